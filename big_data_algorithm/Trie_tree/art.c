@@ -0,0 +1,1080 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "art.h"
+
+#define NODE4   1
+#define NODE16  2
+#define NODE48  3
+#define NODE256 4
+
+// leaves are told apart from nodes by the low pointer bit
+#define IS_LEAF(x)      (((uintptr_t)(x)) & 1)
+#define SET_LEAF(x)     ((art_node_t *)((uintptr_t)(x) | 1))
+#define LEAF_RAW(x)     ((art_leaf_t *)((uintptr_t)(x) & ~(uintptr_t)1))
+
+#define MIN(a, b)       ((a) < (b) ? (a) : (b))
+
+#define ARENA_CHUNK     (1 << 20)
+
+typedef struct
+{
+    art_node_t n;
+    uint8_t keys[4];
+    art_node_t *children[4];
+} art_node4_t;
+
+typedef struct
+{
+    art_node_t n;
+    uint8_t keys[16];           // sorted
+    art_node_t *children[16];
+} art_node16_t;
+
+typedef struct
+{
+    art_node_t n;
+    uint8_t index[256];         // byte -> slot + 1, 0 is none
+    art_node_t *children[48];
+} art_node48_t;
+
+typedef struct
+{
+    art_node_t n;
+    art_node_t *children[256];
+} art_node256_t;
+
+typedef char art_node256_fits[sizeof(art_node256_t) <= ART_ARENA_CLASSES * 8 ? 1 : -1];
+
+
+// ---------------------------------------------------------------------------
+// arena: 1MB chunks cut into 8-byte size classes, freed blocks are reused
+// ---------------------------------------------------------------------------
+
+// a freed block of the class, NULL if there is none. never calls malloc
+static void *arena_reuse(art_arena_t *a, size_t size)
+{
+    size_t cls = (size + 7) / 8;
+    void *p;
+
+    if (cls > ART_ARENA_CLASSES || (p = a->free_list[cls]) == NULL)
+        return NULL;
+    a->free_list[cls] = *(void **)p;
+    a->live_bytes += cls * 8;
+    return p;
+}
+
+static void *arena_alloc(art_arena_t *a, size_t size)
+{
+    size_t cls = (size + 7) / 8;
+    char *chunk;
+    void *p;
+
+    if (cls > ART_ARENA_CLASSES)
+    {
+        p = malloc(size);
+        if (p)
+        {
+            a->big_bytes += size;
+            a->live_bytes += size;
+        }
+        return p;
+    }
+    if ((p = arena_reuse(a, size)) != NULL)
+        return p;
+    size = cls * 8;
+    if (a->left < size)
+    {
+        chunk = (char *)malloc(ARENA_CHUNK);
+        if (!chunk)
+            return NULL;
+        *(void **)chunk = a->chunks;
+        a->chunks = chunk;
+        a->cur = chunk + sizeof(void *);
+        a->left = ARENA_CHUNK - sizeof(void *);
+        a->chunk_bytes += ARENA_CHUNK;
+    }
+    p = a->cur;
+    a->cur += size;
+    a->left -= size;
+    a->live_bytes += size;
+    return p;
+}
+
+// puts a block of a class, or any 8-byte multiple up to the largest class,
+// on its free list
+static void arena_push(art_arena_t *a, void *p, size_t cls)
+{
+    *(void **)p = a->free_list[cls];
+    a->free_list[cls] = p;
+    a->live_bytes -= cls * 8;
+}
+
+static void arena_free(art_arena_t *a, void *p, size_t size)
+{
+    size_t cls = (size + 7) / 8;
+
+    if (cls > ART_ARENA_CLASSES)
+    {
+        a->big_bytes -= size;
+        a->live_bytes -= size;
+        free(p);
+        return;
+    }
+    arena_push(a, p, cls);
+}
+
+static size_t node_size(uint8_t type)
+{
+    switch (type)
+    {
+    case NODE4:
+        return sizeof(art_node4_t);
+    case NODE16:
+        return sizeof(art_node16_t);
+    case NODE48:
+        return sizeof(art_node48_t);
+    default:
+        return sizeof(art_node256_t);
+    }
+}
+
+static art_node_t *alloc_node(art_tree_t *t, uint8_t type)
+{
+    art_node_t *n = (art_node_t *)arena_alloc(&t->arena, node_size(type));
+
+    if (n)
+    {
+        memset(n, 0, node_size(type));
+        n->type = type;
+    }
+    return n;
+}
+
+static void free_node(art_tree_t *t, art_node_t *n)
+{
+    arena_free(&t->arena, n, node_size(n->type));
+}
+
+static art_leaf_t *make_leaf(art_tree_t *t, const uint8_t *key, size_t len,
+                             void *value)
+{
+    art_leaf_t *l = (art_leaf_t *)arena_alloc(&t->arena, sizeof(art_leaf_t) + len);
+
+    if (l)
+    {
+        l->value = value;
+        l->key_len = (uint32_t)len;
+        memcpy(l->key, key, len);
+    }
+    return l;
+}
+
+static void free_leaf(art_tree_t *t, art_leaf_t *l)
+{
+    arena_free(&t->arena, l, sizeof(art_leaf_t) + l->key_len);
+}
+
+static inline int leaf_matches(const art_leaf_t *l, const uint8_t *key,
+                               size_t len)
+{
+    return l->key_len == len && memcmp(l->key, key, len) == 0;
+}
+
+
+// ---------------------------------------------------------------------------
+// children
+// ---------------------------------------------------------------------------
+
+static art_node_t **find_child(const art_node_t *n, uint8_t c)
+{
+    int i;
+
+    switch (n->type)
+    {
+    case NODE4:
+    {
+        art_node4_t *p = (art_node4_t *)n;
+
+        for (i = 0; i < n->num_children; i++)
+        {
+            if (p->keys[i] == c)
+                return &p->children[i];
+        }
+        return NULL;
+    }
+    case NODE16:
+    {
+        art_node16_t *p = (art_node16_t *)n;
+#ifdef __SSE2__
+        // compare all 16 keys at once, drop the unused slots
+        __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8((char)c),
+                                     _mm_loadu_si128((const __m128i *)p->keys));
+        int mask = _mm_movemask_epi8(cmp) & ((1 << n->num_children) - 1);
+
+        if (mask)
+            return &p->children[__builtin_ctz(mask)];
+#else
+        for (i = 0; i < n->num_children; i++)
+        {
+            if (p->keys[i] == c)
+                return &p->children[i];
+        }
+#endif
+        return NULL;
+    }
+    case NODE48:
+    {
+        art_node48_t *p = (art_node48_t *)n;
+
+        i = p->index[c];
+        return i ? &p->children[i - 1] : NULL;
+    }
+    default:
+    {
+        art_node256_t *p = (art_node256_t *)n;
+
+        return p->children[c] ? &p->children[c] : NULL;
+    }
+    }
+}
+
+// position of the first key greater than c in a sorted node4/16
+static int lower_slot(const uint8_t *keys, int num, uint8_t c)
+{
+    int i;
+
+#ifdef __SSE2__
+    if (num > 4)
+    {
+        // signed compare after flipping the top bit is an unsigned compare
+        __m128i flip = _mm_set1_epi8((char)0x80);
+        __m128i cmp = _mm_cmplt_epi8(
+            _mm_xor_si128(_mm_set1_epi8((char)c), flip),
+            _mm_xor_si128(_mm_loadu_si128((const __m128i *)keys), flip));
+        int mask = _mm_movemask_epi8(cmp) & ((1 << num) - 1);
+
+        return mask ? __builtin_ctz(mask) : num;
+    }
+#endif
+    for (i = 0; i < num && keys[i] < c; i++)
+        ;
+    return i;
+}
+
+static void copy_header(art_node_t *dst, const art_node_t *src)
+{
+    dst->prefix_len = src->prefix_len;
+    dst->num_children = src->num_children;
+    dst->leaf = src->leaf;
+    memcpy(dst->prefix, src->prefix, MIN(src->prefix_len, ART_MAX_PREFIX));
+}
+
+// c must not be a child yet. a full node is replaced by a larger one through
+// ref. returns -1 if out of memory, nothing changed then
+static int add_child(art_tree_t *t, art_node_t *n, art_node_t **ref,
+                     uint8_t c, art_node_t *child)
+{
+    int i, pos;
+
+    switch (n->type)
+    {
+    case NODE4:
+    {
+        art_node4_t *p = (art_node4_t *)n;
+        art_node16_t *nn;
+
+        if (n->num_children < 4)
+        {
+            pos = lower_slot(p->keys, n->num_children, c);
+            memmove(p->keys + pos + 1, p->keys + pos, n->num_children - pos);
+            memmove(p->children + pos + 1, p->children + pos,
+                    (n->num_children - pos) * sizeof(void *));
+            p->keys[pos] = c;
+            p->children[pos] = child;
+            n->num_children++;
+            return 0;
+        }
+        nn = (art_node16_t *)alloc_node(t, NODE16);
+        if (!nn)
+            return -1;
+        copy_header(&nn->n, n);
+        memcpy(nn->keys, p->keys, 4);
+        memcpy(nn->children, p->children, 4 * sizeof(void *));
+        *ref = &nn->n;
+        free_node(t, n);
+        return add_child(t, &nn->n, ref, c, child);
+    }
+    case NODE16:
+    {
+        art_node16_t *p = (art_node16_t *)n;
+        art_node48_t *nn;
+
+        if (n->num_children < 16)
+        {
+            pos = lower_slot(p->keys, n->num_children, c);
+            memmove(p->keys + pos + 1, p->keys + pos, n->num_children - pos);
+            memmove(p->children + pos + 1, p->children + pos,
+                    (n->num_children - pos) * sizeof(void *));
+            p->keys[pos] = c;
+            p->children[pos] = child;
+            n->num_children++;
+            return 0;
+        }
+        nn = (art_node48_t *)alloc_node(t, NODE48);
+        if (!nn)
+            return -1;
+        copy_header(&nn->n, n);
+        for (i = 0; i < 16; i++)
+        {
+            nn->index[p->keys[i]] = i + 1;
+            nn->children[i] = p->children[i];
+        }
+        *ref = &nn->n;
+        free_node(t, n);
+        return add_child(t, &nn->n, ref, c, child);
+    }
+    case NODE48:
+    {
+        art_node48_t *p = (art_node48_t *)n;
+        art_node256_t *nn;
+
+        // slots stay packed, see remove_child
+        if (n->num_children < 48)
+        {
+            p->children[n->num_children] = child;
+            p->index[c] = ++n->num_children;
+            return 0;
+        }
+        nn = (art_node256_t *)alloc_node(t, NODE256);
+        if (!nn)
+            return -1;
+        copy_header(&nn->n, n);
+        for (i = 0; i < 256; i++)
+        {
+            if (p->index[i])
+                nn->children[i] = p->children[p->index[i] - 1];
+        }
+        *ref = &nn->n;
+        free_node(t, n);
+        return add_child(t, &nn->n, ref, c, child);
+    }
+    default:
+    {
+        art_node256_t *p = (art_node256_t *)n;
+
+        p->children[c] = child;
+        n->num_children++;
+        return 0;
+    }
+    }
+}
+
+// a node4 left with one child and no leaf is replaced by the child, its
+// prefix put in front of the child's; one left with only a leaf by the leaf
+static void collapse(art_tree_t *t, art_node_t *n, art_node_t **ref)
+{
+    art_node4_t *p = (art_node4_t *)n;
+    art_node_t *child;
+    uint32_t len;
+
+    if (n->num_children == 0)
+    {
+        *ref = SET_LEAF(n->leaf);
+        free_node(t, n);
+        return;
+    }
+    child = p->children[0];
+    if (!IS_LEAF(child))
+    {
+        len = n->prefix_len;
+        if (len < ART_MAX_PREFIX)
+            n->prefix[len++] = p->keys[0];
+        if (len < ART_MAX_PREFIX)
+        {
+            memcpy(n->prefix + len, child->prefix,
+                   MIN(child->prefix_len, ART_MAX_PREFIX - len));
+            len += MIN(child->prefix_len, ART_MAX_PREFIX - len);
+        }
+        memcpy(child->prefix, n->prefix, MIN(len, ART_MAX_PREFIX));
+        child->prefix_len += n->prefix_len + 1;
+    }
+    *ref = child;
+    free_node(t, n);
+}
+
+// puts the smaller node the caller built in tmp in place of n. the block
+// comes from the free list if there is one, else it is the front of n's own
+// block and the rest of that goes back to the arena: nothing is malloc'd, so
+// shrinking can't fail
+static art_node_t *shrink_node(art_tree_t *t, art_node_t *n,
+                               const art_node_t *tmp)
+{
+    size_t size = node_size(tmp->type);
+    size_t used = (size + 7) / 8 * 8;
+    size_t old = (node_size(n->type) + 7) / 8 * 8;
+    art_node_t *nn = (art_node_t *)arena_reuse(&t->arena, size);
+
+    if (nn)
+    {
+        memcpy(nn, tmp, size);
+        free_node(t, n);
+        return nn;
+    }
+    memcpy(n, tmp, size);
+    arena_push(&t->arena, (char *)n + used, (old - used) / 8);
+    return n;
+}
+
+// removes the child at slot, shrinking the node when it gets sparse. never
+// allocates, so it can't fail
+static void remove_child(art_tree_t *t, art_node_t *n, art_node_t **ref,
+                         uint8_t c, art_node_t **slot)
+{
+    int i, pos, last;
+
+    switch (n->type)
+    {
+    case NODE4:
+    {
+        art_node4_t *p = (art_node4_t *)n;
+
+        pos = slot - p->children;
+        memmove(p->keys + pos, p->keys + pos + 1, n->num_children - pos - 1);
+        memmove(p->children + pos, p->children + pos + 1,
+                (n->num_children - pos - 1) * sizeof(void *));
+        n->num_children--;
+        if (n->num_children + (n->leaf != NULL) == 1)
+            collapse(t, n, ref);
+        return;
+    }
+    case NODE16:
+    {
+        art_node16_t *p = (art_node16_t *)n;
+        art_node4_t nn;
+
+        pos = slot - p->children;
+        memmove(p->keys + pos, p->keys + pos + 1, n->num_children - pos - 1);
+        memmove(p->children + pos, p->children + pos + 1,
+                (n->num_children - pos - 1) * sizeof(void *));
+        n->num_children--;
+        if (n->num_children == 3)
+        {
+            memset(&nn, 0, sizeof(nn));
+            nn.n.type = NODE4;
+            copy_header(&nn.n, n);
+            memcpy(nn.keys, p->keys, 3);
+            memcpy(nn.children, p->children, 3 * sizeof(void *));
+            *ref = shrink_node(t, n, &nn.n);
+        }
+        return;
+    }
+    case NODE48:
+    {
+        art_node48_t *p = (art_node48_t *)n;
+        art_node16_t nn;
+
+        // move the last slot into the hole to keep them packed
+        pos = p->index[c] - 1;
+        last = n->num_children - 1;
+        p->index[c] = 0;
+        if (pos != last)
+        {
+            p->children[pos] = p->children[last];
+            for (i = 0; i < 256; i++)
+            {
+                if (p->index[i] == last + 1)
+                {
+                    p->index[i] = pos + 1;
+                    break;
+                }
+            }
+        }
+        p->children[last] = NULL;
+        n->num_children--;
+        if (n->num_children == 12)
+        {
+            memset(&nn, 0, sizeof(nn));
+            nn.n.type = NODE16;
+            copy_header(&nn.n, n);
+            for (i = 0, pos = 0; i < 256; i++)
+            {
+                if (p->index[i])
+                {
+                    nn.keys[pos] = (uint8_t)i;
+                    nn.children[pos++] = p->children[p->index[i] - 1];
+                }
+            }
+            *ref = shrink_node(t, n, &nn.n);
+        }
+        return;
+    }
+    default:
+    {
+        art_node256_t *p = (art_node256_t *)n;
+        art_node48_t nn;
+
+        p->children[c] = NULL;
+        n->num_children--;
+        if (n->num_children == 37)
+        {
+            memset(&nn, 0, sizeof(nn));
+            nn.n.type = NODE48;
+            copy_header(&nn.n, n);
+            for (i = 0, pos = 0; i < 256; i++)
+            {
+                if (p->children[i])
+                {
+                    nn.children[pos] = p->children[i];
+                    nn.index[i] = ++pos;
+                }
+            }
+            *ref = shrink_node(t, n, &nn.n);
+        }
+        return;
+    }
+    }
+}
+
+
+// ---------------------------------------------------------------------------
+// prefixes
+// ---------------------------------------------------------------------------
+
+// leftmost leaf, the node's own leaf is shorter than everything below it
+static const art_leaf_t *minimum(const art_node_t *n)
+{
+    int i;
+
+    while (!IS_LEAF(n))
+    {
+        if (n->leaf)
+            return n->leaf;
+        switch (n->type)
+        {
+        case NODE4:
+            n = ((const art_node4_t *)n)->children[0];
+            break;
+        case NODE16:
+            n = ((const art_node16_t *)n)->children[0];
+            break;
+        case NODE48:
+        {
+            const art_node48_t *p = (const art_node48_t *)n;
+
+            for (i = 0; !p->index[i]; i++)
+                ;
+            n = p->children[p->index[i] - 1];
+            break;
+        }
+        default:
+        {
+            const art_node256_t *p = (const art_node256_t *)n;
+
+            for (i = 0; !p->children[i]; i++)
+                ;
+            n = p->children[i];
+            break;
+        }
+        }
+    }
+    return LEAF_RAW(n);
+}
+
+// bytes of the stored prefix that match, the rest is checked at the leaf
+static uint32_t check_prefix(const art_node_t *n, const uint8_t *key,
+                             size_t len, size_t depth)
+{
+    uint32_t max = (uint32_t)MIN(MIN(n->prefix_len, ART_MAX_PREFIX), len - depth);
+    uint32_t i;
+
+    for (i = 0; i < max && n->prefix[i] == key[depth + i]; i++)
+        ;
+    return i;
+}
+
+// bytes of the whole prefix that match, taking the ones past
+// ART_MAX_PREFIX from a leaf. stops early where the key ends
+static uint32_t prefix_mismatch(const art_node_t *n, const uint8_t *key,
+                                size_t len, size_t depth)
+{
+    uint32_t max = (uint32_t)MIN(MIN(n->prefix_len, ART_MAX_PREFIX), len - depth);
+    uint32_t i;
+    const art_leaf_t *l;
+
+    for (i = 0; i < max; i++)
+    {
+        if (n->prefix[i] != key[depth + i])
+            return i;
+    }
+    if (n->prefix_len > ART_MAX_PREFIX)
+    {
+        l = minimum(n);
+        max = (uint32_t)MIN(n->prefix_len, len - depth);
+        for (; i < max; i++)
+        {
+            if (l->key[depth + i] != key[depth + i])
+                return i;
+        }
+    }
+    return i;
+}
+
+
+// ---------------------------------------------------------------------------
+// public
+// ---------------------------------------------------------------------------
+
+art_tree_t *art_create(void)
+{
+    return (art_tree_t *)calloc(1, sizeof(art_tree_t));
+}
+
+// only leaves can be larger than the arena classes
+static void free_big_leaves(art_tree_t *t, art_node_t *n)
+{
+    art_node_t **child;
+    int i;
+
+    if (IS_LEAF(n))
+    {
+        if ((sizeof(art_leaf_t) + LEAF_RAW(n)->key_len + 7) / 8 > ART_ARENA_CLASSES)
+            free(LEAF_RAW(n));
+        return;
+    }
+    if (n->leaf)
+        free_big_leaves(t, SET_LEAF(n->leaf));
+    for (i = 0; i < 256; i++)
+    {
+        child = find_child(n, (uint8_t)i);
+        if (child)
+            free_big_leaves(t, *child);
+    }
+}
+
+void art_destroy(art_tree_t *t)
+{
+    void *chunk, *next;
+
+    if (!t)
+        return;
+    if (t->root && t->arena.big_bytes)
+        free_big_leaves(t, t->root);
+    for (chunk = t->arena.chunks; chunk; chunk = next)
+    {
+        next = *(void **)chunk;
+        free(chunk);
+    }
+    free(t);
+}
+
+uint64_t art_size(const art_tree_t *t)
+{
+    return t->size;
+}
+
+void *art_search(const art_tree_t *t, const void *key_, size_t len)
+{
+    const uint8_t *key = (const uint8_t *)key_;
+    const art_node_t *n = t->root;
+    art_node_t **child;
+    size_t depth = 0;
+
+    while (n)
+    {
+        if (IS_LEAF(n))
+            return leaf_matches(LEAF_RAW(n), key, len) ? LEAF_RAW(n)->value : NULL;
+        if (n->prefix_len)
+        {
+            if (check_prefix(n, key, len, depth) != MIN(n->prefix_len, ART_MAX_PREFIX))
+                return NULL;
+            depth += n->prefix_len;
+            if (depth > len)
+                return NULL;
+        }
+        if (depth == len)
+            return n->leaf && leaf_matches(n->leaf, key, len) ? n->leaf->value : NULL;
+        child = find_child(n, key[depth++]);
+        n = child ? *child : NULL;
+    }
+    return NULL;
+}
+
+// the leaf at ref differs from key after depth: both go under a new node4
+static void *split_leaf(art_tree_t *t, art_node_t **ref, art_leaf_t *old,
+                        const uint8_t *key, size_t len, size_t depth,
+                        void *value)
+{
+    art_node_t *nn = alloc_node(t, NODE4);
+    art_leaf_t *l = make_leaf(t, key, len, value);
+    size_t max, lcp;
+
+    if (!nn || !l)
+    {
+        if (nn)
+            free_node(t, nn);
+        if (l)
+            free_leaf(t, l);
+        return NULL;
+    }
+    max = MIN(old->key_len, len) - depth;
+    for (lcp = 0; lcp < max && old->key[depth + lcp] == key[depth + lcp]; lcp++)
+        ;
+    nn->prefix_len = (uint32_t)lcp;
+    memcpy(nn->prefix, key + depth, MIN(lcp, ART_MAX_PREFIX));
+    depth += lcp;
+    if (old->key_len == depth)
+        nn->leaf = old;
+    else
+        add_child(t, nn, NULL, old->key[depth], SET_LEAF(old));
+    if (len == depth)
+        nn->leaf = l;
+    else
+        add_child(t, nn, NULL, key[depth], SET_LEAF(l));
+    *ref = nn;
+    t->size++;
+    return NULL;
+}
+
+// key leaves the prefix of n after diff bytes: a new node4 takes the common
+// part, n keeps what is after the differing byte
+static void *split_prefix(art_tree_t *t, art_node_t **ref, art_node_t *n,
+                          const uint8_t *key, size_t len, size_t depth,
+                          uint32_t diff, void *value)
+{
+    art_node_t *nn = alloc_node(t, NODE4);
+    art_leaf_t *l = make_leaf(t, key, len, value);
+    const art_leaf_t *min;
+
+    if (!nn || !l)
+    {
+        if (nn)
+            free_node(t, nn);
+        if (l)
+            free_leaf(t, l);
+        return NULL;
+    }
+    nn->prefix_len = diff;
+    memcpy(nn->prefix, n->prefix, MIN(diff, ART_MAX_PREFIX));
+    if (n->prefix_len <= ART_MAX_PREFIX)
+    {
+        add_child(t, nn, NULL, n->prefix[diff], n);
+        n->prefix_len -= diff + 1;
+        memmove(n->prefix, n->prefix + diff + 1, MIN(n->prefix_len, ART_MAX_PREFIX));
+    }
+    else
+    {
+        min = minimum(n);
+        add_child(t, nn, NULL, min->key[depth + diff], n);
+        n->prefix_len -= diff + 1;
+        memcpy(n->prefix, min->key + depth + diff + 1,
+               MIN(n->prefix_len, ART_MAX_PREFIX));
+    }
+    if (depth + diff == len)
+        nn->leaf = l;
+    else
+        add_child(t, nn, NULL, key[depth + diff], SET_LEAF(l));
+    *ref = nn;
+    t->size++;
+    return NULL;
+}
+
+void *art_insert(art_tree_t *t, const void *key_, size_t len, void *value)
+{
+    const uint8_t *key = (const uint8_t *)key_;
+    art_node_t **ref = &t->root, **child, *n;
+    art_leaf_t *l;
+    size_t depth = 0;
+    uint32_t diff;
+    void *old;
+
+    if (!value || len > UINT32_MAX)
+        return NULL;
+    for (;;)
+    {
+        n = *ref;
+        if (!n)
+        {
+            l = make_leaf(t, key, len, value);
+            if (!l)
+                return NULL;
+            *ref = SET_LEAF(l);
+            t->size++;
+            return NULL;
+        }
+        if (IS_LEAF(n))
+        {
+            l = LEAF_RAW(n);
+            if (!leaf_matches(l, key, len))
+                return split_leaf(t, ref, l, key, len, depth, value);
+            old = l->value;
+            l->value = value;
+            return old;
+        }
+        if (n->prefix_len)
+        {
+            diff = prefix_mismatch(n, key, len, depth);
+            if (diff < n->prefix_len)
+                return split_prefix(t, ref, n, key, len, depth, diff, value);
+            depth += n->prefix_len;
+        }
+        if (depth == len)
+        {
+            if (n->leaf)
+            {
+                old = n->leaf->value;
+                n->leaf->value = value;
+                return old;
+            }
+            n->leaf = make_leaf(t, key, len, value);
+            if (n->leaf)
+                t->size++;
+            return NULL;
+        }
+        child = find_child(n, key[depth]);
+        if (!child)
+        {
+            l = make_leaf(t, key, len, value);
+            if (!l)
+                return NULL;
+            if (add_child(t, n, ref, key[depth], SET_LEAF(l)) == -1)
+                free_leaf(t, l);
+            else
+                t->size++;
+            return NULL;
+        }
+        ref = child;
+        depth++;
+    }
+}
+
+void *art_delete(art_tree_t *t, const void *key_, size_t len)
+{
+    const uint8_t *key = (const uint8_t *)key_;
+    art_node_t **ref = &t->root, **child, *n = t->root;
+    art_leaf_t *l;
+    size_t depth = 0;
+    void *value;
+
+    if (!n)
+        return NULL;
+    if (IS_LEAF(n))
+    {
+        l = LEAF_RAW(n);
+        if (!leaf_matches(l, key, len))
+            return NULL;
+        t->root = NULL;
+        value = l->value;
+        free_leaf(t, l);
+        t->size--;
+        return value;
+    }
+    for (;;)
+    {
+        if (n->prefix_len)
+        {
+            if (check_prefix(n, key, len, depth) != MIN(n->prefix_len, ART_MAX_PREFIX))
+                return NULL;
+            depth += n->prefix_len;
+            if (depth > len)
+                return NULL;
+        }
+        if (depth == len)
+        {
+            l = n->leaf;
+            if (!l || !leaf_matches(l, key, len))
+                return NULL;
+            n->leaf = NULL;
+            if (n->type == NODE4 && n->num_children == 1)
+                collapse(t, n, ref);
+            break;
+        }
+        child = find_child(n, key[depth]);
+        if (!child)
+            return NULL;
+        if (IS_LEAF(*child))
+        {
+            l = LEAF_RAW(*child);
+            if (!leaf_matches(l, key, len))
+                return NULL;
+            remove_child(t, n, ref, key[depth], child);
+            break;
+        }
+        ref = child;
+        n = *child;
+        depth++;
+    }
+    value = l->value;
+    free_leaf(t, l);
+    t->size--;
+    return value;
+}
+
+// candidates along the path are nested, each one only needs the bytes past
+// the last one checked. returns 0 when it doesn't match: nothing deeper can
+static int lpm_candidate(const art_leaf_t *l, const uint8_t *key, size_t len,
+                         const art_leaf_t **best, size_t *checked)
+{
+    if (l->key_len > len ||
+        memcmp(l->key + *checked, key + *checked, l->key_len - *checked) != 0)
+        return 0;
+    *best = l;
+    *checked = l->key_len;
+    return 1;
+}
+
+void *art_longest_prefix(const art_tree_t *t, const void *key_, size_t len,
+                         size_t *match_len)
+{
+    const uint8_t *key = (const uint8_t *)key_;
+    const art_node_t *n = t->root;
+    const art_leaf_t *best = NULL;
+    art_node_t **child;
+    size_t depth = 0, checked = 0;
+
+    while (n)
+    {
+        if (IS_LEAF(n))
+        {
+            lpm_candidate(LEAF_RAW(n), key, len, &best, &checked);
+            break;
+        }
+        if (n->prefix_len)
+        {
+            if (check_prefix(n, key, len, depth) != MIN(n->prefix_len, ART_MAX_PREFIX))
+                break;
+            depth += n->prefix_len;
+            if (depth > len)
+                break;
+        }
+        if (n->leaf && !lpm_candidate(n->leaf, key, len, &best, &checked))
+            break;
+        if (depth == len)
+            break;
+        child = find_child(n, key[depth++]);
+        n = child ? *child : NULL;
+    }
+    if (!best)
+        return NULL;
+    if (match_len)
+        *match_len = best->key_len;
+    return best->value;
+}
+
+static int iter_rec(const art_node_t *n, art_callback cb, void *arg)
+{
+    const art_leaf_t *l;
+    int i, ret;
+
+    if (IS_LEAF(n))
+    {
+        l = LEAF_RAW(n);
+        return cb(arg, l->key, l->key_len, l->value);
+    }
+    if (n->leaf && (ret = cb(arg, n->leaf->key, n->leaf->key_len, n->leaf->value)))
+        return ret;
+    switch (n->type)
+    {
+    case NODE4:
+    case NODE16:
+    {
+        art_node_t *const *children = n->type == NODE4 ?
+                                      ((const art_node4_t *)n)->children :
+                                      ((const art_node16_t *)n)->children;
+
+        for (i = 0; i < n->num_children; i++)
+        {
+            if ((ret = iter_rec(children[i], cb, arg)))
+                return ret;
+        }
+        return 0;
+    }
+    case NODE48:
+    {
+        const art_node48_t *p = (const art_node48_t *)n;
+
+        for (i = 0; i < 256; i++)
+        {
+            if (p->index[i] && (ret = iter_rec(p->children[p->index[i] - 1], cb, arg)))
+                return ret;
+        }
+        return 0;
+    }
+    default:
+    {
+        const art_node256_t *p = (const art_node256_t *)n;
+
+        for (i = 0; i < 256; i++)
+        {
+            if (p->children[i] && (ret = iter_rec(p->children[i], cb, arg)))
+                return ret;
+        }
+        return 0;
+    }
+    }
+}
+
+int art_iter(const art_tree_t *t, art_callback cb, void *arg)
+{
+    return t->root ? iter_rec(t->root, cb, arg) : 0;
+}
+
+int art_iter_prefix(const art_tree_t *t, const void *prefix_, size_t len,
+                    art_callback cb, void *arg)
+{
+    const uint8_t *prefix = (const uint8_t *)prefix_;
+    const art_node_t *n = t->root;
+    const art_leaf_t *l;
+    art_node_t **child;
+    size_t depth = 0;
+    uint32_t p;
+
+    // every byte on the way down is checked, so once the prefix is used up
+    // the whole subtree matches
+    while (n)
+    {
+        if (IS_LEAF(n))
+        {
+            l = LEAF_RAW(n);
+            if (l->key_len >= len && memcmp(l->key, prefix, len) == 0)
+                return cb(arg, l->key, l->key_len, l->value);
+            return 0;
+        }
+        if (n->prefix_len)
+        {
+            p = prefix_mismatch(n, prefix, len, depth);
+            if (depth + p == len)
+                return iter_rec(n, cb, arg);
+            if (p < n->prefix_len)
+                return 0;
+            depth += n->prefix_len;
+        }
+        if (depth == len)
+            return iter_rec(n, cb, arg);
+        child = find_child(n, prefix[depth++]);
+        n = child ? *child : NULL;
+    }
+    return 0;
+}
+
+uint64_t art_memory(const art_tree_t *t)
+{
+    return sizeof(art_tree_t) + t->arena.chunk_bytes + t->arena.big_bytes;
+}
+
+uint64_t art_live_bytes(const art_tree_t *t)
+{
+    return t->arena.live_bytes;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
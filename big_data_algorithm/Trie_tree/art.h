@@ -0,0 +1,113 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+Adaptive Radix Tree (ART)Ӧ
+
+trie_tree.c ÿڵ̶26ָ(Լ208ֽ)ֻСдĸһֽһָ롣
+ART Ľڵ㰴ӸС
+    Node4    4ӣkeys[4] + 4ָ
+    Node16   16ӣkeys[16]SSE2һαȽ16ֽ
+    Node48   256ֽڵ±ָ48ָ
+    Node256  ֱֽ±
+ֻһӵ·ѹɽڵǰ׺(path compression)ǰ׺ ART_MAX_PREFIX
+ֽڣֻǳȣҪʱһҶӵkeyȡ(optimistic)
+
+key ֽڴԻΪǰ׺ĳڵýkeyڵ leaf ϡ
+ҶӴkeyvalueڵҶӶ arena 䣬ͷŵķŻذСֵĿ
+
+Insert / search / delete cost O(key_length); keys are kept in byte order so
+prefix iteration visits them sorted, and longest-prefix match walks the key
+once.
+*/
+
+#ifndef _ART_H_
+#define _ART_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define ART_MAX_PREFIX  9       // header fits in 24 bytes
+
+typedef struct art_leaf art_leaf_t;
+struct art_leaf
+{
+    void *value;
+    uint32_t key_len;
+    uint8_t key[];
+};
+
+// inner node header, the children follow in art_node4_t and friends
+typedef struct art_node art_node_t;
+struct art_node
+{
+    uint32_t prefix_len;
+    uint16_t num_children;
+    uint8_t type;
+    uint8_t prefix[ART_MAX_PREFIX];
+    art_leaf_t *leaf;           // the key that ends at this node
+};
+
+// size-classed allocator for nodes and leaves
+#define ART_ARENA_CLASSES   (2304 / 8)  // Node256 is the largest class
+
+typedef struct art_arena art_arena_t;
+struct art_arena
+{
+    void *chunks;               // linked through their first word
+    char *cur;
+    size_t left;
+    void *free_list[ART_ARENA_CLASSES + 1];
+    uint64_t chunk_bytes;
+    uint64_t big_bytes;         // leaves too large for a class, from malloc
+    uint64_t live_bytes;
+};
+
+typedef struct art_tree art_tree_t;
+struct art_tree
+{
+    art_node_t *root;           // inner node, or a tagged leaf
+    uint64_t size;
+    art_arena_t arena;
+};
+
+// returns nonzero to stop the iteration
+typedef int (*art_callback)(void *arg, const uint8_t *key, size_t len,
+                            void *value);
+
+art_tree_t *art_create(void);
+void art_destroy(art_tree_t *t);
+
+// value must not be NULL. returns the old value if the key was there
+void *art_insert(art_tree_t *t, const void *key, size_t len, void *value);
+
+// NULL if not found
+void *art_search(const art_tree_t *t, const void *key, size_t len);
+
+// returns the removed value, NULL if not found
+void *art_delete(art_tree_t *t, const void *key, size_t len);
+
+uint64_t art_size(const art_tree_t *t);
+
+// the value of the longest key in the tree that is a prefix of key,
+// *match_len gets its length. NULL if no key is a prefix of it
+void *art_longest_prefix(const art_tree_t *t, const void *key, size_t len,
+                         size_t *match_len);
+
+// every key starting with prefix, in byte order. returns what the last
+// callback returned
+int art_iter_prefix(const art_tree_t *t, const void *prefix, size_t len,
+                    art_callback cb, void *arg);
+
+int art_iter(const art_tree_t *t, art_callback cb, void *arg);
+
+// bytes taken from the system / bytes in live nodes and leaves
+uint64_t art_memory(const art_tree_t *t);
+uint64_t art_live_bytes(const art_tree_t *t);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
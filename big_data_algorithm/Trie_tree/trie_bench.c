@@ -0,0 +1,535 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ART ԣ
+ɾͱҶһ(ڵ4/16/48/256ıСART_MAX_PREFIXĳǰ׺
+Ϊǰ׺key) URL ǰ׺·ɱ롢ҡǰ׺ƥ䡢ǰ׺ʱ
+ÿkeyռڴ棬 trie_tree.c ԭ26ָĽڵ(keyÿֽ۳a-z)
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "art.h"
+
+#define MAX_ROUTE   96
+#define CHECK_KEYS  3000
+#define CHECK_OPS   200000
+
+static uint64_t nroutes = 2000000;
+static uint64_t nbaseline = 200000;
+static uint64_t nqueries = 1000000;
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static inline uint64_t xorshift(uint64_t *s)
+{
+    uint64_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *s = x;
+}
+
+static int key_cmp(const uint8_t *a, size_t alen, const uint8_t *b, size_t blen)
+{
+    int c = memcmp(a, b, alen < blen ? alen : blen);
+
+    return c ? c : (alen > blen) - (alen < blen);
+}
+
+
+// ---------------------------------------------------------------------------
+// random operations against a brute force list
+// ---------------------------------------------------------------------------
+
+typedef struct
+{
+    uint8_t key[40];
+    size_t len;
+    void *value;                // NULL when not in the tree
+} ref_key_t;
+
+static ref_key_t refs[CHECK_KEYS];
+
+typedef struct
+{
+    const uint8_t *prefix;
+    size_t len;
+    size_t count;
+    const uint8_t *last;
+    size_t last_len;
+    int bad;
+} iter_check_t;
+
+static int check_visit(void *arg, const uint8_t *key, size_t len, void *value)
+{
+    iter_check_t *c = (iter_check_t *)arg;
+
+    (void)value;
+    if (len < c->len || memcmp(key, c->prefix, c->len) != 0 ||
+        (c->last && key_cmp(c->last, c->last_len, key, len) >= 0))
+        c->bad = 1;
+    c->last = key;
+    c->last_len = len;
+    c->count++;
+    return 0;
+}
+
+// binary keys share long runs, the xxx ones a prefix longer than
+// ART_MAX_PREFIX, the short random ones fill node48/256
+static void make_ref_key(ref_key_t *r, uint64_t *seed)
+{
+    uint64_t x = xorshift(seed);
+    size_t i;
+
+    switch (x % 3)
+    {
+    case 0:
+        r->len = (x >> 8) % 25;
+        for (i = 0; i < r->len; i++)
+            r->key[i] = 'a' + (xorshift(seed) & 1);
+        break;
+    case 1:
+        r->len = 20 + (x >> 8) % 12;
+        memset(r->key, 'x', 20);
+        for (i = 20; i < r->len; i++)
+            r->key[i] = 'a' + xorshift(seed) % 3;
+        break;
+    default:
+        r->len = 1 + (x >> 8) % 3;
+        for (i = 0; i < r->len; i++)
+            r->key[i] = (uint8_t)xorshift(seed);
+        break;
+    }
+}
+
+static int self_check(void)
+{
+    uint64_t seed = 88172645463325252ULL, op, present = 0;
+    art_tree_t *t = art_create();
+    iter_check_t ic;
+    size_t i, j, n = 0, best, got_len, count;
+    ref_key_t *r;
+    void *got, *want;
+    int errors = 0;
+
+    if (!t)
+        return -1;
+    // distinct keys
+    while (n < CHECK_KEYS)
+    {
+        make_ref_key(&refs[n], &seed);
+        for (j = 0; j < n && !(refs[j].len == refs[n].len &&
+                               !memcmp(refs[j].key, refs[n].key, refs[n].len)); j++)
+            ;
+        if (j == n)
+            refs[n++].value = NULL;
+    }
+
+    for (op = 0; op < CHECK_OPS && errors < 10; op++)
+    {
+        r = &refs[xorshift(&seed) % CHECK_KEYS];
+        if (xorshift(&seed) % 3)
+        {
+            want = r->value;
+            got = art_insert(t, r->key, r->len, (void *)(uintptr_t)(op + 1));
+            present += !want;
+            r->value = (void *)(uintptr_t)(op + 1);
+        }
+        else
+        {
+            want = r->value;
+            got = art_delete(t, r->key, r->len);
+            present -= want != NULL;
+            r->value = NULL;
+        }
+        if (got != want || art_size(t) != present)
+        {
+            printf("check: op %lu returned %p, want %p\n", (unsigned long)op, got, want);
+            errors++;
+        }
+        if (op % 64)
+            continue;
+
+        // every key, the longest prefix and the keys under a prefix of a random one
+        for (i = 0; i < CHECK_KEYS; i++)
+        {
+            if (art_search(t, refs[i].key, refs[i].len) != refs[i].value)
+            {
+                printf("check: search %lu wrong after op %lu\n",
+                       (unsigned long)i, (unsigned long)op);
+                errors++;
+                break;
+            }
+        }
+        r = &refs[xorshift(&seed) % CHECK_KEYS];
+        best = SIZE_MAX;
+        want = NULL;
+        for (i = 0; i < CHECK_KEYS; i++)
+        {
+            if (refs[i].value && refs[i].len <= r->len &&
+                !memcmp(refs[i].key, r->key, refs[i].len) &&
+                (best == SIZE_MAX || refs[i].len > best))
+            {
+                best = refs[i].len;
+                want = refs[i].value;
+            }
+        }
+        got = art_longest_prefix(t, r->key, r->len, &got_len);
+        if (got != want || (got && got_len != best))
+        {
+            printf("check: longest prefix wrong after op %lu\n", (unsigned long)op);
+            errors++;
+        }
+        memset(&ic, 0, sizeof(ic));
+        ic.prefix = r->key;
+        ic.len = xorshift(&seed) % (r->len + 1);
+        for (i = 0, count = 0; i < CHECK_KEYS; i++)
+            count += refs[i].value && refs[i].len >= ic.len &&
+                     !memcmp(refs[i].key, ic.prefix, ic.len);
+        art_iter_prefix(t, ic.prefix, ic.len, check_visit, &ic);
+        if (ic.bad || ic.count != count)
+        {
+            printf("check: prefix iteration wrong after op %lu\n", (unsigned long)op);
+            errors++;
+        }
+    }
+    // all deleted, every node is back in the free lists
+    for (i = 0; i < CHECK_KEYS; i++)
+        art_delete(t, refs[i].key, refs[i].len);
+    if (art_size(t) != 0 || art_live_bytes(t) != 0)
+    {
+        printf("check: %lu keys, %lu bytes left\n", (unsigned long)art_size(t),
+               (unsigned long)art_live_bytes(t));
+        errors++;
+    }
+    printf("check    %lu random ops over %d keys: %s\n", (unsigned long)CHECK_OPS,
+           CHECK_KEYS, errors ? "WRONG" : "ok");
+    art_destroy(t);
+    return errors ? -1 : 0;
+}
+
+
+// ---------------------------------------------------------------------------
+// the old layout: 26 children per node
+// ---------------------------------------------------------------------------
+
+typedef struct trie_node trie_node_t;
+struct trie_node
+{
+    int value;
+    trie_node_t *children[26];
+};
+
+static uint64_t trie_nodes;
+
+static void trie_free(trie_node_t *n)
+{
+    int i;
+
+    if (!n)
+        return;
+    for (i = 0; i < 26; i++)
+        trie_free(n->children[i]);
+    free(n);
+}
+
+static void bench_baseline(char **routes, uint64_t n)
+{
+    trie_node_t *root = calloc(1, sizeof(trie_node_t)), *p;
+    uint64_t i, seed = 0x2545f4914f6cdd1dULL, found = 0;
+    const char *s;
+    double t;
+
+    if (!root)
+        return;
+    trie_nodes = 1;
+    t = now_sec();
+    for (i = 0; i < n; i++)
+    {
+        for (p = root, s = routes[i]; *s; s++)
+        {
+            int c = (uint8_t)*s % 26;
+
+            if (!p->children[c])
+            {
+                p->children[c] = calloc(1, sizeof(trie_node_t));
+                if (!p->children[c])
+                {
+                    printf("26-way   out of memory at key %lu\n", (unsigned long)i);
+                    trie_free(root);
+                    return;
+                }
+                trie_nodes++;
+            }
+            p = p->children[c];
+        }
+        p->value++;
+    }
+    t = now_sec() - t;
+    printf("26-way   %lu keys: insert %6.1f ns, %lu nodes, %.1f MB, %.0f bytes/key\n",
+           (unsigned long)n, t * 1e9 / n, (unsigned long)trie_nodes,
+           trie_nodes * sizeof(trie_node_t) / 1048576.0,
+           (double)trie_nodes * sizeof(trie_node_t) / n);
+
+    t = now_sec();
+    for (i = 0; i < nqueries; i++)
+    {
+        for (p = root, s = routes[xorshift(&seed) % n]; p && *s; s++)
+            p = p->children[(uint8_t)*s % 26];
+        found += p && p->value;
+    }
+    t = now_sec() - t;
+    printf("26-way   search %6.1f ns (%lu found)\n", t * 1e9 / nqueries,
+           (unsigned long)found);
+    trie_free(root);
+}
+
+
+// ---------------------------------------------------------------------------
+// URL prefix routes
+// ---------------------------------------------------------------------------
+
+static const char *words[] = {
+    "api", "v1", "v2", "users", "orders", "items", "static", "img", "css", "js",
+    "search", "login", "account", "cart", "pay", "admin", "docs", "blog", "news",
+    "video",
+};
+static const char *regions[] = {"us-east", "us-west", "eu-central", "ap-south"};
+
+// host from 160k, then up to 4 path segments
+static int make_route(char *buf, uint64_t *seed)
+{
+    uint64_t x = xorshift(seed);
+    int len, depth = x % 5, i;
+
+    len = sprintf(buf, "%s%u.%s.example.com", words[x % 20],
+                  (unsigned)((x >> 8) % 2000), regions[(x >> 24) % 4]);
+    for (i = 0; i < depth; i++)
+    {
+        x = xorshift(seed);
+        if (x % 3)
+            len += sprintf(buf + len, "/%s", words[(x >> 8) % 20]);
+        else
+            len += sprintf(buf + len, "/%u", (unsigned)((x >> 8) % 1000));
+    }
+    return len;
+}
+
+typedef struct
+{
+    const uint8_t *last;
+    size_t last_len;
+    uint64_t count;
+    int bad;
+} order_check_t;
+
+static int order_visit(void *arg, const uint8_t *key, size_t len, void *value)
+{
+    order_check_t *c = (order_check_t *)arg;
+
+    (void)value;
+    if (c->last && key_cmp(c->last, c->last_len, key, len) >= 0)
+        c->bad = 1;
+    c->last = key;
+    c->last_len = len;
+    c->count++;
+    return 0;
+}
+
+static int count_visit(void *arg, const uint8_t *key, size_t len, void *value)
+{
+    (void)key;
+    (void)len;
+    (void)value;
+    (*(uint64_t *)arg)++;
+    return 0;
+}
+
+static int bench_routes(char **routes, uint64_t n)
+{
+    uint64_t seed = 0x9e3779b97f4a7c15ULL, i, j, unique = 0, found = 0, bytes = 0;
+    uint64_t wrong = 0, visited = 0;
+    art_tree_t *t = art_create();
+    char query[MAX_ROUTE + 32];
+    size_t len, match;
+    order_check_t oc;
+    double tm;
+    char *dup;
+
+    // duplicates are dropped from the list so every route has its own value
+    if (!t || !(dup = calloc(n, 1)))
+        return -1;
+    tm = now_sec();
+    for (i = 0; i < n; i++)
+    {
+        len = strlen(routes[i]);
+        bytes += len;
+        if (art_insert(t, routes[i], len, (void *)(uintptr_t)(i + 1)))
+            dup[i] = 1;
+    }
+    tm = now_sec() - tm;
+    unique = art_size(t);
+    printf("art      %lu routes (%lu unique, %.1f bytes avg): insert %6.1f ns\n",
+           (unsigned long)n, (unsigned long)unique, (double)bytes / n, tm * 1e9 / n);
+    printf("art      memory %.1f MB (%.1f MB live), %.1f bytes/key\n",
+           art_memory(t) / 1048576.0, art_live_bytes(t) / 1048576.0,
+           (double)art_memory(t) / unique);
+
+    tm = now_sec();
+    for (i = 0; i < nqueries; i++)
+    {
+        j = xorshift(&seed) % n;
+        found += art_search(t, routes[j], strlen(routes[j])) != NULL;
+    }
+    tm = now_sec() - tm;
+    printf("art      search hit  %6.1f ns (%lu found)\n", tm * 1e9 / nqueries,
+           (unsigned long)found);
+
+    found = 0;
+    tm = now_sec();
+    for (i = 0; i < nqueries; i++)
+    {
+        j = xorshift(&seed) % n;
+        len = strlen(routes[j]);
+        memcpy(query, routes[j], len);
+        query[len] = '#';
+        found += art_search(t, query, len + 1) != NULL;
+    }
+    tm = now_sec() - tm;
+    printf("art      search miss %6.1f ns (%lu found)\n", tm * 1e9 / nqueries,
+           (unsigned long)found);
+
+    // no route has a '~', so the route itself is the longest prefix
+    tm = now_sec();
+    for (i = 0; i < nqueries; i++)
+    {
+        j = xorshift(&seed) % n;
+        len = sprintf(query, "%s/~%lu", routes[j], (unsigned long)i);
+        if (!art_longest_prefix(t, query, len, &match) || match != strlen(routes[j]))
+            wrong++;
+    }
+    tm = now_sec() - tm;
+    printf("art      longest prefix %6.1f ns%s\n", tm * 1e9 / nqueries,
+           wrong ? " WRONG" : "");
+
+    // everything under a host
+    tm = now_sec();
+    for (i = 0; i < nqueries / 10; i++)
+    {
+        j = xorshift(&seed) % n;
+        len = strcspn(routes[j], "/");
+        art_iter_prefix(t, routes[j], len, count_visit, &visited);
+    }
+    tm = now_sec() - tm;
+    printf("art      prefix iteration %6.1f ns per host, %.1f keys each\n",
+           tm * 1e9 / (nqueries / 10), (double)visited / (nqueries / 10));
+
+    memset(&oc, 0, sizeof(oc));
+    tm = now_sec();
+    art_iter(t, order_visit, &oc);
+    tm = now_sec() - tm;
+    printf("art      full iteration %.1f ms, %s\n", tm * 1e3,
+           oc.bad || oc.count != unique ? "WRONG" : "sorted");
+    if (oc.bad || oc.count != unique)
+        wrong++;
+
+    // delete half, check, put them back
+    tm = now_sec();
+    for (i = 0; i < n; i += 2)
+    {
+        if (!dup[i] && art_delete(t, routes[i], strlen(routes[i])) == NULL)
+            wrong++;
+    }
+    tm = now_sec() - tm;
+    for (i = 0; i < n; i++)
+    {
+        if (!dup[i] && (art_search(t, routes[i], strlen(routes[i])) == NULL) != (i % 2 == 0))
+            wrong++;
+    }
+    printf("art      delete %6.1f ns, %lu left, %.1f MB live%s\n",
+           tm * 1e9 / (n / 2), (unsigned long)art_size(t),
+           art_live_bytes(t) / 1048576.0, wrong ? " WRONG" : "");
+    for (i = 0; i < n; i += 2)
+    {
+        if (!dup[i])
+            art_insert(t, routes[i], strlen(routes[i]), (void *)(uintptr_t)(i + 1));
+    }
+    printf("art      reinsert: %lu keys, memory %.1f MB\n",
+           (unsigned long)art_size(t), art_memory(t) / 1048576.0);
+    if (art_size(t) != unique)
+        wrong++;
+
+    free(dup);
+    art_destroy(t);
+    return wrong ? -1 : 0;
+}
+
+static void usage(char *name)
+{
+    fprintf(stderr, "Usage: %s [-n routes] [-b keys] [-q queries]\n"
+            "  -n     URL prefix routes for the tree (default 2M)\n"
+            "  -b     routes for the 26-way trie (default 200k, 0 skips it)\n"
+            "  -q     queries per test (default 1M)\n", name);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t seed = 88172645463325252ULL, i, n;
+    char **routes, *pool;
+    int opt, ret = 0;
+
+    while ((opt = getopt(argc, argv, "n:b:q:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': nroutes = strtoull(optarg, NULL, 0); break;
+        case 'b': nbaseline = strtoull(optarg, NULL, 0); break;
+        case 'q': nqueries = strtoull(optarg, NULL, 0); break;
+        default: usage(argv[0]);
+        }
+    }
+    if (nroutes < 2 || nqueries < 10)
+        usage(argv[0]);
+
+    if (self_check() != 0)
+        ret = 1;
+
+    n = nroutes > nbaseline ? nroutes : nbaseline;
+    routes = malloc(n * sizeof(char *));
+    pool = malloc(n * MAX_ROUTE);
+    if (!routes || !pool)
+        return 1;
+    for (i = 0; i < n; i++)
+    {
+        routes[i] = pool + i * MAX_ROUTE;
+        make_route(routes[i], &seed);
+    }
+
+    if (bench_routes(routes, nroutes) != 0)
+        ret = 1;
+    if (nbaseline)
+        bench_baseline(routes, nbaseline);
+
+    free(routes);
+    free(pool);
+    return ret;
+}
+
+#ifdef __cplusplus
+}
+#endif
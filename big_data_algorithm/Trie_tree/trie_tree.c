@@ -33,241 +33,93 @@ The following picture explains construction of trie using keys given in the exam
                         |
                         r
 
+26ָĽڵҪԼ208ֽڣֻܷСдĸ art.h Ӧ
+ֽڵkeyڵ㰴4/16/48/256֮䣬ӵ·ѹǰ׺
+ܰǰ׺ǰ׺(URLǰ׺·)
+
 */
 
 #include <stdio.h>
-#include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
- 
+#include "art.h"
+
 #define ARRAY_SIZE(a) sizeof(a)/sizeof(a[0])
- 
-// Alphabet size (# of symbols)
-#define ALPHABET_SIZE (26)
-// Converts key current character into index
-// use only 'a' through 'z' and lower case
-#define CHAR_TO_INDEX(c) ((int)c - (int)'a')
-#define FREE(p) \
-    free(p);    \
-    p = NULL;
- 
-// trie node
-typedef struct trie_node trie_node_t;
-struct trie_node
-{
-    int value;
-    trie_node_t *children[ALPHABET_SIZE];
-};
- 
-// trie ADT
-typedef struct trie trie_t;
-struct trie
-{
-    trie_node_t *root;
-    int count;
-};
- 
-// Returns new trie node (initialized to NULLs)
-trie_node_t *getNode(void)
-{
-    trie_node_t *pNode = NULL;
- 
-    pNode = (trie_node_t *)malloc(sizeof(trie_node_t));
- 
-    if( pNode )
-    {
-        int i;
- 
-        pNode->value = 0;
- 
-        for(i = 0; i < ALPHABET_SIZE; i++)
-        {
-            pNode->children[i] = NULL;
-        }
-    }
- 
-    return pNode;
-}
- 
-// Initializes trie (root is dummy node)
-void initialize(trie_t *pTrie)
-{
-    pTrie->root = getNode();
-    pTrie->count = 0;
-}
- 
-// If not present, inserts key into trie
-// If the key is prefix of trie node, just marks leaf node
-void insert(trie_t *pTrie, char key[])
-{
-    int level;
-    int length = strlen(key);
-    int index;
-    trie_node_t *pCrawl;
- 
-    pTrie->count++;
-    pCrawl = pTrie->root;
- 
-    for( level = 0; level < length; level++ )
-    {
-        index = CHAR_TO_INDEX(key[level]);
-        if( !pCrawl->children[index] )
-        {
-            pCrawl->children[index] = getNode();
-        }
- 
-        pCrawl = pCrawl->children[index];
-    }
- 
-    // mark last node as leaf
-   // pCrawl->value = pTrie->count;
-   pCrawl->value += 1;
-}
- 
-// Returns non zero, if key presents in trie
-// ûַ0ַ1
-int search(trie_t *pTrie, char key[])
-{
-    int level;
-    int length = strlen(key);
-    int index;
-    trie_node_t *pCrawl;
- 
-    pCrawl = pTrie->root;
- 
-    for( level = 0; level < length; level++ )
-    {
-        index = CHAR_TO_INDEX(key[level]);
- 
-        if( !pCrawl->children[index] )
-        {
-            return 0;
-        }
- 
-        pCrawl = pCrawl->children[index];
-    }
- 
-    return (0 != pCrawl && pCrawl->value);
-}
 
-// ҳֵĴ
-int search_value(trie_t *pTrie, char key[])
-{
-    int level;
-    int length = strlen(key);
-    int index;
-    trie_node_t *pCrawl;
- 
-    pCrawl = pTrie->root;
- 
-    for( level = 0; level < length; level++ )
-    {
-        index = CHAR_TO_INDEX(key[level]);
- 
-        if( !pCrawl->children[index] )
-        {
-            return 0;
-        }
- 
-        pCrawl = pCrawl->children[index];
-    }
- 
-    if (0 != pCrawl)
-        return  pCrawl->value;
-    else
-        return 0;
-}
+// the value is the count, kept in the pointer
+#define COUNT(v) ((int)(uintptr_t)(v))
 
-int leafNode(trie_node_t *pNode)
-{
-    return (pNode->value != 0);
-}
- 
-int isItFreeNode(trie_node_t *pNode)
+static int print_key(void *arg, const uint8_t *key, size_t len, void *value)
 {
-    int i;
-    for(i = 0; i < ALPHABET_SIZE; i++)
-    {
-        if( pNode->children[i] )
-            return 0;
-    }
- 
-    return 1;
+    (void)arg;
+    printf("    %.*s count=%d\n", (int)len, (const char *)key, COUNT(value));
+    return 0;
 }
 
-int deleteHelper(trie_node_t *pNode, char key[], int level, int len)
+// һμһ
+static void insert(art_tree_t *t, const char *key)
 {
-    if( pNode )
-    {
-        // Base case
-        if( level == len )
-        {
-            if( pNode->value )
-            {
-                // Unmark leaf node
-                pNode->value = 0;
+    size_t len = strlen(key);
+    int count = COUNT(art_search(t, key, len));
 
-                // If empty, node to be deleted
-                if( isItFreeNode(pNode) )
-                {
-                    return 1;
-                }
-
-                return 0;
-            }
-        }
-        else // Recursive case ݹ鷽ʽ
-        {
-            int ind = index(key[level]);
-
-            if( deleteHelper(pNode->children[ind], key, level+1, len) )
-            {
-                // last node marked, delete it
-                FREE(pNode->children[ind]);
+    art_insert(t, key, len, (void *)(uintptr_t)(count + 1));
+}
 
-                // recursively climb up, and delete eligible nodes
-                return ( !leafNode(pNode) && isItFreeNode(pNode) );
-            }
-        }
-    }
+static void search(art_tree_t *t, const char *key)
+{
+    int count = COUNT(art_search(t, key, strlen(key)));
 
-    return 0;
+    printf("%s --- %s count=%d\n", key,
+           count ? "Present in trie" : "Not present in trie", count);
 }
 
-void deleteKey(trie_t *pTrie, char key[])
+static void longest_prefix(art_tree_t *t, const char *key)
 {
-    int len = strlen(key);
+    size_t len = 0;
 
-    if( len > 0 )
-    {
-        deleteHelper(pTrie->root, key, 0, len);
-    }
+    if (art_longest_prefix(t, key, strlen(key), &len))
+        printf("%s --- longest prefix %.*s\n", key, (int)len, key);
+    else
+        printf("%s --- no prefix in trie\n", key);
 }
 
-
- 
 // Driver
 int main()
 {
-    // Input keys (use only 'a' through 'z' and lower case)
-    char keys[][8] = {"the", "a", "there", "answer", "any","the", "by", "bye", "their","the"};
-    trie_t trie;
- 
-    char output[][32] = {"Not present in trie", "Present in trie"};
- 
-    initialize(&trie);
- 
+    // any bytes now, not only 'a' through 'z'
+    char keys[][16] = {"the", "a", "there", "answer", "any", "the", "by", "bye",
+                       "their", "the", "/api/v1", "/api/v1/users", "/api/v2"};
+    art_tree_t *t = art_create();
+    size_t i;
+
+    if (!t)
+        return 1;
+
     // Construct trie
-    for(int i = 0; i < ARRAY_SIZE(keys); i++)
-    {
-        insert(&trie, keys[i]);
-    }
- 
+    for (i = 0; i < ARRAY_SIZE(keys); i++)
+        insert(t, keys[i]);
+
     // Search for different keys
-    printf("%s --- %s count=%d\n", "the", output[search(&trie, "the")], search_value(&trie, "the") );
-    printf("%s --- %s count=%d\n", "these", output[search(&trie, "these")], search_value(&trie, "these"));
-    printf("%s --- %s count=%d\n", "their", output[search(&trie, "their")], search_value(&trie, "their"));
-    printf("%s --- %s count=%d\n", "thaw", output[search(&trie, "thaw")], search_value(&trie, "thaw"));
- 
+    search(t, "the");
+    search(t, "these");
+    search(t, "their");
+    search(t, "thaw");
+
+    printf("keys starting with th:\n");
+    art_iter_prefix(t, "th", 2, print_key, NULL);
+
+    longest_prefix(t, "/api/v1/users/42");
+    longest_prefix(t, "/api/v1/orders");
+    longest_prefix(t, "/static/a.css");
+    longest_prefix(t, "byes");
+
+    art_delete(t, "the", 3);
+    search(t, "the");
+    search(t, "there");
+    printf("all %lu keys:\n", (unsigned long)art_size(t));
+    art_iter(t, print_key, NULL);
+
+    art_destroy(t);
     return 0;
 }
 
@@ -40,73 +40,1170 @@ Bit==1.2MBytes
 
 
 #include <stdint.h> /* uint64_t*/
-#include <stdio.h>   
-#include <stdlib.h>   
-#include <string.h>   
-#include "bitmap.h"   
-  
-unsigned char *g_bitmap = NULL;  
-int32_t g_size = 0;  
-int32_t g_base = 0;  
-
- /* 
- *ܣʼbitmap 
- * 
- *sizebitmapĴСbitλĸ 
- *startʼֵ 
- *ֵ0ʾʧܣ1ʾɹ 
- */
-int32_t bitmap_init(int32_t size, int32_t start)  
-{  
-    g_bitmap = (char *)malloc((size/8+1)*sizeof(char));  
-    if(g_bitmap == NULL)  
-        return 0;  
-    g_base = start;  
-    g_size = size/8+1;  
-    memset(g_bitmap, 0x0, g_size);  
-    return 1;  
-}  
-
-
- /* 
- *ܣֵindexĶӦλΪ1 
- *index:Ҫֵ 
- *ֵ0ʾʧܣ1ʾɹ 
- */
-int32_t bitmap_set(int32_t index)  
-{  
-    int32_t quo = (index-g_base)/8 ;  
-    int32_t remainder = (index-g_base)%8;  
-    unsigned char x = (0x1<<remainder);  
-    if( quo > g_size)  
-        return 0;  
-    g_bitmap[quo] |= x;  
-    return 1;   
-}  
-  
-int32_t bitmap_get(int32_t i)  
-{  
-    int32_t quo = (i)/8 ;  
-    int32_t remainder = (i)%8;  
-    unsigned char x = (0x1<<remainder);  
-    unsigned char res;  
-    if( quo > g_size)  
-        return -1;  
-    res = g_bitmap[quo] & x;  
-    return res > 0 ? 1 : 0;   
-}  
-  
-int32_t bitmap_data(int32_t index)  
-{  
-    return (index + g_base);  
-}  
-  
-int32_t bitmap_free()  
-{  
-    free(g_bitmap);  
-} 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BITMAP_X86
+#endif
+#include "bitmap.h"
+
+#define SUPER_WORDS         64      /* rankÿ4096λһ */
+#define CONTAINER_WORDS     1024    /* һ65536λ */
+#define ARRAY_MAX           4096    /* ͻλ飬ʱһ */
+
+enum {
+    OP_AND,
+    OP_OR,
+    OP_XOR,
+    OP_ANDNOT,
+    OP_MAX,
+};
+
+/* RoaringarraybitsֻһΪNULL */
+typedef struct BitmapContainer{
+    uint32_t card;
+    uint32_t cap;           /* array */
+    uint16_t *array;        /*  */
+    uint64_t *bits;
+} BitmapContainer;
+
+
+/************************************************************
+ * 㣺dst = dst op src˳㷵ؽ1ĸ
+ ************************************************************/
+
+typedef uint64_t (*word_op_fn)(uint64_t *dst, const uint64_t *src, uint64_t n);
+typedef uint64_t (*popcount_fn)(const uint64_t *words, uint64_t n);
+typedef uint32_t (*select_fn)(uint64_t word, uint32_t k);
+
+struct bitmap_kernels {
+    word_op_fn op[OP_MAX];
+    popcount_fn popcount;
+};
+
+#define EXPR_AND        (dst[i] & src[i])
+#define EXPR_OR         (dst[i] | src[i])
+#define EXPR_XOR        (dst[i] ^ src[i])
+#define EXPR_ANDNOT     (dst[i] & ~src[i])
+
+#define WORD_OP(name, attr, expr)                                           \
+attr static uint64_t name(uint64_t *dst, const uint64_t *src, uint64_t n)   \
+{                                                                           \
+    uint64_t i, w, c = 0;                                                   \
+                                                                            \
+    for (i = 0; i < n; i++)                                                 \
+    {                                                                       \
+        w = expr;                                                           \
+        dst[i] = w;                                                         \
+        c += __builtin_popcountll(w);                                       \
+    }                                                                       \
+    return c;                                                               \
+}
+
+#define POPCOUNT(name, attr)                                                \
+attr static uint64_t name(const uint64_t *words, uint64_t n)                \
+{                                                                           \
+    uint64_t i, c = 0;                                                      \
+                                                                            \
+    for (i = 0; i < n; i++)                                                 \
+        c += __builtin_popcountll(words[i]);                                \
+    return c;                                                               \
+}
+
+WORD_OP(and_scalar, , EXPR_AND)
+WORD_OP(or_scalar, , EXPR_OR)
+WORD_OP(xor_scalar, , EXPR_XOR)
+WORD_OP(andnot_scalar, , EXPR_ANDNOT)
+POPCOUNT(popcount_scalar, )
+
+static const struct bitmap_kernels kernels_scalar = {
+    {and_scalar, or_scalar, xor_scalar, andnot_scalar}, popcount_scalar,
+};
+
+static uint32_t select_scalar(uint64_t word, uint32_t k)
+{
+    for (; k > 0; k--)
+        word &= word - 1;
+    return __builtin_ctzll(word);
+}
+
+#ifdef BITMAP_X86
+
+#define TARGET_POPCNT   __attribute__((target("popcnt")))
+
+WORD_OP(and_popcnt, TARGET_POPCNT, EXPR_AND)
+WORD_OP(or_popcnt, TARGET_POPCNT, EXPR_OR)
+WORD_OP(xor_popcnt, TARGET_POPCNT, EXPR_XOR)
+WORD_OP(andnot_popcnt, TARGET_POPCNT, EXPR_ANDNOT)
+POPCOUNT(popcount_popcnt, TARGET_POPCNT)
+
+static const struct bitmap_kernels kernels_popcnt = {
+    {and_popcnt, or_popcnt, xor_popcnt, andnot_popcnt}, popcount_popcnt,
+};
+
+/* AVX21ÿ4λһα(vpshufb)vpsadbw64λ */
+__attribute__((target("avx2")))
+static inline __m256i popcount256(__m256i v)
+{
+    const __m256i lookup = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i lo = _mm256_and_si256(v, low);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low);
+    __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                  _mm256_shuffle_epi8(lookup, hi));
+
+    return _mm256_sad_epu8(cnt, _mm256_setzero_si256());
+}
+
+__attribute__((target("avx2")))
+static inline uint64_t sum256(__m256i v)
+{
+    return _mm256_extract_epi64(v, 0) + _mm256_extract_epi64(v, 1) +
+           _mm256_extract_epi64(v, 2) + _mm256_extract_epi64(v, 3);
+}
+
+#define AVX2_OP(name, vexpr, expr)                                          \
+__attribute__((target("avx2,popcnt")))                                      \
+static uint64_t name(uint64_t *dst, const uint64_t *src, uint64_t n)        \
+{                                                                           \
+    __m256i acc = _mm256_setzero_si256(), a, b, r;                          \
+    uint64_t i, w, c;                                                       \
+                                                                            \
+    for (i = 0; i + 4 <= n; i += 4)                                         \
+    {                                                                       \
+        a = _mm256_loadu_si256((const __m256i *)(dst + i));                 \
+        b = _mm256_loadu_si256((const __m256i *)(src + i));                 \
+        r = vexpr;                                                          \
+        _mm256_storeu_si256((__m256i *)(dst + i), r);                       \
+        acc = _mm256_add_epi64(acc, popcount256(r));                        \
+    }                                                                       \
+    for (c = sum256(acc); i < n; i++)                                       \
+    {                                                                       \
+        w = expr;                                                           \
+        dst[i] = w;                                                         \
+        c += __builtin_popcountll(w);                                       \
+    }                                                                       \
+    return c;                                                               \
+}
+
+AVX2_OP(and_avx2, _mm256_and_si256(a, b), EXPR_AND)
+AVX2_OP(or_avx2, _mm256_or_si256(a, b), EXPR_OR)
+AVX2_OP(xor_avx2, _mm256_xor_si256(a, b), EXPR_XOR)
+AVX2_OP(andnot_avx2, _mm256_andnot_si256(b, a), EXPR_ANDNOT)
+
+__attribute__((target("avx2,popcnt")))
+static uint64_t popcount_avx2(const uint64_t *words, uint64_t n)
+{
+    __m256i acc = _mm256_setzero_si256();
+    uint64_t i, c;
+
+    for (i = 0; i + 4 <= n; i += 4)
+        acc = _mm256_add_epi64(acc, popcount256(
+                  _mm256_loadu_si256((const __m256i *)(words + i))));
+    for (c = sum256(acc); i < n; i++)
+        c += __builtin_popcountll(words[i]);
+    return c;
+}
+
+static const struct bitmap_kernels kernels_avx2 = {
+    {and_avx2, or_avx2, xor_avx2, andnot_avx2}, popcount_avx2,
+};
+
+/* pdepѵk1 */
+__attribute__((target("bmi2")))
+static uint32_t select_bmi2(uint64_t word, uint32_t k)
+{
+    return __builtin_ctzll(_pdep_u64(1ULL << k, word));
+}
+
+#endif
+
+/* ʱCPUѡã֮ǰbitmap_set_simd_level֮䶼ǿõʵ֣
+ * ʱָ뵥ԭӵд̶߳ĸϽһ */
+static const struct bitmap_kernels *kernels = &kernels_scalar;
+static select_fn select_word = select_scalar;
+static int32_t simd_level = BITMAP_SCALAR;
+
+static inline const struct bitmap_kernels* cur_kernels(void)
+{
+    return __atomic_load_n(&kernels, __ATOMIC_RELAXED);
+}
+
+static inline select_fn cur_select(void)
+{
+    return __atomic_load_n(&select_word, __ATOMIC_RELAXED);
+}
+
+static int32_t simd_supported(void)
+{
+#ifdef BITMAP_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+        return BITMAP_AVX2;
+    if (__builtin_cpu_supports("popcnt"))
+        return BITMAP_POPCNT;
+#endif
+    return BITMAP_SCALAR;
+}
+
+int32_t bitmap_set_simd_level(int32_t level)
+{
+    const struct bitmap_kernels *k = &kernels_scalar;
+    select_fn sel = select_scalar;
+    int32_t max = simd_supported();
+
+    if (level < 0 || level > max)
+        level = max;
+#ifdef BITMAP_X86
+    if (level == BITMAP_AVX2)
+        k = &kernels_avx2;
+    else if (level == BITMAP_POPCNT)
+        k = &kernels_popcnt;
+    if (level > BITMAP_SCALAR && __builtin_cpu_supports("bmi2"))
+        sel = select_bmi2;
+#endif
+    __atomic_store_n(&kernels, k, __ATOMIC_RELAXED);
+    __atomic_store_n(&select_word, sel, __ATOMIC_RELAXED);
+    __atomic_store_n(&simd_level, level, __ATOMIC_RELAXED);
+    return level;
+}
+
+/* ڵһbitmap_createʱѡ߳ͬʱλͼᾺ */
+__attribute__((constructor))
+static void bitmap_simd_detect(void)
+{
+    bitmap_set_simd_level(-1);
+}
+
+int32_t bitmap_simd_level(void)
+{
+    return __atomic_load_n(&simd_level, __ATOMIC_RELAXED);
+}
+
+
+/************************************************************
+ * Roaring
+ ************************************************************/
+
+/* һСvλãֵʣһк˳ */
+static uint32_t array_lower_bound(const uint16_t *array, uint32_t n, uint16_t v)
+{
+    uint32_t lo = 0, hi = n, mid;
+
+    while (hi - lo > 32)
+    {
+        mid = (lo + hi) / 2;
+        if (array[mid] < v)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    while (lo < hi && array[lo] < v)
+        lo++;
+    return lo;
+}
+
+static void container_free(BitmapContainer *c)
+{
+    free(c->array);
+    free(c->bits);
+    free(c);
+}
+
+static BitmapContainer* container_copy(const BitmapContainer *c)
+{
+    BitmapContainer *copy = (BitmapContainer *)calloc(1, sizeof(BitmapContainer));
+
+    if (copy == NULL)
+        return NULL;
+    copy->card = c->card;
+    if (c->bits != NULL)
+    {
+        copy->bits = (uint64_t *)malloc(CONTAINER_WORDS * sizeof(uint64_t));
+        if (copy->bits == NULL)
+            goto fail;
+        memcpy(copy->bits, c->bits, CONTAINER_WORDS * sizeof(uint64_t));
+    }
+    else if (c->card > 0)
+    {
+        copy->array = (uint16_t *)malloc(c->card * sizeof(uint16_t));
+        if (copy->array == NULL)
+            goto fail;
+        memcpy(copy->array, c->array, c->card * sizeof(uint16_t));
+        copy->cap = c->card;
+    }
+    return copy;
+fail:
+    container_free(copy);
+    return NULL;
+}
+
+static int32_t container_to_bits(BitmapContainer *c)
+{
+    uint64_t *bits = (uint64_t *)calloc(CONTAINER_WORDS, sizeof(uint64_t));
+    uint32_t i;
+
+    if (bits == NULL)
+        return -1;
+    for (i = 0; i < c->card; i++)
+        bits[c->array[i] >> 6] |= 1ULL << (c->array[i] & 63);
+    free(c->array);
+    c->array = NULL;
+    c->cap = 0;
+    c->bits = bits;
+    return 0;
+}
+
+/* λ1˾ͻ飬ڴ治Ȳ */
+static void container_shrink(BitmapContainer *c)
+{
+    uint16_t *array;
+    uint64_t w;
+    uint32_t i, n = 0;
+
+    if (c->bits == NULL || c->card > ARRAY_MAX)
+        return;
+    array = (uint16_t *)malloc((c->card > 0 ? c->card : 1) * sizeof(uint16_t));
+    if (array == NULL)
+        return;
+    for (i = 0; i < CONTAINER_WORDS; i++)
+    {
+        for (w = c->bits[i]; w != 0; w &= w - 1)
+            array[n++] = (uint16_t)(i * 64 + __builtin_ctzll(w));
+    }
+    free(c->bits);
+    c->bits = NULL;
+    c->array = array;
+    c->cap = c->card > 0 ? c->card : 1;
+}
+
+static int32_t container_get(const BitmapContainer *c, uint16_t low)
+{
+    uint32_t pos;
+
+    if (c->bits != NULL)
+        return (c->bits[low >> 6] >> (low & 63)) & 1;
+    pos = array_lower_bound(c->array, c->card, low);
+    return pos < c->card && c->array[pos] == low;
+}
+
+static int32_t container_set(BitmapContainer *c, uint16_t low)
+{
+    uint64_t m = 1ULL << (low & 63);
+    uint16_t *array;
+    uint32_t pos, cap;
+
+    if (c->bits == NULL)
+    {
+        pos = array_lower_bound(c->array, c->card, low);
+        if (pos < c->card && c->array[pos] == low)
+            return 0;
+        if (c->card < ARRAY_MAX)
+        {
+            if (c->card == c->cap)
+            {
+                cap = c->cap < 4 ? 4 : c->cap * 2;
+                cap = cap > ARRAY_MAX ? ARRAY_MAX : cap;
+                array = (uint16_t *)realloc(c->array, cap * sizeof(uint16_t));
+                if (array == NULL)
+                    return -1;
+                c->array = array;
+                c->cap = cap;
+            }
+            memmove(c->array + pos + 1, c->array + pos,
+                    (c->card - pos) * sizeof(uint16_t));
+            c->array[pos] = low;
+            c->card++;
+            return 1;
+        }
+        if (container_to_bits(c) == -1)
+            return -1;
+    }
+    if (c->bits[low >> 6] & m)
+        return 0;
+    c->bits[low >> 6] |= m;
+    c->card++;
+    return 1;
+}
+
+static int32_t container_clear(BitmapContainer *c, uint16_t low)
+{
+    uint64_t m = 1ULL << (low & 63);
+    uint32_t pos;
+
+    if (c->bits != NULL)
+    {
+        if (!(c->bits[low >> 6] & m))
+            return 0;
+        c->bits[low >> 6] &= ~m;
+        c->card--;
+        /* һ4096ת */
+        if (c->card < ARRAY_MAX / 2)
+            container_shrink(c);
+        return 1;
+    }
+    pos = array_lower_bound(c->array, c->card, low);
+    if (pos == c->card || c->array[pos] != low)
+        return 0;
+    memmove(c->array + pos, c->array + pos + 1,
+            (c->card - pos - 1) * sizeof(uint16_t));
+    c->card--;
+    return 1;
+}
+
+/* Сlowĸ */
+static uint32_t container_rank(const BitmapContainer *c, uint32_t low)
+{
+    uint32_t r;
+
+    if (low > 0xffff)
+        return c->card;
+    if (c->bits == NULL)
+        return array_lower_bound(c->array, c->card, (uint16_t)low);
+    r = cur_kernels()->popcount(c->bits, low >> 6);
+    if (low & 63)
+        r += __builtin_popcountll(c->bits[low >> 6] & ((1ULL << (low & 63)) - 1));
+    return r;
+}
+
+static uint32_t container_select(const BitmapContainer *c, uint32_t k)
+{
+    uint32_t i, n;
+
+    if (c->bits == NULL)
+        return c->array[k];
+    for (i = 0; ; i++)
+    {
+        n = __builtin_popcountll(c->bits[i]);
+        if (k < n)
+            return i * 64 + cur_select()(c->bits[i], k);
+        k -= n;
+    }
+}
+
+/* Сlowĵһûз-1 */
+static int32_t container_next(const BitmapContainer *c, uint32_t low)
+{
+    uint32_t pos, i;
+    uint64_t w;
+
+    if (c->bits == NULL)
+    {
+        pos = array_lower_bound(c->array, c->card, (uint16_t)low);
+        return pos < c->card ? c->array[pos] : -1;
+    }
+    i = low >> 6;
+    for (w = c->bits[i] & (~0ULL << (low & 63)); w == 0; w = c->bits[i])
+    {
+        if (++i == CONTAINER_WORDS)
+            return -1;
+    }
+    return i * 64 + __builtin_ctzll(w);
+}
+
+/* 鲢 */
+static int32_t array_op(BitmapContainer *c, const BitmapContainer *s, int32_t op)
+{
+    uint16_t tmp[ARRAY_MAX * 2], *array;
+    uint32_t i = 0, j = 0, n = 0;
+
+    while (i < c->card && j < s->card)
+    {
+        if (c->array[i] < s->array[j])
+        {
+            if (op != OP_AND)
+                tmp[n++] = c->array[i];
+            i++;
+        }
+        else if (c->array[i] > s->array[j])
+        {
+            if (op == OP_OR || op == OP_XOR)
+                tmp[n++] = s->array[j];
+            j++;
+        }
+        else
+        {
+            if (op == OP_AND || op == OP_OR)
+                tmp[n++] = c->array[i];
+            i++;
+            j++;
+        }
+    }
+    if (op != OP_AND)
+    {
+        for (; i < c->card; i++)
+            tmp[n++] = c->array[i];
+    }
+    if (op == OP_OR || op == OP_XOR)
+    {
+        for (; j < s->card; j++)
+            tmp[n++] = s->array[j];
+    }
+
+    if (n > c->cap)
+    {
+        array = (uint16_t *)realloc(c->array, n * sizeof(uint16_t));
+        if (array == NULL)
+            return -1;
+        c->array = array;
+        c->cap = n;
+    }
+    memcpy(c->array, tmp, n * sizeof(uint16_t));
+    c->card = n;
+    if (n > ARRAY_MAX)
+        return container_to_bits(c);
+    return 0;
+}
+
+static int32_t container_op(BitmapContainer *c, const BitmapContainer *s, int32_t op)
+{
+    uint32_t i, n = 0;
+    uint16_t v, *array;
+
+    if (c->bits == NULL && s->bits == NULL)
+        return array_op(c, s, op);
+
+    if (c->bits == NULL)
+    {
+        /* λ󽻻ֱɸ */
+        if (op == OP_AND || op == OP_ANDNOT)
+        {
+            for (i = 0; i < c->card; i++)
+            {
+                v = c->array[i];
+                if (((s->bits[v >> 6] >> (v & 63)) & 1) == (op == OP_AND))
+                    c->array[n++] = v;
+            }
+            c->card = n;
+            return 0;
+        }
+        if (container_to_bits(c) == -1)
+            return -1;
+    }
+
+    if (s->bits != NULL)
+    {
+        c->card = cur_kernels()->op[op](c->bits, s->bits, CONTAINER_WORDS);
+    }
+    else if (op == OP_AND)
+    {
+        /* sͬʱcЩsֱ࣬ӻ */
+        array = (uint16_t *)malloc((s->card > 0 ? s->card : 1) * sizeof(uint16_t));
+        if (array == NULL)
+            return -1;
+        for (i = 0; i < s->card; i++)
+        {
+            v = s->array[i];
+            if ((c->bits[v >> 6] >> (v & 63)) & 1)
+                array[n++] = v;
+        }
+        free(c->bits);
+        c->bits = NULL;
+        c->array = array;
+        c->cap = s->card > 0 ? s->card : 1;
+        c->card = n;
+        return 0;
+    }
+    else
+    {
+        for (i = 0; i < s->card; i++)
+        {
+            v = s->array[i];
+            if (op == OP_OR)
+                c->bits[v >> 6] |= 1ULL << (v & 63);
+            else if (op == OP_XOR)
+                c->bits[v >> 6] ^= 1ULL << (v & 63);
+            else
+                c->bits[v >> 6] &= ~(1ULL << (v & 63));
+        }
+        c->card = cur_kernels()->popcount(c->bits, CONTAINER_WORDS);
+    }
+    container_shrink(c);
+    return 0;
+}
+
+
+/************************************************************
+ * Roaringkeysֵĸ48λ
+ ************************************************************/
+
+/* ҸλΪkeyûʱposΪӦòλ */
+static int32_t roaring_find(const Bitmap *b, uint64_t key, uint32_t *pos)
+{
+    const uint64_t *base = b->keys;
+    uint32_t n = b->ncontainers, half;
+
+    if (b->last < n && b->keys[b->last] == key)
+    {
+        *pos = b->last;
+        return 1;
+    }
+    if (n == 0)
+    {
+        *pos = 0;
+        return 0;
+    }
+    while (n > 1)
+    {
+        half = n / 2;
+        base = base[half] < key ? base + half : base;
+        n -= half;
+    }
+    *pos = (uint32_t)(base - b->keys) + (*base < key);
+    return *pos < b->ncontainers && b->keys[*pos] == key;
+}
+
+static int32_t roaring_reserve(Bitmap *b, uint32_t n)
+{
+    BitmapContainer **containers;
+    uint32_t cap = b->capacity;
+    uint64_t *keys;
+
+    if (n <= cap)
+        return 0;
+    while (cap < n)
+        cap = cap < 8 ? 8 : cap * 2;
+    keys = (uint64_t *)realloc(b->keys, cap * sizeof(uint64_t));
+    if (keys == NULL)
+        return -1;
+    b->keys = keys;
+    containers = (BitmapContainer **)realloc(b->containers,
+                                             cap * sizeof(BitmapContainer *));
+    if (containers == NULL)
+        return -1;
+    b->containers = containers;
+    b->capacity = cap;
+    return 0;
+}
+
+static BitmapContainer* roaring_insert(Bitmap *b, uint32_t pos, uint64_t key)
+{
+    BitmapContainer *c;
+
+    if (roaring_reserve(b, b->ncontainers + 1) == -1)
+        return NULL;
+    c = (BitmapContainer *)calloc(1, sizeof(BitmapContainer));
+    if (c == NULL)
+        return NULL;
+    memmove(b->keys + pos + 1, b->keys + pos,
+            (b->ncontainers - pos) * sizeof(uint64_t));
+    memmove(b->containers + pos + 1, b->containers + pos,
+            (b->ncontainers - pos) * sizeof(BitmapContainer *));
+    b->keys[pos] = key;
+    b->containers[pos] = c;
+    b->ncontainers++;
+    return c;
+}
+
+static void roaring_remove(Bitmap *b, uint32_t pos)
+{
+    container_free(b->containers[pos]);
+    memmove(b->keys + pos, b->keys + pos + 1,
+            (b->ncontainers - pos - 1) * sizeof(uint64_t));
+    memmove(b->containers + pos, b->containers + pos + 1,
+            (b->ncontainers - pos - 1) * sizeof(BitmapContainer *));
+    b->ncontainers--;
+}
+
+/* ߰key鲢ֻһߵֱ»򶪵߶е */
+static int32_t roaring_op(Bitmap *dst, const Bitmap *src, int32_t op)
+{
+    uint32_t i = 0, j = 0, n = 0, cap = dst->ncontainers + src->ncontainers;
+    BitmapContainer **containers, *c;
+    uint64_t *keys, count = 0;
+    int32_t ret = 0;
+
+    keys = (uint64_t *)malloc((cap > 0 ? cap : 1) * sizeof(uint64_t));
+    containers = (BitmapContainer **)malloc((cap > 0 ? cap : 1) *
+                                            sizeof(BitmapContainer *));
+    if (keys == NULL || containers == NULL)
+    {
+        free(keys);
+        free(containers);
+        return -1;
+    }
+
+    while (i < dst->ncontainers || j < src->ncontainers)
+    {
+        if (j == src->ncontainers ||
+            (i < dst->ncontainers && dst->keys[i] < src->keys[j]))
+        {
+            c = dst->containers[i];
+            if (op == OP_AND)
+            {
+                container_free(c);
+                c = NULL;
+            }
+            keys[n] = dst->keys[i++];
+        }
+        else if (i == dst->ncontainers || src->keys[j] < dst->keys[i])
+        {
+            c = NULL;
+            if (op == OP_OR || op == OP_XOR)
+            {
+                c = container_copy(src->containers[j]);
+                if (c == NULL)
+                    ret = -1;
+            }
+            keys[n] = src->keys[j++];
+        }
+        else
+        {
+            c = dst->containers[i];
+            if (container_op(c, src->containers[j], op) == -1)
+                ret = -1;
+            if (c->card == 0)
+            {
+                container_free(c);
+                c = NULL;
+            }
+            keys[n] = dst->keys[i];
+            i++;
+            j++;
+        }
+        if (c != NULL)
+        {
+            containers[n++] = c;
+            count += c->card;
+        }
+    }
+
+    free(dst->keys);
+    free(dst->containers);
+    dst->keys = keys;
+    dst->containers = containers;
+    dst->ncontainers = n;
+    dst->capacity = cap > 0 ? cap : 1;
+    dst->last = 0;
+    dst->count = count;
+    return ret;
+}
+
+/* rank_index[i]ΪǰiԪ */
+static int32_t roaring_build_rank(Bitmap *b)
+{
+    uint64_t *index;
+    uint32_t i;
+
+    index = (uint64_t *)realloc(b->rank_index,
+                                (b->ncontainers + 1) * sizeof(uint64_t));
+    if (index == NULL)
+        return -1;
+    index[0] = 0;
+    for (i = 0; i < b->ncontainers; i++)
+        index[i + 1] = index[i] + b->containers[i]->card;
+    b->rank_index = index;
+    b->rank_dirty = 0;
+    return 0;
+}
+
+
+/************************************************************
+ * λ
+ ************************************************************/
+
+/* rank_index[s]Ϊǰs*4096λ1ĸ */
+static int32_t dense_build_rank(Bitmap *b)
+{
+    uint64_t nsuper = b->nwords / SUPER_WORDS + 1, s, n, *index;
+
+    index = (uint64_t *)realloc(b->rank_index, (nsuper + 1) * sizeof(uint64_t));
+    if (index == NULL)
+        return -1;
+    index[0] = 0;
+    for (s = 0; s < nsuper; s++)
+    {
+        index[s + 1] = index[s];
+        if (s * SUPER_WORDS < b->nwords)
+        {
+            n = b->nwords - s * SUPER_WORDS;
+            index[s + 1] += cur_kernels()->popcount(
+                b->words + s * SUPER_WORDS, n < SUPER_WORDS ? n : SUPER_WORDS);
+        }
+    }
+    b->rank_index = index;
+    b->rank_dirty = 0;
+    return 0;
+}
+
+static uint64_t dense_rank(Bitmap *b, uint64_t idx)
+{
+    uint64_t w = idx >> 6, s = w / SUPER_WORDS, r;
+
+    if (!b->rank_dirty || dense_build_rank(b) == 0)
+        r = b->rank_index[s] +
+            cur_kernels()->popcount(b->words + s * SUPER_WORDS,
+                                    w - s * SUPER_WORDS);
+    else
+        r = cur_kernels()->popcount(b->words, w);     /* ʹͷ */
+    if (w < b->nwords && (idx & 63))
+        r += __builtin_popcountll(b->words[w] & ((1ULL << (idx & 63)) - 1));
+    return r;
+}
+
+static uint64_t dense_select(Bitmap *b, uint64_t k)
+{
+    uint64_t nsuper = b->nwords / SUPER_WORDS + 1, lo, hi, mid, w, n, step;
+
+    if (b->rank_dirty && dense_build_rank(b) == -1)
+        return BITMAP_NONE;
+    /* һrank_index[s] <= kĳ飺һλã
+     * ٱѷΧסֲ֣ʱֻ */
+    lo = (uint64_t)((double)k / b->count * nsuper);
+    lo = lo < nsuper ? lo : nsuper - 1;
+    for (step = 1; b->rank_index[lo] > k; step *= 2)
+        lo = lo > step ? lo - step : 0;
+    for (hi = lo + 1, step = 1; hi < nsuper && b->rank_index[hi] <= k; step *= 2)
+    {
+        lo = hi;
+        hi = hi + step < nsuper ? hi + step : nsuper;
+    }
+    while (hi - lo > 1)
+    {
+        mid = (lo + hi) / 2;
+        if (b->rank_index[mid] <= k)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    k -= b->rank_index[lo];
+    for (w = lo * SUPER_WORDS; w < b->nwords; w++)
+    {
+        n = __builtin_popcountll(b->words[w]);
+        if (k < n)
+            return w * 64 + cur_select()(b->words[w], (uint32_t)k);
+        k -= n;
+    }
+    return BITMAP_NONE;
+}
+
+
+/************************************************************
+ * ӿ
+ ************************************************************/
+
+/* ֵλ± */
+static inline int32_t to_index(const Bitmap *b, uint64_t value, uint64_t *idx)
+{
+    if (value < b->base)
+        return -1;
+    *idx = value - b->base;
+    if (b->size != 0 && *idx >= b->size)
+        return -1;
+    return 0;
+}
+
+Bitmap* bitmap_create(uint64_t size, uint64_t start, int32_t mode)
+{
+    Bitmap *bitmap;
+
+    if (mode != BITMAP_DENSE && mode != BITMAP_ROARING)
+        return NULL;
+    if (mode == BITMAP_DENSE && size == 0)
+        return NULL;
+    bitmap = (Bitmap *)calloc(1, sizeof(Bitmap));
+    if (bitmap == NULL)
+        return NULL;
+    bitmap->mode = mode;
+    bitmap->base = start;
+    bitmap->size = size;
+    bitmap->rank_dirty = 1;
+    if (mode == BITMAP_DENSE)
+    {
+        bitmap->nwords = (size + 63) / 64;
+        bitmap->words = (uint64_t *)calloc(bitmap->nwords, sizeof(uint64_t));
+        if (bitmap->words == NULL)
+        {
+            free(bitmap);
+            return NULL;
+        }
+    }
+    return bitmap;
+}
+
+void bitmap_destroy(Bitmap *bitmap)
+{
+    uint32_t i;
+
+    if (bitmap == NULL)
+        return;
+    for (i = 0; i < bitmap->ncontainers; i++)
+        container_free(bitmap->containers[i]);
+    free(bitmap->containers);
+    free(bitmap->keys);
+    free(bitmap->words);
+    free(bitmap->rank_index);
+    free(bitmap);
+}
+
+Bitmap* bitmap_copy(const Bitmap *bitmap)
+{
+    Bitmap *copy = bitmap_create(bitmap->mode == BITMAP_DENSE ? bitmap->size : 0,
+                                 bitmap->base, bitmap->mode);
+    uint32_t i;
+
+    if (copy == NULL)
+        return NULL;
+    copy->size = bitmap->size;
+    copy->count = bitmap->count;
+    if (bitmap->mode == BITMAP_DENSE)
+    {
+        memcpy(copy->words, bitmap->words, bitmap->nwords * sizeof(uint64_t));
+        return copy;
+    }
+    if (roaring_reserve(copy, bitmap->ncontainers) == -1)
+        goto fail;
+    for (i = 0; i < bitmap->ncontainers; i++)
+    {
+        copy->containers[i] = container_copy(bitmap->containers[i]);
+        if (copy->containers[i] == NULL)
+            goto fail;
+        copy->keys[i] = bitmap->keys[i];
+        copy->ncontainers++;
+    }
+    return copy;
+fail:
+    bitmap_destroy(copy);
+    return NULL;
+}
+
+int32_t bitmap_set(Bitmap *bitmap, uint64_t value)
+{
+    BitmapContainer *c;
+    uint64_t idx, m;
+    uint32_t pos;
+    int32_t ret;
+
+    if (to_index(bitmap, value, &idx) == -1)
+        return -1;
+    if (bitmap->mode == BITMAP_DENSE)
+    {
+        m = 1ULL << (idx & 63);
+        if (bitmap->words[idx >> 6] & m)
+            return 0;
+        bitmap->words[idx >> 6] |= m;
+        bitmap->count++;
+        bitmap->rank_dirty = 1;
+        return 1;
+    }
+
+    if (roaring_find(bitmap, idx >> 16, &pos))
+        c = bitmap->containers[pos];
+    else if ((c = roaring_insert(bitmap, pos, idx >> 16)) == NULL)
+        return -1;
+    bitmap->last = pos;
+    ret = container_set(c, (uint16_t)idx);
+    if (ret == 1)
+    {
+        bitmap->count++;
+        bitmap->rank_dirty = 1;
+    }
+    else if (ret == -1 && c->card == 0)
+    {
+        roaring_remove(bitmap, pos);
+    }
+    return ret;
+}
+
+int32_t bitmap_clear(Bitmap *bitmap, uint64_t value)
+{
+    BitmapContainer *c;
+    uint64_t idx, m;
+    uint32_t pos;
+
+    if (to_index(bitmap, value, &idx) == -1)
+        return -1;
+    if (bitmap->mode == BITMAP_DENSE)
+    {
+        m = 1ULL << (idx & 63);
+        if (!(bitmap->words[idx >> 6] & m))
+            return 0;
+        bitmap->words[idx >> 6] &= ~m;
+        bitmap->count--;
+        bitmap->rank_dirty = 1;
+        return 1;
+    }
+
+    if (!roaring_find(bitmap, idx >> 16, &pos))
+        return 0;
+    c = bitmap->containers[pos];
+    if (container_clear(c, (uint16_t)idx) == 0)
+        return 0;
+    if (c->card == 0)
+        roaring_remove(bitmap, pos);
+    bitmap->count--;
+    bitmap->rank_dirty = 1;
+    return 1;
+}
+
+int32_t bitmap_get(const Bitmap *bitmap, uint64_t value)
+{
+    uint64_t idx;
+    uint32_t pos;
+
+    if (to_index(bitmap, value, &idx) == -1)
+        return -1;
+    if (bitmap->mode == BITMAP_DENSE)
+        return (bitmap->words[idx >> 6] >> (idx & 63)) & 1;
+    if (!roaring_find(bitmap, idx >> 16, &pos))
+        return 0;
+    return container_get(bitmap->containers[pos], (uint16_t)idx);
+}
+
+uint64_t bitmap_count(const Bitmap *bitmap)
+{
+    return bitmap->count;
+}
+
+uint64_t bitmap_rank(Bitmap *bitmap, uint64_t value)
+{
+    uint64_t idx, r = 0;
+    uint32_t pos, i;
+
+    if (value <= bitmap->base)
+        return 0;
+    idx = value - bitmap->base;
+    if (bitmap->size != 0 && idx >= bitmap->size)
+        return bitmap->count;
+    if (bitmap->mode == BITMAP_DENSE)
+        return dense_rank(bitmap, idx);
+
+    if (!bitmap->rank_dirty || roaring_build_rank(bitmap) == 0)
+    {
+        if (roaring_find(bitmap, idx >> 16, &pos))
+            return bitmap->rank_index[pos] +
+                   container_rank(bitmap->containers[pos], idx & 0xffff);
+        return bitmap->rank_index[pos];
+    }
+    /* Ͱǰĸͳܵһʧ */
+    if (roaring_find(bitmap, idx >> 16, &pos))
+        r = container_rank(bitmap->containers[pos], idx & 0xffff);
+    for (i = 0; i < pos; i++)
+        r += bitmap->containers[i]->card;
+    return r;
+}
+
+uint64_t bitmap_select(Bitmap *bitmap, uint64_t k)
+{
+    uint32_t lo = 0, hi, mid;
+    uint64_t idx;
+
+    if (k >= bitmap->count)
+        return BITMAP_NONE;
+    if (bitmap->mode == BITMAP_DENSE)
+    {
+        idx = dense_select(bitmap, k);
+        return idx == BITMAP_NONE ? BITMAP_NONE : bitmap->base + idx;
+    }
+
+    if (bitmap->rank_dirty && roaring_build_rank(bitmap) == -1)
+        return BITMAP_NONE;
+    /* һrank_index[i] <= k */
+    hi = bitmap->ncontainers;
+    while (hi - lo > 1)
+    {
+        mid = (lo + hi) / 2;
+        if (bitmap->rank_index[mid] <= k)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return bitmap->base + (bitmap->keys[lo] << 16) +
+           container_select(bitmap->containers[lo],
+                            (uint32_t)(k - bitmap->rank_index[lo]));
+}
+
+uint64_t bitmap_next(const Bitmap *bitmap, uint64_t value)
+{
+    uint64_t idx, w, word;
+    uint32_t pos;
+    int32_t low;
+
+    if (value < bitmap->base)
+        value = bitmap->base;
+    if (to_index(bitmap, value, &idx) == -1)
+        return BITMAP_NONE;
+
+    if (bitmap->mode == BITMAP_DENSE)
+    {
+        w = idx >> 6;
+        for (word = bitmap->words[w] & (~0ULL << (idx & 63)); word == 0;
+             word = bitmap->words[w])
+        {
+            if (++w == bitmap->nwords)
+                return BITMAP_NONE;
+        }
+        return bitmap->base + w * 64 + __builtin_ctzll(word);
+    }
+
+    if (roaring_find(bitmap, idx >> 16, &pos))
+    {
+        low = container_next(bitmap->containers[pos], idx & 0xffff);
+        if (low >= 0)
+            return bitmap->base + (bitmap->keys[pos] << 16) + low;
+        pos++;
+    }
+    if (pos >= bitmap->ncontainers)
+        return BITMAP_NONE;
+    return bitmap->base + (bitmap->keys[pos] << 16) +
+           container_next(bitmap->containers[pos], 0);
+}
+
+static int32_t bitmap_op(Bitmap *dst, const Bitmap *src, int32_t op)
+{
+    if (dst->mode != src->mode || dst->base != src->base)
+        return -1;
+    dst->rank_dirty = 1;
+    if (dst->mode == BITMAP_ROARING)
+        return roaring_op(dst, src, op);
+    if (dst->size != src->size)
+        return -1;
+    dst->count = cur_kernels()->op[op](dst->words, src->words, dst->nwords);
+    return 0;
+}
+
+int32_t bitmap_and(Bitmap *dst, const Bitmap *src)
+{
+    return bitmap_op(dst, src, OP_AND);
+}
+
+int32_t bitmap_or(Bitmap *dst, const Bitmap *src)
+{
+    return bitmap_op(dst, src, OP_OR);
+}
+
+int32_t bitmap_xor(Bitmap *dst, const Bitmap *src)
+{
+    return bitmap_op(dst, src, OP_XOR);
+}
+
+int32_t bitmap_andnot(Bitmap *dst, const Bitmap *src)
+{
+    return bitmap_op(dst, src, OP_ANDNOT);
+}
+
+uint64_t bitmap_memory(const Bitmap *bitmap)
+{
+    uint64_t bytes = sizeof(Bitmap) + bitmap->nwords * sizeof(uint64_t);
+    const BitmapContainer *c;
+    uint32_t i;
+
+    bytes += bitmap->capacity * (sizeof(uint64_t) + sizeof(BitmapContainer *));
+    for (i = 0; i < bitmap->ncontainers; i++)
+    {
+        c = bitmap->containers[i];
+        bytes += sizeof(BitmapContainer) +
+                 (c->bits != NULL ? CONTAINER_WORDS * sizeof(uint64_t) :
+                                    c->cap * sizeof(uint16_t));
+    }
+    return bytes;
+}
 
 
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
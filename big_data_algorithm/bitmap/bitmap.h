@@ -2,50 +2,119 @@
 extern "C"{
 #endif
 
-/* 
- *bitmapcʵ 
- */  
- 
-#ifndef _BITMAP_H_   
-#define _BITMAP_H_ 
+/*
+ *bitmapcʵ
+ *ÿbitmapһֵ64λģִ淨
+ *BITMAP_DENSE   һλ飬ʺֵȽܵ2^32ֵҪ512MB
+ *BITMAP_ROARING ֵĸ48λֿ飬ÿ65536ֵﲻ4096ֵʱ
+ *               uint16飬ٻ8KBλ飬ϡʱʡڴ
+ *rank/selectbitmapǶǰ64λģAVX2ʱAVX2
+ */
+
+#ifndef _BITMAP_H_
+#define _BITMAP_H_
 
 #include <stdint.h>
-  
-/* 
- *ܣʼbitmap 
- * 
- *sizebitmapĴСbitλĸ 
- *startʼֵ 
- *ֵ0ʾʧܣ1ʾɹ 
- */  
-int32_t bitmap_init(int32_t size, int32_t start);  
-  
-/* 
- *ܣֵindexĶӦλΪ1 
- *index:Ҫֵ 
- *ֵ0ʾʧܣ1ʾɹ 
- */  
-int32_t bitmap_set(int32_t index);  
-  
-/* 
- *ܣȡbitmapiλֵ 
- *iȡλ 
- *ֵ-1ʾʧܣ򷵻ضӦλֵ 
- */  
-int32_t bitmap_get(int32_t i);  
-  
-/* 
- *ܣindexλӦֵ 
- */  
-int32_t bitmap_data(int32_t index);  
-  
-/*ͷڴ*/  
-int32_t bitmap_free();  
 
+#define BITMAP_DENSE        0
+#define BITMAP_ROARING      1
+
+#define BITMAP_NONE         UINT64_MAX  /* select/nextûнʱ */
+
+/* õʵ */
+#define BITMAP_SCALAR       0
+#define BITMAP_POPCNT       1
+#define BITMAP_AVX2         2
+
+struct BitmapContainer;
+
+typedef struct Bitmap{
+    int32_t mode;
+    uint64_t base;          /* ʼֵiλʾֵbase+i */
+    uint64_t size;          /* ܷŵֵĸ */
+    uint64_t count;         /* λĸ */
+
+    /* BITMAP_DENSE */
+    uint64_t *words;
+    uint64_t nwords;
+
+    /* BITMAP_ROARINGkeys */
+    uint64_t *keys;
+    struct BitmapContainer **containers;
+    uint32_t ncontainers;
+    uint32_t capacity;
+    uint32_t last;          /* ϴηʵ˳ʱö */
+
+    /* rank/select޸ĺϣõʱٽ */
+    uint64_t *rank_index;
+    int32_t rank_dirty;
+} Bitmap;
+
+/*
+ *ܣbitmap
+ *
+ *sizeܷŵֵĸBITMAP_ROARINGʱΪ0ʾ
+ *startʼֵ
+ *modeBITMAP_DENSEBITMAP_ROARING
+ *ֵNULLʾʧ
+ */
+Bitmap* bitmap_create(uint64_t size, uint64_t start, int32_t mode);
+
+/*ͷ*/
+void bitmap_destroy(Bitmap *bitmap);
+
+/*һݣʧܷNULL*/
+Bitmap* bitmap_copy(const Bitmap *bitmap);
+
+/*
+ *ܣֵvalueĶӦλΪ1
+ *ֵ1ʾԭ00ʾԭ1-1ʾΧڴ治
+ */
+int32_t bitmap_set(Bitmap *bitmap, uint64_t value);
+
+/*
+ *ܣֵvalueĶӦλ0
+ *ֵ1ʾԭ10ʾԭ0-1ʾΧ
+ */
+int32_t bitmap_clear(Bitmap *bitmap, uint64_t value);
+
+/*
+ *ܣȡֵvalueӦλ
+ *ֵ-1ʾΧ򷵻ضӦλֵ
+ */
+int32_t bitmap_get(const Bitmap *bitmap, uint64_t value);
+
+/*λĸ*/
+uint64_t bitmap_count(const Bitmap *bitmap);
+
+/*Сvalueֵмλʱֱʧ*/
+uint64_t bitmap_rank(Bitmap *bitmap, uint64_t value);
+
+/*Сk(0ʼ)λֵûлڴ治BITMAP_NONE*/
+uint64_t bitmap_select(Bitmap *bitmap, uint64_t k);
+
+/*СvalueĵһλֵûзBITMAP_NONE*/
+uint64_t bitmap_next(const Bitmap *bitmap, uint64_t value);
+
+/*
+ *ܣ㣬dst
+ *bitmapmodestartҪͬBITMAP_DENSEʱsizeҲҪͬ
+ *ֵ0ɹ-1ʧ
+ */
+int32_t bitmap_and(Bitmap *dst, const Bitmap *src);
+int32_t bitmap_or(Bitmap *dst, const Bitmap *src);
+int32_t bitmap_xor(Bitmap *dst, const Bitmap *src);
+int32_t bitmap_andnot(Bitmap *dst, const Bitmap *src);
+
+/*ռõڴֽ*/
+uint64_t bitmap_memory(const Bitmap *bitmap);
+
+/*ǰõʵ֣ǿø͵()ʵõ*/
+int32_t bitmap_simd_level(void);
+int32_t bitmap_set_simd_level(int32_t level);
 
 #endif
 
 #ifdef __cplusplus
 }
 #endif
-
@@ -0,0 +1,186 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/* bitmapȥزԣ
+ * 0..2^32-1ȡnID(ظ)ֱŽbitmap(512MB)ѹbitmap
+ * Ƚλʱȥغrank/selectʱڴ棬
+ * ȡһIDǣʵֵ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include "bitmap.h"
+
+#define ID_RANGE        (1ULL << 32)
+#define QUERIES         1000000
+
+static uint64_t nids = 100000000;
+static int32_t skip_dense = 0;
+
+static double now_sec(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static inline uint64_t xorshift(uint64_t *s){
+    uint64_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *s = x;
+}
+
+/* IDͬһһ */
+static Bitmap* load(int32_t mode, uint64_t seed, uint64_t n, const char *what){
+    Bitmap *bitmap = bitmap_create(mode == BITMAP_DENSE ? ID_RANGE : 0, 0, mode);
+    uint64_t i;
+    double t;
+
+    if (bitmap == NULL)
+    {
+        fprintf(stderr, "can not create %s bitmap\n", what);
+        return NULL;
+    }
+    t = now_sec();
+    for (i = 0; i < n; i++)
+    {
+        if (bitmap_set(bitmap, xorshift(&seed) >> 32) == -1)
+        {
+            fprintf(stderr, "set failed\n");
+            bitmap_destroy(bitmap);
+            return NULL;
+        }
+    }
+    t = now_sec() - t;
+    printf("%-8s set %6.1f ns, %lu unique of %lu, memory %lu MB\n", what,
+           t * 1e9 / n, (unsigned long)bitmap_count(bitmap), (unsigned long)n,
+           (unsigned long)(bitmap_memory(bitmap) >> 20));
+    return bitmap;
+}
+
+static void bench_query(Bitmap *bitmap, const char *what){
+    uint64_t seed = 0x9e3779b97f4a7c15ULL, count = bitmap_count(bitmap);
+    uint64_t i, sum = 0;
+    double t, t_first, t_rank, t_select, t_get;
+
+    if (count == 0)
+        return;
+    /* һrankҪ */
+    t_first = now_sec();
+    sum += bitmap_rank(bitmap, ID_RANGE / 2);
+    t_first = now_sec() - t_first;
+
+    t = now_sec();
+    for (i = 0; i < QUERIES; i++)
+        sum += bitmap_rank(bitmap, xorshift(&seed) >> 32);
+    t_rank = now_sec() - t;
+
+    t = now_sec();
+    for (i = 0; i < QUERIES; i++)
+        sum += bitmap_select(bitmap, xorshift(&seed) % count);
+    t_select = now_sec() - t;
+
+    t = now_sec();
+    for (i = 0; i < QUERIES; i++)
+        sum += bitmap_get(bitmap, xorshift(&seed) >> 32);
+    t_get = now_sec() - t;
+
+    printf("%-8s index %.1f ms, rank %6.1f ns, select %6.1f ns, get %6.1f ns%s\n",
+           what, t_first * 1e3, t_rank * 1e9 / QUERIES, t_select * 1e9 / QUERIES,
+           t_get * 1e9 / QUERIES, sum == 1 ? " " : "");
+}
+
+/* ÿǰһaƲʱʵĸӦһ */
+static int32_t bench_ops(const Bitmap *a, const Bitmap *b, const char *what){
+    typedef int32_t (*op_fn)(Bitmap *, const Bitmap *);
+    static const op_fn ops[] = {bitmap_or, bitmap_and, bitmap_xor, bitmap_andnot};
+    static const char *names[] = {"or", "and", "xor", "andnot"};
+    static const char *levels[] = {"scalar", "popcnt", "avx2"};
+    int32_t level, max = bitmap_simd_level(), j;
+    uint64_t counts[4];
+    Bitmap *c;
+    double t;
+
+    for (level = BITMAP_SCALAR; level <= max; level++)
+    {
+        bitmap_set_simd_level(level);
+        printf("%-8s %-7s", what, levels[level]);
+        for (j = 0; j < 4; j++)
+        {
+            c = bitmap_copy(a);
+            if (c == NULL)
+            {
+                printf("\n");
+                return -1;
+            }
+            t = now_sec();
+            ops[j](c, b);
+            t = now_sec() - t;
+            printf(" %s %6.1f ms", names[j], t * 1e3);
+            if (level == BITMAP_SCALAR)
+                counts[j] = bitmap_count(c);
+            else if (counts[j] != bitmap_count(c))
+                printf(" WRONG");
+            bitmap_destroy(c);
+        }
+        printf("\n");
+    }
+    bitmap_set_simd_level(max);
+    printf("%-8s counts  or %lu, and %lu, xor %lu, andnot %lu\n", what,
+           (unsigned long)counts[0], (unsigned long)counts[1],
+           (unsigned long)counts[2], (unsigned long)counts[3]);
+    return 0;
+}
+
+static int32_t run(int32_t mode, const char *what){
+    Bitmap *a, *b;
+    int32_t ret = -1;
+
+    a = load(mode, 88172645463325252ULL, nids, what);
+    if (a == NULL)
+        return -1;
+    bench_query(a, what);
+    b = load(mode, 0x2545f4914f6cdd1dULL, nids / 2, what);
+    if (b != NULL)
+        ret = bench_ops(a, b, what);
+    bitmap_destroy(a);
+    bitmap_destroy(b);
+    return ret;
+}
+
+static void usage(char *name){
+    fprintf(stderr, "Usage: %s [-n ids] [-r]\n"
+            "  -n     number of IDs drawn from 0..2^32-1 (default 100M)\n"
+            "  -r     roaring only, skip the 512MB dense bitmap\n", name);
+    exit(EXIT_FAILURE);
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    int32_t opt, ret = 0;
+
+    while ((opt = getopt(argc, argv, "n:rh")) != -1) {
+        switch (opt) {
+        case 'n': nids = strtoull(optarg, NULL, 0); break;
+        case 'r': skip_dense = 1; break;
+        default: usage(argv[0]);
+        }
+    }
+    if (nids < 2)
+        usage(argv[0]);
+
+    printf("simd level %d\n", bitmap_simd_level());
+    if (!skip_dense && run(BITMAP_DENSE, "dense") != 0)
+        ret = 1;
+    if (run(BITMAP_ROARING, "roaring") != 0)
+        ret = 1;
+    return ret;
+}
+
+#ifdef __cplusplus
+}
+#endif
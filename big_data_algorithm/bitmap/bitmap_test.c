@@ -3,27 +3,167 @@ extern "C"{
 #endif
 
 #include <stdint.h> /* uint64_t*/
-#include <stdio.h>   
-#include "bitmap.h"   
-  
-int32_t main()  
-{  
-    int32_t a[] = {5,8,7,6,3,1,10,78,56,34,23,12,43,54,65,76,87,98,89,100};  
-    int32_t i;  
-    bitmap_init(100, 0);  
-    for(i=0; i<20; i++)  
-        bitmap_set(a[i]);  
-    for(i=0; i<100; i++)  
-    {  
-        if(bitmap_get(i) > 0 )  
-            printf("%d ", bitmap_data(i));  
-    }  
-    printf("/n");  
-    bitmap_free();  
-    return 0;  
-}  
+#include <stdio.h>
+#include <stdlib.h>
+#include "bitmap.h"
+
+#define CHECK_RANGE     (1 << 22)   /* 64ǰһϡһ */
+
+static uint64_t seed = 88172645463325252ULL;
+
+static uint64_t xorshift(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+/* һֵһϡ裬һֺܣõ */
+static uint64_t random_value(void)
+{
+    uint64_t r = xorshift();
+
+    if (r & 1)
+        return (r >> 8) % (CHECK_RANGE / 2);
+    return CHECK_RANGE / 2 + ((r >> 8) % 32) * 65536 + ((r >> 32) % 16);
+}
+
+/* ͬĲֱڳܺѹbitmapϣӦһģһ */
+static int32_t check_same(Bitmap *dense, Bitmap *roaring, const char *what)
+{
+    uint64_t v, k, bad = 0;
+    int32_t i;
+
+    if (bitmap_count(dense) != bitmap_count(roaring))
+        bad++;
+    for (v = bitmap_next(dense, 0), k = 0; v != BITMAP_NONE;
+         v = bitmap_next(dense, v + 1), k++)
+    {
+        if (bitmap_get(roaring, v) != 1 || bitmap_select(roaring, k) != v ||
+            bitmap_select(dense, k) != v || bitmap_rank(roaring, v) != k)
+            bad++;
+    }
+    if (k != bitmap_count(dense))
+        bad++;
+    for (i = 0; i < 10000; i++)
+    {
+        v = xorshift() % (CHECK_RANGE + 1);
+        if (bitmap_rank(dense, v) != bitmap_rank(roaring, v) ||
+            bitmap_next(dense, v) != bitmap_next(roaring, v) ||
+            (v < CHECK_RANGE && bitmap_get(dense, v) != bitmap_get(roaring, v)))
+            bad++;
+    }
+    printf("%-8s count %8lu, dense %7lu bytes, roaring %7lu bytes, %s\n", what,
+           (unsigned long)bitmap_count(dense),
+           (unsigned long)bitmap_memory(dense),
+           (unsigned long)bitmap_memory(roaring), bad == 0 ? "ok" : "WRONG");
+    return bad == 0 ? 0 : -1;
+}
+
+static void fill(Bitmap *dense, Bitmap *roaring, int32_t n)
+{
+    uint64_t v;
+    int32_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        v = random_value();
+        bitmap_set(dense, v);
+        bitmap_set(roaring, v);
+    }
+}
+
+static int32_t check_ops(void)
+{
+    typedef int32_t (*op_fn)(Bitmap *, const Bitmap *);
+    static const op_fn ops[] = {bitmap_and, bitmap_or, bitmap_xor, bitmap_andnot};
+    static const char *names[] = {"and", "or", "xor", "andnot"};
+    Bitmap *da, *db, *ra, *rb;
+    int32_t i, j, ret = 0;
+    uint64_t v;
+
+    da = bitmap_create(CHECK_RANGE, 0, BITMAP_DENSE);
+    ra = bitmap_create(0, 0, BITMAP_ROARING);
+    fill(da, ra, 300000);
+    ret |= check_same(da, ra, "set");
+
+    for (i = 0; i < 100000; i++)
+    {
+        v = random_value();
+        if (bitmap_clear(da, v) != bitmap_clear(ra, v))
+            ret = -1;
+    }
+    ret |= check_same(da, ra, "clear");
+
+    db = bitmap_create(CHECK_RANGE, 0, BITMAP_DENSE);
+    rb = bitmap_create(0, 0, BITMAP_ROARING);
+    fill(db, rb, 200000);
+    for (j = 0; j < 4; j++)
+    {
+        Bitmap *dc = bitmap_copy(da), *rc = bitmap_copy(ra);
+
+        ops[j](dc, db);
+        ops[j](rc, rb);
+        ret |= check_same(dc, rc, names[j]);
+        bitmap_destroy(dc);
+        bitmap_destroy(rc);
+    }
+
+    /* ģʽͬ */
+    if (bitmap_and(da, rb) != -1)
+        ret = -1;
+    bitmap_destroy(da);
+    bitmap_destroy(db);
+    bitmap_destroy(ra);
+    bitmap_destroy(rb);
+    return ret;
+}
+
+int32_t main()
+{
+    int32_t a[] = {5,8,7,6,3,1,10,78,56,34,23,12,43,54,65,76,87,98,89,100};
+    Bitmap *bitmap;
+    uint64_t v;
+    int32_t i;
+
+    bitmap = bitmap_create(100, 0, BITMAP_DENSE);
+    for(i=0; i<20; i++)
+        bitmap_set(bitmap, a[i]);
+    for (v = bitmap_next(bitmap, 0); v != BITMAP_NONE; v = bitmap_next(bitmap, v + 1))
+        printf("%lu ", (unsigned long)v);
+    printf("\n");
+    /* 100Χ */
+    printf("count %lu, rank(50) %lu, select(10) %lu\n",
+           (unsigned long)bitmap_count(bitmap),
+           (unsigned long)bitmap_rank(bitmap, 50),
+           (unsigned long)bitmap_select(bitmap, 10));
+    bitmap_destroy(bitmap);
+
+    /* 64λֵ */
+    bitmap = bitmap_create(0, 0, BITMAP_ROARING);
+    bitmap_set(bitmap, 1ULL << 40);
+    bitmap_set(bitmap, UINT64_MAX - 1);
+    bitmap_set(bitmap, 7);
+    printf("roaring: %lu %lu %lu, rank(2^40) %lu\n",
+           (unsigned long)bitmap_select(bitmap, 0),
+           (unsigned long)bitmap_select(bitmap, 1),
+           (unsigned long)bitmap_select(bitmap, 2),
+           (unsigned long)bitmap_rank(bitmap, 1ULL << 40));
+    bitmap_destroy(bitmap);
+
+    for (i = BITMAP_AVX2; i >= BITMAP_SCALAR; i--)
+    {
+        if (bitmap_set_simd_level(i) != i)
+            continue;
+        printf("simd level %d\n", i);
+        if (check_ops() != 0)
+            return 1;
+    }
+    return 0;
+}
 
 
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
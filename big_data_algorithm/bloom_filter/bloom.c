@@ -0,0 +1,710 @@
+/*******************************************************************************
+*
+* bloom.c -- Bloom filter sized at run time, see bloom.h
+*
+*******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "bloom.h"
+
+#define BLOCK_WORDS	(BLOOM_BLOCK_BITS / 64)
+#define BLOCK_BYTES	(BLOOM_BLOCK_BITS / 8)
+#define PREFETCH_AHEAD	8
+#define DROP_CHUNK	(64 << 20)	/* bloom_each_line drops pages this far behind */
+
+#define BLOOM_MAGIC	"BLOOMF1"
+#define SCALABLE_MAGIC	"BLOOMS1"
+
+/* file header of one filter, the cells follow 64-byte aligned */
+struct bloom_header {
+	char magic[8];
+	uint32_t type;
+	uint32_t k;
+	uint64_t nbits;
+	uint64_t nblocks;
+	uint64_t count;
+	uint64_t capacity;
+	uint64_t seed;
+	char hash_name[16];
+	char pad[56];
+};
+
+/* file header of a scalable filter, its sub-filters follow one by one */
+struct scalable_header {
+	char magic[8];
+	uint32_t type;
+	int32_t nfilters;
+	uint64_t n;
+	double p;
+	uint64_t count;
+	uint64_t seed;
+	char hash_name[16];
+};
+
+typedef char bloom_header_size[sizeof(struct bloom_header) == 128 ? 1 : -1];
+typedef char scalable_header_size[sizeof(struct scalable_header) == 64 ? 1 : -1];
+
+/* splitmix64 finalizer, gives the second hash of the double hashing */
+static inline uint64_t mix64(uint64_t x)
+{
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+	return x;
+}
+
+/* maps x to [0, n) with a multiply instead of a modulo */
+static inline uint64_t reduce(uint64_t x, uint64_t n)
+{
+	return (uint64_t)(((unsigned __int128)x * n) >> 64);
+}
+
+static double standard_fpp(uint64_t n, uint64_t m, int k)
+{
+	return pow(1 - exp(-(double)k * n / m), k);
+}
+
+/* the keys per block follow a Poisson distribution with mean n / nblocks,
+ * sum the false positive rate of a 512-bit filter over it */
+static double blocked_fpp(uint64_t n, uint64_t nblocks, int k)
+{
+	double lambda = (double)n / nblocks, fpp = 0, p, inner;
+	uint64_t i, last = (uint64_t)(lambda + 10 * sqrt(lambda) + 20);
+
+	for (i = 0; i <= last; i++) {
+		p = exp(-lambda + i * log(lambda) - lgamma(i + 1.0));
+		inner = pow(1 - pow(1 - 1.0 / BLOOM_BLOCK_BITS, (double)k * i), k);
+		fpp += p * inner;
+	}
+	return fpp;
+}
+
+static inline unsigned counter_get(const bloom_t *bloom, uint64_t i)
+{
+	const uint8_t *c = (const uint8_t *)bloom->bits;
+
+	return (c[i >> 1] >> ((i & 1) * 4)) & 0xf;
+}
+
+static inline void counter_add(bloom_t *bloom, uint64_t i, int d)
+{
+	uint8_t *c = (uint8_t *)bloom->bits;
+
+	if (d > 0)
+		c[i >> 1] += 1 << ((i & 1) * 4);
+	else
+		c[i >> 1] -= 1 << ((i & 1) * 4);
+}
+
+bloom_t *bloom_create(uint64_t n, double p, int type)
+{
+	bloom_t *bloom;
+	double m;
+	int k;
+
+	if (n == 0 || !(p > 0 && p < 1) ||
+	    (type != BLOOM_STANDARD && type != BLOOM_BLOCKED &&
+	     type != BLOOM_COUNTING))
+		return NULL;
+	bloom = calloc(1, sizeof(bloom_t));
+	if (!bloom)
+		return NULL;
+
+	m = ceil(-(double)n * log(p) / (M_LN2 * M_LN2));
+	k = (int)(m / n * M_LN2 + 0.5);
+	k = k < 1 ? 1 : k > BLOOM_MAX_HASHES ? BLOOM_MAX_HASHES : k;
+	bloom->k = k;
+	bloom->type = type;
+	bloom->capacity = n;
+	bloom->hash = WyHash64;
+	strcpy(bloom->hash_name, "wyhash");
+
+	bloom->nblocks = (uint64_t)ceil(m / BLOOM_BLOCK_BITS);
+	if (type == BLOOM_BLOCKED) {
+		while (blocked_fpp(n, bloom->nblocks, k) > p)
+			bloom->nblocks += bloom->nblocks / 32 + 1;
+	}
+	bloom->nbits = bloom->nblocks * BLOOM_BLOCK_BITS;
+	if (type != BLOOM_BLOCKED)
+		bloom->nbits = ((uint64_t)m + 63) & ~63ULL;
+	if (type == BLOOM_COUNTING)
+		bloom->nblocks = (bloom->nbits * 4 + BLOOM_BLOCK_BITS - 1) /
+				 BLOOM_BLOCK_BITS;
+
+	if (posix_memalign((void **)&bloom->bits, 64,
+	    bloom->nblocks * BLOCK_BYTES) != 0) {
+		free(bloom);
+		return NULL;
+	}
+	memset(bloom->bits, 0, bloom->nblocks * BLOCK_BYTES);
+	return bloom;
+}
+
+void bloom_destroy(bloom_t *bloom)
+{
+	if (!bloom)
+		return;
+	if (!bloom->mapped)
+		free(bloom->bits);
+	if (bloom->map)
+		munmap(bloom->map, bloom->map_len);
+	free(bloom);
+}
+
+int bloom_set_hash(bloom_t *bloom, const char *name, uint64_t seed)
+{
+	const HashFunc *f = hashfn_lookup(name);
+
+	if (!f || bloom->count > 0 || strlen(name) >= sizeof(bloom->hash_name))
+		return -1;
+	bloom->hash = f->fn;
+	bloom->seed = seed;
+	/* reduce() takes the high bits, a 32-bit result has to be spread */
+	bloom->mix = f->bits < 64;
+	strcpy(bloom->hash_name, name);
+	return 0;
+}
+
+/* the k probes of a blocked filter as a mask over its block */
+static inline void block_mask(uint64_t mask[BLOCK_WORDS], uint64_t h, int k)
+{
+	uint64_t g = mix64(h);
+	uint32_t a = (uint32_t)g, s = (uint32_t)(g >> 32) | 1, pos;
+	int i;
+
+	memset(mask, 0, BLOCK_WORDS * sizeof(uint64_t));
+	for (i = 0; i < k; i++) {
+		pos = a >> 23;
+		mask[pos >> 6] |= 1ULL << (pos & 63);
+		a += s;
+	}
+}
+
+void bloom_add_hash(bloom_t *bloom, uint64_t h)
+{
+	uint64_t mask[BLOCK_WORDS], *block, h2, cell;
+	int i;
+
+	bloom->count++;
+	if (bloom->type == BLOOM_BLOCKED) {
+		block = bloom->bits + reduce(h, bloom->nblocks) * BLOCK_WORDS;
+		block_mask(mask, h, bloom->k);
+		for (i = 0; i < BLOCK_WORDS; i++)
+			block[i] |= mask[i];
+		return;
+	}
+	h2 = mix64(h) | 1;
+	for (i = 0; i < bloom->k; i++) {
+		cell = reduce(h, bloom->nbits);
+		if (bloom->type == BLOOM_STANDARD)
+			bloom->bits[cell >> 6] |= 1ULL << (cell & 63);
+		else if (counter_get(bloom, cell) < BLOOM_COUNTER_MAX)
+			counter_add(bloom, cell, 1);
+		h += h2;
+	}
+}
+
+int bloom_check_hash(const bloom_t *bloom, uint64_t h)
+{
+	uint64_t mask[BLOCK_WORDS], *block, h2, cell, miss = 0;
+	int i;
+
+	if (bloom->type == BLOOM_BLOCKED) {
+		block = bloom->bits + reduce(h, bloom->nblocks) * BLOCK_WORDS;
+		block_mask(mask, h, bloom->k);
+		for (i = 0; i < BLOCK_WORDS; i++)
+			miss |= mask[i] & ~block[i];
+		return miss == 0;
+	}
+	h2 = mix64(h) | 1;
+	for (i = 0; i < bloom->k; i++) {
+		cell = reduce(h, bloom->nbits);
+		if (bloom->type == BLOOM_STANDARD ?
+		    !(bloom->bits[cell >> 6] & (1ULL << (cell & 63))) :
+		    counter_get(bloom, cell) == 0)
+			return 0;
+		h += h2;
+	}
+	return 1;
+}
+
+static inline void prefetch_hash(const bloom_t *bloom, uint64_t h)
+{
+	uint64_t h2, cell;
+	int i;
+
+	if (bloom->type == BLOOM_BLOCKED) {
+		__builtin_prefetch(bloom->bits +
+				   reduce(h, bloom->nblocks) * BLOCK_WORDS, 1);
+		return;
+	}
+	h2 = mix64(h) | 1;
+	for (i = 0; i < bloom->k; i++) {
+		cell = reduce(h, bloom->nbits);
+		if (bloom->type == BLOOM_STANDARD)
+			__builtin_prefetch(bloom->bits + (cell >> 6), 1);
+		else
+			__builtin_prefetch((uint8_t *)bloom->bits + (cell >> 1), 1);
+		h += h2;
+	}
+}
+
+void bloom_add_hashes(bloom_t *bloom, const uint64_t *h, size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n && i < PREFETCH_AHEAD; i++)
+		prefetch_hash(bloom, h[i]);
+	for (i = 0; i < n; i++) {
+		if (i + PREFETCH_AHEAD < n)
+			prefetch_hash(bloom, h[i + PREFETCH_AHEAD]);
+		bloom_add_hash(bloom, h[i]);
+	}
+}
+
+uint64_t bloom_hash(const bloom_t *bloom, const void *key, size_t len)
+{
+	uint64_t h = bloom->hash(key, len, bloom->seed);
+
+	return bloom->mix ? mix64(h) : h;
+}
+
+void bloom_add(bloom_t *bloom, const void *key, size_t len)
+{
+	bloom_add_hash(bloom, bloom_hash(bloom, key, len));
+}
+
+int bloom_check(const bloom_t *bloom, const void *key, size_t len)
+{
+	return bloom_check_hash(bloom, bloom_hash(bloom, key, len));
+}
+
+int bloom_remove(bloom_t *bloom, const void *key, size_t len)
+{
+	uint64_t h, h2, cell;
+	unsigned c;
+	int i;
+
+	if (bloom->type != BLOOM_COUNTING)
+		return -1;
+	h = bloom_hash(bloom, key, len);
+	if (!bloom_check_hash(bloom, h))
+		return 0;
+	h2 = mix64(h) | 1;
+	for (i = 0; i < bloom->k; i++) {
+		cell = reduce(h, bloom->nbits);
+		c = counter_get(bloom, cell);
+		/* a saturated counter no longer knows how many keys it holds */
+		if (c > 0 && c < BLOOM_COUNTER_MAX)
+			counter_add(bloom, cell, -1);
+		h += h2;
+	}
+	bloom->count--;
+	return 1;
+}
+
+double bloom_fpp(const bloom_t *bloom)
+{
+	if (bloom->count == 0)
+		return 0;
+	if (bloom->type == BLOOM_BLOCKED)
+		return blocked_fpp(bloom->count, bloom->nblocks, bloom->k);
+	return standard_fpp(bloom->count, bloom->nbits, bloom->k);
+}
+
+uint64_t bloom_memory(const bloom_t *bloom)
+{
+	return bloom->nblocks * BLOCK_BYTES;
+}
+
+/*
+ * files
+ */
+
+static int write_filter(FILE *fp, const bloom_t *bloom)
+{
+	struct bloom_header h;
+
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, BLOOM_MAGIC, sizeof(h.magic));
+	h.type = bloom->type;
+	h.k = bloom->k;
+	h.nbits = bloom->nbits;
+	h.nblocks = bloom->nblocks;
+	h.count = bloom->count;
+	h.capacity = bloom->capacity;
+	h.seed = bloom->seed;
+	memcpy(h.hash_name, bloom->hash_name, sizeof(h.hash_name));
+	if (fwrite(&h, sizeof(h), 1, fp) != 1 ||
+	    fwrite(bloom->bits, BLOCK_BYTES, bloom->nblocks, fp) != bloom->nblocks)
+		return -1;
+	return 0;
+}
+
+/* a filter over an image in memory; *used is the image size */
+static bloom_t *view_filter(char *base, size_t len, size_t *used)
+{
+	struct bloom_header *h = (struct bloom_header *)base;
+	uint64_t cells;
+	bloom_t *bloom;
+
+	if (len < sizeof(*h) || memcmp(h->magic, BLOOM_MAGIC, sizeof(h->magic)) ||
+	    h->type > BLOOM_COUNTING || h->k < 1 || h->k > BLOOM_MAX_HASHES ||
+	    h->hash_name[sizeof(h->hash_name) - 1] != 0 ||
+	    h->nblocks > (len - sizeof(*h)) / BLOCK_BYTES)
+		return NULL;
+	/* divide rather than multiply nbits by 4, a crafted nbits could wrap */
+	cells = h->nblocks * BLOOM_BLOCK_BITS;
+	if (h->type == BLOOM_COUNTING)
+		cells /= 4;
+	if (h->nbits == 0 || h->nbits > cells ||
+	    (h->type == BLOOM_BLOCKED &&
+	     h->nbits != h->nblocks * BLOOM_BLOCK_BITS))
+		return NULL;
+	bloom = calloc(1, sizeof(bloom_t));
+	if (!bloom)
+		return NULL;
+	bloom->type = h->type;
+	bloom->k = h->k;
+	bloom->nbits = h->nbits;
+	bloom->nblocks = h->nblocks;
+	bloom->capacity = h->capacity;
+	bloom->bits = (uint64_t *)(base + sizeof(*h));
+	bloom->mapped = 1;
+	if (bloom_set_hash(bloom, h->hash_name, h->seed) == -1) {
+		free(bloom);
+		return NULL;
+	}
+	bloom->count = h->count;
+	*used = sizeof(*h) + h->nblocks * BLOCK_BYTES;
+	return bloom;
+}
+
+/* private read-write mapping: changes never reach the file */
+static char *map_file(const char *path, size_t *len)
+{
+	struct stat st;
+	char *base;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+	if (fstat(fd, &st) < 0 || st.st_size == 0) {
+		close(fd);
+		return NULL;
+	}
+	base = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED)
+		return NULL;
+	*len = st.st_size;
+	return base;
+}
+
+int bloom_save(const bloom_t *bloom, const char *path)
+{
+	FILE *fp = fopen(path, "wb");
+	int ret;
+
+	if (!fp)
+		return -1;
+	ret = write_filter(fp, bloom);
+	if (fclose(fp) != 0)
+		ret = -1;
+	return ret;
+}
+
+bloom_t *bloom_open(const char *path)
+{
+	bloom_t *bloom;
+	size_t len, used;
+	char *base;
+
+	base = map_file(path, &len);
+	if (!base)
+		return NULL;
+	bloom = view_filter(base, len, &used);
+	if (!bloom) {
+		munmap(base, len);
+		return NULL;
+	}
+	bloom->map = base;
+	bloom->map_len = len;
+	return bloom;
+}
+
+/*
+ * scalable filter
+ */
+
+/* sub-filter i takes n * GROWTH^i keys at rate p * (1 - r) * r^i, which
+ * sums to less than p over the chain */
+static int scalable_grow(bloom_scalable_t *sbf)
+{
+	int i = sbf->nfilters;
+	bloom_t **filters;
+	bloom_t *bloom;
+
+	if (sbf->nfilters == sbf->cap) {
+		filters = realloc(sbf->filters,
+				  (sbf->cap ? sbf->cap * 2 : 8) * sizeof(bloom_t *));
+		if (!filters)
+			return -1;
+		sbf->filters = filters;
+		sbf->cap = sbf->cap ? sbf->cap * 2 : 8;
+	}
+	bloom = bloom_create(sbf->n * (uint64_t)pow(BLOOM_SCALE_GROWTH, i),
+			     sbf->p * (1 - BLOOM_SCALE_TIGHTEN) *
+			     pow(BLOOM_SCALE_TIGHTEN, i), sbf->type);
+	if (!bloom)
+		return -1;
+	if (bloom_set_hash(bloom, sbf->hash_name, sbf->seed) == -1) {
+		bloom_destroy(bloom);
+		return -1;
+	}
+	sbf->filters[sbf->nfilters++] = bloom;
+	return 0;
+}
+
+bloom_scalable_t *bloom_scalable_create(uint64_t n, double p, int type)
+{
+	bloom_scalable_t *sbf;
+
+	if (type == BLOOM_COUNTING)
+		return NULL;
+	sbf = calloc(1, sizeof(bloom_scalable_t));
+	if (!sbf)
+		return NULL;
+	sbf->type = type;
+	sbf->n = n;
+	sbf->p = p;
+	strcpy(sbf->hash_name, "wyhash");
+	if (scalable_grow(sbf) == -1) {
+		bloom_scalable_destroy(sbf);
+		return NULL;
+	}
+	return sbf;
+}
+
+void bloom_scalable_destroy(bloom_scalable_t *sbf)
+{
+	int i;
+
+	if (!sbf)
+		return;
+	for (i = 0; i < sbf->nfilters; i++)
+		bloom_destroy(sbf->filters[i]);
+	free(sbf->filters);
+	if (sbf->map)
+		munmap(sbf->map, sbf->map_len);
+	free(sbf);
+}
+
+int bloom_scalable_set_hash(bloom_scalable_t *sbf, const char *name,
+			    uint64_t seed)
+{
+	/* only the first sub-filter exists while the chain is empty */
+	if (sbf->count > 0 || sbf->nfilters != 1 ||
+	    bloom_set_hash(sbf->filters[0], name, seed) == -1)
+		return -1;
+	sbf->seed = seed;
+	strcpy(sbf->hash_name, name);
+	return 0;
+}
+
+static int scalable_check_hash(const bloom_scalable_t *sbf, uint64_t h)
+{
+	int i;
+
+	/* the newest filter is the largest, look there first */
+	for (i = sbf->nfilters - 1; i >= 0; i--)
+		if (bloom_check_hash(sbf->filters[i], h))
+			return 1;
+	return 0;
+}
+
+int bloom_scalable_check(const bloom_scalable_t *sbf, const void *key,
+			 size_t len)
+{
+	return scalable_check_hash(sbf, bloom_hash(sbf->filters[0], key, len));
+}
+
+/* all sub-filters use the same hash, one is enough for check and add */
+int bloom_scalable_add(bloom_scalable_t *sbf, const void *key, size_t len)
+{
+	uint64_t h = bloom_hash(sbf->filters[0], key, len);
+	bloom_t *last;
+
+	if (scalable_check_hash(sbf, h))
+		return 0;
+	last = sbf->filters[sbf->nfilters - 1];
+	if (last->count >= last->capacity) {
+		if (scalable_grow(sbf) == -1)
+			return -1;
+		last = sbf->filters[sbf->nfilters - 1];
+	}
+	bloom_add_hash(last, h);
+	sbf->count++;
+	return 1;
+}
+
+double bloom_scalable_fpp(const bloom_scalable_t *sbf)
+{
+	double pass = 1;
+	int i;
+
+	for (i = 0; i < sbf->nfilters; i++)
+		pass *= 1 - bloom_fpp(sbf->filters[i]);
+	return 1 - pass;
+}
+
+uint64_t bloom_scalable_memory(const bloom_scalable_t *sbf)
+{
+	uint64_t total = 0;
+	int i;
+
+	for (i = 0; i < sbf->nfilters; i++)
+		total += bloom_memory(sbf->filters[i]);
+	return total;
+}
+
+int bloom_scalable_save(const bloom_scalable_t *sbf, const char *path)
+{
+	struct scalable_header h;
+	FILE *fp = fopen(path, "wb");
+	int i, ret = 0;
+
+	if (!fp)
+		return -1;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, SCALABLE_MAGIC, sizeof(h.magic));
+	h.type = sbf->type;
+	h.nfilters = sbf->nfilters;
+	h.n = sbf->n;
+	h.p = sbf->p;
+	h.count = sbf->count;
+	h.seed = sbf->seed;
+	memcpy(h.hash_name, sbf->hash_name, sizeof(h.hash_name));
+	if (fwrite(&h, sizeof(h), 1, fp) != 1)
+		ret = -1;
+	for (i = 0; i < sbf->nfilters && ret == 0; i++)
+		ret = write_filter(fp, sbf->filters[i]);
+	if (fclose(fp) != 0)
+		ret = -1;
+	return ret;
+}
+
+bloom_scalable_t *bloom_scalable_open(const char *path)
+{
+	struct scalable_header *h;
+	bloom_scalable_t *sbf;
+	size_t len, off, used;
+	char *base;
+	int i;
+
+	base = map_file(path, &len);
+	if (!base)
+		return NULL;
+	h = (struct scalable_header *)base;
+	sbf = calloc(1, sizeof(bloom_scalable_t));
+	if (!sbf || len < sizeof(*h) ||
+	    memcmp(h->magic, SCALABLE_MAGIC, sizeof(h->magic)) ||
+	    h->nfilters < 1 || h->type == BLOOM_COUNTING ||
+	    h->hash_name[sizeof(h->hash_name) - 1] != 0)
+		goto fail;
+	sbf->map = base;
+	sbf->map_len = len;
+	sbf->type = h->type;
+	sbf->n = h->n;
+	sbf->p = h->p;
+	sbf->count = h->count;
+	sbf->seed = h->seed;
+	memcpy(sbf->hash_name, h->hash_name, sizeof(sbf->hash_name));
+	sbf->filters = calloc(h->nfilters, sizeof(bloom_t *));
+	if (!sbf->filters)
+		goto fail;
+	sbf->cap = h->nfilters;
+	for (i = 0, off = sizeof(*h); i < h->nfilters; i++, off += used) {
+		sbf->filters[i] = view_filter(base + off, len - off, &used);
+		if (!sbf->filters[i])
+			goto fail;
+		sbf->nfilters++;
+		/* lookups hash once for all sub-filters */
+		if (sbf->filters[i]->type != sbf->type ||
+		    sbf->filters[i]->seed != sbf->seed ||
+		    strcmp(sbf->filters[i]->hash_name, sbf->hash_name))
+			goto fail;
+	}
+	return sbf;
+fail:
+	if (sbf && sbf->map)
+		bloom_scalable_destroy(sbf);
+	else {
+		free(sbf);
+		munmap(base, len);
+	}
+	return NULL;
+}
+
+/*
+ * input
+ */
+
+int64_t bloom_each_line(const char *path, bloom_line_fn fn, void *arg,
+			int evict)
+{
+	char *base, *p, *end, *nl;
+	size_t dropped = 0;
+	struct stat st;
+	int64_t n = 0;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return -1;
+	if (fstat(fd, &st) < 0) {
+		close(fd);
+		return -1;
+	}
+	if (st.st_size == 0) {
+		close(fd);
+		return 0;
+	}
+	base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (base == MAP_FAILED) {
+		close(fd);
+		return -1;
+	}
+	madvise(base, st.st_size, MADV_SEQUENTIAL);
+
+	for (p = base, end = base + st.st_size; p < end; p = nl + 1) {
+		nl = memchr(p, '\n', end - p);
+		if (!nl)
+			nl = end;
+		fn(arg, p, nl - p);
+		n++;
+		/* a big input would otherwise push everything else out of
+		 * the page cache.  MADV_DONTNEED only unmaps the pages from
+		 * us; once they are unmapped POSIX_FADV_DONTNEED can evict
+		 * them from the page cache */
+		if (evict &&
+		    (size_t)(p - base) >= dropped + 2 * (size_t)DROP_CHUNK) {
+			madvise(base + dropped, DROP_CHUNK, MADV_DONTNEED);
+			posix_fadvise(fd, dropped, DROP_CHUNK, POSIX_FADV_DONTNEED);
+			dropped += DROP_CHUNK;
+		}
+	}
+	munmap(base, st.st_size);
+	close(fd);
+	return n;
+}
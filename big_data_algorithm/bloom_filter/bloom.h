@@ -0,0 +1,146 @@
+/*******************************************************************************
+*
+* bloom.h -- Bloom filter sized at run time
+*
+* the filter is sized from the expected number of keys n and the target false
+* positive rate p: m = -n ln p / (ln 2)^2 bits and k = m / n * ln 2 probes.
+*
+* each key is hashed once to 64 bits; the k probes are h1 + i * h2
+* (Kirsch-Mitzenmacher double hashing) with h2 derived from h1 by a mix step.
+*
+* BLOOM_STANDARD spreads the k probes over the whole bit array, so a lookup
+* touches up to k cache lines. BLOOM_BLOCKED first picks one 64-byte block and
+* puts all k probes inside it: one cache miss per key, at the price of a
+* somewhat higher false positive rate, which bloom_create makes up for with
+* extra blocks until the predicted rate meets p.
+*
+* BLOOM_COUNTING is the standard layout with a 4-bit counter per cell instead
+* of a bit, so keys can be removed. it takes 4 times the memory; a counter
+* that reaches 15 stays there.
+*
+* bloom_scalable_t is for an unknown number of keys: it starts with a filter
+* for n keys and chains a twice as large one, with a tighter rate, each time
+* the last one is full. the rates form a geometric series so the total stays
+* below p.
+*
+* filters can be saved to a file and opened again with mmap: nothing is read
+* until a lookup touches it. an opened filter is a private mapping, adds and
+* removes stay in memory.
+*
+*******************************************************************************/
+
+#ifndef __BLOOM_H__
+#define __BLOOM_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "hashfn.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BLOOM_STANDARD	0
+#define BLOOM_BLOCKED	1
+#define BLOOM_COUNTING	2
+
+#define BLOOM_BLOCK_BITS	512	/* one cache line */
+#define BLOOM_MAX_HASHES	16
+#define BLOOM_COUNTER_MAX	15
+
+#define BLOOM_SCALE_GROWTH	2	/* each sub-filter takes this many times more keys */
+#define BLOOM_SCALE_TIGHTEN	0.85	/* and has this times the rate of the last */
+
+typedef struct bloom {
+	uint64_t *bits;
+	uint64_t nbits;		/* cells: bits, or counters for BLOOM_COUNTING */
+	uint64_t nblocks;	/* 64-byte blocks allocated */
+	int k;
+	int type;
+	uint64_t count;		/* keys added, duplicates included */
+	uint64_t capacity;	/* the n it was sized for */
+	hashfn64_t hash;
+	uint64_t seed;
+	int mix;		/* hash has fewer than 64 bits, mix it first */
+	char hash_name[16];
+	int mapped;		/* bits point into a file mapping */
+	void *map;		/* the mapping, if this filter owns it */
+	size_t map_len;
+} bloom_t;
+
+typedef struct bloom_scalable {
+	bloom_t **filters;
+	int nfilters;
+	int cap;
+	int type;
+	uint64_t n;		/* keys of the first filter */
+	double p;		/* rate of the whole chain */
+	uint64_t count;		/* keys added that were not there yet */
+	uint64_t seed;		/* hash of every sub-filter */
+	char hash_name[16];
+	void *map;
+	size_t map_len;
+} bloom_scalable_t;
+
+/* NULL if p is not in (0, 1), n is 0 or memory runs out */
+bloom_t *bloom_create(uint64_t n, double p, int type);
+void bloom_destroy(bloom_t *bloom);
+
+/* any function from hashfn_table, wyhash by default; only valid while the
+ * filter is empty. returns -1 for an unknown name */
+int bloom_set_hash(bloom_t *bloom, const char *name, uint64_t seed);
+
+void bloom_add(bloom_t *bloom, const void *key, size_t len);
+int bloom_check(const bloom_t *bloom, const void *key, size_t len);
+
+/* BLOOM_COUNTING only: 1 removed, 0 not in the filter, -1 wrong type.
+ * removing a key that was never added can remove another one */
+int bloom_remove(bloom_t *bloom, const void *key, size_t len);
+
+/* the same with a hash the caller already has (see bloom_hash) */
+uint64_t bloom_hash(const bloom_t *bloom, const void *key, size_t len);
+void bloom_add_hash(bloom_t *bloom, uint64_t h);
+int bloom_check_hash(const bloom_t *bloom, uint64_t h);
+
+/* adds n hashes, prefetching the lines of the next ones meanwhile */
+void bloom_add_hashes(bloom_t *bloom, const uint64_t *h, size_t n);
+
+/* false positive rate predicted for the keys added so far */
+double bloom_fpp(const bloom_t *bloom);
+
+/* bytes used by the cells */
+uint64_t bloom_memory(const bloom_t *bloom);
+
+/* 0 ok, -1 error */
+int bloom_save(const bloom_t *bloom, const char *path);
+bloom_t *bloom_open(const char *path);
+
+/* first filter sized for n keys, p for the whole chain. BLOOM_COUNTING is
+ * not allowed: a remove could not tell which sub-filter holds the key */
+bloom_scalable_t *bloom_scalable_create(uint64_t n, double p, int type);
+void bloom_scalable_destroy(bloom_scalable_t *sbf);
+/* bloom_set_hash for the whole chain, sub-filters added later use it too */
+int bloom_scalable_set_hash(bloom_scalable_t *sbf, const char *name,
+			    uint64_t seed);
+/* 1 added, 0 already there, -1 out of memory */
+int bloom_scalable_add(bloom_scalable_t *sbf, const void *key, size_t len);
+int bloom_scalable_check(const bloom_scalable_t *sbf, const void *key,
+			 size_t len);
+double bloom_scalable_fpp(const bloom_scalable_t *sbf);
+uint64_t bloom_scalable_memory(const bloom_scalable_t *sbf);
+int bloom_scalable_save(const bloom_scalable_t *sbf, const char *path);
+bloom_scalable_t *bloom_scalable_open(const char *path);
+
+/* calls fn for every line of the file (without the '\n') reading it through
+ * mmap front to back. with evict set, pages already read are dropped from the
+ * page cache: pass it only on the last read of the file. returns the number
+ * of lines or -1 */
+typedef void (*bloom_line_fn)(void *arg, const char *line, size_t len);
+int64_t bloom_each_line(const char *path, bloom_line_fn fn, void *arg,
+			int evict);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,416 @@
+/*******************************************************************************
+*
+* bloom_bench.c -- false positive rate and speed of the Bloom filters
+*
+* n words go into each filter, then n words that were added and n that were
+* not are looked up. the filters are:
+*   classic   the fixed filter bloom_filter.c used before: 2^20 bits and
+*             7 partow hash functions, each a separate pass over the word
+*   standard  bloom.c sized for n and p, one wyhash + double hashing
+*   blocked   the same with all probes of a word in one 64-byte line
+* the first round is the classic filter's own design point (100,000 words,
+* p = 0.007), the second uses -n and -p.
+*
+* then, with -n and -p:
+*   removes   counting filter against cuckoo filter: add all words, remove
+*             every other one, look up the rest, the removed and the misses
+*   scalable  a scalable filter started for n / 1000 words against a
+*             standard one sized for n / 1000 and one sized for n
+*   images    the words are written to a file, the filter is built from it
+*             through mmap with prefetching, saved, opened and queried
+*
+*******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "bloom.h"
+#include "cuckoo.h"
+
+#define KEY_STRIDE	24
+#define CLASSIC_SIZE	20
+#define CLASSIC_HASHES	7
+#define CLASSIC_BITMASK	((1 << CLASSIC_SIZE) - 1)
+
+static unsigned char classic[1 << (CLASSIC_SIZE - 3)];
+static char *keys, *misses;
+static const char *image_prefix = "/tmp/bloom_bench";
+static unsigned char *lens;
+
+static double now_sec(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void classic_hashes(unsigned int hash[], char *in, unsigned int len)
+{
+	unsigned char *str = (unsigned char *)in;
+	int i;
+
+	hash[0] = RSHash  (str, len);
+	hash[1] = DJBHash (str, len);
+	hash[2] = FNVHash (str, len);
+	hash[3] = JSHash  (str, len);
+	hash[4] = PJWHash (str, len);
+	hash[5] = SDBMHash(str, len);
+	hash[6] = DEKHash (str, len);
+	for (i = 0; i < CLASSIC_HASHES; i++)
+		hash[i] = (hash[i] >> CLASSIC_SIZE) ^ (hash[i] & CLASSIC_BITMASK);
+}
+
+static void classic_add(char *str, unsigned int len)
+{
+	unsigned int hash[CLASSIC_HASHES];
+	int i;
+
+	classic_hashes(hash, str, len);
+	for (i = 0; i < CLASSIC_HASHES; i++)
+		classic[hash[i] >> 3] |= 1 << (hash[i] & 7);
+}
+
+static int classic_check(char *str, unsigned int len)
+{
+	unsigned int hash[CLASSIC_HASHES];
+	int i;
+
+	classic_hashes(hash, str, len);
+	for (i = 0; i < CLASSIC_HASHES; i++)
+		if (!(classic[hash[i] >> 3] & (1 << (hash[i] & 7))))
+			return 0;
+	return 1;
+}
+
+/* filter is NULL for the classic one */
+static void run(const char *name, bloom_t *filter, uint64_t n)
+{
+	uint64_t i, found = 0, fp = 0;
+	double t_add, t_hit, t_miss;
+	char *key;
+
+	t_add = now_sec();
+	for (i = 0; i < n; i++) {
+		key = keys + i * KEY_STRIDE;
+		if (filter)
+			bloom_add(filter, key, lens[i]);
+		else
+			classic_add(key, lens[i]);
+	}
+	t_add = now_sec() - t_add;
+
+	t_hit = now_sec();
+	for (i = 0; i < n; i++) {
+		key = keys + i * KEY_STRIDE;
+		found += filter ? bloom_check(filter, key, lens[i]) :
+				  classic_check(key, lens[i]);
+	}
+	t_hit = now_sec() - t_hit;
+
+	t_miss = now_sec();
+	for (i = 0; i < n; i++) {
+		key = misses + i * KEY_STRIDE;
+		fp += filter ? bloom_check(filter, key, lens[i]) :
+			       classic_check(key, lens[i]);
+	}
+	t_miss = now_sec() - t_miss;
+
+	printf("%-9s %9lu KB %3d  %7.1f %7.1f %7.1f   %.5f", name,
+	       (unsigned long)((filter ? bloom_memory(filter) :
+				sizeof(classic)) >> 10),
+	       filter ? filter->k : CLASSIC_HASHES,
+	       t_add * 1e9 / n, t_hit * 1e9 / n, t_miss * 1e9 / n,
+	       (double)fp / n);
+	if (filter)
+		printf("  %.5f", bloom_fpp(filter));
+	printf("%s\n", found == n ? "" : "  FALSE NEGATIVES");
+}
+
+static void round_of(uint64_t n, double p)
+{
+	bloom_t *filter;
+	int type;
+
+	printf("\n%lu words, p = %g\n%-9s %12s %3s  %7s %7s %7s   %-7s  %s\n",
+	       (unsigned long)n, p, "", "memory", "k", "add ns", "hit ns",
+	       "miss ns", "fp rate", "predicted");
+	memset(classic, 0, sizeof(classic));
+	run("classic", NULL, n);
+	for (type = BLOOM_STANDARD; type <= BLOOM_BLOCKED; type++) {
+		filter = bloom_create(n, p, type);
+		if (!filter) {
+			fprintf(stderr, "unable to create a filter\n");
+			exit(-1);
+		}
+		run(type == BLOOM_STANDARD ? "standard" : "blocked", filter, n);
+		bloom_destroy(filter);
+	}
+}
+
+#define KEY(i)	(keys + (i) * KEY_STRIDE)
+#define MISS(i)	(misses + (i) * KEY_STRIDE)
+
+static void round_removes(uint64_t n, double p)
+{
+	bloom_t *cbf = bloom_create(n, p, BLOOM_COUNTING);
+	cuckoo_t *cf = cuckoo_create(n);
+	uint64_t i, lost[2] = {0, 0}, stale[2] = {0, 0}, fp[2] = {0, 0}, full = 0;
+	double t_add[2], t_remove[2], t_check[2];
+
+	if (!cbf || !cf) {
+		fprintf(stderr, "unable to create a filter\n");
+		exit(-1);
+	}
+
+	t_add[0] = now_sec();
+	for (i = 0; i < n; i++)
+		bloom_add(cbf, KEY(i), lens[i]);
+	t_add[0] = now_sec() - t_add[0];
+	t_add[1] = now_sec();
+	for (i = 0; i < n; i++)
+		full += cuckoo_add(cf, KEY(i), lens[i]) == -1;
+	t_add[1] = now_sec() - t_add[1];
+
+	t_remove[0] = now_sec();
+	for (i = 0; i < n; i += 2)
+		bloom_remove(cbf, KEY(i), lens[i]);
+	t_remove[0] = now_sec() - t_remove[0];
+	t_remove[1] = now_sec();
+	for (i = 0; i < n; i += 2)
+		cuckoo_remove(cf, KEY(i), lens[i]);
+	t_remove[1] = now_sec() - t_remove[1];
+
+	t_check[0] = now_sec();
+	for (i = 0; i < n; i++) {
+		if (i & 1)
+			lost[0] += !bloom_check(cbf, KEY(i), lens[i]);
+		else
+			stale[0] += bloom_check(cbf, KEY(i), lens[i]);
+		fp[0] += bloom_check(cbf, MISS(i), lens[i]);
+	}
+	t_check[0] = now_sec() - t_check[0];
+	t_check[1] = now_sec();
+	for (i = 0; i < n; i++) {
+		if (i & 1)
+			lost[1] += !cuckoo_check(cf, KEY(i), lens[i]);
+		else
+			stale[1] += cuckoo_check(cf, KEY(i), lens[i]);
+		fp[1] += cuckoo_check(cf, MISS(i), lens[i]);
+	}
+	t_check[1] = now_sec() - t_check[1];
+
+	printf("\nremoves: %lu words, every other one removed\n"
+	       "%-9s %12s  %7s %7s %7s   %-8s %-8s %s\n", (unsigned long)n,
+	       "", "memory", "add ns", "rm ns", "chk ns", "lost", "removed",
+	       "fp rate");
+	for (i = 0; i < 2; i++)
+		printf("%-9s %9lu KB  %7.1f %7.1f %7.1f   %-8lu %-8lu %.5f\n",
+		       i ? "cuckoo" : "counting",
+		       (unsigned long)((i ? cuckoo_memory(cf) :
+					bloom_memory(cbf)) >> 10),
+		       t_add[i] * 1e9 / n, t_remove[i] * 1e9 / (n / 2),
+		       t_check[i] * 1e9 / (2 * n), (unsigned long)lost[i],
+		       (unsigned long)stale[i], (double)fp[i] / n);
+	if (full)
+		printf("cuckoo filter refused %lu adds\n", (unsigned long)full);
+	bloom_destroy(cbf);
+	cuckoo_destroy(cf);
+}
+
+static void round_scalable(uint64_t n, double p)
+{
+	bloom_scalable_t *sbf = bloom_scalable_create(n / 1000, p, BLOOM_STANDARD);
+	bloom_t *small = bloom_create(n / 1000, p, BLOOM_STANDARD);
+	bloom_t *right = bloom_create(n, p, BLOOM_STANDARD);
+	uint64_t i, fp[3] = {0, 0, 0};
+	double t_add, t_check;
+
+	if (!sbf || !small || !right) {
+		fprintf(stderr, "unable to create a filter\n");
+		exit(-1);
+	}
+	t_add = now_sec();
+	for (i = 0; i < n; i++)
+		bloom_scalable_add(sbf, KEY(i), lens[i]);
+	t_add = now_sec() - t_add;
+	for (i = 0; i < n; i++) {
+		bloom_add(small, KEY(i), lens[i]);
+		bloom_add(right, KEY(i), lens[i]);
+	}
+	t_check = now_sec();
+	for (i = 0; i < n; i++)
+		fp[0] += bloom_scalable_check(sbf, MISS(i), lens[i]);
+	t_check = now_sec() - t_check;
+	for (i = 0; i < n; i++) {
+		fp[1] += bloom_check(small, MISS(i), lens[i]);
+		fp[2] += bloom_check(right, MISS(i), lens[i]);
+	}
+
+	printf("\nscalable: %lu words, p = %g\n", (unsigned long)n, p);
+	printf("scalable  %9lu KB  %d filters, add %.1f ns, miss %.1f ns, "
+	       "fp rate %.5f, predicted %.5f\n",
+	       (unsigned long)(bloom_scalable_memory(sbf) >> 10),
+	       sbf->nfilters, t_add * 1e9 / n, t_check * 1e9 / n,
+	       (double)fp[0] / n, bloom_scalable_fpp(sbf));
+	printf("n/1000    %9lu KB  fp rate %.5f\n",
+	       (unsigned long)(bloom_memory(small) >> 10), (double)fp[1] / n);
+	printf("n         %9lu KB  fp rate %.5f\n",
+	       (unsigned long)(bloom_memory(right) >> 10), (double)fp[2] / n);
+	bloom_scalable_destroy(sbf);
+	bloom_destroy(small);
+	bloom_destroy(right);
+}
+
+struct loader {
+	bloom_t *filter;
+	uint64_t hashes[64];
+	size_t n;
+	int batch;
+};
+
+static void load_line(void *arg, const char *line, size_t len)
+{
+	struct loader *l = arg;
+
+	if (!l->batch) {
+		bloom_add(l->filter, line, len);
+		return;
+	}
+	l->hashes[l->n++] = bloom_hash(l->filter, line, len);
+	if (l->n == 64) {
+		bloom_add_hashes(l->filter, l->hashes, l->n);
+		l->n = 0;
+	}
+}
+
+static void round_images(uint64_t n, double p)
+{
+	char txt[256], img[256];
+	struct loader l;
+	bloom_t *filter;
+	cuckoo_t *cf;
+	FILE *fp;
+	uint64_t i, found;
+	double t;
+	int type;
+
+	snprintf(txt, sizeof(txt), "%s.txt", image_prefix);
+	snprintf(img, sizeof(img), "%s.img", image_prefix);
+	fp = fopen(txt, "w");
+	if (!fp) {
+		fprintf(stderr, "unable to write %s\n", txt);
+		return;
+	}
+	for (i = 0; i < n; i++)
+		fprintf(fp, "%s\n", KEY(i));
+	fclose(fp);
+
+	printf("\nimages: %lu words from %s\n", (unsigned long)n, txt);
+	for (type = BLOOM_STANDARD; type <= BLOOM_BLOCKED; type++) {
+		for (l.batch = 0; l.batch < 2; l.batch++) {
+			l.filter = bloom_create(n, p, type);
+			l.n = 0;
+			t = now_sec();
+			/* read four times, keep it cached for a fair
+			 * comparison */
+			bloom_each_line(txt, load_line, &l, 0);
+			if (l.n)
+				bloom_add_hashes(l.filter, l.hashes, l.n);
+			t = now_sec() - t;
+			printf("%-9s build %-10s %6.1f ns/word\n",
+			       type == BLOOM_STANDARD ? "standard" : "blocked",
+			       l.batch ? "batched" : "one by one", t * 1e9 / n);
+			if (!l.batch || type != BLOOM_BLOCKED) {
+				bloom_destroy(l.filter);
+				continue;
+			}
+
+			t = now_sec();
+			bloom_save(l.filter, img);
+			printf("%-9s save  %.1f ms\n", "", (now_sec() - t) * 1e3);
+			bloom_destroy(l.filter);
+
+			t = now_sec();
+			filter = bloom_open(img);
+			t = now_sec() - t;
+			if (!filter) {
+				fprintf(stderr, "unable to open %s\n", img);
+				break;
+			}
+			found = bloom_check(filter, KEY(0), lens[0]);
+			printf("%-9s open  %.3f ms, first check %s\n", "", t * 1e3,
+			       found ? "ok" : "WRONG");
+			t = now_sec();
+			for (i = 0; i < n; i++)
+				found += bloom_check(filter, KEY(i), lens[i]);
+			printf("%-9s check %.1f ns from the image, %s\n", "",
+			       (now_sec() - t) * 1e9 / n,
+			       found == n + 1 ? "ok" : "WRONG");
+			bloom_destroy(filter);
+		}
+	}
+
+	cf = cuckoo_create(n);
+	for (i = 0; i < n; i++)
+		cuckoo_add(cf, KEY(i), lens[i]);
+	cuckoo_save(cf, img);
+	cuckoo_destroy(cf);
+	t = now_sec();
+	cf = cuckoo_open(img);
+	t = now_sec() - t;
+	for (i = 0, found = 0; cf && i < n; i++)
+		found += cuckoo_check(cf, KEY(i), lens[i]);
+	printf("cuckoo    open  %.3f ms, %s\n", t * 1e3,
+	       found == n ? "ok" : "WRONG");
+	cuckoo_destroy(cf);
+
+	unlink(txt);
+	unlink(img);
+}
+
+int main(int argc, char *argv[])
+{
+	uint64_t n = 10000000, i;
+	double p = 0.01;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:p:f:")) != -1) {
+		switch (opt) {
+		case 'n': n = strtoull(optarg, NULL, 0); break;
+		case 'p': p = atof(optarg); break;
+		case 'f': image_prefix = optarg; break;
+		default:
+			fprintf(stderr, "usage: %s [-n words] [-p rate] "
+				"[-f file_prefix]\n", argv[0]);
+			return -1;
+		}
+	}
+	if (n < 100000 || n > 0xffffffffULL)
+		n = 100000;
+
+	keys = malloc(n * KEY_STRIDE);
+	misses = malloc(n * KEY_STRIDE);
+	lens = malloc(n);
+	if (!keys || !misses || !lens)
+		return -1;
+	/* a word and its miss have the same length */
+	for (i = 0; i < n; i++) {
+		lens[i] = snprintf(keys + i * KEY_STRIDE, KEY_STRIDE,
+				   "word%u", (unsigned int)i);
+		snprintf(misses + i * KEY_STRIDE, KEY_STRIDE, "miss%u",
+			 (unsigned int)i);
+	}
+
+	round_of(100000, 0.007);
+	round_of(n, p);
+	round_removes(n, p);
+	round_scalable(n, p);
+	round_images(n, p);
+
+	free(keys);
+	free(misses);
+	free(lens);
+	return 0;
+}
@@ -32,12 +32,13 @@
 *
 ********************************************************************************
 *
-* compile with (note -- ints should be >= 32 bits):
-* gcc -Wall -Werror -g -ansi -pedantic -O2 bloom_filter.c -o bloom_filter
+* compile with make, the filter itself lives in bloom.c and the hash functions
+* come from ../hash_table/hashfn.c
 *
 * example usage ("words" is from /usr/share/dict/words on debian):
 * $ ./bloom_filter
-* usage: ./bloom_filter dictionary word ...
+* usage: ./bloom_filter [-H hash] [-b|-c|-s] [-p rate] [-o image] dictionary word ...
+*        ./bloom_filter -i image word ...
 * $ ./bloom_filter words test word words foo bar baz not_in_dict
 * "test" in dictionary
 * "word" in dictionary
@@ -47,15 +48,24 @@
 * "baz" not in dictionary
 * "not_in_dict" not in dictionary
 *
-* this implementation uses 7 hash functions, the optimal number for an input
-* of approx. 100,000 and a filter size of 2^20 bits -- a ~7.2x decrease in
-* space needed (from 912KB to 128KB), with an false positive rate of 0.007.
-* consult Wikipedia for optimal numbers for your input and desired size
+* the filter used to be fixed at 2^20 bits and 7 hash functions, which is
+* right for approx. 100,000 words and nothing else. now the dictionary is
+* counted first and the filter is sized for it and the false positive rate
+* given with -p (default 0.007, about the old size for 100,000 words).
+* every word is hashed once with wyhash (or the function picked with -H from
+* hashfn_table) and the probes are h1 + i * h2 (Kirsch-Mitzenmacher double
+* hashing). -b uses the cache-blocked filter: all probes of a word fall in
+* one 64-byte line. -c uses 4-bit counters (the filter could remove words),
+* -s a scalable filter, which does not need the count pass.
 *
-* all the hash functions are under the Common Public License and from:
+* the dictionary is read through mmap in one pass and the words are hashed
+* in batches, so the filter lines can be prefetched. -o saves the filter,
+* -i queries a saved one without building or reading it.
+* bloom_bench compares the filters with the old one and a cuckoo filter.
+*
+* the old filter used the 7 functions from
 * http://www.partow.net/programming/hashfunctions/index.html
-* although I haven't rigorously tested them -- for real use, you'll probably
-* want to make sure they work well for your data set or choose others.
+* they are still in hashfn_table (-H rs, -H djb, ...).
 *
 * other hash functions of interest:
 * http://www.cse.yorku.ca/~oz/hash.html
@@ -69,53 +79,87 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdarg.h>
+#include <unistd.h>
+#include "bloom.h"
 
 /* config options */
-/* 2^FILTER_SIZE is the size of the filter in bits, i.e.,  
- * size 20 = 2^20 bits = 1 048 576 bits = 131 072 bytes = 128 KB */
-#define FILTER_SIZE 20
-#define NUM_HASHES 7
-#define WORD_BUF_SIZE 32
-
-#define FILTER_SIZE_BYTES (1 << (FILTER_SIZE - 3))
-#define FILTER_BITMASK ((1 << FILTER_SIZE) - 1)
+#define DEFAULT_FPP 0.007
+#define LOAD_BATCH 64
 
-/* hash functions */
-unsigned int RSHash  (unsigned char *, unsigned int);
-unsigned int DJBHash (unsigned char *, unsigned int);
-unsigned int FNVHash (unsigned char *, unsigned int);
-unsigned int JSHash  (unsigned char *, unsigned int);
-unsigned int PJWHash (unsigned char *, unsigned int);
-unsigned int SDBMHash(unsigned char *, unsigned int);
-unsigned int DEKHash (unsigned char *, unsigned int);
+struct loader {
+	bloom_t *filter;
+	bloom_scalable_t *sfilter;
+	uint64_t hashes[LOAD_BATCH];
+	size_t n;
+};
 
 /* helper functions */
 void err(char *msg, ...);
-void load_words(unsigned char[], char *);
-void insert_word(unsigned char[], char *);
-int in_dict(unsigned char[], char *);
-void get_hashes(unsigned int[], char *);
+uint64_t count_words(char *);
+void load_words(bloom_t *, bloom_scalable_t *, char *);
 
 int main(int argc, char *argv[])
 {
-	unsigned char filter[FILTER_SIZE_BYTES];
-	int i;
-
-	if (argc < 3)
-		err("usage: %s dictionary word ...\n", argv[0]);
+	bloom_t *filter = NULL;
+	bloom_scalable_t *sfilter = NULL;
+	char *hash_name = NULL, *image = NULL, *output = NULL;
+	double fpp = DEFAULT_FPP;
+	int type = BLOOM_STANDARD, scalable = 0, opt, i, found, words;
+
+	while ((opt = getopt(argc, argv, "H:bcsp:o:i:")) != -1) {
+		switch (opt) {
+		case 'H': hash_name = optarg; break;
+		case 'b': type = BLOOM_BLOCKED; break;
+		case 'c': type = BLOOM_COUNTING; break;
+		case 's': scalable = 1; break;
+		case 'p': fpp = atof(optarg); break;
+		case 'o': output = optarg; break;
+		case 'i': image = optarg; break;
+		default: argc = 0;
+		}
+	}
+	if (argc - optind < (image ? 1 : 2))
+		err("usage: %s [-H hash] [-b|-c|-s] [-p rate] [-o image] "
+		    "dictionary word ...\n       %s -i image word ...\n",
+		    argv[0], argv[0]);
+
+	if (image) {
+		filter = bloom_open(image);
+		if (!filter)
+			sfilter = bloom_scalable_open(image);
+		if (!filter && !sfilter)
+			err("unable to open image \"%s\"\n", image);
+		words = optind;
+	} else {
+		if (scalable)
+			sfilter = bloom_scalable_create(100000, fpp, type);
+		else
+			filter = bloom_create(count_words(argv[optind]), fpp, type);
+		if (!filter && !sfilter)
+			err("unable to create a filter with rate %g\n", fpp);
+		if (hash_name && (filter ?
+		    bloom_set_hash(filter, hash_name, 0) :
+		    bloom_scalable_set_hash(sfilter, hash_name, 0)) == -1)
+			err("unknown hash function \"%s\"\n", hash_name);
+		load_words(filter, sfilter, argv[optind]);
+		words = optind + 1;
+	}
 
-	for (i = 0; i < FILTER_SIZE_BYTES; i++)
-		filter[i] = 0;
+	if (output && (filter ? bloom_save(filter, output) :
+			bloom_scalable_save(sfilter, output)) == -1)
+		err("unable to save image \"%s\"\n", output);
 
-	load_words(filter, argv[1]);
-		
-	for (i = 2; i < argc; i++) {
-		if (in_dict(filter, argv[i]))
+	for (i = words; i < argc; i++) {
+		found = filter ? bloom_check(filter, argv[i], strlen(argv[i])) :
+			bloom_scalable_check(sfilter, argv[i], strlen(argv[i]));
+		if (found)
 			printf("\"%s\" in dictionary\n", argv[i]);
 		else
 			printf("\"%s\" not in dictionary\n", argv[i]);
 	}
 
+	bloom_destroy(filter);
+	bloom_scalable_destroy(sfilter);
 	return 0;
 }
 
@@ -128,190 +172,45 @@ void err(char *msg, ...)
 	exit(-1);
 }
 
-void load_words(unsigned char filter[], char *filename)
-{
-	FILE *dict = fopen(filename, "r");
-	char buf[WORD_BUF_SIZE];
-	int c, pos = 0;
-
-	if (!dict)
-		err("unable to open dictionary \"%s\"\n", filename);
-	
-	while ((c = getc(dict)) != EOF) {
-		if (c != '\n') {
-			if (pos > WORD_BUF_SIZE-2) {
-				buf[WORD_BUF_SIZE-1] = 0;
-				err("word \"%s\" exceeds buffer length\n", buf);
-			} else {
-				buf[pos++] = c;
-			}
-		} else {
-			buf[pos] = 0;
-			insert_word(filter, buf);
-			pos = 0;
-		}
-	}
-	
-	fclose(dict);
-}
-
-
-void insert_word(unsigned char filter[], char *str)
+static void skip_line(void *arg, const char *line, size_t len)
 {
-	unsigned int hash[NUM_HASHES];
-	int i;
-	
-	get_hashes(hash, str);
-	
-	for (i = 0; i < NUM_HASHES; i++) {
-		/* xor-fold the hash into FILTER_SIZE bits */
-		hash[i] = (hash[i] >> FILTER_SIZE) ^ 
-		          (hash[i] & FILTER_BITMASK);
-		/* set the bit in the filter */
-		filter[hash[i] >> 3] |= 1 << (hash[i] & 7);
-	}
-}
-
-
-int in_dict(unsigned char filter[], char *str)
-{
-	unsigned int hash[NUM_HASHES];
-	int i;
-	
-	get_hashes(hash, str);
-	
-	for (i = 0; i < NUM_HASHES; i++) {
-		hash[i] = (hash[i] >> FILTER_SIZE) ^
-		          (hash[i] & FILTER_BITMASK);
-		if (!(filter[hash[i] >> 3] & (1 << (hash[i] & 7))))
-			return 0;
-	}
-	
-	return 1;
 }
 
-void get_hashes(unsigned int hash[], char *in)
+uint64_t count_words(char *filename)
 {
-	unsigned char *str = (unsigned char *)in;
-	int pos = strlen(in);
-	hash[0] = RSHash  (str, pos);
-	hash[1] = DJBHash (str, pos);
-	hash[2] = FNVHash (str, pos);
-	hash[3] = JSHash  (str, pos);
-	hash[4] = PJWHash (str, pos);
-	hash[5] = SDBMHash(str, pos);
-	hash[6] = DEKHash (str, pos);
-}
-
-
-
+	/* load_words reads the file again, keep it in the page cache */
+	int64_t n = bloom_each_line(filename, skip_line, NULL, 0);
 
-
-/****************\
-| Hash Functions |
-\****************/
-
-unsigned int RSHash(unsigned char *str, unsigned int len)
-{
-   unsigned int b    = 378551;
-   unsigned int a    = 63689;
-   unsigned int hash = 0;
-   unsigned int i    = 0;
-
-   for(i = 0; i < len; str++, i++)
-   {
-      hash = hash * a + (*str);
-      a    = a * b;
-   }
-
-   return hash;
-}
-
-unsigned int JSHash(unsigned char *str, unsigned int len)
-{
-   unsigned int hash = 1315423911;
-   unsigned int i    = 0;
-
-   for(i = 0; i < len; str++, i++)
-   {
-      hash ^= ((hash << 5) + (*str) + (hash >> 2));
-   }
-
-   return hash;
-}
-
-unsigned int PJWHash(unsigned char *str, unsigned int len)
-{
-   const unsigned int BitsInUnsignedInt = (unsigned int)(sizeof(unsigned int) * 8);
-   const unsigned int ThreeQuarters     = (unsigned int)((BitsInUnsignedInt  * 3) / 4);
-   const unsigned int OneEighth         = (unsigned int)(BitsInUnsignedInt / 8);
-   const unsigned int HighBits          = (unsigned int)(0xFFFFFFFF) << (BitsInUnsignedInt - OneEighth);
-   unsigned int hash              = 0;
-   unsigned int test              = 0;
-   unsigned int i                 = 0;
-
-   for(i = 0; i < len; str++, i++)
-   {
-      hash = (hash << OneEighth) + (*str);
-
-      if((test = hash & HighBits)  != 0)
-      {
-         hash = (( hash ^ (test >> ThreeQuarters)) & (~HighBits));
-      }
-   }
-
-   return hash;
-}
-
-unsigned int SDBMHash(unsigned char *str, unsigned int len)
-{
-   unsigned int hash = 0;
-   unsigned int i    = 0;
-
-   for(i = 0; i < len; str++, i++)
-   {
-      hash = (*str) + (hash << 6) + (hash << 16) - hash;
-   }
-
-   return hash;
+	if (n < 0)
+		err("unable to open dictionary \"%s\"\n", filename);
+	return n > 0 ? n : 1;
 }
 
-unsigned int DJBHash(unsigned char *str, unsigned int len)
+static void load_line(void *arg, const char *line, size_t len)
 {
-   unsigned int hash = 5381;
-   unsigned int i    = 0;
-
-   for(i = 0; i < len; str++, i++)
-   {
-      hash = ((hash << 5) + hash) + (*str);
-   }
+	struct loader *l = arg;
 
-   return hash;
+	if (l->sfilter) {
+		if (bloom_scalable_add(l->sfilter, line, len) == -1)
+			err("out of memory\n");
+		return;
+	}
+	l->hashes[l->n++] = bloom_hash(l->filter, line, len);
+	if (l->n == LOAD_BATCH) {
+		bloom_add_hashes(l->filter, l->hashes, l->n);
+		l->n = 0;
+	}
 }
 
-unsigned int DEKHash(unsigned char *str, unsigned int len)
+void load_words(bloom_t *filter, bloom_scalable_t *sfilter, char *filename)
 {
-   unsigned int hash = len;
-   unsigned int i    = 0;
+	struct loader l;
 
-   for(i = 0; i < len; str++, i++)
-   {
-      hash = ((hash << 5) ^ (hash >> 27)) ^ (*str);
-   }
-   return hash;
+	l.filter = filter;
+	l.sfilter = sfilter;
+	l.n = 0;
+	if (bloom_each_line(filename, load_line, &l, 1) < 0)
+		err("unable to open dictionary \"%s\"\n", filename);
+	if (l.n > 0)
+		bloom_add_hashes(filter, l.hashes, l.n);
 }
-
-unsigned int FNVHash(unsigned char *str, unsigned int len)
-{
-   const unsigned int fnv_prime = 0x811C9DC5;
-   unsigned int hash      = 0;
-   unsigned int i         = 0;
-
-   for(i = 0; i < len; str++, i++)
-   {
-      hash *= fnv_prime;
-      hash ^= (*str);
-   }
-
-   return hash;
-}
\ No newline at end of file
@@ -0,0 +1,278 @@
+/*******************************************************************************
+*
+* cuckoo.c -- cuckoo filter, see cuckoo.h
+*
+*******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cuckoo.h"
+
+#define LOAD_FACTOR	0.95
+#define LANES		0x0001000100010001ULL
+#define HIGHS		0x8000800080008000ULL
+
+#define CUCKOO_MAGIC	"CUCKOO1"
+
+struct cuckoo_header {
+	char magic[8];
+	uint64_t nbuckets;
+	uint64_t count;
+	uint64_t victim_bucket;
+	uint64_t seed;
+	uint16_t victim;
+	char pad[22];
+};
+
+typedef char cuckoo_header_size[sizeof(struct cuckoo_header) == 64 ? 1 : -1];
+
+/* some 16-bit lane of x is zero */
+static inline uint64_t has_zero(uint64_t x)
+{
+	return (x - LANES) & ~x & HIGHS;
+}
+
+static inline int bucket_has(uint64_t bucket, uint16_t fp)
+{
+	return has_zero(bucket ^ (fp * LANES)) != 0;
+}
+
+static inline uint64_t alt_bucket(const cuckoo_t *cf, uint64_t i, uint16_t fp)
+{
+	return (i ^ (fp * 0x5bd1e995ULL)) & (cf->nbuckets - 1);
+}
+
+/* fingerprint from the top bits, bucket from the bottom ones */
+static inline uint16_t split_hash(const cuckoo_t *cf, const void *key,
+				  size_t len, uint64_t *i)
+{
+	uint64_t h = WyHash64(key, len, cf->seed);
+	uint16_t fp = (uint16_t)(h >> 48);
+
+	*i = h & (cf->nbuckets - 1);
+	return fp ? fp : 1;
+}
+
+static int bucket_insert(cuckoo_t *cf, uint64_t i, uint16_t fp)
+{
+	uint64_t b = cf->buckets[i];
+	int s;
+
+	for (s = 0; s < CUCKOO_SLOTS; s++) {
+		if (((b >> (s * 16)) & 0xffff) == 0) {
+			cf->buckets[i] = b | ((uint64_t)fp << (s * 16));
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static int bucket_delete(cuckoo_t *cf, uint64_t i, uint16_t fp)
+{
+	uint64_t b = cf->buckets[i];
+	int s;
+
+	for (s = 0; s < CUCKOO_SLOTS; s++) {
+		if (((b >> (s * 16)) & 0xffff) == fp) {
+			cf->buckets[i] = b & ~(0xffffULL << (s * 16));
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static inline uint64_t next_rand(cuckoo_t *cf)
+{
+	cf->rand ^= cf->rand << 13;
+	cf->rand ^= cf->rand >> 7;
+	cf->rand ^= cf->rand << 17;
+	return cf->rand;
+}
+
+cuckoo_t *cuckoo_create(uint64_t n)
+{
+	uint64_t want = (uint64_t)(n / (CUCKOO_SLOTS * LOAD_FACTOR)) + 1;
+	cuckoo_t *cf = calloc(1, sizeof(cuckoo_t));
+
+	if (!cf)
+		return NULL;
+	cf->nbuckets = 1;
+	while (cf->nbuckets < want)
+		cf->nbuckets *= 2;
+	cf->rand = 88172645463325252ULL;
+	cf->buckets = calloc(cf->nbuckets, sizeof(uint64_t));
+	if (!cf->buckets) {
+		free(cf);
+		return NULL;
+	}
+	return cf;
+}
+
+void cuckoo_destroy(cuckoo_t *cf)
+{
+	if (!cf)
+		return;
+	if (cf->map)
+		munmap(cf->map, cf->map_len);
+	else
+		free(cf->buckets);
+	free(cf);
+}
+
+int cuckoo_add(cuckoo_t *cf, const void *key, size_t len)
+{
+	uint64_t i, old;
+	uint16_t fp = split_hash(cf, key, len, &i), kicked;
+	int n, s;
+
+	if (cf->victim)
+		return -1;
+	if (bucket_insert(cf, i, fp) || bucket_insert(cf, alt_bucket(cf, i, fp), fp)) {
+		cf->count++;
+		return 0;
+	}
+
+	/* both full: put fp in a random slot and move the one it replaced */
+	if (next_rand(cf) & 1)
+		i = alt_bucket(cf, i, fp);
+	for (n = 0; n < CUCKOO_MAX_KICKS; n++) {
+		s = next_rand(cf) % CUCKOO_SLOTS;
+		old = cf->buckets[i];
+		kicked = (uint16_t)(old >> (s * 16));
+		cf->buckets[i] = (old & ~(0xffffULL << (s * 16))) |
+				 ((uint64_t)fp << (s * 16));
+		fp = kicked;
+		i = alt_bucket(cf, i, fp);
+		if (bucket_insert(cf, i, fp)) {
+			cf->count++;
+			return 0;
+		}
+	}
+	/* the key is in, but whoever is homeless now waits here */
+	cf->victim = fp;
+	cf->victim_bucket = i;
+	cf->count++;
+	return 0;
+}
+
+int cuckoo_check(const cuckoo_t *cf, const void *key, size_t len)
+{
+	uint64_t i1, i2;
+	uint16_t fp = split_hash(cf, key, len, &i1);
+
+	i2 = alt_bucket(cf, i1, fp);
+	if (bucket_has(cf->buckets[i1], fp) || bucket_has(cf->buckets[i2], fp))
+		return 1;
+	return cf->victim == fp && (cf->victim_bucket == i1 ||
+				    cf->victim_bucket == i2);
+}
+
+int cuckoo_remove(cuckoo_t *cf, const void *key, size_t len)
+{
+	uint64_t i1, i2;
+	uint16_t fp = split_hash(cf, key, len, &i1), v;
+
+	i2 = alt_bucket(cf, i1, fp);
+	if (bucket_delete(cf, i1, fp) || bucket_delete(cf, i2, fp)) {
+		cf->count--;
+		/* a slot is free now, maybe for the victim */
+		v = cf->victim;
+		if (v && (bucket_insert(cf, cf->victim_bucket, v) ||
+			  bucket_insert(cf, alt_bucket(cf, cf->victim_bucket, v), v)))
+			cf->victim = 0;
+		return 1;
+	}
+	if (cf->victim == fp && (cf->victim_bucket == i1 ||
+				 cf->victim_bucket == i2)) {
+		cf->victim = 0;
+		cf->count--;
+		return 1;
+	}
+	return 0;
+}
+
+/* a lookup compares against the 8 slots of its two buckets */
+double cuckoo_fpp(const cuckoo_t *cf)
+{
+	double load = (double)cf->count / (cf->nbuckets * CUCKOO_SLOTS);
+	double per_slot = 1.0 / 65535;
+
+	return 1 - pow(1 - per_slot, 2 * CUCKOO_SLOTS * load);
+}
+
+uint64_t cuckoo_memory(const cuckoo_t *cf)
+{
+	return cf->nbuckets * sizeof(uint64_t);
+}
+
+int cuckoo_save(const cuckoo_t *cf, const char *path)
+{
+	struct cuckoo_header h;
+	FILE *fp = fopen(path, "wb");
+	int ret = 0;
+
+	if (!fp)
+		return -1;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, CUCKOO_MAGIC, sizeof(h.magic));
+	h.nbuckets = cf->nbuckets;
+	h.count = cf->count;
+	h.victim_bucket = cf->victim_bucket;
+	h.victim = cf->victim;
+	h.seed = cf->seed;
+	if (fwrite(&h, sizeof(h), 1, fp) != 1 ||
+	    fwrite(cf->buckets, sizeof(uint64_t), cf->nbuckets, fp) != cf->nbuckets)
+		ret = -1;
+	if (fclose(fp) != 0)
+		ret = -1;
+	return ret;
+}
+
+/* private mapping like bloom_open: changes stay in memory.
+ * victim_bucket is used as an index by cuckoo_remove, so check it too */
+cuckoo_t *cuckoo_open(const char *path)
+{
+	struct cuckoo_header *h;
+	struct stat st;
+	cuckoo_t *cf;
+	char *base;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+	if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(*h)) {
+		close(fd);
+		return NULL;
+	}
+	base = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED)
+		return NULL;
+	h = (struct cuckoo_header *)base;
+	cf = calloc(1, sizeof(cuckoo_t));
+	if (!cf || memcmp(h->magic, CUCKOO_MAGIC, sizeof(h->magic)) ||
+	    h->nbuckets == 0 || (h->nbuckets & (h->nbuckets - 1)) ||
+	    h->nbuckets > (st.st_size - sizeof(*h)) / sizeof(uint64_t) ||
+	    (h->victim && h->victim_bucket >= h->nbuckets)) {
+		free(cf);
+		munmap(base, st.st_size);
+		return NULL;
+	}
+	cf->buckets = (uint64_t *)(base + sizeof(*h));
+	cf->nbuckets = h->nbuckets;
+	cf->count = h->count;
+	cf->victim_bucket = h->victim_bucket;
+	cf->victim = h->victim;
+	cf->seed = h->seed;
+	cf->rand = 88172645463325252ULL;
+	cf->map = base;
+	cf->map_len = st.st_size;
+	return cf;
+}
@@ -0,0 +1,64 @@
+/*******************************************************************************
+*
+* cuckoo.h -- cuckoo filter, the alternative to a counting Bloom filter
+*
+* every key leaves a 16-bit fingerprint in one of two buckets of 4 slots;
+* the second bucket is the first xor a hash of the fingerprint, so a
+* fingerprint can be moved without the key. lookups read two buckets (one
+* 64-bit word each), removes are exact for keys that were added, and the
+* false positive rate is about 8 / 2^16 = 0.00012 at full load.
+*
+* the table has a power of two of buckets, sized for n keys at 95% load.
+* when an add gives up after CUCKOO_MAX_KICKS moves the homeless fingerprint
+* is kept aside and the filter refuses further adds.
+*
+* a filter can be saved and opened again with mmap like bloom.h.
+*
+*******************************************************************************/
+
+#ifndef __CUCKOO_H__
+#define __CUCKOO_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "hashfn.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CUCKOO_SLOTS		4
+#define CUCKOO_MAX_KICKS	500
+
+typedef struct cuckoo {
+	uint64_t *buckets;	/* 4 fingerprints per word, 0 is empty */
+	uint64_t nbuckets;
+	uint64_t count;
+	uint64_t victim_bucket;
+	uint16_t victim;	/* fingerprint that found no room, 0 if none */
+	uint64_t seed;
+	uint64_t rand;		/* picks which fingerprint to kick */
+	void *map;
+	size_t map_len;
+} cuckoo_t;
+
+cuckoo_t *cuckoo_create(uint64_t n);
+void cuckoo_destroy(cuckoo_t *cf);
+
+/* 0 added, -1 full */
+int cuckoo_add(cuckoo_t *cf, const void *key, size_t len);
+int cuckoo_check(const cuckoo_t *cf, const void *key, size_t len);
+/* 1 removed, 0 not in the filter */
+int cuckoo_remove(cuckoo_t *cf, const void *key, size_t len);
+
+double cuckoo_fpp(const cuckoo_t *cf);
+uint64_t cuckoo_memory(const cuckoo_t *cf);
+
+int cuckoo_save(const cuckoo_t *cf, const char *path);
+cuckoo_t *cuckoo_open(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
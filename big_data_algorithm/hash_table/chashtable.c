@@ -0,0 +1,610 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/* ƬĲϣƬڲıṹhashtable.cͬ(hashtable_group.h)
+ * дзƬkeyдòreleaseдֽڣֽ߳̿
+ * ܿkeyɾֻѿֽڸĳDELETEDĹãֱݻ
+ * ؽԱڵʱ򣬷Ĳ۵key䣬̱߳Ƚkeyǰȫġ
+ * дoldдcurǨȰkey±ٰѾɱĲ۸ĳDELETED
+ * Ҳд̡߳ȶcurٶoldȲɱٲ±ɱ￴
+ * DELETED˵±ĲѾɼűûУٶһcurû
+ * ûУ˵ʱֻ˱keyܸհߣزһ顣
+ * գݰľɱܻж߳ãµʱepoch
+ * ж߳̽ʱepochԺͷš */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "chashtable.h"
+#include "hashtable_group.h"
+
+#define CHASH_MIGRATE_GROUPS    1       /* ÿдἸ */
+#define CHASH_SHARD_MULT        0x9E3779B1U
+
+/* ÿ߳һactiveΪʱepoch0ʾڶ */
+typedef struct CHashReader{
+    uint64_t active;
+    int32_t in_use;
+    struct CHashReader* next;
+} __attribute__((aligned(CHASH_CACHE_LINE))) CHashReader;
+
+typedef struct CHashGarbage{
+    HashTab* tab;
+    uint64_t epoch;
+    struct CHashGarbage* next;
+} CHashGarbage;
+
+static CHashReader* readers = NULL;
+static uint64_t reader_epoch = 1;
+static pthread_key_t reader_key;
+static pthread_once_t reader_once = PTHREAD_ONCE_INIT;
+static __thread CHashReader* reader_self = NULL;
+
+
+/* ߳˳ʱѼ¼ȥԺ߳ */
+static void reader_release(void *arg){
+    CHashReader *r = (CHashReader *)arg;
+
+    __atomic_store_n(&r->active, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&r->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void reader_key_init(void){
+    pthread_key_create(&reader_key, reader_release);
+}
+
+static CHashReader* reader_get(void){
+    CHashReader *r;
+    int32_t unused = 0;
+
+    if (reader_self != NULL)
+    {
+        return reader_self;
+    }
+    pthread_once(&reader_once, reader_key_init);
+
+    for (r = __atomic_load_n(&readers, __ATOMIC_ACQUIRE); r != NULL;
+         r = r->next)
+    {
+        unused = 0;
+        if (__atomic_compare_exchange_n(&r->in_use, &unused, 1, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+        {
+            break;
+        }
+    }
+    if (r == NULL)
+    {
+        /* ¼ͷţֻ */
+        if (posix_memalign((void **)&r, CHASH_CACHE_LINE,
+                           sizeof(CHashReader)) != 0)
+        {
+            return NULL;
+        }
+        memset(r, 0, sizeof(CHashReader));
+        r->in_use = 1;
+        r->next = __atomic_load_n(&readers, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&readers, &r->next, r, 0,
+                                            __ATOMIC_RELEASE,
+                                            __ATOMIC_RELAXED))
+            ;
+    }
+    pthread_setspecific(reader_key, r);
+    reader_self = r;
+    return r;
+}
+
+/* 뿪seq_cstд߳ժɱɨactive˳ϣ
+ * ֤ɨʱûĶ߳һɱ */
+static inline void reader_enter(CHashReader *r){
+    __atomic_store_n(&r->active,
+                     __atomic_load_n(&reader_epoch, __ATOMIC_SEQ_CST),
+                     __ATOMIC_SEQ_CST);
+}
+
+static inline void reader_exit(CHashReader *r){
+    __atomic_store_n(&r->active, 0, __ATOMIC_RELEASE);
+}
+
+static void gc_free_tab(HashTab *tab){
+    tab_free(tab);
+    free(tab);
+}
+
+/* ɱѾӷƬժŽͷͷŵĶͷŵ */
+static void gc_retire(CHashtable *hashtable, HashTab *tab){
+    CHashGarbage *g, **pp;
+    CHashReader *r;
+    uint64_t min = UINT64_MAX, active;
+
+    g = (CHashGarbage *)malloc(sizeof(CHashGarbage));
+    if (g == NULL)
+    {
+        /* ܰȫͷţֻй© */
+        return;
+    }
+    g->tab = tab;
+    g->epoch = __atomic_fetch_add(&reader_epoch, 1, __ATOMIC_SEQ_CST);
+
+    for (r = __atomic_load_n(&readers, __ATOMIC_ACQUIRE); r != NULL;
+         r = r->next)
+    {
+        active = __atomic_load_n(&r->active, __ATOMIC_SEQ_CST);
+        if (active != 0 && active < min)
+        {
+            min = active;
+        }
+    }
+
+    pthread_mutex_lock(&hashtable->gc_lock);
+    g->next = hashtable->garbage;
+    hashtable->garbage = g;
+    for (pp = &hashtable->garbage; *pp != NULL; )
+    {
+        g = *pp;
+        if (g->epoch < min)
+        {
+            *pp = g->next;
+            gc_free_tab(g->tab);
+            free(g);
+        }
+        else
+        {
+            pp = &g->next;
+        }
+    }
+    pthread_mutex_unlock(&hashtable->gc_lock);
+}
+
+
+static inline CHashShard* shard_of(CHashtable *hashtable, uint32_t hash){
+    if (hashtable->shard_bits == 0)
+    {
+        return hashtable->shards;
+    }
+    /* ֱùϣֵĸλͷƬѡõλ */
+    return hashtable->shards +
+           ((hash * CHASH_SHARD_MULT) >> (32 - hashtable->shard_bits));
+}
+
+
+/* ߳Ҳãȶֽڣacquire֮ٶ */
+static HashSlot* ctab_find(HashTab *tab, const char *key, uint32_t len,
+                           uint32_t hash){
+    uint32_t gmask, g, i, mask, bit;
+    const int8_t *ctrl;
+    HashSlot *slot;
+
+    gmask = tab->capacity / HASH_GROUP_SIZE - 1;
+    g = H1(hash) & gmask;
+    for (i = 1; ; i++)
+    {
+        ctrl = tab->ctrl + g * HASH_GROUP_SIZE;
+        mask = group_match(ctrl, H2(hash));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        for (; mask; mask &= mask - 1)
+        {
+            bit = __builtin_ctz(mask);
+            slot = tab->slots + g * HASH_GROUP_SIZE + bit;
+            if (slot->hash == hash && slot->len == len &&
+                memcmp(slot_key(slot), key, len) == 0)
+            {
+                return slot;
+            }
+        }
+        if (group_match(ctrl, CTRL_EMPTY))
+        {
+            return NULL;
+        }
+        g = (g + i) & gmask;
+        /* ̲߳ûпղ۵ı */
+        if (i > tab->capacity / HASH_GROUP_SIZE)
+        {
+            return NULL;
+        }
+    }
+}
+
+/* дkeyvalueдֽڣǰ֤growth_left0
+ * ֻÿղۣ߳̿ڱȽĹľkeyûkeyĵ */
+static HashSlot* ctab_insert(HashTab *tab, const char *key, uint32_t len,
+                             uint32_t hash, char *value){
+    uint32_t gmask, g, i, mask, idx;
+    HashSlot *slot;
+
+    gmask = tab->capacity / HASH_GROUP_SIZE - 1;
+    g = H1(hash) & gmask;
+    for (i = 1; ; i++)
+    {
+        mask = group_match(tab->ctrl + g * HASH_GROUP_SIZE, CTRL_EMPTY);
+        if (mask)
+        {
+            break;
+        }
+        g = (g + i) & gmask;
+    }
+    idx = g * HASH_GROUP_SIZE + __builtin_ctz(mask);
+    slot = tab->slots + idx;
+    if (tab_set_key(tab, slot, key, len, hash) == -1)
+    {
+        return NULL;
+    }
+    slot->value = value;
+    tab->growth_left--;
+    __atomic_store_n(&tab->ctrl[idx], H2(hash), __ATOMIC_RELEASE);
+    return slot;
+}
+
+
+/* ˣժɱepoch */
+static void shard_migrate_done(CHashtable *hashtable, CHashShard *shard){
+    HashTab *old = shard->old;
+
+    /* ɱkeyѾ±ˣ̲߳ɱҲ© */
+    __atomic_store_n(&shard->old, NULL, __ATOMIC_SEQ_CST);
+    shard->migrate_pos = 0;
+
+    gc_retire(hashtable, old);
+}
+
+/* Ѿɱnᵽ±зƬ */
+static void shard_migrate(CHashtable *hashtable, CHashShard *shard,
+                          uint32_t n){
+    HashTab *old = shard->old;
+    HashSlot *from;
+    uint32_t groups, idx, end;
+
+    if (old == NULL)
+    {
+        return;
+    }
+    groups = old->capacity / HASH_GROUP_SIZE;
+
+    for (; n > 0 && shard->migrate_pos < groups; n--)
+    {
+        idx = shard->migrate_pos * HASH_GROUP_SIZE;
+        for (end = idx + HASH_GROUP_SIZE; idx < end; idx++)
+        {
+            if (old->ctrl[idx] < 0)
+            {
+                continue;
+            }
+            from = old->slots + idx;
+            if (ctab_insert(shard->cur, slot_key(from), from->len,
+                            from->hash, from->value) == NULL)
+            {
+                return;
+            }
+            /* ±ĲѾ߳̿DELETED±ҵ */
+            __atomic_store_n(&old->ctrl[idx], CTRL_DELETED, __ATOMIC_RELEASE);
+        }
+        shard->migrate_pos++;
+    }
+
+    if (shard->migrate_pos == groups)
+    {
+        shard_migrate_done(hashtable, shard);
+    }
+}
+
+/* ͬhashtable.cstart_resizeȷoldٷcur
+ * ̶߳µcurʱһܶold */
+static int32_t shard_resize(CHashtable *hashtable, CHashShard *shard){
+    HashTab *cur = shard->cur;
+    HashTab *tab;
+    uint32_t capacity = cur->capacity;
+
+    if (shard->old != NULL)
+    {
+        shard_migrate(hashtable, shard, shard->old->capacity);
+        if (shard->old != NULL || cur->growth_left > 0)
+        {
+            return cur->growth_left > 0 ? 0 : -1;
+        }
+    }
+    if ((uint32_t)shard->item_size >= capacity / 16 * 7)
+    {
+        capacity *= 2;
+    }
+    if (capacity > HASH_MAX_CAPACITY)
+    {
+        return -1;
+    }
+    tab = (HashTab *)malloc(sizeof(HashTab));
+    if (tab == NULL || tab_alloc(tab, capacity) == -1)
+    {
+        free(tab);
+        return -1;
+    }
+
+    shard->migrate_pos = 0;
+    __atomic_store_n(&shard->old, cur, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&shard->cur, tab, __ATOMIC_SEQ_CST);
+
+    shard_migrate(hashtable, shard, CHASH_MIGRATE_GROUPS);
+    return 0;
+}
+
+/* ҵkeyĲۣûоͲһvalueΪinitģзƬ */
+static HashSlot* shard_lookup_insert(CHashtable *hashtable, CHashShard *shard,
+                                     const char *key, uint32_t len,
+                                     uint32_t hash, char *init, int32_t *added){
+    HashSlot *slot;
+
+    *added = 0;
+    shard_migrate(hashtable, shard, CHASH_MIGRATE_GROUPS);
+
+    slot = ctab_find(shard->cur, key, len, hash);
+    if (slot == NULL && shard->old != NULL)
+    {
+        slot = ctab_find(shard->old, key, len, hash);
+    }
+    if (slot != NULL)
+    {
+        return slot;
+    }
+
+    if (shard->cur->growth_left == 0 && shard_resize(hashtable, shard) == -1)
+    {
+        return NULL;
+    }
+    slot = ctab_insert(shard->cur, key, len, hash, init);
+    if (slot != NULL)
+    {
+        shard->item_size++;
+        *added = 1;
+    }
+    return slot;
+}
+
+
+/*ʼ*/
+CHashtable* chashtable_init(int32_t size, int32_t nshards){
+    CHashtable *hashtable;
+    CHashShard *shard;
+    uint32_t bits = 0, capacity, per_shard, i;
+
+    while ((1 << bits) < nshards && bits < 16)
+    {
+        bits++;
+    }
+    per_shard = (size > 0 ? (uint32_t)size : 0) >> bits;
+    capacity = HASH_GROUP_SIZE;
+    while (capacity < HASH_MAX_CAPACITY &&
+           capacity - capacity / 8 < per_shard)
+    {
+        capacity *= 2;
+    }
+
+    hashtable = (CHashtable *)calloc(1, sizeof(CHashtable));
+    if (hashtable == NULL)
+    {
+        return NULL;
+    }
+    hashtable->shard_bits = bits;
+    pthread_mutex_init(&hashtable->gc_lock, NULL);
+    if (posix_memalign((void **)&hashtable->shards, CHASH_CACHE_LINE,
+                       sizeof(CHashShard) << bits) != 0)
+    {
+        free(hashtable);
+        return NULL;
+    }
+    memset(hashtable->shards, 0, sizeof(CHashShard) << bits);
+
+    for (i = 0; i < (1U << bits); i++)
+    {
+        shard = hashtable->shards + i;
+        pthread_mutex_init(&shard->lock, NULL);
+        shard->cur = (HashTab *)malloc(sizeof(HashTab));
+        if (shard->cur == NULL || tab_alloc(shard->cur, capacity) == -1)
+        {
+            free(shard->cur);
+            shard->cur = NULL;
+            chashtable_destroy(hashtable);
+            return NULL;
+        }
+    }
+    return hashtable;
+}
+
+/*һ*/
+void chashtable_put(CHashtable *hashtable, char* key, char* value){
+    uint32_t len = strlen(key);
+    uint32_t hash = hash_key(key, len);
+    CHashShard *shard = shard_of(hashtable, hash);
+    HashSlot *slot;
+    int32_t added;
+
+    pthread_mutex_lock(&shard->lock);
+    slot = shard_lookup_insert(hashtable, shard, key, len, hash, value,
+                               &added);
+    if (slot != NULL && !added)
+    {
+        /* ֻvaluekeyû䣬̲߳ض */
+        __atomic_store_n(&slot->value, value, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&shard->lock);
+
+    if (slot == NULL)
+    {
+        fprintf(stderr, "chashtable: out of memory, %s not added\n", key);
+    }
+}
+
+/**/
+intptr_t chashtable_incr(CHashtable *hashtable, char* key, intptr_t delta){
+    uint32_t len = strlen(key);
+    uint32_t hash = hash_key(key, len);
+    CHashShard *shard = shard_of(hashtable, hash);
+    HashSlot *slot;
+    intptr_t ret = 0;
+    int32_t added;
+
+    pthread_mutex_lock(&shard->lock);
+    slot = shard_lookup_insert(hashtable, shard, key, len, hash,
+                               (char *)delta, &added);
+    if (slot != NULL)
+    {
+        ret = added ? delta :
+              __atomic_add_fetch((intptr_t *)&slot->value, delta,
+                                 __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&shard->lock);
+
+    if (slot == NULL)
+    {
+        fprintf(stderr, "chashtable: out of memory, %s not added\n", key);
+    }
+    return ret;
+}
+
+/* ò̼߳¼(ڴ治)ʱûepochֻܼ飬
+ * зƬʱcuroldᱻ */
+static char* shard_get_locked(CHashShard *shard, const char *key, uint32_t len,
+                              uint32_t hash){
+    HashSlot *slot = NULL;
+    char *value = NULL;
+
+    pthread_mutex_lock(&shard->lock);
+    if (shard->old != NULL)
+    {
+        slot = ctab_find(shard->old, key, len, hash);
+    }
+    if (slot == NULL)
+    {
+        slot = ctab_find(shard->cur, key, len, hash);
+    }
+    if (slot != NULL)
+    {
+        value = __atomic_load_n(&slot->value, __ATOMIC_ACQUIRE);
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return value;
+}
+
+/*ȡһ*/
+char* chashtable_get(CHashtable *hashtable, char* key){
+    uint32_t len = strlen(key);
+    uint32_t hash = hash_key(key, len);
+    CHashShard *shard = shard_of(hashtable, hash);
+    CHashReader *r = reader_get();
+    HashSlot *slot;
+    HashTab *cur, *old;
+    char *value = NULL;
+
+    if (r == NULL)
+    {
+        return shard_get_locked(shard, key, len, hash);
+    }
+    reader_enter(r);
+    cur = __atomic_load_n(&shard->cur, __ATOMIC_SEQ_CST);
+    for (;;)
+    {
+        /* ǨȲ±ɾɱȲɱ */
+        slot = NULL;
+        old = __atomic_load_n(&shard->old, __ATOMIC_SEQ_CST);
+        if (old != NULL)
+        {
+            slot = ctab_find(old, key, len, hash);
+        }
+        if (slot == NULL)
+        {
+            slot = ctab_find(cur, key, len, hash);
+        }
+        if (slot != NULL)
+        {
+            value = __atomic_load_n(&slot->value, __ATOMIC_ACQUIRE);
+            break;
+        }
+
+        /* curû䣬keyͲcurߣûҵûУ
+         * ÿز鶼˵д߳һλһֱز */
+        old = cur;
+        cur = __atomic_load_n(&shard->cur, __ATOMIC_SEQ_CST);
+        if (cur == old)
+        {
+            break;
+        }
+    }
+    reader_exit(r);
+    return value;
+}
+
+/*ɾһ*/
+void chashtable_remove(CHashtable *hashtable, char* key){
+    uint32_t len = strlen(key);
+    uint32_t hash = hash_key(key, len);
+    CHashShard *shard = shard_of(hashtable, hash);
+    HashTab *tab;
+    HashSlot *slot;
+
+    pthread_mutex_lock(&shard->lock);
+    shard_migrate(hashtable, shard, CHASH_MIGRATE_GROUPS);
+
+    tab = shard->cur;
+    slot = ctab_find(tab, key, len, hash);
+    if (slot == NULL && shard->old != NULL)
+    {
+        tab = shard->old;
+        slot = ctab_find(tab, key, len, hash);
+    }
+    if (slot != NULL)
+    {
+        /* Ĺڻǰᱻãkey䣬̲߳ض */
+        __atomic_store_n(&tab->ctrl[slot - tab->slots], CTRL_DELETED,
+                         __ATOMIC_RELEASE);
+        tab->deleted++;
+        shard->item_size--;
+    }
+    pthread_mutex_unlock(&shard->lock);
+}
+
+/*Ԫظ*/
+int32_t chashtable_count(CHashtable *hashtable){
+    int32_t count = 0;
+    uint32_t i;
+
+    for (i = 0; i < (1U << hashtable->shard_bits); i++)
+    {
+        count += __atomic_load_n(&hashtable->shards[i].item_size,
+                                 __ATOMIC_RELAXED);
+    }
+    return count;
+}
+
+/**/
+void chashtable_destroy(CHashtable *hashtable){
+    CHashGarbage *g, *next;
+    CHashShard *shard;
+    uint32_t i;
+
+    for (i = 0; i < (1U << hashtable->shard_bits); i++)
+    {
+        shard = hashtable->shards + i;
+        if (shard->cur != NULL)
+        {
+            gc_free_tab(shard->cur);
+        }
+        if (shard->old != NULL)
+        {
+            gc_free_tab(shard->old);
+        }
+        pthread_mutex_destroy(&shard->lock);
+    }
+    for (g = hashtable->garbage; g != NULL; g = next)
+    {
+        next = g->next;
+        gc_free_tab(g->tab);
+        free(g);
+    }
+    pthread_mutex_destroy(&hashtable->gc_lock);
+    free(hashtable->shards);
+    free(hashtable);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,65 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#ifndef __CHASHTABLE_H__
+#define __CHASHTABLE_H__
+
+#include <stdint.h>
+#include <pthread.h>
+#include "hashtable.h"
+
+/* ̹߳õĹϣϣֳֵɸƬÿƬһhashtable
+ * ĿѰַдзƬҲȴд̣߳
+ * ²ۺ±release߳epochȲɱٲ±
+ * ɾµĹݻؽ֮ǰá
+ * ݰƬУҲǽģֻӰݵķƬд
+ * ݺɱڴepochգж̶߳뿪ɱͷš
+ * valueָֻ룬chashtable_incrvalueʹá */
+
+#define CHASH_CACHE_LINE    64
+
+typedef struct CHashShard{
+    pthread_mutex_t lock;           /* д */
+    HashTab* cur;
+    HashTab* old;                   /* еľɱNULLʾû */
+    uint32_t migrate_pos;
+    int32_t item_size;
+} __attribute__((aligned(CHASH_CACHE_LINE))) CHashShard;
+
+struct CHashGarbage;
+
+typedef struct CHashtable{
+    uint32_t shard_bits;
+    CHashShard* shards;
+    pthread_mutex_t gc_lock;
+    struct CHashGarbage* garbage;   /* ȴͷŵľɱ */
+} CHashtable;
+
+
+/*ʼsizeΪԤƵԪظnshardsȡ2*/
+CHashtable* chashtable_init(int32_t size, int32_t nshards);
+
+/*һѴھ滻value*/
+void chashtable_put(CHashtable *hashtable, char* key, char* value);
+
+/*valuedeltaʱ0ʼµֵ*/
+intptr_t chashtable_incr(CHashtable *hashtable, char* key, intptr_t delta);
+
+/*ȡһ*/
+char* chashtable_get(CHashtable *hashtable, char* key);
+
+/*ɾһ*/
+void chashtable_remove(CHashtable *hashtable, char* key);
+
+/*Ԫظ*/
+int32_t chashtable_count(CHashtable *hashtable);
+
+/*٣ʱ߳ʹ*/
+void chashtable_destroy(CHashtable *hashtable);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
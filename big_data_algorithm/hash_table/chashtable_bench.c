@@ -0,0 +1,203 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/* ϣ²ԣ̶߳ͬһűgetincr()
+ * ͬ߳ͶܣһѴhashtableԱȡ
+ * ӺСʼԹлһֱݡ
+ * keyļ֮͵incrĴ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include "hashtable.h"
+#include "chashtable.h"
+
+#define KEY_STRIDE      16
+#define MAX_THREADS     64
+
+enum {
+    ENGINE_CONCURRENT,
+    ENGINE_LOCKED,
+};
+
+static const char *engine_name[] = {"chashtable      ", "hashtable+mutex "};
+
+static char *keys;
+static uint32_t nkeys = 1000000;
+static uint64_t total_ops = 4000000;
+static int32_t nshards = 64;
+
+static CHashtable *ctable;
+static Hashtable *table;
+static pthread_mutex_t table_lock = PTHREAD_MUTEX_INITIALIZER;
+
+struct bench_arg {
+    int32_t engine;
+    int32_t read_pct;
+    uint64_t ops;
+    uint64_t seed;
+    uint64_t writes;
+    pthread_t tid;
+};
+
+static double now_sec(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static inline uint64_t xorshift(uint64_t *s){
+    uint64_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *s = x;
+}
+
+static void *bench_thread(void *data){
+    struct bench_arg *arg = (struct bench_arg *)data;
+    uint64_t i, r;
+    char *key;
+
+    for (i = 0; i < arg->ops; i++)
+    {
+        r = xorshift(&arg->seed);
+        key = keys + (size_t)((r >> 8) % nkeys) * KEY_STRIDE;
+        if ((int32_t)(r & 0xff) * 100 < arg->read_pct * 256)
+        {
+            if (arg->engine == ENGINE_CONCURRENT)
+            {
+                chashtable_get(ctable, key);
+            }
+            else
+            {
+                pthread_mutex_lock(&table_lock);
+                hashtable_get(table, key);
+                pthread_mutex_unlock(&table_lock);
+            }
+            continue;
+        }
+        arg->writes++;
+        if (arg->engine == ENGINE_CONCURRENT)
+        {
+            chashtable_incr(ctable, key, 1);
+        }
+        else
+        {
+            pthread_mutex_lock(&table_lock);
+            hashtable_put(table, key,
+                          (char *)((intptr_t)hashtable_get(table, key) + 1));
+            pthread_mutex_unlock(&table_lock);
+        }
+    }
+    return NULL;
+}
+
+static int32_t run_bench(int32_t engine, int32_t nthreads, int32_t read_pct){
+    struct bench_arg args[MAX_THREADS];
+    uint64_t writes = 0, sum = 0;
+    double t;
+    uint32_t i;
+    char *v;
+
+    if (engine == ENGINE_CONCURRENT)
+        ctable = chashtable_init(0, nshards);
+    else
+        table = hashtable_init(0);
+
+    memset(args, 0, sizeof(args));
+    t = now_sec();
+    for (i = 0; i < (uint32_t)nthreads; i++)
+    {
+        args[i].engine = engine;
+        args[i].read_pct = read_pct;
+        args[i].ops = total_ops / nthreads;
+        args[i].seed = 0x9E3779B97F4A7C15ULL * (i + 1);
+        pthread_create(&args[i].tid, NULL, bench_thread, &args[i]);
+    }
+    for (i = 0; i < (uint32_t)nthreads; i++)
+    {
+        pthread_join(args[i].tid, NULL);
+        writes += args[i].writes;
+    }
+    t = now_sec() - t;
+
+    for (i = 0; i < nkeys; i++)
+    {
+        if (engine == ENGINE_CONCURRENT)
+            v = chashtable_get(ctable, keys + (size_t)i * KEY_STRIDE);
+        else
+            v = hashtable_get(table, keys + (size_t)i * KEY_STRIDE);
+        sum += (intptr_t)v;
+    }
+
+    printf("%s threads %2d, read %2d%%: %7.2f Mops/s, %s\n",
+           engine_name[engine], nthreads, read_pct,
+           (double)(total_ops / nthreads * nthreads) / t / 1e6,
+           sum == writes ? "counts ok" : "COUNTS WRONG");
+
+    if (engine == ENGINE_CONCURRENT)
+        chashtable_destroy(ctable);
+    else
+        hashtable_destroy(table);
+    return sum == writes ? 0 : -1;
+}
+
+static void usage(char *name){
+    fprintf(stderr, "Usage: %s [-k keys] [-o total_ops] [-s shards] "
+            "[-t max_threads]\n"
+            "  runs 1, 2, 4 ... max_threads (default 8) threads with "
+            "50%%, 90%% and 99%% reads\n", name);
+    exit(EXIT_FAILURE);
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    int32_t read_pcts[] = {50, 90, 99};
+    int32_t max_threads = 8, nthreads, engine, opt, ret = 0;
+    uint32_t i, j;
+
+    while ((opt = getopt(argc, argv, "k:o:s:t:h")) != -1) {
+        switch (opt) {
+        case 'k': nkeys = strtoul(optarg, NULL, 0); break;
+        case 'o': total_ops = strtoull(optarg, NULL, 0); break;
+        case 's': nshards = atoi(optarg); break;
+        case 't': max_threads = atoi(optarg); break;
+        default: usage(argv[0]);
+        }
+    }
+    if (nkeys == 0 || total_ops == 0 || nshards <= 0 ||
+        max_threads <= 0 || max_threads > MAX_THREADS)
+        usage(argv[0]);
+
+    keys = (char *)malloc((size_t)nkeys * KEY_STRIDE);
+    if (keys == NULL)
+        return 1;
+    for (i = 0; i < nkeys; i++)
+        snprintf(keys + (size_t)i * KEY_STRIDE, KEY_STRIDE, "k%u", i);
+
+    printf("%u keys, %lu ops, %d shards, %ld cpus\n", nkeys,
+           (unsigned long)total_ops, nshards, sysconf(_SC_NPROCESSORS_ONLN));
+    for (j = 0; j < sizeof(read_pcts) / sizeof(read_pcts[0]); j++)
+    {
+        for (nthreads = 1; nthreads <= max_threads; nthreads *= 2)
+        {
+            for (engine = ENGINE_CONCURRENT; engine <= ENGINE_LOCKED; engine++)
+            {
+                if (run_bench(engine, nthreads, read_pcts[j]) != 0)
+                    ret = 1;
+            }
+        }
+    }
+    free(keys);
+    return ret;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,165 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdint.h> /* uint64_t*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "chashtable.h"
+
+/* дԣд̶߳Լһkeyɾ²룬߳ͬʱ
+ * һkeyHASH_INLINE_KEY(ڲ)һ볤(ָ)Ĺݶ
+ * valuekeyţvalueҪôNULLҪôkeyġ */
+
+#define NKEYS       4096
+#define WRITERS     2
+#define READERS     2
+#define ROUNDS      200
+#define NPINNED     64
+
+static CHashtable *table;
+static char keys[NKEYS][48];
+static char pinned[NPINNED][48];
+static volatile int32_t stop = 0;
+static uint64_t wrong = 0;
+static uint64_t lost = 0;
+
+static inline uint64_t xorshift(uint64_t *s){
+    *s ^= *s << 13;
+    *s ^= *s >> 7;
+    *s ^= *s << 17;
+    return *s;
+}
+
+static inline char* make_value(uint32_t idx, uint32_t round){
+    return (char *)(intptr_t)(((uint64_t)idx << 32) | (round + 1));
+}
+
+static void *writer(void *data){
+    uint32_t w = (uint32_t)(intptr_t)data;
+    uint32_t idx, round;
+
+    for (round = 0; round < ROUNDS; round++)
+    {
+        for (idx = w; idx < NKEYS; idx += WRITERS)
+        {
+            chashtable_remove(table, keys[idx]);
+            chashtable_put(table, keys[idx], make_value(idx, round));
+            /* һĹһֲŲ */
+            if ((idx / WRITERS + round) & 1)
+            {
+                chashtable_remove(table, keys[idx]);
+            }
+        }
+    }
+    return NULL;
+}
+
+static void *reader(void *data){
+    uint64_t seed = 88172645463325252ULL + (uint64_t)(intptr_t)data;
+    uint64_t bad = 0, miss = 0;
+    uint32_t idx;
+    char *value;
+
+    while (!__atomic_load_n(&stop, __ATOMIC_ACQUIRE))
+    {
+        idx = xorshift(&seed) % NKEYS;
+        value = chashtable_get(table, keys[idx]);
+        if (value != NULL && ((uint64_t)(intptr_t)value >> 32) != idx)
+        {
+            bad++;
+        }
+        /* һֱڱkeyǨͻʱҲܲ鲻 */
+        idx = xorshift(&seed) % NPINNED;
+        if (chashtable_get(table, pinned[idx]) != make_value(idx, 0))
+        {
+            miss++;
+        }
+    }
+    __atomic_add_fetch(&wrong, bad, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&lost, miss, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    pthread_t wt[WRITERS], rt[READERS];
+    uint32_t idx, expect = 0, missing = 0;
+    uint64_t v;
+    char *value;
+    int32_t i, count;
+
+    for (idx = 0; idx < NKEYS; idx++)
+    {
+        if (idx & 1)
+        {
+            snprintf(keys[idx], sizeof(keys[idx]), "k%u", idx);
+        }
+        else
+        {
+            snprintf(keys[idx], sizeof(keys[idx]), "a-much-longer-key-%u", idx);
+        }
+    }
+    /* ʼСԹл */
+    table = chashtable_init(16, 4);
+    if (table == NULL)
+    {
+        printf("init failed\n");
+        return 1;
+    }
+    for (idx = 0; idx < NPINNED; idx++)
+    {
+        snprintf(pinned[idx], sizeof(pinned[idx]), "pinned-%u", idx);
+        chashtable_put(table, pinned[idx], make_value(idx, 0));
+    }
+
+    for (i = 0; i < READERS; i++)
+    {
+        pthread_create(&rt[i], NULL, reader, (void *)(intptr_t)i);
+    }
+    for (i = 0; i < WRITERS; i++)
+    {
+        pthread_create(&wt[i], NULL, writer, (void *)(intptr_t)i);
+    }
+    for (i = 0; i < WRITERS; i++)
+    {
+        pthread_join(wt[i], NULL);
+    }
+    __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+    for (i = 0; i < READERS; i++)
+    {
+        pthread_join(rt[i], NULL);
+    }
+    printf("concurrent get, wrong values: %lu, lost keys: %lu\n",
+           (unsigned long)wrong, (unsigned long)lost);
+
+    /* һµkeyvalue */
+    for (idx = 0; idx < NKEYS; idx++)
+    {
+        value = chashtable_get(table, keys[idx]);
+        if ((idx / WRITERS + ROUNDS - 1) & 1)
+        {
+            missing += value != NULL;
+            continue;
+        }
+        expect++;
+        v = (uint64_t)(intptr_t)value;
+        missing += v != (uint64_t)(intptr_t)make_value(idx, ROUNDS - 1);
+    }
+    count = chashtable_count(table) - NPINNED;
+    printf("final: %d keys, expect %u, mismatched %u\n", count, expect, missing);
+
+    chashtable_destroy(table);
+    if (wrong != 0 || lost != 0 || missing != 0 || (uint32_t)count != expect)
+    {
+        return 1;
+    }
+    printf("all passed\n");
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
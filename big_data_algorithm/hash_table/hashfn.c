@@ -4,6 +4,11 @@ extern "C"{
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HASHFN_X86
+#endif
 
 #include "hashfn.h"
 
@@ -19,7 +24,7 @@ ReallySimpleHash (char *s, int32_t len)
 {
         uint32_t        hash = 0;
         for (;len > 0; len--)
-                hash ^= (char)s[len];
+                hash ^= (char)s[len - 1];
 
         return hash;
 }
@@ -203,6 +208,434 @@ unsigned int FNVHash(unsigned char *str, unsigned int len)
    return hash;
 }
 
+
+/*********************************\
+| 64-bit seeded hash functions    |
+\*********************************/
+
+/* wyhash final4, https://github.com/wangyi-fudan/wyhash */
+
+static const uint64_t wyp[4] = {
+    0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL,
+    0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL,
+};
+
+static inline void wymum(uint64_t *a, uint64_t *b){
+    __uint128_t r = (__uint128_t)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+}
+
+static inline uint64_t wymix(uint64_t a, uint64_t b){
+    wymum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t wyr8(const uint8_t *p){
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t wyr4(const uint8_t *p){
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint64_t wyr3(const uint8_t *p, size_t k){
+    return ((uint64_t)p[0] << 16) | ((uint64_t)p[k >> 1] << 8) | p[k - 1];
+}
+
+uint64_t WyHash64(const void *key, size_t len, uint64_t seed){
+    const uint8_t *p = (const uint8_t *)key;
+    uint64_t a, b, see1, see2;
+    size_t i = len;
+
+    seed ^= wymix(seed ^ wyp[0], wyp[1]);
+    if (len <= 16)
+    {
+        if (len >= 4)
+        {
+            a = (wyr4(p) << 32) | wyr4(p + ((len >> 3) << 2));
+            b = (wyr4(p + len - 4) << 32) | wyr4(p + len - 4 - ((len >> 3) << 2));
+        }
+        else if (len > 0)
+        {
+            a = wyr3(p, len);
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        if (i > 48)
+        {
+            /* ˷صִ */
+            see1 = seed;
+            see2 = seed;
+            do {
+                seed = wymix(wyr8(p) ^ wyp[1], wyr8(p + 8) ^ seed);
+                see1 = wymix(wyr8(p + 16) ^ wyp[2], wyr8(p + 24) ^ see1);
+                see2 = wymix(wyr8(p + 32) ^ wyp[3], wyr8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16)
+        {
+            seed = wymix(wyr8(p) ^ wyp[1], wyr8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = wyr8(p + i - 16);
+        b = wyr8(p + i - 8);
+    }
+    a ^= wyp[1];
+    b ^= seed;
+    wymum(&a, &b);
+    return wymix(a ^ wyp[0] ^ len, b ^ wyp[1]);
+}
+
+
+/* keyxxh3ۼӡ864λۼÿ64ֽһ
+ *   acc[i]   += (d[i] ^ k[i])32λ * 32λ
+ *   acc[i^1] += d[i]
+ * ÿõԿ8ֽڣ16Ϊһ飬βۼɢһΡ
+ * Կsplitmix64ɵ192ֽڣӼԿ */
+
+#define STRIPE_LEN              64
+#define STRIPE_LANES            8
+#define STRIPES_PER_BLOCK       16
+#define STRIPE_BLOCK_LEN        (STRIPE_LEN * STRIPES_PER_BLOCK)
+#define STRIPE_SECRET_WORDS     (STRIPE_LANES + STRIPES_PER_BLOCK)
+#define STRIPE_MIN_LEN          1024
+#define STRIPE_PRIME32          0x9E3779B1U
+
+static const uint64_t stripe_secret[STRIPE_SECRET_WORDS] = {
+    0xe220a8397b1dcdafULL, 0x6e789e6aa1b965f4ULL, 0x06c45d188009454fULL,
+    0xf88bb8a8724c81ecULL, 0x1b39896a51a8749bULL, 0x53cb9f0c747ea2eaULL,
+    0x2c829abe1f4532e1ULL, 0xc584133ac916ab3cULL, 0x3ee5789041c98ac3ULL,
+    0xf3b8488c368cb0a6ULL, 0x657eecdd3cb13d09ULL, 0xc2d326e0055bdef6ULL,
+    0x8621a03fe0bbdb7bULL, 0x8e1f7555983aa92fULL, 0xb54e0f1600cc4d19ULL,
+    0x84bb3f97971d80abULL, 0x7d29825c75521255ULL, 0xc3cf17102b7f7f86ULL,
+    0x3466e9a083914f64ULL, 0xd81a8d2b5a4485acULL, 0xdb01602b100b9ed7ULL,
+    0xa9038a921825f10dULL, 0xedf5f1d90dca2f6aULL, 0x54496ad67bd2634cULL,
+};
+
+typedef void (*stripe_fn)(uint64_t *acc, const uint8_t *p, size_t nstripes,
+                          const uint64_t *secret);
+typedef void (*scramble_fn)(uint64_t *acc, const uint64_t *secret);
+
+/* nstripesnsecret + n */
+static void stripes_scalar(uint64_t *acc, const uint8_t *p, size_t nstripes,
+                           const uint64_t *secret){
+    uint64_t a[STRIPE_LANES], d, dk;
+    size_t n;
+    int i;
+
+    /* ھֲۼӣԭSTRIPE_SSE2_LANE */
+    memcpy(a, acc, sizeof(a));
+    for (n = 0; n < nstripes; n++, p += STRIPE_LEN)
+    {
+        for (i = 0; i < STRIPE_LANES; i++)
+        {
+            d = wyr8(p + i * 8);
+            dk = d ^ secret[n + i];
+            a[i ^ 1] += d;
+            a[i] += (dk & 0xFFFFFFFF) * (dk >> 32);
+        }
+    }
+    memcpy(acc, a, sizeof(a));
+}
+
+static void scramble_scalar(uint64_t *acc, const uint64_t *secret){
+    int i;
+
+    for (i = 0; i < STRIPE_LANES; i++)
+    {
+        acc[i] ^= acc[i] >> 47;
+        acc[i] ^= secret[i];
+        acc[i] *= STRIPE_PRIME32;
+    }
+}
+
+#ifdef HASHFN_X86
+
+/* ۼھֲpuint8_t *ܺaccصֱдxacc[i]
+ * ÿҪۼڴٶkeyῨϡ
+ * 32λλȡshuffleshuffleֻһ˿ڣÿѾһ */
+#define STRIPE_SSE2_LANE(a, p, k)                                           \
+    do {                                                                    \
+        __m128i d_ = _mm_loadu_si128((const __m128i *)(p));                 \
+        __m128i dk_ = _mm_xor_si128(d_, _mm_loadu_si128((const __m128i *)(k))); \
+        __m128i prod_ = _mm_mul_epu32(dk_, _mm_srli_epi64(dk_, 32)); \
+        /* 64λλãacc[i ^ 1] += d */                        \
+        d_ = _mm_shuffle_epi32(d_, _MM_SHUFFLE(1, 0, 3, 2));                \
+        (a) = _mm_add_epi64((a), _mm_add_epi64(prod_, d_));                 \
+    } while (0)
+
+__attribute__((target("sse2")))
+static void stripes_sse2(uint64_t *acc, const uint8_t *p, size_t nstripes,
+                         const uint64_t *secret){
+    __m128i *xacc = (__m128i *)acc;
+    __m128i a0 = xacc[0], a1 = xacc[1], a2 = xacc[2], a3 = xacc[3];
+    size_t n;
+
+    for (n = 0; n < nstripes; n++, p += STRIPE_LEN)
+    {
+        STRIPE_SSE2_LANE(a0, p, secret + n);
+        STRIPE_SSE2_LANE(a1, p + 16, secret + n + 2);
+        STRIPE_SSE2_LANE(a2, p + 32, secret + n + 4);
+        STRIPE_SSE2_LANE(a3, p + 48, secret + n + 6);
+    }
+    xacc[0] = a0;
+    xacc[1] = a1;
+    xacc[2] = a2;
+    xacc[3] = a3;
+}
+
+__attribute__((target("sse2")))
+static void scramble_sse2(uint64_t *acc, const uint64_t *secret){
+    const __m128i prime = _mm_set1_epi32(STRIPE_PRIME32);
+    __m128i *xacc = (__m128i *)acc;
+    __m128i a, lo, hi;
+    int i;
+
+    for (i = 0; i < STRIPE_LANES / 2; i++)
+    {
+        a = xacc[i];
+        a = _mm_xor_si128(a, _mm_srli_epi64(a, 47));
+        a = _mm_xor_si128(a, _mm_loadu_si128((const __m128i *)(secret + i * 2)));
+        /* 64λ32λͰ͸ֱ߰ˣƴ */
+        lo = _mm_mul_epu32(a, prime);
+        hi = _mm_mul_epu32(_mm_srli_epi64(a, 32), prime);
+        xacc[i] = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+    }
+}
+
+#define STRIPE_AVX2_LANE(a, p, k)                                           \
+    do {                                                                    \
+        __m256i d_ = _mm256_loadu_si256((const __m256i *)(p));              \
+        __m256i dk_ = _mm256_xor_si256(d_, _mm256_loadu_si256((const __m256i *)(k))); \
+        __m256i prod_ = _mm256_mul_epu32(dk_, _mm256_srli_epi64(dk_, 32)); \
+        d_ = _mm256_shuffle_epi32(d_, _MM_SHUFFLE(1, 0, 3, 2));             \
+        (a) = _mm256_add_epi64((a), _mm256_add_epi64(prod_, d_));           \
+    } while (0)
+
+__attribute__((target("avx2")))
+static void stripes_avx2(uint64_t *acc, const uint8_t *p, size_t nstripes,
+                         const uint64_t *secret){
+    __m256i *xacc = (__m256i *)acc;
+    __m256i a0 = xacc[0], a1 = xacc[1];
+    size_t n;
+
+    for (n = 0; n < nstripes; n++, p += STRIPE_LEN)
+    {
+        STRIPE_AVX2_LANE(a0, p, secret + n);
+        STRIPE_AVX2_LANE(a1, p + 32, secret + n + 4);
+    }
+    xacc[0] = a0;
+    xacc[1] = a1;
+}
+
+__attribute__((target("avx2")))
+static void scramble_avx2(uint64_t *acc, const uint64_t *secret){
+    const __m256i prime = _mm256_set1_epi32(STRIPE_PRIME32);
+    __m256i *xacc = (__m256i *)acc;
+    __m256i a, lo, hi;
+    int i;
+
+    for (i = 0; i < STRIPE_LANES / 4; i++)
+    {
+        a = xacc[i];
+        a = _mm256_xor_si256(a, _mm256_srli_epi64(a, 47));
+        a = _mm256_xor_si256(a, _mm256_loadu_si256((const __m256i *)(secret + i * 4)));
+        lo = _mm256_mul_epu32(a, prime);
+        hi = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), prime);
+        xacc[i] = _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+    }
+}
+
+/* һһzmmۼһ64ֽڶ룬loadu/storeu */
+__attribute__((target("avx512f")))
+static void stripes_avx512(uint64_t *acc, const uint8_t *p, size_t nstripes,
+                           const uint64_t *secret){
+    __m512i a = _mm512_loadu_si512((const void *)acc);
+    __m512i d, dk, prod;
+    size_t n;
+
+    for (n = 0; n < nstripes; n++, p += STRIPE_LEN)
+    {
+        d = _mm512_loadu_si512((const void *)p);
+        dk = _mm512_xor_si512(d, _mm512_loadu_si512((const void *)(secret + n)));
+        prod = _mm512_mul_epu32(dk, _mm512_srli_epi64(dk, 32));
+        d = _mm512_shuffle_epi32(d, (_MM_PERM_ENUM)_MM_SHUFFLE(1, 0, 3, 2));
+        a = _mm512_add_epi64(a, _mm512_add_epi64(prod, d));
+    }
+    _mm512_storeu_si512((void *)acc, a);
+}
+
+__attribute__((target("avx512f")))
+static void scramble_avx512(uint64_t *acc, const uint64_t *secret){
+    const __m512i prime = _mm512_set1_epi32(STRIPE_PRIME32);
+    __m512i a, lo, hi;
+
+    a = _mm512_loadu_si512((const void *)acc);
+    a = _mm512_xor_si512(a, _mm512_srli_epi64(a, 47));
+    a = _mm512_xor_si512(a, _mm512_loadu_si512((const void *)secret));
+    lo = _mm512_mul_epu32(a, prime);
+    hi = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), prime);
+    _mm512_storeu_si512((void *)acc, _mm512_add_epi64(lo, _mm512_slli_epi64(hi, 32)));
+}
+
+#endif
+
+/* һʵֵһ𣬻ʵֻдһָ룬
+ * StripeHash64õһһ */
+typedef struct StripeImpl{
+    int32_t level;
+    stripe_fn accumulate;
+    scramble_fn scramble;
+} StripeImpl;
+
+static const StripeImpl stripe_impls[] = {
+    { HASHFN_SCALAR, stripes_scalar, scramble_scalar },
+#ifdef HASHFN_X86
+    { HASHFN_SSE2, stripes_sse2, scramble_sse2 },
+    { HASHFN_AVX2, stripes_avx2, scramble_avx2 },
+    { HASHFN_AVX512, stripes_avx512, scramble_avx512 },
+#endif
+};
+
+/* ѡ֮ǰñʵ֣һ */
+static const StripeImpl *stripe_impl = &stripe_impls[0];
+
+static int32_t simd_supported(void){
+#ifdef HASHFN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return HASHFN_AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return HASHFN_AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return HASHFN_SSE2;
+#endif
+    return HASHFN_SCALAR;
+}
+
+/* ʱCPUѡһΣڵһεʱѡ̵߳һεòᾺ */
+__attribute__((constructor))
+static void stripe_detect(void){
+    __atomic_store_n(&stripe_impl, &stripe_impls[simd_supported()],
+                     __ATOMIC_RELEASE);
+}
+
+int32_t hashfn_set_simd_level(int32_t level){
+    int32_t max = simd_supported();
+
+    if (level < 0 || level > max)
+        level = max;
+    __atomic_store_n(&stripe_impl, &stripe_impls[level], __ATOMIC_RELEASE);
+    return level;
+}
+
+int32_t hashfn_simd_level(void){
+    return __atomic_load_n(&stripe_impl, __ATOMIC_ACQUIRE)->level;
+}
+
+uint64_t StripeHash64(const void *key, size_t len, uint64_t seed){
+    const uint8_t *p = (const uint8_t *)key;
+    uint64_t acc[STRIPE_LANES] __attribute__((aligned(32))) = {
+        STRIPE_PRIME32, wyp[0], wyp[1], wyp[2],
+        wyp[3], 0x85EBCA77C2B2AE63ULL, 0x27D4EB2F165667C5ULL, 0x9E3779B1ULL,
+    };
+    uint64_t secret[STRIPE_SECRET_WORDS];
+    const StripeImpl *impl;
+    size_t nblocks, nstripes, i;
+    uint64_t h;
+
+    if (len < STRIPE_MIN_LEN)
+        return WyHash64(key, len, seed);
+    impl = __atomic_load_n(&stripe_impl, __ATOMIC_ACQUIRE);
+
+    /* һһӵԿϣxxh3Կһ */
+    for (i = 0; i < STRIPE_SECRET_WORDS; i++)
+        secret[i] = stripe_secret[i] + ((i & 1) ? -seed : seed);
+
+    nblocks = (len - 1) / STRIPE_BLOCK_LEN;
+    for (i = 0; i < nblocks; i++, p += STRIPE_BLOCK_LEN)
+    {
+        impl->accumulate(acc, p, STRIPES_PER_BLOCK, secret);
+        impl->scramble(acc, secret + STRIPES_PER_BLOCK);
+    }
+    /* һ鲻ģ64ֽڲһ(ǰص) */
+    nstripes = ((const uint8_t *)key + len - p - 1) / STRIPE_LEN;
+    impl->accumulate(acc, p, nstripes, secret);
+    impl->accumulate(acc, (const uint8_t *)key + len - STRIPE_LEN, 1,
+                      secret + STRIPE_SECRET_WORDS - STRIPE_LANES - 1);
+
+    h = len * wyp[0];
+    for (i = 0; i < STRIPE_LANES; i += 2)
+        h += wymix(acc[i] ^ secret[i + 3], acc[i + 1] ^ secret[i + 4]);
+    return wymix(h ^ (h >> 29), wyp[3] ^ seed);
+}
+
+
+/* Ϻͳһǩ */
+static uint64_t fn_superfast(const void *key, size_t len, uint64_t seed){
+    return SuperFastHash((const char *)key, (int32_t)len);
+}
+static uint64_t fn_elf(const void *key, size_t len, uint64_t seed){
+    return ELFHash((const char *)key, (int32_t)len);
+}
+static uint64_t fn_really_simple(const void *key, size_t len, uint64_t seed){
+    return ReallySimpleHash((char *)key, (int32_t)len);
+}
+#define WRAP_PARTOW(name, fn)                                               \
+static uint64_t name(const void *key, size_t len, uint64_t seed){           \
+    return fn((unsigned char *)key, (unsigned int)len);                     \
+}
+WRAP_PARTOW(fn_rs, RSHash)
+WRAP_PARTOW(fn_js, JSHash)
+WRAP_PARTOW(fn_pjw, PJWHash)
+WRAP_PARTOW(fn_sdbm, SDBMHash)
+WRAP_PARTOW(fn_djb, DJBHash)
+WRAP_PARTOW(fn_dek, DEKHash)
+WRAP_PARTOW(fn_fnv, FNVHash)
+
+const HashFunc hashfn_table[] = {
+    {"wyhash",       WyHash64,         64, 1},
+    {"stripe",       StripeHash64,     64, 1},
+    {"superfast",    fn_superfast,     32, 0},
+    {"elf",          fn_elf,           28, 0},
+    {"rs",           fn_rs,            32, 0},
+    {"js",           fn_js,            32, 0},
+    {"pjw",          fn_pjw,           32, 0},
+    {"sdbm",         fn_sdbm,          32, 0},
+    {"djb",          fn_djb,           32, 0},
+    {"dek",          fn_dek,           32, 0},
+    {"fnv",          fn_fnv,           32, 0},
+    {"reallysimple", fn_really_simple,  8, 0},
+};
+
+const int32_t hashfn_count = sizeof(hashfn_table) / sizeof(hashfn_table[0]);
+
+const HashFunc* hashfn_lookup(const char *name){
+    int32_t i;
+
+    for (i = 0; i < hashfn_count; i++)
+    {
+        if (strcmp(hashfn_table[i].name, name) == 0)
+            return &hashfn_table[i];
+    }
+    return NULL;
+}
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
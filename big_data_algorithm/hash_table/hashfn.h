@@ -26,6 +26,42 @@ unsigned int DEKHash (unsigned char *, unsigned int);
 
 #define hashfn ELFHash
 
+/* 64λӵĹϣĺһһֽڡûӣkey
+ * Ҳס⹹ĳͻһδ8/16/48ֽڣ
+ * WyHash64     wyhashkey
+ * StripeHash64 xxh38·64λۼһγ64ֽڣkeySSE2/AVX2/AVX-512
+ *              ʱCPUʵ֣1K½WyHash64 */
+uint64_t WyHash64(const void *key, size_t len, uint64_t seed);
+uint64_t StripeHash64(const void *key, size_t len, uint64_t seed);
+
+/* кͳһһǩϺӣֻ32λ */
+typedef uint64_t (*hashfn64_t)(const void *key, size_t len, uint64_t seed);
+
+typedef struct HashFunc{
+    const char *name;
+    hashfn64_t fn;
+    int32_t bits;       /* Чλ */
+    int32_t seeded;
+} HashFunc;
+
+extern const HashFunc hashfn_table[];
+extern const int32_t hashfn_count;
+
+/*ңҲNULL*/
+const HashFunc* hashfn_lookup(const char *name);
+
+/* StripeHash64ʵ֣01 SSE22 AVX23 AVX-512 */
+#define HASHFN_SCALAR   0
+#define HASHFN_SSE2     1
+#define HASHFN_AVX2     2
+#define HASHFN_AVX512   3
+
+/*ǰõʵ֣ʱCPUѡ*/
+int32_t hashfn_simd_level(void);
+
+/*ǿĳʵ(CPUֵ֧)ʵõģ*/
+int32_t hashfn_set_simd_level(int32_t level);
+
 #endif /* __HASHFN_H__ */
 
 
@@ -0,0 +1,309 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/* hashfn.cйϣٶȺ
+ * 1. ͬkeyÿιϣĺʱ64KʱGB/s
+ * 2. ѩkeyתһλÿλתĸӦýӽ1/2
+ *    ӡƽƫ(0ã1)1K64KkeyStripeHash64
+ *    ֻ512λ(ͷβ64λ)
+ * 3. Ͱַkeykeyõ16λֵ65536Ͱ
+ *    ɶȣӽ1˵ȣԽԽkeyȫ01K/64Kм
+ *    λдһ
+ *    keyѩͷͰֻ64λĺϺ̫keyҲѾϸ
+ * 4. StripeHash64SSE2AVX2AVX-512ʵֵٶȣ˳һ£
+ *    wyhashһ³keyٶ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "hashfn.h"
+
+#define MAX_KEY_LEN         65536
+#define BUCKET_BITS         16
+#define DIST_KEYS           1000000
+#define DIST_LONG_KEYS      (1 << 17)
+#define AVALANCHE_KEYS      1000
+#define AVALANCHE_BITS      512
+
+static const size_t lengths[] = {4, 8, 16, 32, 64, 128, 256, 1024, 4096, 65536};
+#define NLENGTHS (sizeof(lengths) / sizeof(lengths[0]))
+
+static uint8_t *buf;
+
+static double now_sec(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static inline uint64_t xorshift(uint64_t *s){
+    uint64_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *s = x;
+}
+
+/* ÿֳȴԼϣ32MBݣkeyǶ */
+static double time_hash(const HashFunc *f, size_t len){
+    uint64_t n = (32 << 20) / len, i, sum = 0;
+    double t;
+
+    if (n > 4000000)
+        n = 4000000;
+    t = now_sec();
+    for (i = 0; i < n; i++)
+        sum += f->fn(buf + (i & 7), len, sum);
+    t = now_sec() - t;
+    if (sum == 1)
+        printf(" ");
+    return t * 1e9 / n;
+}
+
+static void bench_speed(const HashFunc *f){
+    double ns = 0;
+    size_t i;
+
+    printf("%-13s", f->name);
+    for (i = 0; i < NLENGTHS; i++)
+    {
+        ns = time_hash(f, lengths[i]);
+        printf(" %8.1f", ns);
+    }
+    printf(" %6.2f\n", lengths[NLENGTHS - 1] / ns);
+}
+
+static void bench_avalanche(const HashFunc *f, size_t len){
+    static uint32_t flips[AVALANCHE_BITS][64];
+    static size_t bits[AVALANCHE_BITS];
+    static uint8_t key[MAX_KEY_LEN];
+    uint64_t mask, seed = 0x12345678, h, d;
+    double p, worst = 0, mean = 0;
+    size_t nbits, in, out, k, i;
+
+    if (len > 64 && f->bits != 64)
+    {
+        printf("  %11s", "-");
+        return;
+    }
+    /* keyÿһλkeyͷβ64λ */
+    nbits = len * 8 < AVALANCHE_BITS ? len * 8 : AVALANCHE_BITS;
+    for (in = 0; in < nbits; in++)
+    {
+        if (nbits == len * 8 || in < 64)
+            bits[in] = in;
+        else if (in < 128)
+            bits[in] = len * 8 - 128 + in;
+        else
+            bits[in] = xorshift(&seed) % (len * 8);
+    }
+
+    memset(flips, 0, sizeof(flips));
+    mask = f->bits == 64 ? ~0ULL : (1ULL << f->bits) - 1;
+    for (k = 0; k < AVALANCHE_KEYS; k++)
+    {
+        for (i = 0; i < len; i++)
+            key[i] = (uint8_t)xorshift(&seed);
+        h = f->fn(key, len, 0) & mask;
+        for (in = 0; in < nbits; in++)
+        {
+            key[bits[in] >> 3] ^= 1 << (bits[in] & 7);
+            d = (f->fn(key, len, 0) & mask) ^ h;
+            key[bits[in] >> 3] ^= 1 << (bits[in] & 7);
+            for (out = 0; out < (size_t)f->bits; out++)
+                flips[in][out] += (d >> out) & 1;
+        }
+    }
+    for (in = 0; in < nbits; in++)
+    {
+        for (out = 0; out < (size_t)f->bits; out++)
+        {
+            p = (double)flips[in][out] / AVALANCHE_KEYS;
+            p = p > 0.5 ? (p - 0.5) * 2 : (0.5 - p) * 2;
+            worst = p > worst ? p : worst;
+            mean += p;
+        }
+    }
+    printf("  %5.3f/%5.3f", worst, mean / (nbits * f->bits));
+}
+
+static void bench_distribution(const HashFunc *f, int32_t strings){
+    static uint32_t buckets[1 << BUCKET_BITS];
+    double expect = (double)DIST_KEYS / (1 << BUCKET_BITS), chi = 0, d;
+    char key[32];
+    uint64_t k;
+    uint32_t i;
+
+    memset(buckets, 0, sizeof(buckets));
+    for (i = 0; i < DIST_KEYS; i++)
+    {
+        if (strings)
+        {
+            buckets[f->fn(key, snprintf(key, sizeof(key), "key%u", i), 0) &
+                    ((1 << BUCKET_BITS) - 1)]++;
+        }
+        else
+        {
+            k = i;
+            buckets[f->fn(&k, sizeof(k), 0) & ((1 << BUCKET_BITS) - 1)]++;
+        }
+    }
+    for (i = 0; i < (1 << BUCKET_BITS); i++)
+    {
+        d = buckets[i] - expect;
+        chi += d * d / expect;
+    }
+    printf(" %10.2f", chi / ((1 << BUCKET_BITS) - 1));
+}
+
+/* keyȫ0ֻмһ8ֽڼͬ */
+static void bench_distribution_long(const HashFunc *f, size_t len){
+    static uint32_t buckets[1 << BUCKET_BITS];
+    static uint8_t key[MAX_KEY_LEN];
+    double expect = (double)DIST_LONG_KEYS / (1 << BUCKET_BITS), chi = 0, d;
+    uint64_t k;
+    uint32_t i;
+
+    if (f->bits != 64)
+    {
+        printf(" %10s", "-");
+        return;
+    }
+    memset(buckets, 0, sizeof(buckets));
+    memset(key, 0, len);
+    for (k = 0; k < DIST_LONG_KEYS; k++)
+    {
+        memcpy(key + len / 2 + 3, &k, sizeof(k));
+        buckets[f->fn(key, len, 0) & ((1 << BUCKET_BITS) - 1)]++;
+    }
+    for (i = 0; i < (1 << BUCKET_BITS); i++)
+    {
+        d = buckets[i] - expect;
+        chi += d * d / expect;
+    }
+    printf(" %10.2f", chi / ((1 << BUCKET_BITS) - 1));
+}
+
+static void bench_simd(void){
+    static const char *names[] = {"scalar", "sse2", "avx2", "avx512"};
+    const HashFunc *f = hashfn_lookup("stripe");
+    const HashFunc *wy = hashfn_lookup("wyhash");
+    uint64_t h[4] = {0, 0, 0, 0};
+    double ns = 0, wy_ns[3], best[3];
+    int32_t level, max = hashfn_set_simd_level(-1);
+    size_t i;
+
+    printf("\nStripeHash64 by implementation "
+           "(ns/hash at 1K, 4K, 64K, GB/s at 64K)\n");
+    printf("%-13s", "wyhash");
+    for (i = NLENGTHS - 3; i < NLENGTHS; i++)
+    {
+        wy_ns[i - (NLENGTHS - 3)] = time_hash(wy, lengths[i]);
+        printf(" %8.1f", wy_ns[i - (NLENGTHS - 3)]);
+    }
+    printf(" %6.2f\n", lengths[NLENGTHS - 1] / wy_ns[2]);
+    for (level = HASHFN_SCALAR; level <= max; level++)
+    {
+        hashfn_set_simd_level(level);
+        printf("%-13s", names[level]);
+        for (i = NLENGTHS - 3; i < NLENGTHS; i++)
+        {
+            ns = time_hash(f, lengths[i]);
+            printf(" %8.1f", ns);
+            best[i - (NLENGTHS - 3)] = ns;
+        }
+        printf(" %6.2f", lengths[NLENGTHS - 1] / ns);
+        h[level] = StripeHash64(buf, 12345, 42);
+        printf(" %s\n", h[level] == h[0] ? "same result" : "RESULT DIFFERS");
+    }
+    /* 64KkeyL1װ£౻L2ס4KܿϵĲ */
+    printf("%s vs wyhash: %.2fx at 4K (in L1), %.2fx at 64K (L2 bound)\n",
+           names[max], wy_ns[1] / best[1], wy_ns[2] / best[2]);
+    hashfn_set_simd_level(-1);
+}
+
+static void usage(char *name){
+    int32_t i;
+
+    fprintf(stderr, "Usage: %s [-f function] [-q]\n"
+            "  -f     only this function\n"
+            "  -q     speed only, skip the quality tests\n"
+            "functions:", name);
+    for (i = 0; i < hashfn_count; i++)
+        fprintf(stderr, " %s", hashfn_table[i].name);
+    fprintf(stderr, "\n");
+    exit(EXIT_FAILURE);
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    const HashFunc *only = NULL, *f;
+    uint64_t seed = 88172645463325252ULL;
+    int32_t opt, quick = 0, i;
+    size_t j;
+
+    while ((opt = getopt(argc, argv, "f:qh")) != -1) {
+        switch (opt) {
+        case 'f':
+            only = hashfn_lookup(optarg);
+            if (only == NULL)
+                usage(argv[0]);
+            break;
+        case 'q': quick = 1; break;
+        default: usage(argv[0]);
+        }
+    }
+
+    buf = (uint8_t *)malloc(MAX_KEY_LEN + 8);
+    if (buf == NULL)
+        return 1;
+    for (j = 0; j < MAX_KEY_LEN + 8; j++)
+        buf[j] = (uint8_t)xorshift(&seed);
+
+    printf("speed (ns/hash by key length, GB/s at 64K)\n%-13s", "");
+    for (j = 0; j < NLENGTHS; j++)
+        printf(" %8zu", lengths[j]);
+    printf("   GB/s\n");
+    for (i = 0; i < hashfn_count; i++)
+    {
+        f = &hashfn_table[i];
+        if (only == NULL || only == f)
+            bench_speed(f);
+    }
+
+    if (!quick)
+    {
+        printf("\nquality: avalanche worst/mean bias by key length, "
+               "chi2/df over %d buckets\n%-13s %13s %13s %13s %13s %10s %10s %10s %10s\n",
+               1 << BUCKET_BITS, "", "aval 8B", "aval 64B", "aval 1K",
+               "aval 64K", "strings", "integers", "1K keys", "64K keys");
+        for (i = 0; i < hashfn_count; i++)
+        {
+            f = &hashfn_table[i];
+            if (only != NULL && only != f)
+                continue;
+            printf("%-13s", f->name);
+            bench_avalanche(f, 8);
+            bench_avalanche(f, 64);
+            bench_avalanche(f, 1024);
+            bench_avalanche(f, 65536);
+            bench_distribution(f, 1);
+            bench_distribution(f, 0);
+            bench_distribution_long(f, 1024);
+            bench_distribution_long(f, 65536);
+            printf("\n");
+        }
+    }
+
+    bench_simd();
+    free(buf);
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
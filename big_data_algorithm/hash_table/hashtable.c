@@ -3,6 +3,7 @@ extern "C"{
 #endif
 
 // http://blog.csdn.net/zmxiangde_88/article/details/8025541 վԿһ
+// Ѱַο https://abseil.io/about/design/swisstables
 
 
 #include <stdint.h> /* uint64_t*/
@@ -10,149 +11,322 @@ extern "C"{
 #include <stdlib.h>
 #include <string.h>
 #include "hashtable.h"
-#include "hashfn.h"
+#include "hashtable_group.h"
 
 #define TRUE 1
 #define FALSE 0
 #define true 1
 #define false 0
 
-/*ʼhashtable*/
-Hashtable* hashtable_init(int32_t size){
-    Hashtable* hashtable = (Hashtable*)calloc(1, sizeof(Hashtable));
-    hashtable->size = size;
-    hashtable->item_size = 0;
-    HashNode* head = (HashNode *)calloc(size, sizeof(HashNode));
-    hashtable->head = head;
-    return hashtable;
-}
+#define HASH_MIGRATE_GROUPS 1           /* ÿput/removeἸ */
 
-/*һ*/
-void hashtable_put(Hashtable *hashtable, char* key, char* value){
 
-    int32_t len = strlen(key); 
-    int32_t index = hashfn(key, len) % hashtable->size;
-    HashNode *hashNode = hashtable->head + index;
+/* ̽⣬2ݣ߱ */
+static HashSlot* tab_find(HashTab *tab, const char *key, uint32_t len,
+                          uint32_t hash){
+    uint32_t gmask, g, i, mask, bit;
+    const int8_t *ctrl;
+    HashSlot *slot;
 
-    while (true)
+    if (tab->capacity == 0)
     {
-        if (hashNode->key == NULL || *key == *(hashNode->key))
+        return NULL;
+    }
+    gmask = tab->capacity / HASH_GROUP_SIZE - 1;
+    g = H1(hash) & gmask;
+    for (i = 1; ; i++)
+    {
+        ctrl = tab->ctrl + g * HASH_GROUP_SIZE;
+        for (mask = group_match(ctrl, H2(hash)); mask; mask &= mask - 1)
         {
-            if (hashNode->key == NULL)
+            bit = __builtin_ctz(mask);
+            slot = tab->slots + g * HASH_GROUP_SIZE + bit;
+            if (slot->hash == hash && slot->len == len &&
+                memcmp(slot_key(slot), key, len) == 0)
             {
-                hashtable->item_size = hashtable->item_size + 1;
+                return slot;
             }
-            hashNode->key = key;
-            hashNode->value = value; //ھֵ滻
-            return;
-        }
-        if (hashNode->next != NULL){
-            hashNode = hashNode->next;
         }
-        else{
-            HashNode *newNode = (HashNode*)calloc(1, sizeof(HashNode));
-            newNode->key = key;
-            newNode->value = value;
-            hashNode->next = newNode;
-            hashtable->item_size = hashtable->item_size + 1;
-            return;
+        /* ﻹпղ˵keyں */
+        if (group_match(ctrl, CTRL_EMPTY))
+        {
+            return NULL;
         }
+        g = (g + i) & gmask;
     }
 }
 
-/*ȡһ*/
-char* hashtable_get(Hashtable *hashtable, char* key){
+/* һջɾĲ۷keyǰ֤growth_left0 */
+static HashSlot* tab_insert_slot(HashTab *tab, uint32_t hash){
+    uint32_t gmask, g, i, mask, idx;
 
-    int32_t len = strlen(key); 
-    int32_t index = hashfn(key, len) % hashtable->size;
-    HashNode *hashNode = hashtable->head + index;
-    while (hashNode != NULL)
+    gmask = tab->capacity / HASH_GROUP_SIZE - 1;
+    g = H1(hash) & gmask;
+    for (i = 1; ; i++)
     {
-        if (hashNode->key != NULL&&*key == *(hashNode->key))
+        mask = group_match_free(tab->ctrl + g * HASH_GROUP_SIZE);
+        if (mask)
         {
-            return hashNode->value;
+            idx = g * HASH_GROUP_SIZE + __builtin_ctz(mask);
+            if (tab->ctrl[idx] == CTRL_DELETED)
+            {
+                tab->deleted--;
+            }
+            else
+            {
+                tab->growth_left--;
+            }
+            tab->ctrl[idx] = H2(hash);
+            return tab->slots + idx;
         }
-        hashNode = hashNode->next;
+        g = (g + i) & gmask;
     }
-    return NULL;
 }
 
-/*ɾһ*/
-void hashtable_remove(Hashtable *hashtable, char* key){
+static void tab_erase(HashTab *tab, HashSlot *slot){
+    tab->ctrl[slot - tab->slots] = CTRL_DELETED;
+    tab->deleted++;
+}
+
+
+/* ɱ˾ͷţkeyڵľarenaҲһͷ */
+static void migrate_done(Hashtable *hashtable){
+    tab_free(&hashtable->old);
+    hashtable->migrate_pos = 0;
+}
 
-    int32_t len = strlen(key); 
-    int32_t index = hashfn(key, len) % hashtable->size;
-    HashNode *hashNode = hashtable->head + index;
-    HashNode *temp = hashNode;
-    while (hashNode != NULL)
+/* Ѿɱnᵽ±Ĳ۱Ϊɾ֤ɱ̽ */
+static void migrate_step(Hashtable *hashtable, uint32_t n){
+    HashTab *old = &hashtable->old;
+    HashTab *cur = &hashtable->cur;
+    HashSlot *from, *to;
+    uint32_t groups, idx, end;
+
+    if (old->capacity == 0)
+    {
+        return;
+    }
+    groups = old->capacity / HASH_GROUP_SIZE;
+    for (; n > 0 && hashtable->migrate_pos < groups; n--)
     {
-        if (*key == *(hashNode->key))
+        idx = hashtable->migrate_pos * HASH_GROUP_SIZE;
+        for (end = idx + HASH_GROUP_SIZE; idx < end; idx++)
         {
-            if ((hashtable->head + index) == hashNode)
+            if (old->ctrl[idx] < 0)
             {
-                hashNode->key = NULL;
-                hashNode->value = NULL;
+                continue;
             }
-            else
+            from = old->slots + idx;
+            to = tab_insert_slot(cur, from->hash);
+            if (tab_set_key(cur, to, slot_key(from), from->len,
+                            from->hash) == -1)
             {
-                temp->next = hashNode->next;
-                free(hashNode);
+                /* arenaʧܣһ´ٰ */
+                tab_erase(cur, to);
+                return;
             }
-            hashtable->item_size = hashtable->item_size - 1;
-            return;
+            to->value = from->value;
+            old->ctrl[idx] = CTRL_DELETED;
         }
-        temp = hashNode;
-        hashNode = hashNode->next;
+        hashtable->migrate_pos++;
+    }
+    if (hashtable->migrate_pos == groups)
+    {
+        migrate_done(hashtable);
     }
-    return;
 }
 
+/* ±ûпղˣԪ7/16ͷ󲿷ɾĲۣ
+ * ԭСؽһ */
+static int32_t start_resize(Hashtable *hashtable){
+    HashTab *cur = &hashtable->cur;
+    uint32_t capacity = cur->capacity;
 
-/**/
-void hashtable_destroy(Hashtable *hashtable){
-    HashNode *head = hashtable->head;
-    int32_t index;
-    for (index = 0; index < hashtable->size; index++)
+    /* һݻû꣬һΰ */
+    if (hashtable->old.capacity != 0)
     {
-        HashNode *next = head->next;
-        while (next != NULL)
+        migrate_step(hashtable, hashtable->old.capacity);
+        if (hashtable->old.capacity != 0 || cur->growth_left > 0)
         {
-            HashNode *temp = next;
-            next = next->next;
-            free(temp);
+            return cur->growth_left > 0 ? 0 : -1;
         }
-        head++;
     }
-    free(hashtable->head);
-    free(hashtable);
+    if ((uint32_t)hashtable->item_size >= capacity / 16 * 7)
+    {
+        capacity *= 2;
+    }
+    if (capacity > HASH_MAX_CAPACITY)
+    {
+        return -1;
+    }
+    hashtable->old = *cur;
+    if (tab_alloc(cur, capacity) == -1)
+    {
+        *cur = hashtable->old;
+        memset(&hashtable->old, 0, sizeof(HashTab));
+        return -1;
+    }
+    hashtable->size = capacity;
+    hashtable->migrate_pos = 0;
+    migrate_step(hashtable, HASH_MIGRATE_GROUPS);
+    return 0;
 }
 
-/*ӡ*/
-void hashtable_print(Hashtable *hashtable){
-    HashNode *head = hashtable->head;
-    int32_t index;
-    for (index = 0; index < hashtable->size; index++)
+
+static inline uint32_t table_hash(Hashtable *hashtable, const char *key,
+                                  uint32_t len){
+    if (hashtable->hashfn == NULL)
     {
-        printf("index:%d\t", index);
-        if (head->key!=NULL)
+        return hash_key(key, len);
+    }
+    return (uint32_t)hashtable->hashfn(key, len, hashtable->seed);
+}
+
+
+/*ʼhashtable*/
+Hashtable* hashtable_init(int32_t size){
+    Hashtable* hashtable = (Hashtable*)calloc(1, sizeof(Hashtable));
+    uint32_t capacity = HASH_GROUP_SIZE;
+
+    if (hashtable == NULL)
+    {
+        return NULL;
+    }
+    /* ȡ2ݣ֤sizeԪʱز7/8 */
+    while (capacity < HASH_MAX_CAPACITY &&
+           capacity - capacity / 8 < (uint32_t)(size > 0 ? size : 0))
+    {
+        capacity *= 2;
+    }
+    if (tab_alloc(&hashtable->cur, capacity) == -1)
+    {
+        free(hashtable);
+        return NULL;
+    }
+    hashtable->size = capacity;
+    hashtable->item_size = 0;
+    return hashtable;
+}
+
+/*ϣ*/
+int32_t hashtable_set_hash(Hashtable *hashtable, const char *name, uint64_t seed){
+    const HashFunc *f = hashfn_lookup(name);
+
+    /* еԪǰɺŵģ; */
+    if (f == NULL || hashtable->item_size != 0 || hashtable->old.capacity != 0)
+    {
+        return -1;
+    }
+    hashtable->hashfn = f->fn;
+    hashtable->seed = seed;
+    return 0;
+}
+
+/*һ*/
+void hashtable_put(Hashtable *hashtable, char* key, char* value){
+
+    uint32_t len = strlen(key);
+    uint32_t hash = table_hash(hashtable, key, len);
+    HashSlot *slot;
+
+    migrate_step(hashtable, HASH_MIGRATE_GROUPS);
+
+    slot = tab_find(&hashtable->cur, key, len, hash);
+    if (slot == NULL)
+    {
+        slot = tab_find(&hashtable->old, key, len, hash);
+    }
+    if (slot != NULL)
+    {
+        slot->value = value; //ھֵ滻
+        return;
+    }
+
+    if (hashtable->cur.growth_left == 0 && start_resize(hashtable) == -1)
+    {
+        fprintf(stderr, "hashtable: out of memory, %s not added\n", key);
+        return;
+    }
+    slot = tab_insert_slot(&hashtable->cur, hash);
+    if (tab_set_key(&hashtable->cur, slot, key, len, hash) == -1)
+    {
+        tab_erase(&hashtable->cur, slot);
+        fprintf(stderr, "hashtable: out of memory, %s not added\n", key);
+        return;
+    }
+    slot->value = value;
+    hashtable->item_size = hashtable->item_size + 1;
+}
+
+/*ȡһ*/
+char* hashtable_get(Hashtable *hashtable, char* key){
+
+    uint32_t len = strlen(key);
+    uint32_t hash = table_hash(hashtable, key, len);
+    HashSlot *slot;
+
+    slot = tab_find(&hashtable->cur, key, len, hash);
+    if (slot == NULL)
+    {
+        slot = tab_find(&hashtable->old, key, len, hash);
+    }
+    return slot != NULL ? slot->value : NULL;
+}
+
+/*ɾһ*/
+void hashtable_remove(Hashtable *hashtable, char* key){
+
+    uint32_t len = strlen(key);
+    uint32_t hash = table_hash(hashtable, key, len);
+    HashSlot *slot;
+
+    migrate_step(hashtable, HASH_MIGRATE_GROUPS);
+
+    slot = tab_find(&hashtable->cur, key, len, hash);
+    if (slot != NULL)
+    {
+        tab_erase(&hashtable->cur, slot);
+    }
+    else
+    {
+        slot = tab_find(&hashtable->old, key, len, hash);
+        if (slot == NULL)
         {
-            printf("%s:%s\t", head->key, head->value);
+            return;
         }
+        tab_erase(&hashtable->old, slot);
+    }
+    hashtable->item_size = hashtable->item_size - 1;
+}
+
 
-        HashNode *next = head->next;
-        while (next != NULL)
+/**/
+void hashtable_destroy(Hashtable *hashtable){
+    tab_free(&hashtable->cur);
+    tab_free(&hashtable->old);
+    free(hashtable);
+}
+
+static void tab_print(HashTab *tab){
+    uint32_t index;
+
+    for (index = 0; index < tab->capacity; index++)
+    {
+        if (tab->ctrl[index] < 0)
         {
-            if (next->key != NULL)
-            {
-                printf("%s:%s\t", next->key, next->value);
-            }
-            next = next->next;
+            continue;
         }
-        printf("\n");
-        head++;
+        printf("index:%u\t%s:%s\n", index, slot_key(tab->slots + index),
+               tab->slots[index].value);
     }
 }
 
+/*ӡ*/
+void hashtable_print(Hashtable *hashtable){
+    tab_print(&hashtable->cur);
+    tab_print(&hashtable->old);
+}
+
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
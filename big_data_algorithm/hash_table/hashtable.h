@@ -6,24 +6,58 @@ extern "C"{
 #define __HASHTABLE_H__
 
 #include <stdint.h>
+#include "hashfn.h"
 
-typedef struct HashNode{
-    char* key;
+/* Ѱַϣ(swiss table)
+ * ÿһֽڣ/ɾ/ϣֵĵ7λʱSSE2һαȽ16
+ * ֽڣֻе7λͬĲ۲űȽkey
+ * س7/8ʱݣǽģ±úÿput/removeѾɱ
+ * һ(16)ᵽ±ڼűҪ
+ * keyᱻƣ15ֱֽӷڲķڱԼarena
+ * valueԭһָֻ롣 */
+
+#define HASH_GROUP_SIZE   16
+#define HASH_INLINE_KEY   16  /* β'\0' */
+
+typedef struct HashSlot{
+    uint32_t hash;
+    uint32_t len;
+    union {
+        char  inl[HASH_INLINE_KEY];
+        char* ptr;
+    } key;
     char* value;
-    struct HashNode* next; //structᱨ 
-} HashNode;
+} HashSlot;
 
+struct HashArena;
+
+/* һűڼ¾ */
+typedef struct HashTab{
+    int8_t*   ctrl;
+    HashSlot* slots;
+    uint32_t  capacity;     /* 2ݣHASH_GROUP_SIZE */
+    uint32_t  growth_left;  /* õٸղ */
+    uint32_t  deleted;
+    struct HashArena* arena;
+} HashTab;
 
 typedef struct Hashtable{
-    int32_t size;
+    int32_t size;           /* ǰ */
     int32_t item_size;
-    HashNode* head;
+    HashTab cur;
+    HashTab old;            /* еľɱcapacityΪ0ʾû */
+    uint32_t migrate_pos;   /* ɱһҪ */
+    hashfn64_t hashfn;      /* NULLʱDJBfmix32 */
+    uint64_t seed;
 } Hashtable;
 
 
-/*ʼ*/
+/*ʼsizeΪԤƵԪظ֮Զ*/
 Hashtable* hashtable_init(int32_t size);
 
+/*ϣּhashfn_tableֻڱΪʱɹ0*/
+int32_t hashtable_set_hash(Hashtable *hashtable, const char *name, uint64_t seed);
+
 /*һ*/
 void hashtable_put(Hashtable *hashtable, char* key, char* value);
 
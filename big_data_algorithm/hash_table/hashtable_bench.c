@@ -0,0 +1,201 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/* ѰַhashtableԭhashtableԱȣ
+ * nkeyȫkeynڵkeyȫɾ
+ * nͰʼ()Ѱַ16ۿʼһ·ݡ
+ * ÿӽܣ˳㿴̵ڴ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "hashtable.h"
+#include "hashtable_chain.h"
+
+#define KEY_STRIDE      32
+#define SHUFFLE_PRIME   2654435761ULL
+
+enum {
+    ENGINE_OPEN,
+    ENGINE_CHAIN,
+};
+
+static const char *engine_name[] = {"open ", "chain"};
+
+static int32_t long_keys = 0;
+static const char *hash_name = NULL;
+
+static double now_sec(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ʣk *  mod n 0..n-1һ */
+static inline uint32_t shuffle(uint64_t k, uint32_t n){
+    return (uint32_t)(k * SHUFFLE_PRIME % n);
+}
+
+static int32_t run_bench(int32_t engine, uint32_t n){
+    char *keys = (char *)malloc((size_t)n * KEY_STRIDE);
+    char miss[KEY_STRIDE];
+    Hashtable *open = NULL;
+    ChainHashtable *chain = NULL;
+    double t, t_put, t_hit, t_miss, t_remove;
+    uint32_t i, found = 0;
+    struct rusage ru;
+    char *key, *v;
+
+    if (keys == NULL)
+    {
+        fprintf(stderr, "no memory for %u keys\n", n);
+        return -1;
+    }
+    for (i = 0; i < n; i++)
+    {
+        /* keyڲkeyarena */
+        snprintf(keys + (size_t)i * KEY_STRIDE, KEY_STRIDE,
+                 long_keys ? "user:session:%010u" : "k%u", i);
+    }
+
+    if (engine == ENGINE_OPEN)
+    {
+        open = hashtable_init(0);
+        if (hash_name != NULL)
+            hashtable_set_hash(open, hash_name, 0x9E3779B97F4A7C15ULL);
+    }
+    else
+    {
+        chain = chain_hashtable_init(n);
+    }
+
+    t = now_sec();
+    for (i = 0; i < n; i++)
+    {
+        key = keys + (size_t)i * KEY_STRIDE;
+        if (engine == ENGINE_OPEN)
+            hashtable_put(open, key, key);
+        else
+            chain_hashtable_put(chain, key, key);
+    }
+    t_put = now_sec() - t;
+
+    t = now_sec();
+    for (i = 0; i < n; i++)
+    {
+        key = keys + (size_t)shuffle(i, n) * KEY_STRIDE;
+        if (engine == ENGINE_OPEN)
+            v = hashtable_get(open, key);
+        else
+            v = chain_hashtable_get(chain, key);
+        found += (v == key);
+    }
+    t_hit = now_sec() - t;
+
+    t = now_sec();
+    for (i = 0; i < n; i++)
+    {
+        memcpy(miss, keys + (size_t)shuffle(i, n) * KEY_STRIDE, KEY_STRIDE);
+        miss[0] = 'x';
+        if (engine == ENGINE_OPEN)
+            v = hashtable_get(open, miss);
+        else
+            v = chain_hashtable_get(chain, miss);
+        found += (v != NULL);
+    }
+    t_miss = now_sec() - t;
+
+    getrusage(RUSAGE_SELF, &ru);
+
+    t = now_sec();
+    for (i = 0; i < n; i++)
+    {
+        key = keys + (size_t)shuffle(i, n) * KEY_STRIDE;
+        if (engine == ENGINE_OPEN)
+            hashtable_remove(open, key);
+        else
+            chain_hashtable_remove(chain, key);
+    }
+    t_remove = now_sec() - t;
+
+    printf("%s n=%-10u put %6.1f ns, get hit %6.1f ns, get miss %6.1f ns, "
+           "remove %6.1f ns, maxrss %ld MB, %s (left %d)\n",
+           engine_name[engine], n,
+           t_put * 1e9 / n, t_hit * 1e9 / n, t_miss * 1e9 / n,
+           t_remove * 1e9 / n, ru.ru_maxrss / 1024,
+           found == n ? "ok" : "WRONG",
+           engine == ENGINE_OPEN ? open->item_size : chain->item_size);
+
+    if (engine == ENGINE_OPEN)
+        hashtable_destroy(open);
+    else
+        chain_hashtable_destroy(chain);
+    free(keys);
+    return found == n ? 0 : -1;
+}
+
+static void usage(char *name){
+    fprintf(stderr, "Usage: %s [-n max_keys] [-m min_keys] [-l] [-o] [-H hash]\n"
+            "  runs n = min, min*10, ... up to max (default 1M to 10M),\n"
+            "  100M keys needs about 8GB for the open table\n"
+            "  -l     24-byte keys (stored in the arena)\n"
+            "  -o     open addressing table only\n"
+            "  -H     hash function of the open table, e.g. wyhash\n", name);
+    exit(EXIT_FAILURE);
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    uint64_t n, max = 10000000, min = 1000000;
+    int32_t engine, engines = 2, ret = 0, status, opt;
+    pid_t pid;
+
+    while ((opt = getopt(argc, argv, "n:m:loH:h")) != -1) {
+        switch (opt) {
+        case 'n': max = strtoull(optarg, NULL, 0); break;
+        case 'm': min = strtoull(optarg, NULL, 0); break;
+        case 'l': long_keys = 1; break;
+        case 'o': engines = 1; break;
+        case 'H':
+            if (hashfn_lookup(optarg) == NULL)
+                usage(argv[0]);
+            hash_name = optarg;
+            break;
+        default: usage(argv[0]);
+        }
+    }
+    if (min == 0 || max < min || max > 400000000)
+        usage(argv[0]);
+
+    for (n = min; n <= max; n *= 10)
+    {
+        for (engine = 0; engine < engines; engine++)
+        {
+            fflush(stdout);
+            pid = fork();
+            if (pid == 0)
+            {
+                opt = run_bench(engine, (uint32_t)n);
+                fflush(stdout);
+                _exit(opt == 0 ? 0 : 1);
+            }
+            waitpid(pid, &status, 0);
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            {
+                printf("%s n=%-10lu failed\n", engine_name[engine], n);
+                ret = 1;
+            }
+        }
+    }
+    return ret;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,158 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/* ԭʵֻ֣Ǹ֣ȽkeyʱֻȽϵһַΪstrcmp */
+
+
+#include <stdint.h> /* uint64_t*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hashtable_chain.h"
+#include "hashfn.h"
+
+#define TRUE 1
+#define FALSE 0
+#define true 1
+#define false 0
+
+/*ʼhashtable*/
+ChainHashtable* chain_hashtable_init(int32_t size){
+    ChainHashtable* hashtable = (ChainHashtable*)calloc(1, sizeof(ChainHashtable));
+    hashtable->size = size;
+    hashtable->item_size = 0;
+    ChainHashNode* head = (ChainHashNode *)calloc(size, sizeof(ChainHashNode));
+    hashtable->head = head;
+    return hashtable;
+}
+
+/*һ*/
+void chain_hashtable_put(ChainHashtable *hashtable, char* key, char* value){
+
+    int32_t len = strlen(key); 
+    int32_t index = hashfn(key, len) % hashtable->size;
+    ChainHashNode *hashNode = hashtable->head + index;
+
+    while (true)
+    {
+        if (hashNode->key == NULL || strcmp(key, hashNode->key) == 0)
+        {
+            if (hashNode->key == NULL)
+            {
+                hashtable->item_size = hashtable->item_size + 1;
+            }
+            hashNode->key = key;
+            hashNode->value = value; //ھֵ滻
+            return;
+        }
+        if (hashNode->next != NULL){
+            hashNode = hashNode->next;
+        }
+        else{
+            ChainHashNode *newNode = (ChainHashNode*)calloc(1, sizeof(ChainHashNode));
+            newNode->key = key;
+            newNode->value = value;
+            hashNode->next = newNode;
+            hashtable->item_size = hashtable->item_size + 1;
+            return;
+        }
+    }
+}
+
+/*ȡһ*/
+char* chain_hashtable_get(ChainHashtable *hashtable, char* key){
+
+    int32_t len = strlen(key); 
+    int32_t index = hashfn(key, len) % hashtable->size;
+    ChainHashNode *hashNode = hashtable->head + index;
+    while (hashNode != NULL)
+    {
+        if (hashNode->key != NULL && strcmp(key, hashNode->key) == 0)
+        {
+            return hashNode->value;
+        }
+        hashNode = hashNode->next;
+    }
+    return NULL;
+}
+
+/*ɾһ*/
+void chain_hashtable_remove(ChainHashtable *hashtable, char* key){
+
+    int32_t len = strlen(key); 
+    int32_t index = hashfn(key, len) % hashtable->size;
+    ChainHashNode *hashNode = hashtable->head + index;
+    ChainHashNode *temp = hashNode;
+    while (hashNode != NULL)
+    {
+        if (hashNode->key != NULL && strcmp(key, hashNode->key) == 0)
+        {
+            if ((hashtable->head + index) == hashNode)
+            {
+                hashNode->key = NULL;
+                hashNode->value = NULL;
+            }
+            else
+            {
+                temp->next = hashNode->next;
+                free(hashNode);
+            }
+            hashtable->item_size = hashtable->item_size - 1;
+            return;
+        }
+        temp = hashNode;
+        hashNode = hashNode->next;
+    }
+    return;
+}
+
+
+/**/
+void chain_hashtable_destroy(ChainHashtable *hashtable){
+    ChainHashNode *head = hashtable->head;
+    int32_t index;
+    for (index = 0; index < hashtable->size; index++)
+    {
+        ChainHashNode *next = head->next;
+        while (next != NULL)
+        {
+            ChainHashNode *temp = next;
+            next = next->next;
+            free(temp);
+        }
+        head++;
+    }
+    free(hashtable->head);
+    free(hashtable);
+}
+
+/*ӡ*/
+void chain_hashtable_print(ChainHashtable *hashtable){
+    ChainHashNode *head = hashtable->head;
+    int32_t index;
+    for (index = 0; index < hashtable->size; index++)
+    {
+        printf("index:%d\t", index);
+        if (head->key!=NULL)
+        {
+            printf("%s:%s\t", head->key, head->value);
+        }
+
+        ChainHashNode *next = head->next;
+        while (next != NULL)
+        {
+            if (next->key != NULL)
+            {
+                printf("%s:%s\t", next->key, next->value);
+            }
+            next = next->next;
+        }
+        printf("\n");
+        head++;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#ifndef __HASHTABLE_CHAIN_H__
+#define __HASHTABLE_CHAIN_H__
+
+#include <stdint.h>
+
+/* ԭϣСڳʼʱ̶ݣ
+ * ÿγͻcallocһڵ㣬ֻkeyvalueָ롣
+ * ͿѰַhashtableԱ */
+
+typedef struct ChainHashNode{
+    char* key;
+    char* value;
+    struct ChainHashNode* next;
+} ChainHashNode;
+
+
+typedef struct ChainHashtable{
+    int32_t size;
+    int32_t item_size;
+    ChainHashNode* head;
+} ChainHashtable;
+
+
+/*ʼ*/
+ChainHashtable* chain_hashtable_init(int32_t size);
+
+/*һ*/
+void chain_hashtable_put(ChainHashtable *hashtable, char* key, char* value);
+
+/*ȡһ*/
+char* chain_hashtable_get(ChainHashtable *hashtable, char* key);
+
+/*ɾһ*/
+void chain_hashtable_remove(ChainHashtable *hashtable, char* key);
+
+/**/
+void chain_hashtable_destroy(ChainHashtable *hashtable);
+
+/*ӡ*/
+void chain_hashtable_print(ChainHashtable *hashtable);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
@@ -0,0 +1,188 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#ifndef __HASHTABLE_GROUP_H__
+#define __HASHTABLE_GROUP_H__
+
+/* hashtablechashtableõĲֽ֣ڡƥ䡢keyĹϣʹ洢 */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "hashtable.h"
+#include "hashfn.h"
+
+/* ֽڣλΪ1ʾջɾǹϣֵĵ7λ */
+#define CTRL_EMPTY      ((int8_t)-128)  /* 0x80 */
+#define CTRL_DELETED    ((int8_t)-2)    /* 0xFE */
+
+#define HASH_MAX_CAPACITY   (1U << 29)  /* ϣֵȥ7λʣ25λѡ */
+#define HASH_ARENA_CHUNK    (1 << 20)
+
+/* keyĴ洢䣬ֻ׷ӣݰɱͷ */
+typedef struct HashArenaChunk{
+    struct HashArenaChunk* next;
+    size_t size;
+    size_t used;
+    char data[];
+} HashArenaChunk;
+
+typedef struct HashArena{
+    HashArenaChunk* chunks;
+} HashArena;
+
+
+static inline char* arena_alloc(HashArena *arena, size_t len){
+    HashArenaChunk *chunk = arena->chunks;
+    size_t size;
+
+    if (chunk == NULL || chunk->size - chunk->used < len)
+    {
+        size = len > HASH_ARENA_CHUNK ? len : HASH_ARENA_CHUNK;
+        chunk = (HashArenaChunk *)malloc(sizeof(HashArenaChunk) + size);
+        if (chunk == NULL)
+        {
+            return NULL;
+        }
+        chunk->size = size;
+        chunk->used = 0;
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+    }
+    chunk->used += len;
+    return chunk->data + chunk->used - len;
+}
+
+static inline void arena_free(HashArena *arena){
+    HashArenaChunk *chunk, *next;
+
+    if (arena == NULL)
+    {
+        return;
+    }
+    for (chunk = arena->chunks; chunk != NULL; chunk = next)
+    {
+        next = chunk->next;
+        free(chunk);
+    }
+    free(arena);
+}
+
+
+/* DJBϣټmurmur3fmix32õ7λ͸λֲ */
+static inline uint32_t hash_key(const char *key, uint32_t len){
+    uint32_t h = DJBHash((unsigned char *)key, len);
+
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+#define H1(hash) ((hash) >> 7)
+#define H2(hash) ((int8_t)((hash) & 0x7f))
+
+static inline const char* slot_key(const HashSlot *slot){
+    return slot->len < HASH_INLINE_KEY ? slot->key.inl : slot->key.ptr;
+}
+
+/* ֽڵcĲۣÿλӦһ */
+static inline uint32_t group_match(const int8_t *ctrl, int8_t c){
+#ifdef __SSE2__
+    __m128i g = _mm_load_si128((const __m128i *)ctrl);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(c)));
+#else
+    uint32_t mask = 0;
+    int32_t i;
+    for (i = 0; i < HASH_GROUP_SIZE; i++)
+    {
+        if (ctrl[i] == c)
+        {
+            mask |= 1U << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+/* ջɾĲ(λΪ1) */
+static inline uint32_t group_match_free(const int8_t *ctrl){
+#ifdef __SSE2__
+    __m128i g = _mm_load_si128((const __m128i *)ctrl);
+    return (uint32_t)_mm_movemask_epi8(g);
+#else
+    uint32_t mask = 0;
+    int32_t i;
+    for (i = 0; i < HASH_GROUP_SIZE; i++)
+    {
+        if (ctrl[i] < 0)
+        {
+            mask |= 1U << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+
+static inline int32_t tab_alloc(HashTab *tab, uint32_t capacity){
+    memset(tab, 0, sizeof(HashTab));
+    /* ֽڰ16ֽڶ룬SSE2öload */
+    tab->ctrl = (int8_t *)aligned_alloc(HASH_GROUP_SIZE, capacity);
+    tab->slots = (HashSlot *)malloc((size_t)capacity * sizeof(HashSlot));
+    tab->arena = (HashArena *)calloc(1, sizeof(HashArena));
+    if (tab->ctrl == NULL || tab->slots == NULL || tab->arena == NULL)
+    {
+        free(tab->ctrl);
+        free(tab->slots);
+        free(tab->arena);
+        memset(tab, 0, sizeof(HashTab));
+        return -1;
+    }
+    memset(tab->ctrl, CTRL_EMPTY, capacity);
+    tab->capacity = capacity;
+    tab->growth_left = capacity - capacity / 8;
+    return 0;
+}
+
+static inline void tab_free(HashTab *tab){
+    free(tab->ctrl);
+    free(tab->slots);
+    arena_free(tab->arena);
+    memset(tab, 0, sizeof(HashTab));
+}
+
+static inline int32_t tab_set_key(HashTab *tab, HashSlot *slot, const char *key,
+                           uint32_t len, uint32_t hash){
+    char *p;
+
+    slot->hash = hash;
+    slot->len = len;
+    if (len < HASH_INLINE_KEY)
+    {
+        memcpy(slot->key.inl, key, len);
+        slot->key.inl[len] = '\0';
+        return 0;
+    }
+    p = arena_alloc(tab->arena, len + 1);
+    if (p == NULL)
+    {
+        return -1;
+    }
+    memcpy(p, key, len);
+    p[len] = '\0';
+    slot->key.ptr = p;
+    return 0;
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
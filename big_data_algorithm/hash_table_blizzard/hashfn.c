@@ -56,6 +56,29 @@ unsigned long HashString( char *s, unsigned long HashType )
     return seed1;   
 } 
 
+//һαͬʱ012hashֵͷֱHashStringȡ32λͬ
+void HashStringAll(char *s, uint32_t *nHash, uint32_t *nHashA, uint32_t *nHashB)
+{
+    unsigned char *key = (unsigned char *)s;
+    uint32_t seed1[3] = {0x7FED7FED, 0x7FED7FED, 0x7FED7FED};
+    uint32_t seed2[3] = {0xEEEEEEEE, 0xEEEEEEEE, 0xEEEEEEEE};
+    uint32_t ch;
+    int i;
+
+    while (*key != 0)
+    {
+        ch = toupper(*key++);
+        for (i = 0; i < 3; i++)
+        {
+            seed1[i] = (uint32_t)cryptTable[(i << 8) + ch] ^ (seed1[i] + seed2[i]);
+            seed2[i] = ch + seed1[i] + seed2[i] + (seed2[i] << 5) + 3;
+        }
+    }
+    *nHash = seed1[0];
+    *nHashA = seed1[1];
+    *nHashB = seed1[2];
+}
+
 
 #ifdef __cplusplus
 }
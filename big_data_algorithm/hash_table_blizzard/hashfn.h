@@ -13,6 +13,8 @@ void prepareCryptTable();
 
 unsigned long HashString( char *s, unsigned long HashType );
 
+void HashStringAll(char *s, uint32_t *nHash, uint32_t *nHashA, uint32_t *nHashB);
+
 
 #endif /* __HASHFN_H__ */
 
@@ -8,6 +8,11 @@ extern "C"{
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "hashtable.h"
 #include "hashfn.h"
 
@@ -17,6 +22,282 @@ extern "C"{
 #define false 0
 extern uint32_t initcryptTable;
 
+#define HASH_MIN_SIZE       16
+#define HASH_MAX_SIZE       (1U << 30)
+#define HASH_MIGRATE_SLOTS  64          /* ÿput/removeἸ */
+
+#define HASH_IMAGE_MAGIC    "MPQHASH"
+#define HASH_IMAGE_VERSION  1
+#define HASH_IMAGE_DELETED  (1ULL << 63)        /* key_offλɾ */
+#define HASH_IMAGE_VALUE    (1ULL << 62)        /* valuekey'\0' */
+#define HASH_IMAGE_OFF_MASK (HASH_IMAGE_VALUE - 1)
+
+/* ļ = ͷ + sizeڵ + ַַ0ֽڿţ
+ * key_offΪ0ǿղۡûĹʱѹ */
+typedef struct HashImageHeader{
+    char magic[8];
+    uint32_t version;
+    uint32_t size;
+    uint64_t item_size;
+    uint64_t blob_len;
+} HashImageHeader;
+
+typedef struct HashImageNode{
+    uint32_t nHashA;
+    uint32_t nHashB;
+    uint64_t key_off;
+} HashImageNode;
+
+typedef struct HashImage{
+    char* base;
+    size_t len;
+    uint32_t size;
+    HashImageNode* nodes;
+    char* blob;
+    uint64_t blob_len;
+} HashImage;
+
+typedef struct HashKey{
+    uint32_t nHash;
+    uint32_t nHashA;
+    uint32_t nHashB;
+} HashKey;
+
+typedef void (*hash_visit_t)(char *key, char *value, HashKey *h, void *arg);
+
+
+/* ܷnԪҸص3/4С2 */
+static uint32_t size_for(uint64_t n){
+    uint32_t size = HASH_MIN_SIZE;
+
+    while (size < HASH_MAX_SIZE && (uint64_t)size / 4 * 3 <= n)
+    {
+        size *= 2;
+    }
+    return size;
+}
+
+static int32_t tab_alloc(HashTab *tab, uint32_t size){
+    HashNode *head = (HashNode *)calloc(size, sizeof(HashNode));
+
+    if (head == NULL)
+    {
+        return -1;
+    }
+    tab->head = head;
+    tab->size = size;
+    tab->used = 0;
+    tab->deleted = 0;
+    return 0;
+}
+
+static void tab_free(HashTab *tab){
+    free(tab->head);
+    memset(tab, 0, sizeof(HashTab));
+}
+
+/* ̽⡣ABָƶԺҪһkeyHashStringִСд
+ * ָͬkeyҲֿܷ档ûҵʱslotָһܲĲ */
+static HashNode* tab_lookup(HashTab *tab, char *key, HashKey *h,
+                            HashNode **slot){
+    uint32_t mask, pos;
+    HashNode *node;
+
+    if (slot != NULL)
+    {
+        *slot = NULL;
+    }
+    if (tab->size == 0)
+    {
+        return NULL;
+    }
+    mask = tab->size - 1;
+    for (pos = h->nHash & mask; ; pos = (pos + 1) & mask)
+    {
+        node = tab->head + pos;
+        if (node->bExists == HASH_NODE_USED)
+        {
+            if (node->nHashA == h->nHashA && node->nHashB == h->nHashB &&
+                strcmp(node->key, key) == 0)
+            {
+                return node;
+            }
+            continue;
+        }
+        if (slot != NULL && *slot == NULL)
+        {
+            *slot = node;
+        }
+        /* ղ˵keyűĹҪȥ */
+        if (node->bExists == HASH_NODE_EMPTY)
+        {
+            return NULL;
+        }
+    }
+}
+
+/* ֪keyڱֱҵһղۻĹ */
+static HashNode* tab_slot(HashTab *tab, uint32_t nHash){
+    uint32_t mask = tab->size - 1, pos;
+
+    for (pos = nHash & mask; tab->head[pos].bExists == HASH_NODE_USED;
+         pos = (pos + 1) & mask)
+        ;
+    return tab->head + pos;
+}
+
+static void tab_fill(HashTab *tab, HashNode *node, char *key, char *value,
+                     HashKey *h){
+    if (node->bExists == HASH_NODE_DELETED)
+    {
+        tab->deleted--;
+    }
+    tab->used++;
+    node->bExists = HASH_NODE_USED;
+    node->nHash = h->nHash;
+    node->nHashA = h->nHashA;
+    node->nHashB = h->nHashB;
+    node->key = key;
+    node->value = value;
+}
+
+static void tab_erase(HashTab *tab, HashNode *node){
+    node->bExists = HASH_NODE_DELETED;
+    node->key = NULL;
+    node->value = NULL;
+    tab->used--;
+    tab->deleted++;
+}
+
+/* ʱֻУͷʹСڵõʱٲ飺ƫַ
+ * ַ'\0'β̽һȦͷitem_sizeҲѭ */
+static HashImageNode* image_find(HashImage *image, char *key, HashKey *h){
+    uint32_t mask = image->size - 1, pos, n;
+    size_t len = strlen(key);
+    HashImageNode *node;
+    uint64_t off;
+
+    for (pos = h->nHash & mask, n = 0; n < image->size;
+         pos = (pos + 1) & mask, n++)
+    {
+        node = image->nodes + pos;
+        if (node->key_off == 0)
+        {
+            return NULL;
+        }
+        off = node->key_off & HASH_IMAGE_OFF_MASK;
+        if (!(node->key_off & HASH_IMAGE_DELETED) &&
+            node->nHashA == h->nHashA && node->nHashB == h->nHashB &&
+            off != 0 && off < image->blob_len &&
+            image->blob_len - off > len && image->blob[off + len] == '\0' &&
+            memcmp(image->blob + off, key, len) == 0)
+        {
+            return node;
+        }
+    }
+    return NULL;
+}
+
+/* ڵkeyƫԽû'\0'βNULL */
+static char* image_key(HashImage *image, HashImageNode *node){
+    uint64_t off = node->key_off & HASH_IMAGE_OFF_MASK;
+
+    if (off == 0 || off >= image->blob_len ||
+        memchr(image->blob + off, '\0', image->blob_len - off) == NULL)
+    {
+        return NULL;
+    }
+    return image->blob + off;
+}
+
+/* keyѾУvalueں棬ͬҪַ'\0'β */
+static char* image_value(HashImage *image, HashImageNode *node, char *key){
+    uint64_t off;
+
+    if (!(node->key_off & HASH_IMAGE_VALUE))
+    {
+        return NULL;
+    }
+    off = key + strlen(key) + 1 - image->blob;
+    if (off >= image->blob_len ||
+        memchr(image->blob + off, '\0', image->blob_len - off) == NULL)
+    {
+        return NULL;
+    }
+    return image->blob + off;
+}
+
+
+/* Ѿɱn۰ᵽ±ߵĲ۱Ĺɱ̽ */
+static void migrate_step(Hashtable *hashtable, uint32_t n){
+    HashTab *old = &hashtable->old;
+    HashNode *from;
+    HashKey h;
+
+    if (old->head == NULL)
+    {
+        return;
+    }
+    for (; n > 0 && hashtable->migrate_pos < old->size;
+         n--, hashtable->migrate_pos++)
+    {
+        from = old->head + hashtable->migrate_pos;
+        if (from->bExists != HASH_NODE_USED)
+        {
+            continue;
+        }
+        h.nHash = from->nHash;
+        h.nHashA = from->nHashA;
+        h.nHashB = from->nHashB;
+        tab_fill(&hashtable->cur, tab_slot(&hashtable->cur, h.nHash),
+                 from->key, from->value, &h);
+        tab_erase(old, from);
+    }
+    if (hashtable->migrate_pos == old->size)
+    {
+        tab_free(old);
+        hashtable->migrate_pos = 0;
+    }
+}
+
+/* òۼĹ3/4ͻһűԪضͷĹͰԭСؽ
+ * ԪʣúپС±ز3/8֮ǰ */
+static int32_t start_resize(Hashtable *hashtable){
+    HashTab *cur = &hashtable->cur;
+    uint32_t size;
+
+    /* һλû꣬һΰ */
+    if (hashtable->old.head != NULL)
+    {
+        migrate_step(hashtable, hashtable->old.size);
+        if (cur->used + cur->deleted < cur->size / 4 * 3)
+        {
+            return 0;
+        }
+    }
+    size = size_for((uint64_t)cur->used + cur->used / 2);
+    if (cur->used >= size / 4 * 3)
+    {
+        return -1;
+    }
+    hashtable->old = *cur;
+    if (tab_alloc(cur, size) == -1)
+    {
+        *cur = hashtable->old;
+        memset(&hashtable->old, 0, sizeof(HashTab));
+        return -1;
+    }
+    hashtable->size = size;
+    hashtable->migrate_pos = 0;
+    migrate_step(hashtable, HASH_MIGRATE_SLOTS);
+    return 0;
+}
+
+static void hash_key(char *key, HashKey *h){
+    HashStringAll(key, &h->nHash, &h->nHashA, &h->nHashB);
+}
+
+
 /*ʼhashtable*/
 Hashtable* hashtable_init(uint32_t size){
     if (initcryptTable == 0)
@@ -25,101 +306,535 @@ Hashtable* hashtable_init(uint32_t size){
         initcryptTable = 1;
     }
     Hashtable* hashtable = (Hashtable*)calloc(1, sizeof(Hashtable));
-    hashtable->size = size;
+    if (hashtable == NULL)
+    {
+        return NULL;
+    }
+    if (tab_alloc(&hashtable->cur, size_for(size)) == -1)
+    {
+        free(hashtable);
+        return NULL;
+    }
+    hashtable->size = hashtable->cur.size;
     hashtable->item_size = 0;
-    HashNode* head = (HashNode *)calloc(size, sizeof(HashNode));
-    hashtable->head = head;
     return hashtable;
 }
 
 /*һ*/
 void hashtable_put(Hashtable *hashtable, char* key, char* value){
 
-    const uint32_t HASH_OFFSET = 0, HASH_A = 1, HASH_B = 2;
-    uint32_t nHash = HashString(key, HASH_OFFSET);
-    uint32_t nHashA = HashString(key, HASH_A);
-    uint32_t nHashB = HashString(key, HASH_B);
-    uint32_t nHashStart = nHash % hashtable->size; 
-    uint32_t nHashPos = nHashStart;
+    HashTab *cur = &hashtable->cur;
+    HashImageNode *inode = NULL;
+    HashNode *node, *slot;
+    HashKey h;
+
+    hash_key(key, &h);
+    migrate_step(hashtable, HASH_MIGRATE_SLOTS);
 
-    HashNode *hashNode = hashtable->head + nHashPos;
-    while (hashNode->bExists)
+    node = tab_lookup(cur, key, &h, &slot);
+    if (node == NULL)
     {
-        if (hashNode->nHashA == nHashA && hashNode->nHashB == nHashB)
-            break;
-        else
-        {
-            nHashPos = (nHashPos + 1) % nHash % hashtable->size;
-            hashNode = hashtable->head + nHashPos;
-        }
-         
-        if (nHashPos == nHashStart)
+        node = tab_lookup(&hashtable->old, key, &h, NULL);
+    }
+    if (node != NULL)
+    {
+        node->value = value; //ھֵ滻
+        return;
+    }
+
+    /* keyŲڴǷݱɾ */
+    if (hashtable->image != NULL)
+    {
+        inode = image_find(hashtable->image, key, &h);
+    }
+
+    if (cur->used + cur->deleted >= cur->size / 4 * 3)
+    {
+        if (start_resize(hashtable) == -1)
         {
-            printf("The hash table is out\n");
+            fprintf(stderr, "hashtable: out of memory, %s not added\n", key);
             return;
         }
+        slot = tab_slot(cur, h.nHash);
+    }
+    tab_fill(cur, slot, key, value, &h);
+    if (inode != NULL)
+    {
+        inode->key_off |= HASH_IMAGE_DELETED;
+        return;
     }
-    hashNode->bExists = 1;
-    hashNode->nHashA = nHashA;
-    hashNode->nHashB = nHashB;
-    hashNode->key = key;
-    hashNode->value = value;
     hashtable->item_size = hashtable->item_size + 1;
-    return;
-        
+}
+
+/* ±ɱҵ1valueΪNULL */
+static int32_t table_find(Hashtable *hashtable, char *key, char **value){
+
+    HashImageNode *inode;
+    HashNode *node;
+    HashKey h;
+
+    hash_key(key, &h);
+    node = tab_lookup(&hashtable->cur, key, &h, NULL);
+    if (node == NULL)
+    {
+        node = tab_lookup(&hashtable->old, key, &h, NULL);
+    }
+    if (node != NULL)
+    {
+        if (value != NULL)
+        {
+            *value = node->value;
+        }
+        return 1;
+    }
+    if (hashtable->image != NULL)
+    {
+        inode = image_find(hashtable->image, key, &h);
+        if (inode != NULL)
+        {
+            if (value != NULL)
+            {
+                *value = image_value(hashtable->image, inode,
+                                     image_key(hashtable->image, inode));
+            }
+            return 1;
+        }
+    }
+    return 0;
 }
 
 /*ȡһ*/
-HashNode * hashtable_get(Hashtable *hashtable, char* key){
+char* hashtable_get(Hashtable *hashtable, char* key){
+    char *value = NULL;
+
+    table_find(hashtable, key, &value);
+    return value;
+}
+
+/*ǷڣvalueΪNULLkeyҲ*/
+int32_t hashtable_contains(Hashtable *hashtable, char* key){
+    return table_find(hashtable, key, NULL);
+}
+
+/*ɾһ*/
+void hashtable_remove(Hashtable *hashtable, char* key){
 
-    const uint32_t HASH_OFFSET = 0, HASH_A = 1, HASH_B = 2;
-    uint32_t nHash = HashString(key, HASH_OFFSET);
-    uint32_t nHashA = HashString(key, HASH_A);
-    uint32_t nHashB = HashString(key, HASH_B);
-    uint32_t nHashStart = nHash % hashtable->size; 
-    uint32_t nHashPos = nHashStart;
+    HashTab *cur = &hashtable->cur;
+    HashImageNode *inode;
+    HashNode *node;
+    HashKey h;
 
-    HashNode *hashNode = hashtable->head + nHashPos;
-    while (hashNode->bExists)
+    hash_key(key, &h);
+    migrate_step(hashtable, HASH_MIGRATE_SLOTS);
+
+    if ((node = tab_lookup(cur, key, &h, NULL)) != NULL)
     {
-        if (hashNode->nHashA == nHashA && hashNode->nHashB == nHashB)
-            return hashNode;
-        else
+        tab_erase(cur, node);
+    }
+    else if ((node = tab_lookup(&hashtable->old, key, &h, NULL)) != NULL)
+    {
+        tab_erase(&hashtable->old, node);
+    }
+    else if (hashtable->image != NULL &&
+             (inode = image_find(hashtable->image, key, &h)) != NULL)
+    {
+        inode->key_off |= HASH_IMAGE_DELETED;
+    }
+    else
+    {
+        return;
+    }
+    hashtable->item_size = hashtable->item_size - 1;
+
+    /* Ĺ1/4鲻keyҪߺܳ̽ѹһ */
+    if (hashtable->old.head == NULL && cur->deleted > cur->size / 4)
+    {
+        start_resize(hashtable);
+    }
+}
+
+
+static void tab_foreach(HashTab *tab, hash_visit_t visit, void *arg){
+    uint32_t index;
+    HashNode *node;
+    HashKey h;
+
+    for (index = 0; index < tab->size; index++)
+    {
+        node = tab->head + index;
+        if (node->bExists != HASH_NODE_USED)
+        {
+            continue;
+        }
+        h.nHash = node->nHash;
+        h.nHashA = node->nHashA;
+        h.nHashB = node->nHashB;
+        visit(node->key, node->value, &h, arg);
+    }
+}
+
+/* ̶˳һԪأ±ɱ */
+static void table_foreach(Hashtable *hashtable, hash_visit_t visit, void *arg){
+    HashImage *image = hashtable->image;
+    HashImageNode *node;
+    uint32_t index;
+    HashKey h;
+    char *key;
+
+    tab_foreach(&hashtable->cur, visit, arg);
+    tab_foreach(&hashtable->old, visit, arg);
+    if (image == NULL)
+    {
+        return;
+    }
+    for (index = 0; index < image->size; index++)
+    {
+        node = image->nodes + index;
+        if (node->key_off == 0 || (node->key_off & HASH_IMAGE_DELETED))
+        {
+            continue;
+        }
+        key = image_key(image, node);
+        if (key == NULL)
         {
-            nHashPos = (nHashPos + 1) % nHash % hashtable->size;
-            hashNode = hashtable->head + nHashPos;
+            continue;
         }
-         
-        if (nHashPos == nHashStart)
+        hash_key(key, &h);
+        visit(key, image_value(image, node, key), &h, arg);
+    }
+}
+
+
+/* ļֱkeyͨļmmap
+ * ܵһûлеľһreadĩβһ */
+static int32_t keyfile_read(HashKeyFile *kf, const char *path){
+    int fd = strcmp(path, "-") == 0 ? STDIN_FILENO : open(path, O_RDONLY);
+    size_t cap = 1 << 20;
+    struct stat st;
+    ssize_t n;
+    char *buf;
+
+    memset(kf, 0, sizeof(HashKeyFile));
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        buf = (char *)mmap(NULL, st.st_size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE, fd, 0);
+        if (buf != MAP_FAILED && buf[st.st_size - 1] == '\n')
+        {
+            madvise(buf, st.st_size, MADV_SEQUENTIAL);
+            kf->base = buf;
+            kf->len = st.st_size;
+            kf->mapped = 1;
+            goto out;
+        }
+        if (buf != MAP_FAILED)
+        {
+            munmap(buf, st.st_size);
+        }
+        cap = st.st_size + 2;
+    }
+
+    kf->base = (char *)malloc(cap);
+    while (kf->base != NULL)
+    {
+        if (kf->len + 1 >= cap)
+        {
+            cap *= 2;
+            buf = (char *)realloc(kf->base, cap);
+            if (buf == NULL)
+            {
+                break;
+            }
+            kf->base = buf;
+        }
+        n = read(fd, kf->base + kf->len, cap - kf->len - 1);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            if (n == 0)
+            {
+                if (kf->len == 0 || kf->base[kf->len - 1] != '\n')
+                {
+                    kf->base[kf->len++] = '\n';
+                }
+                goto out;
+            }
             break;
+        }
+        kf->len += n;
+    }
+    free(kf->base);
+    kf->base = NULL;
+    if (fd != STDIN_FILENO)
+    {
+        close(fd);
+    }
+    return -1;
+
+out:
+    if (fd != STDIN_FILENO)
+    {
+        close(fd);
+    }
+    return 0;
+}
+
+static void keyfile_free(HashKeyFile *kf){
+    if (kf->mapped)
+    {
+        munmap(kf->base, kf->len);
+    }
+    else
+    {
+        free(kf->base);
+    }
+    memset(kf, 0, sizeof(HashKeyFile));
+}
+
+/*ļ*/
+Hashtable* hashtable_build(const char *path){
+    Hashtable *hashtable;
+    HashKeyFile kf;
+    uint64_t lines = 0;
+    char *p, *end, *nl, *value;
+
+    if (keyfile_read(&kf, path) == -1)
+    {
+        return NULL;
+    }
+    end = kf.base + kf.len;
+    /* ѱһοʱͲݰ */
+    for (p = kf.base; (p = (char *)memchr(p, '\n', end - p)) != NULL; p++)
+    {
+        lines++;
+    }
+    hashtable = hashtable_init(lines < HASH_MAX_SIZE ? lines : HASH_MAX_SIZE);
+    if (hashtable == NULL)
+    {
+        keyfile_free(&kf);
+        return NULL;
     }
+    hashtable->keyfile = kf;
 
-    return NULL; //Error value
+    for (p = kf.base; p < end; p = nl + 1)
+    {
+        nl = (char *)memchr(p, '\n', end - p);
+        *nl = '\0';
+        if (nl > p && nl[-1] == '\r')
+        {
+            nl[-1] = '\0';
+        }
+        if (*p == '\0')
+        {
+            continue;
+        }
+        /* ֻkeyvalueմhashtable_getûkey */
+        value = strchr(p, '\t');
+        if (value != NULL)
+        {
+            *value++ = '\0';
+        }
+        else
+        {
+            value = "";
+        }
+        hashtable_put(hashtable, p, value);
+    }
+    return hashtable;
+}
+
+
+struct save_ctx {
+    HashImageNode *nodes;
+    uint32_t mask;
+    uint64_t off;
+    FILE *fp;
+};
+
+/* һ飺źýڵλãÿkeyַƫ */
+static void save_place(char *key, char *value, HashKey *h, void *arg){
+    struct save_ctx *ctx = (struct save_ctx *)arg;
+    uint32_t pos;
+
+    for (pos = h->nHash & ctx->mask; ctx->nodes[pos].key_off != 0;
+         pos = (pos + 1) & ctx->mask)
+        ;
+    ctx->nodes[pos].nHashA = h->nHashA;
+    ctx->nodes[pos].nHashB = h->nHashB;
+    ctx->nodes[pos].key_off = ctx->off | (value != NULL ? HASH_IMAGE_VALUE : 0);
+    ctx->off += strlen(key) + 1 + (value != NULL ? strlen(value) + 1 : 0);
 }
 
+/* ڶ飺ͬ˳дַ */
+static void save_write(char *key, char *value, HashKey *h, void *arg){
+    struct save_ctx *ctx = (struct save_ctx *)arg;
+
+    fwrite(key, strlen(key) + 1, 1, ctx->fp);
+    if (value != NULL)
+    {
+        fwrite(value, strlen(value) + 1, 1, ctx->fp);
+    }
+}
+
+/*澵дʱļٸ°*/
+int32_t hashtable_save(Hashtable *hashtable, const char *path){
+    HashImageHeader hdr;
+    struct save_ctx ctx;
+    char *tmp;
+    int32_t ret = -1;
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, HASH_IMAGE_MAGIC, sizeof(HASH_IMAGE_MAGIC));
+    hdr.version = HASH_IMAGE_VERSION;
+    hdr.size = size_for(hashtable->item_size);
+    hdr.item_size = hashtable->item_size;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.nodes = (HashImageNode *)calloc(hdr.size, sizeof(HashImageNode));
+    tmp = (char *)malloc(strlen(path) + 5);
+    if (ctx.nodes == NULL || tmp == NULL)
+    {
+        goto out;
+    }
+    ctx.mask = hdr.size - 1;
+    ctx.off = 1;
+    table_foreach(hashtable, save_place, &ctx);
+    if (ctx.off > HASH_IMAGE_OFF_MASK)
+    {
+        goto out;
+    }
+    hdr.blob_len = ctx.off;
+
+    sprintf(tmp, "%s.tmp", path);
+    ctx.fp = fopen(tmp, "wb");
+    if (ctx.fp == NULL)
+    {
+        goto out;
+    }
+    fwrite(&hdr, sizeof(hdr), 1, ctx.fp);
+    fwrite(ctx.nodes, sizeof(HashImageNode), hdr.size, ctx.fp);
+    fputc('\0', ctx.fp);
+    table_foreach(hashtable, save_write, &ctx);
+    if (ferror(ctx.fp) | fclose(ctx.fp) || rename(tmp, path) == -1)
+    {
+        unlink(tmp);
+        goto out;
+    }
+    ret = 0;
+
+out:
+    free(ctx.nodes);
+    free(tmp);
+    return ret;
+}
+
+/* Ԫظֻڵkey_offַ */
+static uint64_t image_count(const HashImageNode *nodes, uint32_t size){
+    uint64_t used = 0;
+    uint32_t index;
+
+    for (index = 0; index < size; index++)
+    {
+        used += nodes[index].key_off != 0;
+    }
+    return used;
+}
+
+/*򿪾mmapУͷֵĴСԪظַ
+ *ڵƫƺַimage_find/image_valueõʱУ顣
+ *ԪظҪͽڵϣʱ±Сɾʱ*/
+Hashtable* hashtable_open(const char *path){
+    Hashtable *hashtable;
+    HashImageHeader *hdr;
+    HashImage *image;
+    struct stat st;
+    char *base;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(HashImageHeader))
+    {
+        close(fd);
+        return NULL;
+    }
+    /* ˽ӳ䣬ɾдԼĸϣĵļ */
+    base = (char *)mmap(NULL, st.st_size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        return NULL;
+    }
+    hdr = (HashImageHeader *)base;
+    if (memcmp(hdr->magic, HASH_IMAGE_MAGIC, sizeof(HASH_IMAGE_MAGIC)) != 0 ||
+        hdr->version != HASH_IMAGE_VERSION || hdr->size < HASH_MIN_SIZE ||
+        (hdr->size & (hdr->size - 1)) != 0 || hdr->item_size >= hdr->size ||
+        hdr->blob_len == 0 || hdr->blob_len > (uint64_t)st.st_size ||
+        (uint64_t)st.st_size != sizeof(HashImageHeader) +
+            (uint64_t)hdr->size * sizeof(HashImageNode) + hdr->blob_len ||
+        image_count((HashImageNode *)(hdr + 1), hdr->size) != hdr->item_size)
+    {
+        fprintf(stderr, "hashtable: %s is not a hashtable image\n", path);
+        munmap(base, st.st_size);
+        return NULL;
+    }
+
+    image = (HashImage *)calloc(1, sizeof(HashImage));
+    hashtable = image != NULL ? hashtable_init(0) : NULL;
+    if (hashtable == NULL)
+    {
+        free(image);
+        munmap(base, st.st_size);
+        return NULL;
+    }
+    image->base = base;
+    image->len = st.st_size;
+    image->size = hdr->size;
+    image->nodes = (HashImageNode *)(hdr + 1);
+    image->blob = (char *)(image->nodes + hdr->size);
+    image->blob_len = hdr->blob_len;
+    hashtable->image = image;
+    hashtable->item_size = hdr->item_size;
+    return hashtable;
+}
 
 
 /**/
 void hashtable_destroy(Hashtable *hashtable){
-    free(hashtable->head);
+    tab_free(&hashtable->cur);
+    tab_free(&hashtable->old);
+    if (hashtable->image != NULL)
+    {
+        munmap(hashtable->image->base, hashtable->image->len);
+        free(hashtable->image);
+    }
+    keyfile_free(&hashtable->keyfile);
     free(hashtable);
 }
 
+static void print_node(char *key, char *value, HashKey *h, void *arg){
+    printf("index:%u\t%s:%s\n", h->nHash & *(uint32_t *)arg, key,
+           value != NULL ? value : "");
+}
+
 /*ӡ*/
 void hashtable_print(Hashtable *hashtable){
-    HashNode *head = hashtable->head;
-    uint32_t index;
-    for (index = 0; index < hashtable->size; index++)
-    {
-        printf("index:%d\t", index);
-        if (head->key!=NULL)
-        {
-            printf("%s:%s\n", head->key, head->value);
-        }
-        head++;
-    }
+    uint32_t mask = hashtable->cur.size - 1;
+
+    table_foreach(hashtable, print_node, &mask);
 }
 
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
@@ -6,32 +6,73 @@ extern "C"{
 #define __HASHTABLE_H__
 
 #include <stdint.h>
+#include <stddef.h>
+
+/* bExistsȡֵ */
+#define HASH_NODE_EMPTY     0
+#define HASH_NODE_USED      1
+#define HASH_NODE_DELETED   2   /* Ĺʱʱɸ */
 
 typedef struct HashNode{
-    int nHashA;  
-    int nHashB;  
+    uint32_t nHash;     /* ʼλãݰǨʱ */
+    uint32_t nHashA;
+    uint32_t nHashB;
     char bExists;
     char *key;
     char *value;
 } HashNode;
 
+/* һ̽ıΪ2 */
+typedef struct HashTab{
+    HashNode* head;
+    uint32_t size;
+    uint32_t used;
+    uint32_t deleted;
+} HashTab;
+
+struct HashImage;
+
+/* hashtable_buildkeyļkeyvalueֱָ */
+typedef struct HashKeyFile{
+    char* base;
+    size_t len;
+    int32_t mapped;
+} HashKeyFile;
 
 typedef struct Hashtable{
     int32_t size;
     int32_t item_size;
-    HashNode* head;
+    HashTab cur;
+    HashTab old;                /* ݻѹʱľɱͷ */
+    uint32_t migrate_pos;
+    struct HashImage* image;    /* hashtable_openӳľ */
+    HashKeyFile keyfile;
 } Hashtable;
 
 
-/*ʼ*/
+/*ʼsizeΪԤƵԪظ*/
 Hashtable* hashtable_init(uint32_t size);
 
-/*һ*/
+/*һkeyvalue֤߱һֱЧ*/
 void hashtable_put(Hashtable *hashtable, char* key, char* value);
 
-/*ȡһ*/
-HashNode * hashtable_get(Hashtable *hashtable, char* key);
+/*ȡһڷNULLputʱvalueΪNULLkeyҲNULLhashtable_contains*/
+char* hashtable_get(Hashtable *hashtable, char* key);
 
+/*Ƿڣڷ1*/
+int32_t hashtable_contains(Hashtable *hashtable, char* key);
+
+/*ɾһ*/
+void hashtable_remove(Hashtable *hashtable, char* key);
+
+/*ļһνÿkeykey\tvalueֻkeyvalueΪմpathΪ"-"ʱ׼*/
+Hashtable* hashtable_build(const char *path);
+
+/*ɿֱmmapľvalueַɹ0*/
+int32_t hashtable_save(Hashtable *hashtable, const char *path);
+
+/*mmap򿪾֮ճдĶдļ*/
+Hashtable* hashtable_open(const char *path);
 
 /**/
 void hashtable_destroy(Hashtable *hashtable);
@@ -44,4 +85,3 @@ void hashtable_print(Hashtable *hashtable);
 #ifdef __cplusplus
 }
 #endif
-
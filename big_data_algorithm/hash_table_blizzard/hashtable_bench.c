@@ -0,0 +1,260 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/* ѩhashtableԣ
+ * 1. 16ۿʼput nkeyһ·ݣɾһ룬ĹѹĲѯ
+ * 2. nkeyдļhashtable_buildһνɾ
+ * 3. hashtable_open񣬿ʱһβѯȫѯ
+ *    ھɾһ֣ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "hashtable.h"
+
+#define KEY_STRIDE      32
+#define SHUFFLE_PRIME   2654435761ULL
+
+static uint32_t nkeys = 10000000;
+static const char *prefix = "/tmp/hashtable_bench";
+static int32_t sorted = 0;
+static int32_t keep_files = 0;
+
+static char *keys;
+
+static double now_sec(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* ʣk *  mod n 0..n-1һ */
+static inline uint32_t shuffle(uint64_t k, uint32_t n){
+    return (uint32_t)(k * SHUFFLE_PRIME % n);
+}
+
+static inline char *key_at(uint32_t i){
+    return keys + (size_t)i * KEY_STRIDE;
+}
+
+/* key飬valueӦ"v"key */
+static int32_t check_value(char *value, uint32_t i){
+    char buf[KEY_STRIDE];
+
+    snprintf(buf, sizeof(buf), "v%u", i);
+    return value != NULL && strcmp(value, buf) == 0;
+}
+
+static int32_t bench_grow(void){
+    Hashtable *hashtable = hashtable_init(0);
+    char miss[KEY_STRIDE];
+    uint32_t i, found = 0;
+    double t, t_put, t_hit, t_remove, t_miss;
+
+    t = now_sec();
+    for (i = 0; i < nkeys; i++)
+    {
+        hashtable_put(hashtable, key_at(i), key_at(i));
+    }
+    t_put = now_sec() - t;
+
+    t = now_sec();
+    for (i = 0; i < nkeys; i++)
+    {
+        found += hashtable_get(hashtable, key_at(shuffle(i, nkeys))) ==
+                 key_at(shuffle(i, nkeys));
+    }
+    t_hit = now_sec() - t;
+
+    t = now_sec();
+    for (i = 0; i < nkeys; i += 2)
+    {
+        hashtable_remove(hashtable, key_at(i));
+    }
+    t_remove = now_sec() - t;
+
+    t = now_sec();
+    for (i = 0; i < nkeys; i++)
+    {
+        memcpy(miss, key_at(shuffle(i, nkeys)), KEY_STRIDE);
+        miss[0] = 'x';
+        found += hashtable_get(hashtable, miss) != NULL;
+    }
+    t_miss = now_sec() - t;
+    for (i = 0; i < nkeys; i++)
+    {
+        found -= (hashtable_get(hashtable, key_at(i)) != NULL) != (i & 1);
+    }
+
+    printf("grow:  put %6.1f ns, get hit %6.1f ns, remove %6.1f ns, "
+           "get miss %6.1f ns, size %d, %s\n",
+           t_put * 1e9 / nkeys, t_hit * 1e9 / nkeys,
+           t_remove * 1e9 / ((nkeys + 1) / 2), t_miss * 1e9 / nkeys,
+           hashtable->size,
+           found == nkeys && hashtable->item_size == (int32_t)(nkeys / 2) ?
+           "ok" : "WRONG");
+    hashtable_destroy(hashtable);
+    return found == nkeys ? 0 : -1;
+}
+
+static int32_t write_keys(const char *path){
+    FILE *fp = fopen(path, "w");
+    uint32_t i, k;
+
+    if (fp == NULL)
+    {
+        return -1;
+    }
+    for (i = 0; i < nkeys; i++)
+    {
+        k = sorted ? i : shuffle(i, nkeys);
+        fprintf(fp, "%s\tv%u\n", key_at(k), k);
+    }
+    return fclose(fp) == 0 ? 0 : -1;
+}
+
+static int32_t bench_image(void){
+    char txt[256], img[256];
+    Hashtable *hashtable;
+    uint32_t i, bad = 0;
+    struct stat st;
+    double t, t_first;
+
+    snprintf(txt, sizeof(txt), "%s.txt", prefix);
+    snprintf(img, sizeof(img), "%s.img", prefix);
+    if (write_keys(txt) == -1)
+    {
+        fprintf(stderr, "can not write %s\n", txt);
+        return -1;
+    }
+
+    t = now_sec();
+    hashtable = hashtable_build(txt);
+    if (hashtable == NULL)
+    {
+        fprintf(stderr, "can not build from %s\n", txt);
+        return -1;
+    }
+    printf("build: %s file, %.3f s, %.1f ns/key, %d keys\n",
+           sorted ? "sorted" : "shuffled", now_sec() - t,
+           (now_sec() - t) * 1e9 / nkeys, hashtable->item_size);
+
+    t = now_sec();
+    if (hashtable_save(hashtable, img) == -1)
+    {
+        fprintf(stderr, "can not save %s\n", img);
+        hashtable_destroy(hashtable);
+        return -1;
+    }
+    stat(img, &st);
+    printf("save:  %.3f s, image %ld MB\n", now_sec() - t,
+           (long)(st.st_size >> 20));
+    hashtable_destroy(hashtable);
+
+    t = now_sec();
+    hashtable = hashtable_open(img);
+    t = now_sec() - t;
+    if (hashtable == NULL)
+    {
+        fprintf(stderr, "can not open %s\n", img);
+        return -1;
+    }
+    t_first = now_sec();
+    bad += !check_value(hashtable_get(hashtable, key_at(nkeys / 2)), nkeys / 2);
+    t_first = now_sec() - t_first;
+    printf("open:  %.3f ms, first get %.1f us\n", t * 1e3, t_first * 1e6);
+
+    t = now_sec();
+    for (i = 0; i < nkeys; i++)
+    {
+        bad += !check_value(hashtable_get(hashtable, key_at(shuffle(i, nkeys))),
+                            shuffle(i, nkeys));
+    }
+    t = now_sec() - t;
+    printf("image: get hit %6.1f ns (cold pages included)\n", t * 1e9 / nkeys);
+
+    t = now_sec();
+    for (i = 0; i < nkeys; i++)
+    {
+        bad += !check_value(hashtable_get(hashtable, key_at(shuffle(i, nkeys))),
+                            shuffle(i, nkeys));
+    }
+    t = now_sec() - t;
+    printf("image: get hit %6.1f ns (warm)\n", t * 1e9 / nkeys);
+
+    /* ɾ1/4д1/4Ķڴļ */
+    for (i = 0; i < nkeys; i += 4)
+    {
+        hashtable_remove(hashtable, key_at(i));
+        hashtable_put(hashtable, key_at(i + 1 < nkeys ? i + 1 : i), "new");
+    }
+    for (i = 0; i < nkeys; i++)
+    {
+        if (i % 4 == 0)
+            bad += hashtable_get(hashtable, key_at(i)) != NULL;
+        else if (i % 4 == 1)
+            bad += strcmp(hashtable_get(hashtable, key_at(i)), "new") != 0;
+        else
+            bad += !check_value(hashtable_get(hashtable, key_at(i)), i);
+    }
+    bad += hashtable->item_size != (int32_t)(nkeys - (nkeys + 3) / 4);
+    printf("overlay: %d keys after removes and updates, %s\n",
+           hashtable->item_size, bad == 0 ? "ok" : "WRONG");
+    hashtable_destroy(hashtable);
+
+    if (!keep_files)
+    {
+        unlink(txt);
+        unlink(img);
+    }
+    return bad == 0 ? 0 : -1;
+}
+
+static void usage(char *name){
+    fprintf(stderr, "Usage: %s [-n keys] [-p file_prefix] [-s] [-k]\n"
+            "  -n     number of keys (default 10M)\n"
+            "  -p     key file and image are <prefix>.txt and <prefix>.img\n"
+            "  -s     write the key file sorted\n"
+            "  -k     keep the files\n", name);
+    exit(EXIT_FAILURE);
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    int32_t opt, ret = 0;
+    uint32_t i;
+
+    while ((opt = getopt(argc, argv, "n:p:skh")) != -1) {
+        switch (opt) {
+        case 'n': nkeys = strtoul(optarg, NULL, 0); break;
+        case 'p': prefix = optarg; break;
+        case 's': sorted = 1; break;
+        case 'k': keep_files = 1; break;
+        default: usage(argv[0]);
+        }
+    }
+    if (nkeys < 2 || nkeys > 500000000)
+        usage(argv[0]);
+
+    keys = (char *)malloc((size_t)nkeys * KEY_STRIDE);
+    if (keys == NULL)
+        return 1;
+    for (i = 0; i < nkeys; i++)
+        snprintf(key_at(i), KEY_STRIDE, "dict:%010u", i);
+
+    if (bench_grow() != 0)
+        ret = 1;
+    if (bench_image() != 0)
+        ret = 1;
+    free(keys);
+    return ret;
+}
+
+#ifdef __cplusplus
+}
+#endif
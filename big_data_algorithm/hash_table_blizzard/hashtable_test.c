@@ -4,11 +4,149 @@ extern "C"{
 
 #include <stdint.h> /* uint64_t*/
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 #include "hashtable.h"
 #include "hashfn.h"
 
+/* ֻkeyļʹɾٴ򿪣Ҫܲ鵽ûkey */
+static int32_t test_keyonly(void){
+    const char *keys = "/tmp/hashtable_test_keys.txt";
+    const char *image = "/tmp/hashtable_test_keys.img";
+    Hashtable *built, *opened, *t;
+    int32_t failed = 0, round;
+    FILE *fp;
+
+    fp = fopen(keys, "w");
+    if (fp == NULL)
+    {
+        return 1;
+    }
+    fputs("alpha\nbeta\ngamma\tg\n", fp);
+    fclose(fp);
+
+    built = hashtable_build(keys);
+    if (built == NULL || hashtable_save(built, image) != 0)
+    {
+        unlink(keys);
+        return 1;
+    }
+    opened = hashtable_open(image);
+    for (round = 0; round < 2; round++)
+    {
+        t = round == 0 ? built : opened;
+        if (t == NULL || t->item_size != 3 ||
+            hashtable_get(t, "beta") == NULL || hashtable_get(t, "beta")[0] != '\0' ||
+            !hashtable_contains(t, "alpha") || hashtable_contains(t, "delta") ||
+            hashtable_get(t, "delta") != NULL ||
+            hashtable_get(t, "gamma") == NULL || strcmp(hashtable_get(t, "gamma"), "g") != 0)
+        {
+            printf("key-only %s: wrong lookup\n", round == 0 ? "build" : "image");
+            failed++;
+        }
+    }
+    if (opened != NULL)
+    {
+        hashtable_destroy(opened);
+    }
+    hashtable_destroy(built);
+    unlink(keys);
+    unlink(image);
+    return failed;
+}
+
+/* ͷԪظռвۻߺͽڵԲҪ򲻿ڵƫƸĵַ棬
+ * ȥַ'\0'ʱ飬鵽ڵʱԽ */
+static int32_t test_corrupt(void){
+    const char *image = "/tmp/hashtable_test_bad.img";
+    Hashtable *t;
+    int32_t failed = 0, round, bad;
+    struct { uint32_t a, b; uint64_t off; } node;   /* HashImageNodeһ */
+    uint32_t size;
+    uint64_t items;
+    char buf[1 << 12];
+    size_t len, i;
+    FILE *fp;
+
+    for (round = 0; round < 4; round++)
+    {
+        t = hashtable_init(4);
+        hashtable_put(t, "key", "value");
+        hashtable_save(t, image);
+        hashtable_destroy(t);
+
+        fp = fopen(image, "r+b");
+        if (fp == NULL)
+        {
+            return 1;
+        }
+        len = fread(buf, 1, sizeof(buf), fp);
+        if (round == 0)
+        {
+            /* ͷƫ12ǲ16Ԫظ */
+            memcpy(&size, buf + 12, sizeof(size));
+            items = size;
+            memcpy(buf + 16, &items, sizeof(items));
+        }
+        else if (round == 3)
+        {
+            items = 0;
+            memcpy(buf + 16, &items, sizeof(items));
+        }
+        else if (round == 1)
+        {
+            /* 32ֽڵͷ֮ǽڵ */
+            for (i = 32; i + sizeof(node) <= len; i += sizeof(node))
+            {
+                memcpy(&node, buf + i, sizeof(node));
+                if (node.off != 0)
+                {
+                    node.off += 1 << 20;
+                    memcpy(buf + i, &node, sizeof(node));
+                    break;
+                }
+            }
+        }
+        else
+        {
+            buf[len - 1] = 'x';
+        }
+        rewind(fp);
+        fwrite(buf, 1, len, fp);
+        fclose(fp);
+
+        t = hashtable_open(image);
+        if (round == 0 || round == 3)
+        {
+            bad = t != NULL;
+        }
+        else if (round == 1)
+        {
+            bad = t == NULL || hashtable_contains(t, "key");
+        }
+        else
+        {
+            bad = t == NULL || !hashtable_contains(t, "key") ||
+                  hashtable_get(t, "key") != NULL;
+        }
+        if (bad)
+        {
+            printf("corrupt image %d: wrong result\n", round);
+            failed++;
+        }
+        if (t != NULL)
+        {
+            hashtable_destroy(t);
+        }
+    }
+    unlink(image);
+    return failed;
+}
+
 int32_t main(int32_t argc, char **argv)
 {
+    int32_t failed;
+
     Hashtable * hashtable = hashtable_init(10);
     hashtable_put(hashtable, "a", "1");
     hashtable_put(hashtable, "b", "2");
@@ -23,14 +161,21 @@ int32_t main(int32_t argc, char **argv)
     hashtable_put(hashtable, "k", "11");
     hashtable_put(hashtable, "l", "12");
     hashtable_put(hashtable, "f", "8");
+    hashtable_put(hashtable, "F", "F"); /*HashStringִСдָͬҲҪֿ*/
+    hashtable_remove(hashtable, "a");
     hashtable_print(hashtable);
 
-   // HashNode * s = hashtable_get(hashtable, "a");
-    //printf("a=%d",*(int *)s->value);
+    printf("f=%s F=%s a=%s count=%d\n", hashtable_get(hashtable, "f"),
+           hashtable_get(hashtable, "F"),
+           hashtable_get(hashtable, "a") ? "exists" : "removed",
+           hashtable->item_size);
 
     hashtable_destroy(hashtable);
+
+    failed = test_keyonly() + test_corrupt();
+    printf(failed != 0 ? "%d failed\n" : "all passed\n", failed);
     getchar();
-    return 0;
+    return failed != 0;
 }
 
 #ifdef __cplusplus
@@ -11,149 +11,104 @@ extern "C"{
 
 ڶҲöֲ򣬱Ƚϵһȵһ󣬰һɾöַ
 ҳҪλãǰλ롣
+
+ͬĴ̫ʱһHashŲڴ棬topk.hCount-Min SketchHash
+(ֻ1/epsilonSpace-Saving)߶άСѣڴֻKйأ
+ÿʶepsilon*Nļ߳пͳƣϲ
 */
 
 #include <stdio.h>
 #include <string.h>
-#include <malloc.h>
-#include <assert.h>
 #include <stdlib.h>
-#define HASHLEN 101
-#define WORDLEN 30
+#include <time.h>
+#include <unistd.h>
+#include "topk.h"
+
 #define MAX  100000
 #define DOMAIN 300
 #define K 5
-//Hash
-typedef struct node
-{
-    char *word;
-    int count;
-    struct node *next;
-}node,*node_ptr;
-static node_ptr head[HASHLEN];
-static node array[K];
-//Hash
-int hash_function(char *p)
-{
-    unsigned int value = 0;
-    while (*p != '/0')
-    {
-        value = value * 31 + *p++;
-        if (value > HASHLEN)
-            value = value % HASHLEN;
-    }
-    return value;
-}
-//HASH
-void append_word(char *str)
-{
-    int index = hash_function(str);
-    node_ptr p = head[index];
-    while (p != NULL)
-    {
-        if (strcmp(str, p->word) == 0)
-        {
-            (p->count)++;
-            return;
-        }
-        p = p->next;
-    }
-    // 
-    node_ptr q = (node_ptr)malloc(sizeof(node));
-    q->count = 1;
-    q->word = (char *)malloc(sizeof(str) + 1);
-    strcpy(q->word, str);
-//    q->word = str;
-    q->next = head[index];
-    head[index] = q;
-}
-//0~DOMAIN - 1MAX
-void gen_data()
+
+/* ûļʱ0~DOMAIN-1MAX */
+static int gen_data(const char *path)
 {
-    FILE *fp = fopen("c://data1.txt", "w");
-    assert(fp);
+    FILE *fp = fopen(path, "w");
     int i = 0;
+
+    if (fp == NULL)
+        return -1;
     srand((int)(time(0)));
     for (i = 0; i < MAX; i++)
-    	fprintf(fp,"%d  ",rand()%DOMAIN);
+        fprintf(fp, "%d  ", rand() % DOMAIN);
     fclose(fp);
+    return 0;
 }
-//:
-void heapAdjust(node array[], int beginIndex, int endIndex, int index)
+
+static void usage(const char *name)
 {
-	int length = endIndex - beginIndex + 1;
-	int largestIndex = index;
-	int leftIndex = 2 * index + 1;     //0?
-	int rightIndex = 2 * index + 2;
-	if (leftIndex <= length - 1 && array[leftIndex].count <= array[largestIndex].count )
-		{
-			largestIndex = leftIndex;
-		}
-	if (rightIndex <= length - 1 && array[rightIndex].count <= array[largestIndex].count )
-		{
-			largestIndex = rightIndex;
-		}
-	if (largestIndex != index)
-		{
-			node temp = array[largestIndex];
-			array[largestIndex] = array[index];
-			array[index] = temp;
-			heapAdjust (array, beginIndex, endIndex, largestIndex);
-		}
+    printf("usage: %s [-k K] [-e epsilon] [-d delta] [-s] [-t threads] [file]\n"
+           "  -k  how many, default %d\n"
+           "  -e  error as a fraction of all words, default 0.0001\n"
+           "  -d  probability to exceed it (sketch only), default 0.001\n"
+           "  -s  space-saving counters instead of count-min sketch\n"
+           "  -t  threads, default 1\n"
+           "  without a file %d random numbers are written to data1.txt\n",
+           name, K, MAX);
 }
-//
-void heapBuild (node array[], int len )
-	{
-		int i = 0;
-		for (i = len/2 - 1; i >= 0; i --)
-		{
-			heapAdjust (array, 0, len - 1, i);
-		}
-	}
 
-int main()
+int main(int argc, char *argv[])
 {
-	gen_data();
-	char str[WORDLEN];
-//	char *str;
-	int i;
-	int cnt1 = 0;
-	for (i = 0; i < HASHLEN; i++)
-	   head[i] = NULL;
-	FILE *fp_passage = fopen("c://data1.txt", "r");
-	assert(fp_passage);
-	while (fscanf(fp_passage, "%s", str) != EOF)
-	{
-	    cnt1++;
-	    append_word(str);
-	   }
-	printf("the cnt1 is %d/n", cnt1);
-	     fclose(fp_passage);
-	     //Top K
-	for(i = 0; i < HASHLEN; i++)
-	{
-		if(i < K - 1)
-				array[i] = *head[i];
-		else
-			if(i == K - 1)
-				{
-				array[i] = *head[i];
-				heapBuild(array,K);
-				}
-			else
-			{
-				if(array[0].count < head[i]->count)
-				{
-					array[0] = *head[i];
-					heapAdjust(array,0,K - 1,0);
-				}
-			}
-	}
-	printf("the top K is as follows/n");
-	for(i = 0; i < K; i++)
-		 printf("%s , and its count is %d/n",array[i].word, array[i].count);
-//	printf("the total number of word is %d",cnt);
-	return 0;
+    const char *path = "data1.txt";
+    double epsilon = 0.0001, delta = 0.001;
+    int32_t mode = TOPK_SKETCH, threads = 1, opt;
+    uint32_t k = K, i, n;
+    TopKItem *items;
+    TopK *topk;
+
+    while ((opt = getopt(argc, argv, "k:e:d:st:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'k': k = (uint32_t)atoi(optarg); break;
+        case 'e': epsilon = atof(optarg); break;
+        case 'd': delta = atof(optarg); break;
+        case 's': mode = TOPK_SPACE_SAVING; break;
+        case 't': threads = atoi(optarg); break;
+        default: usage(argv[0]); return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (optind < argc)
+        path = argv[optind];
+    else if (gen_data(path) == -1)
+    {
+        printf("can't write %s\n", path);
+        return 1;
+    }
+
+    topk = topk_count_file(path, threads, k, epsilon, delta, mode);
+    if (topk == NULL)
+    {
+        printf("can't count %s (bad parameters or no such file)\n", path);
+        return 1;
+    }
+    items = (TopKItem *)malloc(k * sizeof(TopKItem));
+    if (items == NULL)
+    {
+        topk_destroy(topk);
+        return 1;
+    }
+    n = topk_result(topk, items);
+    printf("the cnt is %llu, %llu bytes used\n",
+           (unsigned long long)topk->total,
+           (unsigned long long)topk_peak_memory(topk));
+    printf("the top %u is as follows\n", n);
+    for (i = 0; i < n; i++)
+        printf("%.*s , and its count is %llu (at most %llu too many)\n",
+               (int)items[i].len, items[i].key,
+               (unsigned long long)items[i].count,
+               (unsigned long long)items[i].error);
+    free(items);
+    topk_destroy(topk);
+    return 0;
 }
 
 
@@ -0,0 +1,657 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "hashfn.h"
+#include "topk.h"
+
+#define TOPK_SEED           0x9e3779b97f4a7c15ULL
+#define MAX_DEPTH           16
+#define MAX_THREADS         64
+#define MIN_KEY_CAP         16
+/* TOPK_SKETCHĶkļѡ߳ʱÿֻ߳Լĺѡ
+ * ȫֵǰkĳܸ߳պk⣬ֻkϲʱᶪ */
+#define SKETCH_CANDIDATES   4
+
+/* հַfscanf%sһ */
+static const uint8_t is_space[256] = {
+    [' '] = 1, ['\t'] = 1, ['\n'] = 1, ['\r'] = 1, ['\f'] = 1, ['\v'] = 1,
+};
+
+/* xӳ䵽[0, n)ó˷ȡģ */
+static inline uint64_t reduce(uint64_t x, uint64_t n)
+{
+    return (uint64_t)(((unsigned __int128)x * n) >> 64);
+}
+
+static inline uint64_t mix64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+
+/************************************************************
+ * Count-Min Sketchÿеλh1+i*h2
+ ************************************************************/
+
+/* ظ£ֻС¹ֵļ̧ȥֱֵȫСö */
+static uint64_t sketch_add(TopK *topk, uint64_t h, uint64_t count)
+{
+    uint64_t pos[MAX_DEPTH], h2 = mix64(h) | 1, est = UINT64_MAX;
+    uint32_t i, *c;
+
+    for (i = 0; i < topk->depth; i++)
+    {
+        pos[i] = i * topk->width + reduce(h, topk->width);
+        c = topk->sketch + pos[i];
+        est = *c < est ? *c : est;
+        h += h2;
+    }
+    est += count;
+    est = est > UINT32_MAX ? UINT32_MAX : est;
+    for (i = 0; i < topk->depth; i++)
+    {
+        c = topk->sketch + pos[i];
+        if (*c < est)
+            *c = (uint32_t)est;
+    }
+    return est;
+}
+
+static uint64_t sketch_estimate(const TopK *topk, uint64_t h)
+{
+    uint64_t h2 = mix64(h) | 1, est = UINT64_MAX, c;
+    uint32_t i;
+
+    for (i = 0; i < topk->depth; i++)
+    {
+        c = topk->sketch[i * topk->width + reduce(h, topk->width)];
+        est = c < est ? c : est;
+        h += h2;
+    }
+    return est;
+}
+
+
+/************************************************************
+ * key -> ±̽⣬ɾʱǰŲĹ
+ ************************************************************/
+
+static inline int32_t key_equal(const TopKItem *item, const char *key,
+                                uint32_t len)
+{
+    return item->len == len && memcmp(item->key, key, len) == 0;
+}
+
+/* ҵض±꣬Ҳ-1*slotΪҵλûԲĿλ */
+static int32_t index_find(const TopK *topk, uint64_t h, const char *key,
+                          uint32_t len, uint32_t *slot)
+{
+    uint32_t i = (uint32_t)h & topk->index_mask;
+    int32_t pos;
+
+    while ((pos = topk->index[i]) != -1)
+    {
+        if (topk->index_hash[i] == h && key_equal(&topk->heap[pos], key, len))
+        {
+            *slot = i;
+            return pos;
+        }
+        i = (i + 1) & topk->index_mask;
+    }
+    *slot = i;
+    return -1;
+}
+
+static void index_remove(TopK *topk, uint32_t slot)
+{
+    uint32_t mask = topk->index_mask, i = slot, j = slot, home;
+
+    for (;;)
+    {
+        j = (j + 1) & mask;
+        if (topk->index[j] == -1)
+            break;
+        home = (uint32_t)topk->index_hash[j] & mask;
+        /* jԭλ(i, j]Ųi */
+        if (i <= j ? (home <= i || home > j) : (home <= i && home > j))
+        {
+            topk->index[i] = topk->index[j];
+            topk->index_hash[i] = topk->index_hash[j];
+            topk->heap[topk->index[i]].slot = i;
+            i = j;
+        }
+    }
+    topk->index[i] = -1;
+}
+
+
+/************************************************************
+ * countС
+ ************************************************************/
+
+static inline void heap_place(TopK *topk, uint32_t pos, const TopKItem *item)
+{
+    topk->heap[pos] = *item;
+    topk->index[item->slot] = pos;
+}
+
+static void sift_down(TopK *topk, uint32_t pos)
+{
+    TopKItem item = topk->heap[pos];
+    uint32_t child;
+
+    while ((child = pos * 2 + 1) < topk->size)
+    {
+        if (child + 1 < topk->size &&
+            topk->heap[child + 1].count < topk->heap[child].count)
+            child++;
+        if (topk->heap[child].count >= item.count)
+            break;
+        heap_place(topk, pos, &topk->heap[child]);
+        pos = child;
+    }
+    heap_place(topk, pos, &item);
+}
+
+static void sift_up(TopK *topk, uint32_t pos)
+{
+    TopKItem item = topk->heap[pos];
+    uint32_t parent;
+
+    while (pos > 0)
+    {
+        parent = (pos - 1) / 2;
+        if (topk->heap[parent].count <= item.count)
+            break;
+        heap_place(topk, pos, &topk->heap[parent]);
+        pos = parent;
+    }
+    heap_place(topk, pos, &item);
+}
+
+/* µkeyþͲ· */
+static int32_t item_set_key(TopKItem *item, const char *key, uint32_t len)
+{
+    uint32_t cap;
+    char *buf;
+
+    if (item->cap < len)
+    {
+        cap = len < MIN_KEY_CAP ? MIN_KEY_CAP : len;
+        buf = (char *)realloc(item->key, cap);
+        if (buf == NULL)
+            return -1;
+        item->key = buf;
+        item->cap = cap;
+    }
+    memcpy(item->key, key, len);
+    item->len = len;
+    return 0;
+}
+
+/* slotindex_findĿλ */
+static void heap_insert(TopK *topk, uint64_t h, uint32_t slot, const char *key,
+                        uint32_t len, uint64_t count, uint64_t error)
+{
+    TopKItem *item = &topk->heap[topk->size];
+
+    if (item_set_key(item, key, len) == -1)
+        return;
+    item->count = count;
+    item->error = error;
+    item->hash = h;
+    item->slot = slot;
+    topk->index_hash[slot] = h;
+    topk->index[slot] = topk->size;
+    sift_up(topk, topk->size++);
+}
+
+/* ѶСǸ */
+static void heap_replace_min(TopK *topk, uint64_t h, const char *key,
+                             uint32_t len, uint64_t count, uint64_t error)
+{
+    TopKItem *root = &topk->heap[0];
+    uint32_t slot;
+
+    /* ڴ治ͲˣindexõslothashkeyӰɾ */
+    if (item_set_key(root, key, len) == -1)
+        return;
+    index_remove(topk, root->slot);
+    index_find(topk, h, key, len, &slot);
+    root->count = count;
+    root->error = error;
+    root->hash = h;
+    root->slot = slot;
+    topk->index_hash[slot] = h;
+    topk->index[slot] = 0;
+    sift_down(topk, 0);
+}
+
+
+/************************************************************
+ * ӿ
+ ************************************************************/
+
+TopK* topk_create(uint32_t k, double epsilon, double delta, int32_t mode)
+{
+    TopK *topk;
+    uint64_t capacity;
+    uint32_t slots;
+
+    if (k == 0 || !(epsilon > 0 && epsilon < 1) ||
+        (mode == TOPK_SKETCH && !(delta > 0 && delta < 1)) ||
+        (mode != TOPK_SKETCH && mode != TOPK_SPACE_SAVING))
+        return NULL;
+    capacity = k;
+    if (mode == TOPK_SKETCH)
+        capacity = (uint64_t)k * SKETCH_CANDIDATES;
+    if (mode == TOPK_SPACE_SAVING && ceil(1 / epsilon) > k)
+        capacity = (uint64_t)ceil(1 / epsilon);
+    if (capacity > (1U << 30))
+        return NULL;
+
+    topk = (TopK *)calloc(1, sizeof(TopK));
+    if (topk == NULL)
+        return NULL;
+    topk->mode = mode;
+    topk->k = k;
+    topk->epsilon = epsilon;
+    topk->delta = delta;
+    topk->seed = TOPK_SEED;
+    topk->capacity = (uint32_t)capacity;
+
+    if (mode == TOPK_SKETCH)
+    {
+        topk->width = (uint64_t)ceil(M_E / epsilon);
+        topk->depth = (uint32_t)ceil(log(1 / delta));
+        topk->depth = topk->depth < 1 ? 1 :
+                      topk->depth > MAX_DEPTH ? MAX_DEPTH : topk->depth;
+        topk->sketch = (uint32_t *)calloc(topk->width * topk->depth,
+                                          sizeof(uint32_t));
+        if (topk->sketch == NULL)
+            goto fail;
+    }
+
+    for (slots = 16; slots < capacity * 2; slots *= 2)
+        ;
+    topk->index_mask = slots - 1;
+    topk->heap = (TopKItem *)calloc(capacity, sizeof(TopKItem));
+    topk->index = (int32_t *)malloc(slots * sizeof(int32_t));
+    topk->index_hash = (uint64_t *)malloc(slots * sizeof(uint64_t));
+    if (topk->heap == NULL || topk->index == NULL || topk->index_hash == NULL)
+        goto fail;
+    memset(topk->index, 0xff, slots * sizeof(int32_t));
+    return topk;
+fail:
+    topk_destroy(topk);
+    return NULL;
+}
+
+void topk_destroy(TopK *topk)
+{
+    uint32_t i;
+
+    if (topk == NULL)
+        return;
+    if (topk->heap != NULL)
+    {
+        for (i = 0; i < topk->capacity; i++)
+            free(topk->heap[i].key);
+    }
+    free(topk->heap);
+    free(topk->index);
+    free(topk->index_hash);
+    free(topk->sketch);
+    free(topk);
+}
+
+void topk_add(TopK *topk, const char *key, uint32_t len, uint64_t count)
+{
+    uint64_t h = WyHash64(key, len, topk->seed), est;
+    uint32_t slot;
+    int32_t pos;
+
+    topk->total += count;
+    if (topk->mode == TOPK_SKETCH)
+    {
+        est = sketch_add(topk, h, count);
+        /* ĴʹֵֻǣȶѶСһڶòindex */
+        if (topk->size == topk->capacity && est <= topk->heap[0].count)
+            return;
+        pos = index_find(topk, h, key, len, &slot);
+        if (pos >= 0)
+        {
+            topk->heap[pos].count = est;
+            sift_down(topk, pos);
+        }
+        else if (topk->size < topk->capacity)
+            heap_insert(topk, h, slot, key, len, est, 0);
+        else if (est > topk->heap[0].count)
+            heap_replace_min(topk, h, key, len, est, 0);
+        return;
+    }
+
+    pos = index_find(topk, h, key, len, &slot);
+    if (pos >= 0)
+    {
+        topk->heap[pos].count += count;
+        sift_down(topk, pos);
+    }
+    else if (topk->size < topk->capacity)
+        heap_insert(topk, h, slot, key, len, count, 0);
+    else
+        /* ´ʿ֮ǰֱֹˣСǸ */
+        heap_replace_min(topk, h, key, len, topk->heap[0].count + count,
+                         topk->heap[0].count);
+}
+
+void topk_add_text(TopK *topk, const char *text, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)text, *end = p + len, *word;
+
+    for (;;)
+    {
+        while (p < end && is_space[*p])
+            p++;
+        if (p == end)
+            break;
+        word = p;
+        while (p < end && !is_space[*p])
+            p++;
+        topk_add(topk, (const char *)word, (uint32_t)(p - word), 1);
+    }
+}
+
+uint64_t topk_estimate(const TopK *topk, const char *key, uint32_t len)
+{
+    uint64_t h = WyHash64(key, len, topk->seed);
+    uint32_t slot;
+    int32_t pos;
+
+    if (topk->mode == TOPK_SKETCH)
+        return sketch_estimate(topk, h);
+    pos = index_find(topk, h, key, len, &slot);
+    if (pos >= 0)
+        return topk->heap[pos].count;
+    return topk->size < topk->capacity ? 0 : topk->heap[0].count;
+}
+
+static int32_t by_count_desc(const void *a, const void *b)
+{
+    const TopKItem *x = (const TopKItem *)a, *y = (const TopKItem *)b;
+
+    return x->count < y->count ? 1 : x->count > y->count ? -1 : 0;
+}
+
+/* úѡؽѣcountcapacitykeyһ */
+static int32_t rebuild(TopK *topk, TopKItem *cands, uint32_t n)
+{
+    uint32_t i, slot;
+
+    qsort(cands, n, sizeof(TopKItem), by_count_desc);
+    n = n < topk->capacity ? n : topk->capacity;
+    topk->size = 0;
+    memset(topk->index, 0xff, (topk->index_mask + 1) * sizeof(int32_t));
+    for (i = 0; i < n; i++)
+    {
+        index_find(topk, cands[i].hash, cands[i].key, cands[i].len, &slot);
+        heap_insert(topk, cands[i].hash, slot, cands[i].key, cands[i].len,
+                    cands[i].count, cands[i].error);
+    }
+    return 0;
+}
+
+int32_t topk_merge(TopK *dst, const TopK *src)
+{
+    uint64_t dst_min, src_min, i;
+    TopKItem *cands;
+    uint32_t n = 0, slot, j;
+    int32_t pos, ret;
+
+    if (dst->mode != src->mode || dst->k != src->k ||
+        dst->capacity != src->capacity || dst->seed != src->seed ||
+        dst->width != src->width || dst->depth != src->depth)
+        return -1;
+
+    cands = (TopKItem *)malloc((dst->size + src->size) * sizeof(TopKItem) + 1);
+    if (cands == NULL)
+        return -1;
+
+    if (dst->mode == TOPK_SKETCH)
+    {
+        /* ֱӣѡߵĶѣúsketch¹ */
+        for (i = 0; i < dst->width * dst->depth; i++)
+        {
+            uint64_t c = (uint64_t)dst->sketch[i] + src->sketch[i];
+            dst->sketch[i] = c > UINT32_MAX ? UINT32_MAX : (uint32_t)c;
+        }
+        for (j = 0; j < dst->size; j++)
+        {
+            cands[n] = dst->heap[j];
+            cands[n++].count = sketch_estimate(dst, dst->heap[j].hash);
+        }
+        for (j = 0; j < src->size; j++)
+        {
+            if (index_find(dst, src->heap[j].hash, src->heap[j].key,
+                           src->heap[j].len, &slot) >= 0)
+                continue;
+            cands[n] = src->heap[j];
+            cands[n++].count = sketch_estimate(dst, src->heap[j].hash);
+        }
+    }
+    else
+    {
+        /* һûеĴʣǱǱСô */
+        dst_min = dst->size < dst->capacity ? 0 : dst->heap[0].count;
+        src_min = src->size < src->capacity ? 0 : src->heap[0].count;
+        for (j = 0; j < dst->size; j++)
+        {
+            cands[n] = dst->heap[j];
+            pos = index_find(src, dst->heap[j].hash, dst->heap[j].key,
+                             dst->heap[j].len, &slot);
+            cands[n].count += pos >= 0 ? src->heap[pos].count : src_min;
+            cands[n++].error += pos >= 0 ? src->heap[pos].error : src_min;
+        }
+        for (j = 0; j < src->size; j++)
+        {
+            if (index_find(dst, src->heap[j].hash, src->heap[j].key,
+                           src->heap[j].len, &slot) >= 0)
+                continue;
+            cands[n] = src->heap[j];
+            cands[n].count += dst_min;
+            cands[n++].error += dst_min;
+        }
+    }
+
+    /* ѡdstԼkeyᱻrebuildǣȸƳ */
+    for (j = 0; j < n; j++)
+    {
+        char *copy = (char *)malloc(cands[j].len ? cands[j].len : 1);
+
+        if (copy == NULL)
+        {
+            while (j-- > 0)
+                free(cands[j].key);
+            free(cands);
+            return -1;
+        }
+        memcpy(copy, cands[j].key, cands[j].len);
+        cands[j].key = copy;
+    }
+    dst->total += src->total;
+    ret = rebuild(dst, cands, n);
+    for (j = 0; j < n; j++)
+        free(cands[j].key);
+    free(cands);
+    return ret;
+}
+
+uint64_t topk_error_bound(const TopK *topk)
+{
+    return (uint64_t)ceil(topk->epsilon * topk->total);
+}
+
+uint32_t topk_result(const TopK *topk, TopKItem *items)
+{
+    TopKItem *all;
+    uint32_t i, n = topk->size < topk->k ? topk->size : topk->k;
+
+    all = (TopKItem *)malloc(topk->size * sizeof(TopKItem) + 1);
+    if (all == NULL)
+        return 0;
+    memcpy(all, topk->heap, topk->size * sizeof(TopKItem));
+    qsort(all, topk->size, sizeof(TopKItem), by_count_desc);
+    for (i = 0; i < n; i++)
+    {
+        items[i] = all[i];
+        if (topk->mode == TOPK_SKETCH)
+            items[i].error = topk_error_bound(topk);
+    }
+    free(all);
+    return n;
+}
+
+uint64_t topk_memory(const TopK *topk)
+{
+    uint64_t bytes = sizeof(TopK), i;
+
+    bytes += topk->width * topk->depth * sizeof(uint32_t);
+    bytes += topk->capacity * sizeof(TopKItem);
+    bytes += (topk->index_mask + 1) * (sizeof(int32_t) + sizeof(uint64_t));
+    for (i = 0; i < topk->size; i++)
+        bytes += topk->heap[i].cap;
+    return bytes;
+}
+
+uint64_t topk_peak_memory(const TopK *topk)
+{
+    uint64_t bytes = topk_memory(topk);
+
+    return topk->peak_memory > bytes ? topk->peak_memory : bytes;
+}
+
+
+/************************************************************
+ * ߳ͳļ
+ ************************************************************/
+
+typedef struct Worker{
+    TopK *topk;
+    const char *begin;
+    const char *end;
+    pthread_t tid;
+} Worker;
+
+static void* count_chunk(void *arg)
+{
+    Worker *w = (Worker *)arg;
+
+    topk_add_text(w->topk, w->begin, w->end - w->begin);
+    return NULL;
+}
+
+TopK* topk_count_file(const char *path, int32_t threads, uint32_t k,
+                      double epsilon, double delta, int32_t mode)
+{
+    Worker workers[MAX_THREADS];
+    const char *base = NULL, *cut;
+    TopK *topk = NULL;
+    struct stat st;
+    uint64_t peak = 0;
+    int32_t fd, i, started = 0, ok = 1;
+
+    threads = threads < 1 ? 1 : threads > MAX_THREADS ? MAX_THREADS : threads;
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    if (fstat(fd, &st) < 0)
+    {
+        close(fd);
+        return NULL;
+    }
+    if (st.st_size > 0)
+    {
+        base = (const char *)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED)
+        {
+            close(fd);
+            return NULL;
+        }
+        madvise((void *)base, st.st_size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    /* ֽƽпеŲհ״һʲᱻ̸߳һ */
+    memset(workers, 0, sizeof(workers));
+    for (i = 0; i < threads; i++)
+    {
+        workers[i].topk = topk_create(k, epsilon, delta, mode);
+        if (workers[i].topk == NULL)
+            ok = 0;
+        cut = base + (uint64_t)st.st_size * i / threads;
+        while (i > 0 && cut < base + st.st_size && !is_space[(uint8_t)*cut])
+            cut++;
+        workers[i].begin = cut;
+        if (i > 0)
+            workers[i - 1].end = cut;
+    }
+    workers[threads - 1].end = base + st.st_size;
+
+    if (ok)
+    {
+        for (i = 1; i < threads; i++, started++)
+        {
+            if (pthread_create(&workers[i].tid, NULL, count_chunk, &workers[i]))
+                break;
+        }
+        /* ̵߳ĲԼ */
+        for (i = started + 1; i < threads; i++)
+            count_chunk(&workers[i]);
+        count_chunk(&workers[0]);
+        for (i = 1; i <= started; i++)
+            pthread_join(workers[i].tid, NULL);
+
+        /* ϲǰ̵߳TopK(һsketch) */
+        for (i = 0; i < threads; i++)
+            peak += topk_memory(workers[i].topk);
+        topk = workers[0].topk;
+        workers[0].topk = NULL;
+        for (i = 1; i < threads; i++)
+        {
+            if (topk_merge(topk, workers[i].topk) == -1)
+            {
+                topk_destroy(topk);
+                topk = NULL;
+                break;
+            }
+        }
+        if (topk != NULL)
+            topk->peak_memory = peak;
+    }
+    for (i = 0; i < threads; i++)
+        topk_destroy(workers[i].topk);
+    if (base != NULL)
+        munmap((void *)base, st.st_size);
+    return topk;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,113 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ *ʽtop K
+ *ֻһ飬ڴͲͬʵĸ޹أֻKйء
+ *TOPK_SKETCH        Count-Min SketchÿʵĴ(ֻ)һС
+ *                   ¹ֵļKѡȡǰKe/epsilonln(1/delta)
+ *                   1-deltaĸÿʶepsilon*N(NΪܴ)
+ *TOPK_SPACE_SAVING  1/epsilon´ûλþͶСǸ
+ *                   ̳Ĵepsilon*Nûиʣdelta޹
+ *߳ʱÿ߳һTopKtopk_merge
+ */
+
+#ifndef _TOPK_H_
+#define _TOPK_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define TOPK_SKETCH         0
+#define TOPK_SPACE_SAVING   1
+
+typedef struct TopKItem{
+    char *key;              /* 0β */
+    uint32_t len;
+    uint32_t cap;           /* keyĻСʱ */
+    uint64_t count;         /* ƵĴʵ */
+    uint64_t error;         /* ô࣬ʵ>=count-error */
+    uint64_t hash;          /* ڲ */
+    uint32_t slot;          /* ڲãindexλ */
+} TopKItem;
+
+typedef struct TopK{
+    int32_t mode;
+    uint32_t k;
+    double epsilon;
+    double delta;
+    uint64_t total;         /* ܴ */
+    uint64_t seed;
+    uint64_t peak_memory;   /* topk_count_fileϲǰ̵߳TopKڴ */
+
+    /* TOPK_SKETCH */
+    uint32_t *sketch;       /* depthУÿwidth */
+    uint64_t width;
+    uint32_t depth;
+
+    /* countСѣTOPK_SKETCHʱǺѡTOPK_SPACE_SAVINGʱȫ */
+    TopKItem *heap;
+    uint32_t size;
+    uint32_t capacity;
+
+    /* key -> ±꣬̽⣬-1Ϊ */
+    int32_t *index;
+    uint64_t *index_hash;
+    uint32_t index_mask;
+} TopK;
+
+/*
+ *ܣ
+ *
+ *kҪ
+ *epsilonռܴı0.0001
+ *deltaTOPK_SKETCHʱƳĸʣ0.001
+ *modeTOPK_SKETCHTOPK_SPACE_SAVING
+ *ֵNULLʾԻڴ治
+ */
+TopK* topk_create(uint32_t k, double epsilon, double delta, int32_t mode);
+
+void topk_destroy(TopK *topk);
+
+/*һʳcount*/
+void topk_add(TopK *topk, const char *key, uint32_t len, uint64_t count);
+
+/*һıհгɴӽȥ*/
+void topk_add_text(TopK *topk, const char *text, size_t len);
+
+/*ƴTOPK_SPACE_SAVINGʱڼķС*/
+uint64_t topk_estimate(const TopK *topk, const char *key, uint32_t len);
+
+/*
+ *ܣsrcdstĲҪͬ(topk_createʱһ)src
+ *ֵ0ɹ-1ͬڴ治
+ */
+int32_t topk_merge(TopK *dst, const TopK *src);
+
+/*
+ *ܣȡcountӴСk
+ *ֵitemsɵṩk
+ */
+uint32_t topk_result(const TopK *topk, TopKItem *items);
+
+/*ޣepsilon*total*/
+uint64_t topk_error_bound(const TopK *topk);
+
+uint64_t topk_memory(const TopK *topk);
+
+/*ʱ˶ڴ棬topk_count_file̵߳TopK֮*/
+uint64_t topk_peak_memory(const TopK *topk);
+
+/*
+ *ܣ߳ͳһļļ߳пÿ߳һTopKϲ
+ *ֵNULLʾ򲻿ļڴ治
+ */
+TopK* topk_count_file(const char *path, int32_t threads, uint32_t k,
+                      double epsilon, double delta, int32_t mode);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
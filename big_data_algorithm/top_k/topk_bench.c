@@ -0,0 +1,370 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/* ʽtop Kԣ
+ * ɰZipfֲĴļ(Ĭ2GB)þȷHashͳƳtop K
+ * ٷֱCount-Min SketchSpace-Saving(̡̺߳߳ϲ)ͳƣ
+ * Ƚʱ䡢ڴ桢top Kٻʺʵ(Ӧ) */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "hashfn.h"
+#include "topk.h"
+
+static uint64_t file_mb = 2048;
+static uint32_t vocab = 4000000;
+static double zipf_s = 1.0;
+static uint32_t k = 100;
+static double epsilon = 0.00001;
+static double delta = 0.001;
+static int32_t threads = 4;
+static const char *path = "topk_words.txt";
+
+static double now_sec(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static inline uint64_t xorshift(uint64_t *s){
+    uint64_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *s = x;
+}
+
+/* rankʣһ£øƵʶܶ */
+static int32_t word_of(uint32_t rank, char *buf){
+    static const char digits[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+    uint64_t x = (rank + 1) * 0x9e3779b97f4a7c15ULL;
+    int32_t len = 0, n = 3 + rank % 6;
+
+    buf[len++] = 'w';
+    while (len < n + 1)
+    {
+        buf[len++] = digits[x % 36];
+        x /= 36;
+    }
+    len += sprintf(buf + len, "%u", rank);
+    return len;
+}
+
+/* ļѾôֱ */
+static int32_t gen_words(void){
+    struct stat st;
+    uint64_t seed = 88172645463325252ULL, bytes = 0, limit = file_mb << 20;
+    double *cdf, sum = 0, t;
+    uint32_t i, lo, hi, mid;
+    int32_t len;
+    char buf[64];
+    FILE *fp;
+
+    if (stat(path, &st) == 0 && (uint64_t)st.st_size >= limit &&
+        (uint64_t)st.st_size < limit + 64)
+        return 0;
+    cdf = (double *)malloc(vocab * sizeof(double));
+    if (cdf == NULL)
+        return -1;
+    for (i = 0; i < vocab; i++)
+        cdf[i] = sum += 1 / pow(i + 1, zipf_s);
+    fp = fopen(path, "w");
+    if (fp == NULL)
+    {
+        free(cdf);
+        return -1;
+    }
+    setvbuf(fp, NULL, _IOFBF, 1 << 20);
+    t = now_sec();
+    while (bytes < limit)
+    {
+        double u = (xorshift(&seed) >> 11) * (1.0 / (1ULL << 53)) * sum;
+
+        for (lo = 0, hi = vocab - 1; lo < hi; )
+        {
+            mid = (lo + hi) / 2;
+            if (cdf[mid] < u)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        len = word_of(lo, buf);
+        buf[len++] = xorshift(&seed) % 16 ? ' ' : '\n';
+        bytes += fwrite(buf, 1, len, fp);
+    }
+    fclose(fp);
+    free(cdf);
+    printf("wrote %s: %lu MB, %u words zipf %.2f, %.1f s\n", path,
+           (unsigned long)(bytes >> 20), vocab, zipf_s, now_sec() - t);
+    return 0;
+}
+
+
+/************************************************************
+ * ȷͳƣŵַHashkeyһڴ
+ ************************************************************/
+
+typedef struct Entry{
+    uint64_t hash;
+    uint64_t count;
+    uint64_t off;       /* 0Ϊգkeyarena+off-1 */
+    uint32_t len;
+} Entry;
+
+typedef struct Exact{
+    Entry *table;
+    uint64_t mask;
+    uint64_t used;
+    char *arena;
+    uint64_t arena_used;
+    uint64_t arena_cap;
+    uint64_t total;
+} Exact;
+
+static Entry* exact_find(Exact *ex, uint64_t h, const char *key, uint32_t len){
+    uint64_t i = h & ex->mask;
+    Entry *e;
+
+    for (;; i = (i + 1) & ex->mask)
+    {
+        e = &ex->table[i];
+        if (e->off == 0 || (e->hash == h && e->len == len &&
+                            memcmp(ex->arena + e->off - 1, key, len) == 0))
+            return e;
+    }
+}
+
+static int32_t exact_grow(Exact *ex){
+    uint64_t i, size = (ex->mask + 1) * 2, j;
+    Entry *old = ex->table, *table;
+
+    table = (Entry *)calloc(size, sizeof(Entry));
+    if (table == NULL)
+        return -1;
+    for (i = 0; i <= ex->mask; i++)
+    {
+        if (old[i].off == 0)
+            continue;
+        for (j = old[i].hash & (size - 1); table[j].off; j = (j + 1) & (size - 1))
+            ;
+        table[j] = old[i];
+    }
+    free(old);
+    ex->table = table;
+    ex->mask = size - 1;
+    return 0;
+}
+
+static int32_t exact_add(Exact *ex, const char *key, uint32_t len){
+    uint64_t h = WyHash64(key, len, 0);
+    Entry *e = exact_find(ex, h, key, len);
+    char *arena;
+
+    ex->total++;
+    if (e->off)
+    {
+        e->count++;
+        return 0;
+    }
+    if (ex->arena_used + len > ex->arena_cap)
+    {
+        arena = (char *)realloc(ex->arena, ex->arena_cap * 2 + len);
+        if (arena == NULL)
+            return -1;
+        ex->arena = arena;
+        ex->arena_cap = ex->arena_cap * 2 + len;
+    }
+    memcpy(ex->arena + ex->arena_used, key, len);
+    e->hash = h;
+    e->count = 1;
+    e->len = len;
+    e->off = ex->arena_used + 1;
+    ex->arena_used += len;
+    if (++ex->used * 2 > ex->mask + 1)
+        return exact_grow(ex);
+    return 0;
+}
+
+static uint64_t exact_count(Exact *ex, const char *key, uint32_t len){
+    return exact_find(ex, WyHash64(key, len, 0), key, len)->count;
+}
+
+static int32_t by_count_desc(const void *a, const void *b){
+    const Entry *x = (const Entry *)a, *y = (const Entry *)b;
+    return x->count < y->count ? 1 : x->count > y->count ? -1 : 0;
+}
+
+static int32_t exact_run(Exact *ex, const char *text, uint64_t size){
+    const char *p = text, *end = text + size, *word;
+
+    memset(ex, 0, sizeof(Exact));
+    ex->mask = (1 << 16) - 1;
+    ex->table = (Entry *)calloc(ex->mask + 1, sizeof(Entry));
+    ex->arena_cap = 1 << 20;
+    ex->arena = (char *)malloc(ex->arena_cap);
+    if (ex->table == NULL || ex->arena == NULL)
+        return -1;
+    for (;;)
+    {
+        while (p < end && (*p == ' ' || *p == '\n'))
+            p++;
+        if (p == end)
+            break;
+        word = p;
+        while (p < end && *p != ' ' && *p != '\n')
+            p++;
+        if (exact_add(ex, word, (uint32_t)(p - word)) == -1)
+            return -1;
+    }
+    return 0;
+}
+
+/* ǰkޣһĶ */
+static uint64_t exact_kth(const Exact *ex){
+    Entry *all = (Entry *)malloc(ex->used * sizeof(Entry) + 1);
+    uint64_t i, n = 0, kth;
+
+    if (all == NULL)
+        return UINT64_MAX;
+    for (i = 0; i <= ex->mask; i++)
+    {
+        if (ex->table[i].off)
+            all[n++] = ex->table[i];
+    }
+    qsort(all, n, sizeof(Entry), by_count_desc);
+    kth = n >= k ? all[k - 1].count : 0;
+    printf("exact    top1 %lu, top%u %lu\n", (unsigned long)all[0].count, k,
+           (unsigned long)kth);
+    free(all);
+    return kth;
+}
+
+
+static void run(Exact *ex, uint64_t kth, int32_t mode, int32_t nthreads,
+                double exact_time){
+    TopKItem *items = (TopKItem *)malloc(k * sizeof(TopKItem));
+    uint64_t truth, diff, max_diff = 0, bound;
+    uint32_t i, n, hits = 0, outside = 0;
+    TopK *topk;
+    double t;
+
+    if (items == NULL)
+        return;
+    t = now_sec();
+    topk = topk_count_file(path, nthreads, k, epsilon, delta, mode);
+    t = now_sec() - t;
+    if (topk == NULL)
+    {
+        printf("topk_count_file failed\n");
+        free(items);
+        return;
+    }
+    n = topk_result(topk, items);
+    bound = topk_error_bound(topk);
+    for (i = 0; i < n; i++)
+    {
+        truth = exact_count(ex, items[i].key, items[i].len);
+        hits += truth >= kth;
+        diff = items[i].count - truth;
+        max_diff = diff > max_diff ? diff : max_diff;
+        /* ʵӦ[count-error, count] */
+        if (truth > items[i].count || truth + items[i].error < items[i].count)
+            outside++;
+    }
+    printf("%-13s t=%d %6.2f s (%.2fx exact), %7.2f MB, recall %.3f, "
+           "max error %lu of bound %lu%s\n",
+           mode == TOPK_SKETCH ? "sketch" : "space-saving", nthreads, t,
+           exact_time / t, topk_peak_memory(topk) / 1048576.0, (double)hits / k,
+           (unsigned long)max_diff, (unsigned long)bound,
+           outside ? " OUT OF BOUNDS" : "");
+    topk_destroy(topk);
+    free(items);
+}
+
+static void usage(char *name){
+    fprintf(stderr, "Usage: %s [-m MB] [-v vocab] [-z s] [-k K] [-e epsilon] "
+            "[-d delta] [-t threads] [-f file]\n"
+            "  -m     size of the word file (default 2048 MB, kept if it exists)\n"
+            "  -v     distinct words (default 4M)\n"
+            "  -z     zipf exponent (default 1.0)\n"
+            "  -k     K (default 100)\n"
+            "  -e -d  error and its probability (default 0.00001 0.001)\n"
+            "  -t     threads of the parallel runs (default 4)\n"
+            "  -f     word file (default topk_words.txt)\n", name);
+    exit(EXIT_FAILURE);
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    struct stat st;
+    uint64_t kth;
+    double t;
+    Exact ex;
+    char *text;
+    int32_t opt, fd;
+
+    while ((opt = getopt(argc, argv, "m:v:z:k:e:d:t:f:h")) != -1) {
+        switch (opt) {
+        case 'm': file_mb = strtoull(optarg, NULL, 0); break;
+        case 'v': vocab = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'z': zipf_s = atof(optarg); break;
+        case 'k': k = (uint32_t)atoi(optarg); break;
+        case 'e': epsilon = atof(optarg); break;
+        case 'd': delta = atof(optarg); break;
+        case 't': threads = atoi(optarg); break;
+        case 'f': path = optarg; break;
+        default: usage(argv[0]);
+        }
+    }
+    if (file_mb == 0 || vocab == 0 || k == 0 || threads < 1)
+        usage(argv[0]);
+
+    if (gen_words() != 0)
+    {
+        fprintf(stderr, "can not write %s\n", path);
+        return 1;
+    }
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) < 0)
+        return 1;
+    text = (char *)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (text == MAP_FAILED)
+        return 1;
+    madvise(text, st.st_size, MADV_SEQUENTIAL);
+    t = now_sec();
+    if (exact_run(&ex, text, st.st_size) != 0)
+    {
+        fprintf(stderr, "exact count out of memory\n");
+        return 1;
+    }
+    t = now_sec() - t;
+    munmap(text, st.st_size);
+    printf("exact    %lu words, %lu distinct, %.2f s, %.2f MB\n",
+           (unsigned long)ex.total, (unsigned long)ex.used, t,
+           ((ex.mask + 1) * sizeof(Entry) + ex.arena_cap) / 1048576.0);
+    kth = exact_kth(&ex);
+
+    run(&ex, kth, TOPK_SKETCH, 1, t);
+    run(&ex, kth, TOPK_SKETCH, threads, t);
+    run(&ex, kth, TOPK_SPACE_SAVING, 1, t);
+    run(&ex, kth, TOPK_SPACE_SAVING, threads, t);
+
+    free(ex.table);
+    free(ex.arena);
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
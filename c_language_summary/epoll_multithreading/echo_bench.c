@@ -0,0 +1,394 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/* echo²ԣԱȡ(batch=1)ȡ
+ * Ƭģʽ(ÿ߳һepollһSO_REUSEPORTfd)io_uring
+ * event_poolͻ߳Լepollͬһѹ⣬
+ * ÿģʽڵӽ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include "../debug/debug.h"
+#include "../count_time/count_time.h"
+#include "event.h"
+
+#define DEFAULT_EVENT_POOL_SIZE            50000
+#define DEFAULT_BATCH                      64
+#define MAX_MSG_SIZE                       4096
+
+enum pool_kind {
+    POOL_EPOLL,
+    POOL_SHARDED,
+    POOL_URING,
+};
+
+static const char *pool_kind_name[] = {"epoll  ", "sharded", "uring  "};
+
+struct private_data{
+    int fd;
+    int idx;
+};
+
+struct client_arg{
+    int nconn;
+    long bytes;
+};
+
+static struct event_pool *pool = NULL;
+static struct sockaddr_in server_addr;
+static int server_threads = 4;
+static int client_threads = 4;
+static int connections = 64;
+static int msg_size = 64;
+static int window = 1;
+static int duration = 5;
+static volatile int stop = 0;
+
+static int
+make_socket_non_blocking (int sfd)
+{
+    int flags;
+
+    flags = fcntl (sfd, F_GETFL, 0);
+    if (flags == -1)
+        return -1;
+
+    return fcntl (sfd, F_SETFL, flags | O_NONBLOCK);
+}
+
+/* дΪֹsocketдʱ */
+static int
+write_all (int fd, const char *buf, ssize_t len)
+{
+    ssize_t n;
+
+    while (len > 0) {
+        n = write (fd, buf, len);
+        if (n == -1) {
+            if (errno == EAGAIN || errno == EINTR)
+                continue;
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/* ԵEAGAIN */
+static int
+echo_event_handler (int fd, int idx, void *data,
+                    int poll_in, int poll_out, int poll_err)
+{
+    char buf[MAX_MSG_SIZE];
+    ssize_t count;
+
+    if (!poll_in && !poll_err)
+        return 0;
+
+    for (;;) {
+        count = read (fd, buf, sizeof(buf));
+        if (count > 0) {
+            if (write_all (fd, buf, count) == -1)
+                goto close;
+            continue;
+        }
+        if (count == -1 && errno == EAGAIN)
+            return 0;
+        if (count == -1 && errno == EINTR)
+            continue;
+        goto close;
+    }
+
+close:
+    /* data˳ͷţڴͬһfd̳߳ͻ */
+    event_unregister_close (pool, fd, idx);
+    return 0;
+}
+
+static int
+accept_event_handler (int fd, int idx, void *data,
+                      int poll_in, int poll_out, int poll_err)
+{
+    struct private_data *new_data;
+    int new_sock;
+    int one = 1;
+
+    if (!poll_in)
+        return 0;
+
+    for (;;) {
+        new_sock = accept (fd, NULL, NULL);
+        if (new_sock == -1) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                perror ("accept");
+            break;
+        }
+
+        make_socket_non_blocking (new_sock);
+        setsockopt (new_sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        new_data = (struct private_data *)calloc(1, sizeof(struct private_data));
+        new_data->fd = new_sock;
+        new_data->idx = event_register (pool, new_sock, echo_event_handler,
+                                        new_data, 1, 0);
+        if (new_data->idx == -1) {
+            LOG_PRINT(D_LOG_ERR, "failed to register the socket with event");
+            free (new_data);
+            close (new_sock);
+        }
+    }
+    return 0;
+}
+
+static void *
+dispatch_thread (void *arg)
+{
+    event_dispatch (pool);
+    return NULL;
+}
+
+/* ÿͻ̸߳nconnӣÿӱwindowϢ·ϣ
+ * յֽھͻдֽ */
+static void *
+client_thread (void *arg)
+{
+    struct client_arg *carg = (struct client_arg *)arg;
+    struct epoll_event ev, events[64];
+    char buf[MAX_MSG_SIZE];
+    char *msg;
+    int *fds;
+    int epfd, i, n, one = 1;
+    ssize_t count;
+
+    msg = malloc (msg_size * window);
+    fds = calloc (carg->nconn, sizeof(int));
+    memset (msg, 'a', msg_size * window);
+
+    epfd = epoll_create (carg->nconn);
+    for (i = 0; i < carg->nconn; i++) {
+        fds[i] = socket (AF_INET, SOCK_STREAM, 0);
+        if (connect (fds[i], (struct sockaddr *)&server_addr,
+                     sizeof(server_addr)) == -1) {
+            perror ("connect");
+            exit (EXIT_FAILURE);
+        }
+        setsockopt (fds[i], IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        make_socket_non_blocking (fds[i]);
+        ev.events = EPOLLIN;
+        ev.data.fd = fds[i];
+        epoll_ctl (epfd, EPOLL_CTL_ADD, fds[i], &ev);
+        write_all (fds[i], msg, msg_size * window);
+    }
+
+    while (!stop) {
+        n = epoll_wait (epfd, events, 64, 100);
+        for (i = 0; i < n; i++) {
+            count = read (events[i].data.fd, buf, sizeof(buf));
+            if (count <= 0)
+                continue;
+            carg->bytes += count;
+            write_all (events[i].data.fd, buf, count);
+        }
+    }
+
+    for (i = 0; i < carg->nconn; i++)
+        close (fds[i]);
+    close (epfd);
+    free (fds);
+    free (msg);
+    return NULL;
+}
+
+/* һεʱ˿Ϊ0ں˷䣬֮ļfdSO_REUSEPORTͬһ˿ */
+static int
+create_listener (void)
+{
+    socklen_t len = sizeof(server_addr);
+    int sfd, one = 1;
+
+    sfd = socket (AF_INET, SOCK_STREAM, 0);
+    setsockopt (sfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt (sfd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+    if (bind (sfd, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1
+        || listen (sfd, SOMAXCONN) == -1) {
+        perror ("bind/listen");
+        close (sfd);
+        return -1;
+    }
+    getsockname (sfd, (struct sockaddr *)&server_addr, &len);
+    make_socket_non_blocking (sfd);
+
+    return sfd;
+}
+
+static int
+run_bench (int batchsize, int kind)
+{
+    struct private_data *data;
+    struct client_arg *cargs;
+    pthread_t tid;
+    pthread_t *ctids;
+    long bytes = 0;
+    int nlisteners, i;
+
+    memset (&server_addr, 0, sizeof(server_addr));
+
+    if (kind == POOL_SHARDED) {
+        pool = event_pool_new_sharded (DEFAULT_EVENT_POOL_SIZE,
+                                       server_threads);
+        nlisteners = event_pool_thread_count (pool);
+    } else {
+        /* ں˲֧io_uringʱ˻epoll */
+        event_pool_uring_set (kind == POOL_URING);
+        pool = event_pool_new (DEFAULT_EVENT_POOL_SIZE, server_threads);
+        nlisteners = 1;
+        if (kind == POOL_URING && !pool->uring)
+            printf ("io_uring not available, using epoll\n");
+    }
+    if (batchsize > 0)
+        event_pool_set_batch (pool, batchsize);
+    batchsize = pool->batchsize;
+
+    /* Ƭģʽÿ߳һfdɽ̴߳ */
+    for (i = 0; i < nlisteners; i++) {
+        data = (struct private_data *)calloc(1, sizeof(struct private_data));
+        data->fd = create_listener ();
+        if (data->fd == -1)
+            return -1;
+        data->idx = event_register_on (pool, i, data->fd,
+                                       accept_event_handler, data, 1, 0);
+        if (data->idx == -1) {
+            LOG_PRINT(D_LOG_ERR, "failed to register the socket with event");
+            return -1;
+        }
+    }
+    pthread_create (&tid, NULL, dispatch_thread, NULL);
+
+    cargs = calloc (client_threads, sizeof(*cargs));
+    ctids = calloc (client_threads, sizeof(*ctids));
+    for (i = 0; i < client_threads; i++)
+        cargs[i].nconn = connections / client_threads +
+                         (i < connections % client_threads);
+
+    TIME_START
+    for (i = 0; i < client_threads; i++)
+        pthread_create (&ctids[i], NULL, client_thread, &cargs[i]);
+    sleep (duration);
+    stop = 1;
+    for (i = 0; i < client_threads; i++) {
+        pthread_join (ctids[i], NULL);
+        bytes += cargs[i].bytes;
+    }
+    TIME_END_PRINT("%s batch %3d: server threads %d, connections %d, "
+                   "msg size %d, window %d: %ld msgs, %.0f msgs/s",
+                   pool_kind_name[kind], batchsize,
+                   server_threads, connections, msg_size, window,
+                   bytes / msg_size,
+                   (double)(bytes / msg_size) / duration);
+
+    if (kind != POOL_EPOLL) {
+        /* Ƭio_uring˳һ߳ע */
+        event_dispatch_destroy (pool);
+        pthread_join (tid, NULL);
+        event_pool_destroy (pool);
+    }
+
+    /* ֱ˳ */
+    return 0;
+}
+
+static void
+usage (char *name)
+{
+    fprintf (stderr, "Usage: %s [-t server_threads] [-T client_threads] "
+             "[-c connections] [-s msg_size] [-w window] [-d seconds] "
+             "[-b batch] [-r] [-u]\n"
+             "  default runs epoll and io_uring with batch=1 and batch=%d, "
+             "and sharded, in turn\n"
+             "  -b N   run with batch N only\n"
+             "  -r     run the sharded pool only\n"
+             "  -u     run the io_uring pool only\n",
+             name, DEFAULT_BATCH);
+    exit (EXIT_FAILURE);
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    int batch = 0;
+    int kind = POOL_EPOLL;
+    int modes[5][2];
+    int nmodes, i, opt;
+    pid_t pid;
+
+    while ((opt = getopt (argc, argv, "t:T:c:s:w:d:b:ruh")) != -1) {
+        switch (opt) {
+        case 't': server_threads = atoi (optarg); break;
+        case 'T': client_threads = atoi (optarg); break;
+        case 'c': connections = atoi (optarg); break;
+        case 's': msg_size = atoi (optarg); break;
+        case 'w': window = atoi (optarg); break;
+        case 'd': duration = atoi (optarg); break;
+        case 'b': batch = atoi (optarg); break;
+        case 'r': kind = POOL_SHARDED; break;
+        case 'u': kind = POOL_URING; break;
+        default: usage (argv[0]);
+        }
+    }
+    if (server_threads <= 0 || client_threads <= 0 || window <= 0 ||
+        connections < client_threads || duration <= 0 ||
+        msg_size <= 0 || msg_size > MAX_MSG_SIZE)
+        usage (argv[0]);
+
+    /* {batch, kind}batchΪ0ʾ¼صĬֵ */
+    if (kind != POOL_EPOLL || batch > 0) {
+        modes[0][0] = batch;
+        modes[0][1] = kind;
+        nmodes = 1;
+    } else {
+        modes[0][0] = 1;
+        modes[0][1] = POOL_EPOLL;
+        modes[1][0] = DEFAULT_BATCH;
+        modes[1][1] = POOL_EPOLL;
+        modes[2][0] = 0;
+        modes[2][1] = POOL_SHARDED;
+        modes[3][0] = 1;
+        modes[3][1] = POOL_URING;
+        modes[4][0] = DEFAULT_BATCH;
+        modes[4][1] = POOL_URING;
+        nmodes = 5;
+    }
+
+    for (i = 0; i < nmodes; i++) {
+        fflush (stdout);
+        pid = fork ();
+        if (pid == 0) {
+            opt = run_bench (modes[i][0], modes[i][1]);
+            fflush (stdout);
+            _exit (opt == 0 ? 0 : 1);
+        }
+        waitpid (pid, NULL, 0);
+    }
+
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
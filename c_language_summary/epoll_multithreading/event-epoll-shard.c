@@ -0,0 +1,902 @@
+
+#include <sys/poll.h>
+#include <sys/eventfd.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+
+#include "../debug/debug.h"
+#include "event.h"
+
+
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+
+/* 分片模式：
+ * 每个线程一个epoll实例和一张slot表，fd注册到哪个线程就一直由哪个线程处理，
+ * slot表只有所属线程访问，不需要锁和引用计数。
+ * 配合SO_REUSEPORT给每个线程注册一个监听fd，accept出来的连接在
+ * handler里用event_register注册，就留在当前线程。
+ * 其他线程的event_register/event_select_on/event_unregister通过
+ * 目标线程的邮箱(mailbox)转交，用eventfd唤醒目标线程执行。
+ * idx = 线程内slot号 << EVENT_SHARD_BITS | 线程号
+ */
+
+#define EVENT_SHARD_BITS           5 /* 2^5 == EVENT_MAX_THREADS */
+#define EVENT_SHARD_MASK           ((1 << EVENT_SHARD_BITS) - 1)
+#define EVENT_SHARD_MAX_SLOTS      (1 << (31 - EVENT_SHARD_BITS))
+#define EVENT_SHARD_INIT_SLOTS     64
+#define EVENT_SHARD_DEFAULT_BATCH  64
+#define EVENT_SHARD_WAKE_IDX       -1 /* 邮箱eventfd在epoll里的idx */
+
+#define EVENT_SHARD_IDX(local, shard) (((local) << EVENT_SHARD_BITS) | (shard))
+
+struct event_slot_shard {
+        int fd;
+        int events;
+        int gen;
+        int next_free; /* 空闲slot链表 */
+        void *data;
+        event_handler_t handler;
+};
+
+enum event_shard_op {
+        EVENT_SHARD_REGISTER,
+        EVENT_SHARD_SELECT_ON,
+        EVENT_SHARD_UNREGISTER,
+};
+
+/* 邮箱消息，同步消息在调用者栈上，异步消息由执行线程释放 */
+struct event_shard_msg {
+        struct event_shard_msg *next;
+        int op;
+        int fd;
+        int idx;
+        int poll_in;
+        int poll_out;
+        int do_close;
+        event_handler_t handler;
+        void *data;
+        int ret;
+        int sync;
+        int done;
+};
+
+struct event_shard {
+        struct event_pool *event_pool;
+        int index;
+        int epfd;
+        int wakefd;
+
+        /* 以下只有所属线程访问(线程启动前和退出后在mutex下访问) */
+        struct event_slot_shard *slots;
+        int nslots;
+        int free_head;
+
+        pthread_mutex_t mutex; /* 保护邮箱和running */
+        pthread_cond_t cond;   /* 同步消息完成通知 */
+        struct event_shard_msg *mbox_head;
+        struct event_shard_msg *mbox_tail;
+        int running;
+        volatile int stop;
+};
+
+/* 当前线程所属的分片，非工作线程为NULL */
+static __thread struct event_shard *current_shard = NULL;
+
+
+static int
+__shard_slot_alloc (struct event_shard *shard, int fd)
+{
+        struct event_slot_shard *slots = NULL;
+        struct event_slot_shard *slot = NULL;
+        int                      nslots = 0;
+        int                      i = 0;
+        int                      local = -1;
+
+        if (shard->free_head == -1) {
+                nslots = shard->nslots ? shard->nslots * 2
+                                       : EVENT_SHARD_INIT_SLOTS;
+                if (nslots > EVENT_SHARD_MAX_SLOTS)
+                        return -1;
+
+                slots = realloc (shard->slots, nslots * sizeof (*slots));
+                if (!slots)
+                        return -1;
+
+                for (i = shard->nslots; i < nslots; i++) {
+                        memset (&slots[i], 0, sizeof (slots[i]));
+                        slots[i].fd = -1;
+                        slots[i].next_free = (i + 1 < nslots) ? i + 1 : -1;
+                }
+                shard->free_head = shard->nslots;
+                shard->slots = slots;
+                shard->nslots = nslots;
+        }
+
+        local = shard->free_head;
+        slot = &shard->slots[local];
+        shard->free_head = slot->next_free;
+
+        slot->fd = fd;
+        slot->gen++;
+        slot->events = 0;
+        slot->next_free = -1;
+
+        return local;
+}
+
+
+static void
+__shard_slot_dealloc (struct event_shard *shard, int local)
+{
+        struct event_slot_shard *slot = &shard->slots[local];
+
+        slot->fd = -1;
+        slot->gen++; /* 让已经收取的旧事件失效 */
+        slot->handler = NULL;
+        slot->data = NULL;
+        slot->next_free = shard->free_head;
+        shard->free_head = local;
+}
+
+
+static struct event_slot_shard *
+__shard_slot_get (struct event_shard *shard, int idx, int fd)
+{
+        int local = idx >> EVENT_SHARD_BITS;
+
+        if (local < 0 || local >= shard->nslots)
+                return NULL;
+
+        if (shard->slots[local].fd != fd || fd == -1)
+                return NULL;
+
+        return &shard->slots[local];
+}
+
+
+static void
+__shard_update_events (struct event_slot_shard *slot, int poll_in,
+                       int poll_out)
+{
+	switch (poll_in) {
+	case 1:
+		slot->events |= EPOLLIN;
+		break;
+	case 0:
+		slot->events &= ~EPOLLIN;
+		break;
+	case -1:
+		/* do nothing */
+		break;
+	default:
+        LOG_PRINT(D_LOG_ERR, "invalid poll_in value %d", poll_in);
+		break;
+	}
+
+	switch (poll_out) {
+	case 1:
+		slot->events |= EPOLLOUT;
+		break;
+	case 0:
+		slot->events &= ~EPOLLOUT;
+		break;
+	case -1:
+		/* do nothing */
+		break;
+	default:
+        LOG_PRINT(D_LOG_ERR, "invalid poll_out value %d", poll_out);
+		break;
+	}
+}
+
+
+/* 水平触发：fd只属于一个线程，不存在多线程抢同一个fd，
+ * 也就不需要EPOLLONESHOT和每次事件后的EPOLL_CTL_MOD */
+static int
+__shard_register (struct event_shard *shard, int fd, event_handler_t handler,
+                  void *data, int poll_in, int poll_out)
+{
+        struct epoll_event       epoll_event = {0, };
+        struct event_data       *ev_data = (void *)&epoll_event.data;
+        struct event_slot_shard *slot = NULL;
+        int                      local = -1;
+        int                      ret = -1;
+
+        local = __shard_slot_alloc (shard, fd);
+        if (local == -1) {
+                LOG_PRINT(D_LOG_ERR, "could not find slot for fd=%d", fd);
+                return -1;
+        }
+
+        slot = &shard->slots[local];
+        slot->handler = handler;
+        slot->data = data;
+        __shard_update_events (slot, poll_in, poll_out);
+
+        epoll_event.events = slot->events;
+        ev_data->idx = local;
+        ev_data->gen = slot->gen;
+
+        ret = epoll_ctl (shard->epfd, EPOLL_CTL_ADD, fd, &epoll_event);
+        if (ret == -1) {
+                LOG_PRINT(D_LOG_ERR, "failed to add fd(=%d) to epoll fd(=%d) (%s)",
+                          fd, shard->epfd, strerror (errno));
+                __shard_slot_dealloc (shard, local);
+                return -1;
+        }
+
+        return EVENT_SHARD_IDX (local, shard->index);
+}
+
+
+static int
+__shard_select_on (struct event_shard *shard, int fd, int idx,
+                   int poll_in, int poll_out)
+{
+        struct epoll_event       epoll_event = {0, };
+        struct event_data       *ev_data = (void *)&epoll_event.data;
+        struct event_slot_shard *slot = NULL;
+        int                      ret = -1;
+
+        slot = __shard_slot_get (shard, idx, fd);
+        if (!slot) {
+                LOG_PRINT(D_LOG_ERR, "stale fd(=%d) idx=%d", fd, idx);
+                return -1;
+        }
+
+        __shard_update_events (slot, poll_in, poll_out);
+
+        epoll_event.events = slot->events;
+        ev_data->idx = idx >> EVENT_SHARD_BITS;
+        ev_data->gen = slot->gen;
+
+        ret = epoll_ctl (shard->epfd, EPOLL_CTL_MOD, fd, &epoll_event);
+        if (ret == -1) {
+                LOG_PRINT(D_LOG_ERR, "failed to modify fd(=%d) events to %d",
+                          fd, epoll_event.events);
+                return -1;
+        }
+
+        return idx;
+}
+
+
+static int
+__shard_unregister (struct event_shard *shard, int fd, int idx, int do_close)
+{
+        struct event_slot_shard *slot = NULL;
+        int                      ret = -1;
+
+        slot = __shard_slot_get (shard, idx, fd);
+        if (!slot) {
+                LOG_PRINT(D_LOG_ERR, "stale fd(=%d) idx=%d", fd, idx);
+                return -1;
+        }
+
+        ret = epoll_ctl (shard->epfd, EPOLL_CTL_DEL, fd, NULL);
+        if (ret == -1) {
+                LOG_PRINT(D_LOG_ERR,
+                          "fail to del fd(=%d) from epoll fd(=%d) (%s)",
+                          fd, shard->epfd, strerror (errno));
+                return -1;
+        }
+
+        __shard_slot_dealloc (shard, idx >> EVENT_SHARD_BITS);
+
+        if (do_close)
+                close (fd);
+
+        return 0;
+}
+
+
+static int
+__shard_msg_exec (struct event_shard *shard, struct event_shard_msg *msg)
+{
+        switch (msg->op) {
+        case EVENT_SHARD_REGISTER:
+                return __shard_register (shard, msg->fd, msg->handler,
+                                         msg->data, msg->poll_in,
+                                         msg->poll_out);
+        case EVENT_SHARD_SELECT_ON:
+                return __shard_select_on (shard, msg->fd, msg->idx,
+                                          msg->poll_in, msg->poll_out);
+        case EVENT_SHARD_UNREGISTER:
+                return __shard_unregister (shard, msg->fd, msg->idx,
+                                           msg->do_close);
+        default:
+                return -1;
+        }
+}
+
+
+/* 执行一条对shard的操作：
+ * 当前线程就是所属线程或者线程还没运行时直接执行，
+ * 否则放进邮箱唤醒所属线程，同步消息等待执行结果。
+ * 注意：不要在两个工作线程之间相互发同步消息 */
+static int
+shard_msg_send (struct event_shard *shard, struct event_shard_msg *msg)
+{
+        struct event_shard_msg *amsg = NULL;
+        uint64_t                one = 1;
+        int                     ret = -1;
+        int                     direct = 0;
+        int                     sync = msg->sync;
+
+        if (current_shard == shard)
+                return __shard_msg_exec (shard, msg);
+
+        if (!msg->sync) {
+                amsg = malloc (sizeof (*amsg));
+                if (!amsg)
+                        return -1;
+                *amsg = *msg;
+                msg = amsg;
+        }
+        msg->next = NULL;
+
+        pthread_mutex_lock (&shard->mutex);
+        {
+                if (!shard->running) {
+                        ret = __shard_msg_exec (shard, msg);
+                        direct = 1;
+                        goto unlock;
+                }
+
+                if (shard->mbox_tail)
+                        shard->mbox_tail->next = msg;
+                else
+                        shard->mbox_head = msg;
+                shard->mbox_tail = msg;
+                amsg = NULL; /* 交给所属线程释放 */
+        }
+unlock:
+        pthread_mutex_unlock (&shard->mutex);
+
+        if (direct) {
+                free (amsg);
+                return ret;
+        }
+
+        /* 异步消息入队后可能已被所属线程释放，不能再访问 */
+
+        if (write (shard->wakefd, &one, sizeof (one)) == -1 &&
+            errno != EAGAIN)
+                LOG_PRINT(D_LOG_ERR, "failed to wake thread %d (%s)",
+                          shard->index, strerror (errno));
+
+        if (!sync)
+                /* 异步消息，event_select_on返回idx，event_unregister返回0 */
+                return 0;
+
+        pthread_mutex_lock (&shard->mutex);
+        {
+                while (!msg->done)
+                        pthread_cond_wait (&shard->cond, &shard->mutex);
+                ret = msg->ret;
+        }
+        pthread_mutex_unlock (&shard->mutex);
+
+        return ret;
+}
+
+
+/* 所属线程处理邮箱里的消息 */
+static void
+shard_mailbox_run (struct event_shard *shard)
+{
+        struct event_shard_msg *msg = NULL;
+        struct event_shard_msg *next = NULL;
+        uint64_t                count = 0;
+        int                     ret = -1;
+        int                     wake = 0;
+
+        while (read (shard->wakefd, &count, sizeof (count)) > 0) {
+        }
+
+        pthread_mutex_lock (&shard->mutex);
+        {
+                msg = shard->mbox_head;
+                shard->mbox_head = shard->mbox_tail = NULL;
+        }
+        pthread_mutex_unlock (&shard->mutex);
+
+        for (; msg; msg = next) {
+                next = msg->next;
+                ret = __shard_msg_exec (shard, msg);
+                if (!msg->sync) {
+                        free (msg);
+                        continue;
+                }
+                pthread_mutex_lock (&shard->mutex);
+                {
+                        msg->ret = ret;
+                        msg->done = 1;
+                }
+                pthread_mutex_unlock (&shard->mutex);
+                wake = 1;
+        }
+
+        if (wake) {
+                pthread_mutex_lock (&shard->mutex);
+                {
+                        pthread_cond_broadcast (&shard->cond);
+                }
+                pthread_mutex_unlock (&shard->mutex);
+        }
+}
+
+
+static struct event_shard *
+event_shard_get (struct event_pool *event_pool, int idx)
+{
+        int shard = idx & EVENT_SHARD_MASK;
+
+        if (idx < 0 || shard >= event_pool->shardcount) {
+                errno = EINVAL;
+                return NULL;
+        }
+
+        return &event_pool->shards[shard];
+}
+
+
+static int
+event_register_on_shard (struct event_pool *event_pool, int thread, int fd,
+                         event_handler_t handler,
+                         void *data, int poll_in, int poll_out)
+{
+        struct event_shard_msg msg = {0, };
+        int                    destroy = 0;
+
+        GF_VALIDATE_OR_GOTO ("event", event_pool, out);
+
+        if (thread < 0 || thread >= event_pool->shardcount) {
+                LOG_PRINT(D_LOG_ERR, "invalid thread index %d", thread);
+                goto out;
+        }
+
+        pthread_mutex_lock (&event_pool->mutex);
+        {
+                destroy = event_pool->destroy;
+        }
+        pthread_mutex_unlock (&event_pool->mutex);
+
+        if (destroy == 1)
+                goto out;
+
+        msg.op = EVENT_SHARD_REGISTER;
+        msg.fd = fd;
+        msg.handler = handler;
+        msg.data = data;
+        msg.poll_in = poll_in;
+        msg.poll_out = poll_out;
+        msg.sync = 1;
+
+        return shard_msg_send (&event_pool->shards[thread], &msg);
+out:
+        return -1;
+}
+
+
+/* 工作线程里注册到当前线程，其他线程轮流分配 */
+static int
+event_register_shard (struct event_pool *event_pool, int fd,
+                      event_handler_t handler,
+                      void *data, int poll_in, int poll_out)
+{
+        static unsigned int next = 0;
+        int                 thread = 0;
+
+        GF_VALIDATE_OR_GOTO ("event", event_pool, out);
+
+        if (current_shard && current_shard->event_pool == event_pool)
+                thread = current_shard->index;
+        else
+                thread = __sync_fetch_and_add (&next, 1) %
+                         event_pool->shardcount;
+
+        return event_register_on_shard (event_pool, thread, fd, handler, data,
+                                        poll_in, poll_out);
+out:
+        return -1;
+}
+
+
+static int
+event_select_on_shard (struct event_pool *event_pool, int fd, int idx,
+                       int poll_in, int poll_out)
+{
+        struct event_shard_msg msg = {0, };
+        struct event_shard    *shard = NULL;
+
+        GF_VALIDATE_OR_GOTO ("event", event_pool, out);
+
+        shard = event_shard_get (event_pool, idx);
+        GF_VALIDATE_OR_GOTO ("event", shard, out);
+
+        msg.op = EVENT_SHARD_SELECT_ON;
+        msg.fd = fd;
+        msg.idx = idx;
+        msg.poll_in = poll_in;
+        msg.poll_out = poll_out;
+        msg.sync = 0;
+
+        if (shard_msg_send (shard, &msg) == -1)
+                return -1;
+
+        return idx;
+out:
+        return -1;
+}
+
+
+/* 非工作线程同步等待注销完成(保证返回后fd已关闭)，
+ * 工作线程注销别的线程的fd时异步执行，避免线程间互相等待 */
+static int
+event_unregister_shard_common (struct event_pool *event_pool, int fd,
+                               int idx, int do_close)
+{
+        struct event_shard_msg msg = {0, };
+        struct event_shard    *shard = NULL;
+
+        GF_VALIDATE_OR_GOTO ("event", event_pool, out);
+
+        shard = event_shard_get (event_pool, idx);
+        GF_VALIDATE_OR_GOTO ("event", shard, out);
+
+        msg.op = EVENT_SHARD_UNREGISTER;
+        msg.fd = fd;
+        msg.idx = idx;
+        msg.do_close = do_close;
+        msg.sync = (current_shard == NULL);
+
+        return shard_msg_send (shard, &msg);
+out:
+        return -1;
+}
+
+
+static int
+event_unregister_shard (struct event_pool *event_pool, int fd, int idx)
+{
+        return event_unregister_shard_common (event_pool, fd, idx, 0);
+}
+
+
+static int
+event_unregister_close_shard (struct event_pool *event_pool, int fd, int idx)
+{
+        return event_unregister_shard_common (event_pool, fd, idx, 1);
+}
+
+
+static void
+event_dispatch_shard_handler (struct event_shard *shard,
+                              struct epoll_event *event)
+{
+        struct event_data       *ev_data = (void *)&event->data;
+        struct event_slot_shard *slot = NULL;
+        event_handler_t          handler = NULL;
+        void                    *data = NULL;
+        int                      fd = -1;
+
+        if (ev_data->idx == EVENT_SHARD_WAKE_IDX) {
+                shard_mailbox_run (shard);
+                return;
+        }
+
+        if (ev_data->idx >= shard->nslots)
+                return;
+
+        slot = &shard->slots[ev_data->idx];
+        if (slot->fd == -1 || slot->gen != ev_data->gen)
+                /* 同一批事件里前面的handler已经注销了这个fd */
+                return;
+
+        /* handler里可能注册新fd导致slot表realloc，先取出来 */
+        fd = slot->fd;
+        handler = slot->handler;
+        data = slot->data;
+
+        handler (fd, EVENT_SHARD_IDX (ev_data->idx, shard->index), data,
+                 (event->events & (EPOLLIN|EPOLLPRI)),
+                 (event->events & (EPOLLOUT)),
+                 (event->events & (EPOLLERR|EPOLLHUP)));
+}
+
+
+static void *
+event_dispatch_shard_worker (void *data)
+{
+        struct event_shard *shard = data;
+        struct event_pool  *event_pool = shard->event_pool;
+        struct epoll_event *events = NULL;
+        struct event_shard_msg *msg = NULL;
+        struct event_shard_msg *next = NULL;
+        int                 batchsize = 1;
+        int                 ret = -1;
+        int                 i = 0;
+
+        LOG_PRINT(D_LOG_INFO, "Started thread with index %d", shard->index + 1);
+
+        current_shard = shard;
+
+        pthread_mutex_lock (&event_pool->mutex);
+        {
+                event_pool->activethreadcount++;
+                batchsize = event_pool->batchsize;
+        }
+        pthread_mutex_unlock (&event_pool->mutex);
+
+        if (batchsize < 1)
+                batchsize = 1;
+
+        events = calloc (batchsize, sizeof (*events));
+        if (!events) {
+                events = calloc (1, sizeof (*events));
+                batchsize = 1;
+        }
+
+        pthread_mutex_lock (&shard->mutex);
+        {
+                shard->running = 1;
+        }
+        pthread_mutex_unlock (&shard->mutex);
+
+        /* 线程启动前投递的消息 */
+        shard_mailbox_run (shard);
+
+        while (!shard->stop) {
+                ret = epoll_wait (shard->epfd, events, batchsize,
+                                  event_timer_timeout (event_pool,
+                                                       shard->index + 1));
+
+                for (i = 0; i < ret; i++)
+                        event_dispatch_shard_handler (shard, &events[i]);
+
+                event_timers_run (event_pool);
+        }
+
+        /* 退出前把邮箱里剩下的消息执行完，之后的消息由调用者直接执行 */
+        pthread_mutex_lock (&shard->mutex);
+        {
+                shard->running = 0;
+                msg = shard->mbox_head;
+                shard->mbox_head = shard->mbox_tail = NULL;
+                for (; msg; msg = next) {
+                        next = msg->next;
+                        msg->ret = __shard_msg_exec (shard, msg);
+                        msg->done = 1;
+                        if (!msg->sync)
+                                free (msg);
+                }
+                pthread_cond_broadcast (&shard->cond);
+        }
+        pthread_mutex_unlock (&shard->mutex);
+
+        current_shard = NULL;
+        free (events);
+
+        pthread_mutex_lock (&event_pool->mutex);
+        {
+                event_pool->pollers[shard->index] = 0;
+                event_pool->activethreadcount--;
+                pthread_cond_broadcast (&event_pool->cond);
+        }
+        pthread_mutex_unlock (&event_pool->mutex);
+
+        LOG_PRINT(D_LOG_INFO, "Exited thread with index %d", shard->index + 1);
+
+        return NULL;
+}
+
+
+static struct event_pool *
+event_pool_new_shard (int count, int eventthreadcount)
+{
+        struct event_pool        *event_pool = NULL;
+        struct event_shard       *shard = NULL;
+        struct epoll_event        epoll_event = {0, };
+        struct event_data        *ev_data = (void *)&epoll_event.data;
+        int                       i = 0;
+
+        if (eventthreadcount > EVENT_MAX_THREADS)
+                eventthreadcount = EVENT_MAX_THREADS;
+        if (eventthreadcount <= 0)
+                eventthreadcount = 1;
+
+        event_pool = calloc (1, sizeof (*event_pool));
+        if (!event_pool)
+                goto err;
+
+        event_pool->shards = calloc (eventthreadcount,
+                                     sizeof (*event_pool->shards));
+        if (!event_pool->shards)
+                goto err;
+
+        for (i = 0; i < eventthreadcount; i++) {
+                shard = &event_pool->shards[i];
+                shard->event_pool = event_pool;
+                shard->index = i;
+                shard->free_head = -1;
+                shard->wakefd = -1;
+                pthread_mutex_init (&shard->mutex, NULL);
+                pthread_cond_init (&shard->cond, NULL);
+                event_pool->shardcount++;
+
+                shard->epfd = epoll_create (count / eventthreadcount + 1);
+                if (shard->epfd == -1) {
+                        LOG_PRINT(D_LOG_ERR, "epoll fd creation failed (%s)",
+                                  strerror (errno));
+                        goto err;
+                }
+
+                shard->wakefd = eventfd (0, EFD_NONBLOCK);
+                if (shard->wakefd == -1) {
+                        LOG_PRINT(D_LOG_ERR, "eventfd creation failed (%s)",
+                                  strerror (errno));
+                        goto err;
+                }
+
+                epoll_event.events = EPOLLIN;
+                ev_data->idx = EVENT_SHARD_WAKE_IDX;
+                ev_data->gen = 0;
+                if (epoll_ctl (shard->epfd, EPOLL_CTL_ADD, shard->wakefd,
+                               &epoll_event) == -1) {
+                        LOG_PRINT(D_LOG_ERR, "failed to add eventfd (%s)",
+                                  strerror (errno));
+                        goto err;
+                }
+        }
+
+        event_pool->fd = -1;
+        event_pool->count = count;
+        event_pool->eventthreadcount = eventthreadcount;
+        event_pool->batchsize = EVENT_SHARD_DEFAULT_BATCH;
+
+        pthread_mutex_init (&event_pool->mutex, NULL);
+        pthread_cond_init (&event_pool->cond, NULL);
+
+        return event_pool;
+err:
+        if (event_pool) {
+                for (i = 0; i < event_pool->shardcount; i++) {
+                        shard = &event_pool->shards[i];
+                        if (shard->epfd != -1)
+                                close (shard->epfd);
+                        if (shard->wakefd != -1)
+                                close (shard->wakefd);
+                        pthread_mutex_destroy (&shard->mutex);
+                        pthread_cond_destroy (&shard->cond);
+                }
+                free (event_pool->shards);
+                free (event_pool);
+        }
+        return NULL;
+}
+
+
+/* 每个分片一个线程，线程数在创建时确定 */
+static int
+event_dispatch_shard (struct event_pool *event_pool)
+{
+        int                       i = 0;
+        pthread_t                 t_id;
+        pthread_t                 t_first = 0;
+        int                       ret = -1;
+
+        pthread_mutex_lock (&event_pool->mutex);
+        {
+                event_pool->activethreadcount++;
+
+                for (i = 0; i < event_pool->shardcount; i++) {
+                        ret = pthread_create (&t_id, NULL,
+                                              event_dispatch_shard_worker,
+                                              &event_pool->shards[i]);
+                        if (ret) {
+                                /* fd已经分配到这个线程上，不能跳过 */
+                                LOG_PRINT(D_LOG_ERR,
+                                        "Failed to start thread for index %d",
+                                        i);
+                                break;
+                        }
+
+                        event_pool->pollers[i] = t_id;
+                        if (i != 0)
+                                pthread_detach (t_id);
+                        else
+                                t_first = t_id;
+                }
+        }
+        pthread_mutex_unlock (&event_pool->mutex);
+
+        if (t_first != 0)
+		pthread_join (t_first, NULL);
+
+        pthread_mutex_lock (&event_pool->mutex);
+        {
+                event_pool->activethreadcount--;
+        }
+        pthread_mutex_unlock (&event_pool->mutex);
+
+	return ret;
+}
+
+
+/* 分片模式下fd固定在线程上，只支持在destroy模式下减到0 */
+static int
+event_reconfigure_threads_shard (struct event_pool *event_pool, int value)
+{
+        uint64_t one = 1;
+        int      i = 0;
+
+        pthread_mutex_lock (&event_pool->mutex);
+        {
+                if (event_pool->destroy == 1) {
+                        event_pool->eventthreadcount = 0;
+                        for (i = 0; i < event_pool->shardcount; i++) {
+                                event_pool->shards[i].stop = 1;
+                                if (write (event_pool->shards[i].wakefd, &one,
+                                           sizeof (one)) == -1)
+                                        LOG_PRINT(D_LOG_ERR,
+                                                  "failed to wake thread %d",
+                                                  i);
+                        }
+                } else if (value != event_pool->eventthreadcount) {
+                        LOG_PRINT(D_LOG_WARN, "thread count of a sharded "
+                                  "event pool is fixed at %d",
+                                  event_pool->shardcount);
+                }
+        }
+        pthread_mutex_unlock (&event_pool->mutex);
+
+        return 0;
+}
+
+
+/* 在event_dispatch_destroy之后调用，线程都已退出 */
+static int
+event_pool_destroy_shard (struct event_pool *event_pool)
+{
+        struct event_shard *shard = NULL;
+        int                 ret = 0;
+        int                 i = 0;
+
+        for (i = 0; i < event_pool->shardcount; i++) {
+                shard = &event_pool->shards[i];
+                ret |= close (shard->epfd);
+                close (shard->wakefd);
+                free (shard->slots);
+                pthread_mutex_destroy (&shard->mutex);
+                pthread_cond_destroy (&shard->cond);
+        }
+        free (event_pool->shards);
+
+        pthread_mutex_destroy (&event_pool->mutex);
+        pthread_cond_destroy (&event_pool->cond);
+
+        free (event_pool);
+
+        return ret;
+}
+
+struct event_ops event_ops_epoll_shard = {
+        .new                       = event_pool_new_shard,
+        .event_register            = event_register_shard,
+        .event_select_on           = event_select_on_shard,
+        .event_unregister          = event_unregister_shard,
+        .event_unregister_close    = event_unregister_close_shard,
+        .event_dispatch            = event_dispatch_shard,
+        .event_reconfigure_threads = event_reconfigure_threads_shard,
+        .event_pool_destroy        = event_pool_destroy_shard,
+        .event_register_on         = event_register_on_shard
+};
+
+#endif
@@ -24,6 +24,8 @@ struct event_slot_epoll {
 	int ref;
 	int do_close;
 	int in_handler;
+	int pending; /* 批量模式下，其他线程处理期间到达的事件，由当前处理线程接着处理 */
+	int armed; /* 最近一次通过epoll_ctl设置到内核的事件 */
 	void *data; /* 用户数据，与struct epoll_event中的data不一样*/
 	event_handler_t handler; /*处理函数*/
 	gf_lock_t lock;
@@ -255,6 +257,8 @@ event_pool_new_epoll (int count, int eventthreadcount)
 
         event_pool->eventthreadcount = eventthreadcount;
 
+        event_pool->batchsize = 1;
+
         pthread_mutex_init (&event_pool->mutex, NULL);
 
 out:
@@ -368,6 +372,8 @@ event_register_epoll (struct event_pool *event_pool, int fd,
 
 		ret = epoll_ctl (event_pool->fd, EPOLL_CTL_ADD, fd,
 				 &epoll_event);
+		if (ret == 0)
+			slot->armed = slot->events;
 		/* check ret after UNLOCK() to avoid deadlock in
 		   event_slot_unref()
 		*/
@@ -493,6 +499,8 @@ event_select_on_epoll (struct event_pool *event_pool, int fd, int idx,
 			LOG_PRINT(D_LOG_ERR,
 				"failed to modify fd(=%d) events to %d",
 				fd, epoll_event.events);
+		} else {
+			slot->armed = slot->events;
 		}
 	}
 unlock:
@@ -591,6 +599,8 @@ pre_unlock:
 						// 多线程不能在调用处理函数时调用epoll_ctl,会导致另一个线程被唤醒，抢占同一个fd
 						// 每次调用event_dispatch_epoll_handler都要调用EPOLL_CTL_MOD
                         ret = epoll_ctl (event_pool->fd, EPOLL_CTL_MOD, fd, event);
+                        if (ret == 0)
+                                slot->armed = slot->events;
                 }
 	}
 post_unlock:
@@ -602,11 +612,118 @@ out:
 }
 
 
+/* 批量模式的事件处理函数
+ * 同一个slot同一时刻只允许一个线程执行handler(与EPOLLONESHOT效果相同)：
+ * 如果事件到达时已有线程在处理，只把事件记到slot->pending里，
+ * 由正在处理的线程在handler返回后接着处理，多个事件合并成一次。
+ * fd是边缘触发注册的，不需要每个事件都EPOLL_CTL_MOD重新装填，
+ * 只有handler期间event_select_on改了监听事件时才补一次EPOLL_CTL_MOD。
+ * 注意：handler必须把数据读到EAGAIN，否则不会再次触发 */
+static int
+event_dispatch_epoll_handler_batch (struct event_pool *event_pool,
+                                    struct epoll_event *event)
+{
+        struct event_data  *ev_data = NULL;
+	struct event_slot_epoll *slot = NULL;
+        struct epoll_event  epoll_event = {0, };
+        struct event_data  *new_data = (void *)&epoll_event.data;
+        event_handler_t     handler = NULL;
+        void               *data = NULL;
+        int                 events = 0;
+        int                 idx = -1;
+	int                 gen = -1;
+        int                 ret = -1;
+	int                 fd = -1;
+
+	ev_data = (void *)&event->data;
+
+	idx = ev_data->idx;
+	gen = ev_data->gen;
+        events = event->events;
+
+	slot = event_slot_get (event_pool, idx);
+
+	LOCK (&slot->lock);
+	{
+		fd = slot->fd;
+		if (fd == -1 || gen != slot->gen)
+			/* fd已注销或slot已被重用，丢弃该事件 */
+			goto pre_unlock;
+
+		if (slot->in_handler) {
+			/* 其他线程正在处理，交给它处理 */
+			slot->pending |= events;
+			ret = 0;
+			goto pre_unlock;
+		}
+
+		handler = slot->handler;
+		data = slot->data;
+
+		slot->in_handler++;
+	}
+pre_unlock:
+	UNLOCK (&slot->lock);
+
+        if (!handler)
+		goto out;
+
+	for (;;) {
+		ret = handler (fd, idx, data,
+			       (events & (EPOLLIN|EPOLLPRI)),
+			       (events & (EPOLLOUT)),
+			       (events & (EPOLLERR|EPOLLHUP)));
+
+		LOCK (&slot->lock);
+		{
+			if (gen != slot->gen) {
+				/* handler期间fd被注销了 */
+				slot->in_handler--;
+				slot->pending = 0;
+				events = 0;
+				goto post_unlock;
+			}
+
+			events = slot->pending;
+			slot->pending = 0;
+			if (events)
+				/* 处理期间又有新事件，继续持有slot */
+				goto post_unlock;
+
+			slot->in_handler--;
+
+			/* 合并装填：只有监听事件变化了才调用epoll_ctl */
+			if (slot->events != slot->armed) {
+				epoll_event.events = slot->events;
+				new_data->idx = idx;
+				new_data->gen = slot->gen;
+				ret = epoll_ctl (event_pool->fd, EPOLL_CTL_MOD,
+						 fd, &epoll_event);
+				if (ret == 0)
+					slot->armed = slot->events;
+			}
+		}
+post_unlock:
+		UNLOCK (&slot->lock);
+
+		if (!events)
+			break;
+	}
+out:
+	event_slot_unref (event_pool, slot, idx);
+
+        return ret;
+}
+
+
 static void *
 event_dispatch_epoll_worker (void *data)
 {
         struct epoll_event  event;
+        struct epoll_event *events = NULL;
         int                 ret = -1;
+        int                 i = 0;
+        int                 batchsize = 1;
         struct event_thread_data *ev_data = data;
 	struct event_pool  *event_pool;
         int                 myindex = -1;
@@ -624,9 +741,21 @@ event_dispatch_epoll_worker (void *data)
         pthread_mutex_lock (&event_pool->mutex);
         {
                 event_pool->activethreadcount++;
+                batchsize = event_pool->batchsize;
         }
         pthread_mutex_unlock (&event_pool->mutex);
 
+        if (batchsize > 1) {
+                /* 每个线程自己的事件缓存，分配失败就退回逐个模式 */
+                events = calloc (batchsize, sizeof (*events));
+                if (!events) {
+                        LOG_PRINT(D_LOG_WARN, "Allocation failure for "
+                                  "event batch of %d, thread index %d",
+                                  batchsize, myindex);
+                        batchsize = 1;
+                }
+        }
+
 	for (;;) {
                 if (event_pool->eventthreadcount < myindex) {
                         /* ...time to die, thread count was decreased below
@@ -654,8 +783,23 @@ event_dispatch_epoll_worker (void *data)
                         }
                 }
 
+                if (batchsize > 1) {
+                        /* 批量模式：一次收取多个事件 */
+                        ret = epoll_wait (event_pool->fd, events, batchsize,
+                                          event_timer_timeout (event_pool,
+                                                               myindex));
+                        for (i = 0; i < ret; i++)
+                                event_dispatch_epoll_handler_batch (event_pool,
+                                                                    &events[i]);
+                        event_timers_run (event_pool);
+                        continue;
+                }
+
                 //每次只返回一个事件，多个线程同时进行
-                ret = epoll_wait (event_pool->fd, &event, 1, -1);
+                ret = epoll_wait (event_pool->fd, &event, 1,
+                                  event_timer_timeout (event_pool, myindex));
+
+                event_timers_run (event_pool);
 
                 if (ret == 0)
                         /* timeout */
@@ -668,6 +812,7 @@ event_dispatch_epoll_worker (void *data)
 		ret = event_dispatch_epoll_handler (event_pool, &event);
         }
 out:
+        free (events);
         if (ev_data)
                 free (ev_data);
         return NULL;
@@ -462,6 +462,8 @@ event_dispatch_poll (struct event_pool *event_pool)
 
                 ret = poll (ufds, size, 1);
 
+                event_timers_run (event_pool);
+
                 if (ret == 0)
                         /* timeout */
                         continue;
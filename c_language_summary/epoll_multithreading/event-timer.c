@@ -0,0 +1,542 @@
+#include <sys/eventfd.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+#include "../debug/debug.h"
+#include "event.h"
+#include "locking.h"
+
+
+/* 分层时间轮(同早期linux内核的timer wheel)：
+ * tick为1ms，tv1有256个槽，直接按到期tick挂；tv2-tv5各64个槽，
+ * 每一层的范围是上一层的64倍，tv1转完一圈时把tv2当前槽里的定时器
+ * 重新分配到tv1(cascade)，依此类推，最远约49天，更远的挂在tv5最后并重复cascade。
+ * 添加和删除都是O(1)，时间轮本身只有512个链表头，定时器由调用者分配，
+ * 百万个定时器也只占调用者自己的内存。
+ *
+ * 到期由poller线程处理：每个线程epoll_wait返回后调用event_timers_run，
+ * 只有一个线程(owner)用最近的到期时间作为epoll_wait超时，其他线程仍然是-1，
+ * 不会所有线程一起定时醒来。非poller线程添加了更早到期的定时器时，
+ * 写eventfd唤醒一个线程重新计算超时。
+ */
+
+#define TVN_BITS        6
+#define TVR_BITS        8
+#define TVN_SIZE        (1 << TVN_BITS)
+#define TVR_SIZE        (1 << TVR_BITS)
+#define TVN_MASK        (TVN_SIZE - 1)
+#define TVR_MASK        (TVR_SIZE - 1)
+#define TV_LEVELS       4
+#define TV_MAX_TICKS    ((uint64_t)UINT32_MAX)
+
+#define TIMER_NEVER     UINT64_MAX
+
+/* event_timer.pending */
+#define EVENT_TIMER_WHEEL       1 /* 在时间轮里 */
+#define EVENT_TIMER_EXPIRED     2 /* 已到期，在expired上等待调用回调 */
+
+struct event_timer_wheel {
+        gf_lock_t         lock;
+        struct timespec   start;      /* tick 0 对应的时间 */
+        uint64_t          jiffies;    /* 下一个要处理的tick */
+        uint64_t          next_wake;  /* 下一个需要处理的tick(到期或cascade) */
+        int               count;      /* 在时间轮里的定时器数，不含expired */
+
+        int               owner;      /* 用next_wake作为超时的poller线程 */
+        uint64_t          owner_deadline;
+
+        int               wakefd;
+        int               wakeidx;
+
+        struct list_head  expired;    /* 已到期，等待调用回调 */
+        uint64_t          tv1map[TVR_SIZE / 64];
+        struct list_head  tv1[TVR_SIZE];
+        struct list_head  tvn[TV_LEVELS][TVN_SIZE];
+};
+
+/* 当前线程是哪个事件池的poller，以及在event_timer_timeout里的编号，
+ * 编号为0表示同一时刻只有一个线程等待(io_uring的leader) */
+static __thread struct event_pool *timer_pool = NULL;
+static __thread int                timer_thread = -1;
+
+
+static uint64_t
+wheel_now (struct event_timer_wheel *wheel)
+{
+        struct timespec ts;
+
+        clock_gettime (CLOCK_MONOTONIC, &ts);
+
+        return (uint64_t)(ts.tv_sec - wheel->start.tv_sec) * 1000 +
+               (ts.tv_nsec - wheel->start.tv_nsec) / 1000000;
+}
+
+
+/* jiffies之后(含)tv1转完一圈、需要cascade的tick */
+static inline uint64_t
+wheel_boundary (uint64_t jiffies)
+{
+        if ((jiffies & TVR_MASK) == 0)
+                return jiffies;
+        return (jiffies | TVR_MASK) + 1;
+}
+
+
+static void
+__wheel_add (struct event_timer_wheel *wheel, struct event_timer *timer)
+{
+        uint64_t expires = timer->expires;
+        uint64_t idx = 0;
+        int      i = 0;
+
+        if (expires < wheel->jiffies)
+                expires = wheel->jiffies;
+        idx = expires - wheel->jiffies;
+
+        if (idx < TVR_SIZE) {
+                i = expires & TVR_MASK;
+                list_add_tail (&timer->list, &wheel->tv1[i]);
+                wheel->tv1map[i / 64] |= 1ULL << (i % 64);
+                if (expires < wheel->next_wake)
+                        wheel->next_wake = expires;
+                return;
+        }
+
+        if (idx > TV_MAX_TICKS) {
+                idx = TV_MAX_TICKS;
+                expires = wheel->jiffies + idx;
+        }
+
+        for (i = 0; i < TV_LEVELS - 1; i++) {
+                if (idx < 1ULL << (TVR_BITS + (i + 1) * TVN_BITS))
+                        break;
+        }
+        list_add_tail (&timer->list,
+                       &wheel->tvn[i][(expires >> (TVR_BITS + i * TVN_BITS)) &
+                                      TVN_MASK]);
+
+        if (wheel_boundary (wheel->jiffies) < wheel->next_wake)
+                wheel->next_wake = wheel_boundary (wheel->jiffies);
+}
+
+
+/* 把第level层当前槽里的定时器重新分配到下面的层，返回槽号，
+ * 为0表示这一层也转完了一圈，需要继续cascade上一层 */
+static int
+__wheel_cascade (struct event_timer_wheel *wheel, int level)
+{
+        struct event_timer *timer = NULL;
+        struct event_timer *tmp = NULL;
+        struct list_head    head;
+        int                 index = 0;
+
+        index = (wheel->jiffies >> (TVR_BITS + level * TVN_BITS)) & TVN_MASK;
+
+        INIT_LIST_HEAD (&head);
+        list_splice_init (&wheel->tvn[level][index], &head);
+
+        list_for_each_entry_safe (timer, tmp, &head, list) {
+                list_del (&timer->list);
+                __wheel_add (wheel, timer);
+        }
+
+        return index;
+}
+
+
+/* 从jiffies开始找下一个需要处理的tick：tv1里下一个非空的槽或者下一次cascade */
+static uint64_t
+__wheel_next (struct event_timer_wheel *wheel)
+{
+        uint64_t boundary = 0;
+        uint64_t word = 0;
+        int      cur = 0;
+        int      i = 0;
+
+        if (wheel->count == 0)
+                return TIMER_NEVER;
+
+        boundary = wheel_boundary (wheel->jiffies);
+        cur = wheel->jiffies & TVR_MASK;
+
+        /* 槽号小于cur的属于下一圈，在cascade之后 */
+        for (i = cur; i < TVR_SIZE; ) {
+                word = wheel->tv1map[i / 64] >> (i % 64);
+                if (!word) {
+                        i = (i / 64 + 1) * 64;
+                        continue;
+                }
+                i += __builtin_ctzll (word);
+                if (!list_empty (&wheel->tv1[i]))
+                        break;
+                /* 定时器已经删除了，删除时不清位图 */
+                wheel->tv1map[i / 64] &= ~(1ULL << (i % 64));
+                i++;
+        }
+
+        if (i < TVR_SIZE && wheel->jiffies + (i - cur) < boundary)
+                return wheel->jiffies + (i - cur);
+
+        return boundary;
+}
+
+
+/* 处理到now为止的所有tick，到期的定时器挂到expired */
+static void
+__wheel_advance (struct event_timer_wheel *wheel, uint64_t now)
+{
+        struct event_timer *timer = NULL;
+        int                 index = 0;
+        int                 level = 0;
+
+        while (wheel->jiffies <= now) {
+                /* next_wake之前既没有到期的定时器也不需要cascade，直接跳过 */
+                if (wheel->jiffies < wheel->next_wake) {
+                        if (wheel->next_wake > now) {
+                                wheel->jiffies = now + 1;
+                                break;
+                        }
+                        wheel->jiffies = wheel->next_wake;
+                }
+
+                index = wheel->jiffies & TVR_MASK;
+                if (index == 0) {
+                        for (level = 0; level < TV_LEVELS; level++) {
+                                if (__wheel_cascade (wheel, level) != 0)
+                                        break;
+                        }
+                }
+
+                list_for_each_entry (timer, &wheel->tv1[index], list) {
+                        timer->pending = EVENT_TIMER_EXPIRED;
+                        wheel->count--;
+                }
+                list_append_init (&wheel->tv1[index], &wheel->expired);
+                wheel->tv1map[index / 64] &= ~(1ULL << (index % 64));
+
+                wheel->jiffies++;
+                wheel->next_wake = __wheel_next (wheel);
+        }
+
+        wheel->next_wake = __wheel_next (wheel);
+}
+
+
+static int
+event_timer_wake_handler (int fd, int idx, void *data,
+                          int poll_in, int poll_out, int poll_err)
+{
+        uint64_t val = 0;
+
+        /* 只是为了让线程从epoll_wait返回，重新计算超时 */
+        while (read (fd, &val, sizeof (val)) == sizeof (val))
+                ;
+
+        return 0;
+}
+
+
+int
+event_timer_wheel_init (struct event_pool *event_pool)
+{
+        struct event_timer_wheel *wheel = NULL;
+        int                       i = 0;
+        int                       j = 0;
+
+        GF_VALIDATE_OR_GOTO ("event", event_pool, err);
+
+        wheel = calloc (1, sizeof (*wheel));
+        if (!wheel) {
+                LOG_PRINT(D_LOG_ERR, "Allocation failure for timer wheel");
+                goto err;
+        }
+
+        LOCK_INIT (&wheel->lock);
+        clock_gettime (CLOCK_MONOTONIC, &wheel->start);
+        wheel->next_wake = TIMER_NEVER;
+        wheel->owner_deadline = TIMER_NEVER;
+        wheel->wakeidx = -1;
+
+        INIT_LIST_HEAD (&wheel->expired);
+        for (i = 0; i < TVR_SIZE; i++)
+                INIT_LIST_HEAD (&wheel->tv1[i]);
+        for (i = 0; i < TV_LEVELS; i++)
+                for (j = 0; j < TVN_SIZE; j++)
+                        INIT_LIST_HEAD (&wheel->tvn[i][j]);
+
+        wheel->wakefd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wheel->wakefd == -1) {
+                LOG_PRINT(D_LOG_ERR, "eventfd() failed (%s)", strerror (errno));
+                goto err;
+        }
+
+        event_pool->timers = wheel;
+
+        wheel->wakeidx = event_register (event_pool, wheel->wakefd,
+                                         event_timer_wake_handler, wheel,
+                                         1, 0);
+        if (wheel->wakeidx == -1) {
+                LOG_PRINT(D_LOG_ERR, "failed to register timer eventfd");
+                event_pool->timers = NULL;
+                goto err;
+        }
+
+        return 0;
+err:
+        if (wheel) {
+                if (wheel->wakefd != -1)
+                        close (wheel->wakefd);
+                LOCK_DESTROY (&wheel->lock);
+                free (wheel);
+        }
+        return -1;
+}
+
+
+/* 在poller线程都退出之后调用，时间轮里剩下的定时器不再调用回调 */
+void
+event_timer_wheel_fini (struct event_pool *event_pool)
+{
+        struct event_timer_wheel *wheel = NULL;
+
+        if (!event_pool || !event_pool->timers)
+                return;
+
+        wheel = event_pool->timers;
+
+        event_unregister_close (event_pool, wheel->wakefd, wheel->wakeidx);
+
+        event_pool->timers = NULL;
+        LOCK_DESTROY (&wheel->lock);
+        free (wheel);
+}
+
+
+void
+event_timer_init (struct event_timer *timer, event_timer_cbk_t cbk,
+                  void *data)
+{
+        INIT_LIST_HEAD (&timer->list);
+        timer->expires = 0;
+        timer->cbk = cbk;
+        timer->data = data;
+        timer->pending = 0;
+}
+
+
+/* 添加定时器，timeout_ms后在某个poller线程里调用回调，
+ * 定时器已经在时间轮里时改为新的到期时间 */
+int
+event_timer_add (struct event_pool *event_pool, struct event_timer *timer,
+                 uint64_t timeout_ms)
+{
+        struct event_timer_wheel *wheel = NULL;
+        uint64_t                  now = 0;
+        uint64_t                  val = 1;
+        int                       wake = 0;
+        int                       ret = -1;
+
+        GF_VALIDATE_OR_GOTO ("event", event_pool, out);
+        GF_VALIDATE_OR_GOTO ("event", event_pool->timers, out);
+        GF_VALIDATE_OR_GOTO ("event", timer, out);
+        GF_VALIDATE_OR_GOTO ("event", timer->cbk, out);
+
+        wheel = event_pool->timers;
+
+        LOCK (&wheel->lock);
+        {
+                now = wheel_now (wheel);
+                if (timeout_ms > TIMER_NEVER - now)
+                        timeout_ms = TIMER_NEVER - now - 1;
+
+                if (timer->pending)
+                        list_del (&timer->list);
+
+                timer->expires = now + timeout_ms;
+                timer->pending = EVENT_TIMER_WHEEL;
+                wheel->count++;
+                __wheel_add (wheel, timer);
+
+                /* 调用者是独立等待的poller线程时，它在下次epoll_wait之前
+                 * 会自己重新计算超时，不用唤醒 */
+                if (wheel->next_wake < wheel->owner_deadline &&
+                    !(timer_pool == event_pool && timer_thread > 0)) {
+                        /* 被唤醒的线程接手，在此之前不再重复唤醒 */
+                        wheel->owner = 0;
+                        wheel->owner_deadline = wheel->next_wake;
+                        wake = 1;
+                }
+        }
+        UNLOCK (&wheel->lock);
+
+        if (wake && write (wheel->wakefd, &val, sizeof (val)) == -1 &&
+            errno != EAGAIN)
+                LOG_PRINT(D_LOG_ERR, "timer wakeup failed (%s)",
+                          strerror (errno));
+
+        ret = 0;
+out:
+        return ret;
+}
+
+
+/* 删除定时器，返回1表示删除时还没有到期，0表示不在时间轮里
+ * (没有添加、已经删除或者回调已经开始执行) */
+int
+event_timer_cancel (struct event_pool *event_pool, struct event_timer *timer)
+{
+        struct event_timer_wheel *wheel = NULL;
+        int                       ret = -1;
+
+        GF_VALIDATE_OR_GOTO ("event", event_pool, out);
+        GF_VALIDATE_OR_GOTO ("event", event_pool->timers, out);
+        GF_VALIDATE_OR_GOTO ("event", timer, out);
+
+        wheel = event_pool->timers;
+
+        LOCK (&wheel->lock);
+        {
+                ret = (timer->pending != 0);
+                if (timer->pending) {
+                        list_del_init (&timer->list);
+                        if (timer->pending == EVENT_TIMER_WHEEL)
+                                wheel->count--;
+                        timer->pending = 0;
+                }
+        }
+        UNLOCK (&wheel->lock);
+out:
+        return ret;
+}
+
+
+int
+event_timer_count (struct event_pool *event_pool)
+{
+        struct event_timer_wheel *wheel = NULL;
+        int                       ret = -1;
+
+        GF_VALIDATE_OR_GOTO ("event", event_pool, out);
+        GF_VALIDATE_OR_GOTO ("event", event_pool->timers, out);
+
+        wheel = event_pool->timers;
+
+        LOCK (&wheel->lock);
+        {
+                ret = wheel->count;
+        }
+        UNLOCK (&wheel->lock);
+out:
+        return ret;
+}
+
+
+/* poller线程在等待事件之前调用，返回等待的超时(毫秒，-1为一直等待)。
+ * thread为线程编号(从1开始)，多个线程各自等待时只有一个线程(owner)
+ * 用到期时间作为超时：没有owner、owner的超时已经过了(忙于处理事件)或者
+ * 有比owner的超时更早到期的定时器时，由当前线程接手。
+ * thread为0表示同一时刻只有调用者在等待，总是使用到期时间 */
+int
+event_timer_timeout (struct event_pool *event_pool, int thread)
+{
+        struct event_timer_wheel *wheel = NULL;
+        uint64_t                  now = 0;
+        uint64_t                  next = 0;
+        int                       ret = -1;
+
+        if (!event_pool || !event_pool->timers)
+                return -1;
+
+        wheel = event_pool->timers;
+        timer_pool = event_pool;
+        timer_thread = thread;
+
+        LOCK (&wheel->lock);
+        {
+                now = wheel_now (wheel);
+                next = wheel->next_wake;
+                /* 其他线程还在执行到期的回调，event_timers_run会帮着执行 */
+                if (!list_empty (&wheel->expired))
+                        next = now;
+
+                if (thread == 0 || wheel->owner == 0 ||
+                    wheel->owner == thread || next < wheel->owner_deadline ||
+                    wheel->owner_deadline <= now) {
+                        wheel->owner = thread;
+                        wheel->owner_deadline = next;
+
+                        if (next == TIMER_NEVER)
+                                ret = -1;
+                        else if (next <= now)
+                                ret = 0;
+                        else if (next - now > INT_MAX)
+                                ret = INT_MAX;
+                        else
+                                ret = next - now;
+                }
+        }
+        UNLOCK (&wheel->lock);
+
+        return ret;
+}
+
+
+/* poller线程从epoll_wait返回后调用，执行到期定时器的回调 */
+void
+event_timers_run (struct event_pool *event_pool)
+{
+        struct event_timer_wheel *wheel = NULL;
+        struct event_timer       *timer = NULL;
+        event_timer_cbk_t         cbk = NULL;
+        void                     *data = NULL;
+
+        if (!event_pool || !event_pool->timers)
+                return;
+
+        wheel = event_pool->timers;
+        timer_pool = event_pool;
+
+        /* 大部分返回是fd事件，不加锁先比较一下。expired不空时
+         * event_timer_timeout给了超时0，要一起取回调执行，不能直接返回，
+         * 否则这个线程会一直用超时0空转，直到别的线程执行完 */
+        if (wheel_now (wheel) <
+            __atomic_load_n (&wheel->next_wake, __ATOMIC_RELAXED) &&
+            __atomic_load_n (&wheel->expired.next, __ATOMIC_RELAXED) ==
+            &wheel->expired)
+                return;
+
+        LOCK (&wheel->lock);
+        {
+                __wheel_advance (wheel, wheel_now (wheel));
+        }
+        UNLOCK (&wheel->lock);
+
+        /* 一次取一个：回调里可以重新添加自己，其他线程也可以在回调
+         * 开始之前把它删掉 */
+        for (;;) {
+                timer = NULL;
+                LOCK (&wheel->lock);
+                {
+                        if (!list_empty (&wheel->expired)) {
+                                timer = list_entry (wheel->expired.next,
+                                                    struct event_timer, list);
+                                list_del_init (&timer->list);
+                                timer->pending = 0;
+                                cbk = timer->cbk;
+                                data = timer->data;
+                        }
+                }
+                UNLOCK (&wheel->lock);
+
+                if (!timer)
+                        break;
+
+                cbk (timer, data);
+        }
+}
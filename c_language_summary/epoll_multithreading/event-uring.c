@@ -0,0 +1,1185 @@
+
+#include <sys/poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+
+#include "../debug/debug.h"
+#include "event.h"
+#include "locking.h"
+
+
+#ifdef HAVE_IO_URING
+#include <linux/io_uring.h>
+
+/* io_uring后端：
+ * batchsize为1(默认)时每个fd提交单次poll，效果同EPOLLONESHOT，
+ * handler返回后重新提交poll(会重新检查是否就绪，handler不必读完数据)，
+ * 但重新提交的SQE不单独调用io_uring_enter，而是跟下一次收取CQE的
+ * io_uring_enter一起提交，省掉epoll每个事件一次的EPOLL_CTL_MOD。
+ * batchsize大于1时提交multishot poll(IORING_POLL_ADD_MULTI)，
+ * 就绪一次内核产生一个CQE，poll一直有效，只有CQE不带IORING_CQE_F_MORE
+ * 或者监听事件变化时才重新提交，handler需要把数据读到EAGAIN(同epoll批量模式)。
+ * 所有线程共用一个环，按leader/follower方式轮流收取CQE：
+ * 拿到cq_lock的线程收一批CQE，放锁后再处理，没有CQE就带锁阻塞在
+ * io_uring_enter里，其他线程在cq_lock上等。
+ * 同一个slot同一时刻只由一个线程执行handler(同epoll批量模式的pending)。
+ * 没有用liburing，直接用系统调用；multishot的accept/recv和provided buffer
+ * 需要改变handler自己读fd的接口，没有做。
+ */
+
+#define EVENT_URING_MAX_ENTRIES    4096
+#define EVENT_URING_IGNORE         ((uint64_t)-1) /* poll remove的CQE */
+#define EVENT_URING_WAKE           ((uint64_t)-2) /* 唤醒线程用的NOP */
+
+/* user_data = armseq << 32 | idx，armseq每次提交poll都递增，
+ * 旧poll的CQE(被remove或slot已重用)按armseq不匹配丢弃 */
+#define EVENT_URING_UDATA(idx, seq) (((uint64_t)(uint32_t)(seq) << 32) | \
+                                     (uint32_t)(idx))
+
+struct event_slot_uring {
+	int fd;
+	int events; /* 需要监听的事件，POLLIN/POLLOUT */
+	int armed;  /* 当前内核里有效的poll的事件，0为没有 */
+	int armseq;
+	int broken; /* poll出错，不再重新提交 */
+	int gen;
+	int ref;
+	int do_close;
+	int in_handler;
+	int pending;
+	void *data;
+	event_handler_t handler;
+	gf_lock_t lock;
+};
+
+struct event_uring {
+        int                 ring_fd;
+        unsigned            features;
+
+        /* SQ */
+        unsigned           *sq_head;
+        unsigned           *sq_tail;
+        unsigned           *sq_mask;
+        unsigned           *sq_array;
+        unsigned            sq_entries;
+        struct io_uring_sqe *sqes;
+        void               *sq_ring;
+        size_t              sq_ring_size;
+        size_t              sqes_size;
+
+        /* CQ */
+        unsigned           *cq_head;
+        unsigned           *cq_tail;
+        unsigned           *cq_mask;
+        struct io_uring_cqe *cqes;
+        void               *cq_ring;
+        size_t              cq_ring_size;
+
+        pthread_mutex_t     sq_lock; /* 提交SQE */
+        pthread_mutex_t     cq_lock; /* 收取CQE(leader) */
+
+        struct event_slot_uring *ereg[EVENT_EPOLL_TABLES];
+        int                 slots_used[EVENT_EPOLL_TABLES];
+};
+
+struct event_thread_data {
+        struct event_pool *event_pool;
+        int    event_index;
+};
+
+
+static int
+__sys_io_uring_setup (unsigned entries, struct io_uring_params *p)
+{
+        return syscall (__NR_io_uring_setup, entries, p);
+}
+
+
+static int
+__sys_io_uring_enter (int fd, unsigned to_submit, unsigned min_complete,
+                      unsigned flags)
+{
+        return syscall (__NR_io_uring_enter, fd, to_submit, min_complete,
+                        flags, NULL, 0);
+}
+
+
+/* 带超时的等待(IORING_FEAT_EXT_ARG)，timeout_ms为-1时一直等待，
+ * 超时返回-1，errno为ETIME */
+static int
+__sys_io_uring_wait (int fd, unsigned to_submit, unsigned min_complete,
+                     unsigned flags, int timeout_ms)
+{
+        struct io_uring_getevents_arg arg;
+        struct __kernel_timespec      ts;
+
+        if (timeout_ms < 0)
+                return __sys_io_uring_enter (fd, to_submit, min_complete,
+                                             flags);
+
+        memset (&arg, 0, sizeof (arg));
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (timeout_ms % 1000) * 1000000LL;
+        arg.ts = (uint64_t)(uintptr_t)&ts;
+
+        return syscall (__NR_io_uring_enter, fd, to_submit, min_complete,
+                        flags | IORING_ENTER_EXT_ARG, &arg, sizeof (arg));
+}
+
+
+static void
+uring_ring_unmap (struct event_uring *uring)
+{
+        if (uring->sqes && uring->sqes != MAP_FAILED)
+                munmap (uring->sqes, uring->sqes_size);
+        if (uring->cq_ring && uring->cq_ring != MAP_FAILED &&
+            uring->cq_ring != uring->sq_ring)
+                munmap (uring->cq_ring, uring->cq_ring_size);
+        if (uring->sq_ring && uring->sq_ring != MAP_FAILED)
+                munmap (uring->sq_ring, uring->sq_ring_size);
+        if (uring->ring_fd != -1)
+                close (uring->ring_fd);
+        uring->ring_fd = -1;
+}
+
+
+static int
+uring_ring_init (struct event_uring *uring, unsigned entries)
+{
+        struct io_uring_params p;
+        char                  *sq = NULL;
+        char                  *cq = NULL;
+
+        memset (&p, 0, sizeof (p));
+        p.flags = IORING_SETUP_CQSIZE;
+        p.cq_entries = entries * 4;
+
+        uring->ring_fd = __sys_io_uring_setup (entries, &p);
+        if (uring->ring_fd == -1) {
+                LOG_PRINT(D_LOG_ERR, "io_uring_setup failed (%s)",
+                          strerror (errno));
+                return -1;
+        }
+        uring->features = p.features;
+
+        uring->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof (unsigned);
+        uring->cq_ring_size = p.cq_off.cqes +
+                              p.cq_entries * sizeof (struct io_uring_cqe);
+        if (p.features & IORING_FEAT_SINGLE_MMAP) {
+                if (uring->cq_ring_size > uring->sq_ring_size)
+                        uring->sq_ring_size = uring->cq_ring_size;
+                uring->cq_ring_size = uring->sq_ring_size;
+        }
+
+        uring->sq_ring = mmap (NULL, uring->sq_ring_size,
+                               PROT_READ | PROT_WRITE,
+                               MAP_SHARED | MAP_POPULATE, uring->ring_fd,
+                               IORING_OFF_SQ_RING);
+        if (uring->sq_ring == MAP_FAILED)
+                goto err;
+
+        if (p.features & IORING_FEAT_SINGLE_MMAP)
+                uring->cq_ring = uring->sq_ring;
+        else
+                uring->cq_ring = mmap (NULL, uring->cq_ring_size,
+                                       PROT_READ | PROT_WRITE,
+                                       MAP_SHARED | MAP_POPULATE,
+                                       uring->ring_fd, IORING_OFF_CQ_RING);
+        if (uring->cq_ring == MAP_FAILED)
+                goto err;
+
+        uring->sqes_size = p.sq_entries * sizeof (struct io_uring_sqe);
+        uring->sqes = mmap (NULL, uring->sqes_size, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, uring->ring_fd,
+                            IORING_OFF_SQES);
+        if (uring->sqes == MAP_FAILED)
+                goto err;
+
+        sq = uring->sq_ring;
+        uring->sq_head = (unsigned *)(sq + p.sq_off.head);
+        uring->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+        uring->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+        uring->sq_array = (unsigned *)(sq + p.sq_off.array);
+        uring->sq_entries = p.sq_entries;
+
+        cq = uring->cq_ring;
+        uring->cq_head = (unsigned *)(cq + p.cq_off.head);
+        uring->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+        uring->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+        uring->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+        return 0;
+err:
+        LOG_PRINT(D_LOG_ERR, "io_uring mmap failed (%s)", strerror (errno));
+        uring_ring_unmap (uring);
+        return -1;
+}
+
+
+/* SQ里还没提交的SQE数。
+ * io_uring_enter的to_submit必须准确，提交数少于to_submit时内核不会等待CQE */
+static unsigned
+uring_sq_pending (struct event_uring *uring)
+{
+        return __atomic_load_n (uring->sq_tail, __ATOMIC_ACQUIRE) -
+               __atomic_load_n (uring->sq_head, __ATOMIC_ACQUIRE);
+}
+
+
+/* 取一个SQE，需持有sq_lock，SQ满时先提交 */
+static struct io_uring_sqe *
+__uring_get_sqe (struct event_uring *uring, unsigned *tail)
+{
+        struct io_uring_sqe *sqe = NULL;
+        unsigned             index = 0;
+
+        if (*tail - __atomic_load_n (uring->sq_head, __ATOMIC_ACQUIRE) >=
+            uring->sq_entries) {
+                __atomic_store_n (uring->sq_tail, *tail, __ATOMIC_RELEASE);
+                __sys_io_uring_enter (uring->ring_fd, uring_sq_pending (uring),
+                                      0, 0);
+        }
+
+        index = *tail & *uring->sq_mask;
+        sqe = &uring->sqes[index];
+        memset (sqe, 0, sizeof (*sqe));
+        uring->sq_array[index] = index;
+        (*tail)++;
+
+        return sqe;
+}
+
+
+/* 提交：poll_remove(old_udata)(old_udata非0时) + poll_add(new_udata)(events
+ * 非0时)，或者一个NOP(都为0时)。
+ * multishot为0时提交单次poll；defer为1时只放入SQ，由uring_flush或下一次
+ * 收取CQE的io_uring_enter提交 */
+static int
+uring_submit_poll (struct event_uring *uring, int fd, int events,
+                   uint64_t new_udata, uint64_t old_udata, int multishot,
+                   int defer)
+{
+        struct io_uring_sqe *sqe = NULL;
+        unsigned             tail = 0;
+        int                  ret = 0;
+
+        pthread_mutex_lock (&uring->sq_lock);
+        {
+                tail = *uring->sq_tail;
+
+                if (old_udata) {
+                        sqe = __uring_get_sqe (uring, &tail);
+                        sqe->opcode = IORING_OP_POLL_REMOVE;
+                        sqe->fd = -1;
+                        sqe->addr = old_udata;
+                        sqe->user_data = EVENT_URING_IGNORE;
+                }
+
+                if (events) {
+                        sqe = __uring_get_sqe (uring, &tail);
+                        sqe->opcode = IORING_OP_POLL_ADD;
+                        sqe->fd = fd;
+                        sqe->poll32_events = events;
+                        sqe->len = multishot ? IORING_POLL_ADD_MULTI : 0;
+                        sqe->user_data = new_udata;
+                }
+
+                if (!old_udata && !events) {
+                        sqe = __uring_get_sqe (uring, &tail);
+                        sqe->opcode = IORING_OP_NOP;
+                        sqe->user_data = EVENT_URING_WAKE;
+                }
+
+                __atomic_store_n (uring->sq_tail, tail, __ATOMIC_RELEASE);
+
+                while (!defer) {
+                        ret = __sys_io_uring_enter (uring->ring_fd,
+                                                    uring_sq_pending (uring),
+                                                    0, 0);
+                        if (ret != -1 || errno != EINTR)
+                                break;
+                }
+        }
+        pthread_mutex_unlock (&uring->sq_lock);
+
+        if (ret == -1) {
+                LOG_PRINT(D_LOG_ERR, "io_uring_enter submit failed (%s)",
+                          strerror (errno));
+                return -1;
+        }
+
+        return 0;
+}
+
+
+/* 提交SQ里延迟的SQE */
+static void
+uring_flush (struct event_uring *uring)
+{
+        pthread_mutex_lock (&uring->sq_lock);
+        {
+                if (uring_sq_pending (uring) &&
+                    __sys_io_uring_enter (uring->ring_fd,
+                                          uring_sq_pending (uring),
+                                          0, 0) == -1)
+                        LOG_PRINT(D_LOG_ERR, "io_uring_enter submit failed "
+                                  "(%s)", strerror (errno));
+        }
+        pthread_mutex_unlock (&uring->sq_lock);
+}
+
+
+/* 收取最多max个CQE，需持有cq_lock */
+static int
+__uring_reap (struct event_uring *uring, struct io_uring_cqe *cqes, int max)
+{
+        unsigned head = 0;
+        unsigned tail = 0;
+        int      n = 0;
+
+        head = *uring->cq_head;
+        tail = __atomic_load_n (uring->cq_tail, __ATOMIC_ACQUIRE);
+
+        while (head != tail && n < max) {
+                cqes[n++] = uring->cqes[head & *uring->cq_mask];
+                head++;
+        }
+
+        __atomic_store_n (uring->cq_head, head, __ATOMIC_RELEASE);
+
+        return n;
+}
+
+
+/* 检查内核是否支持multishot poll：
+ * 对一个pipe提交multishot poll，写入后CQE应该带IORING_CQE_F_MORE */
+static int
+uring_probe_multishot (struct event_uring *uring)
+{
+        struct io_uring_cqe cqe;
+        int                 fds[2] = {-1, -1};
+        int                 ret = -1;
+
+        if (pipe (fds) == -1)
+                return -1;
+
+        if (uring_submit_poll (uring, fds[0], POLLIN, 1, 0, 1, 0) == -1)
+                goto out;
+
+        if (write (fds[1], "x", 1) != 1)
+                goto out;
+
+        do {
+                ret = __sys_io_uring_enter (uring->ring_fd, 0, 1,
+                                            IORING_ENTER_GETEVENTS);
+        } while (ret == -1 && errno == EINTR);
+        if (ret == -1)
+                goto out;
+
+        ret = -1;
+        if (__uring_reap (uring, &cqe, 1) != 1)
+                goto out;
+
+        if (cqe.user_data == 1 && cqe.res > 0 &&
+            (cqe.flags & IORING_CQE_F_MORE))
+                ret = 0;
+        else
+                LOG_PRINT(D_LOG_WARN, "multishot poll not supported "
+                          "(res=%d flags=%u)", cqe.res, cqe.flags);
+
+        /* 取消poll，等它最后一个CQE(不带F_MORE)回来，保证环是干净的 */
+        uring_submit_poll (uring, -1, 0, 0, 1, 0, 0);
+        for (;;) {
+                if (__uring_reap (uring, &cqe, 1) == 1) {
+                        if (cqe.user_data == 1 &&
+                            !(cqe.flags & IORING_CQE_F_MORE))
+                                break;
+                        continue;
+                }
+                if (__sys_io_uring_enter (uring->ring_fd, 0, 1,
+                                          IORING_ENTER_GETEVENTS) == -1 &&
+                    errno != EINTR) {
+                        ret = -1;
+                        break;
+                }
+        }
+out:
+        if (fds[0] != -1)
+                close (fds[0]);
+        if (fds[1] != -1)
+                close (fds[1]);
+        return ret;
+}
+
+
+static struct event_slot_uring *
+__uring_newtable (struct event_uring *uring, int table_idx)
+{
+	struct event_slot_uring *table = NULL;
+	int                      i = -1;
+
+	table = calloc (sizeof (*table), EVENT_EPOLL_SLOTS);
+	if (!table)
+		return NULL;
+
+	for (i = 0; i < EVENT_EPOLL_SLOTS; i++) {
+		table[i].fd = -1;
+		LOCK_INIT (&table[i].lock);
+	}
+
+	uring->ereg[table_idx] = table;
+	uring->slots_used[table_idx] = 0;
+
+	return table;
+}
+
+
+/* 同event-epoll.c的__event_slot_alloc，需持有event_pool->mutex */
+static int
+__uring_slot_alloc (struct event_uring *uring, int fd)
+{
+	struct event_slot_uring *table = NULL;
+	struct event_slot_uring *slot = NULL;
+	int                      table_idx = -1;
+	int                      i = 0;
+
+	for (i = 0; i < EVENT_EPOLL_TABLES; i++) {
+		if (uring->slots_used[i] == EVENT_EPOLL_SLOTS)
+			continue;
+		table = uring->ereg[i];
+		if (!table)
+			table = __uring_newtable (uring, i);
+		break;
+	}
+
+	if (!table)
+		return -1;
+
+	table_idx = i;
+
+	for (i = 0; i < EVENT_EPOLL_SLOTS; i++) {
+		slot = &table[i];
+		if (slot->fd != -1)
+			continue;
+
+		/* 只有gen和armseq需要保留，其余清零 */
+		slot->gen++;
+		slot->armseq++;
+		slot->events = 0;
+		slot->armed = 0;
+		slot->broken = 0;
+		slot->ref = 0;
+		slot->do_close = 0;
+		slot->in_handler = 0;
+		slot->pending = 0;
+		slot->data = NULL;
+		slot->handler = NULL;
+		slot->fd = fd;
+		uring->slots_used[table_idx]++;
+		break;
+	}
+
+	return table_idx * EVENT_EPOLL_SLOTS + i;
+}
+
+
+static struct event_slot_uring *
+uring_slot_get (struct event_pool *event_pool, int idx)
+{
+	struct event_uring      *uring = event_pool->uring;
+	struct event_slot_uring *table = NULL;
+	struct event_slot_uring *slot = NULL;
+
+	if (idx < 0 || idx >= EVENT_EPOLL_TABLES * EVENT_EPOLL_SLOTS)
+		return NULL;
+
+	table = uring->ereg[idx / EVENT_EPOLL_SLOTS];
+	if (!table)
+		return NULL;
+
+	slot = &table[idx % EVENT_EPOLL_SLOTS];
+
+	LOCK (&slot->lock);
+	{
+		slot->ref++;
+	}
+	UNLOCK (&slot->lock);
+
+	return slot;
+}
+
+
+static void
+uring_slot_unref (struct event_pool *event_pool, struct event_slot_uring *slot,
+                  int idx)
+{
+	struct event_uring *uring = event_pool->uring;
+	int ref = -1;
+	int fd = -1;
+	int do_close = 0;
+
+	LOCK (&slot->lock);
+	{
+		ref = --slot->ref;
+		fd = slot->fd;
+		do_close = slot->do_close;
+	}
+	UNLOCK (&slot->lock);
+
+	if (ref)
+		return;
+
+	pthread_mutex_lock (&event_pool->mutex);
+	{
+		slot->fd = -1;
+		uring->slots_used[idx / EVENT_EPOLL_SLOTS]--;
+	}
+	pthread_mutex_unlock (&event_pool->mutex);
+
+	if (do_close)
+		close (fd);
+}
+
+
+static void
+__uring_update_events (struct event_slot_uring *slot, int poll_in,
+                       int poll_out)
+{
+	switch (poll_in) {
+	case 1:
+		slot->events |= POLLIN;
+		break;
+	case 0:
+		slot->events &= ~POLLIN;
+		break;
+	case -1:
+		/* do nothing */
+		break;
+	default:
+        LOG_PRINT(D_LOG_ERR, "invalid poll_in value %d", poll_in);
+		break;
+	}
+
+	switch (poll_out) {
+	case 1:
+		slot->events |= POLLOUT;
+		break;
+	case 0:
+		slot->events &= ~POLLOUT;
+		break;
+	case -1:
+		/* do nothing */
+		break;
+	default:
+        LOG_PRINT(D_LOG_ERR, "invalid poll_out value %d", poll_out);
+		break;
+	}
+}
+
+
+/* 监听事件和内核里的poll不一致(或者poll已终止)时重新提交，需持有slot->lock */
+static int
+__uring_slot_rearm (struct event_pool *event_pool,
+                    struct event_slot_uring *slot, int idx, int defer)
+{
+        uint64_t old_udata = 0;
+        int      ret = 0;
+
+        if (slot->broken || slot->armed == slot->events)
+                return 0;
+
+        if (slot->armed)
+                old_udata = EVENT_URING_UDATA (idx, slot->armseq);
+
+        slot->armseq++;
+        slot->armed = slot->events;
+
+        if (!old_udata && !slot->events)
+                return 0;
+
+        ret = uring_submit_poll (event_pool->uring, slot->fd, slot->events,
+                                 EVENT_URING_UDATA (idx, slot->armseq),
+                                 old_udata, event_pool->batchsize > 1, defer);
+        if (ret == -1)
+                slot->armed = 0;
+
+        return ret;
+}
+
+
+static struct event_pool *
+event_pool_new_uring (int count, int eventthreadcount)
+{
+        struct event_pool  *event_pool = NULL;
+        struct event_uring *uring = NULL;
+        unsigned            entries = 0;
+
+        event_pool = calloc (1, sizeof (*event_pool));
+        uring = calloc (1, sizeof (*uring));
+        if (!event_pool || !uring)
+                goto err;
+
+        uring->ring_fd = -1;
+        pthread_mutex_init (&uring->sq_lock, NULL);
+        pthread_mutex_init (&uring->cq_lock, NULL);
+
+        /* 每次最多提交两个SQE，SQ不需要很大；CQ为SQ的4倍 */
+        entries = count;
+        if (entries > EVENT_URING_MAX_ENTRIES)
+                entries = EVENT_URING_MAX_ENTRIES;
+        if (entries < 8)
+                entries = 8;
+
+        if (uring_ring_init (uring, entries) == -1)
+                goto err;
+
+        if (!(uring->features & IORING_FEAT_NODROP)) {
+                LOG_PRINT(D_LOG_WARN, "io_uring without IORING_FEAT_NODROP");
+                goto err;
+        }
+
+        /* 定时器需要带超时的io_uring_enter(5.11)，支持multishot的内核都有 */
+        if (!(uring->features & IORING_FEAT_EXT_ARG)) {
+                LOG_PRINT(D_LOG_WARN, "io_uring without IORING_FEAT_EXT_ARG");
+                goto err;
+        }
+
+        if (uring_probe_multishot (uring) == -1)
+                goto err;
+
+        event_pool->uring = uring;
+        event_pool->fd = uring->ring_fd;
+        event_pool->count = count;
+        event_pool->eventthreadcount = eventthreadcount;
+        event_pool->batchsize = 1;
+
+        pthread_mutex_init (&event_pool->mutex, NULL);
+        pthread_cond_init (&event_pool->cond, NULL);
+
+        return event_pool;
+err:
+        if (uring) {
+                uring_ring_unmap (uring);
+                pthread_mutex_destroy (&uring->sq_lock);
+                pthread_mutex_destroy (&uring->cq_lock);
+        }
+        free (uring);
+        free (event_pool);
+        return NULL;
+}
+
+
+static int
+event_register_uring (struct event_pool *event_pool, int fd,
+                      event_handler_t handler,
+                      void *data, int poll_in, int poll_out)
+{
+        struct event_slot_uring *slot = NULL;
+        int                      idx = -1;
+        int                      ret = -1;
+        int                      destroy = 0;
+
+        GF_VALIDATE_OR_GOTO ("event", event_pool, out);
+
+        pthread_mutex_lock (&event_pool->mutex);
+        {
+                destroy = event_pool->destroy;
+                if (!destroy)
+                        idx = __uring_slot_alloc (event_pool->uring, fd);
+        }
+        pthread_mutex_unlock (&event_pool->mutex);
+
+        if (destroy == 1)
+                goto out;
+
+	if (idx == -1) {
+                LOG_PRINT(D_LOG_ERR, "could not find slot for fd=%d", fd);
+		goto out;
+	}
+
+        slot = uring_slot_get (event_pool, idx);
+
+        LOCK (&slot->lock);
+        {
+                slot->handler = handler;
+                slot->data = data;
+                __uring_update_events (slot, poll_in, poll_out);
+
+                ret = __uring_slot_rearm (event_pool, slot, idx, 0);
+        }
+        UNLOCK (&slot->lock);
+
+        if (ret == -1) {
+                LOG_PRINT(D_LOG_ERR, "failed to add fd(=%d) to io_uring", fd);
+                uring_slot_unref (event_pool, slot, idx);
+                idx = -1;
+        }
+
+	/* keep slot->ref (do not uring_slot_unref) if successful */
+out:
+        return idx;
+}
+
+
+static int
+event_select_on_uring (struct event_pool *event_pool, int fd, int idx,
+                       int poll_in, int poll_out)
+{
+        struct event_slot_uring *slot = NULL;
+
+        GF_VALIDATE_OR_GOTO ("event", event_pool, out);
+
+        slot = uring_slot_get (event_pool, idx);
+        GF_VALIDATE_OR_GOTO ("event", slot, out);
+
+        LOCK (&slot->lock);
+        {
+                if (slot->fd != fd) {
+                        LOG_PRINT(D_LOG_ERR, "stale fd(=%d) idx=%d", fd, idx);
+                        goto unlock;
+                }
+
+                __uring_update_events (slot, poll_in, poll_out);
+
+                /* 正在执行handler的线程返回时会重新提交 */
+                if (!slot->in_handler)
+                        __uring_slot_rearm (event_pool, slot, idx, 0);
+        }
+unlock:
+        UNLOCK (&slot->lock);
+
+        uring_slot_unref (event_pool, slot, idx);
+out:
+        return idx;
+}
+
+
+static int
+event_unregister_uring_common (struct event_pool *event_pool, int fd,
+                               int idx, int do_close)
+{
+        struct event_slot_uring *slot = NULL;
+        int                      ret = -1;
+
+        GF_VALIDATE_OR_GOTO ("event", event_pool, out);
+
+        slot = uring_slot_get (event_pool, idx);
+        GF_VALIDATE_OR_GOTO ("event", slot, out);
+
+        LOCK (&slot->lock);
+        {
+                if (slot->fd != fd) {
+                        LOG_PRINT(D_LOG_ERR, "stale fd(=%d) idx=%d", fd, idx);
+                        UNLOCK (&slot->lock);
+                        uring_slot_unref (event_pool, slot, idx);
+                        goto out;
+                }
+
+                /* 取消poll，armseq变化后残留的CQE都会被丢弃 */
+                slot->events = 0;
+                slot->broken = 0;
+                ret = __uring_slot_rearm (event_pool, slot, idx, 0);
+                slot->broken = 1;
+
+		slot->do_close = do_close;
+		slot->gen++; /* detect unregister in dispatch_handler() */
+        }
+        UNLOCK (&slot->lock);
+
+	uring_slot_unref (event_pool, slot, idx); /* one for event_register() */
+	uring_slot_unref (event_pool, slot, idx); /* one for uring_slot_get() */
+out:
+        return ret;
+}
+
+
+static int
+event_unregister_uring (struct event_pool *event_pool, int fd, int idx)
+{
+        return event_unregister_uring_common (event_pool, fd, idx, 0);
+}
+
+
+static int
+event_unregister_close_uring (struct event_pool *event_pool, int fd, int idx)
+{
+        return event_unregister_uring_common (event_pool, fd, idx, 1);
+}
+
+
+static void
+event_dispatch_uring_handler (struct event_pool *event_pool,
+                              struct io_uring_cqe *cqe)
+{
+	struct event_slot_uring *slot = NULL;
+        event_handler_t          handler = NULL;
+        void                    *data = NULL;
+        int                      idx = -1;
+        int                      seq = 0;
+        int                      gen = -1;
+        int                      fd = -1;
+        int                      events = 0;
+
+        if (cqe->user_data == EVENT_URING_IGNORE ||
+            cqe->user_data == EVENT_URING_WAKE)
+                return;
+
+        idx = (uint32_t)cqe->user_data;
+        seq = (int)(cqe->user_data >> 32);
+        events = (cqe->res < 0) ? POLLERR : cqe->res;
+
+	slot = uring_slot_get (event_pool, idx);
+        if (!slot)
+                return;
+
+	LOCK (&slot->lock);
+	{
+		fd = slot->fd;
+		if (fd == -1 || seq != slot->armseq)
+			/* 已注销、已重新提交或slot已重用 */
+			goto pre_unlock;
+
+		if (!(cqe->flags & IORING_CQE_F_MORE)) {
+			/* poll被内核终止，处理完后重新提交 */
+			slot->armed = 0;
+			if (cqe->res < 0)
+				slot->broken = 1;
+		}
+
+		if (slot->in_handler) {
+			slot->pending |= events;
+			goto pre_unlock;
+		}
+
+		handler = slot->handler;
+		data = slot->data;
+		gen = slot->gen;
+
+		slot->in_handler++;
+	}
+pre_unlock:
+	UNLOCK (&slot->lock);
+
+        if (!handler)
+		goto out;
+
+	for (;;) {
+		handler (fd, idx, data,
+			 (events & (POLLIN|POLLPRI)),
+			 (events & (POLLOUT)),
+			 (events & (POLLERR|POLLHUP)));
+
+		LOCK (&slot->lock);
+		{
+			if (gen != slot->gen) {
+				slot->in_handler--;
+				slot->pending = 0;
+				events = 0;
+				goto post_unlock;
+			}
+
+			events = slot->pending;
+			slot->pending = 0;
+			if (events)
+				goto post_unlock;
+
+			slot->in_handler--;
+
+			/* 延迟提交，见event_dispatch_uring_worker */
+			__uring_slot_rearm (event_pool, slot, idx, 1);
+		}
+post_unlock:
+		UNLOCK (&slot->lock);
+
+		if (!events)
+			break;
+	}
+out:
+	uring_slot_unref (event_pool, slot, idx);
+}
+
+
+static void *
+event_dispatch_uring_worker (void *data)
+{
+        struct event_thread_data *ev_data = data;
+	struct event_pool   *event_pool;
+        struct event_uring  *uring = NULL;
+        struct io_uring_cqe *cqes = NULL;
+        int                  batchsize = 1;
+        int                  myindex = -1;
+        int                  timetodie = 0;
+        int                  have_lock = 0;
+        int                  ret = -1;
+        int                  i = 0;
+
+        GF_VALIDATE_OR_GOTO ("event", ev_data, out);
+
+        event_pool = ev_data->event_pool;
+        myindex = ev_data->event_index;
+
+        GF_VALIDATE_OR_GOTO ("event", event_pool, out);
+
+        uring = event_pool->uring;
+
+        LOG_PRINT(D_LOG_INFO, "Started thread with index %d", myindex);
+
+        pthread_mutex_lock (&event_pool->mutex);
+        {
+                event_pool->activethreadcount++;
+                batchsize = event_pool->batchsize;
+        }
+        pthread_mutex_unlock (&event_pool->mutex);
+
+        if (batchsize < 1)
+                batchsize = 1;
+        cqes = calloc (batchsize, sizeof (*cqes));
+        if (!cqes) {
+                cqes = calloc (1, sizeof (*cqes));
+                batchsize = 1;
+        }
+        GF_VALIDATE_OR_GOTO ("event", cqes, out);
+
+	for (;;) {
+                if (event_pool->eventthreadcount < myindex) {
+                        pthread_mutex_lock (&event_pool->mutex);
+                        {
+                                if (event_pool->eventthreadcount <
+                                    myindex) {
+                                        /* 唤醒阻塞在io_uring_enter里的下一个
+                                         * 线程，要在activethreadcount减少之前，
+                                         * 之后环可能已经被销毁 */
+                                        uring_submit_poll (uring, -1, 0, 0, 0,
+                                                           0, 0);
+                                        event_pool->pollers[myindex - 1] = 0;
+                                        event_pool->activethreadcount--;
+                                        timetodie = 1;
+                                        pthread_cond_broadcast (&event_pool->cond);
+                                }
+                        }
+                        pthread_mutex_unlock (&event_pool->mutex);
+                        if (timetodie) {
+                                if (have_lock)
+                                        pthread_mutex_unlock (&uring->cq_lock);
+                                LOG_PRINT(D_LOG_INFO,
+                                        "Exited thread with index %d", myindex);
+                                goto out;
+                        }
+                }
+
+                if (!have_lock)
+                        pthread_mutex_lock (&uring->cq_lock);
+                have_lock = 0;
+                {
+                        ret = 0;
+                        if (event_pool->eventthreadcount >= myindex)
+                                ret = __uring_reap (uring, cqes, batchsize);
+
+                        if (ret == 0 &&
+                            event_pool->eventthreadcount >= myindex) {
+                                /* leader：没有CQE时带锁等待，
+                                 * 顺便提交SQ里延迟的SQE；同一时刻只有
+                                 * leader在等待，由它负责定时器的超时 */
+                                if (__sys_io_uring_wait (uring->ring_fd,
+                                        uring_sq_pending (uring), 1,
+                                        IORING_ENTER_GETEVENTS,
+                                        event_timer_timeout (event_pool,
+                                                             0)) == -1 &&
+                                    errno != EINTR && errno != ETIME)
+                                        LOG_PRINT(D_LOG_ERR,
+                                                  "io_uring_enter failed (%s)",
+                                                  strerror (errno));
+                                ret = __uring_reap (uring, cqes, batchsize);
+                        }
+                }
+                pthread_mutex_unlock (&uring->cq_lock);
+
+                for (i = 0; i < ret; i++)
+                        event_dispatch_uring_handler (event_pool, &cqes[i]);
+
+                event_timers_run (event_pool);
+
+                /* handler返回后的重新提交都延迟了：能拿到cq_lock就由自己
+                 * 在下一次io_uring_enter里一起提交，拿不到说明已经有leader
+                 * 在等待，只能自己提交一次 */
+                if (uring_sq_pending (uring)) {
+                        if (pthread_mutex_trylock (&uring->cq_lock) == 0)
+                                have_lock = 1;
+                        else
+                                uring_flush (uring);
+                }
+        }
+out:
+        free (cqes);
+        if (ev_data)
+                free (ev_data);
+        return NULL;
+}
+
+
+static int
+event_uring_thread_start (struct event_pool *event_pool, int i, pthread_t *tid)
+{
+        struct event_thread_data *ev_data = NULL;
+        int                       ret = -1;
+
+        ev_data = calloc (1, sizeof (*ev_data));
+        if (!ev_data) {
+                LOG_PRINT(D_LOG_WARN, "Allocation failure for index %d", i);
+                return -1;
+        }
+
+        ev_data->event_pool = event_pool;
+        ev_data->event_index = i + 1;
+
+        ret = pthread_create (tid, NULL, event_dispatch_uring_worker, ev_data);
+        if (ret) {
+                LOG_PRINT(D_LOG_WARN, "Failed to start thread for index %d", i);
+                free (ev_data);
+                return -1;
+        }
+
+        event_pool->pollers[i] = *tid;
+        return 0;
+}
+
+
+/* 同event_dispatch_epoll，第一个线程可join，其余detach */
+static int
+event_dispatch_uring (struct event_pool *event_pool)
+{
+        pthread_t t_id;
+        pthread_t t_first = 0;
+        int       pollercount = 0;
+	int       ret = -1;
+        int       i = 0;
+
+        pthread_mutex_lock (&event_pool->mutex);
+        {
+                pollercount = event_pool->eventthreadcount;
+
+                if (pollercount > EVENT_MAX_THREADS)
+                        pollercount = EVENT_MAX_THREADS;
+                if (pollercount <= 0)
+                        pollercount = 1;
+                event_pool->eventthreadcount = pollercount;
+
+                event_pool->activethreadcount++;
+
+                for (i = 0; i < pollercount; i++) {
+                        ret = event_uring_thread_start (event_pool, i, &t_id);
+                        if (ret) {
+                                if (i == 0)
+                                        break;
+                                continue;
+                        }
+
+                        if (i == 0)
+                                t_first = t_id;
+                        else
+                                pthread_detach (t_id);
+                }
+        }
+        pthread_mutex_unlock (&event_pool->mutex);
+
+        if (t_first != 0)
+		pthread_join (t_first, NULL);
+
+        pthread_mutex_lock (&event_pool->mutex);
+        {
+                event_pool->activethreadcount--;
+        }
+        pthread_mutex_unlock (&event_pool->mutex);
+
+	return ret;
+}
+
+
+static int
+event_reconfigure_threads_uring (struct event_pool *event_pool, int value)
+{
+        pthread_t t_id;
+        int       oldthreadcount = 0;
+        int       i = 0;
+
+        pthread_mutex_lock (&event_pool->mutex);
+        {
+                if (event_pool->destroy == 1) {
+                        value = 0;
+                } else {
+                        if (value > EVENT_MAX_THREADS)
+                                value = EVENT_MAX_THREADS;
+                        if (value <= 0)
+                                value = 1;
+                }
+
+                oldthreadcount = event_pool->eventthreadcount;
+
+                for (i = oldthreadcount; i < value; i++) {
+                        if (event_pool->pollers[i] == 0 &&
+                            event_uring_thread_start (event_pool, i,
+                                                      &t_id) == 0)
+                                pthread_detach (t_id);
+                }
+
+                event_pool->eventthreadcount = value;
+        }
+        pthread_mutex_unlock (&event_pool->mutex);
+
+        /* 线程数减少时唤醒leader，退出的线程会依次唤醒下一个 */
+        if (value < oldthreadcount)
+                uring_submit_poll (event_pool->uring, -1, 0, 0, 0, 0, 0);
+
+        return 0;
+}
+
+
+static int
+event_pool_destroy_uring (struct event_pool *event_pool)
+{
+        struct event_uring      *uring = event_pool->uring;
+        struct event_slot_uring *table = NULL;
+        int                      i = 0;
+        int                      j = 0;
+
+        uring_ring_unmap (uring);
+
+        for (i = 0; i < EVENT_EPOLL_TABLES; i++) {
+                table = uring->ereg[i];
+                if (!table)
+                        continue;
+                for (j = 0; j < EVENT_EPOLL_SLOTS; j++)
+                        LOCK_DESTROY (&table[j].lock);
+                free (table);
+        }
+
+        pthread_mutex_destroy (&uring->sq_lock);
+        pthread_mutex_destroy (&uring->cq_lock);
+        free (uring);
+
+        pthread_mutex_destroy (&event_pool->mutex);
+        pthread_cond_destroy (&event_pool->cond);
+        free (event_pool);
+
+        return 0;
+}
+
+struct event_ops event_ops_uring = {
+        .new                       = event_pool_new_uring,
+        .event_register            = event_register_uring,
+        .event_select_on           = event_select_on_uring,
+        .event_unregister          = event_unregister_uring,
+        .event_unregister_close    = event_unregister_close_uring,
+        .event_dispatch            = event_dispatch_uring,
+        .event_reconfigure_threads = event_reconfigure_threads_uring,
+        .event_pool_destroy        = event_pool_destroy_uring
+};
+
+#endif
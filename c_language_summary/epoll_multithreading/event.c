@@ -13,6 +13,18 @@
 
 
 
+#ifdef HAVE_IO_URING
+static int event_uring_enable = 1;
+#else
+static int event_uring_enable = 0;
+#endif
+
+/* 是否优先使用io_uring后端，在event_pool_new之前设置 */
+void
+event_pool_uring_set (int enable)
+{
+        event_uring_enable = enable;
+}
 
 
 struct event_pool *
@@ -21,16 +33,33 @@ event_pool_new (int count, int eventthreadcount)
         struct event_pool *event_pool = NULL;
 	    extern struct event_ops event_ops_poll;
 
+#ifdef HAVE_IO_URING
+	extern struct event_ops event_ops_uring;
+
+        if (event_uring_enable) {
+                event_pool = event_ops_uring.new (count, eventthreadcount);
+
+                if (event_pool) {
+                        event_pool->ops = &event_ops_uring;
+                } else {
+                        LOG_PRINT(D_LOG_WARN,
+                                "falling back to epoll based event handling");
+                }
+        }
+#endif
+
 #ifdef HAVE_SYS_EPOLL_H
 	extern struct event_ops event_ops_epoll;
 
-        event_pool = event_ops_epoll.new (count, eventthreadcount);
+        if (!event_pool) {
+                event_pool = event_ops_epoll.new (count, eventthreadcount);
 
-        if (event_pool) {
-                event_pool->ops = &event_ops_epoll;
-        } else {
-                LOG_PRINT(D_LOG_WARN,
-                        "falling back to poll based event handling");
+                if (event_pool) {
+                        event_pool->ops = &event_ops_epoll;
+                } else {
+                        LOG_PRINT(D_LOG_WARN,
+                                "falling back to poll based event handling");
+                }
         }
 #endif
 
@@ -42,10 +71,55 @@ event_pool_new (int count, int eventthreadcount)
                        event_pool->ops = &event_ops_poll;
         }
 
+        /* 时间轮初始化失败只是不能用定时器 */
+        if (event_pool && event_timer_wheel_init (event_pool) == -1)
+                LOG_PRINT(D_LOG_WARN, "event pool without timers");
+
         return event_pool;
 }
 
 
+/* 每个线程独立epoll的分片事件池，配合SO_REUSEPORT每个线程一个监听fd */
+struct event_pool *
+event_pool_new_sharded (int count, int eventthreadcount)
+{
+        struct event_pool *event_pool = NULL;
+
+#ifdef HAVE_SYS_EPOLL_H
+	extern struct event_ops event_ops_epoll_shard;
+
+        event_pool = event_ops_epoll_shard.new (count, eventthreadcount);
+
+        if (event_pool) {
+                event_pool->ops = &event_ops_epoll_shard;
+                if (event_timer_wheel_init (event_pool) == -1)
+                        LOG_PRINT(D_LOG_WARN, "event pool without timers");
+                return event_pool;
+        }
+#endif
+        LOG_PRINT(D_LOG_WARN, "falling back to shared event pool");
+
+        return event_pool_new (count, eventthreadcount);
+}
+
+
+int
+event_pool_thread_count (struct event_pool *event_pool)
+{
+        int ret = -1;
+
+        GF_VALIDATE_OR_GOTO ("event", event_pool, out);
+
+        pthread_mutex_lock (&event_pool->mutex);
+        {
+                ret = event_pool->eventthreadcount;
+        }
+        pthread_mutex_unlock (&event_pool->mutex);
+out:
+        return ret;
+}
+
+
 int
 event_register (struct event_pool *event_pool, int fd,
                 event_handler_t handler,
@@ -62,6 +136,29 @@ out:
 }
 
 
+/* 注册到第thread个线程(从0开始)，只有分片模式有区别 */
+int
+event_register_on (struct event_pool *event_pool, int thread, int fd,
+                   event_handler_t handler,
+                   void *data, int poll_in, int poll_out)
+{
+        int ret = -1;
+
+        GF_VALIDATE_OR_GOTO ("event", event_pool, out);
+
+        if (!event_pool->ops->event_register_on)
+                ret = event_pool->ops->event_register (event_pool, fd, handler,
+                                                       data, poll_in,
+                                                       poll_out);
+        else
+                ret = event_pool->ops->event_register_on (event_pool, thread,
+                                                          fd, handler, data,
+                                                          poll_in, poll_out);
+out:
+        return ret;
+}
+
+
 int
 event_unregister (struct event_pool *event_pool, int fd, int idx)
 {
@@ -118,6 +215,33 @@ out:
         return ret;
 }
 
+/* 设置批量收取的事件数，需在event_dispatch之前调用。
+ * epoll：每次epoll_wait最多收这么多事件，大于1时handler要把数据读到EAGAIN；
+ * io_uring：大于1时改用multishot poll，每次io_uring_enter最多收这么多CQE，
+ * handler同样要读到EAGAIN；为1时是单次poll，逐个收取 */
+int
+event_pool_set_batch (struct event_pool *event_pool, int batchsize)
+{
+        int ret = -1;
+
+        GF_VALIDATE_OR_GOTO ("event", event_pool, out);
+
+        if (batchsize <= 0)
+                batchsize = 1;
+        if (batchsize > EVENT_EPOLL_MAX_BATCH)
+                batchsize = EVENT_EPOLL_MAX_BATCH;
+
+        pthread_mutex_lock (&event_pool->mutex);
+        {
+                event_pool->batchsize = batchsize;
+        }
+        pthread_mutex_unlock (&event_pool->mutex);
+
+        ret = 0;
+out:
+        return ret;
+}
+
 int
 event_reconfigure_threads (struct event_pool *event_pool, int value)
 {
@@ -151,6 +275,8 @@ event_pool_destroy (struct event_pool *event_pool)
         if (!destroy || (activethreadcount > 0))
                 goto out;
 
+        event_timer_wheel_fini (event_pool);
+
         ret = event_pool->ops->event_pool_destroy (event_pool);
 out:
         return ret;
@@ -2,13 +2,19 @@
 #define _EVENT_H_
 
 #include <pthread.h>
+#include <stdint.h>
 
 #include "../debug/debug.h"
+#include "list.h"
 
 struct event_pool;
 struct event_ops;
 struct event_slot_poll;
 struct event_slot_epoll;
+struct event_shard;
+struct event_uring;
+struct event_timer;
+struct event_timer_wheel;
 struct event_data {
 	int idx;
 	int gen;
@@ -18,9 +24,21 @@ struct event_data {
 typedef int (*event_handler_t) (int fd, int idx, void *data,
 				int poll_in, int poll_out, int poll_err);
 
+typedef void (*event_timer_cbk_t) (struct event_timer *timer, void *data);
+
+/* ʱɵ߷(ǶӵȽṹ)ʱֱС̶ */
+struct event_timer {
+        struct list_head  list;
+        uint64_t          expires;  /* ʱ䣬tick */
+        event_timer_cbk_t cbk;      /* poller߳ */
+        void             *data;
+        int               pending;  /* Ƿʱ */
+};
+
 #define EVENT_EPOLL_TABLES 1024
 #define EVENT_EPOLL_SLOTS 1024
 #define EVENT_MAX_THREADS  32
+#define EVENT_EPOLL_MAX_BATCH 256 /* ģʽÿepoll_waitȡ¼ */
 
 #define GF_VALIDATE_OR_GOTO(name,arg,label)   do {   \
 		if (!arg) {                                  \
@@ -59,6 +77,21 @@ struct event_pool {
                                                      * and live status */
         int destroy;
         int activethreadcount;
+
+        /* ÿ߳ÿepoll_wait(io_uring_enter)ȡ¼1Ϊԭ
+         * ģʽ1Ϊģʽio_uringͬʱmultishot poll
+         * (event_dispatch֮ǰ) */
+        int batchsize;
+
+        /* Ƭģʽÿ߳һepollʵһֻslot */
+        struct event_shard *shards;
+        int shardcount;
+
+        /* io_uring˵Ļslot */
+        struct event_uring *uring;
+
+        /* ʱʱ */
+        struct event_timer_wheel *timers;
 };
 
 struct event_ops {
@@ -81,9 +114,20 @@ struct event_ops {
         int (*event_reconfigure_threads) (struct event_pool *event_pool,
                                           int newcount);
         int (*event_pool_destroy) (struct event_pool *event_pool);
+
+        /* ѡעᵽָ̣߳ûʵֵİevent_register */
+        int (*event_register_on) (struct event_pool *event_pool, int thread,
+                                  int fd, event_handler_t handler,
+                                  void *data, int poll_in, int poll_out);
 };
 
 struct event_pool *event_pool_new (int count, int eventthreadcount);
+void event_pool_uring_set (int enable);
+struct event_pool *event_pool_new_sharded (int count, int eventthreadcount);
+int event_pool_thread_count (struct event_pool *event_pool);
+int event_register_on (struct event_pool *event_pool, int thread, int fd,
+                       event_handler_t handler,
+                       void *data, int poll_in, int poll_out);
 int event_select_on (struct event_pool *event_pool, int fd, int idx,
 		     int poll_in, int poll_out);
 int event_register (struct event_pool *event_pool, int fd,
@@ -95,4 +139,19 @@ int event_dispatch (struct event_pool *event_pool);
 int event_reconfigure_threads (struct event_pool *event_pool, int value);
 int event_pool_destroy (struct event_pool *event_pool);
 int event_dispatch_destroy (struct event_pool *event_pool);
+int event_pool_set_batch (struct event_pool *event_pool, int batchsize);
+
+void event_timer_init (struct event_timer *timer, event_timer_cbk_t cbk,
+                       void *data);
+int event_timer_add (struct event_pool *event_pool, struct event_timer *timer,
+                     uint64_t timeout_ms);
+int event_timer_cancel (struct event_pool *event_pool,
+                        struct event_timer *timer);
+int event_timer_count (struct event_pool *event_pool);
+
+/* ¸˵poller߳ʹ */
+int event_timer_wheel_init (struct event_pool *event_pool);
+void event_timer_wheel_fini (struct event_pool *event_pool);
+int event_timer_timeout (struct event_pool *event_pool, int thread);
+void event_timers_run (struct event_pool *event_pool);
 #endif /* _EVENT_H_ */
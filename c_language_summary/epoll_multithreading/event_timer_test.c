@@ -0,0 +1,229 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/* ʱֲԣӷpoller߳ӴʱĶʱɾһ֣
+ * ͳ/ɾĺʱڻصԵʱӳ٣
+ * ͬʱһڻصԼڶʱ
+ * βepollƬio_uring¼ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include "../debug/debug.h"
+#include "event.h"
+
+#define DEFAULT_EVENT_POOL_SIZE            1024
+#define PERIOD_MS                          10
+
+enum pool_kind {
+    POOL_EPOLL,
+    POOL_SHARDED,
+    POOL_URING,
+};
+
+static const char *pool_kind_name[] = {"epoll  ", "sharded", "uring  "};
+
+struct test_timer {
+    struct event_timer timer;
+    uint64_t           due_us;
+};
+
+static struct event_pool *pool;
+static int ntimers = 1000000;
+static int span = 2000;
+static int threads = 4;
+static int cancel_pct = 50;
+
+static long fired;
+static uint64_t late_sum;
+static uint64_t late_max;
+static long period_fired;
+
+static uint64_t
+now_us (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void
+timer_cbk (struct event_timer *timer, void *data)
+{
+    struct test_timer *t = (struct test_timer *)timer;
+    uint64_t late = 0, max;
+    uint64_t now = now_us ();
+
+    if (now > t->due_us)
+        late = now - t->due_us;
+
+    __atomic_add_fetch (&late_sum, late, __ATOMIC_RELAXED);
+    max = __atomic_load_n (&late_max, __ATOMIC_RELAXED);
+    while (late > max &&
+           !__atomic_compare_exchange_n (&late_max, &max, late, 0,
+                                         __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+    __atomic_add_fetch (&fired, 1, __ATOMIC_RELEASE);
+}
+
+/* ڻصԼ */
+static void
+period_cbk (struct event_timer *timer, void *data)
+{
+    __atomic_add_fetch (&period_fired, 1, __ATOMIC_RELAXED);
+    event_timer_add (pool, timer, PERIOD_MS);
+}
+
+static void *
+dispatch_thread (void *arg)
+{
+    event_dispatch (pool);
+    return NULL;
+}
+
+static int
+run_test (int kind)
+{
+    struct test_timer *timers;
+    struct event_timer period;
+    pthread_t tid;
+    uint64_t start, add_us, cancel_us, wait_us;
+    long expect, cancelled = 0;
+    int i;
+
+    if (kind == POOL_SHARDED) {
+        pool = event_pool_new_sharded (DEFAULT_EVENT_POOL_SIZE, threads);
+    } else {
+        event_pool_uring_set (kind == POOL_URING);
+        pool = event_pool_new (DEFAULT_EVENT_POOL_SIZE, threads);
+        if (kind == POOL_URING && !pool->uring)
+            printf ("io_uring not available, using epoll\n");
+    }
+    if (!pool || !pool->timers) {
+        LOG_PRINT(D_LOG_ERR, "failed to create event pool with timers");
+        return -1;
+    }
+    pthread_create (&tid, NULL, dispatch_thread, NULL);
+
+    timers = calloc (ntimers, sizeof (*timers));
+    if (!timers)
+        return -1;
+
+    srand (1);
+    for (i = 0; i < ntimers; i++)
+        event_timer_init (&timers[i].timer, timer_cbk, NULL);
+
+    event_timer_init (&period, period_cbk, NULL);
+    event_timer_add (pool, &period, PERIOD_MS);
+
+    start = now_us ();
+    for (i = 0; i < ntimers; i++) {
+        uint64_t timeout = 1 + rand () % span;
+
+        timers[i].due_us = now_us () + timeout * 1000;
+        event_timer_add (pool, &timers[i].timer, timeout);
+    }
+    add_us = now_us () - start;
+
+    start = now_us ();
+    for (i = 0; i < ntimers; i++) {
+        if (rand () % 100 < cancel_pct)
+            cancelled += event_timer_cancel (pool, &timers[i].timer);
+    }
+    cancel_us = now_us () - start;
+
+    /* ɾ֮ǰѾڵҲfired */
+    expect = ntimers - cancelled;
+    start = now_us ();
+    while (__atomic_load_n (&fired, __ATOMIC_ACQUIRE) < expect &&
+           now_us () - start < (uint64_t)(span + 5000) * 1000)
+        usleep (10000);
+    wait_us = now_us () - start;
+
+    event_timer_cancel (pool, &period);
+
+    printf ("%s: threads %d, %d timers in %d ms: add %.0f ns, "
+            "cancel %.0f ns, cancelled %ld, fired %ld/%ld, "
+            "late avg %.2f ms max %.2f ms, periodic %ld in %.1f s, "
+            "left %d\n",
+            pool_kind_name[kind], event_pool_thread_count (pool),
+            ntimers, span,
+            add_us * 1000.0 / ntimers, cancel_us * 1000.0 / ntimers,
+            cancelled, fired, expect,
+            fired ? late_sum / 1000.0 / fired : 0.0, late_max / 1000.0,
+            period_fired, (add_us + cancel_us + wait_us) / 1000000.0,
+            event_timer_count (pool));
+
+    event_dispatch_destroy (pool);
+    pthread_join (tid, NULL);
+    event_pool_destroy (pool);
+    free (timers);
+
+    return fired == expect ? 0 : -1;
+}
+
+static void
+usage (char *name)
+{
+    fprintf (stderr, "Usage: %s [-n timers] [-s span_ms] [-t threads] "
+             "[-c cancel_percent] [-e] [-r] [-u]\n"
+             "  default runs epoll, sharded and io_uring in turn\n"
+             "  -e     run the epoll pool only\n"
+             "  -r     run the sharded pool only\n"
+             "  -u     run the io_uring pool only\n",
+             name);
+    exit (EXIT_FAILURE);
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    int kind = -1;
+    int ret = 0, status, i, opt;
+    pid_t pid;
+
+    while ((opt = getopt (argc, argv, "n:s:t:c:eruh")) != -1) {
+        switch (opt) {
+        case 'n': ntimers = atoi (optarg); break;
+        case 's': span = atoi (optarg); break;
+        case 't': threads = atoi (optarg); break;
+        case 'c': cancel_pct = atoi (optarg); break;
+        case 'e': kind = POOL_EPOLL; break;
+        case 'r': kind = POOL_SHARDED; break;
+        case 'u': kind = POOL_URING; break;
+        default: usage (argv[0]);
+        }
+    }
+    if (ntimers <= 0 || span <= 0 || threads <= 0 ||
+        cancel_pct < 0 || cancel_pct > 100)
+        usage (argv[0]);
+
+    for (i = POOL_EPOLL; i <= POOL_URING; i++) {
+        if (kind != -1 && i != kind)
+            continue;
+        fflush (stdout);
+        pid = fork ();
+        if (pid == 0) {
+            opt = run_test (i);
+            fflush (stdout);
+            _exit (opt == 0 ? 0 : 1);
+        }
+        waitpid (pid, &status, 0);
+        if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+            ret = 1;
+    }
+
+    return ret;
+}
+
+#ifdef __cplusplus
+}
+#endif
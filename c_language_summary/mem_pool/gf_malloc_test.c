@@ -0,0 +1,115 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdint.h> /* uint64_t*/
+#include <unistd.h> //getopt
+#include <stdio.h>
+#include <pthread.h>
+#include "mem_pool.h"
+#include "../count_time/count_time.h"
+
+/*
+ * Сַ gf_strdup/gf_asprintf/GF_FREEȽǷʹôСּڴ:
+ *   ./gf_malloc_test        malloc
+ *   ./gf_malloc_test -s     Сּڴ
+ */
+
+static int thread_num = 1 ;
+static int str_num  = 1000 ;
+static int loop =  1000 ;
+static int use_size_class =  0 ;
+
+static void usage(void)
+{
+    printf("optional arguments:\n"
+           "-h,  show this help message and exit\n"
+           "-n int,  strings per round \n"
+           "-t int,  thread num \n"
+           "-l int,  loop num \n"
+           "-s bool, use size class mem pools \n");
+}
+
+void *test_fun(void *arg)
+{
+    int j;
+    int i;
+    char ** str_array   = CALLOC(str_num, sizeof(char *));
+    for(j=0; j<loop; j++){
+        for(i=0; i<str_num; i++)
+        {
+            if (i & 1)
+                str_array[i] = gf_strdup("/mnt/glusterfs/dir/file");
+            else
+                gf_asprintf(&str_array[i], "key-%d-%d", j, i);
+        }
+        for(i=0; i<str_num; i++)
+        {
+            GF_FREE (str_array[i]);
+        }
+    }
+    free (str_array);
+    return 0;
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    int i=0;
+    int c;
+
+    while (-1 != (c = getopt(argc, argv, "n:t:l:sh")))
+    {
+        switch (c)
+        {
+        case 'n':
+            str_num  = atoi(optarg);
+            break;
+        case 't':
+            thread_num  = atoi(optarg);
+            break;
+        case 'l':
+            loop  = atoi(optarg);
+            break;
+        case 's':
+            use_size_class = 1;
+            break;
+        case 'h':
+        default:
+            usage();
+            exit(0);
+            break;
+        }
+    }
+    printf("str_num = %d; thread_num = %d; loop  = %d; size_class = %d\n",str_num, thread_num, loop, use_size_class);
+
+    gf_mem_init_mempool_list();
+    gf_mem_acct_enable_set();
+    mem_acct_init(gf_common_mt_end+1);
+    if (use_size_class && gf_mem_size_class_init())
+    {
+        DBG_PRINT("init size class error");
+        return -1;
+    }
+
+    CPU_TIME_START;
+    TIME_START;
+
+    pthread_t id[thread_num];
+
+    for(i=0;i<thread_num;++i){
+            pthread_create(&id[i],NULL,test_fun,NULL);
+    }
+
+    for(i=0;i<thread_num;++i){
+            pthread_join(id[i],NULL);
+    }
+
+    CPU_TIME_END_PRINT("gf malloc");
+    TIME_END_PRINT("gf malloc");
+
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
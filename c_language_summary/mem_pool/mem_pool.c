@@ -2,12 +2,22 @@
 extern "C"{
 #endif
 
+#define _GNU_SOURCE //sched_getcpu
 #include <stdint.h> /* uint64_t*/
 #include <stdlib.h>
 #include <stdarg.h>
 #include <errno.h>
 #include <signal.h>
+#include <sched.h>
 #include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <dirent.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <time.h>
 #include <unistd.h>
 
 
@@ -20,13 +30,20 @@ extern "C"{
 int mem_acct_enable = 0;
 struct mem_acct     mem_acct;  //ڴͳ
 struct list_head    mempool_list; // init in main
+gf_lock_t           mempool_list_lock; // mempool_listͳƵ̻߳
+int mem_pool_magazine_size = GF_MEM_POOL_MAGAZINE_SIZE; //½ڴصÿ̻߳С
+int mem_pool_lockfree = 0; //½ڴǷʹջ
+int mem_pool_numa = 0; //½ڴǷ NUMA ڵֳڴ
+static int mem_pool_numa_fake_nodes = 0; //õļ NUMA ڵ0 ʾʹʵ
+static __thread int mem_pool_numa_fake_node = 0; //ã߳ڵļ NUMA ڵ
 static int gf_dump_fd = -1;
 
 /* 
  * gf mem_pool ڴڴṹ:  
   { 
-    struct list_head;   // mem_pool_new_fnгʼ: INIT_LIST_HEAD (list);
+    struct list_head;   // __mem_pool_slab_newгʼ: INIT_LIST_HEAD (list);
     struct mem_pool*;   // mem_getгʼ: *pool_ptr = (struct mem_pool *)mem_pool;
+    struct mem_pool_slab*; //  slab__mem_pool_slab_newгʼϵͳڴΪ NULL
     int in_use;        //ڴǷʹ: 1ʾʹ, 0ʾδʹ 
     char mem_size[N];  //ʵʿɹʹõڴС 
   } 
@@ -36,22 +53,228 @@ static int gf_dump_fd = -1;
 
 #define GF_MEM_POOL_LIST_BOUNDARY        (sizeof(struct list_head))
 #define GF_MEM_POOL_PTR                  (sizeof(struct mem_pool*))
-#define GF_MEM_POOL_PAD_BOUNDARY         (GF_MEM_POOL_LIST_BOUNDARY  + GF_MEM_POOL_PTR + sizeof(int))
+#define GF_MEM_POOL_SLAB_PTR             (sizeof(struct mem_pool_slab*))
+//ͷ 8 ֽڶ룬֤ظߵڴ 8 ֽڶ
+#define GF_MEM_POOL_ALIGN(size)          (((size) + 7) & ~7UL)
+#define GF_MEM_POOL_PAD_BOUNDARY         GF_MEM_POOL_ALIGN(GF_MEM_POOL_LIST_BOUNDARY  + GF_MEM_POOL_PTR + GF_MEM_POOL_SLAB_PTR + sizeof(int))
 #define mem_pool_chunkhead2ptr(head)     ((head) + GF_MEM_POOL_PAD_BOUNDARY)
 #define mem_pool_ptr2chunkhead(ptr)      ((ptr) - GF_MEM_POOL_PAD_BOUNDARY)
 #define is_mem_chunk_in_use(ptr)         (*ptr == 1)
 #define mem_pool_from_ptr(ptr)           ((ptr) + GF_MEM_POOL_LIST_BOUNDARY)
+#define mem_pool_slab_from_ptr(head)     ((struct mem_pool_slab **)((head) + GF_MEM_POOL_LIST_BOUNDARY + GF_MEM_POOL_PTR))
+#define mem_pool_in_use_ptr(head)        ((int *)((head) + GF_MEM_POOL_LIST_BOUNDARY + GF_MEM_POOL_PTR + GF_MEM_POOL_SLAB_PTR))
 
 #define GLUSTERFS_ENV_MEM_ACCT_STR  "GLUSTERFS_DISABLE_MEM_ACCT"
 
+#define GF_MEM_POOL_NO_NODE          (-1) //ͨڴ
+#define GF_MEM_POOL_NUMA_PARENT      (-2) //NUMA ڴر slabֻתڵڴ
+#define GF_MEM_POOL_MAX_NODES        1024
+#define GF_MEM_POOL_MAX_CPUS         4096
+#define GF_DUMP_LOCK_TRIES           10 //SIGUSR1 dump  mempool_list_lock Ĵÿ 1ms
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED               1
+#endif
+
+/*
+ * Сּ(size class): 32, 48, 64, 96, 128 ... 3072, 4096 2^n  1.5*2^n
+ * ÿһڴءڴͳƲ gf_mem_size_class_init Ժ
+ * ͷβܴС GF_MEM_SIZE_CLASS_MAX  GF_MALLOC/GF_CALLOC ڴз䡣
+ * ͷ 8 ֽм¼ GF_MEM_SIZE_CLASS_MAGICͷʱݴ˵ mem_put
+ */
+#define GF_MEM_SIZE_CLASS_MIN_SHIFT  5
+#define GF_MEM_SIZE_CLASS_MAX        4096
+#define GF_MEM_SIZE_CLASS_NUM        15
+#define GF_MEM_SIZE_CLASS_SLAB_SIZE  (64 * 1024)
+#define GF_MEM_SIZE_CLASS_MAGIC      0x5C1A55ED
+#define gf_mem_size_class_flag(ptr)  (*(uint32_t *)((char *)(ptr) - 8))
+
+static struct mem_pool *gf_mem_size_classes[GF_MEM_SIZE_CLASS_NUM];
+
+// idx ĴС
+static inline size_t
+gf_mem_size_class_size (int idx)
+{
+        if (idx & 1)
+                return 3UL << (GF_MEM_SIZE_CLASS_MIN_SHIFT - 1 + idx / 2);
+        return 1UL << (GF_MEM_SIZE_CLASS_MIN_SHIFT + idx / 2);
+}
+
+//size ڵļO(1): 2^b < size <= 2^(b+1)ٿǷ񲻳 1.5*2^b
+static inline int
+gf_mem_size_class_index (size_t size)
+{
+        int b = 0;
+
+        if (size <= (1UL << GF_MEM_SIZE_CLASS_MIN_SHIFT))
+                return 0;
+
+        b = 63 - __builtin_clzl (size - 1);
+        if (size <= (3UL << (b - 1)))
+                return 2 * (b - GF_MEM_SIZE_CLASS_MIN_SHIFT) + 1;
+        return 2 * (b + 1 - GF_MEM_SIZE_CLASS_MIN_SHIFT);
+}
+
+/*  tot_size СӦڴأûʱ NULL  malloc
+ * ڴԼĽṹ(gf_common_mt_mem_pool)ܴڴз䣬
+ *  slab ʱͬһڴ */
+static inline struct mem_pool *
+gf_mem_size_class_pool (size_t tot_size, uint32_t type)
+{
+        if (tot_size > GF_MEM_SIZE_CLASS_MAX || type == gf_common_mt_mem_pool)
+                return NULL;
+
+        return gf_mem_size_classes[gf_mem_size_class_index (tot_size)];
+}
+
 
 void
 gf_mem_init_mempool_list ()
 {
         INIT_LIST_HEAD (&mempool_list);
+        LOCK_INIT (&mempool_list_lock);
+        return;
+}
+
+
+//½ڴصÿ̻߳С0 ʾر̻߳棬в mem_pool->lock
+void
+gf_mem_pool_magazine_set (int size)
+{
+        if (size < 0)
+                size = 0;
+        mem_pool_magazine_size = size;
+        return;
+}
+
+//½ڴʹջmem_get/mem_put ĳ·
+void
+gf_mem_pool_lockfree_set (int enable)
+{
+        mem_pool_lockfree = !!enable;
+        return;
+}
+
+//½ڴذ NUMA ڵֳڴأֻһڵʱȻͨڴ
+void
+gf_mem_pool_numa_set (int enable)
+{
+        mem_pool_numa = !!enable;
+        return;
+}
+
+/* : װ nr_nodes  NUMA ڵ㣬߳ڽڵ gf_mem_pool_numa_fake_bind ָ
+ * ʱ mbindnr_nodes Ϊ 0 ʱָʹʵ */
+void
+gf_mem_pool_numa_fake_topology (int nr_nodes)
+{
+        if (nr_nodes < 0 || nr_nodes > GF_MEM_POOL_MAX_NODES)
+                nr_nodes = 0;
+        mem_pool_numa_fake_nodes = nr_nodes;
+        return;
+}
+
+void
+gf_mem_pool_numa_fake_bind (int node)
+{
+        mem_pool_numa_fake_node = node;
         return;
 }
 
+static unsigned short mem_pool_cpu_node[GF_MEM_POOL_MAX_CPUS]; //CPU ڽڵ + 10 ʾδ֪
+
+//ȡ nodeN/cpulist( "0-3,8-11") CPU ڵӳ
+static void
+mem_pool_numa_read_cpulist (int node)
+{
+        char   path[64];
+        FILE  *fp = NULL;
+        int    lo = 0;
+        int    hi = 0;
+        int    cpu = 0;
+        int    c = 0;
+
+        snprintf (path, sizeof (path), "/sys/devices/system/node/node%d/cpulist", node);
+        fp = fopen (path, "r");
+        if (!fp)
+                return;
+        while (fscanf (fp, "%d", &lo) == 1) {
+                hi = lo;
+                c = fgetc (fp);
+                if (c == '-') {
+                        if (fscanf (fp, "%d", &hi) != 1)
+                                break;
+                        c = fgetc (fp);
+                }
+                for (cpu = lo; cpu <= hi && cpu < GF_MEM_POOL_MAX_CPUS; cpu++)
+                        mem_pool_cpu_node[cpu] = node + 1;
+                if (c != ',')
+                        break;
+        }
+        fclose (fp);
+}
+
+/* NUMA ڵ: /sys/devices/system/node/nodeN  N + 1ʱΪ 1
+ * һεʱ˳㽨 CPU ڵӳ֮ mem_get/mem_put  */
+int
+gf_mem_pool_numa_nodes ()
+{
+        static int      nr_nodes = 0;
+        DIR            *dir = NULL;
+        struct dirent  *entry = NULL;
+        int             node = 0;
+        int             max_node = 0;
+
+        if (mem_pool_numa_fake_nodes)
+                return mem_pool_numa_fake_nodes;
+        if (nr_nodes)
+                return nr_nodes;
+
+        dir = opendir ("/sys/devices/system/node");
+        if (dir) {
+                while ((entry = readdir (dir)) != NULL) {
+                        if (sscanf (entry->d_name, "node%d", &node) == 1 &&
+                            node < GF_MEM_POOL_MAX_NODES) {
+                                mem_pool_numa_read_cpulist (node);
+                                if (node > max_node)
+                                        max_node = node;
+                        }
+                }
+                closedir (dir);
+        }
+
+        nr_nodes = min (max_node + 1, GF_MEM_POOL_MAX_NODES);
+        return nr_nodes;
+}
+
+/* ǰ߳ڵ NUMA ڵ㣬ʧܷ -1
+ * sched_getcpu  rseq/vDSOںˣÿ mem_get/mem_put Ҳ */
+static inline int
+mem_pool_numa_node ()
+{
+        int cpu = 0;
+
+        if (mem_pool_numa_fake_nodes)
+                return mem_pool_numa_fake_node;
+
+        cpu = sched_getcpu ();
+        if (cpu < 0 || cpu >= GF_MEM_POOL_MAX_CPUS)
+                return -1;
+        return mem_pool_cpu_node[cpu] - 1;
+}
+
+//ڴؿڴĸˮλʱȫյ slab ϵͳ
+void
+mem_pool_set_hiwat (struct mem_pool *pool, unsigned long hiwat)
+{
+        if (!pool)
+                return;
+
+        LOCK (&pool->lock);
+        {
+                pool->hiwat = hiwat;
+        }
+        UNLOCK (&pool->lock);
+}
 
 //ڴͳʹܱ־
 void
@@ -75,7 +298,7 @@ mem_acct_init (int num_types)
 
         mem_acct.rec = CALLOC(num_types, sizeof(struct mem_acct_rec));
 
-        if (mem_acct.rec) {
+        if (!mem_acct.rec) {
                 return -1;
         }
 
@@ -128,7 +351,8 @@ gf_mem_set_acct_info (char **alloc_ptr, size_t size,
         ptr += sizeof (size_t);
         *(uint32_t *)(ptr) = GF_MEM_HEADER_MAGIC; //ħ
         ptr = ptr + 4;
-        ptr = ptr + 8; //padding 
+        *(uint64_t *)(ptr) = 0; //padding 䣬Сּʱ¼ GF_MEM_SIZE_CLASS_MAGIC
+        ptr = ptr + 8;
         //βС: GF_MEM_TRAILER_SIZE 8
         *(uint32_t *) (ptr + size) = GF_MEM_TRAILER_MAGIC; //ħ
 
@@ -145,6 +369,7 @@ __gf_calloc (size_t nmemb, size_t size, uint32_t type, const char *typestr)
         size_t          tot_size = 0;
         size_t          req_size = 0;
         char            *ptr = NULL;
+        struct mem_pool *pool = NULL;
 
         //ڴͳƣֱӷ
         if (!mem_acct_enable)
@@ -156,7 +381,14 @@ __gf_calloc (size_t nmemb, size_t size, uint32_t type, const char *typestr)
         //ʵڴС ͳõͷСβ
         tot_size = req_size + GF_MEM_HEADER_SIZE + GF_MEM_TRAILER_SIZE;
 
-        ptr = calloc (1, tot_size);
+        pool = gf_mem_size_class_pool (tot_size, type);
+        if (pool) {
+                ptr = mem_get (pool);
+                if (ptr)
+                        memset (ptr, 0, tot_size);
+        } else {
+                ptr = calloc (1, tot_size);
+        }
 
         if (!ptr) {
                 LOG_PRINT(D_LOG_CRIT,"The memory size %zu is not enough", tot_size);
@@ -164,6 +396,8 @@ __gf_calloc (size_t nmemb, size_t size, uint32_t type, const char *typestr)
         }
         //ͳϢ
         gf_mem_set_acct_info (&ptr, req_size, type, typestr);
+        if (pool)
+                gf_mem_size_class_flag (ptr) = GF_MEM_SIZE_CLASS_MAGIC;
 
         return (void *)ptr;
 }
@@ -174,18 +408,25 @@ __gf_malloc (size_t size, uint32_t type, const char *typestr)
 {
         size_t          tot_size = 0;
         char            *ptr = NULL;
+        struct mem_pool *pool = NULL;
 
         if (!mem_acct_enable)
                 return MALLOC (size);
 
         tot_size = size + GF_MEM_HEADER_SIZE + GF_MEM_TRAILER_SIZE;
 
-        ptr = malloc (tot_size);
+        pool = gf_mem_size_class_pool (tot_size, type);
+        if (pool)
+                ptr = mem_get (pool);
+        else
+                ptr = malloc (tot_size);
         if (!ptr) {
                 LOG_PRINT(D_LOG_CRIT,"The memory size %zu is not enough", tot_size);
                 return NULL;
         }
         gf_mem_set_acct_info (&ptr, size, type, typestr);
+        if (pool)
+                gf_mem_size_class_flag (ptr) = GF_MEM_SIZE_CLASS_MAGIC;
 
         return (void *)ptr;
 }
@@ -198,6 +439,7 @@ __gf_realloc (void *ptr, size_t size)
         char            *orig_ptr = NULL;
         uint32_t        type = 0;
         char            *new_ptr;
+        size_t          old_size = 0;
 
         if (!mem_acct_enable)
                 return REALLOC (ptr, size);
@@ -211,6 +453,17 @@ __gf_realloc (void *ptr, size_t size)
         orig_ptr = (char *)ptr - GF_MEM_HEADER_SIZE;
         type = *(uint32_t *)orig_ptr;
 
+        //ӴСּڴзĲ realloc·䲢
+        if (gf_mem_size_class_flag (ptr) == GF_MEM_SIZE_CLASS_MAGIC) {
+                memcpy (&old_size, orig_ptr + 4, sizeof (size_t));
+                new_ptr = __gf_malloc (size, type, mem_acct.rec[type].typestr);
+                if (!new_ptr)
+                        return NULL;
+                memcpy (new_ptr, ptr, min (old_size, size));
+                __gf_free (ptr);
+                return (void *)new_ptr;
+        }
+
         new_ptr = realloc (orig_ptr, tot_size);
         if (!new_ptr) {
                 LOG_PRINT(D_LOG_CRIT,"The memory size %zu is not enough", tot_size);
@@ -274,6 +527,7 @@ __gf_free (void *free_ptr)
         size_t          req_size = 0;
         char            *ptr = NULL;
         uint32_t        type = 0;
+        int             pooled = 0;
 
         //ûڴͳƣֱͷ
         if (!mem_acct_enable) {
@@ -290,6 +544,7 @@ __gf_free (void *free_ptr)
         GF_ASSERT (GF_MEM_HEADER_MAGIC == *(uint32_t *)ptr);
 
         *(uint32_t *)ptr = 0; //ħΪ0
+        pooled = (gf_mem_size_class_flag (free_ptr) == GF_MEM_SIZE_CLASS_MAGIC);
 
         if (!mem_acct.rec) {
                 ptr = (char *)free_ptr - GF_MEM_HEADER_SIZE;
@@ -316,25 +571,386 @@ __gf_free (void *free_ptr)
         }
         UNLOCK (&mem_acct.rec[type].lock);
 free:
-        FREE (ptr);
+        if (pooled)
+                mem_put (ptr);
+        else
+                FREE (ptr);
+}
+
+//СּõڴأҪȵ gf_mem_init_mempool_list  mem_acct_init
+int
+gf_mem_size_class_init ()
+{
+        int               i = 0;
+        size_t            class_size = 0;
+        char              name[64] = {0,};
+        struct mem_pool  *pool = NULL;
+
+        if (!mem_acct_enable)
+                return -1;
+
+        for (i = 0; i < GF_MEM_SIZE_CLASS_NUM; i++) {
+                if (gf_mem_size_classes[i])
+                        continue;
+
+                class_size = gf_mem_size_class_size (i);
+                snprintf (name, sizeof (name), "gf_mem_size_class_%zu",
+                          class_size);
+                pool = mem_pool_new_fn (class_size,
+                                        max (GF_MEM_SIZE_CLASS_SLAB_SIZE / class_size, 16),
+                                        name);
+                if (!pool)
+                        return -1;
+                gf_mem_size_classes[i] = pool;
+        }
+
+        return 0;
 }
 
 
+//ȡջ 8 ֽڷֿһµֵʱ CAS ʧ
+static inline void
+mem_pool_lf_read (struct mem_pool *pool, mem_pool_lf_stack_t *old)
+{
+        old->tag = __atomic_load_n (&pool->lf_free->tag, __ATOMIC_ACQUIRE);
+        old->top = __atomic_load_n (&pool->lf_free->top, __ATOMIC_ACQUIRE);
+}
+
+// first  last Ѿõһڴѹջ
+static void
+mem_pool_lf_push_chain (struct mem_pool *pool, struct list_head *first,
+                        struct list_head *last)
+{
+        mem_pool_lf_stack_t old;
+        mem_pool_lf_stack_t new;
+
+        do {
+                mem_pool_lf_read (pool, &old);
+                last->next = old.top;
+                new.top = first;
+                new.tag = old.tag;
+        } while (!__sync_bool_compare_and_swap (&pool->lf_free->full,
+                                                old.full, new.full));
+}
+
+static struct list_head *
+mem_pool_lf_pop (struct mem_pool *pool)
+{
+        mem_pool_lf_stack_t old;
+        mem_pool_lf_stack_t new;
+
+        do {
+                mem_pool_lf_read (pool, &old);
+                if (!old.top)
+                        return NULL;
+                /* old.top Ѿ߳ȡߣģʽ slab 
+                 * ͷţ next ʹǾֵ汾ҲѾˣCAS ʧ */
+                new.top = old.top->next;
+                new.tag = old.tag + 1;
+        } while (!__sync_bool_compare_and_swap (&pool->lf_free->full,
+                                                old.full, new.full));
+
+        return old.top;
+}
+
+//һ slab߳ pool->lockʧܷ -1
+static int
+__mem_pool_slab_new (struct mem_pool *pool)
+{
+        struct mem_pool_slab *slab = NULL;
+        struct list_head     *list = NULL;
+        void                 *start = NULL;
+        size_t                map_size = 0;
+        long                  page_size = sysconf (_SC_PAGESIZE);
+        unsigned long         i = 0;
+
+        slab = GF_CALLOC (1, sizeof (*slab), gf_common_mt_mem_pool);
+        if (!slab)
+                return -1;
+
+        // mmap 䣬slab ͷʱ munmap ϵͳ
+        map_size = pool->slab_count * pool->padded_sizeof_type;
+        map_size = (map_size + page_size - 1) & ~(page_size - 1);
+        start = mmap (NULL, map_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (start == MAP_FAILED) {
+                LOG_PRINT(D_LOG_CRIT,"mem-pool mmap %zu failed, errno %d",
+                          map_size, errno);
+                GF_FREE (slab);
+                return -1;
+        }
+
+        /* NUMA ڴ: ڱڵ䣬(ڵ߳)״ηÿһҳ
+         * mbind ʧʱֻ˻Ϊͨ first-touch */
+        if (pool->node >= 0) {
+                if (!mem_pool_numa_fake_nodes) {
+                        unsigned long nodemask[GF_MEM_POOL_MAX_NODES / (8 * sizeof (unsigned long))] = {0,};
+
+                        nodemask[pool->node / (8 * sizeof (unsigned long))] |=
+                                1UL << (pool->node % (8 * sizeof (unsigned long)));
+                        if (syscall (SYS_mbind, start, map_size, MPOL_PREFERRED,
+                                     nodemask, GF_MEM_POOL_MAX_NODES + 1, 0))
+                                LOG_PRINT(D_LOG_WARN,"mem-pool mbind node %d failed, errno %d",
+                                          pool->node, errno);
+                }
+                for (i = 0; i < map_size; i += page_size)
+                        *((char *)start + i) = 0;
+        }
+
+        slab->pool = pool;
+        slab->start = start;
+        slab->end = start + pool->slab_count * pool->padded_sizeof_type;
+        slab->map_size = map_size;
+        slab->count = pool->slab_count;
+        slab->cold_count = pool->slab_count;
+        INIT_LIST_HEAD (&slab->free_list);
+
+        for (i = 0; i < pool->slab_count; i++) {
+                list = start + (i * pool->padded_sizeof_type);
+                INIT_LIST_HEAD (list);
+                *mem_pool_slab_from_ptr ((void *)list) = slab;
+                if (pool->lockfree)
+                        list->next = (void *)list + pool->padded_sizeof_type;
+                else
+                        list_add_tail (list, &slab->free_list);
+        }
+
+        //ģʽ:  slab һѹջslab ֻ slab_list 
+        if (pool->lockfree) {
+                slab->cold_count = 0;
+                mem_pool_lf_push_chain (pool, start, list);
+        }
+
+        list_add (&slab->list, &pool->slab_list);
+        __sync_fetch_and_add (&pool->cold_count, slab->count);
+        pool->nr_slabs++;
+        if (pool->max_slabs < pool->nr_slabs)
+                pool->max_slabs = pool->nr_slabs;
+
+        return 0;
+}
+
+// slab ϵͳ߳ pool->lockslab еڴ붼 free_list 
+static void
+__mem_pool_slab_free (struct mem_pool *pool, struct mem_pool_slab *slab)
+{
+        list_del (&slab->list);
+        pool->cold_count -= slab->cold_count;
+        pool->nr_slabs--;
+
+        munmap (slab->start, slab->map_size);
+        GF_FREE (slab);
+}
+
+// slab ȡһڴ飬ûпڴʱһ slab߳ pool->lock
+static struct list_head *
+__mem_pool_chunk_get (struct mem_pool *pool)
+{
+        struct mem_pool_slab *slab = NULL;
+        struct list_head     *list = NULL;
+
+        if (list_empty (&pool->slab_list)) {
+                pool->pool_misses++;
+                if (__mem_pool_slab_new (pool))
+                        return NULL;
+        }
+
+        slab = list_entry (pool->slab_list.next, struct mem_pool_slab, list);
+        list = slab->free_list.next;
+        list_del (list);
+        slab->cold_count--;
+        pool->cold_count--;
+
+        if (!slab->cold_count)
+                list_move (&slab->list, &pool->full_slab_list);
+
+        return list;
+}
+
+/* ڴ黹 slab߳ pool->lock
+ * slab ȫ cold_count  hiwat ʱ slab ϵͳٱһ slab */
+static void
+__mem_pool_chunk_put (struct mem_pool *pool, struct list_head *list)
+{
+        struct mem_pool_slab *slab = *mem_pool_slab_from_ptr ((void *)list);
+
+        list_add (list, &slab->free_list);
+        if (!slab->cold_count)
+                list_move (&slab->list, &pool->slab_list);
+        slab->cold_count++;
+        pool->cold_count++;
+
+        if (slab->cold_count < slab->count)
+                return;
+
+        if (pool->cold_count > pool->hiwat && pool->nr_slabs > 1) {
+                __mem_pool_slab_free (pool, slab);
+                return;
+        }
+
+        //ȫյ slab ŵ󣬾䣬ԱԺܻϵͳ
+        list_move_tail (&slab->list, &pool->slab_list);
+}
+
+//ģʽȡһڴ飬ջʱһ slab
+static struct list_head *
+mem_pool_lf_chunk_get (struct mem_pool *pool)
+{
+        struct list_head *list = NULL;
+
+        list = mem_pool_lf_pop (pool);
+        if (!list) {
+                LOCK (&pool->lock);
+                {
+                        //ܱ߳Ѿ slab
+                        list = mem_pool_lf_pop (pool);
+                        if (!list) {
+                                pool->pool_misses++;
+                                if (__mem_pool_slab_new (pool) == 0)
+                                        list = mem_pool_lf_pop (pool);
+                        }
+                }
+                UNLOCK (&pool->lock);
+        }
+
+        if (list)
+                __sync_fetch_and_sub (&pool->cold_count, 1);
+
+        return list;
+}
+
+//̻߳еڴͳݻڴأ߳ pool->lock
+static void
+__mem_pool_tcache_flush (struct mem_pool *pool, struct mem_pool_tcache *tc)
+{
+        int i = 0;
+
+        for (i = 0; i < tc->count; i++)
+                __mem_pool_chunk_put (pool, tc->chunks[i]);
+
+        pool->hot_count += tc->hot_count;
+        pool->alloc_count += tc->alloc_count;
+
+        tc->count = 0;
+        tc->hot_count = 0;
+        tc->alloc_count = 0;
+}
+
+//߳˳ʱ pthread (tcache_key )
+static void
+mem_pool_tcache_destroy (void *data)
+{
+        struct mem_pool_tcache *tc = data;
+        struct mem_pool        *pool = tc->pool;
+
+        LOCK (&pool->lock);
+        {
+                __mem_pool_tcache_flush (pool, tc);
+                list_del (&tc->list);
+        }
+        UNLOCK (&pool->lock);
+
+        FREE (tc);
+}
+
+//ȡñ̵߳Ļ棬һʹʱ
+static struct mem_pool_tcache *
+mem_pool_tcache_get (struct mem_pool *pool)
+{
+        struct mem_pool_tcache *tc = NULL;
+
+        if (!pool->magazine_size)
+                return NULL;
+
+        tc = pthread_getspecific (pool->tcache_key);
+        if (tc)
+                return tc;
+
+        tc = CALLOC (1, sizeof (*tc) + pool->magazine_size * sizeof (void *));
+        if (!tc)
+                return NULL;
+
+        tc->pool = pool;
+        INIT_LIST_HEAD (&tc->list);
+        if (pthread_setspecific (pool->tcache_key, tc)) {
+                FREE (tc);
+                return NULL;
+        }
+
+        LOCK (&pool->lock);
+        {
+                list_add (&tc->list, &pool->tcache_list);
+        }
+        UNLOCK (&pool->lock);
+
+        return tc;
+}
+
+// max_alloc: ڴغ̻߳ʹõڴ֮ͣ߳ pool->lock
+//̵߳ļȡ refill ֮ķֵ©ÿ̰߳ջ
+static void
+__mem_pool_max_alloc_update (struct mem_pool *pool)
+{
+        struct mem_pool_tcache *tc = NULL;
+        int                     hot = pool->hot_count;
+
+        list_for_each_entry (tc, &pool->tcache_list, list)
+                hot += __atomic_load_n (&tc->hot_count, __ATOMIC_RELAXED);
+        if (pool->max_alloc < hot)
+                pool->max_alloc = hot;
+}
+
+//ջ: һδȫȡ magazine_size/2 ڴ
+static void
+mem_pool_tcache_refill (struct mem_pool *pool, struct mem_pool_tcache *tc)
+{
+        struct list_head *list = NULL;
+        int               batch = max (pool->magazine_size / 2, 1);
+
+        LOCK (&pool->lock);
+        {
+                //ջڴ鶼ֳȥˣʱʹǱ̵߳һֵ
+                __mem_pool_max_alloc_update (pool);
+                while (tc->count < batch) {
+                        list = __mem_pool_chunk_get (pool);
+                        if (!list)
+                                break;
+                        tc->chunks[tc->count++] = list;
+                }
+        }
+        UNLOCK (&pool->lock);
+}
+
+//ջ: ջ(ûõ) magazine_size/2 ڴ黹ȫ
+static void
+mem_pool_tcache_drain (struct mem_pool *pool, struct mem_pool_tcache *tc)
+{
+        int i = 0;
+        int batch = max (pool->magazine_size / 2, 1);
+
+        LOCK (&pool->lock);
+        {
+                for (i = 0; i < batch; i++)
+                        __mem_pool_chunk_put (pool, tc->chunks[i]);
+        }
+        UNLOCK (&pool->lock);
+
+        tc->count -= batch;
+        memmove (tc->chunks, tc->chunks + batch, tc->count * sizeof (void *));
+}
+
 /*½һڴضȻմݽڴĴС͸ڴ棬ҪһЩ
 洢ݵڴָΪЩڴضͨͨ
 ģʶڴǷڱʹõһ־
 http://blog.csdn.net/wangyuling1234567890/article/details/24564891
 */
-struct mem_pool *
-mem_pool_new_fn (unsigned long sizeof_type,
-                 unsigned long count, char *name)//˼ǣÿĳȣڴطĸڴص֡
+static struct mem_pool *
+__mem_pool_new (unsigned long sizeof_type,
+                unsigned long count, char *name, int node)//˼ǣÿĳȣڴطĸڴص֣ NUMA ڵ㡣
 {
         struct mem_pool  *mem_pool = NULL;
         unsigned long     padded_sizeof_type = 0;
-        GF_UNUSED void             *pool = NULL;
-        GF_UNUSED int               i = 0;
         int               ret = 0;
-        GF_UNUSED struct list_head *list = NULL;
 
         if (!sizeof_type || !count) {
                 LOG_PRINT(D_LOG_ERR,"mem-pool invalid argument");
@@ -342,7 +958,7 @@ mem_pool_new_fn (unsigned long sizeof_type,
         }
         /*һЩ洢ݵڴ*/
         //Сռڴ+ͷ+ڴָ+intڴСin_use
-        padded_sizeof_type = sizeof_type + GF_MEM_POOL_PAD_BOUNDARY;
+        padded_sizeof_type = GF_MEM_POOL_ALIGN(sizeof_type) + GF_MEM_POOL_PAD_BOUNDARY;
 
         //ڴصͷڴռ
         mem_pool = GF_CALLOC (sizeof (*mem_pool), 1, gf_common_mt_mem_pool);
@@ -359,42 +975,102 @@ mem_pool_new_fn (unsigned long sizeof_type,
         }
 
         LOCK_INIT (&mem_pool->lock);
-        INIT_LIST_HEAD (&mem_pool->list);
+        INIT_LIST_HEAD (&mem_pool->slab_list);
+        INIT_LIST_HEAD (&mem_pool->full_slab_list);
         INIT_LIST_HEAD (&mem_pool->global_list);
+        INIT_LIST_HEAD (&mem_pool->tcache_list);
+        mem_pool->node = node;
+
+        //̻߳棬pthread key ʱ˻صֻȫķʽģʽ NUMA ڴز̻߳
+        mem_pool->lockfree = mem_pool_lockfree;
+        mem_pool->magazine_size = mem_pool->lockfree ? 0 : mem_pool_magazine_size;
+        if (node == GF_MEM_POOL_NUMA_PARENT)
+                mem_pool->magazine_size = 0;
+        if (mem_pool->lockfree &&
+            posix_memalign ((void **)&mem_pool->lf_free,
+                            sizeof (mem_pool_lf_stack_t),
+                            sizeof (mem_pool_lf_stack_t))) {
+                GF_FREE (mem_pool->name);
+                GF_FREE (mem_pool);
+                return NULL;
+        }
+        if (mem_pool->lf_free)
+                memset (mem_pool->lf_free, 0, sizeof (mem_pool_lf_stack_t));
+        if (mem_pool->magazine_size) {
+                if (pthread_key_create (&mem_pool->tcache_key,
+                                        mem_pool_tcache_destroy) == 0)
+                        mem_pool->tcache_key_valid = 1;
+                else
+                        mem_pool->magazine_size = 0;
+        }
 
         //ܵĶڴСڴеÿʵʷڴС
         mem_pool->padded_sizeof_type = padded_sizeof_type;
         //ʹڴضʵڴС
         mem_pool->real_sizeof_type = sizeof_type;
 
-        //տʼģδʹõģ
-        mem_pool->cold_count = count;
-        pool = GF_CALLOC (count, padded_sizeof_type, gf_common_mt_long);
-        if (!pool) {
+        //ÿ slab  count ڴ飬ĬϿڴ鳬 slab ʱ黹ȫյ slab
+        mem_pool->slab_count = count;
+        mem_pool->hiwat = 2 * count;
+
+        //һ slabտʼģδʹõģ
+        if (node != GF_MEM_POOL_NUMA_PARENT && __mem_pool_slab_new (mem_pool)) {
+                if (mem_pool->tcache_key_valid)
+                        pthread_key_delete (mem_pool->tcache_key);
+                free (mem_pool->lf_free);
                 GF_FREE (mem_pool->name);
                 GF_FREE (mem_pool);
                 return NULL;
         }
 
-        for (i = 0; i < count; i++) {
-                //ÿһڴС
-                list = pool + (i * (padded_sizeof_type));
-                //ڴǰǴͷ GF_MEM_POOL_LIST_BOUNDARY
-                INIT_LIST_HEAD (list);
-                //뵽ڴصȥ
-                list_add_tail (list, &mem_pool->list);
-        }
-
-        //¼ڴ
-        mem_pool->pool = pool;
-        //ڴĵַ 
-        mem_pool->pool_end = pool + (count * (padded_sizeof_type));
-
         /* add this pool to the global list */
         
-        //ȫֵڴ ڴع: mempool_list 
+        //ȫֵڴ ڴع: mempool_list ϣNUMA ڴɸڴع
         
-        list_add (&mem_pool->global_list, &mempool_list);
+        if (node < 0) {
+                LOCK (&mempool_list_lock);
+                list_add (&mem_pool->global_list, &mempool_list);
+                UNLOCK (&mempool_list_lock);
+        }
+
+        return mem_pool;
+}
+
+struct mem_pool *
+mem_pool_new_fn (unsigned long sizeof_type,
+                 unsigned long count, char *name)
+{
+        struct mem_pool  *mem_pool = NULL;
+        int               nr_nodes = 0;
+        int               i = 0;
+
+        nr_nodes = gf_mem_pool_numa_nodes ();
+        if (!mem_pool_numa || nr_nodes <= 1)
+                return __mem_pool_new (sizeof_type, count, name,
+                                       GF_MEM_POOL_NO_NODE);
+
+        //NUMA: ÿڵһڴأslab ڵһʹʱŷ䵽ڵ
+        mem_pool = __mem_pool_new (sizeof_type, count, name,
+                                   GF_MEM_POOL_NUMA_PARENT);
+        if (!mem_pool)
+                return NULL;
+
+        mem_pool->node_pools = GF_CALLOC (nr_nodes, sizeof (struct mem_pool *),
+                                          gf_common_mt_mem_pool);
+        if (!mem_pool->node_pools) {
+                mem_pool_destroy (mem_pool);
+                return NULL;
+        }
+        mem_pool->nr_nodes = nr_nodes;
+
+        for (i = 0; i < nr_nodes; i++) {
+                mem_pool->node_pools[i] = __mem_pool_new (sizeof_type, count,
+                                                          name, i);
+                if (!mem_pool->node_pools[i]) {
+                        mem_pool_destroy (mem_pool);
+                        return NULL;
+                }
+        }
 
         return mem_pool;
 }
@@ -420,79 +1096,100 @@ mem_get0 (struct mem_pool *mem_pool)
 
 /*Ҫʹڴеڴ棬ôʹڴóһ󣨲ͬҪ
 ͬڴض󱣴棬ÿһڴضֻһֶڴṹڴ*/
-void *
-mem_get (struct mem_pool *mem_pool)
+/* numa_miss  0 ʾ NUMA ڴڵ(ڵδ֪)̷߳䡣
+ * ϵͳ׼ڴûа󶨽ڵ㣬ͬ numa_miss */
+static void *
+__mem_get (struct mem_pool *mem_pool, int numa_miss)
 {
         struct list_head *list = NULL;
         void             *ptr = NULL;
         int             *in_use = NULL;
         struct mem_pool **pool_ptr = NULL;
+        struct mem_pool_tcache *tc = NULL;
+        int               hot_count = 0;
+
+        if (numa_miss)
+                __sync_fetch_and_add (&mem_pool->numa_miss, 1);
+
+        //ȴӱ̻߳ȡü
+        tc = mem_pool_tcache_get (mem_pool);
+        if (tc) {
+                if (!tc->count)
+                        mem_pool_tcache_refill (mem_pool, tc);
+                if (tc->count) {
+                        ptr = tc->chunks[--tc->count];
+                        tc->alloc_count++;
+                        tc->hot_count++;
+
+                        in_use = mem_pool_in_use_ptr (ptr);
+                        *in_use = 1;
+                        pool_ptr = mem_pool_from_ptr (ptr);
+                        *pool_ptr = (struct mem_pool *)mem_pool;
 
-        if (!mem_pool) {
-                LOG_PRINT(D_LOG_ERR,"mem-pool invalid argument");
-                return NULL;
+                        return mem_pool_chunkhead2ptr (ptr);
+                }
+        }
+
+        //ģʽ
+        if (mem_pool->lockfree) {
+                __sync_fetch_and_add (&mem_pool->alloc_count, 1);
+                ptr = mem_pool_lf_chunk_get (mem_pool);
+                if (ptr) {
+                        hot_count = __sync_add_and_fetch (&mem_pool->hot_count, 1);
+                        //max_alloc £ֻǽֵ
+                        if (mem_pool->max_alloc < hot_count)
+                                mem_pool->max_alloc = hot_count;
+
+                        in_use = mem_pool_in_use_ptr (ptr);
+                        *in_use = 1;
+                        pool_ptr = mem_pool_from_ptr (ptr);
+                        *pool_ptr = (struct mem_pool *)mem_pool;
+
+                        return mem_pool_chunkhead2ptr (ptr);
+                }
         }
 
         LOCK (&mem_pool->lock);
         {
-                //ڴ1
-                mem_pool->alloc_count++;
-                //δʹڴ
-                if (mem_pool->cold_count) {
-                        //ֻδʹõڴ
-                        list = mem_pool->list.next;
-                        list_del (list);
-
+                //ڴ1ģʽѾӹ
+                if (!mem_pool->lockfree)
+                        mem_pool->alloc_count++;
+                //δʹڴ棬һ slab
+                list = mem_pool->lockfree ? NULL : __mem_pool_chunk_get (mem_pool);
+                if (list) {
                         //ʹڴ1
                         mem_pool->hot_count++;
-                        //δʹڴ1
-                        mem_pool->cold_count--;
 
                         if (mem_pool->max_alloc < mem_pool->hot_count)
                                 mem_pool->max_alloc = mem_pool->hot_count;
 
                         ptr = list;
                         //in_use ڴλ
-                        in_use = (ptr + GF_MEM_POOL_LIST_BOUNDARY +
-                                  GF_MEM_POOL_PTR);
+                        in_use = mem_pool_in_use_ptr (ptr);
                         //1ʾʹ
                         *in_use = 1;
 
                         goto fwd_addr_out;
                 }
 
-                /* This is a problem area. If we've run out of
-                 * chunks in our slab above, we need to allocate
-                 * enough memory to service this request.
-                 * The problem is, these individual chunks will fail
-                 * the first address range check in __is_member. Now, since
-                 * we're not allocating a full second slab, we wont have
-                 * enough info perform the range check in __is_member.
-                 *
-                 * I am working around this by performing a regular allocation
-                 * , just the way the caller would've done when not using the
-                 * mem-pool. That also means, we're not padding the size with
-                 * the list_head structure because, this will not be added to
-                 * the list of chunks that belong to the mem-pool allocated
-                 * initially.
-                 *
-                 * This is the best we can do without adding functionality for
-                 * managing multiple slabs. That does not interest us at present
-                 * because it is too much work knowing that a better slab
-                 * allocator is coming RSN.
+                /* We could not grow the pool by a whole slab (mmap failed),
+                 * so fall back to a regular allocation, just the way the
+                 * caller would've done when not using the mem-pool. Its slab
+                 * pointer stays NULL, which is how __is_member tells it
+                 * apart from a pooled chunk.
                  */
-                //ǰڴ治cold_countΪ0
-                mem_pool->pool_misses++; //ڴȱʧ1
                 mem_pool->curr_stdalloc++; //ϵͳ׼1  
                 if (mem_pool->max_stdalloc < mem_pool->curr_stdalloc)
                         mem_pool->max_stdalloc = mem_pool->curr_stdalloc;
                 ptr = GF_CALLOC (1, mem_pool->padded_sizeof_type,
                                  gf_common_mt_mem_pool);//һڴض
-
-                /* Memory coming from the heap need not be transformed from a
-                 * chunkhead to a usable pointer since it is not coming from
-                 * the pool.
-                 */
+                if (!ptr) {
+                        mem_pool->curr_stdalloc--;
+                        UNLOCK (&mem_pool->lock);
+                        return NULL;
+                }
+                if (mem_pool->node >= 0 && !numa_miss)
+                        __sync_fetch_and_add (&mem_pool->numa_miss, 1);
         }
 fwd_addr_out:
         pool_ptr = mem_pool_from_ptr (ptr);// poolַ:ptr+LIST_BOUNDARY
@@ -503,6 +1200,26 @@ fwd_addr_out:
         return ptr;
 }
 
+void *
+mem_get (struct mem_pool *mem_pool)
+{
+        int node = 0;
+
+        if (!mem_pool) {
+                LOG_PRINT(D_LOG_ERR,"mem-pool invalid argument");
+                return NULL;
+        }
+
+        if (!mem_pool->node_pools)
+                return __mem_get (mem_pool, 0);
+
+        //NUMA: ӱ߳ڽڵڴȡڵδ֪ʱýڵ 0Ϊ numa_miss
+        node = mem_pool_numa_node ();
+        if (node < 0 || node >= mem_pool->nr_nodes)
+                return __mem_get (mem_pool->node_pools[0], 1);
+        return __mem_get (mem_pool->node_pools[node], 0);
+}
+
 /*ʹһڴеڴṹԺҪڴԱ㱻Ժĳʹã
 ﵽѭʹõĿġڹ黹ǰҪжǲڴضһԱ
 жϵĽֱ֣ǣǣǺʹڴصڴ淶Χڣ
@@ -510,15 +1227,25 @@ fwd_addr_out:
 static int
 __is_member (struct mem_pool *pool, void *ptr) //жptrָڴǷpoolĳԱ
 {
+        struct mem_pool_slab *slab = NULL;
+        void                 *head = NULL;
+
         if (!pool || !ptr) {
                 LOG_PRINT(D_LOG_ERR,"mem-pool invalid argument");
                 return -1;
         }
 
-        if (ptr < pool->pool || ptr >= pool->pool_end) //ptrpoolʼķΧھͲ
+        head = mem_pool_ptr2chunkhead (ptr);
+
+        //ڴͷм¼ slabO(1) ҵϵͳڴΪ NULL
+        slab = *mem_pool_slab_from_ptr (head);
+        if (!slab)
                 return 0;
 
-        if ((mem_pool_ptr2chunkhead (ptr) - pool->pool)
+        if (slab->pool != pool || head < slab->start || head >= slab->end)
+                return -1;
+
+        if ((head - slab->start)
             % pool->padded_sizeof_type)//жǷһڴСڴ
                 return -1;
 
@@ -534,6 +1261,7 @@ mem_put (void *ptr)
         void   *head = NULL;
         struct mem_pool **tmp = NULL;
         struct mem_pool *pool = NULL;
+        struct mem_pool_tcache *tc = NULL;
 
         if (!ptr) {
                 LOG_PRINT(D_LOG_ERR,"mem-pool invalid argument");
@@ -554,41 +1282,72 @@ mem_put (void *ptr)
                 LOG_PRINT(D_LOG_ERR,"mem-pool ptr is NULL");
                 return;
         }
+
+        //NUMA ڴ: ڴǻڵĽڵ㣬ֻͳƿڵͷ
+        if (pool->node >= 0 && pool->node != mem_pool_numa_node ())
+                __sync_fetch_and_add (&pool->numa_remote_free, 1);
+
+        //ģʽ:  CAS  in_use߳ͬʱظͷҲֻһɹ
+        if (pool->lockfree && __is_member (pool, ptr) == 1) {
+                in_use = mem_pool_in_use_ptr (head);
+                if (!__sync_bool_compare_and_swap (in_use, 1, 0)) {
+                        LOG_PRINT(D_LOG_ERR,"mem-pool mem_put called on freed ptr %p of mem "
+                                          "pool %p", ptr, pool);
+                        return;
+                }
+                __sync_fetch_and_sub (&pool->hot_count, 1);
+                __sync_fetch_and_add (&pool->cold_count, 1);
+                mem_pool_lf_push_chain (pool, list, list);
+                return;
+        }
+
+        //ڴеڴȷŻر̻߳棬ڴû黹ʱ slab ᱻͷţԲж
+        if (__is_member (pool, ptr) == 1 &&
+            (tc = mem_pool_tcache_get (pool)) != NULL) {
+                in_use = mem_pool_in_use_ptr (head);
+                if (!is_mem_chunk_in_use(in_use)) {
+                        LOG_PRINT(D_LOG_ERR,"mem-pool mem_put called on freed ptr %p of mem "
+                                          "pool %p", ptr, pool);
+                        return;
+                }
+                *in_use = 0;
+
+                if (tc->count == pool->magazine_size)
+                        mem_pool_tcache_drain (pool, tc);
+                tc->chunks[tc->count++] = head;
+                tc->hot_count--;
+                return;
+        }
+
         LOCK (&pool->lock);
         {
 
                 switch (__is_member (pool, ptr))
                 {
                 case 1:
-                        in_use = (head + GF_MEM_POOL_LIST_BOUNDARY +
-                                  GF_MEM_POOL_PTR);
+                        in_use = mem_pool_in_use_ptr (head);
                         if (!is_mem_chunk_in_use(in_use)) {
                                 LOG_PRINT(D_LOG_ERR,"mem-pool mem_put called on freed ptr %p of mem "
                                                   "pool %p", ptr, pool);
                                 break;
                         }
                         pool->hot_count--;
-                        pool->cold_count++;
                         *in_use = 0;
-                        list_add (list, &pool->list);
+                        __mem_pool_chunk_put (pool, list);
                         break;
                 case -1:
-                        /* For some reason, the address given is within
-                         * the address range of the mem-pool but does not align
-                         * with the expected start of a chunk that includes
-                         * the list headers also. Sounds like a problem in
-                         * layers of clouds up above us. ;)
+                        /* For some reason, the chunk header points to a slab
+                         * that does not belong to this pool, or the address
+                         * does not align with the expected start of a chunk
+                         * in that slab. Sounds like a problem in layers of
+                         * clouds up above us. ;)
                          */
                         abort ();
                         break;
                 case 0: //ڴеڴֱͷŵ
-                        /* The address is outside the range of the mem-pool. We
-                         * assume here that this address was allocated at a
-                         * point when the mem-pool was out of chunks in mem_get
-                         * or the programmer has made a mistake by calling the
-                         * wrong de-allocation interface. We do
-                         * not have enough info to distinguish between the two
-                         * situations.
+                        /* The chunk has no slab. We assume here that it was
+                         * allocated at a point when the mem-pool could not
+                         * grow by another slab in mem_get.
                          */
                         
                         pool->curr_stdalloc--; //ϵͳ1;
@@ -607,16 +1366,46 @@ mem_put (void *ptr)
 void
 mem_pool_destroy (struct mem_pool *pool)
 {
+        struct mem_pool_tcache *tc = NULL;
+        struct mem_pool_tcache *tmp = NULL;
+        struct mem_pool_slab   *slab = NULL;
+        struct mem_pool_slab   *tmp_slab = NULL;
+        int                     i = 0;
+
         if (!pool)
                 return;
+
+        if (pool->node_pools) {
+                for (i = 0; i < pool->nr_nodes; i++)
+                        mem_pool_destroy (pool->node_pools[i]);
+                GF_FREE (pool->node_pools);
+        }
+
+        //û˳̵߳Ļͷţ֮Щ̲߳ʹøڴ
+        if (pool->tcache_key_valid) {
+                pthread_key_delete (pool->tcache_key);
+                list_for_each_entry_safe (tc, tmp, &pool->tcache_list, list) {
+                        __mem_pool_tcache_flush (pool, tc);
+                        list_del (&tc->list);
+                        FREE (tc);
+                }
+        }
+
         LOG_PRINT(D_LOG_INFO,"size=%lu max=%d total=%"PRIu64,
                 pool->padded_sizeof_type, pool->max_alloc, pool->alloc_count);
 
+        LOCK (&mempool_list_lock);
         list_del (&pool->global_list);//ȫڴض
+        UNLOCK (&mempool_list_lock);
+
+        list_for_each_entry_safe (slab, tmp_slab, &pool->slab_list, list)
+                __mem_pool_slab_free (pool, slab);
+        list_for_each_entry_safe (slab, tmp_slab, &pool->full_slab_list, list)
+                __mem_pool_slab_free (pool, slab);
 
         LOCK_DESTROY (&pool->lock);
+        free (pool->lf_free);
         GF_FREE (pool->name);
-        GF_FREE (pool->pool);
         GF_FREE (pool);
 
         return;
@@ -749,27 +1538,413 @@ proc_dump_mem_info ()
         return;
 }
 
+/*
+ * ڴغ̻߳ͳݡ̻߳ļȡֻǽֵ
+ * nowait  0 ʱȴ pool->lock(SIGUSR1 źŴãϵ߳̿
+ * и): òֻɢضڴԼļ̻߳(߳
+ * ɾڵ) 1 ʾ
+ */
+static int
+__mem_pool_stats_aggregate (struct mem_pool *pool, int *hot_count,
+                            int *cold_count, uint64_t *alloc_count, int nowait)
+{
+        struct mem_pool_tcache *tc = NULL;
+        int                     hot = 0;
+        int                     cold = 0;
+        uint64_t                alloc = 0;
+        int                     node_hot = 0;
+        int                     node_cold = 0;
+        uint64_t                node_alloc = 0;
+        int                     partial = 0;
+        int                     i = 0;
+
+        //NUMA ڴ: ڵڴ֮
+        for (i = 0; i < pool->nr_nodes; i++) {
+                partial |= __mem_pool_stats_aggregate (pool->node_pools[i],
+                                                       &node_hot, &node_cold,
+                                                       &node_alloc, nowait);
+                hot += node_hot;
+                cold += node_cold;
+                alloc += node_alloc;
+        }
+
+        if (nowait && TRY_LOCK (&pool->lock) != 0) {
+                hot += __atomic_load_n (&pool->hot_count, __ATOMIC_RELAXED);
+                cold += __atomic_load_n (&pool->cold_count, __ATOMIC_RELAXED);
+                alloc += __atomic_load_n (&pool->alloc_count, __ATOMIC_RELAXED);
+                partial = 1;
+                goto out;
+        }
+        if (!nowait)
+                LOCK (&pool->lock);
+        {
+                hot += pool->hot_count;
+                cold += pool->cold_count;
+                alloc += pool->alloc_count;
+                list_for_each_entry (tc, &pool->tcache_list, list) {
+                        hot += tc->hot_count;
+                        cold += tc->count;
+                        alloc += tc->alloc_count;
+                }
+                if (pool->max_alloc < hot)
+                        pool->max_alloc = hot;
+        }
+        UNLOCK (&pool->lock);
+
+out:
+        if (hot_count)
+                *hot_count = hot;
+        if (cold_count)
+                *cold_count = cold;
+        if (alloc_count)
+                *alloc_count = alloc;
+        return partial;
+}
+
+void
+mem_pool_stats_aggregate (struct mem_pool *pool, int *hot_count,
+                          int *cold_count, uint64_t *alloc_count)
+{
+        __mem_pool_stats_aggregate (pool, hot_count, cold_count, alloc_count, 0);
+}
+
 void
 gf_proc_dump_mempool_info ()
 {
         struct mem_pool *pool = NULL;
+        struct mem_pool *node_pool = NULL;
+        int              i = 0;
+        int              hot_count = 0;
+        int              cold_count = 0;
+        uint64_t         alloc_count = 0;
+        int              partial = 0;
+        int              tries = 0;
+        struct timespec  delay = {0, 1000000};
 
         gf_proc_dump_add_section ("mempool");
 
+        /*  SIGUSR1 źŴϵ߳̿ mempool_list_lock
+         * (/ڴ)ܵȡͳƵ̳߳ʱ̣ܶԵȼ */
+        while (TRY_LOCK (&mempool_list_lock) != 0) {
+                if (++tries > GF_DUMP_LOCK_TRIES) {
+                        gf_proc_dump_write ("mempool-list", "busy");
+                        return;
+                }
+                nanosleep (&delay, NULL);
+        }
         list_for_each_entry (pool, &mempool_list, global_list) {
+                //źŴܵ pool->lock
+                partial = __mem_pool_stats_aggregate (pool, &hot_count,
+                                                      &cold_count,
+                                                      &alloc_count, 1);
                 gf_proc_dump_write ("-----", "-----");
                 gf_proc_dump_write ("pool-name", "%s", pool->name);
-                gf_proc_dump_write ("hot-count", "%d", pool->hot_count);
-                gf_proc_dump_write ("cold-count", "%d", pool->cold_count);
+                if (partial)
+                        gf_proc_dump_write ("stats-partial", "%d", partial);
+                gf_proc_dump_write ("hot-count", "%d", hot_count);
+                gf_proc_dump_write ("cold-count", "%d", cold_count);
                 gf_proc_dump_write ("padded_sizeof", "%lu",
                                     pool->padded_sizeof_type);
-                gf_proc_dump_write ("alloc-count", "%"PRIu64, pool->alloc_count);
+                gf_proc_dump_write ("alloc-count", "%"PRIu64, alloc_count);
                 gf_proc_dump_write ("max-alloc", "%d", pool->max_alloc);
 
                 gf_proc_dump_write ("pool-misses", "%"PRIu64, pool->pool_misses);
                 gf_proc_dump_write ("cur-stdalloc", "%d", pool->curr_stdalloc);
                 gf_proc_dump_write ("max-stdalloc", "%d", pool->max_stdalloc);
+                gf_proc_dump_write ("slab-count", "%d", pool->nr_slabs);
+                gf_proc_dump_write ("max-slab-count", "%d", pool->max_slabs);
+                gf_proc_dump_write ("slab-hiwat", "%lu", pool->hiwat);
+
+                for (i = 0; i < pool->nr_nodes; i++) {
+                        node_pool = pool->node_pools[i];
+                        __mem_pool_stats_aggregate (node_pool, &hot_count,
+                                                    &cold_count, &alloc_count,
+                                                    1);
+                        gf_proc_dump_write ("numa-node", "%d", node_pool->node);
+                        gf_proc_dump_write ("numa-hit", "%"PRIu64,
+                                            alloc_count - node_pool->numa_miss);
+                        gf_proc_dump_write ("numa-miss", "%"PRIu64,
+                                            node_pool->numa_miss);
+                        gf_proc_dump_write ("numa-remote-free", "%"PRIu64,
+                                            node_pool->numa_remote_free);
+                        gf_proc_dump_write ("numa-hot-count", "%d", hot_count);
+                        gf_proc_dump_write ("numa-slab-count", "%d",
+                                            node_pool->nr_slabs);
+                }
+        }
+        UNLOCK (&mempool_list_lock);
+}
+
+//ȡڴͳƿգֻڻʱݳ pool->lockӰ mem_get/mem_put ̻߳·
+int
+mem_pool_stats_snapshot (struct mem_pool *pool, struct mem_pool_stats *stats)
+{
+        struct mem_pool *node_pool = NULL;
+        int              i = 0;
+
+        if (!pool || !stats)
+                return -1;
+
+        memset (stats, 0, sizeof (*stats));
+        mem_pool_stats_aggregate (pool, &stats->hot_count, &stats->cold_count,
+                                  &stats->alloc_count);
+
+        snprintf (stats->name, sizeof (stats->name), "%s", pool->name);
+        stats->padded_sizeof_type = pool->padded_sizeof_type;
+        stats->alloc_rate = pool->alloc_rate;
+        memcpy (stats->rate_hist, pool->rate_hist, sizeof (stats->rate_hist));
+
+        LOCK (&pool->lock);
+        {
+                stats->max_alloc = pool->max_alloc;
+                stats->pool_misses = pool->pool_misses;
+                stats->curr_stdalloc = pool->curr_stdalloc;
+                stats->max_stdalloc = pool->max_stdalloc;
+                stats->nr_slabs = pool->nr_slabs;
+        }
+        UNLOCK (&pool->lock);
+
+        //NUMA ڴ: ϸڵڴ
+        for (i = 0; i < pool->nr_nodes; i++) {
+                node_pool = pool->node_pools[i];
+                LOCK (&node_pool->lock);
+                {
+                        stats->max_alloc += node_pool->max_alloc;
+                        stats->pool_misses += node_pool->pool_misses;
+                        stats->curr_stdalloc += node_pool->curr_stdalloc;
+                        stats->max_stdalloc += node_pool->max_stdalloc;
+                        stats->nr_slabs += node_pool->nr_slabs;
+                }
+                UNLOCK (&node_pool->lock);
+        }
+
+        return 0;
+}
+
+//һηʣֱͼͳƵ߳(Լ)Ե
+void
+mem_pool_stats_sample (struct mem_pool *pool)
+{
+        struct timeval   tv;
+        double           now = 0;
+        uint64_t         alloc_count = 0;
+        uint64_t         rate = 0;
+        int              bucket = 0;
+
+        if (!pool)
+                return;
+
+        gettimeofday (&tv, NULL);
+        now = tv.tv_sec + tv.tv_usec / 1000000.0;
+        mem_pool_stats_aggregate (pool, NULL, NULL, &alloc_count);
+
+        //һβֻ¼
+        if (pool->last_sample > 0 && now > pool->last_sample) {
+                rate = (alloc_count - pool->last_alloc_count) /
+                       (now - pool->last_sample);
+                bucket = rate ? 64 - __builtin_clzll (rate) : 0;
+                if (bucket >= GF_MEM_POOL_RATE_BUCKETS)
+                        bucket = GF_MEM_POOL_RATE_BUCKETS - 1;
+                pool->alloc_rate = rate;
+                pool->rate_hist[bucket]++;
         }
+
+        pool->last_alloc_count = alloc_count;
+        pool->last_sample = now;
+}
+
+//ѿոʽɺ proc dump һ key=value ıдĳ
+int
+mem_pool_stats_format (struct mem_pool_stats *stats, char *buf, size_t len)
+{
+        size_t  offset = 0;
+        int     i = 0;
+
+#define STATS_PRINT(fmt, args...)                                              \
+        do {                                                                   \
+                if (offset < len)                                              \
+                        offset += snprintf (buf + offset, len - offset,        \
+                                            fmt, ##args);                      \
+        } while (0)
+
+        STATS_PRINT ("[mempool %s]\n", stats->name);
+        STATS_PRINT ("padded_sizeof=%lu\n", stats->padded_sizeof_type);
+        STATS_PRINT ("hot-count=%d\n", stats->hot_count);
+        STATS_PRINT ("cold-count=%d\n", stats->cold_count);
+        STATS_PRINT ("alloc-count=%"PRIu64"\n", stats->alloc_count);
+        STATS_PRINT ("max-alloc=%d\n", stats->max_alloc);
+        STATS_PRINT ("pool-misses=%"PRIu64"\n", stats->pool_misses);
+        STATS_PRINT ("cur-stdalloc=%d\n", stats->curr_stdalloc);
+        STATS_PRINT ("max-stdalloc=%d\n", stats->max_stdalloc);
+        STATS_PRINT ("slab-count=%d\n", stats->nr_slabs);
+        STATS_PRINT ("alloc-rate=%"PRIu64"\n", stats->alloc_rate);
+        STATS_PRINT ("alloc-rate-hist=");
+        for (i = 0; i < GF_MEM_POOL_RATE_BUCKETS; i++) {
+                if (stats->rate_hist[i])
+                        STATS_PRINT ("%llu:%"PRIu64" ",
+                                     i ? 1ULL << (i - 1) : 0ULL,
+                                     stats->rate_hist[i]);
+        }
+        STATS_PRINT ("\n");
+
+#undef STATS_PRINT
+
+        return min (offset, len);
+}
+
+/*
+ * ͳƵ߳: ÿ interval һڴصķʣ Unix socket 
+ * ӦӣÿдڴصĿպرգ:
+ *   socat - UNIX-CONNECT:/var/run/mem_pool.sock
+ */
+static pthread_t         mem_pool_exporter_thread;
+static int               mem_pool_exporter_fd = -1;
+static int               mem_pool_exporter_interval = 1;
+static volatile int      mem_pool_exporter_stop = 0;
+static char              mem_pool_exporter_path[PATH_MAX];
+
+static void
+mem_pool_stats_sample_all ()
+{
+        struct mem_pool *pool = NULL;
+
+        LOCK (&mempool_list_lock);
+        list_for_each_entry (pool, &mempool_list, global_list)
+                mem_pool_stats_sample (pool);
+        UNLOCK (&mempool_list_lock);
+}
+
+//ڰпոʽдͻˣͻ˲ᵲסڴصĴ
+static void
+mem_pool_stats_write_all (int fd)
+{
+        struct mem_pool       *pool = NULL;
+        struct mem_pool_stats  stats;
+        char                  *buf = NULL;
+        char                  *new_buf = NULL;
+        size_t                 size = GF_DUMP_MAX_BUF_LEN;
+        size_t                 used = 0;
+        size_t                 offset = 0;
+        ssize_t                ret = 0;
+
+        buf = MALLOC (size);
+        if (!buf)
+                return;
+
+        LOCK (&mempool_list_lock);
+        list_for_each_entry (pool, &mempool_list, global_list) {
+                if (size - used < GF_DUMP_MAX_BUF_LEN) {
+                        new_buf = REALLOC (buf, size * 2);
+                        if (!new_buf)
+                                break;
+                        buf = new_buf;
+                        size *= 2;
+                }
+                mem_pool_stats_snapshot (pool, &stats);
+                used += mem_pool_stats_format (&stats, buf + used,
+                                               size - used);
+        }
+        UNLOCK (&mempool_list_lock);
+
+        while (offset < used) {
+                ret = write (fd, buf + offset, used - offset);
+                if (ret <= 0)
+                        break;
+                offset += ret;
+        }
+
+        free (buf);
+}
+
+static void *
+mem_pool_stats_exporter (void *arg)
+{
+        struct pollfd  pfd;
+        struct timeval tv;
+        double         now = 0;
+        double         last = 0;
+        int            fd = -1;
+
+        while (!mem_pool_exporter_stop) {
+                gettimeofday (&tv, NULL);
+                now = tv.tv_sec + tv.tv_usec / 1000000.0;
+                if (now - last >= mem_pool_exporter_interval) {
+                        mem_pool_stats_sample_all ();
+                        last = now;
+                }
+
+                //ȴӣ 200msԱ㼰ʱ˳
+                pfd.fd = mem_pool_exporter_fd;
+                pfd.events = POLLIN;
+                pfd.revents = 0;
+                if (poll (&pfd, 1, 200) <= 0)
+                        continue;
+
+                fd = accept (mem_pool_exporter_fd, NULL, NULL);
+                if (fd < 0)
+                        continue;
+                mem_pool_stats_write_all (fd);
+                close (fd);
+        }
+
+        return NULL;
+}
+
+//ͳƵ̣߳sock_path Ϊ Unix socket ·interval Ϊ()
+int
+gf_mem_pool_stats_exporter_start (const char *sock_path, int interval)
+{
+        struct sockaddr_un addr;
+        int                fd = -1;
+
+        if (!sock_path || mem_pool_exporter_fd >= 0)
+                return -1;
+        if (strlen (sock_path) >= sizeof (addr.sun_path))
+                return -1;
+
+        fd = socket (AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+                return -1;
+
+        memset (&addr, 0, sizeof (addr));
+        addr.sun_family = AF_UNIX;
+        strcpy (addr.sun_path, sock_path);
+        unlink (sock_path);
+        if (bind (fd, (struct sockaddr *)&addr, sizeof (addr)) ||
+            listen (fd, 16)) {
+                LOG_PRINT(D_LOG_ERR,"mem-pool stats socket %s failed, errno %d",
+                          sock_path, errno);
+                close (fd);
+                return -1;
+        }
+
+        snprintf (mem_pool_exporter_path, sizeof (mem_pool_exporter_path),
+                  "%s", sock_path);
+        mem_pool_exporter_fd = fd;
+        mem_pool_exporter_interval = max (interval, 1);
+        mem_pool_exporter_stop = 0;
+        if (pthread_create (&mem_pool_exporter_thread, NULL,
+                            mem_pool_stats_exporter, NULL)) {
+                close (fd);
+                unlink (sock_path);
+                mem_pool_exporter_fd = -1;
+                return -1;
+        }
+
+        return 0;
+}
+
+void
+gf_mem_pool_stats_exporter_stop ()
+{
+        if (mem_pool_exporter_fd < 0)
+                return;
+
+        mem_pool_exporter_stop = 1;
+        pthread_join (mem_pool_exporter_thread, NULL);
+        close (mem_pool_exporter_fd);
+        unlink (mem_pool_exporter_path);
+        mem_pool_exporter_fd = -1;
 }
 
 
@@ -190,14 +190,50 @@ out:
         return dup_mem;
 }
 
+#define GF_MEM_POOL_RATE_BUCKETS 32
+
+/*
+ * ڴɶ slab ɣÿ slab һ mmap ڴ棬г count ڴ飬
+ * ÿ slab ԼĿڴʱһ slab calloc
+ */
+struct mem_pool_slab {
+        struct list_head  list; // mem_pool->slab_list  full_slab_list 
+        struct list_head  free_list; // slab δʹڴ
+        struct mem_pool  *pool;
+        void             *start; //slab ʼַ
+        void             *end; //slab һڴĽַ
+        size_t            map_size; //mmap ĴС
+        int               count; //ڴ
+        int               cold_count; //free_list ϵڴ
+};
+
+/*
+ * ģʽµĿڴջ(Treiber stack)ڴͷ list_head  next 
+ * ջָͰ汾һ cmpxchg16b ȽϽÿ pop 汾ż 1ֹ ABA
+ * Ҫ -mcx16 롣cmpxchg16b Ҫ 16 ֽڶ룬 GF_CALLOC ڴͳƺ
+ * صĵַǰͷֻ֤ 8 ֽڶ룬ջ posix_memalign 䡣
+ */
+typedef union {
+        struct {
+                struct list_head *top; //ջڴ
+                uint64_t          tag; //汾
+        };
+        unsigned __int128 full;
+} __attribute__ ((aligned (16))) mem_pool_lf_stack_t;
+
 struct mem_pool {
-        struct list_head  list; //ڴδʹڴ 
+        mem_pool_lf_stack_t *lf_free; //ģʽĿڴջ16 ֽڶ룬ģʽΪ NULL
+        int               lockfree; //1: ģʽ slab  free_list ̻߳棬slab 黹ϵͳ
+        struct list_head  slab_list; //пڴ slabӵһʼ䣬ȫյ slab 
+        struct list_head  full_slab_list; //ûпڴ slab
         int               hot_count; //ڴѾʹڴ 
         int               cold_count; //ڴʣδʹڴ 
         gf_lock_t         lock;
         unsigned long     padded_sizeof_type; //ڴÿʵռڴС
-        void             *pool; //ڴؿʼַ
-        void             *pool_end; //ڴؽַ
+        unsigned long     slab_count; //ÿ slab ڴ
+        int               nr_slabs; //ǰ slab 
+        int               max_slabs; //slab ֵ
+        unsigned long     hiwat; //cold_count ֵʱȫյ slab ϵͳ
         int               real_sizeof_type; //ڴÿڴС 
         uint64_t          alloc_count; //ڴ:뵽 + δ뵽ڴ 
         uint64_t          pool_misses; //ڴȱٴڴڴʧܴ 
@@ -206,8 +242,58 @@ struct mem_pool {
         int               max_stdalloc;  //ϵͳ׼ 
         char             *name; //ڴ
         struct list_head  global_list; //ȫڴ THIS->ctx->mempool_list 
+        int               magazine_size; //ÿ̻߳(magazine)0 ʾʹ̻߳
+        int               tcache_key_valid; //tcache_key Ƿ񴴽ɹ
+        pthread_key_t     tcache_key; //ÿ̵߳ struct mem_pool_tcache
+        struct list_head  tcache_list; //̻߳ͳƻܣ lock 
+        int               node; //NUMA ڴڽڵ㣬ͨڴΪ -1
+        int               nr_nodes; //NUMA ڵnode_pools ĴС
+        struct mem_pool **node_pools; //NUMA ڴ: ÿڵһڴأͨڴΪ NULL
+        uint64_t          numa_miss; //ڱڵķ: ڵڵδ̷֪߳䣬˻ϵͳ׼
+        uint64_t          numa_remote_free; //ڵ߳ͷŵڵĴ
+        uint64_t          last_alloc_count; //ϴβʱ alloc_countֻ mem_pool_stats_sample ޸
+        double            last_sample; //ϴβʱ()
+        uint64_t          alloc_rate; //ϴβõÿ
+        uint64_t          rate_hist[GF_MEM_POOL_RATE_BUCKETS]; //ÿֱͼ
 };
 
+/*
+ * ڴͳƿգҪźź proc dumpʱȡ
+ * rate_hist  0 ǷΪ 0 Ĳ i  [2^(i-1), 2^i) ֮Ĳ
+ */
+struct mem_pool_stats {
+        char              name[64];
+        unsigned long     padded_sizeof_type;
+        int               hot_count;
+        int               cold_count;
+        uint64_t          alloc_count;
+        int               max_alloc;
+        uint64_t          pool_misses;
+        int               curr_stdalloc;
+        int               max_stdalloc;
+        int               nr_slabs;
+        uint64_t          alloc_rate;
+        uint64_t          rate_hist[GF_MEM_POOL_RATE_BUCKETS];
+};
+
+/*
+ * ÿ̻߳(magazine): һСڴջmem_get/mem_put ĳ·ֻ
+ * ̵߳ջ mem_pool->lockջʱȫȡ magazine_size/2 
+ * ջʱ magazine_size/2 
+ * ͳ߳ﵥۼӣҪʱ mem_pool_stats_aggregate (֤ȷ)
+ */
+struct mem_pool_tcache {
+        struct mem_pool  *pool;
+        struct list_head  list; // mem_pool->tcache_list 
+        int               count; //ջпڴ
+        int               hot_count; //߳ get  - put Ϊ
+        uint64_t          alloc_count; //̴߳ջĴ
+        void             *chunks[0]; //ڴͷַmagazine_size 
+};
+
+/* Ĭÿ̻߳Сڴڴǰ gf_mem_pool_magazine_set ޸ */
+#define GF_MEM_POOL_MAGAZINE_SIZE 64
+
 struct mem_pool *
 mem_pool_new_fn (unsigned long sizeof_type, unsigned long count, char *name);
 
@@ -225,6 +311,35 @@ int mem_acct_init (int num_types);
 
 void gf_mem_init_mempool_list ();
 
+int gf_mem_size_class_init ();
+
+void gf_mem_pool_magazine_set (int size);
+
+void gf_mem_pool_lockfree_set (int enable);
+
+void gf_mem_pool_numa_set (int enable);
+
+int gf_mem_pool_numa_nodes ();
+
+void gf_mem_pool_numa_fake_topology (int nr_nodes);
+
+void gf_mem_pool_numa_fake_bind (int node);
+
+void mem_pool_set_hiwat (struct mem_pool *pool, unsigned long hiwat);
+
+int mem_pool_stats_snapshot (struct mem_pool *pool, struct mem_pool_stats *stats);
+
+void mem_pool_stats_sample (struct mem_pool *pool);
+
+int mem_pool_stats_format (struct mem_pool_stats *stats, char *buf, size_t len);
+
+int gf_mem_pool_stats_exporter_start (const char *sock_path, int interval);
+
+void gf_mem_pool_stats_exporter_stop ();
+
+void mem_pool_stats_aggregate (struct mem_pool *pool, int *hot_count,
+                               int *cold_count, uint64_t *alloc_count);
+
 void  signals_setup();
 
 #endif /* _MEM_POOL_H */
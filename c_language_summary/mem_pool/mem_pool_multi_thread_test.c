@@ -3,92 +3,146 @@ extern "C"{
 #endif
 
 #include <stdint.h> /* uint64_t*/
+#include <unistd.h> //getopt
 #include <stdio.h>
 #include <pthread.h>
 #include "mem_pool.h"
 #include "../count_time/count_time.h"
 
-#define size  5000
-#define thread_num 1
+/*
+ * ߳ò: ̹߳һڴأÿ/ͷڴ飬
+ * ߳ڿϳͻȽ:
+ *   mem_pool_multi_thread_test        -f 0 -m 0   mutex 
+ *   mem_pool_multi_thread_test_spin   -f 0 -m 0   HAVE_SPINLOCK 
+ *   mem_pool_multi_thread_test        -f 1        ջ
+ *   mem_pool_multi_thread_test        -f 0        ̻߳
+ *   mem_pool_multi_thread_test        -c          malloc/free
+ */
+
+static int thread_num = 4 ;
+static int batch = 8 ;
+static int loop =  1000000 ;
+static int lockfree = 0 ;
+static int magazine_size = 0 ;
+static int use_malloc = 0 ;
 
 struct _test_mem_t {
-        char a[10240];
-};
-struct _test_mem_2_t {
-        char a[1022];
-};
-struct _test_mem_3_t {
-        char a[1023];
+        char a[128];
 };
 typedef struct _test_mem_t test_mem_t;
-typedef struct _test_mem_2_t test_mem_2_t;
-typedef struct _test_mem_3_t test_mem_3_t;
 
 struct mem_pool *test_mem_pool;
 
+static void usage(void)
+{
+    printf("optional arguments:\n"
+           "-h,  show this help message and exit\n"
+           "-t int,  thread num \n"
+           "-n int,  chunks get/put per round \n"
+           "-l int,  loop num \n"
+           "-f bool, lock-free free list \n"
+           "-m int,  per-thread magazine size, 0 disable \n"
+           "-c bool, use malloc instead of mem pool \n");
+}
 
 void *test_fun(void *arg)
 {
     int j;
     int i;
-    int size_t = size/thread_num;
-    printf("fun 1 size %d \n",size_t);
-    test_mem_t ** mem_array   = CALLOC(size_t,sizeof(test_mem_t * )); 
-    for(j=0; j<10000; j++){    
-            if (!test_mem_pool)
-            {
-                DBG_PRINT("create mem pool error");
-                return 0;
-            }
-        for(i=0; i<size_t; i++)
+    test_mem_t ** mem_array   = CALLOC(batch,sizeof(test_mem_t * )); 
+    for(j=0; j<loop; j++){    
+        for(i=0; i<batch; i++)
         {
             mem_array[i] = (test_mem_t *)mem_get(test_mem_pool);
         }
 
-        for(i=0; i<size_t; i++)
+        for(i=0; i<batch; i++)
         {
             mem_put(mem_array[i]) ;
         }
-
-        
     }
+    free (mem_array);
     return 0;
 }
 void *test_fun2(void *arg)
 {
     int j;
     int i;
-    int size_t = size/thread_num;
-    printf("fun 2 size %d \n",size_t);
-    test_mem_t ** mem_array   = CALLOC(size_t,sizeof(test_mem_t * )); 
-    for(j=0; j<10000; j++){
-        for(i=0; i<size_t; i++)
+    test_mem_t ** mem_array   = CALLOC(batch,sizeof(test_mem_t * )); 
+    for(j=0; j<loop; j++){
+        for(i=0; i<batch; i++)
             mem_array[i] = (test_mem_t *)MALLOC(sizeof(test_mem_t));
-        for(i=0; i<size_t; i++)
+        for(i=0; i<batch; i++)
             free (mem_array[i]);
     }
+    free (mem_array);
     return 0;
 }
 
 int32_t main(int32_t argc, char **argv)
 {
-      
+    int i = 0;
+    int c;
+    int hot_count = 0;
+    int cold_count = 0;
+    uint64_t alloc_count = 0;
+    double begin_d, end_d;
+
+    while (-1 != (c = getopt(argc, argv, "t:n:l:f:m:ch")))
+    {
+        switch (c)
+        {
+        case 't':
+            thread_num  = atoi(optarg);
+            break;
+        case 'n':
+            batch  = atoi(optarg);
+            break;
+        case 'l':
+            loop  = atoi(optarg);
+            break;
+        case 'f':
+            lockfree  = atoi(optarg);
+            break;
+        case 'm':
+            magazine_size  = atoi(optarg);
+            break;
+        case 'c':
+            use_malloc = 1;
+            break;
+        case 'h':
+        default:
+            usage();
+            exit(0);
+            break;
+        }
+    }
+
+#if HAVE_SPINLOCK
+    printf("spinlock build; ");
+#else
+    printf("mutex build; ");
+#endif
+    printf("thread_num = %d; batch = %d; loop = %d; lockfree = %d; magazine_size = %d; malloc = %d\n",
+           thread_num, batch, loop, lockfree, magazine_size, use_malloc);
 
     gf_mem_init_mempool_list();
+    gf_mem_pool_magazine_set(magazine_size);
+    gf_mem_pool_lockfree_set(lockfree);
+    test_mem_pool = mem_pool_new (test_mem_t, thread_num * (batch + magazine_size));
+    if (!test_mem_pool)
+    {
+        DBG_PRINT("create mem pool error");
+        return -1;
+    }
 
-    CPU_TIME_START;
-    TIME_START;
-    test_mem_pool = mem_pool_new (test_mem_t, size);
-    CPU_TIME_END_PRINT("mem pool");
-    TIME_END_PRINT("mem pool");
     CPU_TIME_START;
     TIME_START;
 
     pthread_t id[thread_num];
-    int i = 0;
 
     for(i=0;i<thread_num;++i){
-            pthread_create(&id[i],NULL,test_fun2,NULL);
+            pthread_create(&id[i],NULL,use_malloc ? test_fun2 : test_fun,NULL);
     }
 
     for(i=0;i<thread_num;++i){
@@ -97,9 +151,16 @@ int32_t main(int32_t argc, char **argv)
 
     CPU_TIME_END_PRINT("mem pool");
     TIME_END_PRINT("mem pool");
+
+    begin_d = tv_begin.tv_sec + tv_begin.tv_usec / 1000000.0;
+    end_d = tv_end.tv_sec + tv_end.tv_usec / 1000000.0;
+    printf("ops/s: %.0f\n", 2.0 * thread_num * batch * loop / (end_d - begin_d));
+
+    mem_pool_stats_aggregate(test_mem_pool, &hot_count, &cold_count, &alloc_count);
+    printf("hot_count = %d; cold_count = %d; alloc_count = %"PRIu64"; pool_misses = %"PRIu64"\n",
+           hot_count, cold_count, alloc_count, test_mem_pool->pool_misses);
     mem_pool_destroy(test_mem_pool);
 
-    //getchar();
     return 0;
 }
 
@@ -0,0 +1,119 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdint.h> /* uint64_t*/
+#include <stdio.h>
+#include <pthread.h>
+#include "mem_pool.h"
+
+/*
+ * NUMA ڴزԣü(4 ڵ)ڵڵҲ:
+ *   1. ÿ̰߳󶨵һٽڵ㣬ڴ鶼Աڵڴ
+ *   2. ߳ͷڵڴ飬ͳΪڵͷ
+ *   3. ڵδ̴֪߳ӽڵ 0 䣬ͳΪ numa-miss
+ *   4. ʹʵˣڵʱ˻Ϊͨڴ
+ */
+
+#define FAKE_NODES  4
+#define THREAD_NUM  8
+#define CHUNK_NUM   1000
+
+struct _test_mem_t {
+        char a[200];
+};
+typedef struct _test_mem_t test_mem_t;
+
+struct mem_pool *test_mem_pool;
+test_mem_t *chunks[THREAD_NUM][CHUNK_NUM];
+pthread_barrier_t barrier;
+
+void *test_fun(void *arg)
+{
+    int idx = (long)arg;
+    int i;
+
+    gf_mem_pool_numa_fake_bind(idx % FAKE_NODES);
+    for(i=0; i<CHUNK_NUM; i++)
+        chunks[idx][i] = mem_get(test_mem_pool);
+
+    pthread_barrier_wait(&barrier);
+
+    //ͷһ߳(һڵ)ڴ
+    for(i=0; i<CHUNK_NUM; i++)
+        mem_put(chunks[(idx + 1) % THREAD_NUM][i]);
+    return 0;
+}
+
+static int check(int cond, const char *what)
+{
+    printf("%-50s %s\n", what, cond ? "ok" : "FAILED");
+    return cond ? 0 : 1;
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    pthread_t id[THREAD_NUM];
+    struct mem_pool *node_pool;
+    int hot_count = 0;
+    int cold_count = 0;
+    uint64_t alloc_count = 0;
+    int failed = 0;
+    int i;
+    void *ptr;
+
+    gf_mem_init_mempool_list();
+    gf_mem_pool_numa_set(1);
+    gf_mem_pool_numa_fake_topology(FAKE_NODES);
+
+    test_mem_pool = mem_pool_new (test_mem_t, 256);
+    failed += check(test_mem_pool && test_mem_pool->nr_nodes == FAKE_NODES,
+                    "fake topology creates one sub-pool per node");
+    if (failed)
+        return 1;
+
+    pthread_barrier_init(&barrier, NULL, THREAD_NUM);
+    for(i=0;i<THREAD_NUM;++i)
+        pthread_create(&id[i],NULL,test_fun,(void *)(long)i);
+    for(i=0;i<THREAD_NUM;++i)
+        pthread_join(id[i],NULL);
+
+    for(i=0;i<FAKE_NODES;++i)
+    {
+        node_pool = test_mem_pool->node_pools[i];
+        mem_pool_stats_aggregate(node_pool, &hot_count, &cold_count, &alloc_count);
+        printf("node %d: alloc %"PRIu64" hot %d remote-free %"PRIu64" slabs %d\n",
+               i, alloc_count, hot_count, node_pool->numa_remote_free,
+               node_pool->max_slabs);
+        failed += check(alloc_count == THREAD_NUM / FAKE_NODES * CHUNK_NUM,
+                        "  allocations served by the local node");
+        failed += check(node_pool->numa_miss == 0, "  no numa-miss for local threads");
+        failed += check(hot_count == 0, "  every chunk went back to its node");
+        failed += check(node_pool->numa_remote_free == THREAD_NUM / FAKE_NODES * CHUNK_NUM,
+                        "  frees from the next node counted as remote");
+    }
+
+    gf_mem_pool_numa_fake_bind(-1);
+    ptr = mem_get(test_mem_pool);
+    failed += check(test_mem_pool->node_pools[0]->numa_miss == 1,
+                    "unknown node falls back to node 0 as a miss");
+    mem_put(ptr);
+    mem_pool_destroy(test_mem_pool);
+
+    gf_mem_pool_numa_fake_topology(0);
+    test_mem_pool = mem_pool_new (test_mem_t, 256);
+    printf("real topology: %d node(s)\n", gf_mem_pool_numa_nodes());
+    failed += check(test_mem_pool &&
+                    (gf_mem_pool_numa_nodes() > 1) == (test_mem_pool->node_pools != NULL),
+                    "single node degrades to a plain pool");
+    ptr = mem_get(test_mem_pool);
+    failed += check(ptr != NULL, "real topology mem_get");
+    mem_put(ptr);
+    mem_pool_destroy(test_mem_pool);
+
+    return failed ? 1 : 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
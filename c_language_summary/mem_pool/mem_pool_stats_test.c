@@ -0,0 +1,155 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdint.h> /* uint64_t*/
+#include <unistd.h> //getopt
+#include <stdio.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <signal.h>
+#include "mem_pool.h"
+
+/*
+ * ͳƵ:  Unix socket ̣̲߳߳ͣ mem_get/mem_put
+ * ߳ÿһ socket ȡգģسѯ
+ *   ./mem_pool_stats_test -p /tmp/mem_pool.sock -s 5
+ * ʱҲһն: socat - UNIX-CONNECT:/tmp/mem_pool.sock
+ */
+
+static const char *sock_path = "/tmp/mem_pool.sock";
+static int seconds = 3;
+static int thread_num = 2;
+static volatile int stop = 0;
+
+struct _test_mem_t {
+        char a[512];
+};
+typedef struct _test_mem_t test_mem_t;
+
+struct mem_pool *test_mem_pool;
+extern gf_lock_t mempool_list_lock;
+
+void *test_fun(void *arg)
+{
+    void *ptr[16];
+    int i;
+
+    while (!stop)
+    {
+        for(i=0; i<16; i++)
+            ptr[i] = mem_get(test_mem_pool);
+        for(i=0; i<16; i++)
+            mem_put(ptr[i]);
+    }
+    return 0;
+}
+
+static int poll_stats(void)
+{
+    struct sockaddr_un addr;
+    char buf[4096];
+    ssize_t ret;
+    int fd;
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", sock_path);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)))
+    {
+        close(fd);
+        return -1;
+    }
+    while ((ret = read(fd, buf, sizeof(buf) - 1)) > 0)
+    {
+        buf[ret] = '\0';
+        printf("%s", buf);
+    }
+    close(fd);
+    return 0;
+}
+
+int32_t main(int32_t argc, char **argv)
+{
+    struct mem_pool_stats stats;
+    char path[64];
+    int i;
+    int c;
+
+    while (-1 != (c = getopt(argc, argv, "p:s:t:h")))
+    {
+        switch (c)
+        {
+        case 'p':
+            sock_path = optarg;
+            break;
+        case 's':
+            seconds = atoi(optarg);
+            break;
+        case 't':
+            thread_num = atoi(optarg);
+            break;
+        case 'h':
+        default:
+            printf("usage: %s [-p sock_path] [-s seconds] [-t thread num]\n", argv[0]);
+            exit(0);
+        }
+    }
+
+    gf_mem_init_mempool_list();
+    test_mem_pool = mem_pool_new (test_mem_t, 1024);
+    if (!test_mem_pool || gf_mem_pool_stats_exporter_start(sock_path, 1))
+    {
+        DBG_PRINT("init error");
+        return -1;
+    }
+
+    pthread_t id[thread_num];
+    for(i=0;i<thread_num;++i)
+        pthread_create(&id[i],NULL,test_fun,NULL);
+
+    for(i=0;i<seconds;++i)
+    {
+        sleep(1);
+        printf("---- poll %d ----\n", i);
+        if (poll_stats())
+            printf("connect %s failed\n", sock_path);
+    }
+
+    stop = 1;
+    for(i=0;i<thread_num;++i)
+        pthread_join(id[i],NULL);
+
+    gf_mem_pool_stats_exporter_stop();
+
+    // socketֱȡ
+    mem_pool_stats_snapshot(test_mem_pool, &stats);
+    printf("---- snapshot ----\nhot-count=%d alloc-count=%"PRIu64"\n",
+           stats.hot_count, stats.alloc_count);
+
+    // pool->lock ʱյ SIGUSR1: dump ܵסͱ alarm ɱ
+    signals_setup();
+    alarm(5);
+    LOCK(&test_mem_pool->lock);
+    raise(SIGUSR1);
+    UNLOCK(&test_mem_pool->lock);
+    ///ڴʱ( mempool_list_lock)յ SIGUSR1
+    LOCK(&mempool_list_lock);
+    raise(SIGUSR1);
+    UNLOCK(&mempool_list_lock);
+    alarm(0);
+    snprintf(path, sizeof(path), "/var/run/dump.%d", getpid());
+    unlink(path);
+
+    mem_pool_destroy(test_mem_pool);
+
+    return stats.hot_count == 0 ? 0 : 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
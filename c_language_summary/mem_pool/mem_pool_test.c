@@ -63,6 +63,25 @@ int32_t main(int32_t argc, char **argv)
     mem_pool_destroy(test_mem_pool);
     mem_pool_destroy(test_mem_pool_2);
     mem_pool_destroy(test_mem_pool_3);
+
+    //ڴͳƴʱģʽ: ջҪ 16 ֽڶ룬 cmpxchg16b δ
+    gf_mem_pool_lockfree_set (1);
+    test_mem_pool_2 = mem_pool_new (test_mem_2_t, size);
+    gf_mem_pool_lockfree_set (0);
+    if (!test_mem_pool_2 || ((uintptr_t)test_mem_pool_2->lf_free & 15))
+    {
+        DBG_PRINT("create lockfree mem pool error");
+        return -1;
+    }
+    CPU_TIME_START;
+    for(j=0; j<100; j++){
+        for(i=0; i<size; i++)
+            mem_array2[i] = (test_mem_2_t *)mem_get(test_mem_pool_2);
+        for(i=0; i<size; i++)
+            mem_put(mem_array2[i]);
+    }
+    CPU_TIME_END_PRINT("lockfree mem pool");
+    mem_pool_destroy(test_mem_pool_2);
     CPU_TIME_START;
     for(j=0; j<100; j++){
         for(i=0; i<size; i++)
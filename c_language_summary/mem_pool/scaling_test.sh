@@ -0,0 +1,16 @@
+#!/bin/bash
+# 线程数从 1 到 64，比较 mem_pool(有/无线程缓存)、malloc、tcmalloc
+# usage: ./scaling_test.sh [block_size] [block_num] [loop]
+
+block_size=${1:-256B}
+block_num=${2:-200}
+loop=${3:-10000}
+
+for t in 1 2 4 8 16 32 64
+do
+    echo "==== thread_num $t ===="
+    ./test_mem_pool -b $block_size -n $block_num -l $loop -t $t
+    ./test_mem_pool -b $block_size -n $block_num -l $loop -t $t -m 0
+    ./test_malloc -b $block_size -n $block_num -l $loop -t $t
+    [ -x ./test_tcmalloc ] && ./test_tcmalloc -b $block_size -n $block_num -l $loop -t $t
+done
@@ -9,17 +9,12 @@ extern "C"{
 #include "mem_pool.h"
 #include "../count_time/count_time.h"
 
-static int block_size = 4*1024*1024 ;
+static int block_size = 10240 ;
 static int thread_num = 1 ;
 static int block_num  = 200 ;
 static int loop =  10000 ;
-
-struct _test_mem_t {
-        char a[10240];
-};
-
-typedef struct _test_mem_t test_mem_t;
-
+static int magazine_size = GF_MEM_POOL_MAGAZINE_SIZE ;
+static int slab_count = 0 ;
 
 struct mem_pool *test_mem_pool;
 
@@ -30,38 +25,12 @@ static void usage(void)
            "-b *B,*K,*M,  block size.\n"
            "-n int,  block num \n"
            "-t int,  thread num \n"
-           "-l int,  loop num \n");
+           "-l int,  loop num \n"
+           "-m int,  per-thread magazine size, 0 disable \n"
+           "-s int,  chunks per slab, default enough for all threads \n");
 }
 
-/*
-void *test_fun(void *arg)
-{
-    int j;
-    int i;
-    int size_t = size/thread_num;
-    printf("fun 1 size %d \n",size_t);
-    test_mem_t ** mem_array   = CALLOC(size_t,sizeof(test_mem_t * )); 
-    for(j=0; j<10000; j++){    
-            if (!test_mem_pool)
-            {
-                DBG_PRINT("create mem pool error");
-                return 0;
-            }
-        for(i=0; i<size_t; i++)
-        {
-            mem_array[i] = (test_mem_t *)mem_get(test_mem_pool);
-        }
-
-        for(i=0; i<size_t; i++)
-        {
-            mem_put(mem_array[i]) ;
-        }
-
-        
-    }
-    return 0;
-}
-*/
+/*  test_malloc.c ֻͬǰ malloc/free  mem_get/mem_put */
 void *test_fun(void *arg)
 {
     int j;
@@ -69,8 +38,7 @@ void *test_fun(void *arg)
     char ** mem_array   = CALLOC(block_num, sizeof(char *));
     for(i=0; i<block_num; i++)
     {
-            mem_array[i] = (char *)MALLOC(block_size);// mallocڴֻռϷ䣬ֻռûбռõ
-            //mem_array[i] = (char *)CALLOC(block_size, sizeof(char));// ռռ䣬cpu,Ҫ__memset_sse2
+            mem_array[i] = (char *)mem_get(test_mem_pool);
     }
     
     for(j=0; j<loop; j++){
@@ -78,12 +46,17 @@ void *test_fun(void *arg)
         {
             if(mem_array[i] != NULL)
             {
-                free (mem_array[i]);
+                mem_put (mem_array[i]);
             }
-            mem_array[i] = (char *)MALLOC(block_size);
-            //mem_array[i] = (char *)CALLOC(block_size, sizeof(char));
+            mem_array[i] = (char *)mem_get(test_mem_pool);
         }
     }
+
+    for(i=0; i<block_num; i++)
+    {
+            mem_put (mem_array[i]);
+    }
+    free (mem_array);
     return 0;
 }
 
@@ -101,6 +74,8 @@ int32_t main(int32_t argc, char **argv)
                              "n:"
                              "t:"
                              "l:"
+                             "m:"
+                             "s:"
                              "h"
                             )))
     {
@@ -137,23 +112,34 @@ int32_t main(int32_t argc, char **argv)
             buf = strdup(optarg);
             loop  = atoi(buf);
             break;
+        case 'm':
+            buf = strdup(optarg);
+            magazine_size  = atoi(buf);
+            break;
+        case 's':
+            buf = strdup(optarg);
+            slab_count  = atoi(buf);
+            break;
         case 'h':
             usage();
             exit(0);
             break;
         }
     }
-    printf("block_size = %d; block_num  = %d; thread_num = %d; loop  = %d\n",block_size, block_num, thread_num, loop);
+    printf("block_size = %d; block_num  = %d; thread_num = %d; loop  = %d; magazine_size = %d\n",block_size, block_num, thread_num, loop, magazine_size);
 
-/*
     gf_mem_init_mempool_list();
+    gf_mem_pool_magazine_set(magazine_size);
 
-    CPU_TIME_START;
-    TIME_START;
-    test_mem_pool = mem_pool_new (test_mem_t, size);
-    CPU_TIME_END_PRINT("mem pool");
-    TIME_END_PRINT("mem pool");
-    */
+    //ÿ߳ block_num ټ̻߳ռסڴ
+    if (slab_count <= 0)
+        slab_count = thread_num * (block_num + magazine_size);
+    test_mem_pool = mem_pool_new_fn (block_size, slab_count, "test_mem_pool");
+    if (!test_mem_pool)
+    {
+        DBG_PRINT("create mem pool error");
+        return -1;
+    }
     CPU_TIME_START;
     TIME_START;
 
@@ -169,9 +155,7 @@ int32_t main(int32_t argc, char **argv)
 
     CPU_TIME_END_PRINT("mem pool");
     TIME_END_PRINT("mem pool");
-    /*
     mem_pool_destroy(test_mem_pool);
-    */
 
     //getchar();
     return 0;
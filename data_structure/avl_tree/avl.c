@@ -0,0 +1,678 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "avl.h"
+
+#define AVL_CHUNK_SIZE      (1 << 20)
+#define AVL_PARALLEL_MIN    65536   /*СͲ߳*/
+
+
+/************************************************************
+ * arena
+ ************************************************************/
+
+avl_arena_t* avl_arena_create(void)
+{
+    return (avl_arena_t *)calloc(1, sizeof(avl_arena_t));
+}
+
+void avl_arena_destroy(avl_arena_t *a)
+{
+    void *chunk, *next;
+
+    if (a == NULL)
+        return;
+    for (chunk = a->chunks; chunk != NULL; chunk = next)
+    {
+        next = *(void **)chunk;
+        free(chunk);
+    }
+    free(a);
+}
+
+uint64_t avl_arena_memory(const avl_arena_t *a)
+{
+    return a->chunk_bytes + sizeof(avl_arena_t);
+}
+
+static avl_node_t* node_alloc(avl_arena_t *a)
+{
+    avl_node_t *node;
+    char *chunk;
+
+    if (a->free_list != NULL)
+    {
+        node = a->free_list;
+        a->free_list = node->right;
+    }
+    else
+    {
+        if (a->left < sizeof(avl_node_t))
+        {
+            chunk = (char *)malloc(AVL_CHUNK_SIZE);
+            if (chunk == NULL)
+                return NULL;
+            *(void **)chunk = a->chunks;
+            a->chunks = chunk;
+            a->cur = chunk + sizeof(avl_node_t);
+            a->left = AVL_CHUNK_SIZE - sizeof(avl_node_t);
+            a->chunk_bytes += AVL_CHUNK_SIZE;
+        }
+        node = (avl_node_t *)a->cur;
+        a->cur += sizeof(avl_node_t);
+        a->left -= sizeof(avl_node_t);
+    }
+    a->nodes++;
+    return node;
+}
+
+static void node_free(avl_arena_t *a, avl_node_t *node)
+{
+    node->right = a->free_list;
+    a->free_list = node;
+    a->nodes--;
+}
+
+static void free_subtree(avl_arena_t *a, avl_node_t *node)
+{
+    avl_node_t *right;
+
+    /*ߵݹ飬ұѭջ*/
+    while (node != NULL)
+    {
+        free_subtree(a, node->left);
+        right = node->right;
+        node_free(a, node);
+        node = right;
+    }
+}
+
+void avl_init(avl_tree_t *t, avl_arena_t *a)
+{
+    t->root = NULL;
+    t->arena = a;
+}
+
+void avl_clear(avl_tree_t *t)
+{
+    free_subtree(t->arena, t->root);
+    t->root = NULL;
+}
+
+
+/************************************************************
+ * תƽ⣬ÿζ˳heightsize
+ ************************************************************/
+
+static inline int32_t height(const avl_node_t *node)
+{
+    return node != NULL ? node->height : 0;
+}
+
+static inline uint32_t size(const avl_node_t *node)
+{
+    return node != NULL ? node->size : 0;
+}
+
+static inline void update(avl_node_t *node)
+{
+    int32_t hl = height(node->left), hr = height(node->right);
+
+    node->height = (hl > hr ? hl : hr) + 1;
+    node->size = size(node->left) + size(node->right) + node->count;
+}
+
+static avl_node_t* rotate_right(avl_node_t *y)
+{
+    avl_node_t *x = y->left;
+
+    y->left = x->right;
+    x->right = y;
+    update(y);
+    update(x);
+    return x;
+}
+
+static avl_node_t* rotate_left(avl_node_t *x)
+{
+    avl_node_t *y = x->right;
+
+    x->right = y->left;
+    y->left = x;
+    update(x);
+    update(y);
+    return y;
+}
+
+/*߶Ȳ2ʱָƽ*/
+static avl_node_t* rebalance(avl_node_t *node)
+{
+    int32_t balance;
+
+    update(node);
+    balance = height(node->left) - height(node->right);
+    if (balance > 1)
+    {
+        if (height(node->left->left) < height(node->left->right))
+            node->left = rotate_left(node->left);
+        return rotate_right(node);
+    }
+    if (balance < -1)
+    {
+        if (height(node->right->right) < height(node->right->left))
+            node->right = rotate_right(node->right);
+        return rotate_left(node);
+    }
+    return node;
+}
+
+
+/************************************************************
+ * 롢ɾ
+ ************************************************************/
+
+static avl_node_t* insert_rec(avl_arena_t *a, avl_node_t *node, int32_t key,
+                              int32_t *err)
+{
+    if (node == NULL)
+    {
+        node = node_alloc(a);
+        if (node == NULL)
+        {
+            *err = -1;
+            return NULL;
+        }
+        node->key = key;
+        node->count = 1;
+        node->size = 1;
+        node->height = 1;
+        node->left = node->right = NULL;
+        return node;
+    }
+    if (key == node->key)
+    {
+        node->count++;
+        node->size++;
+        return node;
+    }
+    if (key < node->key)
+        node->left = insert_rec(a, node->left, key, err);
+    else
+        node->right = insert_rec(a, node->right, key, err);
+    return rebalance(node);
+}
+
+int32_t avl_insert(avl_tree_t *t, int32_t key)
+{
+    int32_t err = 0;
+    avl_node_t *root = insert_rec(t->arena, t->root, key, &err);
+
+    /*ʧʱһ·صĶԭĽڵ㣬û*/
+    if (err == 0)
+        t->root = root;
+    return err;
+}
+
+/*ժСĽڵŵ*min*/
+static avl_node_t* remove_min(avl_node_t *node, avl_node_t **min)
+{
+    if (node->left == NULL)
+    {
+        *min = node;
+        return node->right;
+    }
+    node->left = remove_min(node->left, min);
+    return rebalance(node);
+}
+
+static avl_node_t* delete_rec(avl_arena_t *a, avl_node_t *node, int32_t key,
+                              int32_t *found)
+{
+    avl_node_t *min;
+
+    if (node == NULL)
+        return NULL;
+    if (key < node->key)
+        node->left = delete_rec(a, node->left, key, found);
+    else if (key > node->key)
+        node->right = delete_rec(a, node->right, key, found);
+    else
+    {
+        *found = 1;
+        if (node->count > 1)
+        {
+            node->count--;
+            node->size--;
+            return node;
+        }
+        if (node->left == NULL || node->right == NULL)
+        {
+            min = node->left != NULL ? node->left : node->right;
+            node_free(a, node);
+            return min;
+        }
+        /*ڵ㶥*/
+        node->right = remove_min(node->right, &min);
+        min->left = node->left;
+        min->right = node->right;
+        node_free(a, node);
+        node = min;
+    }
+    if (*found == 0)
+        return node;
+    return rebalance(node);
+}
+
+int32_t avl_delete(avl_tree_t *t, int32_t key)
+{
+    int32_t found = 0;
+
+    t->root = delete_rec(t->arena, t->root, key, &found);
+    return found;
+}
+
+uint32_t avl_search(const avl_tree_t *t, int32_t key)
+{
+    const avl_node_t *node = t->root;
+
+    while (node != NULL && node->key != key)
+        node = key < node->key ? node->left : node->right;
+    return node != NULL ? node->count : 0;
+}
+
+uint64_t avl_size(const avl_tree_t *t)
+{
+    return size(t->root);
+}
+
+
+/************************************************************
+ * 齨
+ ************************************************************/
+
+typedef struct build_cursor{
+    const int32_t *keys;
+    size_t pos;
+    size_t n;
+    int32_t failed;
+} build_cursor_t;
+
+/*
+ *mڵȽһ룬ȡһٽұ
+ *ڵҲ䣬ʱ˳ڴ
+ */
+static avl_node_t* build_rec(avl_arena_t *a, build_cursor_t *c, size_t m)
+{
+    avl_node_t *left, *node;
+    size_t start;
+
+    if (m == 0)
+        return NULL;
+    left = build_rec(a, c, m / 2);
+    if (c->failed)
+        return NULL;
+    node = node_alloc(a);
+    if (node == NULL)
+    {
+        free_subtree(a, left);
+        c->failed = 1;
+        return NULL;
+    }
+    start = c->pos;
+    while (c->pos < c->n && c->keys[c->pos] == c->keys[start])
+        c->pos++;
+    node->key = c->keys[start];
+    node->count = (uint32_t)(c->pos - start);
+    node->left = left;
+    node->right = build_rec(a, c, m - m / 2 - 1);
+    if (c->failed)
+    {
+        free_subtree(a, left);
+        node_free(a, node);
+        return NULL;
+    }
+    update(node);
+    return node;
+}
+
+int32_t avl_build(avl_tree_t *t, const int32_t *keys, size_t n)
+{
+    build_cursor_t c = {keys, 0, n, 0};
+    size_t i, distinct = n > 0;
+
+    avl_clear(t);
+    for (i = 1; i < n; i++)
+    {
+        if (keys[i] < keys[i - 1])
+            return -1;
+        distinct += keys[i] != keys[i - 1];
+    }
+    t->root = build_rec(t->arena, &c, distinct);
+    return c.failed ? -1 : 0;
+}
+
+
+/************************************************************
+ * ˳ͳ
+ ************************************************************/
+
+/*Сkey(or_equalΪ1ʱkey)Ԫظ*/
+static uint64_t rank_of(const avl_node_t *node, int32_t key, int32_t or_equal)
+{
+    uint64_t rank = 0;
+
+    while (node != NULL)
+    {
+        if (key < node->key || (key == node->key && !or_equal))
+            node = node->left;
+        else
+        {
+            rank += size(node->left) + node->count;
+            node = node->right;
+        }
+    }
+    return rank;
+}
+
+uint64_t avl_rank(const avl_tree_t *t, int32_t key)
+{
+    return rank_of(t->root, key, 0);
+}
+
+int32_t avl_select(const avl_tree_t *t, uint64_t k, int32_t *key)
+{
+    const avl_node_t *node = t->root;
+    uint64_t left;
+
+    while (node != NULL)
+    {
+        left = size(node->left);
+        if (k < left)
+            node = node->left;
+        else if (k < left + node->count)
+        {
+            *key = node->key;
+            return 0;
+        }
+        else
+        {
+            k -= left + node->count;
+            node = node->right;
+        }
+    }
+    return -1;
+}
+
+uint64_t avl_count_range(const avl_tree_t *t, int32_t lo, int32_t hi)
+{
+    if (lo > hi)
+        return 0;
+    return rank_of(t->root, hi, 1) - rank_of(t->root, lo, 0);
+}
+
+
+/************************************************************
+ * split/join
+ ************************************************************/
+
+/*leftĸ߶ȱright2ϣ˳leftұҸ߶Ⱥʵĵط*/
+static avl_node_t* join_right(avl_node_t *left, avl_node_t *mid, avl_node_t *right)
+{
+    avl_node_t *c = left->right;
+
+    if (height(c) <= height(right) + 1)
+    {
+        mid->left = c;
+        mid->right = right;
+        update(mid);
+        left->right = height(mid) <= height(left->left) + 1 ? mid : rotate_right(mid);
+    }
+    else
+        left->right = join_right(c, mid, right);
+    update(left);
+    if (height(left->right) <= height(left->left) + 1)
+        return left;
+    return rotate_left(left);
+}
+
+static avl_node_t* join_left(avl_node_t *left, avl_node_t *mid, avl_node_t *right)
+{
+    avl_node_t *c = right->left;
+
+    if (height(c) <= height(left) + 1)
+    {
+        mid->left = left;
+        mid->right = c;
+        update(mid);
+        right->left = height(mid) <= height(right->right) + 1 ? mid : rotate_left(mid);
+    }
+    else
+        right->left = join_left(left, mid, c);
+    update(right);
+    if (height(right->left) <= height(right->right) + 1)
+        return right;
+    return rotate_right(right);
+}
+
+/*leftļСmidrightļmidO(|߶Ȳ|)*/
+static avl_node_t* join3(avl_node_t *left, avl_node_t *mid, avl_node_t *right)
+{
+    if (height(left) > height(right) + 1)
+        return join_right(left, mid, right);
+    if (height(right) > height(left) + 1)
+        return join_left(left, mid, right);
+    mid->left = left;
+    mid->right = right;
+    update(mid);
+    return mid;
+}
+
+/*Сkeyĵ*leftڵĵ*rightkeyĽڵժ*mid(ûΪNULL)*/
+static void split_rec(avl_node_t *node, int32_t key, avl_node_t **left,
+                      avl_node_t **mid, avl_node_t **right)
+{
+    avl_node_t *l, *r;
+
+    if (node == NULL)
+    {
+        *left = *mid = *right = NULL;
+        return;
+    }
+    l = node->left;
+    r = node->right;
+    if (key == node->key)
+    {
+        *left = l;
+        *mid = node;
+        *right = r;
+    }
+    else if (key < node->key)
+    {
+        split_rec(l, key, left, mid, &l);
+        *right = join3(l, node, r);
+    }
+    else
+    {
+        split_rec(r, key, &r, mid, right);
+        *left = join3(l, node, r);
+    }
+}
+
+void avl_split(avl_tree_t *t, int32_t key, avl_tree_t *left, avl_tree_t *right)
+{
+    avl_node_t *l, *mid, *r;
+
+    split_rec(t->root, key, &l, &mid, &r);
+    if (mid != NULL)
+        r = join3(NULL, mid, r);
+    left->root = l;
+    left->arena = t->arena;
+    right->root = r;
+    right->arena = t->arena;
+    t->root = NULL;
+}
+
+int32_t avl_join(avl_tree_t *left, avl_tree_t *right)
+{
+    avl_node_t *max, *min;
+
+    if (left->root == NULL || right->root == NULL)
+    {
+        if (left->root == NULL)
+            left->root = right->root;
+        right->root = NULL;
+        return 0;
+    }
+    for (max = left->root; max->right != NULL; max = max->right)
+        ;
+    for (min = right->root; min->left != NULL; min = min->left)
+        ;
+    if (max->key >= min->key)
+        return -1;
+    /*rightСժмڵ*/
+    right->root = remove_min(right->root, &min);
+    left->root = join3(left->root, min, right->root);
+    right->root = NULL;
+    return 0;
+}
+
+
+/************************************************************
+ * ϲ
+ ************************************************************/
+
+typedef struct union_job{
+    avl_node_t *a;
+    avl_node_t *b;
+    int32_t depth;          /*·ּ߳*/
+    avl_node_t *freed;      /*ظϲĽڵ㣬right*/
+    avl_node_t *result;
+} union_job_t;
+
+static void* union_main(void *arg);
+
+/*aĸb߷ֱϲaĸ*/
+static avl_node_t* union_rec(avl_node_t *a, avl_node_t *b, int32_t depth,
+                             avl_node_t **freed)
+{
+    avl_node_t *bl, *bmid, *br, *al, *ar;
+    union_job_t job;
+    pthread_t tid;
+
+    if (a == NULL)
+        return b;
+    if (b == NULL)
+        return a;
+    split_rec(b, a->key, &bl, &bmid, &br);
+    if (bmid != NULL)
+    {
+        a->count += bmid->count;
+        bmid->right = *freed;
+        *freed = bmid;
+    }
+    al = a->left;
+    ar = a->right;
+    if (depth > 0 && (uint64_t)size(al) + size(bl) >= AVL_PARALLEL_MIN
+        && (uint64_t)size(ar) + size(br) >= AVL_PARALLEL_MIN)
+    {
+        job.a = al;
+        job.b = bl;
+        job.depth = depth - 1;
+        job.freed = NULL;
+        if (pthread_create(&tid, NULL, union_main, &job) == 0)
+        {
+            ar = union_rec(ar, br, depth - 1, freed);
+            pthread_join(tid, NULL);
+            al = job.result;
+            /*Ǹ̵߳Ŀнڵӹ*/
+            while (job.freed != NULL)
+            {
+                bmid = job.freed;
+                job.freed = bmid->right;
+                bmid->right = *freed;
+                *freed = bmid;
+            }
+            return join3(al, a, ar);
+        }
+    }
+    al = union_rec(al, bl, depth, freed);
+    ar = union_rec(ar, br, depth, freed);
+    return join3(al, a, ar);
+}
+
+static void* union_main(void *arg)
+{
+    union_job_t *job = (union_job_t *)arg;
+
+    job->result = union_rec(job->a, job->b, job->depth, &job->freed);
+    return NULL;
+}
+
+int32_t avl_union(avl_tree_t *a, avl_tree_t *b, int32_t threads)
+{
+    avl_node_t *freed = NULL, *node;
+    int32_t depth = 0;
+
+    if (a->arena != b->arena)
+        return -1;
+    while (threads > 1)
+    {
+        depth++;
+        threads = (threads + 1) / 2;
+    }
+    /*ôǿõĸȥСǿãСÿβĿС*/
+    if (size(a->root) >= size(b->root))
+        a->root = union_rec(a->root, b->root, depth, &freed);
+    else
+        a->root = union_rec(b->root, a->root, depth, &freed);
+    b->root = NULL;
+    while (freed != NULL)
+    {
+        node = freed;
+        freed = node->right;
+        node_free(a->arena, node);
+    }
+    return 0;
+}
+
+
+/************************************************************
+ * 
+ ************************************************************/
+
+/*ļ(lo, hi)ؽڵ-1*/
+static int64_t check_rec(const avl_node_t *node, int64_t lo, int64_t hi)
+{
+    int64_t nl, nr;
+    int32_t hl, hr;
+
+    if (node == NULL)
+        return 0;
+    if (node->key <= lo || node->key >= hi || node->count == 0)
+        return -1;
+    nl = check_rec(node->left, lo, node->key);
+    nr = check_rec(node->right, node->key, hi);
+    if (nl < 0 || nr < 0)
+        return -1;
+    hl = height(node->left);
+    hr = height(node->right);
+    if (node->height != (hl > hr ? hl : hr) + 1 || hl - hr > 1 || hr - hl > 1)
+        return -1;
+    if (node->size != size(node->left) + size(node->right) + node->count)
+        return -1;
+    return nl + nr + 1;
+}
+
+int32_t avl_check(const avl_tree_t *t)
+{
+    return check_rec(t->root, (int64_t)INT32_MIN - 1, (int64_t)INT32_MAX + 1) < 0 ? -1 : 0;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
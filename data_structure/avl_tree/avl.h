@@ -0,0 +1,131 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ *AVLint32_tظļ avl_tree_duplicate_keys.c һcount
+ * avl_tree.c ȶЩ
+ *    ڵarena䣬1Mһ飬ÿmallocһ
+ *    ڵԪظ(ظ)rank/select/O(logn)
+ *    avl_build O(n)
+ *    split/joinϲʱ𿪣߿Զ̸߳Ժϲ
+ *Ҫsplit/join/unionļͬһarena
+ *size32λģһ2^32-1Ԫ
+ */
+
+#ifndef _AVL_H_
+#define _AVL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct avl_node{
+    int32_t key;
+    uint32_t count;         /*м*/
+    uint32_t size;          /*һظ*/
+    int32_t height;
+    struct avl_node *left;
+    struct avl_node *right;
+} avl_node_t;
+
+typedef struct avl_arena{
+    void *chunks;           /*õһڵλô*/
+    char *cur;
+    size_t left;
+    avl_node_t *free_list;  /*right*/
+    uint64_t chunk_bytes;
+    uint64_t nodes;
+} avl_arena_t;
+
+typedef struct avl_tree{
+    avl_node_t *root;
+    avl_arena_t *arena;
+} avl_tree_t;
+
+/*
+ *ܣһarena
+ *ֵNULLʾڴ治
+ */
+avl_arena_t* avl_arena_create(void);
+
+/*ͷarenaȫ*/
+void avl_arena_destroy(avl_arena_t *a);
+
+/*ϵͳҪֽ*/
+uint64_t avl_arena_memory(const avl_arena_t *a);
+
+/*
+ *ܣʼһÿڵa
+ */
+void avl_init(avl_tree_t *t, avl_arena_t *a);
+
+/*ѽڵ㶼arena*/
+void avl_clear(avl_tree_t *t);
+
+/*
+ *ܣkeyѾоcount1
+ *ֵ0ɹ-1ڴ治()
+ */
+int32_t avl_insert(avl_tree_t *t, int32_t key);
+
+/*
+ *ܣɾһkeycount1ʱֻ1
+ *ֵ1ɾˣ0û
+ */
+int32_t avl_delete(avl_tree_t *t, int32_t key);
+
+/*keyм0ʾû*/
+uint32_t avl_search(const avl_tree_t *t, int32_t key);
+
+/*һԪأظ*/
+uint64_t avl_size(const avl_tree_t *t);
+
+/*
+ *ܣӴСźõkeysԭO(n)
+ *keys ظn 
+ *ֵ0ɹ-1ڴ治keysûź(Ϊ)
+ */
+int32_t avl_build(avl_tree_t *t, const int32_t *keys, size_t n);
+
+/*СkeyԪظ*/
+uint64_t avl_rank(const avl_tree_t *t, int32_t key);
+
+/*
+ *ܣȡkСԪ(0ʼظ)
+ *ֵ0ɹ-1 kΧ
+ */
+int32_t avl_select(const avl_tree_t *t, uint64_t k, int32_t *key);
+
+/*[lo, hi]Ԫظ*/
+uint64_t avl_count_range(const avl_tree_t *t, int32_t lo, int32_t hi);
+
+/*
+ *ܣkeyãСkeyĵleftСڵĵrightt
+ *      leftrighttarenaԭݲҪ
+ */
+void avl_split(avl_tree_t *t, int32_t key, avl_tree_t *left, avl_tree_t *right);
+
+/*
+ *ܣleftļrightСʱrightӵleftϣright
+ *ֵ0ɹ-1н()
+ */
+int32_t avl_join(avl_tree_t *left, avl_tree_t *right);
+
+/*
+ *ܣbϲaͬļcountӣbգO(m log(n/m + 1))
+ *threads ߳漸𿪺߽̣ͬ߳<=1߳
+ *ֵ0ɹ-1arenaͬ
+ */
+int32_t avl_union(avl_tree_t *a, avl_tree_t *b, int32_t threads);
+
+/*
+ *ܣ򡢸߶ȡƽ⡢size
+ *ֵ0-1д
+ */
+int32_t avl_check(const avl_tree_t *t);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include "avl.h"
+#include "../test_util.h"
+
+/*
+ *avl_buildһavl_insertĶԱȣrank/select/split/joinϲٶ
+ *÷avl_bench [-n ] [-t ߳]
+ *Ĭ10M50MĿ -n 5e7Ҫ1.6Gڴ
+ */
+
+int main(int argc, char *argv[])
+{
+    size_t n = 10000000, i, ops = 1000000;
+    struct timeval tv_begin, tv_end;
+    avl_tree_t t, even, odd, left, right;
+    avl_arena_t *a;
+    int32_t *keys, threads = 4, key, runs[2], r;
+    uint64_t sum = 0;
+    double sec;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:t:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            n = (size_t)atof(optarg);
+            break;
+        case 't':
+            threads = atoi(optarg);
+            break;
+        default:
+            printf("usage: %s [-n keys] [-t threads]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    keys = (int32_t *)malloc(n * sizeof(int32_t));
+    a = avl_arena_create();
+    if (keys == NULL || a == NULL)
+    {
+        printf("out of memory\n");
+        return -1;
+    }
+    for (i = 0; i < n; i++)
+        keys[i] = (int32_t)i;
+    avl_init(&t, a);
+
+    printf("%zu sorted keys\n", n);
+    gettimeofday(&tv_begin, NULL);
+    for (i = 0; i < n; i++)
+        avl_insert(&t, keys[i]);
+    gettimeofday(&tv_end, NULL);
+    sec = diff_time(tv_begin, tv_end);
+    printf("avl_insert one by one  %8.3f s  %6.1f ns/key\n", sec, sec * 1e9 / n);
+
+    gettimeofday(&tv_begin, NULL);
+    avl_build(&t, keys, n);
+    gettimeofday(&tv_end, NULL);
+    sec = diff_time(tv_begin, tv_end);
+    printf("avl_build              %8.3f s  %6.1f ns/key\n", sec, sec * 1e9 / n);
+    printf("arena %.1f bytes/key, height %d\n\n",
+           (double)avl_arena_memory(a) / n, t.root != NULL ? t.root->height : 0);
+
+    gettimeofday(&tv_begin, NULL);
+    for (i = 0; i < ops; i++)
+        sum += avl_rank(&t, (int32_t)(xorshift64() % n));
+    gettimeofday(&tv_end, NULL);
+    printf("rank         %6.1f ns\n", diff_time(tv_begin, tv_end) * 1e9 / ops);
+
+    gettimeofday(&tv_begin, NULL);
+    for (i = 0; i < ops; i++)
+    {
+        avl_select(&t, xorshift64() % n, &key);
+        sum += key;
+    }
+    gettimeofday(&tv_end, NULL);
+    printf("select       %6.1f ns\n", diff_time(tv_begin, tv_end) * 1e9 / ops);
+
+    gettimeofday(&tv_begin, NULL);
+    for (i = 0; i < ops; i++)
+    {
+        key = (int32_t)(xorshift64() % n);
+        sum += avl_count_range(&t, key, key + 1000);
+    }
+    gettimeofday(&tv_end, NULL);
+    printf("count_range  %6.1f ns\n", diff_time(tv_begin, tv_end) * 1e9 / ops);
+
+    gettimeofday(&tv_begin, NULL);
+    for (i = 0; i < ops / 10; i++)
+    {
+        avl_split(&t, (int32_t)(xorshift64() % n), &left, &right);
+        avl_join(&left, &right);
+        t = left;
+    }
+    gettimeofday(&tv_end, NULL);
+    printf("split+join   %6.1f ns\n\n", diff_time(tv_begin, tv_end) * 1e9 / (ops / 10));
+    avl_clear(&t);
+
+    /*żһãϲҪÿڵ㶼ȵ߳ٶ߳*/
+    runs[0] = 1;
+    runs[1] = threads;
+    avl_init(&even, a);
+    avl_init(&odd, a);
+    for (r = 0; r < (threads > 1 ? 2 : 1); r++)
+    {
+        for (i = 0; i < n / 2; i++)
+            keys[i] = (int32_t)(i * 2);
+        avl_build(&even, keys, n / 2);
+        for (i = 0; i < n / 2; i++)
+            keys[i] = (int32_t)(i * 2 + 1);
+        avl_build(&odd, keys, n / 2);
+        gettimeofday(&tv_begin, NULL);
+        avl_union(&even, &odd, runs[r]);
+        gettimeofday(&tv_end, NULL);
+        sec = diff_time(tv_begin, tv_end);
+        printf("union of two %zu-key trees, %d thread(s): %.3f s%s\n", n / 2, runs[r], sec,
+               avl_size(&even) == n / 2 * 2 ? "" : " WRONG SIZE");
+        avl_clear(&even);
+    }
+
+    printf("(checksum %llu)\n", (unsigned long long)sum);
+    avl_arena_destroy(a);
+    free(keys);
+    return 0;
+}
@@ -0,0 +1,293 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "avl.h"
+#include "../test_util.h"
+
+/*
+ *һǸգɾrank/selectsplit/joinϲ
+ */
+
+#define RANGE   2000    /*ȡ[-RANGE/2, RANGE/2)*/
+
+static int32_t random_key(void)
+{
+    return (int32_t)(xorshift64() % RANGE) - RANGE / 2;
+}
+
+/*ref[key + RANGE/2]ǵĸһ*/
+static void compare(const char *what, const avl_tree_t *t, const uint32_t *ref)
+{
+    uint64_t total = 0, below, k;
+    int32_t key, lo, hi, got;
+    uint32_t i;
+
+    CHECK(avl_check(t) == 0, "%s: check failed", what);
+    for (i = 0; i < RANGE; i++)
+    {
+        key = (int32_t)i - RANGE / 2;
+        CHECK(avl_search(t, key) == ref[i], "%s: search %d got %u want %u", what, key,
+              avl_search(t, key), ref[i]);
+        CHECK(avl_rank(t, key) == total, "%s: rank %d", what, key);
+        if (ref[i] > 0)
+        {
+            CHECK(avl_select(t, total, &got) == 0 && got == key, "%s: select %llu",
+                  what, (unsigned long long)total);
+            CHECK(avl_select(t, total + ref[i] - 1, &got) == 0 && got == key,
+                  "%s: select %llu", what, (unsigned long long)(total + ref[i] - 1));
+        }
+        total += ref[i];
+    }
+    CHECK(avl_size(t) == total, "%s: size %llu want %llu", what,
+          (unsigned long long)avl_size(t), (unsigned long long)total);
+    CHECK(avl_select(t, total, &got) == -1, "%s: select past the end", what);
+
+    for (k = 0; k < 50; k++)
+    {
+        lo = random_key();
+        hi = random_key();
+        for (i = lo + RANGE / 2, below = 0; (int32_t)i <= hi + RANGE / 2; i++)
+            below += ref[i];
+        CHECK(avl_count_range(t, lo, hi) == below, "%s: count_range %d %d", what, lo, hi);
+    }
+    CHECK(avl_count_range(t, INT32_MIN, INT32_MAX) == total, "%s: count_range all", what);
+}
+
+static void test_random(avl_arena_t *a)
+{
+    static uint32_t ref[RANGE];
+    avl_tree_t t;
+    uint32_t i;
+    int32_t key, ret;
+
+    avl_init(&t, a);
+    memset(ref, 0, sizeof(ref));
+    for (i = 0; i < 200000; i++)
+    {
+        key = random_key();
+        if (xorshift64() % 100 < (i < 100000 ? 60 : 35))
+        {
+            if (avl_insert(&t, key) != 0)
+            {
+                printf("insert %d failed\n", key);
+                failed++;
+                break;
+            }
+            ref[key + RANGE / 2]++;
+        }
+        else
+        {
+            ret = avl_delete(&t, key);
+            if (ret != (ref[key + RANGE / 2] > 0))
+            {
+                printf("delete %d returned %d\n", key, ret);
+                failed++;
+                break;
+            }
+            if (ret)
+                ref[key + RANGE / 2]--;
+        }
+        if (i % 2000 == 0)
+            compare("random", &t, ref);
+    }
+    compare("random", &t, ref);
+    avl_clear(&t);
+    if (a->nodes != 0)
+    {
+        printf("random: %llu nodes left after clear\n", (unsigned long long)a->nodes);
+        failed++;
+    }
+}
+
+static int cmp_int32(const void *x, const void *y)
+{
+    int32_t a = *(const int32_t *)x, b = *(const int32_t *)y;
+    return a < b ? -1 : a > b;
+}
+
+/*nźref¸*/
+static void build_random(avl_tree_t *t, uint32_t *ref, size_t n)
+{
+    int32_t *keys = (int32_t *)malloc((n + 1) * sizeof(int32_t));
+    size_t i;
+
+    memset(ref, 0, RANGE * sizeof(uint32_t));
+    for (i = 0; i < n; i++)
+    {
+        keys[i] = random_key();
+        ref[keys[i] + RANGE / 2]++;
+    }
+    qsort(keys, n, sizeof(int32_t), cmp_int32);
+    if (avl_build(t, keys, n) != 0)
+    {
+        printf("build %zu failed\n", n);
+        failed++;
+    }
+    free(keys);
+}
+
+static void test_build(avl_arena_t *a)
+{
+    static uint32_t ref[RANGE];
+    int32_t unsorted[3] = {1, 3, 2};
+    avl_tree_t t;
+    size_t n;
+
+    avl_init(&t, a);
+    for (n = 0; n < 300; n++)
+    {
+        build_random(&t, ref, n);
+        compare("build", &t, ref);
+    }
+    build_random(&t, ref, 100000);
+    compare("build", &t, ref);
+    if (avl_build(&t, unsorted, 3) != -1 || t.root != NULL)
+    {
+        printf("build accepted unsorted keys\n");
+        failed++;
+    }
+    avl_clear(&t);
+}
+
+static void test_split_join(avl_arena_t *a)
+{
+    static uint32_t ref[RANGE], ref_left[RANGE], ref_right[RANGE];
+    avl_tree_t t, left, right;
+    int32_t key, round;
+    uint32_t i;
+
+    avl_init(&t, a);
+    for (round = 0; round < 300; round++)
+    {
+        build_random(&t, ref, xorshift64() % 3000);
+        /*ɾһЩȫƽ*/
+        for (i = 0; i < 500; i++)
+        {
+            key = random_key();
+            if (i & 1)
+            {
+                avl_insert(&t, key);
+                ref[key + RANGE / 2]++;
+            }
+            else if (avl_delete(&t, key))
+                ref[key + RANGE / 2]--;
+        }
+        key = (int32_t)(xorshift64() % (RANGE + 20)) - RANGE / 2 - 10;
+        avl_split(&t, key, &left, &right);
+        for (i = 0; i < RANGE; i++)
+        {
+            ref_left[i] = (int32_t)i - RANGE / 2 < key ? ref[i] : 0;
+            ref_right[i] = (int32_t)i - RANGE / 2 < key ? 0 : ref[i];
+        }
+        compare("split left", &left, ref_left);
+        compare("split right", &right, ref_right);
+        if (t.root != NULL)
+        {
+            printf("split left the source tree non-empty\n");
+            failed++;
+        }
+        if (left.root != NULL && right.root != NULL && avl_join(&right, &left) != -1)
+        {
+            printf("join accepted overlapping trees\n");
+            failed++;
+        }
+        if (avl_join(&left, &right) != 0)
+        {
+            printf("join failed\n");
+            failed++;
+        }
+        compare("join", &left, ref);
+        t = left;
+    }
+    avl_clear(&t);
+}
+
+static void test_union(avl_arena_t *a, int32_t threads, size_t n)
+{
+    static uint32_t ref[RANGE], ref_b[RANGE];
+    avl_tree_t t, b;
+    uint32_t i;
+
+    avl_init(&t, a);
+    avl_init(&b, a);
+    build_random(&t, ref, n);
+    build_random(&b, ref_b, xorshift64() % (2 * n + 1));
+    for (i = 0; i < RANGE; i++)
+        ref[i] += ref_b[i];
+    avl_union(&t, &b, threads);
+    compare("union", &t, ref);
+    if (b.root != NULL)
+    {
+        printf("union left b non-empty\n");
+        failed++;
+    }
+    avl_clear(&t);
+}
+
+/*ͬĴ̵߳·*/
+static void test_union_big(avl_arena_t *a, int32_t threads)
+{
+    size_t n = 400000, i;
+    int32_t *keys = (int32_t *)malloc(n * sizeof(int32_t));
+    avl_tree_t t, b;
+    int32_t got;
+
+    avl_init(&t, a);
+    avl_init(&b, a);
+    for (i = 0; i < n; i++)
+        keys[i] = (int32_t)(i * 2);
+    avl_build(&t, keys, n);
+    for (i = 0; i < n; i++)
+        keys[i] = (int32_t)(i * 3);
+    avl_build(&b, keys, n);
+    avl_union(&t, &b, threads);
+    if (avl_check(&t) != 0 || avl_size(&t) != 2 * n)
+    {
+        printf("union big (%d threads): check failed\n", threads);
+        failed++;
+    }
+    /*6ıﶼУt2n-2b3n-3*/
+    for (i = 0; i * 6 < 3 * n; i += 101)
+    {
+        if (avl_search(&t, (int32_t)(i * 6)) != (i * 6 < 2 * n ? 2 : 1))
+        {
+            printf("union big (%d threads): count of %zu\n", threads, i * 6);
+            failed++;
+            break;
+        }
+    }
+    if (avl_select(&t, 0, &got) != 0 || got != 0 || avl_rank(&t, 30) != 15 + 10)
+    {
+        printf("union big (%d threads): rank/select\n", threads);
+        failed++;
+    }
+    avl_clear(&t);
+    free(keys);
+}
+
+int main(void)
+{
+    avl_arena_t *a = avl_arena_create();
+    int32_t i;
+
+    test_random(a);
+    test_build(a);
+    test_split_join(a);
+    for (i = 0; i < 200; i++)
+        test_union(a, i % 4 + 1, xorshift64() % 4000);
+    test_union_big(a, 1);
+    test_union_big(a, 4);
+    if (a->nodes != 0)
+    {
+        printf("%llu nodes leaked\n", (unsigned long long)a->nodes);
+        failed++;
+    }
+    avl_arena_destroy(a);
+
+    if (failed)
+        printf("%d failed\n", failed);
+    else
+        printf("all passed\n");
+    return failed != 0;
+}
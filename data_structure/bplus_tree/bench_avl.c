@@ -0,0 +1,78 @@
+/*
+ * ../avl_tree/avl_tree.c ԭ bptree_bench 
+ *ĺinsertdeleteNodemainȸĸ
+ */
+#define max             avl_max
+#define height          avl_height
+#define newNode         avl_newNode
+#define rightRotate     avl_rightRotate
+#define leftRotate      avl_leftRotate
+#define getBalance      avl_getBalance
+#define insert          avl_insert
+#define minValueNode    avl_minValueNode
+#define deleteNode      avl_deleteNode
+#define preOrder        avl_preOrder
+#define inOrder         avl_inOrder
+#define _destoryTree    avl__destoryTree
+#define destoryTree     avl_destoryTree
+#define main            avl_main
+
+#include "../avl_tree/avl_tree.c"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+void* bench_avl_insert(void *root, int key)
+{
+    return insert((struct node *)root, key);
+}
+
+void* bench_avl_delete(void *root, int key)
+{
+    return deleteNode((struct node *)root, key);
+}
+
+int bench_avl_search(void *root, int key)
+{
+    struct node *p = (struct node *)root;
+
+    while (p != NULL && p->key != key)
+        p = key < p->key ? p->left : p->right;
+    return p != NULL;
+}
+
+/*[lo, hi]ļĺ*/
+int64_t bench_avl_range(void *root, int lo, int hi)
+{
+    struct node *p = (struct node *)root;
+    int64_t sum = 0;
+
+    if (p == NULL)
+        return 0;
+    if (lo < p->key)
+        sum += bench_avl_range(p->left, lo, hi);
+    if (lo <= p->key && p->key <= hi)
+        sum += p->key;
+    if (p->key < hi)
+        sum += bench_avl_range(p->right, lo, hi);
+    return sum;
+}
+
+/*avl_tree.cdestoryTreeÿڵӡһУﲻӡ*/
+void bench_avl_destroy(void *root)
+{
+    struct node *p = (struct node *)root;
+
+    if (p == NULL)
+        return;
+    bench_avl_destroy(p->left);
+    bench_avl_destroy(p->right);
+    free(p);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,174 @@
+/*
+ * bptree_bench õĶ
+ *../binary_search_tree/bst.c 벻(isBST_2node->dataûж
+ *maxValuefindPreSucC++)ճ
+ *newNodeinsertsearchminValueNodedeleteNodeһû
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+struct node
+{
+    int key;
+    struct node *left, *right;
+};
+ 
+// A utility function to create a new BST node
+struct node *newNode(int item)
+{
+    struct node *temp =  (struct node *)malloc(sizeof(struct node));
+    temp->key = item;
+    temp->left = temp->right = NULL;
+    return temp;
+}
+ 
+/* A utility function to insert a new node with given key in BST */
+struct node* insert(struct node* root, int key)
+{
+    /* If the tree is empty, return a new node */
+    if (root == NULL) return newNode(key);
+
+    /* Otherwise, recur down the tree */
+    if (key < root->key)
+        root->left  = insert(root->left, key);
+    else if (key > root->key)
+        root->right = insert(root->right, key);   
+
+    /* return the (unchanged) node pointer */
+    return root;
+}
+
+// C function to search a given key in a given BST
+struct node* search(struct node* root, int key)
+{
+    // Base Cases: root is null or key is present at root
+    if (root == NULL || root->key == key)
+       return root;
+   
+    // Key is greater than root's key
+    if (root->key < key)
+       return search(root->right, key);
+
+    // Key is smaller than root's key
+    return search(root->left, key);
+}
+
+/* Given a non-empty binary search tree, return the node with minimum
+   key value found in that tree. Note that the entire tree does not
+   need to be searched. 
+   ҶСֵ*/
+  
+struct node * minValueNode(struct node* node)
+{
+    struct node* current = node;
+ 
+    /* loop down to find the leftmost leaf */
+    while (current->left != NULL)
+        current = current->left;
+ 
+    return current;
+}
+ 
+/* Given a binary search tree and a key, this function deletes the key
+   and returns the new root */
+struct node* deleteNode(struct node* root, int key)
+{
+    // base case
+    if (root == NULL) return root;
+ 
+    // If the key to be deleted is smaller than the root's key,
+    // then it lies in left subtree
+    if (key < root->key)
+        root->left = deleteNode(root->left, key);
+ 
+    // If the key to be deleted is greater than the root's key,
+    // then it lies in right subtree
+    else if (key > root->key)
+        root->right = deleteNode(root->right, key);
+ 
+    // if key is same as root's key, then This is the node
+    // to be deleted
+    else
+    {
+        // node with only one child or no child
+        if (root->left == NULL)
+        {
+            struct node *temp = root->right;
+            free(root);
+            //ݹ㷨
+            return temp;
+        }
+        else if (root->right == NULL)
+        {
+            struct node *temp = root->left;
+            free(root);
+            return temp;
+        }
+ 
+        // node with two children: Get the inorder successor (smallest
+        // in the right subtree)
+        // СֵΪroot
+        struct node* temp = minValueNode(root->right);
+ 
+        // Copy the inorder successor's content to this node
+        root->key = temp->key;
+ 
+        // Delete the inorder successor
+        root->right = deleteNode(root->right, temp->key);
+    }
+    return root;
+}
+
+
+void* bench_bst_insert(void *root, int key)
+{
+    return insert((struct node *)root, key);
+}
+
+void* bench_bst_delete(void *root, int key)
+{
+    return deleteNode((struct node *)root, key);
+}
+
+int bench_bst_search(void *root, int key)
+{
+    return search((struct node *)root, key) != NULL;
+}
+
+/*[lo, hi]ļĺ*/
+int64_t bench_bst_range(void *root, int lo, int hi)
+{
+    struct node *p = (struct node *)root;
+    int64_t sum = 0;
+
+    if (p == NULL)
+        return 0;
+    if (lo < p->key)
+        sum += bench_bst_range(p->left, lo, hi);
+    if (lo <= p->key && p->key <= hi)
+        sum += p->key;
+    if (p->key < hi)
+        sum += bench_bst_range(p->right, lo, hi);
+    return sum;
+}
+
+/*bst.cdestoryTreeÿڵӡһУﲻӡ*/
+void bench_bst_destroy(void *root)
+{
+    struct node *p = (struct node *)root;
+
+    if (p == NULL)
+        return;
+    bench_bst_destroy(p->left);
+    bench_bst_destroy(p->right);
+    free(p);
+}
+
+#ifdef __cplusplus
+}
+#endif
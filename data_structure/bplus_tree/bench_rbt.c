@@ -0,0 +1,72 @@
+/*
+ * ../red_black_tree/rbt.c ԭ bptree_bench 
+ *ĺinsertmainȸĸ
+ *rbt.cֻв룬ûɾͲңҰdataȽߣպnil
+ */
+#define Nil             rbt_Nil
+#define nil             rbt_nil
+#define LeftRotate      rbt_LeftRotate
+#define rightRotate     rbt_rightRotate
+#define insertFixUp     rbt_insertFixUp
+#define insert          rbt_insert
+#define inorder         rbt_inorder
+#define main            rbt_main
+
+#include "../red_black_tree/rbt.c"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+void* bench_rbt_insert(void *root, int key)
+{
+    struct node *p = (struct node *)root;
+
+    insert(&p, key);
+    return p;
+}
+
+int bench_rbt_search(void *root, int key)
+{
+    struct node *p = (struct node *)root;
+
+    if (p == NULL)
+        return 0;
+    while (p != nil && p->data != key)
+        p = key < p->data ? p->left : p->right;
+    return p != nil;
+}
+
+/*[lo, hi]ļĺ*/
+int64_t bench_rbt_range(void *root, int lo, int hi)
+{
+    struct node *p = (struct node *)root;
+    int64_t sum = 0;
+
+    if (p == NULL || p == nil)
+        return 0;
+    if (lo < p->data)
+        sum += bench_rbt_range(p->left, lo, hi);
+    if (lo <= p->data && p->data <= hi)
+        sum += p->data;
+    if (p->data < hi)
+        sum += bench_rbt_range(p->right, lo, hi);
+    return sum;
+}
+
+void bench_rbt_destroy(void *root)
+{
+    struct node *p = (struct node *)root;
+
+    if (p == NULL || p == nil)
+        return;
+    bench_rbt_destroy(p->left);
+    bench_rbt_destroy(p->right);
+    free(p);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,455 @@
+/*
+ * bptree_bench õĺ ../rbTree/rbTree.c
+ *(rbTree.hrbTree_test.cMakefilebitmapµģrbTree.cǺ)
+ *rbTree.cC++Tree &TC벻bench_bst.cһճĶֻУ
+ *1.Tree &TĳTree *TT=yĳ*T=yô&T
+ *2.Successorxʱصڵĸq(Һûʱnil)ĳɷp
+ *3.DeleteFixupcase 2֮case 3/4ĳcase 2case 3/4ѡһ㷨һ
+ *4.SearchݹûreturnҲʱҲûзֵϣҲnil
+ *5.DeleteûfreeɾĽڵ㣬
+ *staticúͱ
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+typedef enum Color //ɫɫ
+{
+    RED = 0,
+    BLACK = 1
+}Color;
+
+typedef struct Node //
+{
+    struct Node *parent;
+    struct Node *left;
+    struct Node *right;
+    int value;
+    Color color;
+}Node, *Tree;
+static Node *nil=NULL; //Ϊ˱۽ı߽һnilеNULL
+
+static Node* Parent(Node *z) //ĳĸĸ
+{
+    return z->parent;
+}
+static Node* Left(Node *z) //
+{
+    return z->left;
+}
+static Node *Right(Node *z) //
+{
+    return z->right;
+}
+static void LeftRotate(Tree *T, Node *x) //תxԭyתΪxĸĸ
+{
+    if( x-> right != nil )
+    {
+        Node *y=Right(x);
+        x->right=y->left;
+        if(y->left != nil)
+        {
+            y->left->parent=x;
+        }
+        y->parent=x->parent;
+        if( x->parent == nil )
+        {
+            *T=y;
+        }
+        else
+        {
+            if( x == Left(Parent(x)) )
+            {
+                x->parent->left=y;
+            }
+            else
+            {
+                x->parent->right=y;
+            }
+        }
+        y->left=x;
+        x->parent=y;
+    }
+    else
+    {
+        printf("%s/n","can't execute left rotate due to null right child");
+    }
+}
+
+static void RightRotate(Tree *T, Node *x) //תxԭyתΪxĸĸ
+{
+    if( x->left != nil )
+    {
+        Node *y=Left(x);
+        x->left=y->right;
+        if( y->right != nil )
+        {
+            y->right->parent=x;
+        }
+        y->parent=x->parent;
+        if( x->parent == nil )
+        {
+            *T=y;
+        }
+        else
+        {
+            if(x == Left(Parent(x)) )
+            {
+                x->parent->left=y;
+            }
+            else
+            {
+                x->parent->right=y;
+            }
+        }
+        y->right=x;
+        x->parent=y;
+    }
+    else
+    {
+        printf("%s/n","can't execute right rotate due to null left child");
+    }
+
+}
+
+static void InsertFixup(Tree *T, Node *z) //, ҪάֺʵĲ
+{
+    Node *y;
+    while( Parent(z)->color == RED ) //ΪĽǺɫģֻΥ3,縸ҲǺɫģҪ
+    {
+        if( Parent(Parent(z))->left == Parent(z) ) //ҪĽz丸
+        {
+            y=Parent(Parent(z))->right; // yΪz常
+            if( y->color == RED ) //case 1: yɫΪɫôyzĸͬʱΪɫȻz
+            { //游Ϊɫz游Υ3,zƳz游
+                y->color=BLACK;
+                z->parent->color=BLACK;
+                z->parent->parent->color=RED;
+                z=z->parent->parent;
+            }
+            else
+            {
+                if( z == z->parent->right ) //case 2: yɫΪɫzzĸĸҽ㣬zתҽzΪԭzparent.
+                {
+                    z=z->parent;
+                    LeftRotate(T, z);
+                }
+                z->parent->color=BLACK; //case 3: yɫΪɫzzĸĸ㣬ôz
+                z->parent->parent->color=RED; //׵ɫΪڣz游ɫΪ죬Ȼתz游
+                RightRotate(T,z->parent->parent);
+            }
+        }
+        else //ǰһԳƣҪĽz丸,עȥ
+        {
+            y=Parent(Parent(z))->left;
+            if( y->color == RED)
+            {
+                z->parent->color=BLACK;
+                y->color=BLACK;
+                z->parent->parent->color=RED;
+                z=z->parent->parent;
+            }
+            else
+            {
+                if( z == z->parent->left )
+                {
+                    z=z->parent;
+                    RightRotate(T,z);
+                }
+                z->parent->color=BLACK;
+                z->parent->parent->color=RED;
+                LeftRotate(T,z->parent->parent);
+            }
+        }
+    }
+    (*T)->color=BLACK; //ΪTĸĻTɫΪɫ
+}
+static void Insert(Tree *T, int val) //
+{
+    if(*T == NULL) //ʼвڣônewһ½ͬʱnewһ½nil
+    {
+        *T=(Tree)malloc(sizeof(Node));
+        nil=(Node*)malloc(sizeof(Node));
+        nil->color=BLACK; //nilɫΪ
+        (*T)->left=nil;
+        (*T)->right=nil;
+        (*T)->parent=nil;
+        (*T)->value=val;
+        (*T)->color=BLACK; //Ϊ2,ɫΪɫ
+    }
+    else //ѾΪգôӸʼ²Ҳ
+    {
+        Node *x=*T; //x浱ǰĸĸ㣬p浱ǰĽ
+        Node *p=nil;
+        while(x != nil) //valСڵǰvalueֵȥұȥ
+        {
+            p=x;
+            if(val < x->value )
+            {
+                x=x->left;
+            }
+            else if(val > x->value)
+            {
+                x=x->right;
+            }
+            else
+            {
+                printf("%s %d/n","duplicate value",val); //ҵvalֵͬĽ㣬ʲôҲֱӷ
+                return;
+            }
+
+        }
+        x=(Node*)malloc(sizeof(Node));
+        x->color=RED; //²ĽɫΪɫ
+        x->left=nil;
+        x->right=nil;
+        x->parent=p;
+        x->value=val;
+        if( val < p->value )
+        {
+            p->left = x;
+        }
+        else
+        {
+            p->right = x;
+        }
+
+        InsertFixup(T, x); //е
+
+    }
+}
+
+static Node* Successor(Tree *T, Node *x) //Ѱҽx
+{
+    if( x->right != nil ) //xΪգôΪߵĽ
+    {
+        Node *p=x->right;
+        while( p->left != nil )
+        {
+            p=p->left;
+        }
+        return p;
+    }
+    else //xΪգôxĺΪxΪ
+    {
+        Node *y=x->parent;
+        while( y != nil && x == y->right )
+        {
+            x=y;
+            y=y->parent;
+        }
+
+        return y;
+    }
+}
+
+static void DeleteFixup(Tree *T, Node *x) //ɾɫ󣬵ºɫȱʧΥ4,ʶе
+{
+    while( x != *T && x->color == BLACK ) //xǺɫֱӰxΪɫѭӸպòһغɫ,Ҳ4
+    {
+        if( x == x->parent->left ) //x丸
+        {
+            Node *w=x->parent->right; //wxֵܽ
+            if( w->color == RED ) //case 1: wɫΪɫĻ
+            {
+                w->color=BLACK;
+                x->parent->color=RED;
+                LeftRotate(T, x->parent);
+                w=x->parent->right;
+            }
+            if( w->left->color == BLACK && w->right->color == BLACK ) //case 2: wɫΪɫɫΪɫ
+            {
+                w->color=RED;
+                x=x->parent;
+            }
+            else
+            {
+                if( w->right->color == BLACK ) //case 3: wǺɫǺɫĻ
+                {
+                    w->color=RED;
+                    w->left->color=BLACK;
+                    RightRotate(T, w);
+                    w=x->parent->right;
+                }
+                w->color=x->parent->color; //case 4: wǺɫ
+                x->parent->color=BLACK;
+                w->right->color=BLACK;
+                LeftRotate(T , x->parent);
+
+                x=*T;
+            }
+        }
+        else //Գx丸
+        {
+            Node *w=x->parent->left;
+            if( w->color == RED )
+            {
+                w->color=BLACK;
+                x->parent->color=RED;
+                RightRotate(T, x->parent);
+                w=x->parent->left;
+            }
+            if( w->left->color == BLACK && w->right->color == BLACK )
+            {
+                w->color=RED;
+                x=x->parent;
+            }
+            else
+            {
+                if( w->left->color == BLACK )
+                {
+                    w->color=RED;
+                    w->right->color=BLACK;
+                    LeftRotate(T, w);
+                    w=x->parent->left;
+                }
+                w->color=x->parent->color;
+                x->parent->color=BLACK;
+                w->left->color=BLACK;
+                RightRotate(T , x->parent);
+
+                x=*T;
+            }
+        }
+    }
+    x->color=BLACK;
+}
+
+static void Delete(Tree *T, Node *z) //ںTɾz
+{
+    Node *y; //yָҪɾĽ
+    Node *x; //xָҪɾĽΨһ
+    if( z->left == nil || z->right == nil ) //zһΪյĻôֱɾz,yָz
+    {
+        y=z;
+    }
+    else
+    {
+        y=Successor(T, z); //zԲΪյĻѰzy
+    } //ֵzֵȻyɾ ( ע: y϶û )
+    if( y->left != nil ) //yΪգxָy
+    {
+        x=y->left;
+    }
+    else
+    {
+        x=y->right;
+    }
+    x->parent=y->parent; //ԭyĸĸΪxĸĸyɾ
+    if( y->parent == nil )
+    {
+        *T=x;
+    }
+    else
+    {
+        if( y == y->parent->left )
+        {
+            y->parent->left=x;
+        }
+        else
+        {
+            y->parent->right=x;
+        }
+    }
+    if( y != z ) //ɾĽyԭҪɾĽz
+    { //ֻyֵzֵȻɾyԴﵽɾzЧ
+        z->value=y->value;
+    }
+    if( y->color == BLACK ) //ɾĽyɫΪɫôܻᵼΥ4,ĳ·һɫ
+    {
+        DeleteFixup(T, x);
+    }
+    free(y);
+}
+static Node* Search(Tree T, int val)
+{
+    if( T != nil )
+    {
+        if( val < T->value )
+        {
+            return Search(T->left, val);
+        }
+        else if ( val > T->value )
+        {
+            return Search(T->right,val);
+        }
+        else
+        {
+            return T;
+        }
+    }
+    return nil;
+}
+
+
+void* bench_rbtree_insert(void *root, int key)
+{
+    Tree t = (Tree)root;
+
+    Insert(&t, key);
+    return t;
+}
+
+void* bench_rbtree_delete(void *root, int key)
+{
+    Tree t = (Tree)root;
+    Node *z;
+
+    if (t == NULL)
+        return t;
+    z = Search(t, key);
+    if (z != nil)
+        Delete(&t, z);
+    return t;
+}
+
+int bench_rbtree_search(void *root, int key)
+{
+    if (root == NULL)
+        return 0;
+    return Search((Tree)root, key) != nil;
+}
+
+/*[lo, hi]ļĺ*/
+int64_t bench_rbtree_range(void *root, int lo, int hi)
+{
+    Node *p = (Node *)root;
+    int64_t sum = 0;
+
+    if (p == NULL || p == nil)
+        return 0;
+    if (lo < p->value)
+        sum += bench_rbtree_range(p->left, lo, hi);
+    if (lo <= p->value && p->value <= hi)
+        sum += p->value;
+    if (p->value < hi)
+        sum += bench_rbtree_range(p->right, lo, hi);
+    return sum;
+}
+
+static void destroy(Node *p)
+{
+    if (p == nil)
+        return;
+    destroy(p->left);
+    destroy(p->right);
+    free(p);
+}
+
+/*nilǽʱmallocģһͷ*/
+void bench_rbtree_destroy(void *root)
+{
+    if (root == NULL)
+        return;
+    destroy((Node *)root);
+    free(nil);
+    nil = NULL;
+}
+
+#ifdef __cplusplus
+}
+#endif
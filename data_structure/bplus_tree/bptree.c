@@ -0,0 +1,654 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "bptree.h"
+
+#define BPT_CHUNK_SIZE  (1 << 20)
+#define BPT_MAX_HEIGHT  16      /*11ӣ2^32Ҳ9*/
+#define BPT_LEAF_MIN    (BPT_LEAF_KEYS / 2)
+#define BPT_INNER_MIN   (BPT_INNER_KEYS / 2)
+#define BPT_PAD         INT32_MAX
+
+typedef char bpt_leaf_size_check[sizeof(bpt_leaf_t) == BPT_NODE_SIZE ? 1 : -1];
+typedef char bpt_inner_size_check[sizeof(bpt_inner_t) == BPT_NODE_SIZE ? 1 : -1];
+
+
+/************************************************************
+ * ڵڲң20λûõBPT_PAD
+ ************************************************************/
+
+#ifdef __SSE2__
+static inline uint32_t cmp_mask(const int32_t *keys, __m128i k, int32_t gt)
+{
+    __m128i v0 = _mm_loadu_si128((const __m128i *)keys);
+    __m128i v1 = _mm_loadu_si128((const __m128i *)(keys + 4));
+    __m128i v2 = _mm_loadu_si128((const __m128i *)(keys + 8));
+    __m128i v3 = _mm_loadu_si128((const __m128i *)(keys + 12));
+    __m128i v4 = _mm_loadu_si128((const __m128i *)(keys + 16));
+
+    if (gt)
+    {
+        v0 = _mm_cmpgt_epi32(v0, k);
+        v1 = _mm_cmpgt_epi32(v1, k);
+        v2 = _mm_cmpgt_epi32(v2, k);
+        v3 = _mm_cmpgt_epi32(v3, k);
+        v4 = _mm_cmpgt_epi32(v4, k);
+    }
+    else
+    {
+        v0 = _mm_cmplt_epi32(v0, k);
+        v1 = _mm_cmplt_epi32(v1, k);
+        v2 = _mm_cmplt_epi32(v2, k);
+        v3 = _mm_cmplt_epi32(v3, k);
+        v4 = _mm_cmplt_epi32(v4, k);
+    }
+    /*ÿ32λȽϽȡһλƴ20λ*/
+    return (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(v0))
+         | (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(v1)) << 4
+         | (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(v2)) << 8
+         | (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(v3)) << 12
+         | (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(v4)) << 16;
+}
+#endif
+
+/*
+ *СkeyļĸҶkeyڵλ
+ *򣬱ȽϽһ1ĩβ1Уòpopcnt
+ */
+static inline uint32_t rank_lt(const int32_t *keys, int32_t key)
+{
+#ifdef __SSE2__
+    return __builtin_ctz(~cmp_mask(keys, _mm_set1_epi32(key), 0));
+#else
+    uint32_t i, n = 0;
+
+    for (i = 0; i < BPT_LEAF_KEYS; i++)
+        n += keys[i] < key;
+    return n;
+#endif
+}
+
+/*ڲڵkeyߵĺӣkeyļĸ*/
+static inline uint32_t child_index(const bpt_inner_t *node, int32_t key)
+{
+    uint32_t n;
+
+#ifdef __SSE2__
+    n = __builtin_ctz(cmp_mask(node->keys, _mm_set1_epi32(key), 1) | 1U << BPT_INNER_KEYS);
+#else
+    uint32_t i;
+
+    for (i = 0, n = 0; i < BPT_INNER_KEYS; i++)
+        n += node->keys[i] <= key;
+#endif
+    /*keyΪINT32_MAXʱλBPT_PADҲȥ*/
+    return n < node->count ? n : node->count;
+}
+
+
+/************************************************************
+ * ڵ
+ ************************************************************/
+
+static void* node_alloc(bptree_t *t)
+{
+    char *chunk;
+    void *p;
+
+    if (t->free_list != NULL)
+    {
+        p = t->free_list;
+        t->free_list = *(void **)p;
+    }
+    else
+    {
+        if (t->left < BPT_NODE_SIZE)
+        {
+            if (posix_memalign((void **)&chunk, 64, BPT_CHUNK_SIZE) != 0)
+                return NULL;
+            *(void **)chunk = t->chunks;
+            t->chunks = chunk;
+            t->cur = chunk + BPT_NODE_SIZE;
+            t->left = BPT_CHUNK_SIZE - BPT_NODE_SIZE;
+            t->chunk_bytes += BPT_CHUNK_SIZE;
+        }
+        p = t->cur;
+        t->cur += BPT_NODE_SIZE;
+        t->left -= BPT_NODE_SIZE;
+    }
+    t->nodes++;
+    return p;
+}
+
+static void node_free(bptree_t *t, void *p)
+{
+    *(void **)p = t->free_list;
+    t->free_list = p;
+    t->nodes--;
+}
+
+static void fill_pad(int32_t *keys, uint32_t from, uint32_t to)
+{
+    while (from < to)
+        keys[from++] = BPT_PAD;
+}
+
+static bpt_leaf_t* leaf_new(bptree_t *t)
+{
+    bpt_leaf_t *leaf = (bpt_leaf_t *)node_alloc(t);
+
+    if (leaf == NULL)
+        return NULL;
+    leaf->count = 0;
+    leaf->leaf = 1;
+    leaf->next = NULL;
+    fill_pad(leaf->keys, 0, BPT_LEAF_KEYS);
+    return leaf;
+}
+
+bptree_t* bptree_create(void)
+{
+    bptree_t *t = (bptree_t *)calloc(1, sizeof(bptree_t));
+
+    if (t == NULL)
+        return NULL;
+    t->root = leaf_new(t);
+    if (t->root == NULL)
+    {
+        free(t);
+        return NULL;
+    }
+    return t;
+}
+
+void bptree_destroy(bptree_t *t)
+{
+    void *chunk, *next;
+
+    if (t == NULL)
+        return;
+    for (chunk = t->chunks; chunk != NULL; chunk = next)
+    {
+        next = *(void **)chunk;
+        free(chunk);
+    }
+    free(t);
+}
+
+
+/************************************************************
+ * 
+ ************************************************************/
+
+static const bpt_leaf_t* find_leaf(const bptree_t *t, int32_t key)
+{
+    const void *node = t->root;
+    uint32_t level;
+
+    for (level = 0; level < t->height; level++)
+    {
+        const bpt_inner_t *inner = (const bpt_inner_t *)node;
+        node = inner->children[child_index(inner, key)];
+    }
+    return (const bpt_leaf_t *)node;
+}
+
+int32_t bptree_search(const bptree_t *t, int32_t key, int64_t *value)
+{
+    const bpt_leaf_t *leaf = find_leaf(t, key);
+    uint32_t pos = rank_lt(leaf->keys, key);
+
+    if (pos >= leaf->count || leaf->keys[pos] != key)
+        return 0;
+    if (value != NULL)
+        *value = leaf->values[pos];
+    return 1;
+}
+
+void bptree_seek(const bptree_t *t, int32_t key, bptree_iter_t *it)
+{
+    it->leaf = find_leaf(t, key);
+    it->pos = rank_lt(it->leaf->keys, key);
+}
+
+int32_t bptree_next(bptree_iter_t *it, int32_t *key, int64_t *value)
+{
+    while (it->pos >= it->leaf->count)
+    {
+        if (it->leaf->next == NULL)
+            return 0;
+        it->leaf = it->leaf->next;
+        it->pos = 0;
+        if (it->leaf->next != NULL)
+            __builtin_prefetch(it->leaf->next);
+    }
+    if (key != NULL)
+        *key = it->leaf->keys[it->pos];
+    if (value != NULL)
+        *value = it->leaf->values[it->pos];
+    it->pos++;
+    return 1;
+}
+
+uint64_t bptree_size(const bptree_t *t)
+{
+    return t->size;
+}
+
+uint64_t bptree_memory(const bptree_t *t)
+{
+    return t->chunk_bytes + sizeof(bptree_t);
+}
+
+
+/************************************************************
+ * 
+ ************************************************************/
+
+static void leaf_insert_at(bpt_leaf_t *leaf, uint32_t pos, int32_t key,
+                           int64_t value)
+{
+    uint32_t n = leaf->count - pos;
+
+    memmove(leaf->keys + pos + 1, leaf->keys + pos, n * sizeof(int32_t));
+    memmove(leaf->values + pos + 1, leaf->values + pos, n * sizeof(int64_t));
+    leaf->keys[pos] = key;
+    leaf->values[pos] = value;
+    leaf->count++;
+}
+
+/*keys[pos]keychildren[pos + 1]child*/
+static void inner_insert_at(bpt_inner_t *node, uint32_t pos, int32_t key,
+                            void *child)
+{
+    uint32_t n = node->count - pos;
+
+    memmove(node->keys + pos + 1, node->keys + pos, n * sizeof(int32_t));
+    memmove(node->children + pos + 2, node->children + pos + 1, n * sizeof(void *));
+    node->keys[pos] = key;
+    node->children[pos + 1] = child;
+    node->count++;
+}
+
+/*ҶӲһΪұߵһ*/
+static int32_t leaf_split(bpt_leaf_t *leaf, bpt_leaf_t *right, uint32_t pos,
+                          int32_t key, int64_t value)
+{
+    int32_t keys[BPT_LEAF_KEYS + 1];
+    int64_t values[BPT_LEAF_KEYS + 1];
+    uint32_t total = BPT_LEAF_KEYS + 1, n;
+
+    memcpy(keys, leaf->keys, pos * sizeof(int32_t));
+    memcpy(values, leaf->values, pos * sizeof(int64_t));
+    keys[pos] = key;
+    values[pos] = value;
+    memcpy(keys + pos + 1, leaf->keys + pos, (BPT_LEAF_KEYS - pos) * sizeof(int32_t));
+    memcpy(values + pos + 1, leaf->values + pos, (BPT_LEAF_KEYS - pos) * sizeof(int64_t));
+
+    /*ұ׷(˳)ʱ԰*/
+    n = pos == BPT_LEAF_KEYS && leaf->next == NULL ? BPT_LEAF_KEYS : (total + 1) / 2;
+    memcpy(leaf->keys, keys, n * sizeof(int32_t));
+    memcpy(leaf->values, values, n * sizeof(int64_t));
+    fill_pad(leaf->keys, n, BPT_LEAF_KEYS);
+    leaf->count = n;
+    memcpy(right->keys, keys + n, (total - n) * sizeof(int32_t));
+    memcpy(right->values, values + n, (total - n) * sizeof(int64_t));
+    right->count = total - n;
+    right->next = leaf->next;
+    leaf->next = right;
+    return right->keys[0];
+}
+
+/*ڲڵһΪмļƲ*/
+static int32_t inner_split(bpt_inner_t *node, bpt_inner_t *right, uint32_t pos,
+                           int32_t key, void *child)
+{
+    int32_t keys[BPT_INNER_KEYS + 1];
+    void *children[BPT_INNER_KEYS + 2];
+    uint32_t total = BPT_INNER_KEYS + 1, n = total / 2;
+
+    memcpy(keys, node->keys, pos * sizeof(int32_t));
+    keys[pos] = key;
+    memcpy(keys + pos + 1, node->keys + pos, (BPT_INNER_KEYS - pos) * sizeof(int32_t));
+    memcpy(children, node->children, (pos + 1) * sizeof(void *));
+    children[pos + 1] = child;
+    memcpy(children + pos + 2, node->children + pos + 1,
+           (BPT_INNER_KEYS - pos) * sizeof(void *));
+
+    memcpy(node->keys, keys, n * sizeof(int32_t));
+    memcpy(node->children, children, (n + 1) * sizeof(void *));
+    fill_pad(node->keys, n, BPT_INNER_KEYS);
+    node->count = n;
+    memcpy(right->keys, keys + n + 1, (total - n - 1) * sizeof(int32_t));
+    memcpy(right->children, children + n + 1, (total - n) * sizeof(void *));
+    right->count = total - n - 1;
+    return keys[n];
+}
+
+int32_t bptree_insert(bptree_t *t, int32_t key, int64_t value)
+{
+    bpt_inner_t *path[BPT_MAX_HEIGHT], *inner, *root;
+    uint32_t idx[BPT_MAX_HEIGHT], pos, need, i;
+    void *spare[BPT_MAX_HEIGHT + 2], *node = t->root, *child;
+    bpt_leaf_t *leaf;
+    int32_t level, sep;
+
+    for (level = 0; level < (int32_t)t->height; level++)
+    {
+        path[level] = (bpt_inner_t *)node;
+        idx[level] = child_index(path[level], key);
+        node = path[level]->children[idx[level]];
+    }
+    leaf = (bpt_leaf_t *)node;
+    pos = rank_lt(leaf->keys, key);
+    if (pos < leaf->count && leaf->keys[pos] == key)
+        return 0;
+    if (leaf->count < BPT_LEAF_KEYS)
+    {
+        leaf_insert_at(leaf, pos, key, value);
+        t->size++;
+        return 1;
+    }
+
+    /*ȰҪѵĽڵ㶼ãڴ治ʱ*/
+    need = 1;
+    for (level = (int32_t)t->height - 1; level >= 0 && path[level]->count == BPT_INNER_KEYS; level--)
+        need++;
+    if (level < 0)
+        need++;     /*ҲҪѣһ¸*/
+    for (i = 0; i < need; i++)
+    {
+        spare[i] = node_alloc(t);
+        if (spare[i] == NULL)
+        {
+            while (i--)
+                node_free(t, spare[i]);
+            return -1;
+        }
+    }
+
+    i = 0;
+    child = spare[i++];
+    ((bpt_leaf_t *)child)->leaf = 1;
+    sep = leaf_split(leaf, (bpt_leaf_t *)child, pos, key, value);
+    fill_pad(((bpt_leaf_t *)child)->keys, ((bpt_leaf_t *)child)->count, BPT_LEAF_KEYS);
+    for (level = (int32_t)t->height - 1; level >= 0; level--)
+    {
+        inner = path[level];
+        if (inner->count < BPT_INNER_KEYS)
+        {
+            inner_insert_at(inner, idx[level], sep, child);
+            child = NULL;
+            break;
+        }
+        node = spare[i++];
+        ((bpt_inner_t *)node)->leaf = 0;
+        sep = inner_split(inner, (bpt_inner_t *)node, idx[level], sep, child);
+        fill_pad(((bpt_inner_t *)node)->keys, ((bpt_inner_t *)node)->count, BPT_INNER_KEYS);
+        child = node;
+    }
+    if (child != NULL)
+    {
+        root = (bpt_inner_t *)spare[i++];
+        root->leaf = 0;
+        root->count = 1;
+        fill_pad(root->keys, 0, BPT_INNER_KEYS);
+        root->keys[0] = sep;
+        root->children[0] = t->root;
+        root->children[1] = child;
+        t->root = root;
+        t->height++;
+    }
+    t->size++;
+    return 1;
+}
+
+
+/************************************************************
+ * ɾ
+ ************************************************************/
+
+static void leaf_remove_at(bpt_leaf_t *leaf, uint32_t pos)
+{
+    uint32_t n = leaf->count - pos - 1;
+
+    memmove(leaf->keys + pos, leaf->keys + pos + 1, n * sizeof(int32_t));
+    memmove(leaf->values + pos, leaf->values + pos + 1, n * sizeof(int64_t));
+    leaf->count--;
+    leaf->keys[leaf->count] = BPT_PAD;
+}
+
+/*ɾkeys[pos]children[pos + 1]*/
+static void inner_remove_at(bpt_inner_t *node, uint32_t pos)
+{
+    uint32_t n = node->count - pos - 1;
+
+    memmove(node->keys + pos, node->keys + pos + 1, n * sizeof(int32_t));
+    memmove(node->children + pos + 1, node->children + pos + 2, n * sizeof(void *));
+    node->count--;
+    node->keys[node->count] = BPT_PAD;
+}
+
+/*Ҷһ룺ֵܽһ費ͺϲϲ1*/
+static int32_t leaf_rebalance(bptree_t *t, bpt_inner_t *parent, uint32_t i,
+                              bpt_leaf_t *leaf)
+{
+    bpt_leaf_t *left = i > 0 ? (bpt_leaf_t *)parent->children[i - 1] : NULL;
+    bpt_leaf_t *right = i < parent->count ? (bpt_leaf_t *)parent->children[i + 1] : NULL;
+
+    if (left != NULL && left->count > BPT_LEAF_MIN)
+    {
+        leaf_insert_at(leaf, 0, left->keys[left->count - 1],
+                       left->values[left->count - 1]);
+        leaf_remove_at(left, left->count - 1);
+        parent->keys[i - 1] = leaf->keys[0];
+        return 0;
+    }
+    if (right != NULL && right->count > BPT_LEAF_MIN)
+    {
+        leaf_insert_at(leaf, leaf->count, right->keys[0], right->values[0]);
+        leaf_remove_at(right, 0);
+        parent->keys[i] = right->keys[0];
+        return 0;
+    }
+    if (left == NULL)
+    {
+        /*ұ߲ұߵ߲*/
+        left = leaf;
+        leaf = right;
+        i++;
+    }
+    memcpy(left->keys + left->count, leaf->keys, leaf->count * sizeof(int32_t));
+    memcpy(left->values + left->count, leaf->values, leaf->count * sizeof(int64_t));
+    left->count += leaf->count;
+    left->next = leaf->next;
+    inner_remove_at(parent, i - 1);
+    node_free(t, leaf);
+    return 1;
+}
+
+static int32_t inner_rebalance(bptree_t *t, bpt_inner_t *parent, uint32_t i,
+                               bpt_inner_t *node)
+{
+    bpt_inner_t *left = i > 0 ? (bpt_inner_t *)parent->children[i - 1] : NULL;
+    bpt_inner_t *right = i < parent->count ? (bpt_inner_t *)parent->children[i + 1] : NULL;
+
+    if (left != NULL && left->count > BPT_INNER_MIN)
+    {
+        /*ڵļֵļȥ*/
+        memmove(node->keys + 1, node->keys, node->count * sizeof(int32_t));
+        memmove(node->children + 1, node->children, (node->count + 1) * sizeof(void *));
+        node->keys[0] = parent->keys[i - 1];
+        node->children[0] = left->children[left->count];
+        node->count++;
+        parent->keys[i - 1] = left->keys[left->count - 1];
+        left->count--;
+        left->keys[left->count] = BPT_PAD;
+        return 0;
+    }
+    if (right != NULL && right->count > BPT_INNER_MIN)
+    {
+        node->keys[node->count] = parent->keys[i];
+        node->children[node->count + 1] = right->children[0];
+        node->count++;
+        parent->keys[i] = right->keys[0];
+        memmove(right->keys, right->keys + 1, (right->count - 1) * sizeof(int32_t));
+        memmove(right->children, right->children + 1, right->count * sizeof(void *));
+        right->count--;
+        right->keys[right->count] = BPT_PAD;
+        return 0;
+    }
+    if (left == NULL)
+    {
+        left = node;
+        node = right;
+        i++;
+    }
+    left->keys[left->count] = parent->keys[i - 1];
+    memcpy(left->keys + left->count + 1, node->keys, node->count * sizeof(int32_t));
+    memcpy(left->children + left->count + 1, node->children,
+           (node->count + 1) * sizeof(void *));
+    left->count += node->count + 1;
+    inner_remove_at(parent, i - 1);
+    node_free(t, node);
+    return 1;
+}
+
+int32_t bptree_delete(bptree_t *t, int32_t key)
+{
+    bpt_inner_t *path[BPT_MAX_HEIGHT], *root;
+    uint32_t idx[BPT_MAX_HEIGHT], pos;
+    void *node = t->root;
+    bpt_leaf_t *leaf;
+    int32_t level;
+
+    for (level = 0; level < (int32_t)t->height; level++)
+    {
+        path[level] = (bpt_inner_t *)node;
+        idx[level] = child_index(path[level], key);
+        node = path[level]->children[idx[level]];
+    }
+    leaf = (bpt_leaf_t *)node;
+    pos = rank_lt(leaf->keys, key);
+    if (pos >= leaf->count || leaf->keys[pos] != key)
+        return 0;
+    leaf_remove_at(leaf, pos);
+    t->size--;
+
+    level = t->height;
+    if (level > 0 && leaf->count < BPT_LEAF_MIN)
+    {
+        if (leaf_rebalance(t, path[level - 1], idx[level - 1], leaf))
+        {
+            /*ϲˣڵһܽ*/
+            for (level--; level > 0 && path[level]->count < BPT_INNER_MIN; level--)
+            {
+                if (!inner_rebalance(t, path[level - 1], idx[level - 1], path[level]))
+                    break;
+            }
+        }
+    }
+
+    root = (bpt_inner_t *)t->root;
+    if (t->height > 0 && root->count == 0)
+    {
+        t->root = root->children[0];
+        t->height--;
+        node_free(t, root);
+    }
+    return 1;
+}
+
+
+/************************************************************
+ * 
+ ************************************************************/
+
+typedef struct check_state{
+    const bpt_leaf_t *prev_leaf;
+    uint64_t keys;
+    uint64_t nodes;
+} check_state_t;
+
+/*ļ[lo, hi]*/
+static int32_t check_node(const void *node, uint32_t depth, uint32_t height,
+                          int64_t lo, int64_t hi, int32_t is_root,
+                          check_state_t *st)
+{
+    const bpt_leaf_t *leaf;
+    const bpt_inner_t *inner;
+    uint32_t i;
+
+    st->nodes++;
+    if (depth == height)
+    {
+        leaf = (const bpt_leaf_t *)node;
+        if (!leaf->leaf || leaf->count > BPT_LEAF_KEYS || (!is_root && leaf->count == 0))
+            return -1;
+        for (i = 0; i < leaf->count; i++)
+        {
+            if (leaf->keys[i] < lo || leaf->keys[i] > hi)
+                return -1;
+            if (i > 0 && leaf->keys[i] <= leaf->keys[i - 1])
+                return -1;
+        }
+        for (; i < BPT_LEAF_KEYS; i++)
+        {
+            if (leaf->keys[i] != BPT_PAD)
+                return -1;
+        }
+        if (st->prev_leaf != NULL && st->prev_leaf->next != leaf)
+            return -1;
+        st->prev_leaf = leaf;
+        st->keys += leaf->count;
+        return 0;
+    }
+
+    inner = (const bpt_inner_t *)node;
+    if (inner->leaf || inner->count > BPT_INNER_KEYS || inner->count == 0)
+        return -1;
+    for (i = 0; i < inner->count; i++)
+    {
+        if (inner->keys[i] < lo || inner->keys[i] > hi)
+            return -1;
+        if (i > 0 && inner->keys[i] <= inner->keys[i - 1])
+            return -1;
+    }
+    for (i = inner->count; i < BPT_INNER_KEYS; i++)
+    {
+        if (inner->keys[i] != BPT_PAD)
+            return -1;
+    }
+    for (i = 0; i <= inner->count; i++)
+    {
+        if (check_node(inner->children[i], depth + 1, height,
+                       i == 0 ? lo : inner->keys[i - 1],
+                       i == inner->count ? hi : (int64_t)inner->keys[i] - 1,
+                       0, st) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+int32_t bptree_check(const bptree_t *t)
+{
+    check_state_t st = {NULL, 0, 0};
+
+    if (check_node(t->root, 0, t->height, INT32_MIN, INT32_MAX, 1, &st) != 0)
+        return -1;
+    if (st.prev_leaf->next != NULL || st.keys != t->size || st.nodes != t->nodes)
+        return -1;
+    return 0;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,115 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ *B+int32_tint64_tֵ
+ *avl_treered_black_treebinary_search_tree ÿmallocһڵ㣬ÿһ
+ *һcache missһڵ256ֽ(4cache line)20
+ *    ڲڵ  20 + 21ָ
+ *    Ҷӽڵ  20 + 20ֵ + ָһҶӵָ룬Χѯ˳Ҷ
+ *ڲSSE2һαȽ4ûõļλINT32_MAXÿҲ÷֧
+ *ڵ1MĴУͷŵĹҵϡ
+ *
+ *롢ɾҵǼinsert/deleteNode/searchһ
+ *ѾھͲ(ֵ)ɾڵļʲôҲ
+ */
+
+#ifndef _BPTREE_H_
+#define _BPTREE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define BPT_NODE_SIZE   256
+#define BPT_LEAF_KEYS   20
+#define BPT_INNER_KEYS  20
+
+typedef struct bpt_leaf{
+    uint16_t count;
+    uint8_t leaf;
+    uint8_t pad[5];
+    struct bpt_leaf *next;
+    int32_t keys[BPT_LEAF_KEYS];
+    int64_t values[BPT_LEAF_KEYS];
+} bpt_leaf_t;
+
+/*keys[i]children[i+1]Сļ½*/
+typedef struct bpt_inner{
+    uint16_t count;
+    uint8_t leaf;
+    uint8_t pad[5];
+    int32_t keys[BPT_INNER_KEYS];
+    void *children[BPT_INNER_KEYS + 1];
+} bpt_inner_t;
+
+typedef struct bptree{
+    void *root;
+    uint32_t height;        /*0ʾҶ*/
+    uint64_t size;
+    void *chunks;           /*õһڵλô*/
+    char *cur;
+    size_t left;
+    void *free_list;
+    uint64_t chunk_bytes;
+    uint64_t nodes;
+} bptree_t;
+
+typedef struct bptree_iter{
+    const bpt_leaf_t *leaf;
+    uint32_t pos;
+} bptree_iter_t;
+
+/*
+ *ܣһÿ
+ *ֵNULLʾڴ治
+ */
+bptree_t* bptree_create(void);
+
+void bptree_destroy(bptree_t *t);
+
+/*
+ *ܣkey
+ *ֵ1ˣ0Ѿ(ֵ)-1ڴ治
+ */
+int32_t bptree_insert(bptree_t *t, int32_t key, int64_t value);
+
+/*
+ *ܣɾkey
+ *ֵ1ɾˣ0û
+ */
+int32_t bptree_delete(bptree_t *t, int32_t key);
+
+/*
+ *ܣkeyҵʱֵŵ*value(valueΪNULL)
+ *ֵ1ҵ0û
+ */
+int32_t bptree_search(const bptree_t *t, int32_t key, int64_t *value);
+
+/*
+ *ܣλһСkeyļ֮bptree_nextСȡ
+ */
+void bptree_seek(const bptree_t *t, int32_t key, bptree_iter_t *it);
+
+/*
+ *ܣȡǰļֵ
+ *ֵ1ȡ0Ѿͷ
+ */
+int32_t bptree_next(bptree_iter_t *it, int32_t *key, int64_t *value);
+
+uint64_t bptree_size(const bptree_t *t);
+
+/*ϵͳҪֽ*/
+uint64_t bptree_memory(const bptree_t *t);
+
+/*
+ *ܣ򡢽ڵҶ
+ *ֵ0-1д
+ */
+int32_t bptree_check(const bptree_t *t);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,203 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include "bptree.h"
+#include "../test_util.h"
+
+/*
+ *B+ avl_treered_black_treerbTreebinary_search_tree Աȣ
+ *nظ(һ)Χѯ(ƽÿ100)ɾn/10
+ *÷bptree_bench [-n ] [-q ѯ]
+ *n1Mÿγ10-nޣĬ10M100MʱavlҪ5Gڴ棬
+ */
+
+typedef struct tree_ops{
+    const char *name;
+    void* (*insert)(void *root, int key);
+    void* (*remove)(void *root, int key);   /*NULLʾ֧ɾ*/
+    int (*search)(void *root, int key);
+    int64_t (*range)(void *root, int lo, int hi);
+    void (*destroy)(void *root);
+} tree_ops_t;
+
+/*bench_avl.c bench_rbt.c bench_rbtree.c bench_bst.c*/
+void* bench_avl_insert(void *root, int key);
+void* bench_avl_delete(void *root, int key);
+int bench_avl_search(void *root, int key);
+int64_t bench_avl_range(void *root, int lo, int hi);
+void bench_avl_destroy(void *root);
+
+void* bench_rbt_insert(void *root, int key);
+int bench_rbt_search(void *root, int key);
+int64_t bench_rbt_range(void *root, int lo, int hi);
+void bench_rbt_destroy(void *root);
+
+void* bench_rbtree_insert(void *root, int key);
+void* bench_rbtree_delete(void *root, int key);
+int bench_rbtree_search(void *root, int key);
+int64_t bench_rbtree_range(void *root, int lo, int hi);
+void bench_rbtree_destroy(void *root);
+
+void* bench_bst_insert(void *root, int key);
+void* bench_bst_delete(void *root, int key);
+int bench_bst_search(void *root, int key);
+int64_t bench_bst_range(void *root, int lo, int hi);
+void bench_bst_destroy(void *root);
+
+/*B+һĽӿڣrootbptree_t*/
+static void* bpt_insert(void *root, int key)
+{
+    bptree_t *t = root != NULL ? (bptree_t *)root : bptree_create();
+
+    bptree_insert(t, key, key);
+    return t;
+}
+
+static void* bpt_delete(void *root, int key)
+{
+    bptree_delete((bptree_t *)root, key);
+    return root;
+}
+
+static int bpt_search(void *root, int key)
+{
+    return bptree_search((bptree_t *)root, key, NULL);
+}
+
+static int64_t bpt_range(void *root, int lo, int hi)
+{
+    bptree_iter_t it;
+    int32_t key;
+    int64_t sum = 0;
+
+    bptree_seek((bptree_t *)root, lo, &it);
+    while (bptree_next(&it, &key, NULL) && key <= hi)
+        sum += key;
+    return sum;
+}
+
+static void bpt_destroy(void *root)
+{
+    bptree_destroy((bptree_t *)root);
+}
+
+static tree_ops_t trees[] = {
+    {"bptree", bpt_insert, bpt_delete, bpt_search, bpt_range, bpt_destroy},
+    {"avl_tree", bench_avl_insert, bench_avl_delete, bench_avl_search, bench_avl_range, bench_avl_destroy},
+    {"rbt", bench_rbt_insert, NULL, bench_rbt_search, bench_rbt_range, bench_rbt_destroy},
+    {"rbTree", bench_rbtree_insert, bench_rbtree_delete, bench_rbtree_search, bench_rbtree_range, bench_rbtree_destroy},
+    {"bst", bench_bst_insert, bench_bst_delete, bench_bst_search, bench_bst_range, bench_bst_destroy},
+};
+
+#define TREE_NUM    (sizeof(trees) / sizeof(trees[0]))
+
+/*2^32һһӳ䣬iͬͲͬ*/
+static int key_of(uint64_t i)
+{
+    return (int)(int32_t)(uint32_t)(i * 2654435761U);
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t max_n = 10000000, n, i, queries = 1000000, ranges, hits;
+    uint64_t want_hits = 0, span;
+    int64_t sum, want_sum = 0, lo, hi;
+    struct timeval tv_begin, tv_end;
+    double t_insert, t_search, t_range, t_delete, bytes = 0;
+    void *root;
+    size_t k;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:q:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            max_n = (uint64_t)atof(optarg);
+            break;
+        case 'q':
+            queries = (uint64_t)atof(optarg);
+            break;
+        default:
+            printf("usage: %s [-n max keys] [-q queries]\n", argv[0]);
+            return -1;
+        }
+    }
+    ranges = queries / 10;
+
+    for (n = 1000000; n <= max_n; n *= 10)
+    {
+        span = 100 * (UINT64_C(1) << 32) / n;
+        printf("n = %llu, ns per op, range = %llu scans of ~100 keys\n",
+               (unsigned long long)n, (unsigned long long)ranges);
+        printf("%-10s %10s %10s %10s %10s %10s\n", "tree", "insert", "search", "range",
+               "delete", "bytes/key");
+        for (k = 0; k < TREE_NUM; k++)
+        {
+            root = NULL;
+            gettimeofday(&tv_begin, NULL);
+            for (i = 0; i < n; i++)
+                root = trees[k].insert(root, key_of(i));
+            gettimeofday(&tv_end, NULL);
+            t_insert = diff_time(tv_begin, tv_end);
+
+            /*һһ벻Уÿһ*/
+            rng = TEST_RNG_SEED;
+            hits = 0;
+            gettimeofday(&tv_begin, NULL);
+            for (i = 0; i < queries; i++)
+                hits += trees[k].search(root, key_of(xorshift64() % (2 * n)));
+            gettimeofday(&tv_end, NULL);
+            t_search = diff_time(tv_begin, tv_end);
+
+            sum = 0;
+            gettimeofday(&tv_begin, NULL);
+            for (i = 0; i < ranges; i++)
+            {
+                lo = key_of(xorshift64() % n);
+                hi = lo + (int64_t)span;
+                sum += trees[k].range(root, (int)lo, hi > INT32_MAX ? INT32_MAX : (int)hi);
+            }
+            gettimeofday(&tv_end, NULL);
+            t_range = diff_time(tv_begin, tv_end);
+
+            if (k == 0)
+            {
+                want_hits = hits;
+                want_sum = sum;
+                bytes = (double)bptree_memory((bptree_t *)root) / n;
+            }
+            else if (hits != want_hits || sum != want_sum)
+                printf("%s: results differ from bptree\n", trees[k].name);
+
+            t_delete = -1;
+            if (trees[k].remove != NULL)
+            {
+                gettimeofday(&tv_begin, NULL);
+                for (i = 0; i < n / 10; i++)
+                    root = trees[k].remove(root, key_of(i * 7 % n));
+                gettimeofday(&tv_end, NULL);
+                t_delete = diff_time(tv_begin, tv_end);
+            }
+            trees[k].destroy(root);
+
+            printf("%-10s %10.1f %10.1f %10.1f", trees[k].name, t_insert * 1e9 / n,
+                   t_search * 1e9 / queries, t_range * 1e9 / ranges);
+            if (t_delete < 0)
+                printf(" %10s", "-");
+            else
+                printf(" %10.1f", t_delete * 1e9 / (n / 10));
+            /*ÿһmalloc㲻׼ֻB+*/
+            if (k == 0)
+                printf(" %10.1f\n", bytes);
+            else
+                printf(" %10s\n", "-");
+            fflush(stdout);
+        }
+        printf("\n");
+    }
+    return 0;
+}
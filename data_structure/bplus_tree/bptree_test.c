@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "bptree.h"
+#include "../test_util.h"
+
+/*
+ *ɾһ±¼գһһ
+ */
+
+#define RANGE   6000    /*ȡ[-RANGE/2, RANGE/2)ټINT32_MININT32_MAX*/
+
+static int32_t slot_key(uint32_t slot)
+{
+    if (slot == RANGE)
+        return INT32_MIN;
+    if (slot == RANGE + 1)
+        return INT32_MAX;
+    return (int32_t)slot - RANGE / 2;
+}
+
+static void compare(bptree_t *t, const int8_t *present, const int64_t *values)
+{
+    bptree_iter_t it;
+    int32_t key, lo;
+    int64_t value;
+    uint32_t slot, n = 0;
+
+    CHECK(bptree_check(t) == 0, "check failed, size %llu", (unsigned long long)bptree_size(t));
+
+    bptree_seek(t, INT32_MIN, &it);
+    CHECK(present[RANGE] == 0 || (bptree_next(&it, &key, &value) && key == INT32_MIN),
+          "INT32_MIN missing in scan");
+    for (slot = 0; slot < RANGE; slot++)
+    {
+        if (!present[slot])
+            continue;
+        CHECK(bptree_next(&it, &key, &value), "scan ended early at %d", slot_key(slot));
+        CHECK(key == slot_key(slot) && value == values[slot],
+              "scan got %d want %d", key, slot_key(slot));
+        n++;
+    }
+    CHECK(present[RANGE + 1] == 0 || (bptree_next(&it, &key, &value) && key == INT32_MAX),
+          "INT32_MAX missing in scan");
+    CHECK(!bptree_next(&it, &key, &value), "scan has extra keys");
+    n += present[RANGE] + present[RANGE + 1];
+    CHECK(n == bptree_size(t), "size %llu want %u", (unsigned long long)bptree_size(t), n);
+
+    /*λÿʼķΧѯ*/
+    lo = (int32_t)(xorshift64() % RANGE) - RANGE / 2;
+    bptree_seek(t, lo, &it);
+    for (slot = lo + RANGE / 2; slot < RANGE; slot++)
+    {
+        if (!present[slot])
+            continue;
+        CHECK(bptree_next(&it, &key, NULL) && key == slot_key(slot),
+              "range from %d: got %d want %d", lo, key, slot_key(slot));
+        break;
+    }
+}
+
+static void test_random(void)
+{
+    static int8_t present[RANGE + 2];
+    static int64_t values[RANGE + 2];
+    bptree_t *t = bptree_create();
+    uint32_t i, slot, op;
+    int32_t key, ret;
+    int64_t value;
+
+    memset(present, 0, sizeof(present));
+    for (i = 0; i < 400000; i++)
+    {
+        slot = xorshift64() % (RANGE + 2);
+        key = slot_key(slot);
+        /*ǰһ壬һɾȥ*/
+        op = xorshift64() % 100;
+        if (op < (i < 200000 ? 60 : 30))
+        {
+            value = (int64_t)xorshift64();
+            ret = bptree_insert(t, key, value);
+            if (ret != !present[slot])
+            {
+                printf("insert %d returned %d\n", key, ret);
+                failed++;
+                break;
+            }
+            if (ret == 1)
+            {
+                present[slot] = 1;
+                values[slot] = value;
+            }
+        }
+        else if (op < 90)
+        {
+            ret = bptree_delete(t, key);
+            if (ret != present[slot])
+            {
+                printf("delete %d returned %d\n", key, ret);
+                failed++;
+                break;
+            }
+            present[slot] = 0;
+        }
+        else
+        {
+            ret = bptree_search(t, key, &value);
+            if (ret != present[slot] || (ret && value != values[slot]))
+            {
+                printf("search %d returned %d\n", key, ret);
+                failed++;
+                break;
+            }
+        }
+        if (i % 1000 == 0)
+            compare(t, present, values);
+    }
+    compare(t, present, values);
+
+    for (slot = 0; slot < RANGE + 2; slot++)
+        bptree_delete(t, slot_key(slot));
+    if (bptree_size(t) != 0 || bptree_check(t) != 0 || t->height != 0 || t->nodes != 1)
+    {
+        printf("tree not empty after deleting everything\n");
+        failed++;
+    }
+    bptree_destroy(t);
+}
+
+/*˳룬ɾ*/
+static void test_order(int32_t step)
+{
+    bptree_t *t = bptree_create();
+    uint32_t n = 1000000, i, j, tmp, *perm;
+    int32_t key;
+    int64_t value;
+
+    for (i = 0; i < n; i++)
+    {
+        key = step > 0 ? (int32_t)i : (int32_t)(n - i);
+        bptree_insert(t, key * 3, key);
+    }
+    if (bptree_check(t) != 0 || bptree_size(t) != n)
+    {
+        printf("order %d: check failed\n", step);
+        failed++;
+    }
+    if (step > 0)
+        printf("ascending insert: %llu nodes for %u keys, %.1f bytes/key\n",
+               (unsigned long long)t->nodes, n, (double)t->nodes * BPT_NODE_SIZE / n);
+    for (i = 0; i < n; i += 997)
+    {
+        key = step > 0 ? (int32_t)i : (int32_t)(n - i);
+        if (!bptree_search(t, key * 3, &value) || value != key || bptree_search(t, key * 3 + 1, NULL))
+        {
+            printf("order %d: search %d failed\n", step, key * 3);
+            failed++;
+            break;
+        }
+    }
+
+    perm = (uint32_t *)malloc(n * sizeof(uint32_t));
+    for (i = 0; i < n; i++)
+        perm[i] = i;
+    for (i = n - 1; i > 0; i--)
+    {
+        j = xorshift64() % (i + 1);
+        tmp = perm[i];
+        perm[i] = perm[j];
+        perm[j] = tmp;
+    }
+    for (i = 0; i < n; i++)
+    {
+        key = step > 0 ? (int32_t)perm[i] : (int32_t)(n - perm[i]);
+        if (bptree_delete(t, key * 3) != 1)
+        {
+            printf("order %d: delete %d failed\n", step, key * 3);
+            failed++;
+            break;
+        }
+        if (i % 100000 == 0 && bptree_check(t) != 0)
+        {
+            printf("order %d: check failed after %u deletes\n", step, i);
+            failed++;
+            break;
+        }
+    }
+    if (bptree_size(t) != 0 || t->nodes != 1)
+    {
+        printf("order %d: tree not empty\n", step);
+        failed++;
+    }
+    free(perm);
+    bptree_destroy(t);
+}
+
+int main(void)
+{
+    test_random();
+    test_order(1);
+    test_order(-1);
+
+    if (failed)
+        printf("%d failed\n", failed);
+    else
+        printf("all passed\n");
+    return failed != 0;
+}
@@ -0,0 +1,780 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ *CSRͼĽͼдļ߳飬csr.h
+ *ͼÿĶ(ԭӼ) -> ǰ׺͵õoffsets -> ÿԭӵһλдȥ
+ *      -> ÿھ(ֿ̬飬ܴ) -> CSR_SIMPLEʱȥѹ
+ *      ȨĳȰ(ھ<<32|Ȩ)uint64رǰ棬ٲ
+ *߱mmapļ߳гɼΣпڶ뵽ףÿдģ
+ *      ٸԽѸŲһ
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "csr.h"
+#include "csr_parallel.h"
+#include "../sort/sort.h"
+
+#define CSR_SORT_CHUNK      1024    /*ʱһô*/
+#define CSR_MAGIC           "CSRGRAPH"
+#define CSR_FILE_WEIGHTED   4       /*ļͷflagsģCSR_DIRECTED֮*/
+
+typedef struct team_worker{
+    struct team_ctl *ctl;
+    int32_t tid;
+    pthread_t thread;
+} team_worker_t;
+
+typedef struct team_ctl{
+    csr_team_t team;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int32_t go;
+    csr_work_fn fn;
+    void *arg;
+} team_ctl_t;
+
+/*õ߳ȵţ֪һ˼ٿʼ*/
+static void *team_main(void *data)
+{
+    team_worker_t *w = (team_worker_t *)data;
+    team_ctl_t *ctl = w->ctl;
+
+    pthread_mutex_lock(&ctl->lock);
+    while (!ctl->go)
+        pthread_cond_wait(&ctl->cond, &ctl->lock);
+    pthread_mutex_unlock(&ctl->lock);
+    ctl->fn(&ctl->team, w->tid, ctl->arg);
+    return NULL;
+}
+
+void csr_parallel(int32_t threads, csr_work_fn fn, void *arg)
+{
+    team_worker_t workers[CSR_MAX_THREADS];
+    team_ctl_t ctl;
+    int32_t i;
+
+    if (threads > CSR_MAX_THREADS)
+        threads = CSR_MAX_THREADS;
+    if (threads <= 1)
+    {
+        ctl.team.threads = 1;
+        fn(&ctl.team, 0, arg);
+        return;
+    }
+
+    pthread_mutex_init(&ctl.lock, NULL);
+    pthread_cond_init(&ctl.cond, NULL);
+    ctl.go = 0;
+    ctl.fn = fn;
+    ctl.arg = arg;
+    for (i = 1; i < threads; i++)
+    {
+        workers[i].ctl = &ctl;
+        workers[i].tid = i;
+        if (pthread_create(&workers[i].thread, NULL, team_main, &workers[i]) != 0)
+            break;
+    }
+    ctl.team.threads = i;
+    if (i > 1)
+        pthread_barrier_init(&ctl.team.barrier, NULL, i);
+    pthread_mutex_lock(&ctl.lock);
+    ctl.go = 1;
+    pthread_cond_broadcast(&ctl.cond);
+    pthread_mutex_unlock(&ctl.lock);
+
+    fn(&ctl.team, 0, arg);
+    for (i = 1; i < ctl.team.threads; i++)
+        pthread_join(workers[i].thread, NULL);
+    if (ctl.team.threads > 1)
+        pthread_barrier_destroy(&ctl.team.barrier);
+    pthread_cond_destroy(&ctl.cond);
+    pthread_mutex_destroy(&ctl.lock);
+}
+
+
+typedef struct build_arg{
+    const csr_edge_t *edges;
+    const uint32_t *weights;            /*NULLȨ*/
+    uint64_t m;
+    uint32_t n;
+    int32_t flags;
+    csr_graph_t *g;
+    uint64_t *cursor;                   /*n+1Ƕд*/
+    uint64_t partial[CSR_MAX_THREADS];  /*ǰ׺ʱÿ߳Ƕεĺ*/
+    uint64_t total;
+    uint64_t next;                      /*ֿ̬һ*/
+    uint32_t *compact;                  /*ѹ߲Ժadj*/
+    uint64_t *packed;                   /*Ȩʱ(ھ<<32|Ȩ)*/
+    int32_t failed;
+} build_arg_t;
+
+/*cursor[0..n)ԭظĳɲԼǰ׺ͣܺ*/
+static uint64_t prefix_sum(csr_team_t *team, int32_t tid, build_arg_t *b)
+{
+    uint64_t lo, hi, v, sum = 0, d;
+    int32_t i;
+
+    csr_split(b->n, tid, team->threads, &lo, &hi);
+    for (v = lo; v < hi; v++)
+        sum += b->cursor[v];
+    b->partial[tid] = sum;
+    csr_barrier(team);
+    if (tid == 0)
+    {
+        for (i = 0, sum = 0; i < team->threads; i++)
+        {
+            d = b->partial[i];
+            b->partial[i] = sum;
+            sum += d;
+        }
+        b->total = sum;
+        b->cursor[b->n] = sum;
+    }
+    csr_barrier(team);
+    for (v = lo, sum = b->partial[tid]; v < hi; v++)
+    {
+        d = b->cursor[v];
+        b->cursor[v] = sum;
+        sum += d;
+    }
+    csr_barrier(team);
+    return b->total;
+}
+
+/*side 0ߣ1ͼ*/
+static int32_t build_side(csr_team_t *team, int32_t tid, build_arg_t *b, int32_t side)
+{
+    csr_graph_t *g = b->g;
+    const csr_edge_t *e;
+    uint64_t lo, hi, elo, ehi, i, j, v, *off, pos, old, len, total, *pa;
+    uint32_t *adj = NULL, *a, *na, u, w;
+    int32_t undirected = !(b->flags & CSR_DIRECTED);
+    int32_t weighted = side == 0 && b->weights != NULL;
+
+    csr_split(b->n, tid, team->threads, &lo, &hi);
+    csr_split(b->m, tid, team->threads, &elo, &ehi);
+    off = side == 0 ? g->offsets : g->in_offsets;
+
+    for (v = lo; v < hi; v++)
+        b->cursor[v] = 0;
+    csr_barrier(team);
+    for (i = elo; i < ehi; i++)
+    {
+        e = b->edges + i;
+        u = side == 0 ? e->src : e->dst;
+        __atomic_fetch_add(&b->cursor[u], 1, __ATOMIC_RELAXED);
+        if (undirected)
+            __atomic_fetch_add(&b->cursor[e->dst], 1, __ATOMIC_RELAXED);
+    }
+    csr_barrier(team);
+
+    total = prefix_sum(team, tid, b);
+    if (tid == 0)
+    {
+        if (weighted)
+        {
+            b->packed = (uint64_t *)malloc((total > 0 ? total : 1) * sizeof(uint64_t));
+            if (b->packed == NULL)
+                b->failed = 1;
+        }
+        else
+        {
+            adj = (uint32_t *)malloc((total > 0 ? total : 1) * sizeof(uint32_t));
+            if (adj == NULL)
+                b->failed = 1;
+            if (side == 0)
+                g->adj = adj;
+            else
+                g->in_adj = adj;
+        }
+        b->next = 0;
+    }
+    for (v = lo; v < hi; v++)
+        off[v] = b->cursor[v];
+    if (tid == 0)
+        off[b->n] = total;
+    csr_barrier(team);
+    if (b->failed)
+        return -1;
+    adj = side == 0 ? g->adj : g->in_adj;
+
+    /*ÿԭӵһλãͬһھ˳ҵģ*/
+    for (i = elo; i < ehi; i++)
+    {
+        e = b->edges + i;
+        u = side == 0 ? e->src : e->dst;
+        w = side == 0 ? e->dst : e->src;
+        if (weighted)
+        {
+            b->packed[__atomic_fetch_add(&b->cursor[u], 1, __ATOMIC_RELAXED)] =
+                (uint64_t)w << 32 | b->weights[i];
+            if (undirected)
+                b->packed[__atomic_fetch_add(&b->cursor[w], 1, __ATOMIC_RELAXED)] =
+                    (uint64_t)u << 32 | b->weights[i];
+            continue;
+        }
+        adj[__atomic_fetch_add(&b->cursor[u], 1, __ATOMIC_RELAXED)] = w;
+        if (undirected)
+            adj[__atomic_fetch_add(&b->cursor[w], 1, __ATOMIC_RELAXED)] = u;
+    }
+    csr_barrier(team);
+
+    for (;;)
+    {
+        lo = __atomic_fetch_add(&b->next, CSR_SORT_CHUNK, __ATOMIC_RELAXED);
+        if (lo >= b->n)
+            break;
+        hi = lo + CSR_SORT_CHUNK < b->n ? lo + CSR_SORT_CHUNK : b->n;
+        for (v = lo; v < hi; v++)
+        {
+            len = off[v + 1] - off[v];
+            if (weighted)
+            {
+                pa = b->packed + off[v];
+                if (len > 1)
+                    sort_u64(pa, len);
+                b->cursor[v] = len;
+                if (!(b->flags & CSR_SIMPLE))
+                    continue;
+                for (i = 0, pos = 0; i < len; i++)
+                {
+                    if ((pa[i] >> 32) != v && (pos == 0 || (pa[i] >> 32) != (pa[pos - 1] >> 32)))
+                        pa[pos++] = pa[i];
+                }
+                b->cursor[v] = pos;
+                continue;
+            }
+            a = adj + off[v];
+            if (len > 1)
+                sort_u32(a, len);
+            if (!(b->flags & CSR_SIMPLE))
+                continue;
+            /*źˣȥغȥԻѹһ飬µĶcursor*/
+            for (i = 0, pos = 0; i < len; i++)
+            {
+                if (a[i] != v && (pos == 0 || a[i] != a[pos - 1]))
+                    a[pos++] = a[i];
+            }
+            b->cursor[v] = pos;
+        }
+    }
+    csr_barrier(team);
+    if (!(b->flags & CSR_SIMPLE) && !weighted)
+        return 0;
+
+    /*ȥıŲµoffsetscursorٿһ飻Ȩ˳*/
+    total = prefix_sum(team, tid, b);
+    if (tid == 0)
+    {
+        b->compact = (uint32_t *)malloc((total > 0 ? total : 1) * sizeof(uint32_t));
+        if (b->compact == NULL)
+            b->failed = 1;
+        if (weighted)
+        {
+            g->weight = (uint32_t *)malloc((total > 0 ? total : 1) * sizeof(uint32_t));
+            if (g->weight == NULL)
+                b->failed = 1;
+        }
+    }
+    csr_barrier(team);
+    if (b->failed)
+        return -1;
+    na = b->compact;
+    csr_split(b->n, tid, team->threads, &lo, &hi);
+    for (v = lo; v < hi; v++)
+    {
+        old = off[v];
+        off[v] = b->cursor[v];
+        len = b->cursor[v + 1] - b->cursor[v];
+        if (!weighted)
+        {
+            memcpy(na + b->cursor[v], adj + old, len * sizeof(uint32_t));
+            continue;
+        }
+        for (j = 0; j < len; j++)
+        {
+            na[b->cursor[v] + j] = (uint32_t)(b->packed[old + j] >> 32);
+            g->weight[b->cursor[v] + j] = (uint32_t)b->packed[old + j];
+        }
+    }
+    csr_barrier(team);
+    if (tid == 0)
+    {
+        off[b->n] = total;
+        free(adj);
+        free(b->packed);
+        b->packed = NULL;
+        b->compact = NULL;
+        if (side == 0)
+            g->adj = na;
+        else
+            g->in_adj = na;
+    }
+    csr_barrier(team);
+    return 0;
+}
+
+static void build_work(csr_team_t *team, int32_t tid, void *data)
+{
+    build_arg_t *b = (build_arg_t *)data;
+    csr_graph_t *g = b->g;
+    uint64_t lo, hi, i, max = 0;
+    int32_t t;
+
+    csr_split(b->m, tid, team->threads, &lo, &hi);
+    if (b->n == 0)
+    {
+        /*+1CSR_NONEܵ*/
+        for (i = lo; i < hi; i++)
+        {
+            if (b->edges[i].src + 1ULL > max)
+                max = b->edges[i].src + 1ULL;
+            if (b->edges[i].dst + 1ULL > max)
+                max = b->edges[i].dst + 1ULL;
+        }
+        b->partial[tid] = max;
+        csr_barrier(team);
+        if (tid == 0)
+        {
+            for (t = 0; t < team->threads; t++)
+                max = b->partial[t] > max ? b->partial[t] : max;
+            if (max > CSR_NONE)
+                b->failed = 1;
+            b->n = (uint32_t)max;
+        }
+    }
+    else
+    {
+        for (i = lo; i < hi; i++)
+        {
+            if (b->edges[i].src >= b->n || b->edges[i].dst >= b->n)
+                __atomic_store_n(&b->failed, 1, __ATOMIC_RELAXED);
+        }
+    }
+    csr_barrier(team);
+    if (tid == 0 && !b->failed)
+    {
+        g->n = b->n;
+        b->cursor = (uint64_t *)malloc((b->n + 1ULL) * sizeof(uint64_t));
+        g->offsets = (uint64_t *)malloc((b->n + 1ULL) * sizeof(uint64_t));
+        if (g->directed)
+            g->in_offsets = (uint64_t *)malloc((b->n + 1ULL) * sizeof(uint64_t));
+        if (b->cursor == NULL || g->offsets == NULL || (g->directed && g->in_offsets == NULL))
+            b->failed = 1;
+    }
+    csr_barrier(team);
+    if (b->failed)
+        return;
+
+    if (build_side(team, tid, b, 0) != 0)
+        return;
+    if (g->directed)
+        build_side(team, tid, b, 1);
+}
+
+csr_graph_t* csr_build(const csr_edge_t *edges, uint64_t m, uint32_t n, int32_t flags,
+                       int32_t threads)
+{
+    return csr_build_weighted(edges, NULL, m, n, flags, threads);
+}
+
+csr_graph_t* csr_build_weighted(const csr_edge_t *edges, const uint32_t *weights, uint64_t m,
+                                uint32_t n, int32_t flags, int32_t threads)
+{
+    csr_graph_t *g = (csr_graph_t *)calloc(1, sizeof(csr_graph_t));
+    build_arg_t *b = (build_arg_t *)calloc(1, sizeof(build_arg_t));
+
+    if (g == NULL || b == NULL)
+    {
+        free(g);
+        free(b);
+        return NULL;
+    }
+    g->directed = (flags & CSR_DIRECTED) != 0;
+    b->edges = edges;
+    b->weights = weights;
+    b->m = m;
+    b->n = n;
+    b->flags = flags;
+    b->g = g;
+    csr_parallel(threads, build_work, b);
+
+    free(b->cursor);
+    free(b->packed);
+    free(b->compact);
+    if (b->failed)
+    {
+        csr_free(g);
+        g = NULL;
+    }
+    else
+    {
+        g->m = g->offsets[g->n];
+        if (!g->directed)
+        {
+            g->in_offsets = g->offsets;
+            g->in_adj = g->adj;
+        }
+    }
+    free(b);
+    return g;
+}
+
+void csr_free(csr_graph_t *g)
+{
+    if (g == NULL)
+        return;
+    if (g->in_offsets != g->offsets)
+        free(g->in_offsets);
+    if (g->in_adj != g->adj)
+        free(g->in_adj);
+    free(g->offsets);
+    free(g->adj);
+    free(g->weight);
+    free(g);
+}
+
+
+typedef struct load_arg{
+    const char *data;
+    uint64_t size;
+    csr_edge_t *edges;
+    uint32_t *weights;                  /*ҪȨʱ*/
+    int32_t weighted;
+    uint64_t base[CSR_MAX_THREADS];     /*дedges*/
+    uint64_t count[CSR_MAX_THREADS];    /*ʵʽ*/
+    uint64_t max[CSR_MAX_THREADS];
+    int32_t failed;
+} load_arg_t;
+
+/*tidδĿʼ뵽*/
+static uint64_t load_begin(const load_arg_t *l, int32_t tid, int32_t threads)
+{
+    uint64_t pos;
+
+    if (tid == 0)
+        return 0;
+    if (tid >= threads)
+        return l->size;
+    pos = l->size * tid / threads;
+    while (pos < l->size && l->data[pos - 1] != '\n')
+        pos++;
+    return pos;
+}
+
+/*һCSR_NONE-1-1ʾʽ*/
+static int32_t parse_id(const char **pp, const char *end, uint32_t *id)
+{
+    const char *p = *pp;
+    uint64_t x = 0;
+
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+    if (p == end || *p < '0' || *p > '9')
+        return -1;
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        x = x * 10 + (*p++ - '0');
+        if (x >= CSR_NONE)
+            return -1;
+    }
+    *id = (uint32_t)x;
+    *pp = p;
+    return 0;
+}
+
+static void load_work(csr_team_t *team, int32_t tid, void *data)
+{
+    load_arg_t *l = (load_arg_t *)data;
+    const char *p, *end, *nl;
+    csr_edge_t *out;
+    uint32_t *wout = NULL;
+    uint64_t lines = 0, sum, d, max = 0;
+    uint32_t u, v, w;
+    int32_t i;
+
+    p = l->data + load_begin(l, tid, team->threads);
+    end = l->data + load_begin(l, tid + 1, team->threads);
+    for (nl = p; nl < end && (nl = (const char *)memchr(nl, '\n', end - nl)) != NULL; nl++)
+        lines++;
+    if (p < end && end[-1] != '\n')
+        lines++;
+    l->base[tid] = lines;
+    csr_barrier(team);
+    if (tid == 0)
+    {
+        for (i = 0, sum = 0; i < team->threads; i++)
+        {
+            d = l->base[i];
+            l->base[i] = sum;
+            sum += d;
+        }
+        l->edges = (csr_edge_t *)malloc((sum > 0 ? sum : 1) * sizeof(csr_edge_t));
+        if (l->weighted)
+            l->weights = (uint32_t *)malloc((sum > 0 ? sum : 1) * sizeof(uint32_t));
+        if (l->edges == NULL || (l->weighted && l->weights == NULL))
+            l->failed = 1;
+    }
+    csr_barrier(team);
+    if (l->failed)
+        return;
+
+    out = l->edges + l->base[tid];
+    if (l->weighted)
+        wout = l->weights + l->base[tid];
+    while (p < end)
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+            p++;
+        if (p < end && *p != '\n' && *p != '#' && *p != '%')
+        {
+            if (parse_id(&p, end, &u) != 0 || parse_id(&p, end, &v) != 0)
+            {
+                __atomic_store_n(&l->failed, 1, __ATOMIC_RELAXED);
+                break;
+            }
+            if (l->weighted)
+            {
+                /*пû*/
+                while (p < end && (*p == ' ' || *p == '\t'))
+                    p++;
+                w = 1;
+                if (p < end && *p >= '0' && *p <= '9' && parse_id(&p, end, &w) != 0)
+                {
+                    __atomic_store_n(&l->failed, 1, __ATOMIC_RELAXED);
+                    break;
+                }
+                *wout++ = w;
+            }
+            out->src = u;
+            out->dst = v;
+            out++;
+            max = u + 1ULL > max ? u + 1ULL : max;
+            max = v + 1ULL > max ? v + 1ULL : max;
+        }
+        nl = (const char *)memchr(p, '\n', end - p);
+        p = nl != NULL ? nl + 1 : end;
+    }
+    l->count[tid] = out - (l->edges + l->base[tid]);
+    l->max[tid] = max;
+}
+
+static csr_edge_t* load_edges(const char *path, uint64_t *m, uint32_t *n, uint32_t **weights,
+                              int32_t threads)
+{
+    load_arg_t *l;
+    csr_edge_t *edges;
+    struct stat st;
+    void *shrunk;
+    uint64_t total = 0, max = 0;
+    int32_t fd, i;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    l = (load_arg_t *)calloc(1, sizeof(load_arg_t));
+    if (l == NULL || fstat(fd, &st) != 0)
+    {
+        free(l);
+        close(fd);
+        return NULL;
+    }
+    l->size = st.st_size;
+    l->weighted = weights != NULL;
+    if (l->size > 0)
+    {
+        l->data = (const char *)mmap(NULL, l->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (l->data == MAP_FAILED)
+        {
+            free(l);
+            close(fd);
+            return NULL;
+        }
+        madvise((void *)l->data, l->size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    /*Сļһ߳̾͹*/
+    if (threads < 1)
+        threads = 1;
+    if ((uint64_t)threads > l->size / 65536 + 1)
+        threads = (int32_t)(l->size / 65536 + 1);
+    if (threads > CSR_MAX_THREADS)
+        threads = CSR_MAX_THREADS;
+    csr_parallel(threads, load_work, l);
+    if (l->size > 0)
+        munmap((void *)l->data, l->size);
+
+    edges = l->edges;
+    if (l->failed)
+    {
+        free(edges);
+        free(l->weights);
+        free(l);
+        return NULL;
+    }
+    /*Ųһ*/
+    for (i = 0; i < threads; i++)
+    {
+        if (l->base[i] != total && l->count[i] > 0)
+        {
+            memmove(edges + total, edges + l->base[i], l->count[i] * sizeof(csr_edge_t));
+            if (l->weighted)
+                memmove(l->weights + total, l->weights + l->base[i],
+                        l->count[i] * sizeof(uint32_t));
+        }
+        total += l->count[i];
+        max = l->max[i] > max ? l->max[i] : max;
+    }
+    if (total > 0)
+    {
+        shrunk = realloc(edges, total * sizeof(csr_edge_t));
+        edges = shrunk != NULL ? (csr_edge_t *)shrunk : edges;
+        if (l->weighted)
+        {
+            shrunk = realloc(l->weights, total * sizeof(uint32_t));
+            l->weights = shrunk != NULL ? (uint32_t *)shrunk : l->weights;
+        }
+    }
+    if (weights != NULL)
+        *weights = l->weights;
+    *m = total;
+    *n = (uint32_t)max;
+    free(l);
+    return edges;
+}
+
+csr_edge_t* csr_load_edges(const char *path, uint64_t *m, uint32_t *n, int32_t threads)
+{
+    return load_edges(path, m, n, NULL, threads);
+}
+
+csr_edge_t* csr_load_weighted_edges(const char *path, uint64_t *m, uint32_t *n,
+                                    uint32_t **weights, int32_t threads)
+{
+    return load_edges(path, m, n, weights, threads);
+}
+
+
+typedef struct csr_file_header{
+    char magic[8];
+    uint32_t n;
+    int32_t flags;          /*CSR_DIRECTEDCSR_FILE_WEIGHTED*/
+    uint64_t m;
+} csr_file_header_t;
+
+static int32_t write_side(FILE *fp, const uint64_t *off, const uint32_t *adj, uint32_t n,
+                          uint64_t m)
+{
+    if (fwrite(off, sizeof(uint64_t), n + 1ULL, fp) != n + 1ULL)
+        return -1;
+    if (m > 0 && fwrite(adj, sizeof(uint32_t), m, fp) != m)
+        return -1;
+    return 0;
+}
+
+int32_t csr_save(const csr_graph_t *g, const char *path)
+{
+    csr_file_header_t h;
+    FILE *fp = fopen(path, "wb");
+    int32_t ret = -1;
+
+    if (fp == NULL)
+        return -1;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, CSR_MAGIC, 8);
+    h.n = g->n;
+    h.flags = (g->directed ? CSR_DIRECTED : 0) | (g->weight != NULL ? CSR_FILE_WEIGHTED : 0);
+    h.m = g->m;
+    if (fwrite(&h, sizeof(h), 1, fp) == 1 &&
+        write_side(fp, g->offsets, g->adj, g->n, g->m) == 0 &&
+        (g->weight == NULL || g->m == 0 || fwrite(g->weight, sizeof(uint32_t), g->m, fp) == g->m) &&
+        (!g->directed || write_side(fp, g->in_offsets, g->in_adj, g->n, g->m) == 0))
+        ret = 0;
+    if (fclose(fp) != 0)
+        ret = -1;
+    return ret;
+}
+
+/*һoffsetsadjoffsetsھӱСn*/
+static int32_t read_side(FILE *fp, uint64_t **off, uint32_t **adj, uint32_t n, uint64_t m)
+{
+    uint64_t i;
+
+    *off = (uint64_t *)malloc((n + 1ULL) * sizeof(uint64_t));
+    *adj = (uint32_t *)malloc((m > 0 ? m : 1) * sizeof(uint32_t));
+    if (*off == NULL || *adj == NULL)
+        return -1;
+    if (fread(*off, sizeof(uint64_t), n + 1ULL, fp) != n + 1ULL ||
+        (m > 0 && fread(*adj, sizeof(uint32_t), m, fp) != m))
+        return -1;
+    if ((*off)[0] != 0 || (*off)[n] != m)
+        return -1;
+    for (i = 0; i < n; i++)
+    {
+        if ((*off)[i] > (*off)[i + 1])
+            return -1;
+    }
+    for (i = 0; i < m; i++)
+    {
+        if ((*adj)[i] >= n)
+            return -1;
+    }
+    return 0;
+}
+
+csr_graph_t* csr_load(const char *path)
+{
+    csr_file_header_t h;
+    csr_graph_t *g;
+    FILE *fp = fopen(path, "rb");
+
+    if (fp == NULL)
+        return NULL;
+    g = (csr_graph_t *)calloc(1, sizeof(csr_graph_t));
+    if (g == NULL || fread(&h, sizeof(h), 1, fp) != 1 || memcmp(h.magic, CSR_MAGIC, 8) != 0 ||
+        h.n == CSR_NONE)
+    {
+        free(g);
+        fclose(fp);
+        return NULL;
+    }
+    g->n = h.n;
+    g->directed = (h.flags & CSR_DIRECTED) != 0;
+    g->m = h.m;
+    if ((h.flags & CSR_FILE_WEIGHTED) &&
+        (g->weight = (uint32_t *)malloc((g->m > 0 ? g->m : 1) * sizeof(uint32_t))) == NULL)
+    {
+        csr_free(g);
+        fclose(fp);
+        return NULL;
+    }
+    if (read_side(fp, &g->offsets, &g->adj, g->n, g->m) != 0 ||
+        (g->weight != NULL && g->m > 0 && fread(g->weight, sizeof(uint32_t), g->m, fp) != g->m) ||
+        (g->directed && read_side(fp, &g->in_offsets, &g->in_adj, g->n, g->m) != 0))
+    {
+        csr_free(g);
+        fclose(fp);
+        return NULL;
+    }
+    if (!g->directed)
+    {
+        g->in_offsets = g->offsets;
+        g->in_adj = g->adj;
+    }
+    fclose(fp);
+    return g;
+}
+
+#ifdef __cplusplus
+}
+#endif
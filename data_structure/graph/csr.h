@@ -0,0 +1,172 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ *CSR(compressed sparse row)ͼͼ
+ *adjacency_list.c ÿmallocһAdjListNodeһ߹ڵҪG
+ *ʱһֱ׷ָ롣жھӰ˳һ
+ *    vھ adj[offsets[v]] ... adj[offsets[v+1]-1]Сź
+ *һ4ֽڣ8ֽڡͼÿһΡ
+ *ͼһݷ(in_offsets/in_adj)BFSԵϺͨҪã
+ *ͼin_offsets/in_adjָoffsets/adj
+ *
+ *csr_build       ӱ߱߳̽ͼ
+ *csr_load_edges  SNAPʽı߱("u v"һУ#%ͷע)mmap߳̽
+ *csr_save/load   õͼɶļ´ֱӶ
+ *csr_bfs         ŻĶ߳BFSǰСʱǰ(top-downǰǶ)
+ *                ǰشʱûʹĶԼھڲǰ(bottom-up
+ *                ǰλͼ)󲿷ֱ߲ÿ
+ *csr_dfs         ǵݹDFS˳ Traversal.c ĵݹDFSһ
+ *csr_cc          ߳ͨ(ͼͨ)鼯+CASֻÿͷ
+ *                ھӣҳķʣµı˶ľͲÿ
+ *
+ *Ȩͼ(csr_build_weighted)һadjӦweight飬ֻгߴȨ
+ *csr_dijkstra    ߳Dijkstra(radix heap)ֻϴε
+ *                ߵĲͬλͰһԪŲ64ΣñȽ
+ *csr_sssp        ߳delta-stepping밴deltaͰͬһͰĶ㲢ɳڣ
+ *                ÿ߳ԼͰһͰһһ
+ *csr_pagerank    ߳PageRankԴ㰴blockһпÿεһ
+ *                CSRһֻһζĹֵܷŽ
+ */
+
+#ifndef _CSR_H_
+#define _CSR_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define CSR_DIRECTED    1       /*ͼӷ*/
+#define CSR_SIMPLE      2       /*ȥԻر*/
+
+#define CSR_NONE        UINT32_MAX
+#define CSR_INF         UINT64_MAX  /*˵ľ*/
+
+/*BFSķ򣬲ԺͶԱãƽʱCSR_BFS_AUTO*/
+#define CSR_BFS_AUTO        0
+#define CSR_BFS_TOP_DOWN    1
+#define CSR_BFS_BOTTOM_UP   2
+
+typedef struct csr_edge{
+    uint32_t src;
+    uint32_t dst;
+} csr_edge_t;
+
+typedef struct csr_graph{
+    uint32_t n;             /*0..n-1*/
+    int32_t directed;
+    uint64_t m;             /*adjĳȣͼǱ*/
+    uint64_t *offsets;      /*n+1*/
+    uint32_t *adj;
+    uint64_t *in_offsets;   /*ͼķߣͼoffsetsһ*/
+    uint32_t *in_adj;
+    uint32_t *weight;       /*adjӦıȨȨNULL*/
+} csr_graph_t;
+
+/**/
+static inline uint64_t csr_degree(const csr_graph_t *g, uint32_t v)
+{
+    return g->offsets[v + 1] - g->offsets[v];
+}
+
+/*
+ *ܣӱ߱ͼ
+ *edges ߣm n 0ȡ+1
+ *      flags CSR_DIRECTEDCSR_SIMPLEthreads ߳
+ *ֵNULLʾڴ治߱ߵıŲСn
+ */
+csr_graph_t* csr_build(const csr_edge_t *edges, uint64_t m, uint32_t n, int32_t flags,
+                       int32_t threads);
+
+/*
+ *ܣӱ߱Ȩͼ
+ *weights edgesһһӦCSR_SIMPLEʱرֻһͬcsr_build
+ *ֵͬcsr_build
+ */
+csr_graph_t* csr_build_weighted(const csr_edge_t *edges, const uint32_t *weights, uint64_t m,
+                                uint32_t n, int32_t flags, int32_t threads);
+
+/*ͷ*/
+void csr_free(csr_graph_t *g);
+
+/*
+ *ܣı߱һ"u v"вܣк#%ͷ
+ *m رn +1
+ *ֵmallocı߱NULLʾ򲻿ʽڴ治
+ */
+csr_edge_t* csr_load_edges(const char *path, uint64_t *m, uint32_t *n, int32_t threads);
+
+/*
+ *ܣȨı߱һ"u v w"ûееıȨ1
+ *weights mallocıȨͱ߱һһӦ
+ *ֵͬcsr_load_edges
+ */
+csr_edge_t* csr_load_weighted_edges(const char *path, uint64_t *m, uint32_t *n,
+                                    uint32_t **weights, int32_t threads);
+
+/*
+ *ܣͼɶļ
+ *ֵ0ɹ-1ʧ
+ */
+int32_t csr_save(const csr_graph_t *g, const char *path);
+
+/*
+ *ܣcsr_saveļ
+ *ֵNULLʾ򲻿ʽԻڴ治
+ */
+csr_graph_t* csr_load(const char *path);
+
+/*
+ *ܣsrcʼBFS
+ *depth ÿĲsrc0˵-1
+ *      mode CSR_BFS_AUTO ǿһ
+ *ֵĶ(src)-1ʾsrcСnڴ治
+ */
+int64_t csr_bfs(const csr_graph_t *g, uint32_t src, int32_t *depth, int32_t threads,
+                int32_t mode);
+
+/*
+ *ܣsrcʼDFSھӰС˳
+ *order ˳򷵻ض㣬parent DFSϵĸףsrcԼ
+ *      ûCSR_NONEΪNULL
+ *ֵʵĶ-1ʾsrcСnڴ治
+ */
+int64_t csr_dfs(const csr_graph_t *g, uint32_t src, uint32_t *order, uint32_t *parent);
+
+/*
+ *ܣͨͼͨ
+ *comp ÿڷСĶ
+ *ֵ
+ */
+int64_t csr_cc(const csr_graph_t *g, uint32_t *comp, int32_t threads);
+
+/*
+ *ܣsrcʼĵԴ·DijkstraȨͼȨ1
+ *dist ÿľ룬˵CSR_INF
+ *ֵĶ(src)-1ʾsrcСnڴ治
+ */
+int64_t csr_dijkstra(const csr_graph_t *g, uint32_t src, uint64_t *dist);
+
+/*
+ *ܣ߳delta-steppingԴ·csr_dijkstraһ
+ *delta Ͱ0ƽȨƽһ
+ *ֵͬcsr_dijkstra
+ */
+int64_t csr_sssp(const csr_graph_t *g, uint32_t src, uint64_t *dist, uint64_t delta,
+                 int32_t threads);
+
+/*
+ *ܣPageRankΪ0Ķֵƽָж㣬rank1
+ *damping ϵ(һ0.85)tol ֮rank仯L1Сͣ
+ *      max_iters ֣block ÿεԴ0Ĭֵ(ֵռ1MB)
+ *      rank nֵ
+ *ֵ-1ڴ治
+ */
+int32_t csr_pagerank(const csr_graph_t *g, double damping, double tol, int32_t max_iters,
+                     uint32_t block, double *rank, int32_t threads);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
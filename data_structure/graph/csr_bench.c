@@ -0,0 +1,414 @@
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "csr.h"
+#include "../test_util.h"
+
+/*
+ *CSRͼĽͼ߱BFS/DFS/ͨٶȣBFSÿı(TEPS)
+ *ĬR-MAT2^scale㡢edgefactor*2^scaleߵͼ(Graph500Ĳ)
+ *-f SNAPʽı߱ļ
+ *Աȵ adjacency_list.c/Traversal.c дÿmallocһڵ㣬Ҳ
+ *ٽһȨͼ(Ȩȡ1..wļеоõ)Dijkstra
+ *delta-steppingPageRankPageRankԱȷֶκͲֶΡ
+ *÷csr_bench [-s scale] [-e edgefactor] [-f ߱ļ] [-t ߳] [-r BFS]
+ *       [-L Ա] [-w Ȩ] [-d delta0Զѡ] [-i PageRank]
+ *ĬR-MAT scale 20 edgefactor 16߳ΪCPU8BFS㣬Ȩ1..255
+ */
+
+static uint32_t scale = 20;
+static uint32_t edgefactor = 16;
+static int32_t threads = 0;
+static int32_t nroots = 8;
+static int32_t with_list = 1;
+static uint32_t max_weight = 255;
+static uint64_t delta = 0;
+static int32_t pr_iters = 20;
+
+/* R-MATa=0.57 b=0.19 c=0.19 d=0.05ٴһ£ȻĶǰ */
+static csr_edge_t* rmat(uint64_t m)
+{
+    csr_edge_t *edges = (csr_edge_t *)malloc(m * sizeof(csr_edge_t));
+    uint32_t n = 1U << scale, *perm, b, u, v, t;
+    uint64_t i, r, seed = 88172645463325252ULL;
+
+    perm = (uint32_t *)malloc((size_t)n * sizeof(uint32_t));
+    if (edges == NULL || perm == NULL)
+    {
+        free(edges);
+        free(perm);
+        return NULL;
+    }
+    for (u = 0; u < n; u++)
+        perm[u] = u;
+    for (u = n - 1; u > 0; u--)
+    {
+        v = (uint32_t)(xorshift(&seed) % (u + 1ULL));
+        t = perm[u];
+        perm[u] = perm[v];
+        perm[v] = t;
+    }
+    for (i = 0; i < m; i++)
+    {
+        u = v = 0;
+        for (b = 0; b < scale; b++)
+        {
+            r = xorshift(&seed) % 100;
+            u = u * 2 + (r >= 76);
+            v = v * 2 + ((r >= 57 && r < 76) || r >= 95);
+        }
+        edges[i].src = perm[u];
+        edges[i].dst = perm[v];
+    }
+    free(perm);
+    return edges;
+}
+
+/* Traversal.c д */
+typedef struct list_node{
+    uint32_t dest;
+    struct list_node *next;
+} list_node_t;
+
+typedef struct queue_node{
+    uint32_t data;
+    struct queue_node *next;
+} queue_node_t;
+
+static list_node_t **list_build(const csr_edge_t *edges, uint64_t m, uint32_t n)
+{
+    list_node_t **head = (list_node_t **)calloc(n, sizeof(list_node_t *));
+    list_node_t *node;
+    uint64_t i;
+
+    for (i = 0; i < m && head != NULL; i++)
+    {
+        node = (list_node_t *)malloc(sizeof(list_node_t));
+        node->dest = edges[i].dst;
+        node->next = head[edges[i].src];
+        head[edges[i].src] = node;
+        node = (list_node_t *)malloc(sizeof(list_node_t));
+        node->dest = edges[i].src;
+        node->next = head[edges[i].dst];
+        head[edges[i].dst] = node;
+    }
+    return head;
+}
+
+static void list_free(list_node_t **head, uint32_t n)
+{
+    list_node_t *node, *next;
+    uint32_t v;
+
+    for (v = 0; v < n; v++)
+    {
+        for (node = head[v]; node != NULL; node = next)
+        {
+            next = node->next;
+            free(node);
+        }
+    }
+    free(head);
+}
+
+static uint64_t list_bfs(list_node_t **head, uint32_t n, uint32_t src, int32_t *depth)
+{
+    queue_node_t *front, *rear, *q;
+    list_node_t *node;
+    uint64_t reached = 1;
+    uint32_t v;
+
+    for (v = 0; v < n; v++)
+        depth[v] = -1;
+    depth[src] = 0;
+    front = rear = (queue_node_t *)malloc(sizeof(queue_node_t));
+    front->data = src;
+    front->next = NULL;
+    while (front != NULL)
+    {
+        v = front->data;
+        for (node = head[v]; node != NULL; node = node->next)
+        {
+            if (depth[node->dest] < 0)
+            {
+                depth[node->dest] = depth[v] + 1;
+                q = (queue_node_t *)malloc(sizeof(queue_node_t));
+                q->data = node->dest;
+                q->next = NULL;
+                rear->next = q;
+                rear = q;
+                reached++;
+            }
+        }
+        q = front;
+        front = front->next;
+        free(q);
+    }
+    return reached;
+}
+
+/* Graph500㷨BFSıǵĶ֮͵һ */
+static uint64_t traversed_edges(const csr_graph_t *g, const int32_t *depth)
+{
+    uint64_t sum = 0;
+    uint32_t v;
+
+    for (v = 0; v < g->n; v++)
+    {
+        if (depth[v] >= 0)
+            sum += csr_degree(g, v);
+    }
+    return sum / 2;
+}
+
+static void pick_roots(const csr_graph_t *g, uint32_t *roots)
+{
+    uint64_t seed = 0x2545F4914F6CDD1DULL;
+    int32_t i, tries;
+
+    for (i = 0; i < nroots; i++)
+    {
+        tries = 0;
+        do {
+            roots[i] = (uint32_t)(xorshift(&seed) % g->n);
+        } while (csr_degree(g, roots[i]) == 0 && ++tries < 1000);
+    }
+}
+
+static void bench_bfs(const csr_graph_t *g, const uint32_t *roots, int32_t *depth,
+                      const char *name, int32_t nthreads, int32_t mode)
+{
+    uint64_t edges = 0;
+    double t, total = 0;
+    int32_t i;
+
+    for (i = 0; i < nroots; i++)
+    {
+        t = now_sec();
+        csr_bfs(g, roots[i], depth, nthreads, mode);
+        total += now_sec() - t;
+        edges += traversed_edges(g, depth);
+    }
+    printf("bfs %-20s threads %3d: %8.2f ms/root %10.2f M TEPS\n", name, nthreads,
+           total * 1e3 / nroots, edges / total / 1e6);
+}
+
+static void bench_list(const csr_edge_t *edges, uint64_t m, const csr_graph_t *g,
+                       const uint32_t *roots, int32_t *depth)
+{
+    list_node_t **head;
+    uint64_t traversed = 0;
+    double t, total = 0;
+    int32_t i;
+
+    t = now_sec();
+    head = list_build(edges, m, g->n);
+    t = now_sec() - t;
+    printf("build linked list          : %8.2f s, %8.1f MB\n", t,
+           (g->n * sizeof(void *) + 2 * m * sizeof(list_node_t)) / 1e6);
+    for (i = 0; i < nroots; i++)
+    {
+        t = now_sec();
+        list_bfs(head, g->n, roots[i], depth);
+        total += now_sec() - t;
+        traversed += traversed_edges(g, depth);
+    }
+    printf("bfs %-20s threads %3d: %8.2f ms/root %10.2f M TEPS\n", "linked list", 1,
+           total * 1e3 / nroots, traversed / total / 1e6);
+    list_free(head, g->n);
+}
+
+/* ·ɨıĶĳ֮ */
+static void bench_sssp(const csr_graph_t *g, const uint32_t *roots, uint64_t *dist,
+                       const char *name, int32_t nthreads)
+{
+    uint64_t edges = 0;
+    double t, total = 0;
+    int32_t i, nr = nroots < 4 ? nroots : 4;
+    uint32_t v;
+
+    for (i = 0; i < nr; i++)
+    {
+        t = now_sec();
+        if (nthreads == 0)
+            csr_dijkstra(g, roots[i], dist);
+        else
+            csr_sssp(g, roots[i], dist, delta, nthreads);
+        total += now_sec() - t;
+        for (v = 0; v < g->n; v++)
+            edges += dist[v] != CSR_INF ? csr_degree(g, v) : 0;
+    }
+    printf("sssp %-19s threads %3d: %8.2f ms/root %10.2f M edges/s\n", name,
+           nthreads > 0 ? nthreads : 1, total * 1e3 / nr, edges / total / 1e6);
+}
+
+static void bench_pagerank(const csr_graph_t *g, double *rank, const char *name,
+                           uint32_t block, int32_t nthreads)
+{
+    double t;
+    int32_t iters;
+
+    t = now_sec();
+    iters = csr_pagerank(g, 0.85, 0, pr_iters, block, rank, nthreads);
+    t = now_sec() - t;
+    printf("pagerank %-15s threads %3d: %8.2f ms/iter %10.2f M edges/s\n", name, nthreads,
+           t * 1e3 / iters, (double)g->m * iters / t / 1e6);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path = NULL;
+    csr_edge_t *edges;
+    csr_graph_t *g;
+    uint32_t *roots, *buf, *weights, n = 0;
+    uint64_t m, i, *dist, seed = 0x9E3779B97F4A7C15ULL;
+    int32_t *depth;
+    double t, *rank;
+    int64_t k;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:e:f:t:r:Lw:d:i:")) != -1)
+    {
+        switch (opt)
+        {
+        case 's':
+            scale = strtoul(optarg, NULL, 0);
+            break;
+        case 'e':
+            edgefactor = strtoul(optarg, NULL, 0);
+            break;
+        case 'f':
+            path = optarg;
+            break;
+        case 't':
+            threads = atoi(optarg);
+            break;
+        case 'r':
+            nroots = atoi(optarg);
+            break;
+        case 'L':
+            with_list = 0;
+            break;
+        case 'w':
+            max_weight = strtoul(optarg, NULL, 0);
+            break;
+        case 'd':
+            delta = strtoull(optarg, NULL, 0);
+            break;
+        case 'i':
+            pr_iters = atoi(optarg);
+            break;
+        default:
+            scale = 0;
+        }
+    }
+    if (threads <= 0)
+        threads = (int32_t)sysconf(_SC_NPROCESSORS_ONLN);
+    if (scale == 0 || scale > 31 || edgefactor == 0 || nroots <= 0 || threads > 256 ||
+        max_weight == 0 || pr_iters <= 0)
+    {
+        printf("usage: %s [-s scale] [-e edgefactor] [-f edge_file] [-t threads] [-r roots] "
+               "[-L] [-w max_weight] [-d delta] [-i pagerank_iters]\n", argv[0]);
+        return -1;
+    }
+
+    t = now_sec();
+    if (path != NULL)
+    {
+        edges = csr_load_weighted_edges(path, &m, &n, &weights, threads);
+        if (edges == NULL)
+        {
+            fprintf(stderr, "cannot load %s\n", path);
+            return 1;
+        }
+        t = now_sec() - t;
+        printf("load %s: %llu edges in %.2f s, %.2f M edges/s\n", path,
+               (unsigned long long)m, t, m / t / 1e6);
+    }
+    else
+    {
+        m = (uint64_t)edgefactor << scale;
+        edges = rmat(m);
+        weights = (uint32_t *)malloc(m * sizeof(uint32_t));
+        if (edges == NULL || weights == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+        for (i = 0; i < m; i++)
+            weights[i] = 1 + (uint32_t)(xorshift(&seed) % max_weight);
+        t = now_sec() - t;
+        printf("R-MAT scale %u edgefactor %u: %llu edges in %.2f s\n", scale, edgefactor,
+               (unsigned long long)m, t);
+    }
+
+    t = now_sec();
+    g = csr_build(edges, m, n, CSR_SIMPLE, threads);
+    t = now_sec() - t;
+    if (g == NULL || g->n == 0)
+    {
+        fprintf(stderr, "cannot build the graph\n");
+        return 1;
+    }
+    printf("build csr threads %3d      : %8.2f s, %8.1f MB, %u vertices, %llu arcs, "
+           "%.2f M edges/s\n", threads, t,
+           ((g->n + 1ULL) * sizeof(uint64_t) + g->m * sizeof(uint32_t)) / 1e6, g->n,
+           (unsigned long long)g->m, m / t / 1e6);
+
+    roots = (uint32_t *)malloc(nroots * sizeof(uint32_t));
+    depth = (int32_t *)malloc((size_t)g->n * sizeof(int32_t));
+    buf = (uint32_t *)malloc((size_t)g->n * sizeof(uint32_t));
+    pick_roots(g, roots);
+
+    bench_bfs(g, roots, depth, "direction-optimizing", threads, CSR_BFS_AUTO);
+    bench_bfs(g, roots, depth, "top-down", threads, CSR_BFS_TOP_DOWN);
+    if (threads > 1)
+        bench_bfs(g, roots, depth, "direction-optimizing", 1, CSR_BFS_AUTO);
+    if (with_list)
+        bench_list(edges, m, g, roots, depth);
+
+    t = now_sec();
+    k = csr_dfs(g, roots[0], buf, NULL);
+    t = now_sec() - t;
+    printf("dfs                        : %8.2f ms, %lld vertices\n", t * 1e3, (long long)k);
+
+    t = now_sec();
+    k = csr_cc(g, buf, threads);
+    t = now_sec() - t;
+    printf("cc threads %3d             : %8.2f ms, %lld components\n", threads, t * 1e3,
+           (long long)k);
+    free(depth);
+    free(buf);
+    csr_free(g);
+
+    t = now_sec();
+    g = csr_build_weighted(edges, weights, m, n, CSR_SIMPLE, threads);
+    t = now_sec() - t;
+    free(edges);
+    free(weights);
+    if (g == NULL)
+    {
+        fprintf(stderr, "cannot build the weighted graph\n");
+        return 1;
+    }
+    printf("build weighted threads %3d : %8.2f s, %8.1f MB\n", threads, t,
+           ((g->n + 1ULL) * sizeof(uint64_t) + g->m * 2 * sizeof(uint32_t)) / 1e6);
+    dist = (uint64_t *)malloc((size_t)g->n * sizeof(uint64_t));
+    rank = (double *)malloc((size_t)g->n * sizeof(double));
+    bench_sssp(g, roots, dist, "dijkstra radix heap", 0);
+    bench_sssp(g, roots, dist, "delta-stepping", threads);
+    if (threads > 1)
+        bench_sssp(g, roots, dist, "delta-stepping", 1);
+    bench_pagerank(g, rank, "segmented", 0, threads);
+    bench_pagerank(g, rank, "unsegmented", g->n, threads);
+
+    free(roots);
+    free(dist);
+    free(rank);
+    csr_free(g);
+    return 0;
+}
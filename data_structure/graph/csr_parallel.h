@@ -0,0 +1,49 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ *csr*.c ڲõ߳飺threads߳ͬһtidֹ׶֮ͬ
+ *BFSһһ׶ΣǧͼҲֻһ߳
+ */
+
+#ifndef _CSR_PARALLEL_H_
+#define _CSR_PARALLEL_H_
+
+#include <stdint.h>
+#include <pthread.h>
+
+#define CSR_MAX_THREADS     256
+
+typedef struct csr_team{
+    int32_t threads;            /*ʵʵ߳߳ʧʱҪ*/
+    pthread_barrier_t barrier;
+} csr_team_t;
+
+typedef void (*csr_work_fn)(csr_team_t *team, int32_t tid, void *arg);
+
+/*
+ *ܣthreads߳fnõ߳tid 0ȫŷ
+ *      ߳ʧܾѾõЩfnҪteam->threads
+ */
+void csr_parallel(int32_t threads, csr_work_fn fn, void *arg);
+
+static inline void csr_barrier(csr_team_t *team)
+{
+    if (team->threads > 1)
+        pthread_barrier_wait(&team->barrier);
+}
+
+/*[0, n)ƽָ߳*/
+static inline void csr_split(uint64_t n, int32_t tid, int32_t threads, uint64_t *lo,
+                             uint64_t *hi)
+{
+    *lo = n * tid / threads;
+    *hi = n * (tid + 1) / threads;
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
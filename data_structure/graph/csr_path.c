@@ -0,0 +1,453 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ *CSRͼϵĵԴ·csr.h
+ *
+ *Dijkstraûѣľֻϴεlastdڵ
+ *    (d^lastλ+1)Ͱ0Ͱǵlastġ0Ͱ˾һǿյͰ
+ *    ȡСĵµlastͰԪ·һ飬Ƕ䵽СͰ
+ *    һԪŲ64ΣûбȽϣһͰһڴ档
+ *    decrease-keyС˾ٷһȥdistԲϵӵ
+ *delta-stepping(GAPд)
+ *    [k*delta, (k+1)*delta)ĶڵkͰһδһͰ̶ֿ̬߳
+ *    ͰĶɳڳ(CASȡС)С˾ͷŽ߳ԼͰ
+ *    һ߳СķǿͰ԰Ͱǰء
+ *    ԼĵǰͰв༸ʱȱˣֱӽŴʡܶͬ
+ *    Ͱֻһ(SSSP_WINDOW)Զȶһ(near-far)ڴ
+ *    СŲڣȨܴdeltaСʱͰҲڴű
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "csr.h"
+#include "csr_parallel.h"
+
+#define RADIX_BUCKETS       65
+#define SSSP_CHUNK          64      /*һôǰض*/
+#define SSSP_FUSE           1024    /*ԼĵǰͰСֱӽŴ*/
+#define SSSP_WINDOW         1024    /*뵱ǰͰ̫ԶȲͰ*/
+#define SSSP_NO_BIN         UINT64_MAX
+
+typedef struct radix_item{
+    uint64_t key;
+    uint32_t v;
+} radix_item_t;
+
+typedef struct radix_bucket{
+    radix_item_t *items;
+    uint64_t n;
+    uint64_t cap;
+} radix_bucket_t;
+
+typedef struct radix_heap{
+    radix_bucket_t b[RADIX_BUCKETS];
+    uint64_t last;
+    uint64_t size;
+} radix_heap_t;
+
+static inline int32_t radix_index(uint64_t key, uint64_t last)
+{
+    return key == last ? 0 : 64 - __builtin_clzll(key ^ last);
+}
+
+static int32_t radix_append(radix_bucket_t *b, uint64_t key, uint32_t v)
+{
+    radix_item_t *items;
+    uint64_t cap;
+
+    if (b->n == b->cap)
+    {
+        cap = b->cap ? b->cap * 2 : 16;
+        items = (radix_item_t *)realloc(b->items, cap * sizeof(radix_item_t));
+        if (items == NULL)
+            return -1;
+        b->items = items;
+        b->cap = cap;
+    }
+    b->items[b->n].key = key;
+    b->items[b->n++].v = v;
+    return 0;
+}
+
+/*keyСϴε*/
+static inline int32_t radix_push(radix_heap_t *h, uint64_t key, uint32_t v)
+{
+    if (radix_append(&h->b[radix_index(key, h->last)], key, v) != 0)
+        return -1;
+    h->size++;
+    return 0;
+}
+
+/*ֵ-1ڴ治*/
+static int32_t radix_pop(radix_heap_t *h, uint64_t *key, uint32_t *v)
+{
+    radix_bucket_t *b;
+    uint64_t i, min;
+    int32_t k;
+
+    if (h->b[0].n == 0)
+    {
+        for (k = 1; h->b[k].n == 0; k++)
+            ;
+        b = &h->b[k];
+        for (i = 1, min = b->items[0].key; i < b->n; i++)
+            min = b->items[i].key < min ? b->items[i].key : min;
+        h->last = min;
+        /*min߲ͬλkͰĵͣ䵽kµͰ*/
+        for (i = 0; i < b->n; i++)
+        {
+            if (radix_append(&h->b[radix_index(b->items[i].key, min)], b->items[i].key,
+                             b->items[i].v) != 0)
+                return -1;
+        }
+        b->n = 0;
+    }
+    b = &h->b[0];
+    b->n--;
+    *key = b->items[b->n].key;
+    *v = b->items[b->n].v;
+    h->size--;
+    return 0;
+}
+
+int64_t csr_dijkstra(const csr_graph_t *g, uint32_t src, uint64_t *dist)
+{
+    radix_heap_t h;
+    uint64_t d, nd, e;
+    uint32_t u, v;
+    int64_t reached = 0;
+    int32_t k;
+
+    if (src >= g->n)
+        return -1;
+    memset(&h, 0, sizeof(h));
+    for (v = 0; v < g->n; v++)
+        dist[v] = CSR_INF;
+    dist[src] = 0;
+    if (radix_push(&h, 0, src) != 0)
+        return -1;
+    while (h.size > 0)
+    {
+        if (radix_pop(&h, &d, &u) != 0)
+        {
+            reached = -1;
+            break;
+        }
+        if (d != dist[u])
+            continue;
+        reached++;
+        for (e = g->offsets[u]; e < g->offsets[u + 1]; e++)
+        {
+            v = g->adj[e];
+            nd = d + (g->weight != NULL ? g->weight[e] : 1);
+            if (nd < dist[v])
+            {
+                dist[v] = nd;
+                if (radix_push(&h, nd, v) != 0)
+                {
+                    reached = -1;
+                    goto out;
+                }
+            }
+        }
+    }
+out:
+    for (k = 0; k < RADIX_BUCKETS; k++)
+        free(h.b[k].items);
+    return reached;
+}
+
+
+typedef struct sssp_bin{
+    uint32_t *v;
+    uint64_t n;
+    uint64_t cap;
+} sssp_bin_t;
+
+/*ÿ߳ԼͰ[base, base+SSSP_WINDOW)ͰbinsԶȶfar*/
+typedef struct sssp_local{
+    sssp_bin_t bins[SSSP_WINDOW];
+    sssp_bin_t far;
+    sssp_bin_t spare;       /*ֱӽŴǰͰʱ*/
+    uint64_t base;
+} __attribute__((aligned(64))) sssp_local_t;
+
+typedef struct sssp_arg{
+    const csr_graph_t *g;
+    uint32_t src;
+    uint64_t *dist;
+    uint64_t delta;
+    uint32_t *frontier;
+    uint64_t frontier_cap;
+    uint64_t frontier_n;
+    uint64_t cursor;                        /*ֿ̬*/
+    uint64_t weight_sum[CSR_MAX_THREADS];   /*delta*/
+    uint64_t min_bin[CSR_MAX_THREADS];      /*̴߳СķǿͰ*/
+    uint64_t far_min[CSR_MAX_THREADS];      /*߳farСͰ*/
+    uint64_t far_n[CSR_MAX_THREADS];
+    uint64_t count[CSR_MAX_THREADS];        /*߳ǸͰĶ*/
+    sssp_local_t *local;                    /*ÿ߳һ*/
+    uint64_t reached;
+    int32_t failed;
+} sssp_arg_t;
+
+static int32_t bin_push(sssp_bin_t *b, uint32_t v)
+{
+    uint32_t *p;
+    uint64_t cap;
+
+    if (b->n == b->cap)
+    {
+        cap = b->cap ? b->cap * 2 : 64;
+        p = (uint32_t *)realloc(b->v, cap * sizeof(uint32_t));
+        if (p == NULL)
+            return -1;
+        b->v = p;
+        b->cap = cap;
+    }
+    b->v[b->n++] = v;
+    return 0;
+}
+
+/*ɳuĳߣuѾڵkͰ(øС)*/
+static void sssp_relax(sssp_arg_t *s, sssp_local_t *l, uint32_t u, uint64_t k)
+{
+    const csr_graph_t *g = s->g;
+    uint64_t du, nd, old, e, idx;
+    uint32_t v;
+
+    du = __atomic_load_n(&s->dist[u], __ATOMIC_RELAXED);
+    if (du / s->delta < k)
+        return;
+    for (e = g->offsets[u]; e < g->offsets[u + 1]; e++)
+    {
+        v = g->adj[e];
+        nd = du + (g->weight != NULL ? g->weight[e] : 1);
+        old = __atomic_load_n(&s->dist[v], __ATOMIC_RELAXED);
+        while (nd < old)
+        {
+            if (__atomic_compare_exchange_n(&s->dist[v], &old, nd, 1, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED))
+            {
+                idx = nd / s->delta - l->base;
+                if (bin_push(idx < SSSP_WINDOW ? &l->bins[idx] : &l->far, v) != 0)
+                    __atomic_store_n(&s->failed, 1, __ATOMIC_RELAXED);
+                break;
+            }
+        }
+    }
+}
+
+/*ˣfarѾӵ(Ķ)ʣСͰ*/
+static uint64_t far_prune(sssp_arg_t *s, sssp_local_t *l)
+{
+    uint64_t i, j, idx, min = SSSP_NO_BIN;
+
+    for (i = 0, j = 0; i < l->far.n; i++)
+    {
+        idx = s->dist[l->far.v[i]] / s->delta;
+        if (idx < l->base + SSSP_WINDOW)
+            continue;
+        min = idx < min ? idx : min;
+        l->far.v[j++] = l->far.v[i];
+    }
+    l->far.n = j;
+    return min;
+}
+
+/*ŲbasefarڵķŽͰ*/
+static void far_split(sssp_arg_t *s, sssp_local_t *l, uint64_t base)
+{
+    uint64_t i, j, idx;
+
+    l->base = base;
+    for (i = 0, j = 0; i < l->far.n; i++)
+    {
+        idx = s->dist[l->far.v[i]] / s->delta - base;
+        if (idx >= SSSP_WINDOW)
+            l->far.v[j++] = l->far.v[i];
+        else if (bin_push(&l->bins[idx], l->far.v[i]) != 0)
+            __atomic_store_n(&s->failed, 1, __ATOMIC_RELAXED);
+    }
+    l->far.n = j;
+}
+
+static void sssp_work(csr_team_t *team, int32_t tid, void *data)
+{
+    sssp_arg_t *s = (sssp_arg_t *)data;
+    const csr_graph_t *g = s->g;
+    sssp_local_t *l = &s->local[tid];
+    sssp_bin_t t, *b;
+    uint64_t lo, hi, i, k = 0, next, total, base, cap;
+    uint32_t *frontier;
+    double delta;
+    int32_t j;
+
+    /*deltaȨʱȡ Ȩ/ƽ ȽϺãƽȨȨ*/
+    if (s->delta == 0)
+    {
+        csr_split(g->m, tid, team->threads, &lo, &hi);
+        for (i = lo, total = 0; i < hi; i++)
+            total += g->weight != NULL ? g->weight[i] : 1;
+        s->weight_sum[tid] = total;
+        csr_barrier(team);
+        if (tid == 0)
+        {
+            for (j = 0, total = 0; j < team->threads; j++)
+                total += s->weight_sum[j];
+            delta = g->m > 0 ? 2.0 * total / g->m / ((double)g->m / g->n) : 1;
+            s->delta = delta >= 1 ? (uint64_t)delta : 1;
+        }
+    }
+    if (tid == 0)
+    {
+        s->frontier[0] = s->src;
+        s->frontier_n = 1;
+        s->cursor = 0;
+    }
+    csr_barrier(team);
+
+    for (;;)
+    {
+        for (;;)
+        {
+            lo = __atomic_fetch_add(&s->cursor, SSSP_CHUNK, __ATOMIC_RELAXED);
+            if (lo >= s->frontier_n)
+                break;
+            hi = lo + SSSP_CHUNK < s->frontier_n ? lo + SSSP_CHUNK : s->frontier_n;
+            for (i = lo; i < hi; i++)
+                sssp_relax(s, l, s->frontier[i], k);
+        }
+        b = &l->bins[k - l->base];
+        while (b->n > 0 && b->n < SSSP_FUSE && !__atomic_load_n(&s->failed, __ATOMIC_RELAXED))
+        {
+            t = *b;
+            *b = l->spare;
+            l->spare = t;
+            for (i = 0; i < t.n; i++)
+                sssp_relax(s, l, t.v[i], k);
+            l->spare.n = 0;
+        }
+        for (next = k; next < l->base + SSSP_WINDOW && l->bins[next - l->base].n == 0; next++)
+            ;
+        s->min_bin[tid] = next < l->base + SSSP_WINDOW ? next : SSSP_NO_BIN;
+        s->far_n[tid] = l->far.n;
+        csr_barrier(team);
+
+        /*ÿ߳Ķһ*/
+        for (j = 0, next = SSSP_NO_BIN, total = 0; j < team->threads; j++)
+        {
+            next = s->min_bin[j] < next ? s->min_bin[j] : next;
+            total += s->far_n[j];
+        }
+        if (s->failed || (next == SSSP_NO_BIN && total == 0))
+            break;
+        if (next == SSSP_NO_BIN)
+        {
+            s->far_min[tid] = far_prune(s, l);
+            csr_barrier(team);
+            for (j = 0, next = SSSP_NO_BIN; j < team->threads; j++)
+                next = s->far_min[j] < next ? s->far_min[j] : next;
+            if (next == SSSP_NO_BIN)
+                break;
+            far_split(s, l, next);
+        }
+        s->count[tid] = l->bins[next - l->base].n;
+        csr_barrier(team);
+        for (j = 0, total = 0, base = 0; j < team->threads; j++)
+        {
+            base += j < tid ? s->count[j] : 0;
+            total += s->count[j];
+        }
+        if (total > s->frontier_cap)
+        {
+            if (tid == 0)
+            {
+                for (cap = s->frontier_cap * 2; cap < total; cap *= 2)
+                    ;
+                frontier = (uint32_t *)realloc(s->frontier, cap * sizeof(uint32_t));
+                if (frontier != NULL)
+                {
+                    s->frontier = frontier;
+                    s->frontier_cap = cap;
+                }
+                else
+                    s->failed = 1;
+            }
+            csr_barrier(team);
+            if (s->failed)
+                break;
+        }
+        b = &l->bins[next - l->base];
+        if (b->n > 0)
+        {
+            memcpy(s->frontier + base, b->v, b->n * sizeof(uint32_t));
+            b->n = 0;
+        }
+        if (tid == 0)
+        {
+            s->frontier_n = total;
+            s->cursor = 0;
+        }
+        k = next;
+        csr_barrier(team);
+    }
+
+    csr_split(g->n, tid, team->threads, &lo, &hi);
+    for (i = lo, total = 0; i < hi; i++)
+        total += s->dist[i] != CSR_INF;
+    __atomic_fetch_add(&s->reached, total, __ATOMIC_RELAXED);
+}
+
+int64_t csr_sssp(const csr_graph_t *g, uint32_t src, uint64_t *dist, uint64_t delta,
+                 int32_t threads)
+{
+    sssp_arg_t *s;
+    sssp_local_t *l;
+    uint32_t v;
+    int64_t ret = -1;
+    int32_t j, k;
+
+    if (src >= g->n)
+        return -1;
+    s = (sssp_arg_t *)calloc(1, sizeof(sssp_arg_t));
+    if (s == NULL)
+        return -1;
+    s->g = g;
+    s->src = src;
+    s->dist = dist;
+    s->delta = delta;
+    s->frontier_cap = g->n;
+    s->frontier = (uint32_t *)malloc(s->frontier_cap * sizeof(uint32_t));
+    threads = threads < 1 ? 1 : threads > CSR_MAX_THREADS ? CSR_MAX_THREADS : threads;
+    s->local = (sssp_local_t *)calloc(threads, sizeof(sssp_local_t));
+    if (s->frontier != NULL && s->local != NULL)
+    {
+        for (v = 0; v < g->n; v++)
+            dist[v] = CSR_INF;
+        dist[src] = 0;
+        csr_parallel(threads, sssp_work, s);
+        if (!s->failed)
+            ret = (int64_t)s->reached;
+    }
+    for (j = 0; s->local != NULL && j < threads; j++)
+    {
+        l = &s->local[j];
+        for (k = 0; k < SSSP_WINDOW; k++)
+            free(l->bins[k].v);
+        free(l->far.v);
+        free(l->spare.v);
+    }
+    free(s->local);
+    free(s->frontier);
+    free(s);
+    return ret;
+}
+
+#ifdef __cplusplus
+}
+#endif
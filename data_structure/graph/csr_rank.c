@@ -0,0 +1,286 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ *CSRͼϵPageRankcsr.h
+ *
+ *rank'[v] = (1-d)/n + d*(Ҷrank֮)/n + d*sum(contrib[u], u->v)
+ *    contrib[u] = rank[u]/(u)ÿֻԼ߳дԭӲ
+ *ֶ(Zhang˵CSR segmenting)ֱʱcontrib[u]nһȫ
+ *    ȱʧԴ㰴blockһпÿεһCSRֻһ
+ *    Ŀ궥㣻һ̰߳ε˳ԼЩĿ궥㣬ͬһʱֻһεcontrib
+ *    źģһĿ궥ĳһin_adjһأֱӿȥ
+ *    ֻһʱin_offsets/in_adj
+ *̰߳+ƽĿ궥㣬ÿ̴߳Ŀʼڽεʱͼ
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "csr.h"
+#include "csr_parallel.h"
+
+#define PR_BLOCK    (1U << 17)  /*һεԴcontrib1MB*/
+
+typedef struct pr_segment{
+    uint32_t *dst;          /*һߵĿ궥㣬С*/
+    uint64_t *off;          /*ndst+1*/
+    uint32_t *src;
+    uint64_t ndst;
+} pr_segment_t;
+
+typedef struct pr_arg{
+    const csr_graph_t *g;
+    double damping;
+    double tol;
+    int32_t max_iters;
+    uint32_t block;
+    double *rank;
+    double *contrib;
+    double *sum;
+    uint32_t nseg;
+    pr_segment_t *seg;
+    uint32_t vbegin[CSR_MAX_THREADS + 1];   /*̵߳Ŀ궥*/
+    uint64_t *dbase;        /*threads*nsegԺ߳tidڵkεdbase[tid*nseg+k]Ϊֹ*/
+    uint64_t *ebase;        /*ʱ߳ڵkεıߴĿʼд*/
+    double dangling[CSR_MAX_THREADS];
+    double err[CSR_MAX_THREADS];
+    int32_t iters;
+    int32_t failed;
+} pr_arg_t;
+
+/*һin_offsets[v]+v>=targetv*/
+static uint32_t pr_find(const csr_graph_t *g, uint64_t target)
+{
+    uint32_t lo = 0, hi = g->n, mid;
+
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (g->in_offsets[mid] + mid < target)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/*ԼЩĿ궥ÿһмߣдλãٿ*/
+static void pr_segment(csr_team_t *team, int32_t tid, pr_arg_t *p)
+{
+    const csr_graph_t *g = p->g;
+    uint64_t *nd = p->dbase + (uint64_t)tid * p->nseg;
+    uint64_t *ne = p->ebase + (uint64_t)tid * p->nseg;
+    uint64_t e, end, sum, d, k, t, threads = team->threads;
+    uint32_t v, seg;
+    pr_segment_t *s;
+
+    memset(nd, 0, p->nseg * sizeof(uint64_t));
+    memset(ne, 0, p->nseg * sizeof(uint64_t));
+    for (v = p->vbegin[tid]; v < p->vbegin[tid + 1]; v++)
+    {
+        for (e = g->in_offsets[v]; e < g->in_offsets[v + 1]; e = end)
+        {
+            seg = g->in_adj[e] / p->block;
+            for (end = e + 1; end < g->in_offsets[v + 1] && g->in_adj[end] / p->block == seg;
+                 end++)
+                ;
+            nd[seg]++;
+            ne[seg] += end - e;
+        }
+    }
+    csr_barrier(team);
+
+    /*ÿΰ߳ǰ׺ͣtidб߳tidĿʼд*/
+    csr_split(p->nseg, tid, team->threads, &k, &end);
+    for (; k < end; k++)
+    {
+        for (t = 0, sum = 0, d = 0; t < threads; t++)
+        {
+            sum += p->dbase[t * p->nseg + k];
+            p->dbase[t * p->nseg + k] = sum - p->dbase[t * p->nseg + k];
+            d += p->ebase[t * p->nseg + k];
+            p->ebase[t * p->nseg + k] = d - p->ebase[t * p->nseg + k];
+        }
+        s = &p->seg[k];
+        s->ndst = sum;
+        s->dst = (uint32_t *)malloc((sum > 0 ? sum : 1) * sizeof(uint32_t));
+        s->off = (uint64_t *)malloc((sum + 1) * sizeof(uint64_t));
+        s->src = (uint32_t *)malloc((d > 0 ? d : 1) * sizeof(uint32_t));
+        if (s->dst == NULL || s->off == NULL || s->src == NULL)
+            __atomic_store_n(&p->failed, 1, __ATOMIC_RELAXED);
+        else
+            s->off[sum] = d;
+    }
+    csr_barrier(team);
+    if (p->failed)
+        return;
+
+    /*дŲдndԼĽβҲһ̵߳Ŀʼ*/
+    for (v = p->vbegin[tid]; v < p->vbegin[tid + 1]; v++)
+    {
+        for (e = g->in_offsets[v]; e < g->in_offsets[v + 1]; e = end)
+        {
+            seg = g->in_adj[e] / p->block;
+            for (end = e + 1; end < g->in_offsets[v + 1] && g->in_adj[end] / p->block == seg;
+                 end++)
+                ;
+            s = &p->seg[seg];
+            s->dst[nd[seg]] = v;
+            s->off[nd[seg]++] = ne[seg];
+            memcpy(s->src + ne[seg], g->in_adj + e, (end - e) * sizeof(uint32_t));
+            ne[seg] += end - e;
+        }
+    }
+    csr_barrier(team);
+}
+
+static void pr_work(csr_team_t *team, int32_t tid, void *data)
+{
+    pr_arg_t *p = (pr_arg_t *)data;
+    const csr_graph_t *g = p->g;
+    uint64_t j, e, end, deg, total = g->in_offsets[g->n] + g->n;
+    uint32_t v, lo, hi, k;
+    double s, dangling, base, err, r, d = p->damping;
+    const pr_segment_t *seg;
+    int32_t t, iter;
+
+    if (tid == 0)
+    {
+        for (t = 0; t <= team->threads; t++)
+            p->vbegin[t] = pr_find(g, total * t / team->threads);
+        p->vbegin[team->threads] = g->n;
+        if (p->nseg > 1)
+        {
+            p->dbase = (uint64_t *)malloc((uint64_t)team->threads * p->nseg * sizeof(uint64_t));
+            p->ebase = (uint64_t *)malloc((uint64_t)team->threads * p->nseg * sizeof(uint64_t));
+            p->seg = (pr_segment_t *)calloc(p->nseg, sizeof(pr_segment_t));
+            if (p->dbase == NULL || p->ebase == NULL || p->seg == NULL)
+                p->failed = 1;
+        }
+    }
+    csr_barrier(team);
+    if (p->failed)
+        return;
+    if (p->nseg > 1)
+    {
+        pr_segment(team, tid, p);
+        if (p->failed)
+            return;
+    }
+    lo = p->vbegin[tid];
+    hi = p->vbegin[tid + 1];
+    for (v = lo; v < hi; v++)
+        p->rank[v] = 1.0 / g->n;
+
+    for (iter = 0; iter < p->max_iters; iter++)
+    {
+        for (v = lo, dangling = 0; v < hi; v++)
+        {
+            deg = csr_degree(g, v);
+            if (deg == 0)
+                dangling += p->rank[v];
+            else
+                p->contrib[v] = p->rank[v] / deg;
+            p->sum[v] = 0;
+        }
+        p->dangling[tid] = dangling;
+        csr_barrier(team);
+
+        for (t = 0, dangling = 0; t < team->threads; t++)
+            dangling += p->dangling[t];
+        base = (1 - d) / g->n + d * dangling / g->n;
+        if (p->nseg <= 1)
+        {
+            for (v = lo; v < hi; v++)
+            {
+                for (e = g->in_offsets[v], s = 0; e < g->in_offsets[v + 1]; e++)
+                    s += p->contrib[g->in_adj[e]];
+                p->sum[v] = s;
+            }
+        }
+        else
+        {
+            for (k = 0; k < p->nseg; k++)
+            {
+                seg = &p->seg[k];
+                end = p->dbase[tid * p->nseg + k];
+                for (j = tid > 0 ? p->dbase[(tid - 1) * p->nseg + k] : 0; j < end; j++)
+                {
+                    for (e = seg->off[j], s = 0; e < seg->off[j + 1]; e++)
+                        s += p->contrib[seg->src[e]];
+                    p->sum[seg->dst[j]] += s;
+                }
+            }
+        }
+        for (v = lo, err = 0; v < hi; v++)
+        {
+            r = base + d * p->sum[v];
+            err += fabs(r - p->rank[v]);
+            p->rank[v] = r;
+        }
+        p->err[tid] = err;
+        csr_barrier(team);
+        for (t = 0, err = 0; t < team->threads; t++)
+            err += p->err[t];
+        if (err < p->tol)
+        {
+            iter++;
+            break;
+        }
+    }
+    if (tid == 0)
+        p->iters = iter;
+}
+
+int32_t csr_pagerank(const csr_graph_t *g, double damping, double tol, int32_t max_iters,
+                     uint32_t block, double *rank, int32_t threads)
+{
+    pr_arg_t *p;
+    int32_t ret = -1;
+    uint32_t k;
+
+    if (g->n == 0)
+        return 0;
+    p = (pr_arg_t *)calloc(1, sizeof(pr_arg_t));
+    if (p == NULL)
+        return -1;
+    p->g = g;
+    p->damping = damping;
+    p->tol = tol;
+    p->max_iters = max_iters;
+    p->block = block > 0 ? block : PR_BLOCK;
+    p->nseg = (uint32_t)((g->n + (uint64_t)p->block - 1) / p->block);
+    p->rank = rank;
+    p->contrib = (double *)calloc(g->n, sizeof(double));
+    p->sum = (double *)malloc(g->n * sizeof(double));
+    if (p->contrib != NULL && p->sum != NULL)
+    {
+        csr_parallel(threads, pr_work, p);
+        if (!p->failed)
+            ret = p->iters;
+    }
+    if (p->seg != NULL)
+    {
+        for (k = 0; k < p->nseg; k++)
+        {
+            free(p->seg[k].dst);
+            free(p->seg[k].off);
+            free(p->seg[k].src);
+        }
+    }
+    free(p->seg);
+    free(p->dbase);
+    free(p->ebase);
+    free(p->contrib);
+    free(p->sum);
+    free(p);
+    return ret;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,767 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+#include "csr.h"
+#include "../test_util.h"
+
+/*
+ *򵥵дգ߱õÿھӣBFSݹDFSBFSͨ
+ *Bellman-Ford·һPageRank
+ *ͼͼ(R-MAT)Traversal.cСͼȥȥء14̣߳
+ *жı߱ͶļĴȡ
+ */
+
+/*գź(u, v)ԣcsrһĲ*/
+typedef struct ref_graph{
+    uint32_t n;
+    uint64_t m;
+    uint64_t *off;
+    uint32_t *adj;
+    uint64_t *in_off;       /*ͨãͼoffһ*/
+    uint32_t *in_adj;
+} ref_graph_t;
+
+static int cmp_edge(const void *a, const void *b)
+{
+    const csr_edge_t *x = (const csr_edge_t *)a, *y = (const csr_edge_t *)b;
+
+    if (x->src != y->src)
+        return x->src < y->src ? -1 : 1;
+    return x->dst < y->dst ? -1 : x->dst > y->dst;
+}
+
+static void ref_side(uint32_t n, csr_edge_t *pairs, uint64_t k, int32_t simple,
+                     uint64_t **off, uint32_t **adj, uint64_t *m)
+{
+    uint64_t i, j = 0;
+    uint32_t v;
+
+    qsort(pairs, k, sizeof(csr_edge_t), cmp_edge);
+    *off = (uint64_t *)calloc(n + 1ULL, sizeof(uint64_t));
+    *adj = (uint32_t *)malloc((k + 1) * sizeof(uint32_t));
+    for (i = 0; i < k; i++)
+    {
+        if (simple && (pairs[i].src == pairs[i].dst ||
+                       (i > 0 && cmp_edge(&pairs[i], &pairs[i - 1]) == 0)))
+            continue;
+        (*adj)[j++] = pairs[i].dst;
+        (*off)[pairs[i].src + 1]++;
+    }
+    for (v = 0; v < n; v++)
+        (*off)[v + 1] += (*off)[v];
+    *m = j;
+}
+
+static void ref_build(ref_graph_t *r, const csr_edge_t *edges, uint64_t m, uint32_t n,
+                      int32_t flags)
+{
+    csr_edge_t *pairs = (csr_edge_t *)malloc((2 * m + 1) * sizeof(csr_edge_t));
+    uint64_t i, k = 0, in_m;
+
+    for (i = 0; i < m; i++)
+    {
+        pairs[k++] = edges[i];
+        if (!(flags & CSR_DIRECTED))
+        {
+            pairs[k].src = edges[i].dst;
+            pairs[k++].dst = edges[i].src;
+        }
+    }
+    r->n = n;
+    ref_side(n, pairs, k, flags & CSR_SIMPLE, &r->off, &r->adj, &r->m);
+    if (flags & CSR_DIRECTED)
+    {
+        for (i = 0; i < m; i++)
+        {
+            pairs[i].src = edges[i].dst;
+            pairs[i].dst = edges[i].src;
+        }
+        ref_side(n, pairs, m, flags & CSR_SIMPLE, &r->in_off, &r->in_adj, &in_m);
+    }
+    else
+    {
+        r->in_off = r->off;
+        r->in_adj = r->adj;
+    }
+    free(pairs);
+}
+
+static void ref_free(ref_graph_t *r)
+{
+    if (r->in_off != r->off)
+    {
+        free(r->in_off);
+        free(r->in_adj);
+    }
+    free(r->off);
+    free(r->adj);
+}
+
+static void ref_bfs(const ref_graph_t *r, uint32_t src, int32_t *depth)
+{
+    uint32_t *queue = (uint32_t *)malloc(r->n * sizeof(uint32_t)), head = 0, tail = 0, v, w;
+    uint64_t e;
+
+    for (v = 0; v < r->n; v++)
+        depth[v] = -1;
+    depth[src] = 0;
+    queue[tail++] = src;
+    while (head < tail)
+    {
+        v = queue[head++];
+        for (e = r->off[v]; e < r->off[v + 1]; e++)
+        {
+            w = r->adj[e];
+            if (depth[w] < 0)
+            {
+                depth[w] = depth[v] + 1;
+                queue[tail++] = w;
+            }
+        }
+    }
+    free(queue);
+}
+
+static void ref_dfs(const ref_graph_t *r, uint32_t v, uint8_t *visited, uint32_t *order,
+                    uint32_t *count)
+{
+    uint64_t e;
+
+    visited[v] = 1;
+    order[(*count)++] = v;
+    for (e = r->off[v]; e < r->off[v + 1]; e++)
+    {
+        if (!visited[r->adj[e]])
+            ref_dfs(r, r->adj[e], visited, order, count);
+    }
+}
+
+/*߶ߣСûĶ㿪ʼľǷСı*/
+static uint32_t ref_cc(const ref_graph_t *r, uint32_t *comp)
+{
+    uint32_t *queue = (uint32_t *)malloc(r->n * sizeof(uint32_t)), head, tail, v, w, s, k = 0;
+    uint64_t e;
+
+    for (v = 0; v < r->n; v++)
+        comp[v] = CSR_NONE;
+    for (s = 0; s < r->n; s++)
+    {
+        if (comp[s] != CSR_NONE)
+            continue;
+        k++;
+        comp[s] = s;
+        head = tail = 0;
+        queue[tail++] = s;
+        while (head < tail)
+        {
+            v = queue[head++];
+            for (e = r->off[v]; e < r->off[v + 1]; e++)
+            {
+                w = r->adj[e];
+                if (comp[w] == CSR_NONE)
+                {
+                    comp[w] = s;
+                    queue[tail++] = w;
+                }
+            }
+            for (e = r->in_off[v]; e < r->in_off[v + 1]; e++)
+            {
+                w = r->in_adj[e];
+                if (comp[w] == CSR_NONE)
+                {
+                    comp[w] = s;
+                    queue[tail++] = w;
+                }
+            }
+        }
+    }
+    free(queue);
+    return k;
+}
+
+static int32_t has_edge(const csr_graph_t *g, uint32_t u, uint32_t v)
+{
+    uint64_t e;
+
+    for (e = g->offsets[u]; e < g->offsets[u + 1]; e++)
+    {
+        if (g->adj[e] == v)
+            return 1;
+    }
+    return 0;
+}
+
+static void compare(const char *what, const csr_edge_t *edges, uint64_t m, uint32_t n,
+                    int32_t flags, int32_t threads)
+{
+    csr_graph_t *g = csr_build(edges, m, n, flags, threads);
+    ref_graph_t r;
+    int32_t *depth, *want;
+    uint32_t *order, *want_order, *parent, *comp, *want_comp, count, src, v, k;
+    uint8_t *visited;
+    int32_t mode, i;
+    int64_t got;
+
+    CHECK(g != NULL, "%s: build failed", what);
+    ref_build(&r, edges, m, g->n, flags);
+    depth = (int32_t *)malloc((g->n + 1) * sizeof(int32_t));
+    want = (int32_t *)malloc((g->n + 1) * sizeof(int32_t));
+    order = (uint32_t *)malloc((g->n + 1) * sizeof(uint32_t));
+    want_order = (uint32_t *)malloc((g->n + 1) * sizeof(uint32_t));
+    parent = (uint32_t *)malloc((g->n + 1) * sizeof(uint32_t));
+    comp = (uint32_t *)malloc((g->n + 1) * sizeof(uint32_t));
+    want_comp = (uint32_t *)malloc((g->n + 1) * sizeof(uint32_t));
+    visited = (uint8_t *)malloc(g->n + 1);
+
+    if (g->m != r.m || memcmp(g->offsets, r.off, (g->n + 1ULL) * sizeof(uint64_t)) != 0 ||
+        memcmp(g->adj, r.adj, r.m * sizeof(uint32_t)) != 0 ||
+        memcmp(g->in_offsets, r.in_off, (g->n + 1ULL) * sizeof(uint64_t)) != 0 ||
+        memcmp(g->in_adj, r.in_adj, r.in_off[r.n] * sizeof(uint32_t)) != 0)
+    {
+        printf("%s: csr differs from reference (n %u, m %llu)\n", what, g->n,
+               (unsigned long long)g->m);
+        failed++;
+        goto out;
+    }
+
+    for (i = 0; i < 3 && g->n > 0; i++)
+    {
+        src = (uint32_t)(xorshift64() % g->n);
+        ref_bfs(&r, src, want);
+        for (mode = CSR_BFS_AUTO; mode <= CSR_BFS_BOTTOM_UP; mode++)
+        {
+            got = csr_bfs(g, src, depth, threads, mode);
+            for (v = 0, count = 0; v < g->n; v++)
+                count += want[v] >= 0;
+            if (got != count || memcmp(depth, want, g->n * sizeof(int32_t)) != 0)
+            {
+                printf("%s: bfs from %u mode %d differs\n", what, src, mode);
+                failed++;
+                goto out;
+            }
+        }
+
+        memset(visited, 0, g->n);
+        count = 0;
+        ref_dfs(&r, src, visited, want_order, &count);
+        got = csr_dfs(g, src, order, parent);
+        if (got != count || memcmp(order, want_order, count * sizeof(uint32_t)) != 0 ||
+            parent[src] != src)
+        {
+            printf("%s: dfs from %u differs\n", what, src);
+            failed++;
+            goto out;
+        }
+        /*ҪԼǰʣ*/
+        for (k = 1; k < count; k++)
+        {
+            v = order[k];
+            if (parent[v] >= g->n || !visited[parent[v]] || !has_edge(g, parent[v], v))
+            {
+                printf("%s: dfs parent of %u is wrong\n", what, v);
+                failed++;
+                goto out;
+            }
+        }
+    }
+
+    k = ref_cc(&r, want_comp);
+    got = csr_cc(g, comp, threads);
+    if (got != k || memcmp(comp, want_comp, g->n * sizeof(uint32_t)) != 0)
+    {
+        printf("%s: cc got %lld components want %u\n", what, (long long)got, k);
+        failed++;
+    }
+
+out:
+    free(depth);
+    free(want);
+    free(order);
+    free(want_order);
+    free(parent);
+    free(comp);
+    free(want_comp);
+    free(visited);
+    ref_free(&r);
+    csr_free(g);
+}
+
+/*R-MATɷֲģBFSм伸ǰغܴ󣬻ỻbottom-up*/
+static csr_edge_t* rmat(uint32_t scale, uint64_t m)
+{
+    csr_edge_t *edges = (csr_edge_t *)malloc(m * sizeof(csr_edge_t));
+    uint64_t i, r;
+    uint32_t b, u, v;
+
+    for (i = 0; i < m; i++)
+    {
+        u = v = 0;
+        for (b = 0; b < scale; b++)
+        {
+            r = xorshift64() % 100;
+            u = u * 2 + (r >= 76);
+            v = v * 2 + ((r >= 57 && r < 76) || r >= 95);
+        }
+        edges[i].src = u;
+        edges[i].dst = v;
+    }
+    return edges;
+}
+
+static void test_small(void)
+{
+    /*Traversal.cͼ*/
+    csr_edge_t edges[] = {{0, 1}, {0, 4}, {1, 2}, {1, 3}, {1, 4}, {2, 3}, {3, 4}};
+    uint32_t order[6], want[6] = {0, 1, 2, 3, 4, CSR_NONE}, comp[6];
+    int32_t depth[6], want_depth[6] = {0, 1, 2, 2, 1, -1};
+    csr_graph_t *g = csr_build(edges, 7, 6, 0, 2);
+
+    CHECK(g != NULL && g->n == 6 && g->m == 14 && csr_degree(g, 1) == 4 &&
+          csr_degree(g, 5) == 0, "small: build");
+    CHECK(csr_dfs(g, 0, order, NULL) == 5 && memcmp(order, want, 5 * sizeof(uint32_t)) == 0,
+          "small: dfs order");
+    CHECK(csr_bfs(g, 0, depth, 2, CSR_BFS_AUTO) == 5 &&
+          memcmp(depth, want_depth, sizeof(depth)) == 0, "small: bfs");
+    CHECK(csr_cc(g, comp, 2) == 2 && comp[4] == 0 && comp[5] == 5, "small: cc");
+    CHECK(csr_bfs(g, 6, depth, 1, CSR_BFS_AUTO) == -1, "small: bfs from a bad vertex");
+    csr_free(g);
+    CHECK(csr_build(edges, 7, 4, 0, 1) == NULL, "small: vertex id not less than n accepted");
+    g = csr_build(edges, 0, 0, 0, 3);
+    CHECK(g != NULL && g->n == 0 && g->m == 0, "small: empty graph");
+    CHECK(csr_cc(g, comp, 3) == 0, "small: empty cc");
+    csr_free(g);
+}
+
+static void test_random(void)
+{
+    static const int32_t flag_set[] = {0, CSR_SIMPLE, CSR_DIRECTED, CSR_DIRECTED | CSR_SIMPLE};
+    csr_edge_t *edges;
+    uint64_t m, i;
+    uint32_t n, round;
+    char what[64];
+
+    for (round = 0; round < 120; round++)
+    {
+        n = 1 + (uint32_t)(xorshift64() % (round < 60 ? 50 : 3000));
+        m = xorshift64() % (n * (round % 3 == 0 ? 1ULL : 6ULL) + 1);
+        edges = (csr_edge_t *)malloc((m + 1) * sizeof(csr_edge_t));
+        for (i = 0; i < m; i++)
+        {
+            edges[i].src = (uint32_t)(xorshift64() % n);
+            /*һԻر*/
+            edges[i].dst = i > 0 && xorshift64() % 10 == 0 ? edges[i - 1].dst :
+                           (uint32_t)(xorshift64() % n);
+        }
+        snprintf(what, sizeof(what), "random %u", round);
+        compare(what, edges, m, round % 2 ? n : 0, flag_set[round % 4], 1 + round % 4);
+        free(edges);
+    }
+}
+
+static void test_rmat(void)
+{
+    csr_edge_t *edges = rmat(14, 16 << 14);
+
+    compare("rmat undirected", edges, 16 << 14, 0, CSR_SIMPLE, 4);
+    compare("rmat directed", edges, 16 << 14, 1 << 14, CSR_DIRECTED, 3);
+    free(edges);
+}
+
+static void test_load(void)
+{
+    const char *text = "# comment\n% another\n\n1 2\r\n  3\t4 extra column\n5 6\n\n7 0";
+    csr_edge_t want[] = {{1, 2}, {3, 4}, {5, 6}, {7, 0}}, *edges, *big;
+    char path[] = "/tmp/csr_test_XXXXXX";
+    csr_graph_t *g, *h;
+    uint64_t m, i;
+    uint32_t n;
+    FILE *fp;
+    int fd;
+
+    fd = mkstemp(path);
+    CHECK(fd >= 0, "load: mkstemp");
+    close(fd);
+    fp = fopen(path, "w");
+    fputs(text, fp);
+    fclose(fp);
+    edges = csr_load_edges(path, &m, &n, 4);
+    CHECK(edges != NULL && m == 4 && n == 8 && memcmp(edges, want, sizeof(want)) == 0,
+          "load: small text file");
+    free(edges);
+
+    fp = fopen(path, "w");
+    fputs("1 2\n3 x\n", fp);
+    fclose(fp);
+    CHECK(csr_load_edges(path, &m, &n, 1) == NULL, "load: accepted a bad line");
+    fp = fopen(path, "w");
+    fclose(fp);
+    edges = csr_load_edges(path, &m, &n, 4);
+    CHECK(edges != NULL && m == 0 && n == 0, "load: empty file");
+    free(edges);
+
+    /*һļ̷ֶ߳*/
+    big = rmat(16, 300000);
+    fp = fopen(path, "w");
+    for (i = 0; i < 300000; i++)
+    {
+        if (i % 1000 == 0)
+            fprintf(fp, "# %llu\n", (unsigned long long)i);
+        fprintf(fp, "%u %u\n", big[i].src, big[i].dst);
+    }
+    fclose(fp);
+    edges = csr_load_edges(path, &m, &n, 4);
+    CHECK(edges != NULL && m == 300000 && memcmp(edges, big, m * sizeof(csr_edge_t)) == 0,
+          "load: big text file");
+
+    /*ɶٶ*/
+    g = csr_build(edges, m, n, CSR_DIRECTED, 4);
+    free(edges);
+    CHECK(g != NULL && csr_save(g, path) == 0, "save failed");
+    h = csr_load(path);
+    CHECK(h != NULL && h->n == g->n && h->m == g->m && h->directed &&
+          memcmp(h->offsets, g->offsets, (g->n + 1ULL) * sizeof(uint64_t)) == 0 &&
+          memcmp(h->adj, g->adj, g->m * sizeof(uint32_t)) == 0 &&
+          memcmp(h->in_adj, g->in_adj, g->m * sizeof(uint32_t)) == 0, "load: round trip");
+    csr_free(h);
+    CHECK(truncate(path, 100) == 0 && csr_load(path) == NULL, "load: truncated file accepted");
+    csr_free(g);
+    free(big);
+    unlink(path);
+}
+
+typedef struct wedge{
+    uint32_t src;
+    uint32_t dst;
+    uint32_t w;
+} wedge_t;
+
+static int cmp_wedge(const void *a, const void *b)
+{
+    const wedge_t *x = (const wedge_t *)a, *y = (const wedge_t *)b;
+
+    if (x->src != y->src)
+        return x->src < y->src ? -1 : 1;
+    if (x->dst != y->dst)
+        return x->dst < y->dst ? -1 : 1;
+    return x->w < y->w ? -1 : x->w > y->w;
+}
+
+/*Ȩĳߣ(src, dst, w)ȥʱ*/
+static void check_weighted(const char *what, const csr_graph_t *g, const csr_edge_t *edges,
+                           const uint32_t *weights, uint64_t m, int32_t flags)
+{
+    wedge_t *t = (wedge_t *)malloc((2 * m + 1) * sizeof(wedge_t));
+    uint64_t i, k = 0, j = 0;
+    uint32_t v;
+
+    for (i = 0; i < m; i++)
+    {
+        t[k].src = edges[i].src;
+        t[k].dst = edges[i].dst;
+        t[k++].w = weights[i];
+        if (!(flags & CSR_DIRECTED))
+        {
+            t[k].src = edges[i].dst;
+            t[k].dst = edges[i].src;
+            t[k++].w = weights[i];
+        }
+    }
+    qsort(t, k, sizeof(wedge_t), cmp_wedge);
+    for (i = 0; i < k; i++)
+    {
+        if ((flags & CSR_SIMPLE) && (t[i].src == t[i].dst ||
+            (i > 0 && t[i].src == t[i - 1].src && t[i].dst == t[i - 1].dst)))
+            continue;
+        t[j++] = t[i];
+    }
+    if (g->weight == NULL || g->m != j)
+    {
+        printf("%s: weighted build has %llu arcs want %llu\n", what,
+               (unsigned long long)g->m, (unsigned long long)j);
+        failed++;
+        free(t);
+        return;
+    }
+    for (v = 0, i = 0; v < g->n; v++)
+    {
+        for (; i < g->offsets[v + 1]; i++)
+        {
+            if (t[i].src != v || t[i].dst != g->adj[i] || t[i].w != g->weight[i])
+            {
+                printf("%s: weighted arc %llu differs\n", what, (unsigned long long)i);
+                failed++;
+                free(t);
+                return;
+            }
+        }
+    }
+    free(t);
+}
+
+/*Bellman-Fordֱԭʼ߱Իر߲Ӱ*/
+static uint64_t ref_sssp(const csr_edge_t *edges, const uint32_t *weights, uint64_t m,
+                         uint32_t n, int32_t directed, uint32_t src, uint64_t *dist)
+{
+    uint64_t i, count = 0;
+    uint32_t v, a, b;
+    int32_t changed = 1, side;
+
+    for (v = 0; v < n; v++)
+        dist[v] = CSR_INF;
+    dist[src] = 0;
+    while (changed)
+    {
+        changed = 0;
+        for (i = 0; i < m; i++)
+        {
+            for (side = 0; side < (directed ? 1 : 2); side++)
+            {
+                a = side ? edges[i].dst : edges[i].src;
+                b = side ? edges[i].src : edges[i].dst;
+                if (dist[a] != CSR_INF && dist[a] + weights[i] < dist[b])
+                {
+                    dist[b] = dist[a] + weights[i];
+                    changed = 1;
+                }
+            }
+        }
+    }
+    for (v = 0; v < n; v++)
+        count += dist[v] != CSR_INF;
+    return count;
+}
+
+static void test_sssp(void)
+{
+    static const uint32_t max_weight[] = {1, 10, 1000, 1U << 30};
+    static const uint64_t deltas[] = {0, 1, 7, 1000, 1ULL << 40};
+    csr_edge_t *edges;
+    uint32_t *weights, n, round, src;
+    uint64_t m, i, *dist, *want, reached;
+    int32_t flags, d;
+    csr_graph_t *g;
+    int64_t got;
+
+    for (round = 0; round < 48; round++)
+    {
+        n = 1 + (uint32_t)(xorshift64() % (round < 24 ? 40 : 1500));
+        m = xorshift64() % (n * 4ULL + 1);
+        flags = (round & 1 ? CSR_DIRECTED : 0) | (round & 2 ? CSR_SIMPLE : 0);
+        edges = (csr_edge_t *)malloc((m + 1) * sizeof(csr_edge_t));
+        weights = (uint32_t *)malloc((m + 1) * sizeof(uint32_t));
+        for (i = 0; i < m; i++)
+        {
+            edges[i].src = (uint32_t)(xorshift64() % n);
+            edges[i].dst = (uint32_t)(xorshift64() % n);
+            weights[i] = 1 + (uint32_t)(xorshift64() % max_weight[round % 4]);
+        }
+        dist = (uint64_t *)malloc(n * sizeof(uint64_t));
+        want = (uint64_t *)malloc(n * sizeof(uint64_t));
+        g = csr_build_weighted(edges, weights, m, n, flags, 1 + round % 4);
+        if (g == NULL)
+        {
+            printf("sssp %u: build failed\n", round);
+            failed++;
+            goto next;
+        }
+        check_weighted("sssp", g, edges, weights, m, flags);
+        src = (uint32_t)(xorshift64() % n);
+        reached = ref_sssp(edges, weights, m, n, flags & CSR_DIRECTED, src, want);
+        got = csr_dijkstra(g, src, dist);
+        if (got != (int64_t)reached || memcmp(dist, want, n * sizeof(uint64_t)) != 0)
+        {
+            printf("sssp %u: dijkstra from %u differs\n", round, src);
+            failed++;
+            goto next;
+        }
+        for (d = 0; d < 5; d++)
+        {
+            got = csr_sssp(g, src, dist, deltas[d], 1 + (round + d) % 4);
+            if (got != (int64_t)reached || memcmp(dist, want, n * sizeof(uint64_t)) != 0)
+            {
+                printf("sssp %u: delta-stepping delta %llu from %u differs\n", round,
+                       (unsigned long long)deltas[d], src);
+                failed++;
+                goto next;
+            }
+        }
+next:
+        csr_free(g);
+        free(edges);
+        free(weights);
+        free(dist);
+        free(want);
+    }
+}
+
+/*Ȩͼ·BFSĲ*/
+static void test_sssp_unweighted(void)
+{
+    csr_edge_t *edges = rmat(12, 8 << 12);
+    csr_graph_t *g = csr_build(edges, 8 << 12, 0, CSR_SIMPLE, 4);
+    uint64_t *dist = (uint64_t *)malloc(g->n * sizeof(uint64_t));
+    int32_t *depth = (int32_t *)malloc(g->n * sizeof(int32_t));
+    int64_t reached = csr_bfs(g, 0, depth, 2, CSR_BFS_AUTO);
+    uint32_t v, bad = 0;
+
+    CHECK(csr_dijkstra(g, 0, dist) == reached, "sssp: unweighted dijkstra reached");
+    for (v = 0; v < g->n; v++)
+        bad += dist[v] != (depth[v] < 0 ? CSR_INF : (uint64_t)depth[v]);
+    CHECK(bad == 0, "sssp: unweighted dijkstra differs from bfs");
+    CHECK(csr_sssp(g, 0, dist, 0, 3) == reached, "sssp: unweighted delta-stepping reached");
+    for (v = 0; v < g->n; v++)
+        bad += dist[v] != (depth[v] < 0 ? CSR_INF : (uint64_t)depth[v]);
+    CHECK(bad == 0, "sssp: unweighted delta-stepping differs from bfs");
+    CHECK(csr_dijkstra(g, g->n, dist) == -1 && csr_sssp(g, g->n, dist, 0, 2) == -1,
+          "sssp: bad source accepted");
+    free(dist);
+    free(depth);
+    free(edges);
+    csr_free(g);
+}
+
+/*iters*/
+static void ref_pagerank(const csr_graph_t *g, double d, int32_t iters, double *rank)
+{
+    double *next = (double *)malloc(g->n * sizeof(double)), dangling;
+    uint64_t e;
+    uint32_t v;
+    int32_t i;
+
+    for (v = 0; v < g->n; v++)
+        rank[v] = 1.0 / g->n;
+    for (i = 0; i < iters; i++)
+    {
+        dangling = 0;
+        for (v = 0; v < g->n; v++)
+        {
+            next[v] = 0;
+            if (csr_degree(g, v) == 0)
+                dangling += rank[v];
+        }
+        for (v = 0; v < g->n; v++)
+        {
+            for (e = g->offsets[v]; e < g->offsets[v + 1]; e++)
+                next[g->adj[e]] += rank[v] / csr_degree(g, v);
+        }
+        for (v = 0; v < g->n; v++)
+            rank[v] = (1 - d) / g->n + d * dangling / g->n + d * next[v];
+    }
+    free(next);
+}
+
+static void test_pagerank(void)
+{
+    static const uint32_t blocks[] = {0, 1, 7, 100};
+    csr_edge_t *edges;
+    csr_graph_t *g;
+    double *rank, *want, diff, sum;
+    uint32_t n, round, v;
+    uint64_t m, i;
+    int32_t b, iters;
+
+    for (round = 0; round < 24; round++)
+    {
+        n = 1 + (uint32_t)(xorshift64() % (round < 12 ? 30 : 2000));
+        m = xorshift64() % (n * 5ULL + 1);
+        edges = (csr_edge_t *)malloc((m + 1) * sizeof(csr_edge_t));
+        for (i = 0; i < m; i++)
+        {
+            edges[i].src = (uint32_t)(xorshift64() % n);
+            edges[i].dst = (uint32_t)(xorshift64() % n);
+        }
+        g = csr_build(edges, m, n, round & 1 ? CSR_DIRECTED : 0, 2);
+        rank = (double *)malloc(n * sizeof(double));
+        want = (double *)malloc(n * sizeof(double));
+        ref_pagerank(g, 0.85, 20, want);
+        for (b = 0; b < 4; b++)
+        {
+            iters = csr_pagerank(g, 0.85, 0, 20, blocks[b], rank, 1 + (round + b) % 4);
+            for (v = 0, diff = 0, sum = 0; v < n; v++)
+            {
+                diff = fmax(diff, fabs(rank[v] - want[v]));
+                sum += rank[v];
+            }
+            if (iters != 20 || diff > 1e-12 || fabs(sum - 1) > 1e-9)
+            {
+                printf("pagerank %u block %u: %d iterations, diff %g, sum %g\n", round,
+                       blocks[b], iters, diff, sum);
+                failed++;
+                break;
+            }
+        }
+        /*˾ǰͣ*/
+        iters = csr_pagerank(g, 0.85, 1e-6, 1000, 0, rank, 3);
+        if (iters <= 0 || iters >= 1000)
+        {
+            printf("pagerank %u: did not converge, %d iterations\n", round, iters);
+            failed++;
+        }
+        csr_free(g);
+        free(edges);
+        free(rank);
+        free(want);
+    }
+}
+
+static void test_load_weighted(void)
+{
+    const char *text = "# u v w\n1 2 5\n3 4\r\n5 6 7 extra\n\n6 1\t9\n";
+    csr_edge_t want[] = {{1, 2}, {3, 4}, {5, 6}, {6, 1}}, *edges;
+    uint32_t want_w[] = {5, 1, 7, 9}, *weights, n;
+    char path[] = "/tmp/csr_test_XXXXXX";
+    csr_graph_t *g, *h;
+    uint64_t m;
+    FILE *fp;
+    int fd;
+
+    fd = mkstemp(path);
+    CHECK(fd >= 0, "load weighted: mkstemp");
+    close(fd);
+    fp = fopen(path, "w");
+    fputs(text, fp);
+    fclose(fp);
+    edges = csr_load_weighted_edges(path, &m, &n, &weights, 2);
+    CHECK(edges != NULL && m == 4 && n == 7 && memcmp(edges, want, sizeof(want)) == 0 &&
+          memcmp(weights, want_w, sizeof(want_w)) == 0, "load weighted: small text file");
+
+    g = csr_build_weighted(edges, weights, m, n, CSR_DIRECTED | CSR_SIMPLE, 2);
+    free(edges);
+    free(weights);
+    CHECK(g != NULL && csr_save(g, path) == 0, "load weighted: save failed");
+    h = csr_load(path);
+    CHECK(h != NULL && h->m == g->m && h->weight != NULL &&
+          memcmp(h->weight, g->weight, g->m * sizeof(uint32_t)) == 0 &&
+          memcmp(h->adj, g->adj, g->m * sizeof(uint32_t)) == 0, "load weighted: round trip");
+    csr_free(g);
+    csr_free(h);
+
+    fp = fopen(path, "w");
+    fputs("1 2 3\n3 4 99999999999\n", fp);
+    fclose(fp);
+    CHECK(csr_load_weighted_edges(path, &m, &n, &weights, 1) == NULL,
+          "load weighted: accepted a weight that does not fit");
+    unlink(path);
+}
+
+int main(void)
+{
+    test_small();
+    test_random();
+    test_rmat();
+    test_load();
+    test_sssp();
+    test_sssp_unweighted();
+    test_pagerank();
+    test_load_weighted();
+
+    if (failed)
+        printf("%d failed\n", failed);
+    else
+        printf("all passed\n");
+    return failed != 0;
+}
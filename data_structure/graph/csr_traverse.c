@@ -0,0 +1,555 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ *CSRͼϵBFSDFSͨcsr.h
+ *
+ *BFS(BeamerķŻ)
+ *    top-downǰǶУ̶ֿ̬߳ǰĶ㣬ھûʹCASռ
+ *              ȷŽ߳ԼС壬һ׷ӵһĶ
+ *    bottom-upǰλͼÿ̰߳64һַֿ飬ûʹĶ㿴Լ
+ *              ()ھӣһǰľͣһλͼдԭӲ
+ *    ǰصĳm_fûʵĶım_u1/ALPHAʱbottom-up
+ *    ǰصĶn/BETAڱʱtop-down
+ *ͨ(Afforest)鼯ǷСĶ㣬ʱCAS
+ *    ѴĹҵС棻ֻÿͷھӣҳķ
+ *    ʣµıʱĶ(ǵıߴһͷҲܿ)
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "csr.h"
+#include "csr_parallel.h"
+
+#define BFS_ALPHA           15
+#define BFS_BETA            18
+#define BFS_CHUNK           64      /*top-downһôǰض*/
+#define BFS_WORD_CHUNK      16      /*bottom-upһô*/
+#define BFS_LOCAL           1024    /*top-down߳ԼĻ*/
+#define CC_NEIGHBORS        2       /*ھӸ*/
+#define CC_SAMPLES          1024
+#define CC_CHUNK            1024
+
+typedef struct bfs_arg{
+    const csr_graph_t *g;
+    uint32_t src;
+    int32_t *depth;
+    int32_t mode;
+    uint32_t *queue;        /*top-downĵǰ*/
+    uint32_t *next;         /*top-downһ*/
+    uint64_t queue_n;
+    uint64_t next_n;
+    uint64_t *front;        /*bottom-upĵǰ*/
+    uint64_t *front_next;
+    uint64_t words;
+    uint64_t cursor;        /*ֿ̬*/
+    uint64_t m_f;           /*ǰصĳ*/
+    uint64_t m_u;           /*ûʵĶĳ*/
+    uint64_t n_f;           /*ǰصĶ*/
+    int32_t shrinking;      /*ǰرһС*/
+    uint64_t next_m;        /*һĳ̼߳ӽ*/
+    uint64_t reached;
+    int32_t level;
+    int32_t bottom_up;      /*һĸ*/
+    int32_t convert;        /*һ㿪ʼǰҪҪתǰصıʾ*/
+} bfs_arg_t;
+
+static inline int32_t bit_test(const uint64_t *bits, uint32_t v)
+{
+    return (bits[v >> 6] >> (v & 63)) & 1;
+}
+
+/*׷ӵһĶ*/
+static void bfs_flush(bfs_arg_t *b, const uint32_t *local, uint64_t n)
+{
+    uint64_t pos;
+
+    if (n == 0)
+        return;
+    pos = __atomic_fetch_add(&b->next_n, n, __ATOMIC_RELAXED);
+    memcpy(b->next + pos, local, n * sizeof(uint32_t));
+}
+
+static void bfs_top_down(bfs_arg_t *b)
+{
+    const csr_graph_t *g = b->g;
+    uint32_t local[BFS_LOCAL], u, w;
+    uint64_t lo, hi, i, e, n = 0, m = 0;
+    int32_t unvisited, d = b->level + 1;
+
+    for (;;)
+    {
+        lo = __atomic_fetch_add(&b->cursor, BFS_CHUNK, __ATOMIC_RELAXED);
+        if (lo >= b->queue_n)
+            break;
+        hi = lo + BFS_CHUNK < b->queue_n ? lo + BFS_CHUNK : b->queue_n;
+        for (i = lo; i < hi; i++)
+        {
+            u = b->queue[i];
+            for (e = g->offsets[u]; e < g->offsets[u + 1]; e++)
+            {
+                w = g->adj[e];
+                if (__atomic_load_n(&b->depth[w], __ATOMIC_RELAXED) >= 0)
+                    continue;
+                unvisited = -1;
+                if (!__atomic_compare_exchange_n(&b->depth[w], &unvisited, d, 0,
+                                                 __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                    continue;
+                m += csr_degree(g, w);
+                local[n++] = w;
+                if (n == BFS_LOCAL)
+                {
+                    bfs_flush(b, local, n);
+                    n = 0;
+                }
+            }
+        }
+    }
+    bfs_flush(b, local, n);
+    __atomic_fetch_add(&b->next_m, m, __ATOMIC_RELAXED);
+}
+
+static void bfs_bottom_up(bfs_arg_t *b)
+{
+    const csr_graph_t *g = b->g;
+    uint64_t lo, hi, i, e, bits, n = 0, m = 0;
+    uint32_t v, end;
+    int32_t d = b->level + 1;
+
+    for (;;)
+    {
+        lo = __atomic_fetch_add(&b->cursor, BFS_WORD_CHUNK, __ATOMIC_RELAXED);
+        if (lo >= b->words)
+            break;
+        hi = lo + BFS_WORD_CHUNK < b->words ? lo + BFS_WORD_CHUNK : b->words;
+        for (i = lo; i < hi; i++)
+        {
+            bits = 0;
+            end = i * 64 + 64 < g->n ? (uint32_t)(i * 64 + 64) : g->n;
+            for (v = (uint32_t)(i * 64); v < end; v++)
+            {
+                if (b->depth[v] >= 0)
+                    continue;
+                for (e = g->in_offsets[v]; e < g->in_offsets[v + 1]; e++)
+                {
+                    if (bit_test(b->front, g->in_adj[e]))
+                    {
+                        b->depth[v] = d;
+                        bits |= 1ULL << (v & 63);
+                        m += csr_degree(g, v);
+                        n++;
+                        break;
+                    }
+                }
+            }
+            b->front_next[i] = bits;
+        }
+    }
+    __atomic_fetch_add(&b->next_n, n, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&b->next_m, m, __ATOMIC_RELAXED);
+}
+
+/*תλͼ㣬ٰλ*/
+static void queue_to_bitmap(csr_team_t *team, int32_t tid, bfs_arg_t *b)
+{
+    uint64_t lo, hi, i;
+    uint32_t v;
+
+    csr_split(b->words, tid, team->threads, &lo, &hi);
+    memset(b->front + lo, 0, (hi - lo) * sizeof(uint64_t));
+    csr_barrier(team);
+    csr_split(b->queue_n, tid, team->threads, &lo, &hi);
+    for (i = lo; i < hi; i++)
+    {
+        v = b->queue[i];
+        __atomic_fetch_or(&b->front[v >> 6], 1ULL << (v & 63), __ATOMIC_RELAXED);
+    }
+}
+
+/*λͼתУ߳ɨԼǶ֣Ž׷*/
+static void bitmap_to_queue(csr_team_t *team, int32_t tid, bfs_arg_t *b)
+{
+    uint32_t local[BFS_LOCAL];
+    uint64_t lo, hi, i, bits, n = 0;
+
+    csr_split(b->words, tid, team->threads, &lo, &hi);
+    for (i = lo; i < hi; i++)
+    {
+        for (bits = b->front[i]; bits != 0; bits &= bits - 1)
+        {
+            local[n++] = (uint32_t)(i * 64 + __builtin_ctzll(bits));
+            if (n == BFS_LOCAL)
+            {
+                bfs_flush(b, local, n);
+                n = 0;
+            }
+        }
+    }
+    bfs_flush(b, local, n);
+}
+
+/*0߳̾һķ*/
+static void bfs_decide(bfs_arg_t *b)
+{
+    int32_t bottom_up = b->bottom_up;
+
+    if (b->mode == CSR_BFS_TOP_DOWN)
+        bottom_up = 0;
+    else if (b->mode == CSR_BFS_BOTTOM_UP)
+        bottom_up = 1;
+    else if (!b->bottom_up && b->m_f > b->m_u / BFS_ALPHA)
+        bottom_up = 1;
+    else if (b->bottom_up && b->shrinking && b->n_f < b->g->n / BFS_BETA)
+        bottom_up = 0;
+    b->convert = bottom_up != b->bottom_up;
+    b->bottom_up = bottom_up;
+    b->cursor = 0;
+    b->next_n = 0;
+    b->next_m = 0;
+}
+
+static void bfs_work(csr_team_t *team, int32_t tid, void *data)
+{
+    bfs_arg_t *b = (bfs_arg_t *)data;
+    const csr_graph_t *g = b->g;
+    uint64_t lo, hi, v, n_f;
+    uint32_t *tmp;
+    uint64_t *tbits;
+
+    csr_split(g->n, tid, team->threads, &lo, &hi);
+    for (v = lo; v < hi; v++)
+        b->depth[v] = -1;
+    csr_barrier(team);
+    if (tid == 0)
+    {
+        b->depth[b->src] = 0;
+        b->queue[0] = b->src;
+        b->queue_n = 1;
+        b->n_f = 1;
+        b->m_f = csr_degree(g, b->src);
+        b->m_u = g->m - b->m_f;
+        b->reached = 1;
+        b->level = 0;
+        b->bottom_up = 0;
+        bfs_decide(b);
+    }
+    csr_barrier(team);
+
+    for (;;)
+    {
+        if (b->convert)
+        {
+            if (b->bottom_up)
+                queue_to_bitmap(team, tid, b);
+            else
+                bitmap_to_queue(team, tid, b);
+            csr_barrier(team);
+            if (tid == 0 && !b->bottom_up)
+            {
+                tmp = b->queue;
+                b->queue = b->next;
+                b->next = tmp;
+                b->queue_n = b->next_n;
+                b->next_n = 0;
+            }
+            csr_barrier(team);
+        }
+
+        if (b->bottom_up)
+            bfs_bottom_up(b);
+        else
+            bfs_top_down(b);
+        csr_barrier(team);
+
+        if (tid == 0)
+        {
+            n_f = b->next_n;
+            if (b->bottom_up)
+            {
+                tbits = b->front;
+                b->front = b->front_next;
+                b->front_next = tbits;
+            }
+            else
+            {
+                tmp = b->queue;
+                b->queue = b->next;
+                b->next = tmp;
+                b->queue_n = n_f;
+            }
+            b->reached += n_f;
+            b->level++;
+            /*ǰڱٲſǻtop-down*/
+            b->shrinking = n_f < b->n_f;
+            b->n_f = n_f;
+            b->m_f = b->next_m;
+            b->m_u -= b->m_f;
+            bfs_decide(b);
+        }
+        csr_barrier(team);
+        if (b->n_f == 0)
+            break;
+    }
+}
+
+int64_t csr_bfs(const csr_graph_t *g, uint32_t src, int32_t *depth, int32_t threads,
+                int32_t mode)
+{
+    bfs_arg_t b;
+    int64_t ret = -1;
+
+    if (src >= g->n)
+        return -1;
+    memset(&b, 0, sizeof(b));
+    b.g = g;
+    b.src = src;
+    b.depth = depth;
+    b.mode = mode;
+    b.words = (g->n + 63ULL) / 64;
+    b.queue = (uint32_t *)malloc(g->n * sizeof(uint32_t));
+    b.next = (uint32_t *)malloc(g->n * sizeof(uint32_t));
+    b.front = (uint64_t *)malloc(b.words * sizeof(uint64_t));
+    b.front_next = (uint64_t *)malloc(b.words * sizeof(uint64_t));
+    if (b.queue != NULL && b.next != NULL && b.front != NULL && b.front_next != NULL)
+    {
+        csr_parallel(threads, bfs_work, &b);
+        ret = (int64_t)b.reached;
+    }
+    free(b.queue);
+    free(b.next);
+    free(b.front);
+    free(b.front_next);
+    return ret;
+}
+
+
+int64_t csr_dfs(const csr_graph_t *g, uint32_t src, uint32_t *order, uint32_t *parent)
+{
+    uint32_t *stack, *visited, v, w;
+    uint64_t *next;
+    int64_t count = 0;
+    uint32_t top = 0;
+
+    if (src >= g->n)
+        return -1;
+    stack = (uint32_t *)malloc(g->n * sizeof(uint32_t));
+    next = (uint64_t *)malloc(g->n * sizeof(uint64_t));
+    visited = (uint32_t *)calloc((g->n + 31ULL) / 32, sizeof(uint32_t));
+    if (stack == NULL || next == NULL || visited == NULL)
+    {
+        free(stack);
+        free(next);
+        free(visited);
+        return -1;
+    }
+    if (parent != NULL)
+    {
+        for (v = 0; v < g->n; v++)
+            parent[v] = CSR_NONE;
+        parent[src] = src;
+    }
+
+    /*͵ݹDFSһȷԼջÿһҪھ*/
+    stack[top++] = src;
+    next[src] = g->offsets[src];
+    visited[src >> 5] |= 1U << (src & 31);
+    if (order != NULL)
+        order[count] = src;
+    count++;
+    while (top > 0)
+    {
+        v = stack[top - 1];
+        if (next[v] == g->offsets[v + 1])
+        {
+            top--;
+            continue;
+        }
+        w = g->adj[next[v]++];
+        if (visited[w >> 5] & (1U << (w & 31)))
+            continue;
+        visited[w >> 5] |= 1U << (w & 31);
+        if (order != NULL)
+            order[count] = w;
+        if (parent != NULL)
+            parent[w] = v;
+        count++;
+        next[w] = g->offsets[w];
+        stack[top++] = w;
+    }
+    free(stack);
+    free(next);
+    free(visited);
+    return count;
+}
+
+
+typedef struct cc_arg{
+    const csr_graph_t *g;
+    uint32_t *comp;
+    uint64_t cursor;
+    uint32_t big;           /*ķ*/
+    uint64_t count[CSR_MAX_THREADS];    /*ÿ߳ĸ*/
+} cc_arg_t;
+
+/*Ҹ˳·룻ָֻĳָȣҲûϵ*/
+static uint32_t cc_find(uint32_t *comp, uint32_t x)
+{
+    uint32_t p, gp;
+
+    for (;;)
+    {
+        p = __atomic_load_n(&comp[x], __ATOMIC_RELAXED);
+        if (p == x)
+            return x;
+        gp = __atomic_load_n(&comp[p], __ATOMIC_RELAXED);
+        if (gp != p)
+            __atomic_store_n(&comp[x], gp, __ATOMIC_RELAXED);
+        x = gp;
+    }
+}
+
+/*ıŴĹҵС棬ȹ˾*/
+static void cc_union(uint32_t *comp, uint32_t u, uint32_t w)
+{
+    uint32_t ru, rw, hi, lo;
+
+    for (;;)
+    {
+        ru = cc_find(comp, u);
+        rw = cc_find(comp, w);
+        if (ru == rw)
+            return;
+        hi = ru > rw ? ru : rw;
+        lo = ru > rw ? rw : ru;
+        if (__atomic_compare_exchange_n(&comp[hi], &hi, lo, 0, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED))
+            return;
+    }
+}
+
+/*̶ֿ̬߳ö㣬ӵfirstھӿʼıߣskip_bigʱĶ*/
+static void cc_link(csr_team_t *team, cc_arg_t *c, uint64_t first, uint64_t last,
+                    int32_t skip_big)
+{
+    const csr_graph_t *g = c->g;
+    uint64_t lo, hi, v, e, end;
+
+    for (;;)
+    {
+        lo = __atomic_fetch_add(&c->cursor, CC_CHUNK, __ATOMIC_RELAXED);
+        if (lo >= g->n)
+            break;
+        hi = lo + CC_CHUNK < g->n ? lo + CC_CHUNK : g->n;
+        for (v = lo; v < hi; v++)
+        {
+            if (skip_big && cc_find(c->comp, (uint32_t)v) == c->big)
+                continue;
+            end = g->offsets[v] + last < g->offsets[v + 1] ? g->offsets[v] + last :
+                  g->offsets[v + 1];
+            for (e = g->offsets[v] + first; e < end; e++)
+                cc_union(c->comp, (uint32_t)v, g->adj[e]);
+            /*ͼıֻһͷĳ͵ðҲ*/
+            if (skip_big && g->directed)
+            {
+                for (e = g->in_offsets[v]; e < g->in_offsets[v + 1]; e++)
+                    cc_union(c->comp, (uint32_t)v, g->in_adj[e]);
+            }
+        }
+    }
+}
+
+/*ÿֱָ*/
+static void cc_compress(csr_team_t *team, int32_t tid, cc_arg_t *c)
+{
+    uint64_t lo, hi, v;
+
+    csr_split(c->g->n, tid, team->threads, &lo, &hi);
+    for (v = lo; v < hi; v++)
+        __atomic_store_n(&c->comp[v], cc_find(c->comp, (uint32_t)v), __ATOMIC_RELAXED);
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/*ĸķ*/
+static uint32_t cc_sample(const cc_arg_t *c)
+{
+    uint32_t samples[CC_SAMPLES], best = 0;
+    uint64_t seed = 88172645463325252ULL;
+    int32_t i, run, best_run = 0;
+
+    for (i = 0; i < CC_SAMPLES; i++)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        samples[i] = c->comp[seed % c->g->n];
+    }
+    qsort(samples, CC_SAMPLES, sizeof(uint32_t), cmp_u32);
+    for (i = 0, run = 0; i < CC_SAMPLES; i++)
+    {
+        run = i > 0 && samples[i] == samples[i - 1] ? run + 1 : 1;
+        if (run > best_run)
+        {
+            best_run = run;
+            best = samples[i];
+        }
+    }
+    return best;
+}
+
+static void cc_work(csr_team_t *team, int32_t tid, void *data)
+{
+    cc_arg_t *c = (cc_arg_t *)data;
+    uint64_t lo, hi, v, roots = 0;
+
+    csr_split(c->g->n, tid, team->threads, &lo, &hi);
+    for (v = lo; v < hi; v++)
+        c->comp[v] = (uint32_t)v;
+    csr_barrier(team);
+
+    cc_link(team, c, 0, CC_NEIGHBORS, 0);
+    csr_barrier(team);
+    cc_compress(team, tid, c);
+    csr_barrier(team);
+    if (tid == 0)
+    {
+        c->big = cc_sample(c);
+        c->cursor = 0;
+    }
+    csr_barrier(team);
+
+    cc_link(team, c, CC_NEIGHBORS, UINT64_MAX / 2, 1);
+    csr_barrier(team);
+    cc_compress(team, tid, c);
+    for (v = lo; v < hi; v++)
+        roots += __atomic_load_n(&c->comp[v], __ATOMIC_RELAXED) == v;
+    c->count[tid] = roots;
+}
+
+int64_t csr_cc(const csr_graph_t *g, uint32_t *comp, int32_t threads)
+{
+    cc_arg_t c;
+    int64_t total = 0;
+    int32_t i;
+
+    if (g->n == 0)
+        return 0;
+    memset(&c, 0, sizeof(c));
+    c.g = g;
+    c.comp = comp;
+    csr_parallel(threads, cc_work, &c);
+    for (i = 0; i < CSR_MAX_THREADS; i++)
+        total += c.count[i];
+    return total;
+}
+
+#ifdef __cplusplus
+}
+#endif
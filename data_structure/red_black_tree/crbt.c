@@ -0,0 +1,708 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ *ĺcrbt.h
+ *д̳߳t->lockȰҪõĽڵgarbageĿռ׼;ͲΪڴ治ʧܡ
+ *gent->genͬĽڵдƻ½ģֱ̻߳Ӹģ
+ *ڵ㶼ж߳ڿҪcowһݣɵķŽgarbage
+ *¸seq_cstдȥ֮Ľڵֻ֮ǰĶ̻߳ܿ
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "crbt.h"
+
+#define CRBT_CACHE_LINE     64
+#define CRBT_MAX_DEPTH      96      /*߶Ȳ2log2(n+1)*/
+#define CRBT_RESERVE        400     /*һдิôڵ*/
+#define CRBT_FREE_MAX       4096    /*free_listô࣬Ļϵͳ*/
+#define CRBT_GC_BATCH       1024    /*ôڵһ*/
+
+/*
+ *ÿ߳һactiveΪʱepoch0ʾڶ
+ *depthǶײcrbt_rangevisitﻹsearch/rangeֻactive
+ */
+typedef struct CRbtReader{
+    uint64_t active;
+    int32_t in_use;
+    int32_t depth;
+    struct CRbtReader* next;
+} __attribute__((aligned(CRBT_CACHE_LINE))) CRbtReader;
+
+static CRbtReader* readers = NULL;
+static uint64_t reader_epoch = 1;
+static pthread_key_t reader_key;
+static pthread_once_t reader_once = PTHREAD_ONCE_INIT;
+static __thread CRbtReader* reader_self = NULL;
+/*˻ؼʱŵͬһǶ׶ټȻԼԼ*/
+static __thread crbt_t* reader_locked = NULL;
+static __thread int32_t reader_locked_depth = 0;
+
+
+/*߳˳ʱѼ¼ȥԺ߳*/
+static void reader_release(void *arg)
+{
+    CRbtReader *r = (CRbtReader *)arg;
+
+    r->depth = 0;
+    __atomic_store_n(&r->active, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&r->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void reader_key_init(void)
+{
+    pthread_key_create(&reader_key, reader_release);
+}
+
+static CRbtReader* reader_get(void)
+{
+    CRbtReader *r;
+    int32_t unused;
+
+    if (reader_self != NULL)
+        return reader_self;
+    pthread_once(&reader_once, reader_key_init);
+
+    for (r = __atomic_load_n(&readers, __ATOMIC_ACQUIRE); r != NULL; r = r->next)
+    {
+        unused = 0;
+        if (__atomic_compare_exchange_n(&r->in_use, &unused, 1, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+            break;
+    }
+    if (r == NULL)
+    {
+        /*¼ͷţֻ*/
+        if (posix_memalign((void **)&r, CRBT_CACHE_LINE, sizeof(CRbtReader)) != 0)
+            return NULL;
+        memset(r, 0, sizeof(CRbtReader));
+        r->in_use = 1;
+        r->next = __atomic_load_n(&readers, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&readers, &r->next, r, 0,
+                                            __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            ;
+    }
+    pthread_setspecific(reader_key, r);
+    reader_self = r;
+    return r;
+}
+
+/*
+ *seq_cst֮seq_cstд߳дټepochɨactive
+ *ɨʱûĶ̶߳һ¸
+ *Ƕ׽Ķactiveepochϣֻౣڵ
+ *ò¼(ڴ治)˻ؼ
+ */
+static CRbtReader* read_begin(crbt_t *t)
+{
+    CRbtReader *r = reader_get();
+
+    if (r == NULL)
+    {
+        if (reader_locked == t)
+        {
+            reader_locked_depth++;
+            return NULL;
+        }
+        pthread_mutex_lock(&t->lock);
+        if (reader_locked == NULL)
+        {
+            reader_locked = t;
+            reader_locked_depth = 1;
+        }
+    }
+    else if (r->depth++ == 0)
+        __atomic_store_n(&r->active, __atomic_load_n(&reader_epoch, __ATOMIC_SEQ_CST),
+                         __ATOMIC_SEQ_CST);
+    return r;
+}
+
+static void read_end(crbt_t *t, CRbtReader *r)
+{
+    if (r == NULL)
+    {
+        if (reader_locked == t)
+        {
+            if (--reader_locked_depth > 0)
+                return;
+            reader_locked = NULL;
+        }
+        pthread_mutex_unlock(&t->lock);
+    }
+    else if (--r->depth == 0)
+        __atomic_store_n(&r->active, 0, __ATOMIC_RELEASE);
+}
+
+/*ͷһ߳ѾĽڵ*/
+static void node_free(crbt_t *t, crbt_node_t *n)
+{
+    if (t->free_count < CRBT_FREE_MAX)
+    {
+        n->left = t->free_list;
+        t->free_list = n;
+        t->free_count++;
+    }
+    else
+    {
+        free(n);
+        t->nodes--;
+    }
+}
+
+/*ͷŵĶͷŵûepochȴ*/
+static void gc(crbt_t *t)
+{
+    CRbtReader *r;
+    crbt_node_t *n;
+    uint64_t min = UINT64_MAX, active, epoch;
+    size_t i, j;
+
+    epoch = __atomic_fetch_add(&reader_epoch, 1, __ATOMIC_SEQ_CST);
+    for (r = __atomic_load_n(&readers, __ATOMIC_ACQUIRE); r != NULL; r = r->next)
+    {
+        active = __atomic_load_n(&r->active, __ATOMIC_SEQ_CST);
+        if (active != 0 && active < min)
+            min = active;
+    }
+
+    for (i = j = 0; i < t->garbage_n; i++)
+    {
+        n = t->garbage[i];
+        if (n->gen == 0)
+            n->gen = epoch;
+        if (n->gen < min)
+            node_free(t, n);
+        else
+            t->garbage[j++] = n;
+    }
+    t->garbage_n = j;
+    /*ж߳һֱߵĻҪÿдɨһ*/
+    t->gc_next = j + CRBT_GC_BATCH;
+}
+
+/*׼дҪĽڵgarbageռ*/
+static int32_t reserve(crbt_t *t)
+{
+    crbt_node_t *n, **g;
+    size_t cap;
+
+    while (t->free_count < CRBT_RESERVE)
+    {
+        n = (crbt_node_t *)malloc(sizeof(crbt_node_t));
+        if (n == NULL)
+            return -1;
+        t->nodes++;
+        n->left = t->free_list;
+        t->free_list = n;
+        t->free_count++;
+    }
+    if (t->garbage_n + CRBT_RESERVE > t->garbage_cap)
+    {
+        cap = t->garbage_cap * 2 > t->garbage_n + CRBT_RESERVE ?
+              t->garbage_cap * 2 : t->garbage_n + CRBT_RESERVE;
+        g = (crbt_node_t **)realloc(t->garbage, cap * sizeof(crbt_node_t *));
+        if (g == NULL)
+            return -1;
+        t->garbage = g;
+        t->garbage_cap = cap;
+    }
+    return 0;
+}
+
+static crbt_node_t* node_new(crbt_t *t)
+{
+    crbt_node_t *n = t->free_list;
+
+    t->free_list = n->left;
+    t->free_count--;
+    n->gen = t->gen;
+    return n;
+}
+
+/*Ҫn߳̿ڿ͸һݣɵĻ*/
+static crbt_node_t* cow(crbt_t *t, crbt_node_t *n)
+{
+    crbt_node_t *copy;
+
+    if (n == NULL || n->gen == t->gen)
+        return n;
+    copy = node_new(t);
+    copy->key = n->key;
+    copy->color = n->color;
+    copy->value = n->value;
+    copy->left = n->left;
+    copy->right = n->right;
+    n->gen = 0;
+    t->garbage[t->garbage_n++] = n;
+    return copy;
+}
+
+static void publish(crbt_t *t, crbt_node_t *root)
+{
+    __atomic_store_n(&t->root, root, __ATOMIC_SEQ_CST);
+    if (t->garbage_n >= t->gc_next)
+        gc(t);
+}
+
+static int is_red(const crbt_node_t *n)
+{
+    return n != NULL && n->color == 'R';
+}
+
+/*
+ *rbt.cLeftRotateһparentxĸףNULLʾxǸ
+ *xx->rightparentдƹ
+ *                x                             y
+ *               / \     Left Rotation         / \
+ *             T1   y    - - - - - - - >      x   T3
+ *                 / \                       / \
+ *                T2  T3                   T1   T2
+ */
+static void left_rotate(crbt_node_t **root, crbt_node_t *parent, crbt_node_t *x)
+{
+    crbt_node_t *y = x->right;
+
+    x->right = y->left;
+    if (parent == NULL)
+        *root = y;
+    else if (x == parent->left)
+        parent->left = y;
+    else
+        parent->right = y;
+    y->left = x;
+}
+
+/*rbt.crightRotateһ*/
+static void right_rotate(crbt_node_t **root, crbt_node_t *parent, crbt_node_t *y)
+{
+    crbt_node_t *x = y->left;
+
+    y->left = x->right;
+    if (parent == NULL)
+        *root = x;
+    else if (y == parent->left)
+        parent->left = x;
+    else
+        parent->right = x;
+    x->right = y;
+}
+
+/*
+ *rbt.cinsertFixUpһzpath[i]path[i-1]Ǹףpath[i-2]游
+ *·ϵĽڵ㶼ƹˣҪɫڵٸ
+ *Ǻɫת꣬ĸǺɫģ
+ */
+static void insert_fixup(crbt_t *t, crbt_node_t **root, crbt_node_t **path, int32_t i)
+{
+    crbt_node_t *z, *p, *g, *gg, *y;
+    char ch;
+
+    while (i > 0 && path[i - 1]->color == 'R')
+    {
+        /*ǺɫԿ϶游ڵ*/
+        z = path[i];
+        p = path[i - 1];
+        g = path[i - 2];
+        gg = i >= 3 ? path[i - 3] : NULL;
+        y = p == g->left ? g->right : g->left;
+
+        if (is_red(y))
+        {
+            y = cow(t, y);
+            if (p == g->left)
+                g->right = y;
+            else
+                g->left = y;
+            y->color = 'B';
+            p->color = 'B';
+            g->color = 'R';
+            i -= 2;             /*游ڵΪҪ޸Ľڵ*/
+            continue;
+        }
+
+        if (p == g->left && z == p->left)
+        {
+            /*Left-Left׺游ɫ游*/
+            ch = p->color;
+            p->color = g->color;
+            g->color = ch;
+            right_rotate(root, gg, g);
+        }
+        else if (p == g->left && z == p->right)
+        {
+            /*Left-RightԼ游ɫף游*/
+            ch = z->color;
+            z->color = g->color;
+            g->color = ch;
+            left_rotate(root, g, p);
+            right_rotate(root, gg, g);
+        }
+        else if (p == g->right && z == p->right)
+        {
+            /*Right-Right*/
+            ch = p->color;
+            p->color = g->color;
+            g->color = ch;
+            left_rotate(root, gg, g);
+        }
+        else
+        {
+            /*Right-Left*/
+            ch = z->color;
+            z->color = g->color;
+            g->color = ch;
+            right_rotate(root, g, p);
+            left_rotate(root, gg, g);
+        }
+        break;
+    }
+    (*root)->color = 'B';
+}
+
+/*
+ *ɾһڽڵԺxһɫxĸpath[i]i<0ʾxǸ
+ *xNULLֵһǣֵܺҪɫֶӸԺٸ
+ */
+static void delete_fixup(crbt_t *t, crbt_node_t **root, crbt_node_t **path, int32_t i,
+                         crbt_node_t *x)
+{
+    crbt_node_t *p, *gp, *w;
+
+    while (i >= 0 && !is_red(x))
+    {
+        p = path[i];
+        gp = i > 0 ? path[i - 1] : NULL;
+        if (x == p->left)
+        {
+            w = p->right = cow(t, p->right);
+            if (w->color == 'R')
+            {
+                /*ֵܺɫתֵܺɫwpԭλ*/
+                w->color = 'B';
+                p->color = 'R';
+                left_rotate(root, gp, p);
+                path[i++] = w;
+                path[i] = p;
+                gp = w;
+                w = p->right = cow(t, p->right);
+            }
+            if (!is_red(w->left) && !is_red(w->right))
+            {
+                w->color = 'R';
+                x = p;
+                i--;
+                continue;
+            }
+            if (!is_red(w->right))
+            {
+                w->left = cow(t, w->left);
+                w->left->color = 'B';
+                w->color = 'R';
+                right_rotate(root, p, w);
+                w = p->right;
+            }
+            w->color = p->color;
+            p->color = 'B';
+            w->right = cow(t, w->right);
+            w->right->color = 'B';
+            left_rotate(root, gp, p);
+        }
+        else
+        {
+            w = p->left = cow(t, p->left);
+            if (w->color == 'R')
+            {
+                w->color = 'B';
+                p->color = 'R';
+                right_rotate(root, gp, p);
+                path[i++] = w;
+                path[i] = p;
+                gp = w;
+                w = p->left = cow(t, p->left);
+            }
+            if (!is_red(w->left) && !is_red(w->right))
+            {
+                w->color = 'R';
+                x = p;
+                i--;
+                continue;
+            }
+            if (!is_red(w->left))
+            {
+                w->right = cow(t, w->right);
+                w->right->color = 'B';
+                w->color = 'R';
+                left_rotate(root, p, w);
+                w = p->left;
+            }
+            w->color = p->color;
+            p->color = 'B';
+            w->left = cow(t, w->left);
+            w->left->color = 'B';
+            right_rotate(root, gp, p);
+        }
+        return;
+    }
+    /*ɫx·ϸƹ*/
+    if (is_red(x))
+        x->color = 'B';
+}
+
+crbt_t* crbt_create(void)
+{
+    crbt_t *t = (crbt_t *)calloc(1, sizeof(crbt_t));
+
+    if (t == NULL)
+        return NULL;
+    pthread_mutex_init(&t->lock, NULL);
+    t->gen = 1;
+    t->gc_next = CRBT_GC_BATCH;
+    return t;
+}
+
+static void free_rec(crbt_node_t *n)
+{
+    crbt_node_t *right;
+
+    while (n != NULL)
+    {
+        free_rec(n->left);
+        right = n->right;
+        free(n);
+        n = right;
+    }
+}
+
+void crbt_destroy(crbt_t *t)
+{
+    crbt_node_t *n;
+    size_t i;
+
+    if (t == NULL)
+        return;
+    free_rec(t->root);
+    for (i = 0; i < t->garbage_n; i++)
+        free(t->garbage[i]);
+    while (t->free_list != NULL)
+    {
+        n = t->free_list;
+        t->free_list = n->left;
+        free(n);
+    }
+    free(t->garbage);
+    pthread_mutex_destroy(&t->lock);
+    free(t);
+}
+
+int32_t crbt_insert(crbt_t *t, int32_t key, int64_t value)
+{
+    crbt_node_t *path[CRBT_MAX_DEPTH], *root, *n, *z, **link;
+    int32_t d = 0;
+
+    pthread_mutex_lock(&t->lock);
+    if (reserve(t) != 0)
+    {
+        pthread_mutex_unlock(&t->lock);
+        return -1;
+    }
+    t->gen++;
+
+    z = node_new(t);
+    z->key = key;
+    z->value = value;
+    z->left = z->right = NULL;
+    if (t->root == NULL)
+    {
+        z->color = 'B';
+        __atomic_store_n(&t->size, t->size + 1, __ATOMIC_RELAXED);
+        publish(t, z);
+        pthread_mutex_unlock(&t->lock);
+        return 1;
+    }
+
+    /*һ·¸*/
+    root = n = cow(t, t->root);
+    for (;;)
+    {
+        path[d++] = n;
+        if (key == n->key)
+        {
+            n->value = value;
+            node_free(t, z);
+            publish(t, root);
+            pthread_mutex_unlock(&t->lock);
+            return 0;
+        }
+        link = key < n->key ? &n->left : &n->right;
+        if (*link == NULL)
+            break;
+        n = *link = cow(t, *link);
+    }
+    z->color = 'R';         /*ĽڵǺɫ*/
+    *link = z;
+    path[d] = z;
+    insert_fixup(t, &root, path, d);
+    __atomic_store_n(&t->size, t->size + 1, __ATOMIC_RELAXED);
+    publish(t, root);
+    pthread_mutex_unlock(&t->lock);
+    return 1;
+}
+
+int32_t crbt_delete(crbt_t *t, int32_t key)
+{
+    crbt_node_t *path[CRBT_MAX_DEPTH], *root, *n, *y, *x, *parent, **link;
+    int32_t d = 0, red_child;
+
+    pthread_mutex_lock(&t->lock);
+    /*ȿûУûоͲø*/
+    for (n = t->root; n != NULL && n->key != key; )
+        n = key < n->key ? n->left : n->right;
+    if (n == NULL)
+    {
+        pthread_mutex_unlock(&t->lock);
+        return 0;
+    }
+    if (reserve(t) != 0)
+    {
+        pthread_mutex_unlock(&t->lock);
+        return -1;
+    }
+    t->gen++;
+
+    root = n = cow(t, t->root);
+    for (;;)
+    {
+        path[d++] = n;
+        if (key == n->key)
+            break;
+        link = key < n->key ? &n->left : &n->right;
+        n = *link = cow(t, *link);
+    }
+    /*ӾͰѺ̵ļֵɾ*/
+    if (n->left != NULL && n->right != NULL)
+    {
+        y = n->right = cow(t, n->right);
+        path[d++] = y;
+        while (y->left != NULL)
+        {
+            y = y->left = cow(t, y->left);
+            path[d++] = y;
+        }
+        n->key = y->key;
+        n->value = y->value;
+    }
+
+    /*yһxxӵyλϣyǺڵĶxǺģxĳɺɫ*/
+    y = path[--d];
+    x = y->left != NULL ? y->left : y->right;
+    red_child = is_red(x);
+    if (y->color == 'B' && red_child)
+    {
+        x = cow(t, x);
+        x->color = 'B';
+    }
+    parent = d > 0 ? path[d - 1] : NULL;
+    if (parent == NULL)
+        root = x;
+    else if (parent->left == y)
+        parent->left = x;
+    else
+        parent->right = x;
+    if (y->color == 'B' && !red_child)
+        delete_fixup(t, &root, path, d - 1, x);
+    /*y·ϣθƵģûж̼߳*/
+    node_free(t, y);
+    __atomic_store_n(&t->size, t->size - 1, __ATOMIC_RELAXED);
+    publish(t, root);
+    pthread_mutex_unlock(&t->lock);
+    return 1;
+}
+
+int32_t crbt_search(crbt_t *t, int32_t key, int64_t *value)
+{
+    CRbtReader *r = read_begin(t);
+    crbt_node_t *n = __atomic_load_n(&t->root, __ATOMIC_SEQ_CST);
+
+    while (n != NULL && n->key != key)
+        n = key < n->key ? n->left : n->right;
+    if (n != NULL && value != NULL)
+        *value = n->value;
+    read_end(t, r);
+    return n != NULL;
+}
+
+uint64_t crbt_range(crbt_t *t, int32_t lo, int32_t hi,
+                    int32_t (*visit)(int32_t key, int64_t value, void *arg), void *arg)
+{
+    crbt_node_t *stack[CRBT_MAX_DEPTH], *n;
+    CRbtReader *r = read_begin(t);
+    int32_t top = 0;
+    uint64_t count = 0;
+
+    /*ջǴӸ²СloûʵĽڵ*/
+    for (n = __atomic_load_n(&t->root, __ATOMIC_SEQ_CST); n != NULL; )
+    {
+        if (n->key >= lo)
+        {
+            stack[top++] = n;
+            n = n->left;
+        }
+        else
+            n = n->right;
+    }
+    while (top > 0)
+    {
+        n = stack[--top];
+        if (n->key > hi)
+            break;
+        count++;
+        if (visit != NULL && visit(n->key, n->value, arg))
+            break;
+        for (n = n->right; n != NULL; n = n->left)
+            stack[top++] = n;
+    }
+    read_end(t, r);
+    return count;
+}
+
+uint64_t crbt_size(crbt_t *t)
+{
+    return __atomic_load_n(&t->size, __ATOMIC_RELAXED);
+}
+
+/*غڸ߶ȣ-1ʾд*/
+static int32_t check_rec(const crbt_node_t *n, int64_t lo, int64_t hi, uint64_t *count)
+{
+    int32_t lh, rh;
+
+    if (n == NULL)
+        return 0;
+    if (n->key < lo || n->key > hi || (n->color != 'R' && n->color != 'B'))
+        return -1;
+    if (n->color == 'R' && (is_red(n->left) || is_red(n->right)))
+        return -1;
+    (*count)++;
+    lh = check_rec(n->left, lo, (int64_t)n->key - 1, count);
+    rh = check_rec(n->right, (int64_t)n->key + 1, hi, count);
+    if (lh < 0 || lh != rh)
+        return -1;
+    return lh + (n->color == 'B');
+}
+
+int32_t crbt_check(crbt_t *t)
+{
+    uint64_t count = 0;
+
+    if (is_red(t->root))
+        return -1;
+    if (check_rec(t->root, INT32_MIN, INT32_MAX, &count) < 0 || count != t->size)
+        return -1;
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,95 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ *ĺint32_tint64_tֵ
+ *дһСӸҪĵĵط·һ(path copying)תͱɫ
+ *    ڸƳĽڵһԭд¸תļ
+ *     rbt.c  LeftRotate/rightRotate/insertFixUp һֻûparentָ룬
+ *    ״Ӽµ·ȡ
+ *õԺ󿴵һٱĿգҲᱻд
+ *գľɽڵepochж߳̽ʱepochԺͷţ
+ *     big_data_algorithm/hash_table/chashtable.c һ
+ */
+
+#ifndef _CRBT_H_
+#define _CRBT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+typedef struct crbt_node{
+    int32_t key;
+    char color;             /*'R''B'rbt.cһ*/
+    uint64_t gen;           /*Ĵд︴ƳģԺepoch*/
+    int64_t value;
+    struct crbt_node *left;
+    struct crbt_node *right;
+} crbt_node_t;
+
+typedef struct crbt{
+    crbt_node_t *root;      /*ֱ߳Ӷ*/
+    pthread_mutex_t lock;   /*д*/
+    uint64_t gen;           /*дţgenͬĽڵθƵģֱӸ*/
+    uint64_t size;
+    crbt_node_t *free_list; /*leftֻд߳*/
+    uint32_t free_count;
+    crbt_node_t **garbage;  /*ûͷŵĽڵ*/
+    size_t garbage_n;
+    size_t garbage_cap;
+    size_t gc_next;         /*garbage_nôٻһ*/
+    uint64_t nodes;         /*ϵͳҪĽڵ*/
+} crbt_t;
+
+/*
+ *ܣһÿ
+ *ֵNULLʾڴ治
+ */
+crbt_t* crbt_create(void);
+
+/*٣ʱ߳ʹ*/
+void crbt_destroy(crbt_t *t);
+
+/*
+ *ܣkeyѾо滻value
+ *ֵ1룬0滻-1ڴ治()
+ */
+int32_t crbt_insert(crbt_t *t, int32_t key, int64_t value);
+
+/*
+ *ܣɾkey
+ *ֵ1ɾˣ0û-1ڴ治()
+ */
+int32_t crbt_delete(crbt_t *t, int32_t key);
+
+/*
+ *ܣң
+ *value ΪNULL
+ *ֵ1ҵ0û
+ */
+int32_t crbt_search(crbt_t *t, int32_t key, int64_t *value);
+
+/*
+ *ܣС˳[lo, hi]ļͬһ
+ *visit ط0ͣ£visitٶsearch/range
+ *ֵ˼
+ */
+uint64_t crbt_range(crbt_t *t, int32_t lo, int32_t hi,
+                    int32_t (*visit)(int32_t key, int64_t value, void *arg), void *arg);
+
+/*Ԫظ*/
+uint64_t crbt_size(crbt_t *t);
+
+/*
+ *ܣ򡢺ڵûк캢ӡڸ߶ȡsizeãʱд
+ *ֵ0-1д
+ */
+int32_t crbt_check(crbt_t *t);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
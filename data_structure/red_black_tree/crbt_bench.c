@@ -0,0 +1,193 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include "crbt.h"
+#include "../test_util.h"
+
+/*
+ *дٵ²ԣ1д̲߳ɾ132߳ң
+ *вͬһѴԱȡ
+ *д̰߳Ĵƽ࣬Ĭÿ50ζдһ(-r 0)
+ *ĺʺԪظ
+ *÷crbt_bench [-k ] [-d ÿֺ] [-r ÿдӦĶ] [-t ߳]
+ */
+
+#define MAX_READERS     64
+
+enum {
+    ENGINE_CONCURRENT,
+    ENGINE_LOCKED,
+};
+
+static const char *engine_name[] = {"crbt            ", "crbt+mutex      "};
+
+static uint32_t nkeys = 1000000;
+static int32_t duration_ms = 500;
+static int32_t ratio = 50;
+
+static crbt_t *tree;
+static pthread_mutex_t tree_lock = PTHREAD_MUTEX_INITIALIZER;
+static int32_t engine;
+static int32_t stop;
+
+/*ÿ߳Լļд̶߳ƽ*/
+typedef struct reader_arg{
+    uint64_t seed;
+    uint64_t reads;
+    uint64_t found;
+    pthread_t tid;
+} __attribute__((aligned(64))) reader_arg_t;
+
+static reader_arg_t readers[MAX_READERS];
+static int32_t nreaders;
+
+static void* reader_thread(void *data)
+{
+    reader_arg_t *arg = (reader_arg_t *)data;
+    uint64_t i, found = 0;
+    int32_t key;
+
+    for (i = 1; !__atomic_load_n(&stop, __ATOMIC_RELAXED); i++)
+    {
+        key = (int32_t)(xorshift(&arg->seed) % (2 * (uint64_t)nkeys));
+        if (engine == ENGINE_CONCURRENT)
+        {
+            found += crbt_search(tree, key, NULL);
+        }
+        else
+        {
+            pthread_mutex_lock(&tree_lock);
+            found += crbt_search(tree, key, NULL);
+            pthread_mutex_unlock(&tree_lock);
+        }
+        if ((i & 255) == 0)
+            __atomic_store_n(&arg->reads, i, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&arg->reads, i - 1, __ATOMIC_RELAXED);
+    arg->found = found;
+    return NULL;
+}
+
+static uint64_t total_reads(void)
+{
+    uint64_t sum = 0;
+    int32_t i;
+
+    for (i = 0; i < nreaders; i++)
+        sum += __atomic_load_n(&readers[i].reads, __ATOMIC_RELAXED);
+    return sum;
+}
+
+/*һɾһԪظ*/
+static uint64_t writer_loop(double end)
+{
+    uint64_t seed = 0x2545F4914F6CDD1DULL, writes = 0;
+    int32_t key;
+
+    while (now_sec() < end)
+    {
+        if (ratio > 0 && writes * ratio > total_reads())
+        {
+            sched_yield();
+            continue;
+        }
+        key = (int32_t)(xorshift(&seed) % (2 * (uint64_t)nkeys));
+        if (engine == ENGINE_LOCKED)
+            pthread_mutex_lock(&tree_lock);
+        if (writes & 1)
+            crbt_delete(tree, key);
+        else
+            crbt_insert(tree, key, key);
+        if (engine == ENGINE_LOCKED)
+            pthread_mutex_unlock(&tree_lock);
+        writes++;
+    }
+    return writes;
+}
+
+static int32_t run_bench(int32_t eng, int32_t n)
+{
+    uint64_t writes, reads, seed = 88172645463325252ULL;
+    double t;
+    int32_t i, ok;
+
+    engine = eng;
+    nreaders = n;
+    tree = crbt_create();
+    for (i = 0; i < (int32_t)nkeys; i++)
+        crbt_insert(tree, (int32_t)(xorshift(&seed) % (2 * (uint64_t)nkeys)), i);
+
+    stop = 0;
+    memset(readers, 0, sizeof(readers));
+    t = now_sec();
+    for (i = 0; i < nreaders; i++)
+    {
+        readers[i].seed = 0x9E3779B97F4A7C15ULL * (i + 1);
+        pthread_create(&readers[i].tid, NULL, reader_thread, &readers[i]);
+    }
+    writes = writer_loop(t + duration_ms / 1000.0);
+    __atomic_store_n(&stop, 1, __ATOMIC_RELAXED);
+    for (i = 0; i < nreaders; i++)
+        pthread_join(readers[i].tid, NULL);
+    t = now_sec() - t;
+    reads = total_reads();
+
+    ok = crbt_check(tree) == 0;
+    printf("%s readers %2d: %8.2f M reads/s %8.1f K writes/s, %llu nodes for %llu keys, %s\n",
+           engine_name[eng], nreaders, reads / t / 1e6, writes / t / 1e3,
+           (unsigned long long)tree->nodes, (unsigned long long)crbt_size(tree),
+           ok ? "tree ok" : "TREE BROKEN");
+    crbt_destroy(tree);
+    return ok ? 0 : -1;
+}
+
+int main(int argc, char *argv[])
+{
+    int32_t max_readers = 32, n, eng, ret = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "k:d:r:t:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'k':
+            nkeys = strtoul(optarg, NULL, 0);
+            break;
+        case 'd':
+            duration_ms = atoi(optarg);
+            break;
+        case 'r':
+            ratio = atoi(optarg);
+            break;
+        case 't':
+            max_readers = atoi(optarg);
+            break;
+        default:
+            nkeys = 0;
+        }
+    }
+    if (nkeys == 0 || nkeys > INT32_MAX / 2 || duration_ms <= 0 || ratio < 0 ||
+        max_readers <= 0 || max_readers > MAX_READERS)
+    {
+        printf("usage: %s [-k keys] [-d duration_ms] [-r reads_per_write] [-t max_readers]\n",
+               argv[0]);
+        return -1;
+    }
+
+    printf("%u keys, %d ms per run, %d reads per write, %ld cpus\n", nkeys, duration_ms,
+           ratio, sysconf(_SC_NPROCESSORS_ONLN));
+    for (n = 1; n <= max_readers; n *= 2)
+    {
+        for (eng = ENGINE_CONCURRENT; eng <= ENGINE_LOCKED; eng++)
+        {
+            if (run_bench(eng, n) != 0)
+                ret = 1;
+        }
+    }
+    return ret;
+}
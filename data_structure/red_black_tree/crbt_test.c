@@ -0,0 +1,364 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include "crbt.h"
+#include "../test_util.h"
+
+/*
+ *̣߳ɾ飬գһһ
+ *̣߳żһֱڣдֻ߳ɾдżֵ
+ *̲߳ͣزżɨ䣬ÿζҪһµĿ
+ */
+
+#define RANGE   4000    /*ȡ[-RANGE/2, RANGE/2)*/
+
+struct scan {
+    const int8_t *present;
+    const int64_t *values;
+    int32_t next;           /*һӦÿļ*/
+    int32_t bad;
+};
+
+static int32_t scan_visit(int32_t key, int64_t value, void *arg)
+{
+    struct scan *s = (struct scan *)arg;
+
+    while (s->next < key && !s->present[s->next + RANGE / 2])
+        s->next++;
+    if (key != s->next || value != s->values[key + RANGE / 2])
+    {
+        s->bad = 1;
+        return 1;
+    }
+    s->next++;
+    return 0;
+}
+
+static void compare(crbt_t *t, const int8_t *present, const int64_t *values)
+{
+    struct scan s;
+    int32_t lo, hi, i;
+    uint64_t n = 0, want = 0;
+
+    CHECK(crbt_check(t) == 0, "check failed, size %llu", (unsigned long long)crbt_size(t));
+    for (i = 0; i < RANGE; i++)
+        n += present[i];
+    CHECK(n == crbt_size(t), "size %llu want %llu", (unsigned long long)crbt_size(t),
+          (unsigned long long)n);
+
+    lo = (int32_t)(xorshift64() % RANGE) - RANGE / 2;
+    hi = lo + (int32_t)(xorshift64() % (RANGE / 4));
+    if (hi >= RANGE / 2)
+        hi = RANGE / 2 - 1;
+    for (i = lo; i <= hi; i++)
+        want += present[i + RANGE / 2];
+    s.present = present;
+    s.values = values;
+    s.next = lo;
+    s.bad = 0;
+    n = crbt_range(t, lo, hi, scan_visit, &s);
+    CHECK(!s.bad && n == want, "range [%d, %d] got %llu want %llu", lo, hi,
+          (unsigned long long)n, (unsigned long long)want);
+    CHECK(crbt_range(t, INT32_MIN, INT32_MAX, NULL, NULL) == crbt_size(t), "full range");
+}
+
+static void test_random(void)
+{
+    static int8_t present[RANGE];
+    static int64_t values[RANGE];
+    crbt_t *t = crbt_create();
+    uint32_t i, slot, op;
+    int32_t key, ret;
+    int64_t value;
+
+    memset(present, 0, sizeof(present));
+    for (i = 0; i < 400000; i++)
+    {
+        slot = xorshift64() % RANGE;
+        key = (int32_t)slot - RANGE / 2;
+        /*ǰһ壬һɾȳȥ*/
+        op = xorshift64() % 100;
+        if (op < (i < 200000 ? 60 : 30))
+        {
+            value = (int64_t)xorshift64();
+            ret = crbt_insert(t, key, value);
+            if (ret != !present[slot])
+            {
+                printf("insert %d returned %d\n", key, ret);
+                failed++;
+                break;
+            }
+            present[slot] = 1;
+            values[slot] = value;
+        }
+        else if (op < 90)
+        {
+            ret = crbt_delete(t, key);
+            if (ret != present[slot])
+            {
+                printf("delete %d returned %d\n", key, ret);
+                failed++;
+                break;
+            }
+            present[slot] = 0;
+        }
+        else
+        {
+            ret = crbt_search(t, key, &value);
+            if (ret != present[slot] || (ret && value != values[slot]))
+            {
+                printf("search %d returned %d\n", key, ret);
+                failed++;
+                break;
+            }
+        }
+        if (i % 1000 == 0)
+            compare(t, present, values);
+    }
+    compare(t, present, values);
+
+    for (slot = 0; slot < RANGE; slot++)
+        crbt_delete(t, (int32_t)slot - RANGE / 2);
+    if (crbt_size(t) != 0 || t->root != NULL || crbt_check(t) != 0)
+    {
+        printf("tree not empty after deleting everything\n");
+        failed++;
+    }
+    crbt_destroy(t);
+}
+
+/*˳룬ɾ·*/
+static void test_order(int32_t step)
+{
+    crbt_t *t = crbt_create();
+    uint32_t n = 200000, i, j, tmp, *perm;
+    int32_t key;
+
+    for (i = 0; i < n; i++)
+        crbt_insert(t, step > 0 ? (int32_t)i : (int32_t)(n - i), i);
+    if (crbt_check(t) != 0 || crbt_size(t) != n)
+    {
+        printf("order %d: check failed\n", step);
+        failed++;
+    }
+    perm = (uint32_t *)malloc(n * sizeof(uint32_t));
+    for (i = 0; i < n; i++)
+        perm[i] = i;
+    for (i = n - 1; i > 0; i--)
+    {
+        j = xorshift64() % (i + 1);
+        tmp = perm[i];
+        perm[i] = perm[j];
+        perm[j] = tmp;
+    }
+    for (i = 0; i < n; i++)
+    {
+        key = step > 0 ? (int32_t)perm[i] : (int32_t)(n - perm[i]);
+        if (crbt_delete(t, key) != 1)
+        {
+            printf("order %d: delete %d failed\n", step, key);
+            failed++;
+            break;
+        }
+        if (i % 20000 == 0 && crbt_check(t) != 0)
+        {
+            printf("order %d: check failed after %u deletes\n", step, i);
+            failed++;
+            break;
+        }
+    }
+    if (crbt_size(t) != 0)
+    {
+        printf("order %d: tree not empty\n", step);
+        failed++;
+    }
+    free(perm);
+    crbt_destroy(t);
+}
+
+#define CONC_KEYS       20000   /*ȡ[0, CONC_KEYS)żһֱ*/
+#define CONC_READERS    4
+
+static crbt_t *conc_tree;
+static int32_t conc_stop;
+
+struct reader_arg {
+    uint64_t seed;
+    uint64_t reads;
+    int32_t bad;
+    pthread_t tid;
+};
+
+struct even_scan {
+    int32_t last;
+    int32_t evens;
+    int32_t bad;
+};
+
+static int32_t even_visit(int32_t key, int64_t value, void *arg)
+{
+    struct even_scan *s = (struct even_scan *)arg;
+
+    if (key <= s->last || (key % 2 == 0 && value != key * 10))
+        s->bad = 1;
+    s->last = key;
+    s->evens += key % 2 == 0;
+    return s->bad;
+}
+
+static void *reader_thread(void *data)
+{
+    struct reader_arg *arg = (struct reader_arg *)data;
+    struct even_scan s;
+    int32_t key, lo;
+    int64_t value;
+
+    while (!__atomic_load_n(&conc_stop, __ATOMIC_RELAXED))
+    {
+        key = (int32_t)(xorshift(&arg->seed) % (CONC_KEYS / 2)) * 2;
+        if (!crbt_search(conc_tree, key, &value) || value != key * 10)
+            arg->bad++;
+        arg->reads++;
+        if (arg->reads % 64 == 0)
+        {
+            /*[lo, lo+199]100ż*/
+            lo = key < CONC_KEYS - 200 ? key : CONC_KEYS - 200;
+            s.last = lo - 1;
+            s.evens = 0;
+            s.bad = 0;
+            crbt_range(conc_tree, lo, lo + 199, even_visit, &s);
+            if (s.bad || s.evens != 100)
+                arg->bad++;
+        }
+    }
+    return NULL;
+}
+
+static void test_concurrent(void)
+{
+    struct reader_arg args[CONC_READERS];
+    uint64_t reads = 0;
+    int32_t i, key;
+
+    conc_tree = crbt_create();
+    for (key = 0; key < CONC_KEYS; key += 2)
+        crbt_insert(conc_tree, key, key * 10);
+    conc_stop = 0;
+    memset(args, 0, sizeof(args));
+    for (i = 0; i < CONC_READERS; i++)
+    {
+        args[i].seed = 0x9E3779B97F4A7C15ULL * (i + 1);
+        pthread_create(&args[i].tid, NULL, reader_thread, &args[i]);
+    }
+
+    for (i = 0; i < 300000; i++)
+    {
+        key = (int32_t)(xorshift64() % CONC_KEYS);
+        if (key % 2 == 0)
+            crbt_insert(conc_tree, key, key * 10);
+        else if (xorshift64() & 1)
+            crbt_insert(conc_tree, key, -key);
+        else
+            crbt_delete(conc_tree, key);
+    }
+    __atomic_store_n(&conc_stop, 1, __ATOMIC_RELAXED);
+    for (i = 0; i < CONC_READERS; i++)
+    {
+        pthread_join(args[i].tid, NULL);
+        reads += args[i].reads;
+        if (args[i].bad)
+        {
+            printf("concurrent: reader %d saw %d bad snapshots\n", i, args[i].bad);
+            failed++;
+        }
+    }
+    if (crbt_check(conc_tree) != 0)
+    {
+        printf("concurrent: check failed\n");
+        failed++;
+    }
+    printf("concurrent: %llu reads during 300000 writes, %llu nodes for %llu keys\n",
+           (unsigned long long)reads, (unsigned long long)conc_tree->nodes,
+           (unsigned long long)crbt_size(conc_tree));
+    crbt_destroy(conc_tree);
+}
+
+/*
+ *visitǶsearch/rangeдһgc
+ *Ƕ׵Ķ㻹ܱյĽڵ㲻ܱ
+ */
+struct nested_scan {
+    crbt_t *t;
+    struct even_scan outer;
+    int32_t nested;
+};
+
+static int32_t nested_visit(int32_t key, int64_t value, void *arg)
+{
+    struct nested_scan *s = (struct nested_scan *)arg;
+    struct even_scan inner;
+    int64_t v;
+    int32_t i, odd;
+
+    if (even_visit(key, value, &s->outer))
+        return 1;
+    if (key % 1000 != 0)
+        return 0;
+
+    s->nested++;
+    if (!crbt_search(s->t, key, &v) || v != key * 10)
+        s->outer.bad = 1;
+    inner.last = key - 1;
+    inner.evens = 0;
+    inner.bad = 0;
+    crbt_range(s->t, key, key + 199, even_visit, &inner);
+    if (inner.bad || inner.evens != 100)
+        s->outer.bad = 1;
+
+    for (i = 0; i < 500; i++)
+    {
+        odd = (int32_t)(xorshift64() % (CONC_KEYS / 2)) * 2 + 1;
+        crbt_insert(s->t, odd, -odd);
+        crbt_delete(s->t, odd);
+    }
+    return s->outer.bad;
+}
+
+static void test_nested(void)
+{
+    struct nested_scan s;
+    int32_t key;
+
+    s.t = crbt_create();
+    for (key = 0; key < CONC_KEYS; key += 2)
+        crbt_insert(s.t, key, key * 10);
+    s.outer.last = -1;
+    s.outer.evens = 0;
+    s.outer.bad = 0;
+    s.nested = 0;
+    crbt_range(s.t, 0, CONC_KEYS - 1, nested_visit, &s);
+    CHECK(!s.outer.bad && s.outer.evens == CONC_KEYS / 2,
+          "nested: outer scan saw %d of %d keys, bad %d", s.outer.evens, CONC_KEYS / 2,
+          s.outer.bad);
+    CHECK(crbt_check(s.t) == 0 && crbt_size(s.t) == CONC_KEYS / 2, "nested: check failed");
+    printf("nested: %d nested reads inside one range, %llu nodes\n", s.nested,
+           (unsigned long long)s.t->nodes);
+    crbt_destroy(s.t);
+}
+
+int main(void)
+{
+    test_random();
+    test_order(1);
+    test_order(-1);
+    test_concurrent();
+    test_nested();
+
+    if (failed)
+        printf("%d failed\n", failed);
+    else
+        printf("all passed\n");
+    return failed != 0;
+}
@@ -0,0 +1,653 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "sort.h"
+
+#define INSERTION_THRESHOLD     24      /*Сò*/
+#define NINTHER_THRESHOLD       128     /*ȡ*/
+#define PARTIAL_INSERTION_LIMIT 8       /*ʱŲô*/
+#define BLOCK_SIZE              64      /*޷֧ÿԪ*/
+#define RADIX_MIN               64      /*С򲻻㣬ò(Ҳȶ)*/
+#define PARALLEL_MIN            65536   /*ÿ߳ô*/
+#define MAX_THREADS             64
+
+#define LESS_NUM(x, y)  ((x) < (y))
+#define LESS_KEY(x, y)  ((x).key < (y).key)
+
+#define KEY_U32(x)      ((uint32_t)(x))
+#define KEY_I32(x)      ((uint32_t)(x) ^ 0x80000000U)
+#define KEY_U64(x)      ((uint64_t)(x))
+#define KEY_I64(x)      ((uint64_t)(x) ^ 0x8000000000000000ULL)
+#define KEY_KV(x)       ((x).key)
+
+static int32_t log2_floor(size_t n)
+{
+    int32_t log = 0;
+
+    while (n >>= 1)
+        log++;
+    return log;
+}
+
+
+/************************************************************
+ * ̣߳ÿһ߳һjoin
+ ************************************************************/
+
+typedef struct job{
+    void (*fn)(void *);
+    void *arg;
+    pthread_t tid;
+} job_t;
+
+static void* job_main(void *arg)
+{
+    job_t *job = (job_t *)arg;
+
+    job->fn(job->arg);
+    return NULL;
+}
+
+/*0ڵǰ̵߳߳Ҳڵǰ߳*/
+static void run_jobs(job_t *jobs, int32_t n)
+{
+    int32_t i, started[MAX_THREADS] = {0};
+
+    for (i = 1; i < n; i++)
+        started[i] = pthread_create(&jobs[i].tid, NULL, job_main, &jobs[i]) == 0;
+    jobs[0].fn(jobs[0].arg);
+    for (i = 1; i < n; i++)
+    {
+        if (started[i])
+            pthread_join(jobs[i].tid, NULL);
+        else
+            jobs[i].fn(jobs[i].arg);
+    }
+}
+
+
+/************************************************************
+ * pdqsortSΪͺ׺TΪͣLESSȽ
+ ************************************************************/
+
+#define PDQSORT_IMPL(S, T, LESS)                                              \
+                                                                              \
+static void insertion_##S(T *begin, T *end)                                   \
+{                                                                             \
+    T *cur, *sift, tmp;                                                       \
+                                                                              \
+    if (begin == end)                                                         \
+        return;                                                               \
+    for (cur = begin + 1; cur != end; cur++)                                  \
+    {                                                                         \
+        sift = cur;                                                           \
+        if (LESS(*sift, *(sift - 1)))                                         \
+        {                                                                     \
+            tmp = *sift;                                                      \
+            do {                                                              \
+                *sift = *(sift - 1);                                          \
+                sift--;                                                       \
+            } while (sift != begin && LESS(tmp, *(sift - 1)));                \
+            *sift = tmp;                                                      \
+        }                                                                     \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+/*beginǰһԪصڱ*/                             \
+static void unguarded_insertion_##S(T *begin, T *end)                         \
+{                                                                             \
+    T *cur, *sift, tmp;                                                       \
+                                                                              \
+    if (begin == end)                                                         \
+        return;                                                               \
+    for (cur = begin + 1; cur != end; cur++)                                  \
+    {                                                                         \
+        sift = cur;                                                           \
+        if (LESS(*sift, *(sift - 1)))                                         \
+        {                                                                     \
+            tmp = *sift;                                                      \
+            do {                                                              \
+                *sift = *(sift - 1);                                          \
+                sift--;                                                       \
+            } while (LESS(tmp, *(sift - 1)));                                 \
+            *sift = tmp;                                                      \
+        }                                                                     \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+/*Ų̫ͷ0ź÷1*/                                          \
+static int32_t partial_insertion_##S(T *begin, T *end)                        \
+{                                                                             \
+    T *cur, *sift, tmp;                                                       \
+    size_t limit = 0;                                                         \
+                                                                              \
+    if (begin == end)                                                         \
+        return 1;                                                             \
+    for (cur = begin + 1; cur != end; cur++)                                  \
+    {                                                                         \
+        sift = cur;                                                           \
+        if (LESS(*sift, *(sift - 1)))                                         \
+        {                                                                     \
+            tmp = *sift;                                                      \
+            do {                                                              \
+                *sift = *(sift - 1);                                          \
+                sift--;                                                       \
+            } while (sift != begin && LESS(tmp, *(sift - 1)));                \
+            *sift = tmp;                                                      \
+            limit += cur - sift;                                              \
+        }                                                                     \
+        if (limit > PARTIAL_INSERTION_LIMIT)                                  \
+            return 0;                                                         \
+    }                                                                         \
+    return 1;                                                                 \
+}                                                                             \
+                                                                              \
+static inline void swap_##S(T *a, T *b)                                       \
+{                                                                             \
+    T tmp = *a;                                                               \
+    *a = *b;                                                                  \
+    *b = tmp;                                                                 \
+}                                                                             \
+                                                                              \
+static inline void sort2_##S(T *a, T *b)                                      \
+{                                                                             \
+    if (LESS(*b, *a))                                                         \
+        swap_##S(a, b);                                                       \
+}                                                                             \
+                                                                              \
+static inline void sort3_##S(T *a, T *b, T *c)                                \
+{                                                                             \
+    sort2_##S(a, b);                                                          \
+    sort2_##S(b, c);                                                          \
+    sort2_##S(a, b);                                                          \
+}                                                                             \
+                                                                              \
+static void sift_down_##S(T *a, size_t i, size_t n)                           \
+{                                                                             \
+    T tmp = a[i];                                                             \
+    size_t j;                                                                 \
+                                                                              \
+    while ((j = 2 * i + 1) < n)                                               \
+    {                                                                         \
+        if (j + 1 < n && LESS(a[j], a[j + 1]))                                \
+            j++;                                                              \
+        if (!LESS(tmp, a[j]))                                                 \
+            break;                                                            \
+        a[i] = a[j];                                                          \
+        i = j;                                                                \
+    }                                                                         \
+    a[i] = tmp;                                                               \
+}                                                                             \
+                                                                              \
+static void heapsort_##S(T *a, size_t n)                                      \
+{                                                                             \
+    size_t i;                                                                 \
+                                                                              \
+    for (i = n / 2; i > 0; i--)                                               \
+        sift_down_##S(a, i - 1, n);                                           \
+    for (i = n - 1; i > 0; i--)                                               \
+    {                                                                         \
+        swap_##S(a, a + i);                                                   \
+        sift_down_##S(a, 0, i);                                               \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+/*µ±ɶԽʱתȦƶһд*/              \
+static inline void swap_offsets_##S(T *first, T *last,                        \
+                                    const uint8_t *offsets_l,                 \
+                                    const uint8_t *offsets_r,                 \
+                                    size_t num, int32_t use_swaps)            \
+{                                                                             \
+    T *l, *r, tmp;                                                            \
+    size_t i;                                                                 \
+                                                                              \
+    if (use_swaps)                                                            \
+    {                                                                         \
+        for (i = 0; i < num; i++)                                             \
+            swap_##S(first + offsets_l[i], last - offsets_r[i]);              \
+    }                                                                         \
+    else if (num > 0)                                                         \
+    {                                                                         \
+        l = first + offsets_l[0];                                             \
+        r = last - offsets_r[0];                                              \
+        tmp = *l;                                                             \
+        *l = *r;                                                              \
+        for (i = 1; i < num; i++)                                             \
+        {                                                                     \
+            l = first + offsets_l[i];                                         \
+            *r = *l;                                                          \
+            r = last - offsets_r[i];                                          \
+            *l = *r;                                                          \
+        }                                                                     \
+        *r = tmp;                                                             \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+/*                                                                            \
+ **beginΪķұߣλã*alreadyΪ1ʾͷֺ \
+ *ȽϽ߷֧ȰһŴߵ±(num += ȽϽ)һ𽻻 \
+ */                                                                           \
+static T* partition_right_##S(T *begin, T *end, int32_t *already)             \
+{                                                                             \
+    uint8_t offsets_l[BLOCK_SIZE], offsets_r[BLOCK_SIZE];                     \
+    T pivot = *begin, *first = begin, *last = end, *pivot_pos;                \
+    T *offsets_l_base, *offsets_r_base;                                       \
+    size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0, num;               \
+    size_t unknown, left_split, right_split, i;                               \
+                                                                              \
+    while (LESS(*++first, pivot))                                             \
+        ;                                                                     \
+    if (first - 1 == begin)                                                   \
+        while (first < last && !LESS(*--last, pivot))                        \
+            ;                                                                 \
+    else                                                                      \
+        while (!LESS(*--last, pivot))                                         \
+            ;                                                                 \
+    *already = first >= last;                                                 \
+    if (!*already)                                                            \
+    {                                                                         \
+        swap_##S(first, last);                                                \
+        first++;                                                              \
+        offsets_l_base = first;                                               \
+        offsets_r_base = last;                                                \
+        while (first < last)                                                  \
+        {                                                                     \
+            unknown = last - first;                                           \
+            left_split = num_l == 0 ? (num_r == 0 ? unknown / 2 : unknown) : 0; \
+            right_split = num_r == 0 ? unknown - left_split : 0;              \
+            if (left_split >= BLOCK_SIZE)                                     \
+                left_split = BLOCK_SIZE;                                      \
+            if (right_split >= BLOCK_SIZE)                                    \
+                right_split = BLOCK_SIZE;                                     \
+            for (i = 0; i < left_split; i++)                                  \
+            {                                                                 \
+                offsets_l[num_l] = (uint8_t)i;                                \
+                num_l += !LESS(*first, pivot);                                \
+                first++;                                                      \
+            }                                                                 \
+            for (i = 0; i < right_split; i++)                                 \
+            {                                                                 \
+                offsets_r[num_r] = (uint8_t)(i + 1);                          \
+                num_r += LESS(*--last, pivot);                                \
+            }                                                                 \
+            num = num_l < num_r ? num_l : num_r;                              \
+            swap_offsets_##S(offsets_l_base, offsets_r_base,                  \
+                             offsets_l + start_l, offsets_r + start_r,        \
+                             num, num_l == num_r);                            \
+            num_l -= num;                                                     \
+            num_r -= num;                                                     \
+            start_l += num;                                                   \
+            start_r += num;                                                   \
+            if (num_l == 0)                                                   \
+            {                                                                 \
+                start_l = 0;                                                  \
+                offsets_l_base = first;                                       \
+            }                                                                 \
+            if (num_r == 0)                                                   \
+            {                                                                 \
+                start_r = 0;                                                  \
+                offsets_r_base = last;                                        \
+            }                                                                 \
+        }                                                                     \
+        /*ʣһ߻ûģŲм*/                                      \
+        if (num_l)                                                            \
+        {                                                                     \
+            while (num_l--)                                                   \
+                swap_##S(offsets_l_base + offsets_l[start_l + num_l], --last); \
+            first = last;                                                     \
+        }                                                                     \
+        if (num_r)                                                            \
+        {                                                                     \
+            while (num_r--)                                                   \
+            {                                                                 \
+                swap_##S(offsets_r_base - offsets_r[start_r + num_r], first); \
+                first++;                                                      \
+            }                                                                 \
+            last = first;                                                     \
+        }                                                                     \
+    }                                                                         \
+    pivot_pos = first - 1;                                                    \
+    *begin = *pivot_pos;                                                      \
+    *pivot_pos = pivot;                                                       \
+    return pivot_pos;                                                         \
+}                                                                             \
+                                                                              \
+/*߽ʱãĶߣЩԺ*/              \
+static T* partition_left_##S(T *begin, T *end)                                \
+{                                                                             \
+    T pivot = *begin, *first = begin, *last = end;                            \
+                                                                              \
+    while (LESS(pivot, *--last))                                              \
+        ;                                                                     \
+    if (last + 1 == end)                                                      \
+        while (first < last && !LESS(pivot, *++first))                       \
+            ;                                                                 \
+    else                                                                      \
+        while (!LESS(pivot, *++first))                                        \
+            ;                                                                 \
+    while (first < last)                                                      \
+    {                                                                         \
+        swap_##S(first, last);                                                \
+        while (LESS(pivot, *--last))                                          \
+            ;                                                                 \
+        while (!LESS(pivot, *++first))                                        \
+            ;                                                                 \
+    }                                                                         \
+    *begin = *last;                                                           \
+    *last = pivot;                                                            \
+    return last;                                                              \
+}                                                                             \
+                                                                              \
+static void pdqsort_##S(T *begin, T *end, int32_t bad_allowed,                \
+                        int32_t leftmost)                                     \
+{                                                                             \
+    size_t size, s2, l_size, r_size;                                          \
+    int32_t already;                                                          \
+    T *pivot_pos;                                                             \
+                                                                              \
+    for (;;)                                                                  \
+    {                                                                         \
+        size = end - begin;                                                   \
+        if (size < INSERTION_THRESHOLD)                                       \
+        {                                                                     \
+            if (leftmost)                                                     \
+                insertion_##S(begin, end);                                    \
+            else                                                              \
+                unguarded_insertion_##S(begin, end);                          \
+            return;                                                           \
+        }                                                                     \
+        s2 = size / 2;                                                        \
+        if (size > NINTHER_THRESHOLD)                                         \
+        {                                                                     \
+            sort3_##S(begin, begin + s2, end - 1);                            \
+            sort3_##S(begin + 1, begin + (s2 - 1), end - 2);                  \
+            sort3_##S(begin + 2, begin + (s2 + 1), end - 3);                  \
+            sort3_##S(begin + (s2 - 1), begin + s2, begin + (s2 + 1));        \
+            swap_##S(begin, begin + s2);                                      \
+        }                                                                     \
+        else                                                                  \
+            sort3_##S(begin + s2, begin, end - 1);                            \
+                                                                              \
+        /*߽Сᣬ˵ظģһη*/            \
+        if (!leftmost && !LESS(*(begin - 1), *begin))                         \
+        {                                                                     \
+            begin = partition_left_##S(begin, end) + 1;                       \
+            continue;                                                         \
+        }                                                                     \
+                                                                              \
+        pivot_pos = partition_right_##S(begin, end, &already);                \
+        l_size = pivot_pos - begin;                                           \
+        r_size = end - (pivot_pos + 1);                                       \
+        if (l_size < size / 8 || r_size < size / 8)                           \
+        {                                                                     \
+            /*ֵ̫ƫͶ򣬷Ҽ*/              \
+            if (--bad_allowed == 0)                                           \
+            {                                                                 \
+                heapsort_##S(begin, end - begin);                             \
+                return;                                                       \
+            }                                                                 \
+            if (l_size >= INSERTION_THRESHOLD)                                \
+            {                                                                 \
+                swap_##S(begin, begin + l_size / 4);                          \
+                swap_##S(pivot_pos - 1, pivot_pos - l_size / 4);              \
+                if (l_size > NINTHER_THRESHOLD)                               \
+                {                                                             \
+                    swap_##S(begin + 1, begin + (l_size / 4 + 1));            \
+                    swap_##S(begin + 2, begin + (l_size / 4 + 2));            \
+                    swap_##S(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));    \
+                    swap_##S(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));    \
+                }                                                             \
+            }                                                                 \
+            if (r_size >= INSERTION_THRESHOLD)                                \
+            {                                                                 \
+                swap_##S(pivot_pos + 1, pivot_pos + (1 + r_size / 4));        \
+                swap_##S(end - 1, end - r_size / 4);                          \
+                if (r_size > NINTHER_THRESHOLD)                               \
+                {                                                             \
+                    swap_##S(pivot_pos + 2, pivot_pos + (2 + r_size / 4));    \
+                    swap_##S(pivot_pos + 3, pivot_pos + (3 + r_size / 4));    \
+                    swap_##S(end - 2, end - (1 + r_size / 4));                \
+                    swap_##S(end - 3, end - (2 + r_size / 4));                \
+                }                                                             \
+            }                                                                 \
+        }                                                                     \
+        else if (already && partial_insertion_##S(begin, pivot_pos) &&        \
+                 partial_insertion_##S(pivot_pos + 1, end))                   \
+            return; /*Ͳ*/                                      \
+                                                                              \
+        pdqsort_##S(begin, pivot_pos, bad_allowed, leftmost);                 \
+        begin = pivot_pos + 1;                                                \
+        leftmost = 0;                                                         \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+void sort_##S(T *a, size_t n)                                                 \
+{                                                                             \
+    if (n > 1)                                                                \
+        pdqsort_##S(a, a + n, log2_floor(n), 1);                              \
+}
+
+
+/************************************************************
+ * LSDKEYȡ޷ŵļBITSΪλ
+ ************************************************************/
+
+#define RADIX_IMPL(S, T, KEY, BITS)                                           \
+int32_t sort_radix_##S(T *a, size_t n)                                        \
+{                                                                             \
+    size_t counts[BITS / 8][256], offsets[256], i, sum;                       \
+    int32_t d, digits = BITS / 8, shift;                                      \
+    T *buf, *src = a, *dst, *tmp;                                             \
+                                                                              \
+    if (n < RADIX_MIN)                                                        \
+    {                                                                         \
+        insertion_##S(a, a + n);                                              \
+        return 0;                                                             \
+    }                                                                         \
+    buf = (T *)malloc(n * sizeof(T));                                         \
+    if (buf == NULL)                                                          \
+        return -1;                                                            \
+    dst = buf;                                                                \
+    memset(counts, 0, sizeof(counts));                                        \
+    for (i = 0; i < n; i++)                                                   \
+    {                                                                         \
+        for (d = 0; d < digits; d++)                                          \
+            counts[d][(KEY(a[i]) >> (d * 8)) & 0xff]++;                       \
+    }                                                                         \
+    for (d = 0; d < digits; d++)                                              \
+    {                                                                         \
+        shift = d * 8;                                                        \
+        /*һλȫһ˲*/                                          \
+        if (counts[d][(KEY(a[0]) >> shift) & 0xff] == n)                      \
+            continue;                                                         \
+        for (i = 0, sum = 0; i < 256; i++)                                    \
+        {                                                                     \
+            offsets[i] = sum;                                                 \
+            sum += counts[d][i];                                              \
+        }                                                                     \
+        for (i = 0; i < n; i++)                                               \
+            dst[offsets[(KEY(src[i]) >> shift) & 0xff]++] = src[i];           \
+        tmp = src;                                                            \
+        src = dst;                                                            \
+        dst = tmp;                                                            \
+    }                                                                         \
+    if (src != a)                                                             \
+        memcpy(a, src, n * sizeof(T));                                        \
+    free(buf);                                                                \
+    return 0;                                                                 \
+}
+
+
+/************************************************************
+ * ̹߳鲢
+ ************************************************************/
+
+#define PARALLEL_IMPL(S, T, LESS)                                             \
+                                                                              \
+typedef struct chunk_##S{                                                     \
+    T *a;                                                                     \
+    size_t n;                                                                 \
+} chunk_##S##_t;                                                              \
+                                                                              \
+static void sort_chunk_##S(void *arg)                                         \
+{                                                                             \
+    chunk_##S##_t *c = (chunk_##S##_t *)arg;                                  \
+                                                                              \
+    sort_##S(c->a, c->n);                                                     \
+}                                                                             \
+                                                                              \
+/*ab鲢ǰkмaʱaǰ*/                               \
+static size_t co_rank_##S(size_t k, const T *a, size_t m, const T *b,         \
+                          size_t n)                                           \
+{                                                                             \
+    size_t lo = k > n ? k - n : 0, hi = k < m ? k : m, mid;                   \
+                                                                              \
+    while (lo < hi)                                                           \
+    {                                                                         \
+        mid = lo + (hi - lo + 1) / 2;                                         \
+        if (!LESS(b[k - mid], a[mid - 1]))                                    \
+            lo = mid;                                                         \
+        else                                                                  \
+            hi = mid - 1;                                                     \
+    }                                                                         \
+    return lo;                                                                \
+}                                                                             \
+                                                                              \
+typedef struct merge_##S{                                                     \
+    const T *a;                                                               \
+    size_t m;                                                                 \
+    const T *b;                                                               \
+    size_t n;                                                                 \
+    T *dst;                                                                   \
+    size_t begin, end;      /*[begin, end)*/                      \
+} merge_##S##_t;                                                              \
+                                                                              \
+static void merge_part_##S(void *arg)                                         \
+{                                                                             \
+    merge_##S##_t *p = (merge_##S##_t *)arg;                                  \
+    size_t i = co_rank_##S(p->begin, p->a, p->m, p->b, p->n);                 \
+    size_t i_end = co_rank_##S(p->end, p->a, p->m, p->b, p->n);               \
+    size_t j = p->begin - i, j_end = p->end - i_end;                          \
+    T *out = p->dst + p->begin;                                               \
+                                                                              \
+    while (i < i_end && j < j_end)                                            \
+    {                                                                         \
+        if (LESS(p->b[j], p->a[i]))                                           \
+            *out++ = p->b[j++];                                               \
+        else                                                                  \
+            *out++ = p->a[i++];                                               \
+    }                                                                         \
+    memcpy(out, p->a + i, (i_end - i) * sizeof(T));                           \
+    out += i_end - i;                                                         \
+    memcpy(out, p->b + j, (j_end - j) * sizeof(T));                           \
+}                                                                             \
+                                                                              \
+int32_t sort_parallel_##S(T *a, size_t n, int32_t threads)                    \
+{                                                                             \
+    size_t bounds[MAX_THREADS + 1], runs, r, next, part, parts, len;          \
+    chunk_##S##_t chunks[MAX_THREADS];                                        \
+    merge_##S##_t merges[MAX_THREADS];                                        \
+    job_t jobs[MAX_THREADS];                                                  \
+    T *buf, *src = a, *dst, *tmp;                                             \
+    int32_t i, njobs;                                                         \
+                                                                              \
+    if (threads > MAX_THREADS)                                                \
+        threads = MAX_THREADS;                                                \
+    if ((size_t)threads > n / PARALLEL_MIN)                                   \
+        threads = (int32_t)(n / PARALLEL_MIN);                                \
+    if (threads <= 1)                                                         \
+    {                                                                         \
+        sort_##S(a, n);                                                       \
+        return 0;                                                             \
+    }                                                                         \
+    buf = (T *)malloc(n * sizeof(T));                                         \
+    if (buf == NULL)                                                          \
+        return -1;                                                            \
+    dst = buf;                                                                \
+                                                                              \
+    for (i = 0; i <= threads; i++)                                            \
+        bounds[i] = n * i / threads;                                          \
+    for (i = 0; i < threads; i++)                                             \
+    {                                                                         \
+        chunks[i].a = a + bounds[i];                                          \
+        chunks[i].n = bounds[i + 1] - bounds[i];                              \
+        jobs[i].fn = sort_chunk_##S;                                          \
+        jobs[i].arg = &chunks[i];                                             \
+    }                                                                         \
+    run_jobs(jobs, threads);                                                  \
+                                                                              \
+    /*ÿ鲢ÿԷֵthreads/ݣһ߳ͬһ*/        \
+    for (runs = threads; runs > 1; runs = (runs + 1) / 2)                     \
+    {                                                                         \
+        parts = threads / (runs / 2);                                         \
+        njobs = 0;                                                            \
+        for (r = 0, next = 0; r + 1 < runs; r += 2, next++)                   \
+        {                                                                     \
+            len = bounds[r + 2] - bounds[r];                                  \
+            for (part = 0; part < parts; part++)                              \
+            {                                                                 \
+                merge_##S##_t *p = &merges[njobs];                            \
+                                                                              \
+                p->a = src + bounds[r];                                       \
+                p->m = bounds[r + 1] - bounds[r];                             \
+                p->b = src + bounds[r + 1];                                   \
+                p->n = bounds[r + 2] - bounds[r + 1];                         \
+                p->dst = dst + bounds[r];                                     \
+                p->begin = len * part / parts;                                \
+                p->end = len * (part + 1) / parts;                            \
+                jobs[njobs].fn = merge_part_##S;                              \
+                jobs[njobs].arg = p;                                          \
+                njobs++;                                                      \
+            }                                                                 \
+            bounds[next] = bounds[r];                                         \
+        }                                                                     \
+        if (r < runs)                                                         \
+        {                                                                     \
+            /*䵥һԭȥ*/                                          \
+            memcpy(dst + bounds[r], src + bounds[r],                          \
+                   (bounds[r + 1] - bounds[r]) * sizeof(T));                  \
+            bounds[next++] = bounds[r];                                       \
+        }                                                                     \
+        bounds[next] = n;                                                     \
+        run_jobs(jobs, njobs);                                                \
+        tmp = src;                                                            \
+        src = dst;                                                            \
+        dst = tmp;                                                            \
+    }                                                                         \
+    if (src != a)                                                             \
+        memcpy(a, src, n * sizeof(T));                                        \
+    free(buf);                                                                \
+    return 0;                                                                 \
+}
+
+
+PDQSORT_IMPL(i32, int32_t, LESS_NUM)
+PDQSORT_IMPL(u32, uint32_t, LESS_NUM)
+PDQSORT_IMPL(i64, int64_t, LESS_NUM)
+PDQSORT_IMPL(u64, uint64_t, LESS_NUM)
+PDQSORT_IMPL(kv32, sort_kv32_t, LESS_KEY)
+PDQSORT_IMPL(kv64, sort_kv64_t, LESS_KEY)
+
+RADIX_IMPL(i32, int32_t, KEY_I32, 32)
+RADIX_IMPL(u32, uint32_t, KEY_U32, 32)
+RADIX_IMPL(i64, int64_t, KEY_I64, 64)
+RADIX_IMPL(u64, uint64_t, KEY_U64, 64)
+RADIX_IMPL(kv32, sort_kv32_t, KEY_KV, 32)
+RADIX_IMPL(kv64, sort_kv64_t, KEY_KV, 64)
+
+PARALLEL_IMPL(i32, int32_t, LESS_NUM)
+PARALLEL_IMPL(u32, uint32_t, LESS_NUM)
+PARALLEL_IMPL(i64, int64_t, LESS_NUM)
+PARALLEL_IMPL(u64, uint64_t, LESS_NUM)
+PARALLEL_IMPL(kv32, sort_kv32_t, LESS_KEY)
+PARALLEL_IMPL(kv64, sort_kv64_t, LESS_KEY)
+
+
+#ifdef __cplusplus
+}
+#endif
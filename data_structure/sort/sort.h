@@ -0,0 +1,73 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+/*
+ *⣬Sort.c ǽ̿дҪڴϵģ
+ *sort_xxx           pdqsort(pattern-defeating quicksort)ʡĸĽ棬
+ *                   С򣬴ȡУʱ÷֧(
+ *                   Ҫ±һ)ֵ̫ƫʹҼԪأƫ͸
+ *                   O(nlogn)ظӽO(n)ȶ
+ *sort_radix_xxx     LSDÿ8λһͳƳλĸĳһλȫͬ
+ *                   O(n)ҪnԪصĶڴ档ȶ
+ *sort_parallel_xxx  ̹߳鲢ֳthreadsθpdqsort鲢鲢ʱ
+ *                   merge pathһԶгɼ߳һҪnԪصĶڴ
+ *
+ *ͣi32 u32 i64 u64Լkeyļֵ kv32 kv64
+ */
+
+#ifndef _SORT_H_
+#define _SORT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct sort_kv32{
+    uint32_t key;
+    uint32_t value;
+} sort_kv32_t;
+
+typedef struct sort_kv64{
+    uint64_t key;
+    uint64_t value;
+} sort_kv64_t;
+
+/*
+ *ܣpdqsortС
+ *a 飬n 
+ */
+void sort_i32(int32_t *a, size_t n);
+void sort_u32(uint32_t *a, size_t n);
+void sort_i64(int64_t *a, size_t n);
+void sort_u64(uint64_t *a, size_t n);
+void sort_kv32(sort_kv32_t *a, size_t n);
+void sort_kv64(sort_kv64_t *a, size_t n);
+
+/*
+ *ܣLSD򣬴Сȶ
+ *ֵ0ɹ-1ڴ治(û)
+ */
+int32_t sort_radix_i32(int32_t *a, size_t n);
+int32_t sort_radix_u32(uint32_t *a, size_t n);
+int32_t sort_radix_i64(int64_t *a, size_t n);
+int32_t sort_radix_u64(uint64_t *a, size_t n);
+int32_t sort_radix_kv32(sort_kv32_t *a, size_t n);
+int32_t sort_radix_kv64(sort_kv64_t *a, size_t n);
+
+/*
+ *ܣ̹߳鲢򣬴С
+ *threads ߳<=1̫Сʱsort_xxx
+ *ֵ0ɹ-1ڴ治(û)
+ */
+int32_t sort_parallel_i32(int32_t *a, size_t n, int32_t threads);
+int32_t sort_parallel_u32(uint32_t *a, size_t n, int32_t threads);
+int32_t sort_parallel_i64(int64_t *a, size_t n, int32_t threads);
+int32_t sort_parallel_u64(uint64_t *a, size_t n, int32_t threads);
+int32_t sort_parallel_kv32(sort_kv32_t *a, size_t n, int32_t threads);
+int32_t sort_parallel_kv64(sort_kv64_t *a, size_t n, int32_t threads);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include "sort.h"
+#include "../test_util.h"
+
+/*
+ *qsortpdqsort򡢶̹߳鲢ĶԱȣȴ1Kÿγ10 -n 
+ *÷sort_bench [-n 󳤶] [-t ߳] [-T i32|u64|kv64]
+ *1e9u64Ҫ8Gټ8G壬ڴ -n
+ *ʱÿԪص̵ظżȡƽ
+ */
+
+enum {
+    DIST_RANDOM,
+    DIST_SORTED,
+    DIST_REVERSED,
+    DIST_FEW,
+    DIST_NUM
+};
+
+static const char *dist_name[DIST_NUM] = {"random", "sorted", "reversed", "few"};
+
+enum {
+    ALGO_QSORT,
+    ALGO_PDQ,
+    ALGO_RADIX,
+    ALGO_PARALLEL,
+    ALGO_NUM
+};
+
+static const char *algo_name[ALGO_NUM] = {"qsort", "pdqsort", "radix", "parallel"};
+
+static int threads = 4;
+
+static uint64_t gen(int dist, size_t i, size_t n)
+{
+    switch (dist)
+    {
+    case DIST_SORTED:
+        return i;
+    case DIST_REVERSED:
+        return n - i;
+    case DIST_FEW:
+        return xorshift64() % 16;
+    default:
+        return xorshift64();
+    }
+}
+
+/*-1*/
+#define BENCH_IMPL(S, T, SET, KEY)                                            \
+static int cmp_##S(const void *x, const void *y)                              \
+{                                                                             \
+    const T *a = (const T *)x, *b = (const T *)y;                             \
+    return KEY(*a) < KEY(*b) ? -1 : KEY(*a) > KEY(*b);                        \
+}                                                                             \
+                                                                              \
+static double bench_##S(int algo, int dist, size_t n, size_t reps,            \
+                        T *src, T *a)                                         \
+{                                                                             \
+    struct timeval tv_begin, tv_end;                                          \
+    double total = 0;                                                         \
+    uint64_t sum_src = 0, sum = 0;                                            \
+    size_t i, r;                                                              \
+    int ret = 0;                                                              \
+                                                                              \
+    for (i = 0; i < n; i++)                                                   \
+    {                                                                         \
+        SET(src[i], gen(dist, i, n), i);                                      \
+        sum_src += KEY(src[i]);                                               \
+    }                                                                         \
+    for (r = 0; r < reps; r++)                                                \
+    {                                                                         \
+        memcpy(a, src, n * sizeof(T));                                        \
+        gettimeofday(&tv_begin, NULL);                                        \
+        switch (algo)                                                         \
+        {                                                                     \
+        case ALGO_QSORT:                                                      \
+            qsort(a, n, sizeof(T), cmp_##S);                                  \
+            break;                                                            \
+        case ALGO_PDQ:                                                        \
+            sort_##S(a, n);                                                   \
+            break;                                                            \
+        case ALGO_RADIX:                                                      \
+            ret = sort_radix_##S(a, n);                                       \
+            break;                                                            \
+        default:                                                              \
+            ret = sort_parallel_##S(a, n, threads);                           \
+            break;                                                            \
+        }                                                                     \
+        gettimeofday(&tv_end, NULL);                                          \
+        total += diff_time(tv_begin, tv_end);                                 \
+        if (ret != 0)                                                         \
+            return -1;                                                        \
+    }                                                                         \
+    for (i = 0; i < n; i++)                                                   \
+    {                                                                         \
+        if (i > 0 && KEY(a[i]) < KEY(a[i - 1]))                               \
+            return -1;                                                        \
+        sum += KEY(a[i]);                                                     \
+    }                                                                         \
+    return sum == sum_src ? total / reps : -1;                                \
+}
+
+#define SET_NUM(x, k, i)    ((x) = (k))
+#define SET_KV(x, k, i)     ((x).key = (k), (x).value = (i))
+#define KEY_NUM(x)          (x)
+#define KEY_KV(x)           ((x).key)
+
+BENCH_IMPL(i32, int32_t, SET_NUM, KEY_NUM)
+BENCH_IMPL(u64, uint64_t, SET_NUM, KEY_NUM)
+BENCH_IMPL(kv64, sort_kv64_t, SET_KV, KEY_KV)
+
+int main(int argc, char *argv[])
+{
+    size_t max_n = 10000000, n, reps, elem;
+    const char *type = "u64";
+    double t;
+    void *src, *a;
+    int opt, dist, algo;
+
+    while ((opt = getopt(argc, argv, "n:t:T:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            max_n = (size_t)atof(optarg);
+            break;
+        case 't':
+            threads = atoi(optarg);
+            break;
+        case 'T':
+            type = optarg;
+            break;
+        default:
+            printf("usage: %s [-n max] [-t threads] [-T i32|u64|kv64]\n", argv[0]);
+            return -1;
+        }
+    }
+    if (strcmp(type, "i32") == 0)
+        elem = sizeof(int32_t);
+    else if (strcmp(type, "u64") == 0)
+        elem = sizeof(uint64_t);
+    else if (strcmp(type, "kv64") == 0)
+        elem = sizeof(sort_kv64_t);
+    else
+    {
+        printf("unknown type %s\n", type);
+        return -1;
+    }
+
+    src = malloc(max_n * elem);
+    a = malloc(max_n * elem);
+    if (src == NULL || a == NULL)
+    {
+        printf("out of memory for %zu elements\n", max_n);
+        return -1;
+    }
+
+    printf("type %s, %d threads, ns per element\n", type, threads);
+    printf("%-12s %-9s", "n", "dist");
+    for (algo = 0; algo < ALGO_NUM; algo++)
+        printf(" %10s", algo_name[algo]);
+    printf("\n");
+    for (n = 1000; n <= max_n; n *= 10)
+    {
+        /*ÿŹ1000Ԫ*/
+        reps = n < 10000000 ? 10000000 / n : 1;
+        for (dist = 0; dist < DIST_NUM; dist++)
+        {
+            printf("%-12zu %-9s", n, dist_name[dist]);
+            for (algo = 0; algo < ALGO_NUM; algo++)
+            {
+                rng = TEST_RNG_SEED;
+                if (elem == sizeof(int32_t))
+                    t = bench_i32(algo, dist, n, reps, src, a);
+                else if (elem == sizeof(uint64_t))
+                    t = bench_u64(algo, dist, n, reps, src, a);
+                else
+                    t = bench_kv64(algo, dist, n, reps, src, a);
+                if (t < 0)
+                    printf(" %10s", "FAIL");
+                else
+                    printf(" %10.2f", t * 1e9 / n);
+                fflush(stdout);
+            }
+            printf("\n");
+        }
+    }
+
+    free(src);
+    free(a);
+    return 0;
+}
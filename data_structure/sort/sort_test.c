@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "sort.h"
+#include "../test_util.h"
+
+/*
+ *ÿ͡ÿֲַÿȶqsortĽȣkvĻҪȶ
+ */
+
+enum {
+    DIST_RANDOM,
+    DIST_SORTED,
+    DIST_REVERSED,
+    DIST_FEW,       /*ֻмֵͬ*/
+    DIST_ORGAN,     /**/
+    DIST_NEARLY,    /**/
+    DIST_EXTREME,   /*Сֵ*/
+    DIST_NUM
+};
+
+static const char *dist_name[DIST_NUM] = {
+    "random", "sorted", "reversed", "few", "organ", "nearly", "extreme"
+};
+
+static uint64_t gen(int dist, size_t i, size_t n)
+{
+    switch (dist)
+    {
+    case DIST_SORTED:
+        return i;
+    case DIST_REVERSED:
+        return n - i;
+    case DIST_FEW:
+        return xorshift64() % 4;
+    case DIST_ORGAN:
+        return i < n / 2 ? i : n - i;
+    case DIST_NEARLY:
+        return i;
+    case DIST_EXTREME:
+        return xorshift64() & 1 ? UINT64_MAX : 0;
+    default:
+        return xorshift64();
+    }
+}
+
+#define TEST_IMPL(S, T, SET, KEY)                                             \
+static int cmp_##S(const void *x, const void *y)                              \
+{                                                                             \
+    const T *a = (const T *)x, *b = (const T *)y;                             \
+    return KEY(*a) < KEY(*b) ? -1 : KEY(*a) > KEY(*b);                        \
+}                                                                             \
+                                                                              \
+static void fill_##S(T *a, size_t n, int dist)                                \
+{                                                                             \
+    size_t i, j;                                                              \
+    T tmp;                                                                    \
+                                                                              \
+    for (i = 0; i < n; i++)                                                   \
+        SET(a[i], gen(dist, i, n), i);                                        \
+    if (dist == DIST_NEARLY && n > 1)                                         \
+    {                                                                         \
+        for (i = 0; i < n / 64 + 1; i++)                                      \
+        {                                                                     \
+            j = xorshift64() % n;                                             \
+            tmp = a[j];                                                       \
+            a[j] = a[i * 7 % n];                                              \
+            a[i * 7 % n] = tmp;                                               \
+        }                                                                     \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+static void check_##S(const char *algo, const T *got, const T *want,          \
+                      size_t n, int dist, int stable)                         \
+{                                                                             \
+    size_t i;                                                                 \
+                                                                              \
+    for (i = 0; i < n; i++)                                                   \
+    {                                                                         \
+        if (KEY(got[i]) != KEY(want[i]))                                      \
+        {                                                                     \
+            printf("%s %s n=%zu %s: wrong at %zu\n", #S, algo, n,             \
+                   dist_name[dist], i);                                       \
+            failed++;                                                         \
+            return;                                                           \
+        }                                                                     \
+        if (stable && memcmp(&got[i], &want[i], sizeof(T)) != 0)              \
+        {                                                                     \
+            printf("%s %s n=%zu %s: not stable at %zu\n", #S, algo, n,        \
+                   dist_name[dist], i);                                       \
+            failed++;                                                         \
+            return;                                                           \
+        }                                                                     \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+/*qsortȶȶĴò*/                                       \
+static void stable_sort_##S(T *a, size_t n)                                   \
+{                                                                             \
+    size_t i, j;                                                              \
+    T tmp;                                                                    \
+                                                                              \
+    for (i = 1; i < n; i++)                                                   \
+    {                                                                         \
+        tmp = a[i];                                                           \
+        for (j = i; j > 0 && KEY(tmp) < KEY(a[j - 1]); j--)                   \
+            a[j] = a[j - 1];                                                  \
+        a[j] = tmp;                                                           \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+static void test_##S(size_t n, int dist, int threads, int stable)             \
+{                                                                             \
+    T *src = (T *)malloc((n + 1) * sizeof(T));                                \
+    T *want = (T *)malloc((n + 1) * sizeof(T));                               \
+    T *got = (T *)malloc((n + 1) * sizeof(T));                                \
+                                                                              \
+    fill_##S(src, n, dist);                                                   \
+    memcpy(want, src, n * sizeof(T));                                         \
+    if (stable)                                                               \
+        stable_sort_##S(want, n);                                             \
+    else                                                                      \
+        qsort(want, n, sizeof(T), cmp_##S);                                   \
+                                                                              \
+    memcpy(got, src, n * sizeof(T));                                          \
+    sort_##S(got, n);                                                         \
+    check_##S("pdqsort", got, want, n, dist, 0);                              \
+                                                                              \
+    memcpy(got, src, n * sizeof(T));                                          \
+    if (sort_radix_##S(got, n) != 0)                                          \
+        printf("%s radix n=%zu: out of memory\n", #S, n);                     \
+    check_##S("radix", got, want, n, dist, stable);                           \
+                                                                              \
+    memcpy(got, src, n * sizeof(T));                                          \
+    if (sort_parallel_##S(got, n, threads) != 0)                              \
+        printf("%s parallel n=%zu: out of memory\n", #S, n);                  \
+    check_##S("parallel", got, want, n, dist, 0);                             \
+                                                                              \
+    free(src);                                                                \
+    free(want);                                                               \
+    free(got);                                                                \
+}
+
+#define SET_NUM(x, k, i)    ((x) = (k))
+#define SET_KV(x, k, i)     ((x).key = (k), (x).value = (i))
+#define KEY_NUM(x)          (x)
+#define KEY_KV(x)           ((x).key)
+
+TEST_IMPL(i32, int32_t, SET_NUM, KEY_NUM)
+TEST_IMPL(u32, uint32_t, SET_NUM, KEY_NUM)
+TEST_IMPL(i64, int64_t, SET_NUM, KEY_NUM)
+TEST_IMPL(u64, uint64_t, SET_NUM, KEY_NUM)
+TEST_IMPL(kv32, sort_kv32_t, SET_KV, KEY_KV)
+TEST_IMPL(kv64, sort_kv64_t, SET_KV, KEY_KV)
+
+static void test_all(size_t n, int dist, int threads)
+{
+    test_i32(n, dist, threads, 0);
+    test_u32(n, dist, threads, 0);
+    test_i64(n, dist, threads, 0);
+    test_u64(n, dist, threads, 0);
+    /*𰸣̫Ĳȶ*/
+    test_kv32(n, dist, threads, n <= 5000);
+    test_kv64(n, dist, threads, n <= 5000);
+}
+
+int main(void)
+{
+    /*ļö̹߳鲢߳ż*/
+    size_t big[] = {131072, 200003, 300000, 1000000};
+    int threads[] = {2, 3, 4, 5};
+    size_t n;
+    int dist, i;
+
+    for (n = 0; n <= 2100; n += n < 300 ? 1 : 37)
+    {
+        for (dist = 0; dist < DIST_NUM; dist++)
+            test_all(n, dist, 4);
+    }
+    test_all(5000, DIST_RANDOM, 4);
+    test_all(5000, DIST_FEW, 4);
+    for (i = 0; i < 4; i++)
+    {
+        for (dist = 0; dist < DIST_NUM; dist++)
+            test_all(big[i], dist, threads[i]);
+    }
+
+    if (failed)
+        printf("%d failed\n", failed);
+    else
+        printf("all passed\n");
+    return failed != 0;
+}
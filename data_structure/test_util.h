@@ -0,0 +1,76 @@
+#ifdef __cplusplus
+extern "C"{
+#endif
+
+#ifndef __TEST_UTIL_H__
+#define __TEST_UTIL_H__
+
+/*
+ *data_structure¸Ŀ¼ *_test.c*_bench.c õĶ
+ *̶ӵxorshift64ʱʧܼCHECK
+ *staticģÿֻԼmainڵļ
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/time.h>
+
+#define TEST_RNG_SEED   88172645463325252ULL
+
+/*ȫֵ״̬ҪطͬоͰrngTEST_RNG_SEED*/
+static uint64_t rng = TEST_RNG_SEED;
+
+static inline uint64_t xorshift64(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+}
+
+/*߳ʱÿ߳Լ״̬*/
+static inline uint64_t xorshift(uint64_t *s)
+{
+    uint64_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *s = x;
+}
+
+/*Sort.cdiff_timeһ*/
+static inline double diff_time(struct timeval tv_begin, struct timeval tv_end)
+{
+    double end_d = tv_end.tv_sec + tv_end.tv_usec / 1000000.0;
+    double begin_d = tv_begin.tv_sec + tv_begin.tv_usec / 1000000.0;
+    return end_d - begin_d;
+}
+
+static inline double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*ʧܵĸbenchﲻ*/
+static int failed __attribute__((unused)) = 0;
+
+/*ʹӡһСһʧܣӵǰvoid*/
+#define CHECK(cond, ...)                                \
+    do {                                                \
+        if (!(cond))                                    \
+        {                                               \
+            printf(__VA_ARGS__);                        \
+            printf("\n");                               \
+            failed++;                                   \
+            return;                                     \
+        }                                               \
+    } while (0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif